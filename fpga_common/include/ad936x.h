@@ -854,5 +854,11 @@ int32_t ad9361_tx_fastlock_save(struct ad9361_rf_phy *phy,
                                 uint32_t profile,
                                 uint8_t *values);
 int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode);
+int32_t ad9361_set_trx_path_clks(struct ad9361_rf_phy *phy,
+                                 uint32_t *rx_path_clks,
+                                 uint32_t *tx_path_clks);
+int32_t ad9361_get_trx_path_clks(struct ad9361_rf_phy *phy,
+                                 uint32_t *rx_path_clks,
+                                 uint32_t *tx_path_clks);
 
 #endif  // AD936X_H_
@@ -95,6 +95,14 @@ static bladerf_frequency const RESET_FREQUENCY = 70000000;
 #define TRIMDAC_EN_ACTIVE           0x0
 #define TRIMDAC_EN_HIGHZ            0x3
 
+// RX decimation control (see hdl rx_decimator)
+#define RX_DECIM_NCO_DPHASE_MASK    0xFFFF  // 0 through 15
+#define RX_DECIM_LOG2_SHIFT         16      // 16 through 18
+#define RX_DECIM_LOG2_MASK          0x7
+#define RX_DECIM_LOG2_MAX           6
+#define RX_DECIM_NCO_EN             24
+#define RX_DECIM_NCO_PHASE_STEPS    8192    // NCO phase steps per cycle
+
 /* Number of fast lock profiles that can be stored in the Nios
  * Make sure this number matches that of the Nios' devices.h */
 #define NUM_BBP_FASTLOCK_PROFILES   256
@@ -108,6 +108,7 @@
 #define NIOS_PKT_8x32_TARGET_ADF400X  0x04   /* ADF400x config */
 #define NIOS_PKT_8x32_TARGET_FASTLOCK 0x05   /* Save AD9361 fast lock profile
                                               * to Nios */
+#define NIOS_PKT_8x32_TARGET_RX_DECIM 0x06   /* RX decimation/NCO control */
 
 /* IDs 0x80 through 0xff will not be assigned by Nuand. These are reserved
  * for user customizations */
@@ -34,6 +34,10 @@
 /* Specify this value instead of a timestamp to clear the retune queue */
 #define NIOS_PKT_RETUNE_CLEAR_QUEUE ((uint64_t) -1)
 
+/* Specify this value instead of a timestamp to cancel all scheduled retunes
+ * bearing the request's retune ID */
+#define NIOS_PKT_RETUNE_CANCEL      ((uint64_t) -2)
+
 /* This file defines the Host <-> FPGA (NIOS II) packet formats for
  * retune messages. This packet is formatted, as follows. All values are
  * little-endian.
@@ -56,16 +60,23 @@
  * |                | Bit 6:        1=Quick tune, 0=Normal tune               |
  * |                | Bits [5:0]    VCOCAP[5:0] Hint                          |
  * +----------------+---------------------------------------------------------+
- * |       15       | 8-bit reserved word. Should be set to 0x00.             |
+ * |       15       | 8-bit retune ID (Note 5)                                |
  * +----------------+---------------------------------------------------------+
  *
  * (Note 1) Special Timestamp Values:
  *
  * Tune "Now":          0x0000000000000000
+ * Cancel Retunes:      0xfffffffffffffffe
  * Clear Retune Queue:  0xffffffffffffffff
  *
- * When the "Clear Retune Queue" value is used, all of the other tuning
- * parameters are ignored.
+ * When the "Clear Retune Queue" or "Cancel Retunes" values are used, all of
+ * the other tuning parameters, aside from the RX/TX bit and retune ID, are
+ * ignored.
+ *
+ * Scheduled retunes may be submitted in any order; they are performed in
+ * order of their timestamps. A retune whose timestamp has already passed by
+ * the time it reaches the head of the queue is performed immediately, and is
+ * reported as a missed deadline (see the response's status fields).
  *
  * (Note 2) Packed as follows:
  *
@@ -94,6 +105,10 @@
  * +----------------+-----------------------+
  *
  * (Notes 4) Band-selection bit = 1 implies "Low band". 0 = "High band"
+ *
+ * (Note 5) An arbitrary, host-assigned value used to identify scheduled
+ *          retunes for later cancellation. Multiple retunes may share an ID.
+ *          Hosts that do not use cancellation should set this to 0x00.
  */
 
 #define NIOS_PKT_RETUNE_IDX_MAGIC    0
@@ -101,7 +116,7 @@
 #define NIOS_PKT_RETUNE_IDX_INTFRAC  9
 #define NIOS_PKT_RETUNE_IDX_FREQSEL  13
 #define NIOS_PKT_RETUNE_IDX_BANDSEL  14
-#define NIOS_PKT_RETUNE_IDX_RESV     15
+#define NIOS_PKT_RETUNE_IDX_ID       15
 
 #define NIOS_PKT_RETUNE_MAGIC        'T'
 
@@ -177,7 +192,19 @@ static inline void nios_pkt_retune_pack(uint8_t *buf,
 
     buf[NIOS_PKT_RETUNE_IDX_BANDSEL] |= vcocap;
 
-    buf[NIOS_PKT_RETUNE_IDX_RESV]     = 0x00;
+    buf[NIOS_PKT_RETUNE_IDX_ID]       = 0x00;
+}
+
+/* Set the retune ID of a packed retune request */
+static inline void nios_pkt_retune_set_id(uint8_t *buf, uint8_t id)
+{
+    buf[NIOS_PKT_RETUNE_IDX_ID] = id;
+}
+
+/* Get the retune ID of a retune request */
+static inline uint8_t nios_pkt_retune_get_id(const uint8_t *buf)
+{
+    return buf[NIOS_PKT_RETUNE_IDX_ID];
 }
 
 /* Unpack a retune request */
@@ -240,7 +267,11 @@ static inline void nios_pkt_retune_unpack(const uint8_t *buf,
  * +----------------+---------------------------------------------------------+
  * |       10       | Status Flags (Note 3)                                   |
  * +----------------+---------------------------------------------------------+
- * |      11-15     | Reserved. All bits set to 0.                            |
+ * |       11       | Number of missed deadlines (Note 4)                     |
+ * +----------------+---------------------------------------------------------+
+ * |       12       | Number of retunes cancelled (Note 5)                    |
+ * +----------------+---------------------------------------------------------+
+ * |      13-15     | Reserved. All bits set to 0.                            |
  * +----------------+---------------------------------------------------------+
  *
  * (Note 1) This value will be zero if timestamps are not running for the
@@ -271,13 +302,22 @@ static inline void nios_pkt_retune_unpack(const uint8_t *buf,
  *                is full.
  *
  *      flags[7:2]    Reserved. Set to 0.
+ *
+ * (Note 4) The number of scheduled retunes for the associated module that
+ *          were performed late, since the previous response, because their
+ *          timestamps had already passed. Saturates at 255.
+ *
+ * (Note 5) The number of scheduled retunes removed from the queue by a
+ *          "Cancel Retunes" request. Zero for all other requests.
  */
 
 #define NIOS_PKT_RETUNERESP_IDX_MAGIC   0
 #define NIOS_PKT_RETUNERESP_IDX_TIME    1
 #define NIOS_PKT_RETUNERESP_IDX_VCOCAP  9
 #define NIOS_PKT_RETUNERESP_IDX_FLAGS   10
-#define NIOS_PKT_RETUNERESP_IDX_RESV    11
+#define NIOS_PKT_RETUNERESP_IDX_MISSED  11
+#define NIOS_PKT_RETUNERESP_IDX_CANCELLED 12
+#define NIOS_PKT_RETUNERESP_IDX_RESV    13
 
 #define NIOS_PKT_RETUNERESP_FLAG_TSVTUNE_VALID (1 << 0)
 #define NIOS_PKT_RETUNERESP_FLAG_SUCCESS       (1 << 1)
@@ -302,11 +342,30 @@ static inline void nios_pkt_retune_resp_pack(uint8_t *buf,
 
     buf[NIOS_PKT_RETUNERESP_IDX_FLAGS] = flags;
 
+    buf[NIOS_PKT_RETUNERESP_IDX_MISSED]    = 0x00;
+    buf[NIOS_PKT_RETUNERESP_IDX_CANCELLED] = 0x00;
+
     buf[NIOS_PKT_RETUNERESP_IDX_RESV + 0] = 0x00;
     buf[NIOS_PKT_RETUNERESP_IDX_RESV + 1] = 0x00;
     buf[NIOS_PKT_RETUNERESP_IDX_RESV + 2] = 0x00;
-    buf[NIOS_PKT_RETUNERESP_IDX_RESV + 3] = 0x00;
-    buf[NIOS_PKT_RETUNERESP_IDX_RESV + 4] = 0x00;
+}
+
+/* Set the queue status fields of a packed retune response */
+static inline void nios_pkt_retune_resp_set_status(uint8_t *buf,
+                                                   uint8_t missed,
+                                                   uint8_t cancelled)
+{
+    buf[NIOS_PKT_RETUNERESP_IDX_MISSED]    = missed;
+    buf[NIOS_PKT_RETUNERESP_IDX_CANCELLED] = cancelled;
+}
+
+/* Get the queue status fields of a retune response */
+static inline void nios_pkt_retune_resp_get_status(const uint8_t *buf,
+                                                   uint8_t *missed,
+                                                   uint8_t *cancelled)
+{
+    *missed    = buf[NIOS_PKT_RETUNERESP_IDX_MISSED];
+    *cancelled = buf[NIOS_PKT_RETUNERESP_IDX_CANCELLED];
 }
 
 static inline void nios_pkt_retune_resp_unpack(const uint8_t *buf,
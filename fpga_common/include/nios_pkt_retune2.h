@@ -58,16 +58,25 @@
  * |                | Bits [3:2]: External RX2 SPDT switch setting            |
  * |                | Bits [1:0]: External RX1 SPDT switch setting            |
  * +----------------+---------------------------------------------------------+
- * |       14-15    | 8-bit reserved words. Should be set to 0x00.            |
+ * |       14       | 8-bit retune ID (Note 3)                                |
+ * +----------------+---------------------------------------------------------+
+ * |       15       | 8-bit reserved word. Should be set to 0x00.             |
  * +----------------+---------------------------------------------------------+
  *
  * (Note 1) Special Timestamp Values:
  *
  * Tune "Now":          0x0000000000000000
+ * Cancel Retunes:      0xfffffffffffffffe
  * Clear Retune Queue:  0xffffffffffffffff
  *
- * When the "Clear Retune Queue" value is used, all of the other tuning
- * parameters are ignored.
+ * When the "Clear Retune Queue" or "Cancel Retunes" values are used, all of
+ * the other tuning parameters, aside from the RX bit and retune ID, are
+ * ignored.
+ *
+ * Scheduled retunes may be submitted in any order; they are performed in
+ * order of their timestamps. A retune whose timestamp has already passed by
+ * the time it reaches the head of the queue is performed immediately, and is
+ * reported as a missed deadline (see the response's status fields).
  *
  * (Note 2) Packed as follows:
  *
@@ -79,6 +88,9 @@
  * |       1        |  NIOS_PROFILE[15:8]   |
  * +----------------+-----------------------+
  *
+ * (Note 3) An arbitrary, host-assigned value used to identify scheduled
+ *          retunes for later cancellation. Multiple retunes may share an ID.
+ *          Hosts that do not use cancellation should set this to 0x00.
  */
 
 #define NIOS_PKT_RETUNE2_IDX_MAGIC        0
@@ -87,13 +99,18 @@
 #define NIOS_PKT_RETUNE2_IDX_RFFE_PROFILE 11
 #define NIOS_PKT_RETUNE2_IDX_RFFE_PORT    12
 #define NIOS_PKT_RETUNE2_IDX_SPDT         13
-#define NIOS_PKT_RETUNE2_IDX_RESV         14
+#define NIOS_PKT_RETUNE2_IDX_ID           14
+#define NIOS_PKT_RETUNE2_IDX_RESV         15
 
 #define NIOS_PKT_RETUNE2_MAGIC            'U'
 
 /* Specify this value instead of a timestamp to clear the retune2 queue */
 #define NIOS_PKT_RETUNE2_CLEAR_QUEUE      ((uint64_t) -1)
 
+/* Specify this value instead of a timestamp to cancel all scheduled retune2
+ * requests bearing the request's retune ID */
+#define NIOS_PKT_RETUNE2_CANCEL           ((uint64_t) -2)
+
 /* Denotes that the retune2 should not be scheduled - it should occur "now" */
 #define NIOS_PKT_RETUNE2_NOW              ((uint64_t) 0x00)
 
@@ -138,8 +155,21 @@ static inline void nios_pkt_retune2_pack(uint8_t *buf,
 
     buf[NIOS_PKT_RETUNE2_IDX_SPDT] = spdt & 0xff;
 
-    buf[NIOS_PKT_RETUNE2_IDX_RESV + 0] = 0x00;
-    buf[NIOS_PKT_RETUNE2_IDX_RESV + 1] = 0x00;
+    buf[NIOS_PKT_RETUNE2_IDX_ID] = 0x00;
+
+    buf[NIOS_PKT_RETUNE2_IDX_RESV] = 0x00;
+}
+
+/* Set the retune ID of a packed retune2 request */
+static inline void nios_pkt_retune2_set_id(uint8_t *buf, uint8_t id)
+{
+    buf[NIOS_PKT_RETUNE2_IDX_ID] = id;
+}
+
+/* Get the retune ID of a retune2 request */
+static inline uint8_t nios_pkt_retune2_get_id(const uint8_t *buf)
+{
+    return buf[NIOS_PKT_RETUNE2_IDX_ID];
 }
 
 /* Unpack a retune request */
@@ -192,7 +222,11 @@ static inline void nios_pkt_retune2_unpack(const uint8_t *buf,
  * +----------------+---------------------------------------------------------+
  * |        9       | Status Flags (Note 2)                                   |
  * +----------------+---------------------------------------------------------+
- * |      10-15     | Reserved. All bits set to 0.                            |
+ * |       10       | Number of missed deadlines (Note 3)                     |
+ * +----------------+---------------------------------------------------------+
+ * |       11       | Number of retunes cancelled (Note 4)                    |
+ * +----------------+---------------------------------------------------------+
+ * |      12-15     | Reserved. All bits set to 0.                            |
  * +----------------+---------------------------------------------------------+
  *
  * (Note 1) This value will be zero if timestamps are not running for the
@@ -219,12 +253,21 @@ static inline void nios_pkt_retune2_unpack(const uint8_t *buf,
  *                is full.
  *
  *      flags[7:2]    Reserved. Set to 0.
+ *
+ * (Note 3) The number of scheduled retunes for the associated module that
+ *          were performed late, since the previous response, because their
+ *          timestamps had already passed. Saturates at 255.
+ *
+ * (Note 4) The number of scheduled retunes removed from the queue by a
+ *          "Cancel Retunes" request. Zero for all other requests.
  */
 
 #define NIOS_PKT_RETUNE2_RESP_IDX_MAGIC   0
 #define NIOS_PKT_RETUNE2_RESP_IDX_TIME    1
 #define NIOS_PKT_RETUNE2_RESP_IDX_FLAGS   9
-#define NIOS_PKT_RETUNE2_RESP_IDX_RESV    10
+#define NIOS_PKT_RETUNE2_RESP_IDX_MISSED    10
+#define NIOS_PKT_RETUNE2_RESP_IDX_CANCELLED 11
+#define NIOS_PKT_RETUNE2_RESP_IDX_RESV    12
 
 #define NIOS_PKT_RETUNE2_RESP_FLAG_TSVTUNE_VALID (1 << 0)
 #define NIOS_PKT_RETUNE2_RESP_FLAG_SUCCESS       (1 << 1)
@@ -246,12 +289,31 @@ static inline void nios_pkt_retune2_resp_pack(uint8_t *buf,
 
     buf[NIOS_PKT_RETUNE2_RESP_IDX_FLAGS] = flags;
 
+    buf[NIOS_PKT_RETUNE2_RESP_IDX_MISSED]    = 0x00;
+    buf[NIOS_PKT_RETUNE2_RESP_IDX_CANCELLED] = 0x00;
+
     buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 0] = 0x00;
     buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 1] = 0x00;
     buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 2] = 0x00;
     buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 3] = 0x00;
-    buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 4] = 0x00;
-    buf[NIOS_PKT_RETUNE2_RESP_IDX_RESV + 5] = 0x00;
+}
+
+/* Set the queue status fields of a packed retune2 response */
+static inline void nios_pkt_retune2_resp_set_status(uint8_t *buf,
+                                                    uint8_t missed,
+                                                    uint8_t cancelled)
+{
+    buf[NIOS_PKT_RETUNE2_RESP_IDX_MISSED]    = missed;
+    buf[NIOS_PKT_RETUNE2_RESP_IDX_CANCELLED] = cancelled;
+}
+
+/* Get the queue status fields of a retune2 response */
+static inline void nios_pkt_retune2_resp_get_status(const uint8_t *buf,
+                                                    uint8_t *missed,
+                                                    uint8_t *cancelled)
+{
+    *missed    = buf[NIOS_PKT_RETUNE2_RESP_IDX_MISSED];
+    *cancelled = buf[NIOS_PKT_RETUNE2_RESP_IDX_CANCELLED];
 }
 
 static inline void nios_pkt_retune2_resp_unpack(const uint8_t *buf,
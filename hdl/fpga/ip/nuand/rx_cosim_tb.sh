@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+#
+# RX co-simulation with GHDL: fifo_writer -> RX FIFOs -> fx3_gpif -> FX3/host
+# model. Produces a capture of the USB byte stream, which is then checked by
+# libbladeRF_test_rx_cosim if it is available.
+#
+# The Altera FIFO models are required. These may be compiled with the script
+# that ships with GHDL (libraries/vendors/compile-intel.sh --altera); point
+# -L at the directory it produces.
+################################################################################
+
+function usage()
+{
+    echo ""
+    echo "bladeRF RX co-simulation script"
+    echo ""
+    echo "Usage: `basename $0` -L <altera libs> [options] [-- <generics>]"
+    echo ""
+    echo "Options:"
+    echo "    -L <dir>              Directory containing GHDL-compiled altera_mf"
+    echo "    -w <dir>              Working directory (default: ./rx_cosim_tb)"
+    echo "    -c <checker>          Path to libbladeRF_test_rx_cosim"
+    echo "    -a <args>             Checker arguments. These must agree with the"
+    echo "                          USB2, META_ENABLE and ENABLE_CHANNEL_1 generics."
+    echo "    -h                    Show this text"
+    echo ""
+    echo "Generics are passed to the testbench, e.g.:"
+    echo "    `basename $0` -L ~/ghdl/intel -- -gSAMPLE_FIFO_DEPTH=2048 \\"
+    echo "        -gHOST_BUFFER_NS=300000 -gSCHEDULE_FILE=stalls.txt"
+    echo ""
+    echo "See hdl/fpga/ip/nuand/simulation/rx_cosim_tb.vhd for the full list."
+    echo ""
+}
+
+root=$(cd "$(dirname "$0")" && pwd)
+workdir=$(pwd)/rx_cosim_tb
+altera_libs=""
+checker=$(command -v libbladeRF_test_rx_cosim)
+checker_args=""
+
+while getopts ":L:w:c:a:h" opt; do
+    case $opt in
+        L)
+            altera_libs=$OPTARG
+            ;;
+        w)
+            workdir=$OPTARG
+            ;;
+        c)
+            checker=$OPTARG
+            ;;
+        a)
+            checker_args=$OPTARG
+            ;;
+        h)
+            usage
+            exit 0
+            ;;
+        \?)
+            echo "Invalid option: -$OPTARG" >&2
+            usage
+            exit 1
+            ;;
+    esac
+done
+shift $((OPTIND-1))
+
+if [ "$1" == "--" ]; then
+    shift
+fi
+
+if [ -z "$altera_libs" ]; then
+    echo "The location of the Altera simulation libraries (-L) is required." >&2
+    usage
+    exit 1
+fi
+
+GHDL_FLAGS="--std=08 --work=nuand --workdir=${workdir} -P${altera_libs} -frelaxed"
+
+sources=(
+    synthesis/synchronizer.vhd
+    synthesis/set_clear_ff.vhd
+    ../altera/common_dcfifo/common_dcfifo.vhd
+    ../../platforms/bladerf-micro/vhdl/wrappers/rx_fifo.vhd
+    ../../platforms/bladerf-micro/vhdl/wrappers/rx_meta_fifo.vhd
+    simulation/util.vhd
+    simulation/fx3_model.vhd
+    synthesis/fifo_readwrite_p.vhd
+    synthesis/fifo_writer.vhd
+    ../../platforms/common/bladerf/vhdl/fx3_gpif.vhd
+    simulation/rx_cosim_tb.vhd
+)
+
+set -e
+
+mkdir -p "${workdir}"
+
+for src in "${sources[@]}"; do
+    ghdl -a ${GHDL_FLAGS} "${root}/${src}"
+done
+
+ghdl -e ${GHDL_FLAGS} -o "${workdir}/rx_cosim_tb" rx_cosim_tb
+
+pushd "${workdir}" >/dev/null
+./rx_cosim_tb "$@" --ieee-asserts=disable-at-0
+popd >/dev/null
+
+if [ -n "$checker" ]; then
+    "$checker" ${checker_args} "${workdir}/rx_cosim.bin"
+else
+    echo "libbladeRF_test_rx_cosim not found; capture left in ${workdir}/rx_cosim.bin"
+fi
@@ -27,7 +27,22 @@ library ieee;
 library work;
     use work.util.all;
 
+library std;
+    use std.textio.all;
+
 entity fx3_model is
+  generic (
+    -- The following are only used by the "host" architecture, which models
+    -- the FX3 handing RX data to a host that is running libbladeRF's sync
+    -- interface. Sizes are in 32-bit GPIF words, times are in ns or us.
+    HOST_BLOCK_SIZE     :   natural := 512;     -- GPIF DMA size (256 for USB 2.0)
+    HOST_BUFFER_SIZE    :   natural := 8192;    -- Words per libbladeRF buffer
+    HOST_NUM_TRANSFERS  :   natural := 8;       -- Transfers in flight
+    HOST_NUM_BUFFERS    :   natural := 64;      -- Buffers to receive before finishing
+    HOST_BUFFER_NS      :   natural := 0;       -- Time the host spends on each buffer
+    HOST_SCHEDULE_FILE  :   string  := "";      -- Optional per-buffer host stalls
+    HOST_CAPTURE_FILE   :   string  := "rx_capture.bin"
+  );
   port (
     fx3_pclk            :   buffer  std_logic := '1';
     fx3_gpif            :   inout   std_logic_vector(31 downto 0);
@@ -268,3 +283,203 @@ end architecture dma;
 architecture inband_scheduler of fx3_model is
 begin
 end architecture inband_scheduler;
+
+-- Models the RX path from the FX3 to a host running libbladeRF's sync
+-- interface, for measuring how the FPGA FIFOs cope with host scheduling.
+--
+-- The host has HOST_NUM_TRANSFERS transfers of HOST_BUFFER_SIZE words in
+-- flight. The FX3 only requests GPIF DMAs while a transfer is available to
+-- fill, so when the host falls behind, data backs up into the FPGA. Each
+-- filled buffer is consumed by the host after HOST_BUFFER_NS, plus any stall
+-- listed for it in HOST_SCHEDULE_FILE, at which point it is resubmitted.
+--
+-- The schedule file contains lines of the form "<buffer index> <stall us>".
+-- Lines that do not start with a number are ignored.
+--
+-- Everything received is written, little-endian, to HOST_CAPTURE_FILE, exactly
+-- as libbladeRF would see it over USB. USB bus latency is not modeled; the
+-- GPIF interface is the bottleneck at 100 MHz.
+architecture host of fx3_model is
+
+    constant PCLK_HALF_PERIOD       : time      := 1 sec * (1.0/100.0e6/2.0);
+
+    -- Control mapping
+    alias dma0_rx_ack   is fx3_ctl( 0);
+    alias dma_rx_enable is fx3_ctl( 4);
+    alias dma_tx_enable is fx3_ctl( 5);
+    alias dma_idle      is fx3_ctl( 6);
+    alias system_reset  is fx3_ctl( 7);
+    alias dma0_rx_reqx  is fx3_ctl( 8);
+    alias dma1_rx_reqx  is fx3_ctl(12); -- due to 9 being connected to dclk
+    alias dma2_tx_reqx  is fx3_ctl(10);
+    alias dma3_tx_reqx  is fx3_ctl(11);
+
+    type byte_file_t is file of character;
+    type stall_array_t is array( natural range <> ) of natural;
+
+    signal rx_done          : boolean := false;
+    signal buffers_filled   : natural := 0;
+    signal buffers_consumed : natural := 0;
+
+    impure function read_schedule return stall_array_t is
+        file     f      : text;
+        variable l      : line;
+        variable status : file_open_status;
+        variable idx    : integer;
+        variable stall  : integer;
+        variable ok     : boolean;
+        variable rv     : stall_array_t(0 to HOST_NUM_BUFFERS-1) := (others => 0);
+    begin
+        if( HOST_SCHEDULE_FILE'length = 0 ) then
+            return rv;
+        end if;
+
+        file_open(status, f, HOST_SCHEDULE_FILE, READ_MODE);
+        assert status = OPEN_OK
+            report "Could not open host schedule: " & HOST_SCHEDULE_FILE
+            severity failure;
+
+        while not endfile(f) loop
+            readline(f, l);
+            read(l, idx, ok);
+            if( ok ) then
+                read(l, stall, ok);
+                if( ok and idx >= 0 and idx < HOST_NUM_BUFFERS and stall >= 0 ) then
+                    rv(idx) := stall;
+                end if;
+            end if;
+        end loop;
+
+        file_close(f);
+        return rv;
+    end function;
+
+begin
+
+    assert (HOST_BUFFER_SIZE mod HOST_BLOCK_SIZE) = 0
+        report "HOST_BUFFER_SIZE must be a multiple of HOST_BLOCK_SIZE"
+        severity failure;
+
+    -- DCLK which isn't used
+    fx3_ctl(9) <= '0';
+
+    fx3_ctl(3 downto 0) <= (others => 'Z');
+
+    -- Create a 100MHz clock output
+    fx3_pclk <= not fx3_pclk after PCLK_HALF_PERIOD when not rx_done else '0';
+
+    -- Doneness
+    done <= rx_done;
+
+    -- Moves blocks from the GPIF into host transfers
+    rx_dma : process
+        file     capture    : byte_file_t;
+        variable word       : std_logic_vector(31 downto 0);
+        variable filled     : natural := 0;
+        variable words      : natural := 0;
+        variable req_time   : time;
+        variable max_delay  : time    := 0 ns;
+        variable starved    : natural := 0;
+    begin
+        dma0_rx_reqx    <= '1';
+        dma1_rx_reqx    <= '1';
+        dma2_tx_reqx    <= '1';
+        dma3_tx_reqx    <= '1';
+        dma_rx_enable   <= '0';
+        dma_tx_enable   <= '0';
+
+        file_open(capture, HOST_CAPTURE_FILE, WRITE_MODE);
+
+        wait until rising_edge(fx3_pclk) and system_reset = '0';
+
+        nop(fx3_pclk, 1000);
+
+        wait until rising_edge(fx3_pclk) and fx3_rx_en = '1';
+
+        dma_rx_enable <= '1';
+
+        while filled < HOST_NUM_BUFFERS loop
+            -- No transfers available: the host has fallen behind
+            if( filled - buffers_consumed >= HOST_NUM_TRANSFERS ) then
+                starved := starved + 1;
+                wait until filled - buffers_consumed < HOST_NUM_TRANSFERS;
+                wait until rising_edge(fx3_pclk);
+            end if;
+
+            dma0_rx_reqx    <= '0';
+            req_time        := now;
+            wait until rising_edge( fx3_pclk ) and dma0_rx_ack = '1';
+            wait until rising_edge( fx3_pclk );
+            dma0_rx_reqx    <= '1';
+
+            if( now - req_time > max_delay ) then
+                max_delay := now - req_time;
+            end if;
+
+            for i in 1 to HOST_BLOCK_SIZE loop
+                word := fx3_gpif;
+                for b in 0 to 3 loop
+                    write(capture, character'val(to_integer(unsigned(word(8*b+7 downto 8*b)))));
+                end loop;
+                wait until rising_edge( fx3_pclk );
+            end loop;
+
+            words := words + HOST_BLOCK_SIZE;
+            if( words = HOST_BUFFER_SIZE ) then
+                words          := 0;
+                filled         := filled + 1;
+                buffers_filled <= filled;
+            end if;
+        end loop;
+
+        dma_rx_enable <= '0';
+        file_close(capture);
+
+        report "RX DMA done: " & to_string(filled) & " buffers, " &
+               to_string(starved) & " waits for a free transfer, " &
+               "max DMA request delay " & to_string(max_delay);
+        wait;
+    end process;
+
+    -- Consumes filled buffers, as the libbladeRF sync interface would
+    host_consumer : process
+        variable stalls     : stall_array_t(0 to HOST_NUM_BUFFERS-1) := read_schedule;
+        variable consumed   : natural := 0;
+    begin
+        wait until buffers_filled > consumed;
+
+        if( HOST_BUFFER_NS > 0 ) then
+            wait for HOST_BUFFER_NS * 1 ns;
+        end if;
+
+        if( stalls(consumed) > 0 ) then
+            report "Host stalling for " & to_string(stalls(consumed)) &
+                   " us on buffer " & to_string(consumed);
+            wait for stalls(consumed) * 1 us;
+        end if;
+
+        consumed         := consumed + 1;
+        buffers_consumed <= consumed;
+
+        if( consumed = HOST_NUM_BUFFERS ) then
+            report "Host done with " & to_string(consumed) & " buffers";
+            rx_done <= true;
+            wait;
+        end if;
+    end process;
+
+    reset_system : process
+    begin
+        system_reset <= '1';
+        dma_idle <= '0';
+        nop( fx3_pclk, 100 );
+        system_reset <= '0';
+        nop( fx3_pclk, 10 );
+        dma_idle <= '1';
+        wait;
+    end process;
+
+    fx3_uart_txd <= '1';
+    fx3_uart_cts <= '1';
+
+end architecture host;
@@ -0,0 +1,432 @@
+-- Copyright (c) 2019 Nuand LLC
+--
+-- Permission is hereby granted, free of charge, to any person obtaining a copy
+-- of this software and associated documentation files (the "Software"), to deal
+-- in the Software without restriction, including without limitation the rights
+-- to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+-- copies of the Software, and to permit persons to whom the Software is
+-- furnished to do so, subject to the following conditions:
+--
+-- The above copyright notice and this permission notice shall be included in
+-- all copies or substantial portions of the Software.
+--
+-- THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+-- IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+-- FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+-- AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+-- LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+-- OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+-- THE SOFTWARE.
+
+-- RX co-simulation testbench
+--
+-- Streams a timestamped counter through fifo_writer, the RX sample and meta
+-- FIFOs, and fx3_gpif into the "host" model of the FX3, which captures the
+-- resulting USB byte stream to a file. The capture is then checked on the host
+-- side by libbladeRF_test_rx_cosim, which plays it back through libbladeRF's
+-- replay backend and sync interface, reports overruns, and verifies that every
+-- timestamp matches the samples that follow it.
+--
+-- All of the interesting parameters are generics, so that FIFO depths and
+-- host buffer configurations may be swept from the command line. See
+-- rx_cosim_tb.sh (GHDL) and rx_cosim_tb.do (ModelSim).
+--
+-- Sample (I, Q) at timestamp t is (t mod 2048, -(t mod 2048)) on every channel.
+
+library ieee;
+    use ieee.std_logic_1164.all;
+    use ieee.numeric_std.all;
+
+library work;
+    use work.util.all;
+    use work.fifo_readwrite_p.all;
+    use work.common_dcfifo_p.all;
+
+library std;
+    use std.env.all;
+
+entity rx_cosim_tb is
+    generic (
+        -- FPGA configuration
+        NUM_STREAMS         : natural := 2;
+        ENABLE_CHANNEL_1    : boolean := false;
+        SAMPLE_RATE_HZ      : natural := 30720000;
+        USB2                : boolean := false;
+        META_ENABLE         : boolean := true;
+        SAMPLE_FIFO_DEPTH   : natural := 4096;  -- Write-side words
+        META_FIFO_DEPTH     : natural := 32;
+        OVERFLOW_DURATION   : natural := 16#ffff#;
+
+        -- Host configuration (see fx3_model(host))
+        BUFFER_SIZE         : natural := 8192;  -- Samples (32-bit words)
+        NUM_TRANSFERS       : natural := 8;
+        NUM_BUFFERS         : natural := 64;
+        HOST_BUFFER_NS      : natural := 0;
+        SCHEDULE_FILE       : string  := "";
+        CAPTURE_FILE        : string  := "rx_cosim.bin"
+    );
+end entity;
+
+architecture arch of rx_cosim_tb is
+
+    -- rx_clock runs at twice the sample rate, as on bladeRF 2.0 micro
+    constant RX_HALF_PERIOD     : time      := 1 sec / (4.0 * real(SAMPLE_RATE_HZ));
+
+    -- For reasons unknown, simulation of this system in ModelSim requires that
+    -- wrreq and data be asserted shortly before the rising clock edge. Sigh...
+    constant FIFO_WORKAROUND    : time      := 1 ps;
+
+    constant GPIF_BLOCK_SIZE    : natural   := 512 / (1 + boolean'pos(USB2));
+
+    type fifo_t is record
+        aclr    :   std_logic;
+
+        wclock  :   std_logic;
+        wdata   :   std_logic_vector;
+        wreq    :   std_logic;
+        wempty  :   std_logic;
+        wfull   :   std_logic;
+        wused   :   std_logic_vector;
+
+        rclock  :   std_logic;
+        rdata   :   std_logic_vector;
+        rreq    :   std_logic;
+        rempty  :   std_logic;
+        rfull   :   std_logic;
+        rused   :   std_logic_vector;
+    end record;
+
+    signal rx_sample_fifo   :   fifo_t(
+                                    wdata(((NUM_STREAMS*32)-1) downto 0),
+                                    rdata( 31 downto 0), -- GPIF side is always 32 bits
+                                    rused(compute_rdusedw_high(SAMPLE_FIFO_DEPTH,(NUM_STREAMS*32),32,"OFF") downto 0),
+                                    wused(compute_wrusedw_high(SAMPLE_FIFO_DEPTH,"OFF") downto 0)
+                                );
+
+    signal rx_meta_fifo     :   fifo_t(
+                                    wdata(127 downto 0),
+                                    rdata( 31 downto 0),
+                                    rused(compute_rdusedw_high(META_FIFO_DEPTH,128,32,"OFF") downto 0),
+                                    wused(compute_wrusedw_high(META_FIFO_DEPTH,"OFF") downto 0)
+                                );
+
+    -- The TX side of fx3_gpif is unused
+    signal tx_fifo_usedw    :   std_logic_vector(11 downto 0) := (others => '0');
+    signal tx_meta_usedw    :   std_logic_vector( 4 downto 0) := (others => '0');
+
+    signal reset            :   std_logic   := '1';
+    signal done             :   boolean     := false;
+
+    signal fx3_pclk         :   std_logic   := '1';
+    signal rx_clock         :   std_logic   := '1';
+
+    signal fx3_gpif_i       :   std_logic_vector(31 downto 0);
+    signal fx3_ctl_i        :   std_logic_vector(12 downto 0);
+    signal gpif_in          :   std_logic_vector(31 downto 0);
+    signal gpif_out         :   std_logic_vector(31 downto 0);
+    signal gpif_oe          :   std_logic;
+    signal ctl_out          :   std_logic_vector(12 downto 0);
+    signal ctl_oe           :   std_logic_vector(12 downto 0);
+
+    signal usb_speed        :   std_logic;
+    signal meta_en          :   std_logic;
+    signal rx_enable        :   std_logic;
+    signal rx_enable_sync   :   std_logic   := '0';
+
+    signal rx_timestamp     :   unsigned(63 downto 0) := (others => '0');
+    signal adc_controls     :   sample_controls_t(0 to NUM_STREAMS-1) := (others => SAMPLE_CONTROL_DISABLE);
+    signal adc_streams      :   sample_streams_t(adc_controls'range)  := (others => ZERO_SAMPLE);
+
+    signal overflow_led     :   std_logic;
+    signal overflow_count   :   unsigned(63 downto 0);
+
+    signal sample_fifo_max      :   natural := 0;
+    signal meta_fifo_max        :   natural := 0;
+    signal overflow_led_cycles  :   natural := 0;
+
+begin
+
+    usb_speed <= '1' when USB2 else '0';
+    meta_en   <= '1' when META_ENABLE else '0';
+
+    -- Reset handler
+    reset <= '0' after 100 ns;
+
+    -- Clock creation
+    rx_clock <= not rx_clock after RX_HALF_PERIOD when not done else '0';
+
+    -- ========================================================================
+    -- Samples
+    -- ========================================================================
+
+    gen_adc_controls : for i in adc_controls'range generate
+        adc_controls(i) <= SAMPLE_CONTROL_ENABLE when (i = 0 or ENABLE_CHANNEL_1)
+                           else SAMPLE_CONTROL_DISABLE;
+    end generate;
+
+    -- One sample every other rx_clock, with its timestamp
+    gen_samples : process( rx_clock, reset )
+        variable ts   : unsigned(63 downto 0) := (others => '0');
+        variable ping : boolean := false;
+        variable v    : signed(15 downto 0);
+    begin
+        if( reset = '1' ) then
+            ts           := (others => '0');
+            ping         := false;
+            rx_timestamp <= (others => '0');
+            adc_streams  <= (others => ZERO_SAMPLE);
+        elsif( rising_edge(rx_clock) ) then
+            ping := not ping;
+
+            for i in adc_streams'range loop
+                adc_streams(i).data_v <= '0';
+            end loop;
+
+            if( ping ) then
+                v := resize(signed('0' & ts(10 downto 0)), v'length);
+                for i in adc_streams'range loop
+                    adc_streams(i).data_i <= v;
+                    adc_streams(i).data_q <= -v;
+                    adc_streams(i).data_v <= '1';
+                end loop;
+                rx_timestamp <= ts;
+                ts := ts + 1;
+            end if;
+        end if;
+    end process;
+
+    sync_rx_enable : entity work.synchronizer
+        generic map (
+            RESET_LEVEL =>  '0'
+        )
+        port map (
+            reset       =>  reset,
+            clock       =>  rx_clock,
+            async       =>  rx_enable,
+            sync        =>  rx_enable_sync
+        );
+
+    -- ========================================================================
+    -- FPGA RX path
+    -- ========================================================================
+
+    U_fifo_writer : entity work.fifo_writer
+        generic map (
+            NUM_STREAMS           => NUM_STREAMS,
+            FIFO_USEDW_WIDTH      => rx_sample_fifo.wused'length,
+            FIFO_DATA_WIDTH       => rx_sample_fifo.wdata'length,
+            META_FIFO_USEDW_WIDTH => rx_meta_fifo.wused'length,
+            META_FIFO_DATA_WIDTH  => rx_meta_fifo.wdata'length
+        )
+        port map (
+            clock               =>  rx_clock,
+            reset               =>  reset,
+            enable              =>  rx_enable_sync,
+
+            usb_speed           =>  usb_speed,
+            meta_en             =>  meta_en,
+            timestamp           =>  rx_timestamp,
+            mini_exp            =>  "00",
+
+            fifo_full           =>  rx_sample_fifo.wfull,
+            fifo_usedw          =>  rx_sample_fifo.wused,
+            fifo_data           =>  rx_sample_fifo.wdata,
+            fifo_write          =>  rx_sample_fifo.wreq,
+
+            meta_fifo_full      =>  rx_meta_fifo.wfull,
+            meta_fifo_usedw     =>  rx_meta_fifo.wused,
+            meta_fifo_data      =>  rx_meta_fifo.wdata,
+            meta_fifo_write     =>  rx_meta_fifo.wreq,
+
+            in_sample_controls  =>  adc_controls,
+            in_samples          =>  adc_streams,
+
+            overflow_led        =>  overflow_led,
+            overflow_count      =>  overflow_count,
+            overflow_duration   =>  to_unsigned(OVERFLOW_DURATION, 16)
+        );
+
+    rx_sample_fifo.aclr   <= reset or not rx_enable;
+    rx_sample_fifo.wclock <= rx_clock after FIFO_WORKAROUND; -- simulation workaround
+    rx_sample_fifo.rclock <= fx3_pclk;
+    U_rx_sample_fifo : entity work.rx_fifo
+        generic map (
+            LPM_NUMWORDS        => SAMPLE_FIFO_DEPTH,
+            LPM_WIDTH           => rx_sample_fifo.wdata'length,
+            LPM_WIDTH_R         => rx_sample_fifo.rdata'length
+        )
+        port map (
+            aclr                => rx_sample_fifo.aclr,
+
+            wrclk               => rx_sample_fifo.wclock,
+            wrreq               => rx_sample_fifo.wreq,
+            data                => rx_sample_fifo.wdata,
+            wrempty             => rx_sample_fifo.wempty,
+            wrfull              => rx_sample_fifo.wfull,
+            wrusedw             => rx_sample_fifo.wused,
+
+            rdclk               => rx_sample_fifo.rclock,
+            rdreq               => rx_sample_fifo.rreq,
+            q                   => rx_sample_fifo.rdata,
+            rdempty             => rx_sample_fifo.rempty,
+            rdfull              => rx_sample_fifo.rfull,
+            rdusedw             => rx_sample_fifo.rused
+        );
+
+    rx_meta_fifo.aclr   <= reset or not rx_enable;
+    rx_meta_fifo.wclock <= rx_clock after FIFO_WORKAROUND; -- simulation workaround
+    rx_meta_fifo.rclock <= fx3_pclk;
+    U_rx_meta_fifo : entity work.rx_meta_fifo
+        generic map (
+            LPM_NUMWORDS        => META_FIFO_DEPTH
+        )
+        port map (
+            aclr                => rx_meta_fifo.aclr,
+
+            wrclk               => rx_meta_fifo.wclock,
+            wrreq               => rx_meta_fifo.wreq,
+            data                => rx_meta_fifo.wdata,
+            wrempty             => rx_meta_fifo.wempty,
+            wrfull              => rx_meta_fifo.wfull,
+            wrusedw             => rx_meta_fifo.wused,
+
+            rdclk               => rx_meta_fifo.rclock,
+            rdreq               => rx_meta_fifo.rreq,
+            q                   => rx_meta_fifo.rdata,
+            rdempty             => rx_meta_fifo.rempty,
+            rdfull              => rx_meta_fifo.rfull,
+            rdusedw             => rx_meta_fifo.rused
+        );
+
+    -- The hardware phase-shifts pclk with a PLL, which is of no consequence
+    -- here, so fx3_gpif runs directly from the model's clock.
+    U_fx3_gpif : entity work.fx3_gpif
+        port map (
+            pclk                => fx3_pclk,
+            reset               => reset,
+            usb_speed           => usb_speed,
+            gpif_in             => gpif_in,
+            gpif_out            => gpif_out,
+            gpif_oe             => gpif_oe,
+            ctl_in              => fx3_ctl_i,
+            ctl_out             => ctl_out,
+            ctl_oe              => ctl_oe,
+            tx_enable           => open,
+            rx_enable           => rx_enable,
+            meta_enable         => meta_en,
+            tx_fifo_write       => open,
+            tx_fifo_full        => '0',
+            tx_fifo_empty       => '1',
+            tx_fifo_usedw       => tx_fifo_usedw,
+            tx_fifo_data        => open,
+            tx_timestamp        => (others => '0'),
+            tx_meta_fifo_write  => open,
+            tx_meta_fifo_full   => '0',
+            tx_meta_fifo_empty  => '1',
+            tx_meta_fifo_usedw  => tx_meta_usedw,
+            tx_meta_fifo_data   => open,
+            rx_fifo_read        => rx_sample_fifo.rreq,
+            rx_fifo_full        => rx_sample_fifo.rfull,
+            rx_fifo_empty       => rx_sample_fifo.rempty,
+            rx_fifo_usedw       => rx_sample_fifo.rused,
+            rx_fifo_data        => rx_sample_fifo.rdata,
+            rx_meta_fifo_read   => rx_meta_fifo.rreq,
+            rx_meta_fifo_full   => rx_meta_fifo.rfull,
+            rx_meta_fifo_empty  => rx_meta_fifo.rempty,
+            rx_meta_fifo_usedr  => rx_meta_fifo.rused,
+            rx_meta_fifo_data   => rx_meta_fifo.rdata
+        );
+
+    -- FX3 GPIF bidirectional signal control
+    -- Adapted from same process in bladerf-hosted.vhd
+    register_gpif : process( reset, fx3_pclk )
+    begin
+        if( reset = '1' ) then
+            fx3_gpif_i  <= (others => 'Z');
+            gpif_in     <= (others => 'Z');
+        elsif( rising_edge(fx3_pclk) ) then
+            gpif_in     <= fx3_gpif_i;
+
+            if( gpif_oe = '1' ) then
+                fx3_gpif_i  <= gpif_out;
+            else
+                fx3_gpif_i  <= (others => 'Z');
+            end if;
+        end if;
+    end process;
+
+    -- FX3 CTL bidirectional signals
+    -- Adapted from same generator in bladerf-hosted.vhd
+    generate_ctl : for i in fx3_ctl_i'range generate
+        fx3_ctl_i(i) <= ctl_out(i) when ctl_oe(i) = '1' else 'Z';
+    end generate;
+
+    -- ========================================================================
+    -- FX3 and host
+    -- ========================================================================
+
+    U_fx3_model : entity work.fx3_model(host)
+        generic map (
+            HOST_BLOCK_SIZE     => GPIF_BLOCK_SIZE,
+            HOST_BUFFER_SIZE    => BUFFER_SIZE,
+            HOST_NUM_TRANSFERS  => NUM_TRANSFERS,
+            HOST_NUM_BUFFERS    => NUM_BUFFERS,
+            HOST_BUFFER_NS      => HOST_BUFFER_NS,
+            HOST_SCHEDULE_FILE  => SCHEDULE_FILE,
+            HOST_CAPTURE_FILE   => CAPTURE_FILE
+        )
+        port map (
+            fx3_pclk            => fx3_pclk,
+            fx3_gpif            => fx3_gpif_i,
+            fx3_ctl             => fx3_ctl_i,
+            fx3_uart_rxd        => '0',
+            fx3_uart_txd        => open,
+            fx3_uart_cts        => open,
+            fx3_rx_en           => '1',
+            fx3_rx_meta_en      => meta_en,
+            fx3_tx_en           => '0',
+            fx3_tx_meta_en      => '0',
+            done                => done
+        );
+
+    -- ========================================================================
+    -- Statistics
+    -- ========================================================================
+
+    -- FIFO high-water marks and overflow LED time, for sizing the FIFOs and
+    -- choosing overflow_duration
+    stats : process( rx_clock )
+        variable used : natural;
+    begin
+        if( rising_edge(rx_clock) ) then
+            used := to_integer(unsigned(rx_sample_fifo.wfull & rx_sample_fifo.wused));
+            if( used > sample_fifo_max ) then
+                sample_fifo_max <= used;
+            end if;
+
+            used := to_integer(unsigned(rx_meta_fifo.wfull & rx_meta_fifo.wused));
+            if( used > meta_fifo_max ) then
+                meta_fifo_max <= used;
+            end if;
+
+            if( overflow_led = '1' ) then
+                overflow_led_cycles <= overflow_led_cycles + 1;
+            end if;
+        end if;
+    end process;
+
+    report_stats : process
+    begin
+        wait until done;
+        report "Sample FIFO high-water mark: " & to_string(sample_fifo_max) &
+               " / " & to_string(SAMPLE_FIFO_DEPTH);
+        report "Meta FIFO high-water mark: " & to_string(meta_fifo_max) &
+               " / " & to_string(META_FIFO_DEPTH);
+        report "Overflows: " & to_string(to_integer(overflow_count)) &
+               ", overflow LED asserted for " & to_string(overflow_led_cycles) &
+               " rx_clock cycles";
+        report "Capture written to " & CAPTURE_FILE;
+        finish;
+    end process;
+
+end architecture;
@@ -0,0 +1,386 @@
+-- Copyright (c) 2026 Nuand LLC
+--
+-- Permission is hereby granted, free of charge, to any person obtaining a copy
+-- of this software and associated documentation files (the "Software"), to deal
+-- in the Software without restriction, including without limitation the rights
+-- to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+-- copies of the Software, and to permit persons to whom the Software is
+-- furnished to do so, subject to the following conditions:
+--
+-- The above copyright notice and this permission notice shall be included in
+-- all copies or substantial portions of the Software.
+--
+-- THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+-- IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+-- FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+-- AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+-- LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+-- OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+-- THE SOFTWARE.
+
+-- Sample packing testbench
+--
+-- For each pack mode, streams two bursts of a 12-bit test pattern through
+-- fifo_writer and checks every FIFO word it produces bit-for-bit against the
+-- expected LSB-first concatenation of packed pairs. The captured words are
+-- then played back through fifo_reader, whose output must reproduce the
+-- (reduced) samples in order.
+--
+-- BURST_LENGTH is chosen such that SC12 and SC8 bursts do not end on a FIFO
+-- word boundary, which exercises the partial word at the end of a burst:
+--   - fifo_writer must not emit the trailing partial word, and must discard
+--     it when disabled, so that the second burst starts word-aligned.
+--   - fifo_reader must not emit a sample for a partial pair at the end of
+--     the last word, and must likewise start the second burst aligned.
+--
+-- All channels are enabled, so the FIFO word width must be 32 bits per
+-- stream. The testbench finishes on its own; any mismatch is a failure.
+
+library ieee;
+    use ieee.std_logic_1164.all;
+    use ieee.numeric_std.all;
+
+library nuand;
+    use nuand.fifo_readwrite_p.all;
+
+library std;
+    use std.env.all;
+
+entity sample_pack_tb is
+    generic (
+        -- For bladeRF (SISO):
+        NUM_STREAMS         : natural := 1;
+        FIFO_DATA_WIDTH     : natural := 32;
+        FIFO_READ_THROTTLE  : natural := 1;
+
+        -- For bladeRF2 (2x2 MIMO):
+        --NUM_STREAMS        : natural := 2;
+        --FIFO_DATA_WIDTH    : natural := 64;
+        --FIFO_READ_THROTTLE : natural := 0;
+
+        -- Pairs per channel in each burst
+        BURST_LENGTH        : natural := 1003
+    );
+end entity;
+
+architecture arch of sample_pack_tb is
+
+    constant CLOCK_HALF_PERIOD : time := 1.0/(80.0e6)/2.0*1 sec;
+
+    constant DW        : natural := FIFO_DATA_WIDTH;
+    constant MAX_WORDS : natural := BURST_LENGTH * NUM_STREAMS * 32 / DW;
+
+    type word_array_t is array( natural range <> ) of std_logic_vector(DW-1 downto 0);
+    type count_array_t is array( natural range <> ) of natural;
+
+    signal clock        : std_logic := '1';
+    signal reset        : std_logic := '1';
+
+    signal pack_mode    : pack_mode_t := PACK_MODE_SC16;
+
+    -- fifo_writer
+    signal w_enable     : std_logic := '0';
+    signal w_controls   : sample_controls_t(0 to NUM_STREAMS-1) := (others => SAMPLE_CONTROL_ENABLE);
+    signal w_samples    : sample_streams_t(0 to NUM_STREAMS-1)  := (others => ZERO_SAMPLE);
+    signal w_fifo_clear : std_logic;
+    signal w_fifo_write : std_logic;
+    signal w_fifo_data  : std_logic_vector(DW-1 downto 0);
+    signal w_meta_data  : std_logic_vector(127 downto 0);
+    signal w_meta_write : std_logic;
+    signal w_ovf_led    : std_logic;
+    signal w_ovf_count  : unsigned(63 downto 0);
+
+    -- fifo_reader
+    signal r_enable     : std_logic := '0';
+    signal r_controls   : sample_controls_t(0 to NUM_STREAMS-1) := (others => SAMPLE_CONTROL_ENABLE);
+    signal r_samples    : sample_streams_t(0 to NUM_STREAMS-1);
+    signal r_fifo_read  : std_logic;
+    signal r_fifo_empty : std_logic := '1';
+    signal r_fifo_data  : std_logic_vector(DW-1 downto 0) := (others => '0');
+    signal r_meta_read  : std_logic;
+    signal r_unf_led    : std_logic;
+    signal r_unf_count  : unsigned(63 downto 0);
+
+    -- Test pattern: 12-bit I and Q for pair n of channel ch, covering every
+    -- code and both signs
+    function pattern( n : natural; ch : natural ) return std_logic_vector is
+        variable i : integer;
+        variable q : integer;
+    begin
+        i := ((n*37 + ch*1024 + 5) mod 4096) - 2048;
+        q := ((n*91 + ch*2048 + 3000) mod 4096) - 2048;
+        return std_logic_vector(resize(to_signed(q, 12), 16)) &
+               std_logic_vector(resize(to_signed(i, 12), 16));
+    end function;
+
+begin
+
+    clock <= not clock after CLOCK_HALF_PERIOD;
+
+    assert (DW = 32 * NUM_STREAMS)
+        report "FIFO_DATA_WIDTH must be 32 bits per stream"
+        severity failure;
+
+    U_fifo_writer : entity nuand.fifo_writer
+      generic map (
+        NUM_STREAMS           => NUM_STREAMS,
+        FIFO_USEDW_WIDTH      => 12,
+        FIFO_DATA_WIDTH       => DW,
+        META_FIFO_USEDW_WIDTH => 5,
+        META_FIFO_DATA_WIDTH  => 128
+      )
+      port map (
+        clock               => clock,
+        reset               => reset,
+        enable              => w_enable,
+
+        usb_speed           => '0',
+        meta_en             => '0',
+        timestamp           => (others => '0'),
+        mini_exp            => (others => '0'),
+        pack_mode           => pack_mode,
+
+        in_sample_controls  => w_controls,
+        in_samples          => w_samples,
+
+        fifo_usedw          => (others => '0'),
+        fifo_clear          => w_fifo_clear,
+        fifo_write          => w_fifo_write,
+        fifo_full           => '0',
+        fifo_data           => w_fifo_data,
+
+        meta_fifo_full      => '0',
+        meta_fifo_usedw     => (others => '0'),
+        meta_fifo_data      => w_meta_data,
+        meta_fifo_write     => w_meta_write,
+
+        overflow_led        => w_ovf_led,
+        overflow_count      => w_ovf_count,
+        overflow_duration   => (others => '1')
+      );
+
+    U_fifo_reader : entity nuand.fifo_reader
+      generic map (
+        NUM_STREAMS           => NUM_STREAMS,
+        FIFO_READ_THROTTLE    => FIFO_READ_THROTTLE,
+        FIFO_USEDW_WIDTH      => 12,
+        FIFO_DATA_WIDTH       => DW,
+        META_FIFO_USEDW_WIDTH => 3,
+        META_FIFO_DATA_WIDTH  => 128
+      )
+      port map (
+        clock               => clock,
+        reset               => reset,
+        enable              => r_enable,
+
+        usb_speed           => '0',
+        meta_en             => '0',
+        timestamp           => (others => '0'),
+        pack_mode           => pack_mode,
+
+        fifo_usedw          => (others => '0'),
+        fifo_read           => r_fifo_read,
+        fifo_empty          => r_fifo_empty,
+        fifo_data           => r_fifo_data,
+        fifo_holdoff        => '0',
+
+        meta_fifo_usedw     => (others => '0'),
+        meta_fifo_read      => r_meta_read,
+        meta_fifo_empty     => '1',
+        meta_fifo_data      => (others => '0'),
+
+        in_sample_controls  => r_controls,
+        out_samples         => r_samples,
+
+        underflow_led       => r_unf_led,
+        underflow_count     => r_unf_count,
+        underflow_duration  => (others => '1')
+      );
+
+    -- Request a sample every other clock, as the RFIC interfaces do
+    drive_data_req : process( clock )
+    begin
+        if( rising_edge(clock) ) then
+            for ch in r_controls'range loop
+                r_controls(ch).data_req <= not r_controls(ch).data_req;
+            end loop;
+        end if;
+    end process;
+
+    tb : process
+        variable words    : word_array_t(0 to MAX_WORDS-1);
+        variable nwords   : natural := 0;
+        variable rd_ptr   : natural := 0;
+        variable rd_count : natural := 0;
+        variable rx_base  : natural := 0;
+        variable rx_mode  : pack_mode_t := PACK_MODE_SC16;
+        variable rx_count : count_array_t(0 to NUM_STREAMS-1) := (others => 0);
+
+        -- Advance one clock, capturing fifo_writer output, modeling a
+        -- show-ahead FIFO in front of fifo_reader, and checking its output
+        procedure tick is
+            variable expect : std_logic_vector(31 downto 0);
+        begin
+            wait until rising_edge(clock);
+
+            if( w_fifo_write = '1' ) then
+                assert nwords < MAX_WORDS
+                    report "fifo_writer wrote too many words"
+                    severity failure;
+                words(nwords) := w_fifo_data;
+                nwords := nwords + 1;
+            end if;
+
+            if( r_fifo_read = '1' ) then
+                assert rd_ptr < rd_count
+                    report "fifo_reader read from an empty FIFO"
+                    severity failure;
+                rd_ptr := rd_ptr + 1;
+            end if;
+
+            if( rd_ptr < rd_count ) then
+                r_fifo_empty <= '0';
+                r_fifo_data  <= words(rd_ptr);
+            else
+                r_fifo_empty <= '1';
+            end if;
+
+            for ch in r_samples'range loop
+                if( r_samples(ch).data_v = '1' ) then
+                    expect := unpack_sample(pack_sample(pattern(rx_base + rx_count(ch), ch), rx_mode), rx_mode);
+                    assert (std_logic_vector(r_samples(ch).data_q) & std_logic_vector(r_samples(ch).data_i)) = expect
+                        report "fifo_reader: channel " & to_string(ch) & " sample " &
+                               to_string(rx_count(ch)) & " mismatch"
+                        severity failure;
+                    rx_count(ch) := rx_count(ch) + 1;
+                end if;
+            end loop;
+        end procedure;
+
+        procedure nop( count : natural ) is
+        begin
+            for i in 1 to count loop
+                tick;
+            end loop;
+        end procedure;
+
+        -- Stream BURST_LENGTH pairs per channel, starting at pattern index
+        -- base, through fifo_writer and check the words it writes
+        procedure write_burst( mode : pack_mode_t; base : natural ) is
+            constant BITS   : natural := packed_sample_bits(mode);
+            constant EXPECT : natural := (BURST_LENGTH * NUM_STREAMS * BITS) / DW;
+            variable sent   : natural := 0;
+            variable k      : natural;
+            variable p      : std_logic_vector(31 downto 0);
+            variable b      : natural;
+        begin
+            -- Disabling latches the mode and must discard any residue
+            w_enable  <= '0';
+            pack_mode <= mode;
+            nop(4);
+            w_enable  <= '1';
+            nop(4);
+
+            nwords := 0;
+            while sent < BURST_LENGTH loop
+                -- Present a sample every other clock
+                for ch in w_samples'range loop
+                    w_samples(ch).data_q <= signed(pattern(base + sent, ch)(31 downto 16));
+                    w_samples(ch).data_i <= signed(pattern(base + sent, ch)(15 downto 0));
+                    w_samples(ch).data_v <= '1';
+                end loop;
+                tick;
+                for ch in w_samples'range loop
+                    w_samples(ch).data_v <= '0';
+                end loop;
+                tick;
+                sent := sent + 1;
+            end loop;
+
+            nop(16);
+            w_enable <= '0';
+            nop(4);
+
+            assert nwords = EXPECT
+                report "fifo_writer: expected " & to_string(EXPECT) & " words, got " &
+                       to_string(nwords)
+                severity failure;
+
+            -- Pair k of the burst occupies bits [k*BITS, (k+1)*BITS) of the
+            -- concatenated words. Pairs that straddle the end are not written.
+            k := 0;
+            while (k+1)*BITS <= nwords*DW loop
+                p := pack_sample(pattern(base + k / NUM_STREAMS, k mod NUM_STREAMS), mode);
+                for j in 0 to BITS-1 loop
+                    b := k*BITS + j;
+                    assert words(b / DW)(b mod DW) = p(j)
+                        report "fifo_writer: pair " & to_string(k) & " bit " & to_string(j) &
+                               " mismatch"
+                        severity failure;
+                end loop;
+                k := k + 1;
+            end loop;
+        end procedure;
+
+        -- Play back the words captured by write_burst() through fifo_reader
+        -- and check that every whole pair comes out, and nothing else
+        procedure read_burst( mode : pack_mode_t; base : natural ) is
+            constant BITS   : natural := packed_sample_bits(mode);
+            constant PER_RD : natural := (DW/32) * BITS;
+            constant EXPECT : natural := ((nwords * DW) / PER_RD) * (DW/32) / NUM_STREAMS;
+        begin
+            r_enable  <= '0';
+            pack_mode <= mode;
+            nop(4);
+
+            rx_mode  := mode;
+            rx_base  := base;
+            rx_count := (others => 0);
+            rd_ptr   := 0;
+            rd_count := nwords;
+
+            r_enable <= '1';
+            nop(8 * nwords * (FIFO_READ_THROTTLE + 1) + 64);
+
+            assert rd_ptr = rd_count
+                report "fifo_reader: read " & to_string(rd_ptr) & " of " &
+                       to_string(rd_count) & " words"
+                severity failure;
+
+            for ch in rx_count'range loop
+                assert rx_count(ch) = EXPECT
+                    report "fifo_reader: channel " & to_string(ch) & " expected " &
+                           to_string(EXPECT) & " samples, got " & to_string(rx_count(ch))
+                    severity failure;
+            end loop;
+
+            r_enable <= '0';
+            rd_count := 0;
+            rd_ptr   := 0;
+            nop(4);
+        end procedure;
+
+        type mode_array_t is array( natural range <> ) of pack_mode_t;
+        constant MODES : mode_array_t := (PACK_MODE_SC16, PACK_MODE_SC12, PACK_MODE_SC8);
+
+    begin
+        reset <= '1';
+        nop(10);
+        reset <= '0';
+        nop(10);
+
+        for m in MODES'range loop
+            -- The second burst starts at a different pattern index, so that a
+            -- leftover partial word from the first would be caught
+            write_burst(MODES(m), 0);
+            read_burst(MODES(m), 0);
+            write_burst(MODES(m), 5000);
+            read_burst(MODES(m), 5000);
+            report "Mode " & to_string(MODES(m)) & " passed";
+        end loop;
+
+        report "Sample packing testbench passed";
+        finish;
+    end process;
+
+end architecture;
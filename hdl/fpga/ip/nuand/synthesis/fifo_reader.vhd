@@ -42,6 +42,7 @@ entity fifo_reader is
         usb_speed           :   in      std_logic;
         meta_en             :   in      std_logic;
         timestamp           :   in      unsigned(63 downto 0);
+        pack_mode           :   in      pack_mode_t := PACK_MODE_SC16;
 
         fifo_usedw          :   in      std_logic_vector(FIFO_USEDW_WIDTH-1 downto 0);
         fifo_read           :   buffer  std_logic := '0';
@@ -135,6 +136,19 @@ architecture simple of fifo_reader is
     signal fifo_current : fifo_fsm_t := FIFO_FSM_RESET_VALUE;
     signal fifo_future  : fifo_fsm_t := FIFO_FSM_RESET_VALUE;
 
+    -- Sample FIFO, as seen by the FSM (i.e., after unpacking)
+    signal sample_fifo_read  : std_logic;
+    signal sample_fifo_empty : std_logic;
+    signal sample_fifo_data  : std_logic_vector(fifo_data'range);
+
+    -- Sample unpacker
+    signal pack_mode_r       : pack_mode_t := PACK_MODE_SC16;
+    signal unpack_acc        : unsigned(2*fifo_data'length-1 downto 0) := (others => '0');
+    signal unpack_fill       : natural range 0 to 2*fifo_data'length := 0;
+    signal unpack_read       : std_logic;
+    signal unpack_empty      : std_logic;
+    signal unpack_data       : std_logic_vector(fifo_data'range);
+
 begin
 
     -- Throw compile/synthesis error if things don't make sense
@@ -143,6 +157,10 @@ begin
         report "in_sample_controls must have same range as out_samples"
         severity failure;
 
+    assert (fifo_data'length mod 32 = 0)
+        report "fifo_data port width must be a multiple of 32 bits to support sample packing."
+        severity failure;
+
     -- Determine the DMA buffer size based on USB speed
     calc_buf_size : process( clock, reset )
     begin
@@ -334,7 +352,7 @@ begin
         fifo_future.fifo_read <= '0';
 
         -- MIMO UNPACKER: STEP 1 of 5
-        unpacked := unpack(fifo_current.sample_controls_reg, fifo_data);
+        unpacked := unpack(fifo_current.sample_controls_reg, sample_fifo_data);
         for i in fifo_future.out_samples'range loop
             if( fifo_current.sample_controls_reg(i).enable = '1' ) then
                 fifo_future.out_samples(i) <= unpacked(fifo_current.ch_offsets(i) + fifo_current.ch_shift);
@@ -376,7 +394,7 @@ begin
                     -- Pause for a spell
                     fifo_future.state <= READ_HOLDOFF;
 
-                elsif( fifo_empty = '0' and
+                elsif( sample_fifo_empty = '0' and
                        (meta_en = '0' or (meta_en = '1' and meta_current.meta_time_go = '1')) ) then
 
                     -- Check for valid data request
@@ -438,17 +456,117 @@ begin
             end loop;
         end if;
 
-        if( fifo_empty = '1' ) then
+        if( sample_fifo_empty = '1' ) then
             -- Re-evaluate the MIMO settings
             fifo_future.state <= FIFO_FSM_RESET_VALUE.state;
         end if;
 
         -- Output assignments
-        fifo_read   <= fifo_current.fifo_read;
-        out_samples <= fifo_current.out_samples;
+        sample_fifo_read <= fifo_current.fifo_read;
+        out_samples      <= fifo_current.out_samples;
+
+    end process;
+
 
+    -- ------------------------------------------------------------------------
+    -- SAMPLE UNPACKER
+    -- ------------------------------------------------------------------------
+    -- In PACK_MODE_SC16, the FSM reads the sample FIFO directly. Otherwise,
+    -- the FIFO contains Q & I pairs reduced to 24 or 16 bits and concatenated
+    -- LSB-first, such that pairs may straddle FIFO words (see fifo_writer).
+    -- The FSM is then presented with a show-ahead "virtual FIFO" of 32-bit
+    -- pairs, which is refilled from the sample FIFO whenever there is room
+    -- for another FIFO word.
+    --
+    -- The mode may only change while the reader is disabled. Packed modes
+    -- are not supported in conjunction with metadata, as the meta FSM's DMA
+    -- buffer accounting assumes one FIFO word per sample per channel.
+
+    latch_pack_mode : process( clock, reset )
+    begin
+        if( reset = '1' ) then
+            pack_mode_r <= PACK_MODE_SC16;
+        elsif( rising_edge(clock) ) then
+            if( enable = '0' ) then
+                pack_mode_r <= pack_mode;
+            end if;
+        end if;
     end process;
 
+    unpack_comb : process( all )
+        constant DW   : natural := fifo_data'length;
+        variable bits : natural range 0 to 32;
+        variable need : natural range 0 to DW;
+        variable fill : natural range 0 to 2*DW;
+        variable w    : std_logic_vector(31 downto 0);
+    begin
+        bits := packed_sample_bits(pack_mode_r);
+        need := (DW/32) * bits;
+
+        -- Head of the virtual FIFO
+        for i in 0 to DW/32-1 loop
+            w := std_logic_vector(resize(shift_right(unpack_acc, i*bits), 32));
+            unpack_data(32*i+31 downto 32*i) <= unpack_sample(w, pack_mode_r);
+        end loop;
+
+        if( unpack_fill >= need ) then
+            unpack_empty <= '0';
+        else
+            unpack_empty <= '1';
+        end if;
+
+        -- Bits remaining after this cycle's read from the virtual FIFO
+        fill := unpack_fill;
+        if( sample_fifo_read = '1' and unpack_fill >= need ) then
+            fill := unpack_fill - need;
+        end if;
+
+        if( enable = '1' and pack_mode_r /= PACK_MODE_SC16 and
+            fifo_empty = '0' and fill <= DW ) then
+            unpack_read <= '1';
+        else
+            unpack_read <= '0';
+        end if;
+    end process;
+
+    unpack_sync : process( clock, reset )
+        constant DW   : natural := fifo_data'length;
+        variable need : natural range 0 to DW;
+        variable acc  : unsigned(unpack_acc'range);
+        variable fill : natural range 0 to 2*DW;
+    begin
+        if( reset = '1' ) then
+            unpack_acc  <= (others => '0');
+            unpack_fill <= 0;
+        elsif( rising_edge(clock) ) then
+            need := (DW/32) * packed_sample_bits(pack_mode_r);
+            acc  := unpack_acc;
+            fill := unpack_fill;
+
+            if( enable = '0' ) then
+                acc  := (others => '0');
+                fill := 0;
+            else
+                if( sample_fifo_read = '1' and fill >= need ) then
+                    acc  := shift_right(acc, need);
+                    fill := fill - need;
+                end if;
+
+                if( unpack_read = '1' ) then
+                    acc  := acc or shift_left(resize(unsigned(fifo_data), acc'length), fill);
+                    fill := fill + DW;
+                end if;
+            end if;
+
+            unpack_acc  <= acc;
+            unpack_fill <= fill;
+        end if;
+    end process;
+
+    sample_fifo_data  <= fifo_data        when pack_mode_r = PACK_MODE_SC16 else unpack_data;
+    sample_fifo_empty <= fifo_empty       when pack_mode_r = PACK_MODE_SC16 else unpack_empty;
+    fifo_read         <= sample_fifo_read when pack_mode_r = PACK_MODE_SC16 else unpack_read;
+
 
     -- ------------------------------------------------------------------------
     -- UNDERFLOW
@@ -461,7 +579,7 @@ begin
             underflow_detected <= '0';
         elsif( rising_edge( clock ) ) then
             underflow_detected <= '0';
-            if( enable = '1' and fifo_empty = '1' and
+            if( enable = '1' and sample_fifo_empty = '1' and
                 (meta_en = '0' or (meta_en = '1' and meta_current.meta_time_go = '1')) ) then
                 underflow_detected <= '1';
             end if;
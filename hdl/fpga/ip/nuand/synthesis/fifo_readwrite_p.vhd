@@ -47,6 +47,24 @@ package fifo_readwrite_p is
     -- Count how many channels are enabled
     function count_enabled_channels( x : sample_controls_t ) return natural;
 
+    -- Representation of samples in the sample FIFOs (i.e., over USB). These
+    -- values must match the host's bladerf_wire_format enumeration.
+    subtype pack_mode_t is std_logic_vector(1 downto 0);
+
+    constant PACK_MODE_SC16         : pack_mode_t := "00";  -- 32 bits/sample
+    constant PACK_MODE_SC12         : pack_mode_t := "01";  -- 24 bits/sample
+    constant PACK_MODE_SC8          : pack_mode_t := "10";  -- 16 bits/sample
+
+    -- Number of bits occupied by one I/Q pair in the given mode
+    function packed_sample_bits( mode : pack_mode_t ) return natural;
+
+    -- Reduce a 32-bit Q & I pair (each a sign-extended 12-bit value) to the
+    -- given mode's representation, LSB-aligned and zero-padded
+    function pack_sample( x : std_logic_vector(31 downto 0); mode : pack_mode_t ) return std_logic_vector;
+
+    -- Inverse of pack_sample()
+    function unpack_sample( x : std_logic_vector(31 downto 0); mode : pack_mode_t ) return std_logic_vector;
+
 end package;
 
 package body fifo_readwrite_p is
@@ -81,4 +99,46 @@ package body fifo_readwrite_p is
         return rv;
     end function;
 
+    function packed_sample_bits( mode : pack_mode_t ) return natural is
+    begin
+        case mode is
+            when PACK_MODE_SC12 => return 24;
+            when PACK_MODE_SC8  => return 16;
+            when others         => return 32;
+        end case;
+    end function;
+
+    function pack_sample( x : std_logic_vector(31 downto 0); mode : pack_mode_t ) return std_logic_vector is
+        variable rv : std_logic_vector(31 downto 0) := (others => '0');
+    begin
+        rv := (others => '0');
+        case mode is
+            when PACK_MODE_SC12 =>
+                rv(23 downto 12) := x(27 downto 16);
+                rv(11 downto 0)  := x(11 downto 0);
+            when PACK_MODE_SC8 =>
+                rv(15 downto 8)  := x(27 downto 20);
+                rv(7 downto 0)   := x(11 downto 4);
+            when others =>
+                rv := x;
+        end case;
+        return rv;
+    end function;
+
+    function unpack_sample( x : std_logic_vector(31 downto 0); mode : pack_mode_t ) return std_logic_vector is
+        variable rv : std_logic_vector(31 downto 0) := (others => '0');
+    begin
+        case mode is
+            when PACK_MODE_SC12 =>
+                rv(31 downto 16) := std_logic_vector(resize(signed(x(23 downto 12)), 16));
+                rv(15 downto 0)  := std_logic_vector(resize(signed(x(11 downto 0)), 16));
+            when PACK_MODE_SC8 =>
+                rv(31 downto 16) := std_logic_vector(resize(signed(x(15 downto 8) & "0000"), 16));
+                rv(15 downto 0)  := std_logic_vector(resize(signed(x(7 downto 0) & "0000"), 16));
+            when others =>
+                rv := x;
+        end case;
+        return rv;
+    end function;
+
 end package body;
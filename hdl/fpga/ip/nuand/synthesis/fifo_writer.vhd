@@ -42,6 +42,7 @@ entity fifo_writer is
         meta_en             :   in      std_logic;
         timestamp           :   in      unsigned(63 downto 0);
         mini_exp            :   in      std_logic_vector(1 downto 0);
+        pack_mode           :   in      pack_mode_t := PACK_MODE_SC16;
 
         in_sample_controls  :   in      sample_controls_t(0 to NUM_STREAMS-1) := (others => SAMPLE_CONTROL_DISABLE);
         in_samples          :   in      sample_streams_t(0 to NUM_STREAMS-1)  := (others => ZERO_SAMPLE);
@@ -127,6 +128,15 @@ architecture simple of fifo_writer is
 
     signal sync_mini_exp: std_logic_vector(1 downto 0);
 
+    -- Sample FIFO writes, prior to packing
+    signal sample_write : std_logic;
+    signal sample_data  : std_logic_vector(fifo_data'range);
+
+    -- Packed sample FIFO writes
+    signal pack_mode_r  : pack_mode_t := PACK_MODE_SC16;
+    signal packed_write : std_logic := '0';
+    signal packed_data  : std_logic_vector(fifo_data'range) := (others => '0');
+
 begin
 
     -- Throw an error if port widths don't make sense
@@ -134,6 +144,10 @@ begin
         report "fifo_data port width too narrow to support " & integer'image(NUM_STREAMS) & " MIMO streams."
         severity failure;
 
+    assert (fifo_data'length mod 32 = 0)
+        report "fifo_data port width must be a multiple of 32 bits to support sample packing."
+        severity failure;
+
     -- Determine the DMA buffer size based on USB speed
     calc_buf_size : process( clock, reset )
     begin
@@ -381,13 +395,74 @@ begin
         end if;
 
         -- Output assignments
-        fifo_clear <= fifo_current.fifo_clear;
-        fifo_write <= fifo_current.fifo_write;
-        fifo_data  <= std_logic_vector(fifo_current.fifo_data);
+        fifo_clear   <= fifo_current.fifo_clear;
+        sample_write <= fifo_current.fifo_write;
+        sample_data  <= std_logic_vector(fifo_current.fifo_data);
 
     end process;
 
 
+    -- ------------------------------------------------------------------------
+    -- SAMPLE PACKER
+    -- ------------------------------------------------------------------------
+    -- Each 32-bit word of sample_data holds a Q & I pair (see the MIMO PACKER
+    -- above). In PACK_MODE_SC16, these are written to the FIFO untouched.
+    -- Otherwise, each pair is reduced to 24 or 16 bits, and the results are
+    -- concatenated LSB-first into FIFO words, such that pairs may straddle
+    -- FIFO words. Since a packed pair is never wider than a FIFO word, at most
+    -- one FIFO word is produced per sample_data word.
+    --
+    -- The mode may only change while the writer is disabled.
+
+    latch_pack_mode : process( clock, reset )
+    begin
+        if( reset = '1' ) then
+            pack_mode_r <= PACK_MODE_SC16;
+        elsif( rising_edge(clock) ) then
+            if( enable = '0' ) then
+                pack_mode_r <= pack_mode;
+            end if;
+        end if;
+    end process;
+
+    pack_samples : process( clock, reset )
+        constant DW   : natural := fifo_data'length;
+        variable acc  : unsigned(2*DW-1 downto 0)    := (others => '0');
+        variable fill : natural range 0 to 2*DW      := 0;
+        variable p    : std_logic_vector(31 downto 0);
+    begin
+        if( reset = '1' ) then
+            acc          := (others => '0');
+            fill         := 0;
+            packed_write <= '0';
+            packed_data  <= (others => '0');
+        elsif( rising_edge(clock) ) then
+            packed_write <= '0';
+
+            if( fifo_current.fifo_clear = '1' ) then
+                acc  := (others => '0');
+                fill := 0;
+            elsif( sample_write = '1' ) then
+                for i in 0 to DW/32-1 loop
+                    p    := pack_sample(sample_data(32*i+31 downto 32*i), pack_mode_r);
+                    acc  := acc or shift_left(resize(unsigned(p), acc'length), fill);
+                    fill := fill + packed_sample_bits(pack_mode_r);
+                end loop;
+
+                if( fill >= DW ) then
+                    packed_write <= '1';
+                    packed_data  <= std_logic_vector(acc(DW-1 downto 0));
+                    acc          := shift_right(acc, DW);
+                    fill         := fill - DW;
+                end if;
+            end if;
+        end if;
+    end process;
+
+    fifo_write <= sample_write when pack_mode_r = PACK_MODE_SC16 else packed_write;
+    fifo_data  <= sample_data  when pack_mode_r = PACK_MODE_SC16 else packed_data;
+
+
     -- ------------------------------------------------------------------------
     -- OVERFLOW
     -- ------------------------------------------------------------------------
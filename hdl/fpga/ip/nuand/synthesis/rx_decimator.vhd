@@ -0,0 +1,343 @@
+-- Copyright (c) 2019 Nuand LLC
+--
+-- Permission is hereby granted, free of charge, to any person obtaining a copy
+-- of this software and associated documentation files (the "Software"), to deal
+-- in the Software without restriction, including without limitation the rights
+-- to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+-- copies of the Software, and to permit persons to whom the Software is
+-- furnished to do so, subject to the following conditions:
+--
+-- The above copyright notice and this permission notice shall be included in
+-- all copies or substantial portions of the Software.
+--
+-- THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+-- IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+-- FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+-- AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+-- LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+-- OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+-- THE SOFTWARE.
+
+-- RX decimation chain
+--
+-- An optional NCO frequency shift, followed by a cascade of half-band
+-- decimate-by-2 stages. Stages beyond log2_decimation are bypassed, such that
+-- the overall decimation factor is 2**log2_decimation.
+--
+-- Each stage only computes the outputs that are kept, using the symmetry of
+-- the half-band response: 6 products per output per rail. These are spread
+-- over as many clock cycles as are available between outputs, which doubles
+-- with every stage, so stage k needs ceil(12 / (MIN_INPUT_INTERVAL*2**(k+1)))
+-- multipliers. For MIN_INPUT_INTERVAL = 2, that is 3 + 2 + 1 + 1 + 1 + 1 = 9
+-- multipliers for a 6-stage chain, plus 4 for the NCO mixer.
+--
+-- The filters delay the signal by group_delay samples at the input (RFIC)
+-- rate, which the RX timestamp must account for. This excludes the pipeline
+-- latency of a few clock cycles.
+--
+-- The configuration inputs are expected to be static while samples are
+-- flowing; changing them mid-stream produces a (harmless) transient.
+
+library ieee;
+    use ieee.std_logic_1164.all;
+    use ieee.numeric_std.all;
+    use ieee.math_real.all;
+
+library work;
+    use work.fifo_readwrite_p.all;
+    use work.nco_p.all;
+    use work.constellation_mapper_p.all;
+
+entity rx_decimator is
+    generic (
+        MAX_LOG2_DECIMATION : natural  := 6;
+        -- Minimum number of clock cycles between input samples
+        MIN_INPUT_INTERVAL  : positive := 2
+    );
+    port (
+        clock           : in  std_logic;
+        reset           : in  std_logic;
+
+        -- Configuration
+        log2_decimation : in  natural range 0 to MAX_LOG2_DECIMATION;
+        nco_enable      : in  std_logic;
+        nco_dphase      : in  signed(15 downto 0);
+
+        -- Samples
+        in_sample       : in  sample_stream_t;
+        out_sample      : out sample_stream_t;
+
+        -- Delay through the filters, in input samples
+        group_delay     : out natural
+    );
+end entity;
+
+architecture arch of rx_decimator is
+
+    -- 23-tap Blackman-windowed half-band, unity DC gain. Every other tap
+    -- (besides the center tap) is zero, and the center tap is implemented
+    -- as 0.5, so only HALFBAND_H(0), (2), ..., (10) need to be multiplied.
+    constant HALFBAND_H : real_array_t := (
+        -0.000183, 0.0, 0.002350, 0.0, -0.010062, 0.0, 0.030562, 0.0,
+        -0.082065, 0.0, 0.309433, 0.499932, 0.309433, 0.0, -0.082065, 0.0,
+        0.030562, 0.0, -0.010062, 0.0, 0.002350, 0.0, -0.000183
+    );
+
+    constant HB_TAPS     : natural := HALFBAND_H'length;
+    constant HB_CENTER   : natural := HB_TAPS / 2;
+    constant HB_SIDES    : natural := (HB_CENTER + 1) / 2;
+    constant HB_PRODUCTS : natural := 2 * HB_SIDES;   -- I and Q
+    constant HB_Q        : natural := 17;
+
+    type hb_coefs_t is array( natural range <> ) of signed(17 downto 0);
+    type hb_samples_t is array( natural range <> ) of signed(15 downto 0);
+    type hb_preadds_t is array( natural range <> ) of signed(16 downto 0);
+
+    -- Coefficient for each product; products 0 to HB_SIDES-1 are I and the
+    -- remainder are Q
+    function hb_coefs return hb_coefs_t is
+        variable rv : hb_coefs_t(0 to HB_PRODUCTS-1);
+    begin
+        for i in rv'range loop
+            rv(i) := to_signed(integer(round(HALFBAND_H(2*(i mod HB_SIDES)) * real(2**HB_Q))), rv(i)'length);
+        end loop;
+        return rv;
+    end function;
+
+    constant HB_COEFS : hb_coefs_t := hb_coefs;
+
+    -- Multipliers needed by stage k to finish an output before the next
+    function hb_mults( k : natural ) return positive is
+        constant CYCLES : positive := MIN_INPUT_INTERVAL * 2**(k+1);
+    begin
+        return (HB_PRODUCTS + CYCLES - 1) / CYCLES;
+    end function;
+
+    -- The NCO output magnitude is approximately 2**11
+    constant NCO_SHIFT  : natural := 11;
+
+    -- Samples are 12-bit (Q11) values
+    constant SAMPLE_MAX : integer := 2047;
+    constant SAMPLE_MIN : integer := -2048;
+
+    signal nco_inputs   : nco_input_t;
+    signal nco_outputs  : nco_output_t;
+    signal lo_re        : signed(15 downto 0) := (others => '0');
+    signal lo_im        : signed(15 downto 0) := (others => '0');
+
+    signal stages       : sample_streams_t(0 to MAX_LOG2_DECIMATION) := (others => ZERO_SAMPLE);
+
+    function saturate( x : signed ) return signed is
+    begin
+        if( x > SAMPLE_MAX ) then
+            return to_signed(SAMPLE_MAX, 16);
+        elsif( x < SAMPLE_MIN ) then
+            return to_signed(SAMPLE_MIN, 16);
+        else
+            return resize(x, 16);
+        end if;
+    end function;
+
+begin
+
+    -- ------------------------------------------------------------------------
+    -- NCO FREQUENCY SHIFT
+    -- ------------------------------------------------------------------------
+    -- The NCO is advanced once per input sample. Its output lags the input
+    -- by the CORDIC's pipeline depth, so the most recent output is held and
+    -- applied to each sample. This amounts to a constant phase offset.
+
+    nco_inputs.dphase <= nco_dphase;
+    nco_inputs.valid  <= in_sample.data_v and nco_enable;
+
+    U_nco : entity work.nco
+        port map (
+            clock   => clock,
+            reset   => reset,
+            inputs  => nco_inputs,
+            outputs => nco_outputs
+        );
+
+    hold_lo : process( clock, reset )
+    begin
+        if( reset = '1' ) then
+            lo_re <= to_signed(2**NCO_SHIFT, lo_re'length);
+            lo_im <= (others => '0');
+        elsif( rising_edge(clock) ) then
+            if( nco_outputs.valid = '1' ) then
+                lo_re <= nco_outputs.re;
+                lo_im <= nco_outputs.im;
+            end if;
+        end if;
+    end process;
+
+    mix : process( clock, reset )
+        variable re : signed(32 downto 0);
+        variable im : signed(32 downto 0);
+    begin
+        if( reset = '1' ) then
+            stages(0) <= ZERO_SAMPLE;
+        elsif( rising_edge(clock) ) then
+            stages(0).data_v <= in_sample.data_v;
+
+            if( nco_enable = '1' ) then
+                re := resize(in_sample.data_i * lo_re, re'length) -
+                      resize(in_sample.data_q * lo_im, re'length);
+                im := resize(in_sample.data_i * lo_im, im'length) +
+                      resize(in_sample.data_q * lo_re, im'length);
+
+                stages(0).data_i <= saturate(shift_right(re, NCO_SHIFT));
+                stages(0).data_q <= saturate(shift_right(im, NCO_SHIFT));
+            else
+                stages(0).data_i <= in_sample.data_i;
+                stages(0).data_q <= in_sample.data_q;
+            end if;
+        end if;
+    end process;
+
+
+    -- ------------------------------------------------------------------------
+    -- HALF-BAND DECIMATION STAGES
+    -- ------------------------------------------------------------------------
+
+    generate_stages : for k in 0 to MAX_LOG2_DECIMATION-1 generate
+        constant MULTS  : positive := hb_mults(k);
+        constant CYCLES : positive := (HB_PRODUCTS + MULTS - 1) / MULTS;
+
+        signal line_i   : hb_samples_t(0 to HB_TAPS-1) := (others => (others => '0'));
+        signal line_q   : hb_samples_t(0 to HB_TAPS-1) := (others => (others => '0'));
+        signal preadds  : hb_preadds_t(0 to HB_PRODUCTS-1) := (others => (others => '0'));
+        signal center_i : signed(15 downto 0) := (others => '0');
+        signal center_q : signed(15 downto 0) := (others => '0');
+        signal acc_i    : signed(39 downto 0) := (others => '0');
+        signal acc_q    : signed(39 downto 0) := (others => '0');
+        signal step     : natural range 0 to CYCLES := CYCLES;
+        signal done     : std_logic := '0';
+        signal phase    : std_logic := '0';
+        signal filtered : sample_stream_t := ZERO_SAMPLE;
+    begin
+
+        -- Every other input completes an output. The pre-added tap pairs and
+        -- the center tap are captured at that point, and the products are
+        -- accumulated over the following CYCLES clock cycles.
+        filter : process( clock, reset )
+            variable li   : hb_samples_t(line_i'range);
+            variable lq   : hb_samples_t(line_q'range);
+            variable idx  : natural;
+            variable prod : signed(34 downto 0);
+            variable ai   : signed(acc_i'range);
+            variable aq   : signed(acc_q'range);
+        begin
+            if( reset = '1' ) then
+                line_i   <= (others => (others => '0'));
+                line_q   <= (others => (others => '0'));
+                preadds  <= (others => (others => '0'));
+                center_i <= (others => '0');
+                center_q <= (others => '0');
+                acc_i    <= (others => '0');
+                acc_q    <= (others => '0');
+                step     <= CYCLES;
+                done     <= '0';
+                phase    <= '0';
+            elsif( rising_edge(clock) ) then
+                done <= '0';
+
+                if( step < CYCLES ) then
+                    ai := acc_i;
+                    aq := acc_q;
+                    for m in 0 to MULTS-1 loop
+                        idx := step*MULTS + m;
+                        if( idx < HB_PRODUCTS ) then
+                            prod := preadds(idx) * HB_COEFS(idx);
+                            if( idx < HB_SIDES ) then
+                                ai := ai + prod;
+                            else
+                                aq := aq + prod;
+                            end if;
+                        end if;
+                    end loop;
+                    acc_i <= ai;
+                    acc_q <= aq;
+                    step  <= step + 1;
+
+                    if( step = CYCLES-1 ) then
+                        done <= '1';
+                    end if;
+                end if;
+
+                if( stages(k).data_v = '1' ) then
+                    li := stages(k).data_i & line_i(0 to HB_TAPS-2);
+                    lq := stages(k).data_q & line_q(0 to HB_TAPS-2);
+                    line_i <= li;
+                    line_q <= lq;
+
+                    if( phase = '1' ) then
+                        assert step = CYCLES
+                            report "rx_decimator: stage " & integer'image(k) &
+                                   " input arrived faster than MIN_INPUT_INTERVAL allows"
+                            severity warning;
+
+                        for j in 0 to HB_SIDES-1 loop
+                            preadds(j)          <= resize(li(2*j), 17) + resize(li(HB_TAPS-1-2*j), 17);
+                            preadds(HB_SIDES+j) <= resize(lq(2*j), 17) + resize(lq(HB_TAPS-1-2*j), 17);
+                        end loop;
+                        center_i <= li(HB_CENTER);
+                        center_q <= lq(HB_CENTER);
+                        acc_i    <= (others => '0');
+                        acc_q    <= (others => '0');
+                        step     <= 0;
+                    end if;
+
+                    phase <= not phase;
+                end if;
+
+                if( k >= log2_decimation ) then
+                    phase <= '0';
+                end if;
+            end if;
+        end process;
+
+        -- Add the center tap (0.5), round, and saturate
+        output : process( clock, reset )
+            constant HALF : signed(acc_i'range) := shift_left(to_signed(1, acc_i'length), HB_Q-1);
+        begin
+            if( reset = '1' ) then
+                filtered <= ZERO_SAMPLE;
+            elsif( rising_edge(clock) ) then
+                filtered.data_v <= done;
+                if( done = '1' ) then
+                    filtered.data_i <= saturate(shift_right(acc_i + shift_left(resize(center_i, acc_i'length), HB_Q-1) + HALF, HB_Q));
+                    filtered.data_q <= saturate(shift_right(acc_q + shift_left(resize(center_q, acc_q'length), HB_Q-1) + HALF, HB_Q));
+                end if;
+            end if;
+        end process;
+
+        decimate : process( clock, reset )
+        begin
+            if( reset = '1' ) then
+                stages(k+1) <= ZERO_SAMPLE;
+            elsif( rising_edge(clock) ) then
+                if( k < log2_decimation ) then
+                    stages(k+1) <= filtered;
+                else
+                    -- Bypass
+                    stages(k+1) <= stages(k);
+                end if;
+            end if;
+        end process;
+
+    end generate;
+
+    -- Each active stage delays by HB_CENTER of its own input samples
+    compute_group_delay : process( clock, reset )
+    begin
+        if( reset = '1' ) then
+            group_delay <= 0;
+        elsif( rising_edge(clock) ) then
+            group_delay <= HB_CENTER * (2**log2_decimation - 1);
+        end if;
+    end process;
+
+    out_sample <= stages(MAX_LOG2_DECIMATION);
+
+end architecture;
@@ -0,0 +1,286 @@
+-- Copyright (c) 2026 Nuand LLC
+--
+-- Permission is hereby granted, free of charge, to any person obtaining a copy
+-- of this software and associated documentation files (the "Software"), to deal
+-- in the Software without restriction, including without limitation the rights
+-- to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+-- copies of the Software, and to permit persons to whom the Software is
+-- furnished to do so, subject to the following conditions:
+--
+-- The above copyright notice and this permission notice shall be included in
+-- all copies or substantial portions of the Software.
+--
+-- THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+-- IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+-- FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+-- AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+-- LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+-- OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+-- THE SOFTWARE.
+
+-- rx_decimator testbench
+--
+--  1. Decimate-by-2 of pseudo-random samples, checked bit-for-bit against an
+--     integer model of the half-band stage.
+--  2. For every decimation factor, a DC input must produce the same DC
+--     output, exactly one output per 2**log2_decimation inputs, and the
+--     expected group_delay.
+--  3. A tone at +fs/16, shifted to DC by the NCO and decimated by 4, must
+--     produce a steady output.
+--
+-- Inputs are presented every MIN_INPUT_INTERVAL clocks, as from the AD9361.
+
+library ieee;
+    use ieee.std_logic_1164.all;
+    use ieee.numeric_std.all;
+    use ieee.math_real.all;
+
+library std;
+    use std.env.all;
+
+library work;
+    use work.fifo_readwrite_p.all;
+
+entity rx_decimator_tb is
+    generic (
+        MAX_LOG2_DECIMATION : natural  := 6;
+        MIN_INPUT_INTERVAL  : positive := 2
+    );
+end entity;
+
+architecture arch of rx_decimator_tb is
+
+    -- Must match rx_decimator
+    type integer_array_t is array( natural range <> ) of integer;
+    constant HB_TAPS   : natural := 23;
+    constant HB_Q      : natural := 17;
+    constant HB_SIDE_H : integer_array_t(0 to 5) := (
+        integer(round(-0.000183 * real(2**HB_Q))),
+        integer(round( 0.002350 * real(2**HB_Q))),
+        integer(round(-0.010062 * real(2**HB_Q))),
+        integer(round( 0.030562 * real(2**HB_Q))),
+        integer(round(-0.082065 * real(2**HB_Q))),
+        integer(round( 0.309433 * real(2**HB_Q)))
+    );
+
+    constant RANDOM_COUNT : natural := 512;
+
+    signal clock           : std_logic := '1';
+    signal reset           : std_logic := '1';
+
+    signal log2_decimation : natural range 0 to MAX_LOG2_DECIMATION := 0;
+    signal nco_enable      : std_logic := '0';
+    signal nco_dphase      : signed(15 downto 0) := (others => '0');
+
+    signal in_sample       : sample_stream_t := ZERO_SAMPLE;
+    signal out_sample      : sample_stream_t;
+    signal group_delay     : natural;
+
+    -- Input history, with zeros before the first sample
+    function at( x : integer_array_t; i : integer ) return integer is
+    begin
+        if( i < 0 ) then
+            return 0;
+        else
+            return x(i);
+        end if;
+    end function;
+
+    -- Integer model of one half-band output, given the input history x with
+    -- the newest sample at index n
+    function halfband( x : integer_array_t; n : natural ) return integer is
+        variable acc : signed(39 downto 0) := (others => '0');
+        variable y   : integer;
+    begin
+        acc := (others => '0');
+        for j in HB_SIDE_H'range loop
+            acc := acc + to_signed(HB_SIDE_H(j) * (at(x, n-2*j) + at(x, n-(HB_TAPS-1)+2*j)), acc'length);
+        end loop;
+        acc := acc + shift_left(to_signed(at(x, n-(HB_TAPS/2)), acc'length), HB_Q-1);
+        acc := acc + shift_left(to_signed(1, acc'length), HB_Q-1);
+        y   := to_integer(shift_right(acc, HB_Q));
+        if( y > 2047 ) then
+            return 2047;
+        elsif( y < -2048 ) then
+            return -2048;
+        end if;
+        return y;
+    end function;
+
+begin
+
+    clock <= not clock after 1 ns;
+
+    U_rx_decimator : entity work.rx_decimator
+      generic map (
+        MAX_LOG2_DECIMATION => MAX_LOG2_DECIMATION,
+        MIN_INPUT_INTERVAL  => MIN_INPUT_INTERVAL
+      )
+      port map (
+        clock           => clock,
+        reset           => reset,
+
+        log2_decimation => log2_decimation,
+        nco_enable      => nco_enable,
+        nco_dphase      => nco_dphase,
+
+        in_sample       => in_sample,
+        out_sample      => out_sample,
+
+        group_delay     => group_delay
+      );
+
+    tb : process
+        variable xi      : integer_array_t(0 to RANDOM_COUNT-1);
+        variable xq      : integer_array_t(0 to RANDOM_COUNT-1);
+        variable nin     : natural;
+        variable nout    : natural;
+        variable last_i  : integer;
+        variable last_q  : integer;
+        variable seed1   : positive := 1;
+        variable seed2   : positive := 2;
+        variable r       : real;
+        variable mag     : real;
+        variable min_mag : real;
+        variable max_mag : real;
+
+        -- Advance one clock and check any output against the model for the
+        -- random test, or record it otherwise
+        procedure tick( check_model : boolean ) is
+            variable n : natural;
+        begin
+            wait until rising_edge(clock);
+            if( out_sample.data_v = '1' ) then
+                if( check_model ) then
+                    -- Output m completes with input 2m+1
+                    n := 2*nout + 1;
+                    assert to_integer(out_sample.data_i) = halfband(xi, n) and
+                           to_integer(out_sample.data_q) = halfband(xq, n)
+                        report "Output " & integer'image(nout) & " mismatch: got (" &
+                               integer'image(to_integer(out_sample.data_i)) & ", " &
+                               integer'image(to_integer(out_sample.data_q)) & "), expected (" &
+                               integer'image(halfband(xi, n)) & ", " &
+                               integer'image(halfband(xq, n)) & ")"
+                        severity failure;
+                end if;
+                last_i := to_integer(out_sample.data_i);
+                last_q := to_integer(out_sample.data_q);
+                nout   := nout + 1;
+            end if;
+        end procedure;
+
+        -- Present one input, then idle for the rest of the input interval
+        procedure push( i : integer; q : integer; check_model : boolean ) is
+        begin
+            in_sample.data_i <= to_signed(i, 16);
+            in_sample.data_q <= to_signed(q, 16);
+            in_sample.data_v <= '1';
+            tick(check_model);
+            in_sample.data_v <= '0';
+            for c in 2 to MIN_INPUT_INTERVAL loop
+                tick(check_model);
+            end loop;
+            nin := nin + 1;
+        end procedure;
+
+        procedure restart( l : natural ) is
+        begin
+            reset           <= '1';
+            log2_decimation <= l;
+            for c in 1 to 4 loop
+                tick(false);
+            end loop;
+            reset <= '0';
+            for c in 1 to 4 loop
+                tick(false);
+            end loop;
+            nin  := 0;
+            nout := 0;
+        end procedure;
+
+        procedure drain( check_model : boolean ) is
+        begin
+            for c in 1 to 200 loop
+                tick(check_model);
+            end loop;
+        end procedure;
+
+    begin
+        -- 1. Bit-exact decimate-by-2
+        for n in xi'range loop
+            uniform(seed1, seed2, r);
+            xi(n) := integer(floor(r * 4096.0)) - 2048;
+            uniform(seed1, seed2, r);
+            xq(n) := integer(floor(r * 4096.0)) - 2048;
+        end loop;
+
+        restart(1);
+        for n in xi'range loop
+            push(xi(n), xq(n), true);
+        end loop;
+        drain(true);
+
+        assert nout = RANDOM_COUNT / 2
+            report "Random test: expected " & integer'image(RANDOM_COUNT / 2) &
+                   " outputs, got " & integer'image(nout)
+            severity failure;
+        report "Bit-exact decimate-by-2 passed";
+
+        -- 2. DC response, output rate, and group delay for each factor
+        for l in 0 to MAX_LOG2_DECIMATION loop
+            restart(l);
+            for n in 1 to (64 + 4*HB_TAPS) * 2**l loop
+                push(1000, -700, false);
+            end loop;
+            drain(false);
+
+            assert nout = nin / 2**l
+                report "Decimation by " & integer'image(2**l) & ": expected " &
+                       integer'image(nin / 2**l) & " outputs, got " & integer'image(nout)
+                severity failure;
+
+            assert abs(last_i - 1000) <= 2 and abs(last_q + 700) <= 2
+                report "Decimation by " & integer'image(2**l) & ": DC output (" &
+                       integer'image(last_i) & ", " & integer'image(last_q) & ")"
+                severity failure;
+
+            assert group_delay = 11 * (2**l - 1)
+                report "Decimation by " & integer'image(2**l) & ": group delay " &
+                       integer'image(group_delay)
+                severity failure;
+
+            report "Decimation by " & integer'image(2**l) & " passed";
+        end loop;
+
+        -- 3. NCO shift of a tone at +fs/16 down to DC, decimated by 4. A
+        --    positive offset corresponds to a negative phase step, of which
+        --    there are 8192 per cycle.
+        nco_enable <= '1';
+        nco_dphase <= to_signed(-8192/16, 16);
+        restart(2);
+
+        min_mag := real'high;
+        max_mag := 0.0;
+        for n in 0 to 1023 loop
+            push(integer(round(1500.0 * cos(MATH_2_PI * real(n) / 16.0))),
+                 integer(round(1500.0 * sin(MATH_2_PI * real(n) / 16.0))), false);
+
+            -- Allow the filters to settle
+            if( nout > 64 ) then
+                mag     := sqrt(real(last_i)**2 + real(last_q)**2);
+                min_mag := realmin(min_mag, mag);
+                max_mag := realmax(max_mag, mag);
+            end if;
+        end loop;
+
+        assert min_mag > 1300.0 and max_mag < 1700.0 and (max_mag - min_mag) < 30.0
+            report "NCO test: output magnitude ranged from " & real'image(min_mag) &
+                   " to " & real'image(max_mag)
+            severity failure;
+        report "NCO shift passed";
+
+        report "rx_decimator testbench passed";
+        finish;
+    end process;
+
+end architecture;
@@ -279,6 +279,19 @@ set_instance_parameter_value rffe_spi {syncRegDepth} {2}
 set_instance_parameter_value rffe_spi {targetClockRate} {40000000.0}
 set_instance_parameter_value rffe_spi {targetSlaveSelectToSClkDelay} {0.0}
 
+add_instance rx_decim_ctl altera_avalon_pio
+set_instance_parameter_value rx_decim_ctl {bitClearingEdgeCapReg} {0}
+set_instance_parameter_value rx_decim_ctl {bitModifyingOutReg} {0}
+set_instance_parameter_value rx_decim_ctl {captureEdge} {0}
+set_instance_parameter_value rx_decim_ctl {direction} {Output}
+set_instance_parameter_value rx_decim_ctl {edgeType} {RISING}
+set_instance_parameter_value rx_decim_ctl {generateIRQ} {0}
+set_instance_parameter_value rx_decim_ctl {irqType} {LEVEL}
+set_instance_parameter_value rx_decim_ctl {resetValue} {0.0}
+set_instance_parameter_value rx_decim_ctl {simDoTestBenchWiring} {0}
+set_instance_parameter_value rx_decim_ctl {simDrivenValue} {0.0}
+set_instance_parameter_value rx_decim_ctl {width} {32}
+
 add_instance rx_tamer time_tamer 1.0
 
 add_instance rx_trigger_ctl altera_avalon_pio
@@ -413,6 +426,8 @@ add_interface oc_i2c conduit end
 set_interface_property oc_i2c EXPORT_OF opencores_i2c.conduit_end
 add_interface reset reset sink
 set_interface_property reset EXPORT_OF system_clock.clk_in_reset
+add_interface rx_decim_ctl conduit end
+set_interface_property rx_decim_ctl EXPORT_OF rx_decim_ctl.external_connection
 add_interface rx_tamer conduit end
 set_interface_property rx_tamer EXPORT_OF rx_tamer.conduit_end
 add_interface rx_trigger_ctl conduit end
@@ -492,6 +507,11 @@ set_connection_parameter_value nios2.data_master/rx_tamer.avalon_slave_0 arbitra
 set_connection_parameter_value nios2.data_master/rx_tamer.avalon_slave_0 baseAddress {0x9160}
 set_connection_parameter_value nios2.data_master/rx_tamer.avalon_slave_0 defaultConnection {0}
 
+add_connection nios2.data_master rx_decim_ctl.s1
+set_connection_parameter_value nios2.data_master/rx_decim_ctl.s1 arbitrationPriority {1}
+set_connection_parameter_value nios2.data_master/rx_decim_ctl.s1 baseAddress {0x9460}
+set_connection_parameter_value nios2.data_master/rx_decim_ctl.s1 defaultConnection {0}
+
 add_connection nios2.data_master rx_trigger_ctl.s1
 set_connection_parameter_value nios2.data_master/rx_trigger_ctl.s1 arbitrationPriority {1}
 set_connection_parameter_value nios2.data_master/rx_trigger_ctl.s1 baseAddress {0x9400}
@@ -578,6 +598,8 @@ add_connection system_clock.clk ram.clk1
 
 add_connection system_clock.clk rffe_spi.clk
 
+add_connection system_clock.clk rx_decim_ctl.clk
+
 add_connection system_clock.clk rx_tamer.clock_sink
 
 add_connection system_clock.clk rx_trigger_ctl.clk
@@ -612,6 +634,8 @@ add_connection system_clock.clk_reset ram.reset1
 
 add_connection system_clock.clk_reset rffe_spi.reset
 
+add_connection system_clock.clk_reset rx_decim_ctl.reset
+
 add_connection system_clock.clk_reset rx_tamer.reset
 
 add_connection system_clock.clk_reset rx_trigger_ctl.reset
@@ -47,6 +47,11 @@ architecture hosted_bladerf of bladerf is
     signal fx3_pclk_pll_reset  : std_logic;
 
     signal rx_mux_sel             : unsigned(2 downto 0);
+    signal rx_pack_mode           : pack_mode_t;
+    signal tx_pack_mode           : pack_mode_t;
+
+    signal rx_decim_ctl_i         : std_logic_vector(31 downto 0);
+    signal rx_decim_ctl_sync      : std_logic_vector(31 downto 0);
 
     signal nios_xb_gpio_in        : std_logic_vector(31 downto 0) := (others => '0');
     signal nios_xb_gpio_out       : std_logic_vector(31 downto 0) := (others => '0');
@@ -392,6 +397,7 @@ begin
             rx_trigger_ctl_out_port         => rx_trigger_ctl_i,
             tx_trigger_ctl_out_port         => tx_trigger_ctl_i,
             rx_trigger_ctl_in_port          => pack(rx_trigger_ctl),
+            rx_decim_ctl_export             => rx_decim_ctl_i,
             tx_trigger_ctl_in_port          => pack(tx_trigger_ctl)
         );
 
@@ -485,6 +491,7 @@ begin
             meta_en              => meta_en_tx,
             timestamp_reset      => tx_ts_reset,
             usb_speed            => usb_speed_tx,
+            pack_mode            => tx_pack_mode,
             tx_underflow_led     => tx_underflow_led,
             tx_timestamp         => tx_timestamp,
 
@@ -552,6 +559,8 @@ begin
             timestamp_reset        => rx_ts_reset,
             usb_speed              => usb_speed_rx,
             rx_mux_sel             => rx_mux_sel,
+            pack_mode              => rx_pack_mode,
+            decimation             => unpack(rx_decim_ctl_sync),
             rx_overflow_led        => rx_overflow_led,
             rx_timestamp           => rx_timestamp,
 
@@ -740,6 +749,45 @@ begin
             );
     end generate;
 
+    generate_sync_rx_pack_mode : for i in rx_pack_mode'range generate
+        U_sync_rx_pack_mode : entity work.synchronizer
+            generic map (
+                RESET_LEVEL         =>  '0'
+            )
+            port map (
+                reset               =>  '0',
+                clock               =>  rx_clock,
+                async               =>  nios_gpio.o.rx_pack_mode(i),
+                sync                =>  rx_pack_mode(i)
+            );
+    end generate;
+
+    generate_sync_rx_decim_ctl : for i in rx_decim_ctl_i'range generate
+        U_sync_rx_decim_ctl : entity work.synchronizer
+            generic map (
+                RESET_LEVEL         =>  '0'
+            )
+            port map (
+                reset               =>  '0',
+                clock               =>  rx_clock,
+                async               =>  rx_decim_ctl_i(i),
+                sync                =>  rx_decim_ctl_sync(i)
+            );
+    end generate;
+
+    generate_sync_tx_pack_mode : for i in tx_pack_mode'range generate
+        U_sync_tx_pack_mode : entity work.synchronizer
+            generic map (
+                RESET_LEVEL         =>  '0'
+            )
+            port map (
+                reset               =>  '0',
+                clock               =>  tx_clock,
+                async               =>  nios_gpio.o.tx_pack_mode(i),
+                sync                =>  tx_pack_mode(i)
+            );
+    end generate;
+
     generate_sync_mimo_rx_en : for i in mimo_rx_enables'range generate
         U_sync_mimo_rx_en : entity work.synchronizer
             generic map (
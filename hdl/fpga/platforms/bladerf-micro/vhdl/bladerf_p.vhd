@@ -137,7 +137,8 @@ package bladerf_p is
         tx_trigger_ctl_in_port          :   in  std_logic_vector(7 downto 0);
         tx_trigger_ctl_out_port         :   out std_logic_vector(7 downto 0);
         rx_trigger_ctl_in_port          :   in  std_logic_vector(7 downto 0);
-        rx_trigger_ctl_out_port         :   out std_logic_vector(7 downto 0)
+        rx_trigger_ctl_out_port         :   out std_logic_vector(7 downto 0);
+        rx_decim_ctl_export             :   out std_logic_vector(31 downto 0)
       );
     end component;
 
@@ -285,6 +286,8 @@ package bladerf_p is
 
     type nios_gpo_t is record
         xb_mode         : std_logic_vector(1 downto 0);
+        tx_pack_mode    : std_logic_vector(1 downto 0);
+        rx_pack_mode    : std_logic_vector(1 downto 0);
         si_clock_sel    : std_logic;
         ufl_clock_oe    : std_logic;
         meta_sync       : std_logic;
@@ -376,6 +379,13 @@ package bladerf_p is
         trig_line : std_logic;
     end record;
 
+    -- RX decimation chain configuration (see rx_decimator)
+    type rx_decim_t is record
+        nco_enable      : std_logic;
+        log2_decimation : unsigned(2 downto 0);
+        nco_dphase      : signed(15 downto 0);
+    end record;
+
 
     -- ========================================================================
     -- PACK FUNCTIONS -- pack a human-readable record/type into bits
@@ -387,6 +397,7 @@ package bladerf_p is
     function pack( x : trigger_t )        return std_logic_vector;
     function pack( x : nios_gpo_t )       return std_logic_vector;
     function pack( x : nios_gpi_t )       return std_logic_vector;
+    function pack( x : rx_decim_t )       return std_logic_vector;
 
 
     -- ========================================================================
@@ -398,6 +409,7 @@ package bladerf_p is
     function unpack( trig_gpo  : std_logic_vector(7 downto 0);
                      trig_line : std_logic ) return trigger_t;
     function unpack( x : std_logic_vector(31 downto 0) ) return nios_gpo_t;
+    function unpack( x : std_logic_vector(31 downto 0) ) return rx_decim_t;
 
 
     -- ========================================================================
@@ -422,6 +434,7 @@ package bladerf_p is
     constant META_FIFO_RX_T_DEFAULT     : meta_fifo_rx_t;
     constant MIMO_2R2T_T_DEFAULT        : mimo_2r2t_t;
     constant TRIGGER_T_DEFAULT          : trigger_t;
+    constant RX_DECIM_T_DEFAULT         : rx_decim_t;
 
 end package;
 
@@ -494,6 +507,8 @@ package body bladerf_p is
         variable rv : std_logic_vector(31 downto 0) := (others => 'U');
     begin
         rv(31 downto 30) := x.xb_mode;
+        rv(27 downto 26) := x.tx_pack_mode;
+        rv(25 downto 24) := x.rx_pack_mode;
         rv(18)           := x.si_clock_sel;
         rv(17)           := x.ufl_clock_oe;
         rv(16)           := x.meta_sync;
@@ -516,6 +531,15 @@ package body bladerf_p is
         return rv;
     end function;
 
+    function pack( x : rx_decim_t ) return std_logic_vector is
+        variable rv : std_logic_vector(31 downto 0) := (others => '0');
+    begin
+        rv(24)           := x.nco_enable;
+        rv(18 downto 16) := std_logic_vector(x.log2_decimation);
+        rv(15 downto 0)  := std_logic_vector(x.nco_dphase);
+        return rv;
+    end function;
+
 
     -- ========================================================================
     -- UNPACK FUNCTIONS
@@ -570,6 +594,8 @@ package body bladerf_p is
         variable rv : nios_gpo_t;
     begin
         rv.xb_mode         := x(31 downto 30);
+        rv.tx_pack_mode    := x(27 downto 26);
+        rv.rx_pack_mode    := x(25 downto 24);
         rv.si_clock_sel    := x(18);
         rv.ufl_clock_oe    := x(17);
         rv.meta_sync       := x(16);
@@ -582,6 +608,15 @@ package body bladerf_p is
         return rv;
     end function;
 
+    function unpack( x : std_logic_vector(31 downto 0) ) return rx_decim_t is
+        variable rv : rx_decim_t;
+    begin
+        rv.nco_enable      := x(24);
+        rv.log2_decimation := unsigned(x(18 downto 16));
+        rv.nco_dphase      := signed(x(15 downto 0));
+        return rv;
+    end function;
+
 
     -- ========================================================================
     -- Utility functions
@@ -843,4 +878,10 @@ package body bladerf_p is
         trig_line => '0'
     );
 
+    constant RX_DECIM_T_DEFAULT : rx_decim_t := (
+        nco_enable      => '0',
+        log2_decimation => (others => '0'),
+        nco_dphase      => (others => '0')
+    );
+
 end package body;
@@ -39,6 +39,8 @@ entity rx is
         timestamp_reset        : out   std_logic := '1';
         usb_speed              : in    std_logic;
         rx_mux_sel             : in    unsigned;
+        pack_mode              : in    pack_mode_t := PACK_MODE_SC16;
+        decimation             : in    rx_decim_t := RX_DECIM_T_DEFAULT;
         rx_overflow_led        : out   std_logic := '1';
         rx_timestamp           : in    unsigned(63 downto 0);
 
@@ -112,6 +114,14 @@ architecture arch of rx is
 
     signal mux_streams              : sample_streams_t(adc_streams'range) := (others => ZERO_SAMPLE);
 
+    constant MAX_LOG2_DECIMATION    : natural             := 6;
+
+    signal log2_decimation          : natural range 0 to MAX_LOG2_DECIMATION := 0;
+    signal decim_streams            : sample_streams_t(adc_streams'range) := (others => ZERO_SAMPLE);
+    signal decim_timestamp          : unsigned(rx_timestamp'range) := (others => '0');
+    type group_delays_t is array(natural range <>) of natural;
+    signal decim_group_delays       : group_delays_t(adc_streams'range) := (others => 0);
+
     signal trigger_signal_out       : std_logic;
     signal trigger_signal_out_sync  : std_logic;
 
@@ -227,8 +237,9 @@ begin
 
             usb_speed           =>  usb_speed,
             meta_en             =>  meta_en,
-            timestamp           =>  rx_timestamp,
+            timestamp           =>  decim_timestamp,
             mini_exp            =>  mini_exp,
+            pack_mode           =>  pack_mode,
 
             fifo_full           =>  sample_fifo.wfull,
             fifo_usedw          =>  sample_fifo.wused,
@@ -241,7 +252,7 @@ begin
             meta_fifo_write     =>  meta_fifo.wreq,
 
             in_sample_controls  =>  adc_controls,
-            in_samples          =>  mux_streams,
+            in_samples          =>  decim_streams,
 
             overflow_led        =>  rx_overflow_led,
             overflow_count      =>  open,
@@ -364,6 +375,53 @@ begin
     end process;
 
 
+    -- RX decimation
+    --   Samples (and the timestamps applied to them) are in units of the
+    --   decimated sample rate. The timestamp counter itself continues to run
+    --   at the RFIC's sample rate, so it is scaled down here, after removing
+    --   the decimator's group delay such that a sample's timestamp reflects
+    --   when it was received by the RFIC. libbladeRF likewise scales the
+    --   counter when it is read back, so both are in the same units.
+    set_log2_decimation : process(rx_reset, rx_clock)
+    begin
+        if( rx_reset = '1' ) then
+            log2_decimation <= 0;
+            decim_timestamp <= (others => '0');
+        elsif( rising_edge(rx_clock) ) then
+            if( decimation.log2_decimation > MAX_LOG2_DECIMATION ) then
+                log2_decimation <= MAX_LOG2_DECIMATION;
+            else
+                log2_decimation <= to_integer(decimation.log2_decimation);
+            end if;
+
+            decim_timestamp <= shift_right(rx_timestamp -
+                                           to_unsigned(decim_group_delays(decim_group_delays'low),
+                                                       rx_timestamp'length),
+                                           log2_decimation);
+        end if;
+    end process;
+
+    generate_decimators : for i in mux_streams'range generate
+        U_rx_decimator : entity work.rx_decimator
+            generic map (
+                MAX_LOG2_DECIMATION => MAX_LOG2_DECIMATION
+            )
+            port map (
+                clock           => rx_clock,
+                reset           => rx_reset,
+
+                log2_decimation => log2_decimation,
+                nco_enable      => decimation.nco_enable,
+                nco_dphase      => decimation.nco_dphase,
+
+                in_sample       => mux_streams(i),
+                out_sample      => decim_streams(i),
+
+                group_delay     => decim_group_delays(i)
+            );
+    end generate;
+
+
     -- RX Trigger
     rxtrig : entity work.trigger(async)
         generic map (
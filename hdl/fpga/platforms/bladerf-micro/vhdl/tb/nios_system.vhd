@@ -94,6 +94,7 @@ entity nios_system is
         rx_tamer_ts_time                : out std_logic_vector(63 downto 0);                    -- ts_time
         rx_trigger_ctl_in_port          : in  std_logic_vector(7 downto 0)  := (others => 'X'); -- in_port
         rx_trigger_ctl_out_port         : out std_logic_vector(7 downto 0);                     -- out_port
+        rx_decim_ctl_export             : out std_logic_vector(31 downto 0);                    -- export
         spi_MISO                        : in  std_logic                     := 'X';             -- MISO
         spi_MOSI                        : out std_logic;                                        -- MOSI
         spi_SCLK                        : out std_logic;                                        -- SCLK
@@ -141,6 +142,7 @@ begin
 
     xb_gpio_out_port <= (others =>'0') ;
     xb_gpio_dir_export <= (others =>'0') ;
+    rx_decim_ctl_export <= (others =>'0') ;
 
 end architecture ;
 
@@ -38,6 +38,7 @@ entity tx is
         meta_en              : in    std_logic := '0';
         timestamp_reset      : out   std_logic := '1';
         usb_speed            : in    std_logic;
+        pack_mode            : in    pack_mode_t := PACK_MODE_SC16;
         tx_underflow_led     : out   std_logic := '1';
         tx_timestamp         : in    unsigned(63 downto 0);
 
@@ -206,6 +207,7 @@ begin
             usb_speed           =>  usb_speed,
             meta_en             =>  meta_en,
             timestamp           =>  tx_timestamp,
+            pack_mode           =>  pack_mode,
 
             fifo_empty          =>  sample_fifo.rempty,
             fifo_usedw          =>  sample_fifo.rused,
@@ -4,6 +4,9 @@
 
 FPGA_COMMON_DIR    := ../../../../../../fpga_common
 BLADERF_COMMON_DIR := ../../../common/bladerf/software/bladeRF_nios
+LIBBLADERF_DIR     := ../../../../../../host/libraries/libbladeRF
+PLATFORM_SRC_DIR   := ./src
+PLATFORM_CFLAGS    := -DBOARD_BLADERF
 
 QUARTUS_WORKDIR    := ../../../../../quartus/work/bladerf
 NIOS_BUILD_OUTDIR  := $(QUARTUS_WORKDIR)/bladeRF_nios
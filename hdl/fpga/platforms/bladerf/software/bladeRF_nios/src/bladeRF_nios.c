@@ -88,6 +88,17 @@ static const struct pkt_handler pkt_handlers[] = {
     PKT_LEGACY,
 };
 
+/* Jump table from a request's magic byte to its packet handler, holding the
+ * handler's index in pkt_handlers[] plus one (0 denotes an invalid magic).
+ * This is populated at startup, so that dispatching a request is a single
+ * lookup rather than a comparison against every handler's magic. */
+static uint8_t pkt_dispatch[UINT8_MAX + 1];
+
+/* Deferred work functions of the packet handlers that provide one, which are
+ * run while there is no request pending */
+static void (*pkt_do_work[ARRAY_SIZE(pkt_handlers)])(void);
+static uint8_t pkt_do_work_count;
+
 /* A structure that represents a point on a line. Used for calibrating
  * the VCTCXO */
 typedef struct point {
@@ -151,11 +162,17 @@ int main(void)
     pkt.ready = false;
     bladerf_nios_init(&pkt, &vctcxo_tamer_pkt);
 
-    /* Initialize packet handlers */
+    /* Initialize packet handlers and their dispatch tables */
     for (i = 0; i < ARRAY_SIZE(pkt_handlers); i++) {
         if (pkt_handlers[i].init != NULL) {
             pkt_handlers[i].init();
         }
+
+        pkt_dispatch[pkt_handlers[i].magic] = i + 1;
+
+        if (pkt_handlers[i].do_work != NULL) {
+            pkt_do_work[pkt_do_work_count++] = pkt_handlers[i].do_work;
+        }
     }
 
     while (run_nios) {
@@ -164,22 +181,19 @@ int main(void)
         /* We have a command in the UART */
         if (have_request) {
             pkt.ready = false;
-            handler = NULL;
 
             /* Determine which packet handler should receive this message */
-            for (i = 0; i < ARRAY_SIZE(pkt_handlers); i++) {
-                if (pkt_handlers[i].magic == *magic) {
-                    handler = &pkt_handlers[i];
-                }
-            }
+            i = pkt_dispatch[*magic];
 
-            if (handler == NULL) {
+            if (i == 0) {
                 /* We somehow got out of sync. Throw away request data until
                  * we hit a magic value */
                 DBG("Got invalid magic value: 0x%x\n", pkt.req[PKT_MAGIC_IDX]);
                 continue;
             }
 
+            handler = &pkt_handlers[i - 1];
+
             print_bytes("Request data:", pkt.req, NIOS_PKT_LEN);
 
             /* If building with RESET_RESPONSE_BUF defined, reset response buffer
@@ -283,10 +297,8 @@ int main(void)
 
             } /* VCTCXO Tamer interrupt */
 
-            for (i = 0; i < ARRAY_SIZE(pkt_handlers); i++) {
-                if (pkt_handlers[i].do_work != NULL) {
-                    pkt_handlers[i].do_work();
-                }
+            for (i = 0; i < pkt_do_work_count; i++) {
+                pkt_do_work[i]();
             }
         }
     }
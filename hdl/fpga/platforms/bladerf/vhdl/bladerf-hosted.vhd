@@ -45,6 +45,10 @@ architecture hosted_bladerf of bladerf is
     signal rx_mux_sel       : unsigned(2 downto 0) ;
     signal rx_mux_mode      : rx_mux_mode_t ;
 
+    -- Can be set from libbladeRF using bladerf_set_wire_format()
+    signal rx_pack_mode     : pack_mode_t ;
+    signal tx_pack_mode     : pack_mode_t ;
+
     signal \80MHz\          : std_logic ;
 
     signal nios_gpio        : nios_gpio_t;
@@ -327,6 +331,30 @@ begin
           ) ;
     end generate ;
 
+    generate_rx_pack_mode : for i in rx_pack_mode'range generate
+        U_rx_pack_mode : entity work.synchronizer
+          generic map (
+            RESET_LEVEL         =>  '0'
+          ) port map (
+            reset               =>  '0',
+            clock               =>  rx_clock,
+            async               =>  nios_gpio.o.rx_pack_mode(i),
+            sync                =>  rx_pack_mode(i)
+          ) ;
+    end generate ;
+
+    generate_tx_pack_mode : for i in tx_pack_mode'range generate
+        U_tx_pack_mode : entity work.synchronizer
+          generic map (
+            RESET_LEVEL         =>  '0'
+          ) port map (
+            reset               =>  '0',
+            clock               =>  tx_clock,
+            async               =>  nios_gpio.o.tx_pack_mode(i),
+            sync                =>  tx_pack_mode(i)
+          ) ;
+    end generate ;
+
     U_meta_sync_fx3 : entity work.synchronizer
       generic map (
         RESET_LEVEL         =>  '0'
@@ -725,6 +753,7 @@ begin
         meta_en             =>  meta_en_rx,
         timestamp           =>  rx_timestamp,
         mini_exp            =>  mini_exp2 & mini_exp1,
+        pack_mode           =>  rx_pack_mode,
 
         fifo_clear          =>  rx_sample_fifo.aclr,
         fifo_full           =>  rx_sample_fifo.wfull,
@@ -869,6 +898,7 @@ begin
         usb_speed           =>  usb_speed_tx,
         meta_en             =>  meta_en_tx,
         timestamp           =>  tx_timestamp,
+        pack_mode           =>  tx_pack_mode,
 
         fifo_empty          =>  tx_sample_fifo.rempty,
         fifo_usedw          =>  tx_sample_fifo.rused,
@@ -252,6 +252,8 @@ package bladerf_p is
 
     type nios_gpo_t is record
         xb_mode         : std_logic_vector(1 downto 0);
+        tx_pack_mode    : std_logic_vector(1 downto 0);
+        rx_pack_mode    : std_logic_vector(1 downto 0);
         agc_en          : std_logic;
         agc_band_sel    : std_logic;
         ts_div2         : std_logic;  -- Not used in FPGA versions >= 0.3.0
@@ -320,7 +322,10 @@ package body bladerf_p is
         variable rv : std_logic_vector(31 downto 0) := (others => '0');
     begin
         rv(31 downto 30) := x.xb_mode;
-        -- AVAILABLE: x(29 downto 23);
+        -- AVAILABLE: x(29 downto 28);
+        rv(27 downto 26) := x.tx_pack_mode;
+        rv(25 downto 24) := x.rx_pack_mode;
+        -- AVAILABLE: x(23);
         -- RESERVED:  rv(22 downto 21) := x.xb_mode2;  -- Why? Is this even needed?
         -- RESERVED:  rv(20 downto 19) := x.nios_ss_n; -- Why? Is this even needed?
         rv(18)           := x.agc_en;
@@ -359,7 +364,10 @@ package body bladerf_p is
         variable rv : nios_gpo_t;
     begin
         rv.xb_mode         := x(31 downto 30);
-        -- AVAILABLE: x(29 downto 23);
+        -- AVAILABLE: x(29 downto 28);
+        rv.tx_pack_mode    := x(27 downto 26);
+        rv.rx_pack_mode    := x(25 downto 24);
+        -- AVAILABLE: x(23);
         --rv.xb_mode2      := x(22 downto 21); -- Why? Is this even needed?
         --rv.nios_ss_n     := x(20 downto 19); -- Why? Is this even needed?
         rv.agc_en          := x(18);
@@ -5,22 +5,28 @@
 #  - FPGA_COMMON_DIR    : Path to fpga_common
 #  - BLADERF_COMMON_DIR : Path to common bladeRF_nios dir
 #  - NIOS_BUILD_OUTDIR  : Path to place the Nios build products
+#  - LIBBLADERF_DIR     : Path to libbladeRF
+#  - PLATFORM_SRC_DIR   : Path to the platform's main() and fpga_version.h
+#  - PLATFORM_CFLAGS    : Platform-specific flags, e.g., the BOARD_ define
 
 #------------------------------------------------------------------------------
 #              MAKEFILE TARGETS
 #------------------------------------------------------------------------------
 
-INCLUDES := -I $(FPGA_COMMON_DIR)/include -I $(BLADERF_COMMON_DIR)/src
+INCLUDES := -I $(FPGA_COMMON_DIR)/include -I $(BLADERF_COMMON_DIR)/src \
+            -I $(PLATFORM_SRC_DIR) -I $(LIBBLADERF_DIR)/include
 
 CFLAGS := -Wall -Wextra -Wno-unused-parameter \
           -O0 -ggdb3 -DBLADERF_NIOS_PC_SIMULATION \
-          $(INCLUDES)
+          $(PLATFORM_CFLAGS) $(INCLUDES)
 
-SRC := $(wildcard $(BLADERF_COMMON_DIR)/src/*.c) $(FPGA_COMMON_DIR)/src/band_select.c
+SRC := $(wildcard $(BLADERF_COMMON_DIR)/src/*.c) $(FPGA_COMMON_DIR)/src/band_select.c \
+       $(PLATFORM_SRC_DIR)/bladeRF_nios.c
 
 all: $(NIOS_BUILD_OUTDIR)/bladeRF_nios.sim
 
-bladeRF_nios.sim: $(SRC)
+$(NIOS_BUILD_OUTDIR)/bladeRF_nios.sim: $(SRC)
+	mkdir -p $(NIOS_BUILD_OUTDIR)
 	$(CC) $(CFLAGS) $^ -o $@
 
 clean:
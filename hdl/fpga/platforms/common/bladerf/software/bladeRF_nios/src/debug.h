@@ -28,8 +28,17 @@
 
 #ifdef BLADERF_NIOS_PC_SIMULATION
 #   include <stdio.h>
+#   include <stdbool.h>
 
-#   define DBG(...) fprintf(stderr,  __VA_ARGS__)
+    /* Set by devices_sim.c while it repeats a request for timing, to keep
+     * console output out of the measurement */
+    extern bool sim_quiet;
+
+#   define DBG(...) do { \
+        if (!sim_quiet) { \
+            fprintf(stderr,  __VA_ARGS__); \
+        } \
+    } while (0)
 
     /* Always keep assert() enabled for PC simulation */
 #   ifdef NDEBUG
@@ -50,6 +59,10 @@ static inline void print_bytes(const char *msg, const uint8_t *bytes, size_t n)
 {
     size_t i;
 
+    if (sim_quiet) {
+        return;
+    }
+
     if (msg != NULL) {
         puts(msg);
     }
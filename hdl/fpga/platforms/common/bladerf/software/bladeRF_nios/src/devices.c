@@ -238,6 +238,27 @@ void tamer_schedule(bladerf_module m, uint64_t time)
     return;
 }
 
+void tamer_enable_isr(bladerf_module m, bool enable)
+{
+    if (m == BLADERF_MODULE_RX) {
+        if (enable) {
+            alt_ic_irq_enable(RX_TAMER_IRQ_INTERRUPT_CONTROLLER_ID,
+                              RX_TAMER_IRQ);
+        } else {
+            alt_ic_irq_disable(RX_TAMER_IRQ_INTERRUPT_CONTROLLER_ID,
+                               RX_TAMER_IRQ);
+        }
+    } else {
+        if (enable) {
+            alt_ic_irq_enable(TX_TAMER_IRQ_INTERRUPT_CONTROLLER_ID,
+                              TX_TAMER_IRQ);
+        } else {
+            alt_ic_irq_disable(TX_TAMER_IRQ_INTERRUPT_CONTROLLER_ID,
+                               TX_TAMER_IRQ);
+        }
+    }
+}
+
 void bladerf_nios_init(struct pkt_buf *pkt,
                        struct vctcxo_tamer_pkt_buf *vctcxo_tamer_pkt)
 {
@@ -874,6 +895,22 @@ uint8_t rx_trigger_ctl_read(void)
     return IORD_ALTERA_AVALON_PIO_DATA(RX_TRIGGER_CTL_BASE);
 }
 
+/* The RX decimation PIO is output-only, so its value is shadowed here */
+static uint32_t rx_decim_ctl;
+
+void rx_decim_ctl_write(uint32_t val)
+{
+    rx_decim_ctl = val;
+#ifdef RX_DECIM_CTL_BASE
+    IOWR_ALTERA_AVALON_PIO_DATA(RX_DECIM_CTL_BASE, val);
+#endif
+}
+
+uint32_t rx_decim_ctl_read(void)
+{
+    return rx_decim_ctl;
+}
+
 void agc_dc_corr_write(uint16_t addr, uint16_t value)
 {
 // Applies only to bladeRF1
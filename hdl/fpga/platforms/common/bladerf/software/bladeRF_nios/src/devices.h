@@ -99,14 +99,6 @@
 #   define VT_STAT_ERR_10S   (1<<1)
 #   define VT_STAT_ERR_100S  (1<<2)
 
-/* Number of RFFE fast lock profiles to store in the Nios.
- * Make sure this matches what is defined in bladerf2.c.
- */
-#define NUM_BBP_FASTLOCK_PROFILES  256
-
-/* Number of fast lock profiles that can be stored in the RFFE */
-#define NUM_RFFE_FASTLOCK_PROFILES 8
-
 /* Enable libad936x if we have enough RAM. Note that it is very important
  * that all calls to ad9361_* be ifdef-wrapped! */
 #   if RAM_SPAN >= 131072
@@ -116,8 +108,19 @@
 #else
 #   define INLINE
     void SIMULATION_FLUSH_UART();
+
+    /* Stand-in for alt_ic_isr_register() of a time tamer interrupt */
+    void sim_tamer_isr_register(bladerf_module m, void (*isr)(void *context));
 #endif
 
+/* Number of RFFE fast lock profiles to store in the Nios.
+ * Make sure this matches what is defined in bladerf2.c.
+ */
+#define NUM_BBP_FASTLOCK_PROFILES  256
+
+/* Number of fast lock profiles that can be stored in the RFFE */
+#define NUM_RFFE_FASTLOCK_PROFILES 8
+
 /* Define a global variable containing the current VCTCXO DAC setting.
  * This is a 'cached' value of what is written to the DAC and is used
  * for the calibration algorithm to avoid unnecessary read requests
@@ -331,6 +334,20 @@ void adf400x_spi_write(uint32_t val);
  */
 uint32_t adf400x_spi_read(uint8_t addr);
 
+/**
+ * Write the RX decimation/NCO control register
+ *
+ * @param   val     Register value (see RX_DECIM_* in bladerf2_common.h)
+ */
+void rx_decim_ctl_write(uint32_t val);
+
+/**
+ * Read the RX decimation/NCO control register
+ *
+ * @return  Register value
+ */
+uint32_t rx_decim_ctl_read(void);
+
 /**
  * Write a value to the ADF4351 synthesizer (on the XB-200)
  *
@@ -356,6 +373,20 @@ INLINE uint32_t control_reg_read(void);
  */
 INLINE void control_reg_write(uint32_t value);
 
+/**
+ * Read the RFFE control/status register
+ *
+ * @return RFFE CSR bit map
+ */
+INLINE uint32_t rffe_csr_read(void);
+
+/**
+ * Write the RFFE control/status register
+ *
+ * @param   value   RFFE CSR bit map
+ */
+INLINE void rffe_csr_write(uint32_t value);
+
 /**
  * Get IQ balance gain value
  *
@@ -451,6 +482,14 @@ INLINE void timer_tamer_clear_interrupt(bladerf_module m);
  */
 void tamer_schedule(bladerf_module m, uint64_t time);
 
+/**
+ * Enable or disable the time tamer interrupt of the specified module
+ *
+ * @param   m       Module whose interrupt to enable or disable
+ * @param   enable  true or false
+ */
+void tamer_enable_isr(bladerf_module m, bool enable);
+
 /**
  * Read the command UART request buffer
  */
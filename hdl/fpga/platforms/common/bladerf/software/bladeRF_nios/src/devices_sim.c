@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <time.h>
 
 #include "pkt_handler.h"
 #include "devices.h"
@@ -40,6 +41,99 @@ bool run_nios = true;
 
 static size_t test_case_idx = 0;
 
+/* Timing of a test case's repeated requests */
+bool sim_quiet = false;
+static unsigned int repeats_left = 0;
+static unsigned int repeats_timed = 0;
+static uint64_t repeat_ns = 0;
+static struct timespec request_time;
+
+/* Simulated time tamers, indexed by module. The counters only move when a
+ * test case advances them. */
+static uint64_t tamer_time[2] = { 0x123456780a1b2c3d, 0x87654321a1b2c3d4 };
+static uint64_t tamer_armed_time[2];
+static bool tamer_armed[2];
+static bool tamer_pending[2];
+static bool tamer_isr_enabled[2] = { true, true };
+static void (*tamer_isr[2])(void *context);
+
+/* NINT values of the retunes performed since the previous test case */
+static uint16_t retune_log[SIM_RETUNE_LOG_MAX];
+static size_t retune_log_len = 0;
+
+static inline size_t tamer_idx(bladerf_module m)
+{
+    ASSERT(m == BLADERF_MODULE_RX || m == BLADERF_MODULE_TX);
+    return (m == BLADERF_MODULE_RX) ? 0 : 1;
+}
+
+static void tamer_deliver(size_t i)
+{
+    if (tamer_pending[i] && tamer_isr_enabled[i] && tamer_isr[i] != NULL) {
+        tamer_isr[i](NULL);
+    }
+}
+
+/* Advance both timestamp counters, firing any tamer whose armed time is
+ * reached along the way */
+static void tamer_advance(uint64_t ticks)
+{
+    size_t i;
+
+    for (i = 0; i < 2; i++) {
+        tamer_time[i] += ticks;
+
+        if (tamer_armed[i] && tamer_time[i] >= tamer_armed_time[i]) {
+            tamer_armed[i] = false;
+            tamer_pending[i] = true;
+            tamer_deliver(i);
+        }
+    }
+}
+
+static void check_retunes(const struct test_case *t)
+{
+    size_t i, n = 0;
+
+    while (n < SIM_RETUNE_LOG_MAX && t->retunes[n] != 0) {
+        n++;
+    }
+
+    if (n != retune_log_len ||
+        memcmp(retune_log, t->retunes, n * sizeof(retune_log[0]))) {
+        printf("Performed retunes:");
+        for (i = 0; i < retune_log_len; i++) {
+            printf(" 0x%03x", retune_log[i]);
+        }
+        printf("\nExpected retunes: ");
+        for (i = 0; i < n; i++) {
+            printf(" 0x%03x", t->retunes[i]);
+        }
+        printf("\nFailed.\n");
+
+        if (!getenv("CONTINUE_ON_FAIL")) {
+            ASSERT(!"Aborting due to failed test case.\n");
+        }
+    }
+
+    retune_log_len = 0;
+}
+
+static uint64_t elapsed_ns(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000 +
+           (now.tv_nsec - start->tv_nsec);
+}
+
+uint16_t vctcxo_trim_dac_value;
+uint8_t vctcxo_tamer_ctrl_reg;
+fastlock_profile fastlocks_rx[NUM_BBP_FASTLOCK_PROFILES];
+fastlock_profile fastlocks_tx[NUM_BBP_FASTLOCK_PROFILES];
+
 const char *module2str(bladerf_module m)
 {
     switch (m) {
@@ -54,7 +148,8 @@ const char *module2str(bladerf_module m)
     }
 }
 
-void bladerf_nios_init(struct pkt_buf *pkt)
+void bladerf_nios_init(struct pkt_buf *pkt,
+                       struct vctcxo_tamer_pkt_buf *vctcxo_tamer_pkt)
 {
     DBG("%s()\n", __FUNCTION__);
 }
@@ -134,7 +229,10 @@ uint32_t control_reg_read(void)
 void control_reg_write(uint32_t value)
 {
     DBG("%s: value=0x%08x\n", __FUNCTION__, value);
-    ASSERT(value == 0x80402057);
+
+    /* Either the config write test case, or the RX high band selection made
+     * by a retune */
+    ASSERT(value == 0x80402057 || value == 0x8abcde37);
 }
 
 uint16_t iqbal_get_gain(bladerf_module m)
@@ -250,22 +348,7 @@ void expansion_port_set_direction(uint32_t dir)
 
 uint64_t time_tamer_read(bladerf_module m)
 {
-    uint64_t ret = (uint64_t) -1;
-
-    switch (m) {
-        case BLADERF_MODULE_RX:
-            ret = 0x123456780a1b2c3d;
-            break;
-
-        case BLADERF_MODULE_TX:
-            ret = 0x87654321a1b2c3d4;
-            break;
-
-        default:
-            DBG("%s: Invalid module %u\n", __FUNCTION__, m);
-            ASSERT(0);
-            break;
-    }
+    const uint64_t ret = tamer_time[tamer_idx(m)];
 
     DBG("%s: module=%s, returning 0x%016"PRIx64"\n",
          __FUNCTION__, module2str(m), ret);
@@ -289,24 +372,122 @@ void time_tamer_reset(bladerf_module m)
     DBG("%s: module=%s\n", __FUNCTION__, module2str(m));
 }
 
-void time_tamer_clear_interrupt(bladerf_module m)
+void timer_tamer_clear_interrupt(bladerf_module m)
 {
-    switch (m) {
-        case BLADERF_MODULE_RX:
-        case BLADERF_MODULE_TX:
-            break;
-
-        default:
-            DBG("%s: Invalid module %u\n", __FUNCTION__, m);
-            ASSERT(0);
-            break;
-    }
+    tamer_pending[tamer_idx(m)] = false;
 
     DBG("%s: module=%s\n", __FUNCTION__, module2str(m));
 }
 
+void tamer_enable_isr(bladerf_module m, bool enable)
+{
+    const size_t i = tamer_idx(m);
+
+    DBG("%s: module=%s, enable=%s\n", __FUNCTION__, module2str(m),
+        enable ? "true" : "false");
+
+    tamer_isr_enabled[i] = enable;
+    tamer_deliver(i);
+}
+
+void sim_tamer_isr_register(bladerf_module m, void (*isr)(void *context))
+{
+    tamer_isr[tamer_idx(m)] = isr;
+}
+
+uint32_t rffe_csr_read(void)
+{
+    DBG("%s: returning 0\n", __FUNCTION__);
+    return 0;
+}
+
+void rffe_csr_write(uint32_t value)
+{
+    DBG("%s: value=0x%08x\n", __FUNCTION__, value);
+}
+
+void tx_trigger_ctl_write(uint8_t data)
+{
+    DBG("%s: data=0x%02x\n", __FUNCTION__, data);
+}
+
+uint8_t tx_trigger_ctl_read(void)
+{
+    DBG("%s: returning 0\n", __FUNCTION__);
+    return 0;
+}
+
+void rx_trigger_ctl_write(uint8_t data)
+{
+    DBG("%s: data=0x%02x\n", __FUNCTION__, data);
+}
+
+uint8_t rx_trigger_ctl_read(void)
+{
+    DBG("%s: returning 0\n", __FUNCTION__);
+    return 0;
+}
+
+void agc_dc_corr_write(uint16_t addr, uint16_t value)
+{
+    DBG("%s: addr=0x%04x, value=0x%04x\n", __FUNCTION__, addr, value);
+}
+
+void vctcxo_tamer_enable_isr(bool enable)
+{
+    DBG("%s: enable=%s\n", __FUNCTION__, enable ? "true" : "false");
+}
+
+void vctcxo_tamer_reset_counters(bool reset)
+{
+    DBG("%s: reset=%s\n", __FUNCTION__, reset ? "true" : "false");
+}
+
+void vctcxo_tamer_set_tune_mode(bladerf_vctcxo_tamer_mode mode)
+{
+    DBG("%s: mode=%d\n", __FUNCTION__, mode);
+}
+
+bladerf_vctcxo_tamer_mode vctcxo_tamer_get_tune_mode()
+{
+    DBG("%s: returning BLADERF_VCTCXO_TAMER_DISABLED\n", __FUNCTION__);
+    return BLADERF_VCTCXO_TAMER_DISABLED;
+}
+
+void adi_fastlock_load(bladerf_module m, fastlock_profile *p)
+{
+    DBG("%s: module=%s, profile=%u\n", __FUNCTION__, module2str(m),
+        p->profile_num);
+}
+
+void adi_fastlock_recall(bladerf_module m, fastlock_profile *p)
+{
+    DBG("%s: module=%s, profile=%u\n", __FUNCTION__, module2str(m),
+        p->profile_num);
+}
+
+void adi_rfport_select(fastlock_profile *p)
+{
+    DBG("%s: port=0x%02x\n", __FUNCTION__, p->port);
+}
+
+void adi_rfspdt_select(bladerf_module m, fastlock_profile *p)
+{
+    DBG("%s: module=%s, spdt=0x%02x\n", __FUNCTION__, module2str(m), p->spdt);
+}
+
 void tamer_schedule(bladerf_module m, uint64_t time) {
-    DBG("%s: module=%s, time=%"PRIu64"\n", __FUNCTION__, module2str(m), time);
+    const size_t i = tamer_idx(m);
+
+    DBG("%s: module=%s, time=0x%016"PRIx64"\n", __FUNCTION__, module2str(m),
+        time);
+
+    tamer_armed_time[i] = time;
+    tamer_armed[i] = true;
+
+    /* Per tamer_schedule()'s description, a time already passed fires
+     * immediately */
+    tamer_advance(0);
 }
 
 int lms_set_precalculated_frequency(struct bladerf *dev, bladerf_module mod,
@@ -315,6 +496,10 @@ int lms_set_precalculated_frequency(struct bladerf *dev, bladerf_module mod,
     DBG("%s: module=%s, nint=0x%04x, nfrac=0x%08x, freqsel=0x%02x, flags=0x%02x\n",
         __FUNCTION__, module2str(mod), f->nint, f->nfrac, f->freqsel, f->flags);
 
+    if (retune_log_len < SIM_RETUNE_LOG_MAX) {
+        retune_log[retune_log_len++] = f->nint;
+    }
+
     return 0;
 }
 
@@ -328,15 +513,36 @@ int lms_select_band(struct bladerf *dev, bladerf_module module, bool low_band)
 
 void command_uart_read_request(uint8_t *req) {
 
+    /* Issue the remaining repeats of the previous test case quietly, timing
+     * each from the request's arrival to its response */
+    if (repeats_left > 0) {
+        memcpy(req, &test_cases[test_case_idx - 1].req, NIOS_PKT_LEN);
+        repeats_left--;
+
+        if (test_case_idx == ARRAY_SIZE(test_cases) && repeats_left == 0) {
+            run_nios = false;
+        }
+
+        sim_quiet = true;
+        clock_gettime(CLOCK_MONOTONIC, &request_time);
+        return;
+    }
+
     printf("\nTest case %-2zd: %s\n", test_case_idx + 1,
             test_cases[test_case_idx].desc);
     printf("--------------------------------------------------------\n");
 
     if (test_case_idx < ARRAY_SIZE(test_cases)) {
+        check_retunes(&test_cases[test_case_idx]);
+        tamer_advance(test_cases[test_case_idx].advance);
+
         memcpy(req, &test_cases[test_case_idx].req, NIOS_PKT_LEN);
+        repeats_left = test_cases[test_case_idx].repeat;
+        repeats_timed = 0;
+        repeat_ns = 0;
         test_case_idx++;
 
-        if (test_case_idx == ARRAY_SIZE(test_cases)) {
+        if (test_case_idx == ARRAY_SIZE(test_cases) && repeats_left == 0) {
             run_nios = false;
         }
     } else {
@@ -347,7 +553,15 @@ void command_uart_read_request(uint8_t *req) {
 }
 
 void command_uart_write_response(uint8_t *resp) {
-    print_bytes("Response data:", resp, NIOS_PKT_LEN);
+    const bool timed = sim_quiet;
+
+    if (timed) {
+        repeat_ns += elapsed_ns(&request_time);
+        repeats_timed++;
+        sim_quiet = false;
+    } else {
+        print_bytes("Response data:", resp, NIOS_PKT_LEN);
+    }
 
     /* At this point, we'll already have incremented the test_case_idx past
      * this test. */
@@ -358,9 +572,14 @@ void command_uart_write_response(uint8_t *resp) {
         if (!getenv("CONTINUE_ON_FAIL")) {
                 ASSERT(!"Aborting due to failed test case.\n");
         }
-    } else {
+    } else if (!timed) {
         printf("Pass.\n\n");
     }
+
+    if (timed && repeats_left == 0) {
+        printf("Request to response: %u ns average over %u repeats\n\n",
+               (unsigned int) (repeat_ns / repeats_timed), repeats_timed);
+    }
 }
 
 bool rfic_command_write(uint16_t addr, uint64_t data)
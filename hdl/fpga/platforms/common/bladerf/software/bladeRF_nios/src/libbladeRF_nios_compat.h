@@ -91,7 +91,9 @@ struct bladerf;
     })
 
 /* Stub out pthread type */
+#ifndef BLADERF_NIOS_PC_SIMULATION
 typedef void *pthread_cond_t;
+#endif
 
 #endif
 
@@ -62,6 +62,12 @@ static inline bool perform_read(uint8_t id, uint8_t addr, uint32_t *data)
             return false;
 #endif  // BOARD_BLADERF_MICRO
 
+#ifdef BOARD_BLADERF_MICRO
+        case NIOS_PKT_8x32_TARGET_RX_DECIM:
+            *data = rx_decim_ctl_read();
+            break;
+#endif  // BOARD_BLADERF_MICRO
+
         default:
             DBG("Invalid id: 0x%x\n", id);
             *data = 0x00;
@@ -102,6 +108,12 @@ static inline bool perform_write(uint8_t id, uint8_t addr, uint32_t data)
             break;
 #endif  // BOARD_BLADERF_MICRO
 
+#ifdef BOARD_BLADERF_MICRO
+        case NIOS_PKT_8x32_TARGET_RX_DECIM:
+            rx_decim_ctl_write(data);
+            break;
+#endif  // BOARD_BLADERF_MICRO
+
         default:
             DBG("Invalid id: 0x%x\n", id);
             return false;
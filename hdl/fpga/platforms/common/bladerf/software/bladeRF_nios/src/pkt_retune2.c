@@ -27,6 +27,7 @@
 #include "pkt_retune2.h"
 #include "nios_pkt_retune2.h"    /* Packet format definition */
 #include "devices.h"
+#include "retune_queue.h"
 #include "debug.h"
 
 #ifdef BLADERF_NIOS_LIBAD936X
@@ -40,124 +41,13 @@ void rfic_invalidate_frequency(bladerf_module module);
 #   define INCREMENT_ERROR_COUNT() do {} while (0)
 #endif
 
-/* The enqueue/dequeue routines require that this be a power of two */
-#define RETUNE2_QUEUE_MAX   16
-#define QUEUE_FULL          0xff
-#define QUEUE_EMPTY         0xfe
-
-/* State of items in the retune queue */
-enum entry_state {
-    ENTRY_STATE_INVALID = 0,  /* Marks entry invalid and not in use */
-    ENTRY_STATE_NEW,          /* We have a new retune request to satisfy */
-    ENTRY_STATE_SCHEDULED,    /* We've scheduled the timer interrupt for
-                               * this entry and are awaiting the ISR */
-    ENTRY_STATE_READY,        /* The timer interrupt has fired - we should
-                               * handle this retune */
-    ENTRY_STATE_DONE,         /* Retune is complete */
-};
-
-struct queue_entry {
-    volatile enum entry_state state;
-    fastlock_profile *profile;
-    uint64_t timestamp;
-};
-
-static struct queue {
-    uint8_t count;      /* Total number of items in the queue */
-    uint8_t ins_idx;    /* Insertion index */
-    uint8_t rem_idx;    /* Removal index */
-
-    struct queue_entry entries[RETUNE2_QUEUE_MAX];
-} rx_queue, tx_queue;
-
-/* Returns queue size after enqueue operation, or QUEUE_FULL if we could
- * not enqueue the requested item */
-static inline uint8_t enqueue_retune(struct queue *q,
-                                     fastlock_profile *p,
-                                     uint64_t timestamp)
-{
-    uint8_t ret;
+/* Number of fast lock profile slots in the RFFE */
+#define RFFE_PROFILE_SLOTS  8
 
-    if (q->count >= RETUNE2_QUEUE_MAX) {
-        return QUEUE_FULL;
-    }
-
-    q->entries[q->ins_idx].profile = p;
-    q->entries[q->ins_idx].state = ENTRY_STATE_NEW;
-    q->entries[q->ins_idx].timestamp = timestamp;
-
-    q->ins_idx = (q->ins_idx + 1) & (RETUNE2_QUEUE_MAX - 1);
-
-    q->count++;
-    ret = q->count;
-
-    return ret;
-}
-
-/* Retune number of items left in the queue after the dequeue operation,
- * or QUEUE_EMPTY if there was nothing to dequeue */
-static inline uint8_t dequeue_retune(struct queue *q, struct queue_entry *e)
-{
-    uint8_t ret;
-
-    if (q->count == 0) {
-        return QUEUE_EMPTY;
-    }
-
-    if (e != NULL) {
-        memcpy(&e, &q->entries[q->rem_idx], sizeof(e[0]));
-    }
-
-    q->entries[q->rem_idx].state = ENTRY_STATE_DONE;
-    q->rem_idx = (q->rem_idx + 1) & (RETUNE2_QUEUE_MAX - 1);
-
-    q->count--;
-    ret = q->count;
-
-    return ret;
-}
-
-/* Get the state of the next item in the retune queue */
-static inline struct queue_entry* peek_next_retune(struct queue *q)
-{
-    if (q == NULL) {
-        return NULL;
-    } else if (q->count == 0) {
-        return NULL;
-    } else {
-        return &q->entries[q->rem_idx];
-    }
-}
-
-/* Get the queue element at the given offset relative to the removal index */
-static inline struct queue_entry* peek_next_retune_offset(struct queue *q,
-                                                           uint8_t offset)
-{
-    if (q == NULL) {
-        return NULL;
-    } else if (q->count == 0) {
-        return NULL;
-    } else {
-        return &q->entries[(q->rem_idx + offset) & (RETUNE2_QUEUE_MAX - 1)];
-    }
-}
-
-/* The retune interrupt may fire while this call is occuring, so we should
- * perform these operations in an order that minimizes the race window, and
- * does not cause the race to be problematic. It's fine if the last retune
- * occurs before we can cancel it. */
-static void reset_queue(struct queue *q)
-{
-    unsigned int i;
-
-    q->count = 0;
-
-    for (i = 0; i < RETUNE2_QUEUE_MAX; i++) {
-        q->entries[i].state = ENTRY_STATE_INVALID;
-    }
-
-    q->rem_idx = q->ins_idx = 0;
-}
+/* Scheduled retunes, and their fast lock profiles indexed by queue slot */
+static struct retune_queue rx_queue, tx_queue;
+static fastlock_profile *rx_profiles[RETUNE_QUEUE_MAX];
+static fastlock_profile *tx_profiles[RETUNE_QUEUE_MAX];
 
 static inline void profile_load(bladerf_module module, fastlock_profile *p)
 {
@@ -168,32 +58,41 @@ static inline void profile_load(bladerf_module module, fastlock_profile *p)
     adi_fastlock_load(module, p);
 }
 
-static inline void profile_load_scheduled(struct queue *q,
+static inline void profile_load_scheduled(struct retune_queue *q,
+                                          fastlock_profile **profiles,
                                           bladerf_module module)
 {
-    struct queue_entry *e;
-    uint32_t i;
-    uint8_t  used = 0;
-
-    if ((q == NULL) || (q->count == 0)) {
-        return;
+    const struct retune_queue_entry *next[RFFE_PROFILE_SLOTS] = { NULL };
+    const struct retune_queue_entry *e;
+    uint8_t i, n;
+    uint8_t used = 0;
+
+    /* The armed retune's profile is already loaded, and must not be
+     * overwritten before it is activated */
+    if (retune_queue_head_armed(q)) {
+        used |= 1 << profiles[q->heap[0].slot]->profile_num;
     }
 
-    /* Check the contents of the retune queue and load all the profiles we can
-     * without causing them to step on each other. This should reduce retune
-     * times in most scenarios because the profile will have already been
-     * loaded into the RFFE when it becomes time to retune. */
+    /* For each RFFE profile slot, find the earliest pending retune that uses
+     * it. Loading these ahead of time should reduce retune times in most
+     * scenarios because the profile will have already been loaded into the
+     * RFFE when it becomes time to retune. */
     for (i = 0; i < q->count; i++) {
-        e = peek_next_retune_offset(q, i);
-        if( e != NULL ) {
-            if (e->state == ENTRY_STATE_NEW) {
-                if ( !(used & (1 << e->profile->profile_num)) ) {
-                    /* Profile slot is available in RFFE, fill it */
-                    profile_load(module, e->profile);
-                    /* Mark profile slot used */
-                    used |= 1 << e->profile->profile_num;
-                }
-            }
+        e = &q->heap[i];
+        n = profiles[e->slot]->profile_num;
+
+        if (n >= RFFE_PROFILE_SLOTS || (used & (1 << n))) {
+            continue;
+        }
+
+        if (next[n] == NULL || e->timestamp < next[n]->timestamp) {
+            next[n] = e;
+        }
+    }
+
+    for (n = 0; n < RFFE_PROFILE_SLOTS; n++) {
+        if (next[n] != NULL) {
+            profile_load(module, profiles[next[n]->slot]);
         }
     }
 }
@@ -219,24 +118,11 @@ static inline void profile_activate(bladerf_module module, fastlock_profile *p)
     adi_rfspdt_select(module, p);
 }
 
-static inline void retune_isr(struct queue *q)
-{
-    struct queue_entry *e = peek_next_retune(q);
-    if (e != NULL) {
-        if (e->state == ENTRY_STATE_SCHEDULED) {
-            e->state = ENTRY_STATE_READY;
-        } else {
-            INCREMENT_ERROR_COUNT();
-        }
-    }
-}
 
-
-#ifndef BLADERF_NIOS_PC_SIMULATION
 static void retune_rx(void *context)
 {
     /* Handle the ISR */
-    retune_isr(&rx_queue);
+    retune_queue_isr(&rx_queue);
 
     /* Clear the interrupt */
     timer_tamer_clear_interrupt(BLADERF_MODULE_RX);
@@ -245,18 +131,17 @@ static void retune_rx(void *context)
 static void retune_tx(void *context)
 {
     /* Handle the ISR */
-    retune_isr(&tx_queue);
+    retune_queue_isr(&tx_queue);
 
     /* Clear the interrupt */
     timer_tamer_clear_interrupt(BLADERF_MODULE_TX);
 }
-#endif
 
 
 void pkt_retune2_init()
 {
-    reset_queue(&rx_queue);
-    reset_queue(&tx_queue);
+    retune_queue_reset(&rx_queue);
+    retune_queue_reset(&tx_queue);
 
 #ifndef BLADERF_NIOS_PC_SIMULATION
 
@@ -277,55 +162,43 @@ void pkt_retune2_init()
         NULL,
         NULL
     ) ;
+#else
+    sim_tamer_isr_register(BLADERF_MODULE_RX, retune_rx);
+    sim_tamer_isr_register(BLADERF_MODULE_TX, retune_tx);
 #endif
 }
 
-static inline void perform_work(struct queue *q, bladerf_module module)
+static inline void perform_work(struct retune_queue *q,
+                                fastlock_profile **profiles,
+                                bladerf_module module)
 {
-    struct queue_entry *e = peek_next_retune(q);
+    const struct retune_queue_entry *e = retune_queue_peek(q);
 
     if (e == NULL) {
         return;
     }
 
-    switch (e->state) {
-        case ENTRY_STATE_NEW:
-
-            /* Load the fast lock profile into the RFFE */
-            profile_load(module, e->profile);
-
-            /* Schedule the retune */
-            e->state = ENTRY_STATE_SCHEDULED;
-            tamer_schedule(module, e->timestamp);
-
-            break;
-
-        case ENTRY_STATE_SCHEDULED:
-
-            /* Nothing to do.
-             * Waiting for this entry to become ready */
-            break;
-
-        case ENTRY_STATE_READY:
-
-            /* Activate the fast lock profile for this retune */
-            profile_activate(module, e->profile);
+    /* Load the fast lock profile into the RFFE before scheduling the retune.
+     * It may have been displaced by a retune inserted ahead of it. */
+    if (!retune_queue_head_armed(q)) {
+        profile_load(module, profiles[e->slot]);
+    }
 
-            /* Drop the item from the queue */
-            dequeue_retune(q, NULL);
+    if (!retune_queue_due(q, module)) {
+        return;
+    }
 
-            break;
+    /* Activate the fast lock profile for this retune */
+    profile_activate(module, profiles[e->slot]);
 
-        default:
-            INCREMENT_ERROR_COUNT();
-            break;
-    }
+    /* Drop the item from the queue */
+    retune_queue_pop(q);
 }
 
 void pkt_retune2_work(void)
 {
-    perform_work(&rx_queue, BLADERF_MODULE_RX);
-    perform_work(&tx_queue, BLADERF_MODULE_TX);
+    perform_work(&rx_queue, rx_profiles, BLADERF_MODULE_RX);
+    perform_work(&tx_queue, tx_profiles, BLADERF_MODULE_TX);
 }
 
 void pkt_retune2(struct pkt_buf *b)
@@ -341,28 +214,45 @@ void pkt_retune2(struct pkt_buf *b)
     uint8_t rffe_profile;
     uint8_t port;
     uint8_t spdt;
+    uint8_t id;
+    uint8_t cancelled = 0;
     fastlock_profile *profile;
+    fastlock_profile **profiles;
+    struct retune_queue *q;
 
     flags = NIOS_PKT_RETUNE2_RESP_FLAG_SUCCESS;
 
     nios_pkt_retune2_unpack(b->req, &module, &timestamp,
                             &nios_profile, &rffe_profile, &port, &spdt);
 
+    id = nios_pkt_retune2_get_id(b->req);
+
     switch (module) {
         case BLADERF_MODULE_RX:
             profile = &fastlocks_rx[nios_profile];
+            profiles = rx_profiles;
+            q = &rx_queue;
             break;
         case BLADERF_MODULE_TX:
             profile = &fastlocks_tx[nios_profile];
+            profiles = tx_profiles;
+            q = &tx_queue;
             break;
         default:
             profile = NULL;
+            profiles = NULL;
+            q = NULL;
     }
 
-    if (profile == NULL) {
+    if (q == NULL) {
         INCREMENT_ERROR_COUNT();
-        status = -1;
-    } else {
+        nios_pkt_retune2_resp_pack(b->resp, 0, 0);
+        return;
+    }
+
+    /* Cancellation and queue clearing requests carry no profile data */
+    if (timestamp != NIOS_PKT_RETUNE2_CLEAR_QUEUE &&
+        timestamp != NIOS_PKT_RETUNE2_CANCEL) {
         /* Update the fastlock profile data */
         profile->profile_num = rffe_profile;
         profile->port = port;
@@ -372,66 +262,32 @@ void pkt_retune2(struct pkt_buf *b)
     start_time = time_tamer_read(module);
 
     if (timestamp == NIOS_PKT_RETUNE2_NOW) {
-        /* Fire off this retune operation now */
-        switch (module) {
-            case BLADERF_MODULE_RX:
-            case BLADERF_MODULE_TX:
-
-                /* Load the profile data into RFFE memory */
-                profile_load(module, profile);
+        /* Load the profile data into RFFE memory */
+        profile_load(module, profile);
 
-                /* Activate the fast lock profile for this retune */
-                profile_activate(module, profile);
+        /* Activate the fast lock profile for this retune */
+        profile_activate(module, profile);
 
-                flags |= NIOS_PKT_RETUNE2_RESP_FLAG_TSVTUNE_VALID;
+        flags |= NIOS_PKT_RETUNE2_RESP_FLAG_TSVTUNE_VALID;
 
-                status = 0;
-                break;
-
-            default:
-                INCREMENT_ERROR_COUNT();
-                status = -1;
-        }
+        status = 0;
 
     } else if (timestamp == NIOS_PKT_RETUNE2_CLEAR_QUEUE) {
-        switch (module) {
-            case BLADERF_MODULE_RX:
-                reset_queue(&rx_queue);
-                status = 0;
-                break;
-
-            case BLADERF_MODULE_TX:
-                reset_queue(&tx_queue);
-                status = 0;
-                break;
-
-            default:
-                INCREMENT_ERROR_COUNT();
-                status = -1;
-        }
-    } else {
-        uint8_t queue_size;
-
-        switch (module) {
-            case BLADERF_MODULE_RX:
-                queue_size = enqueue_retune(&rx_queue, profile, timestamp);
-                profile_load_scheduled(&rx_queue, module);
-                break;
-
-            case BLADERF_MODULE_TX:
-                queue_size = enqueue_retune(&tx_queue, profile, timestamp);
-                profile_load_scheduled(&tx_queue, module);
-                break;
+        retune_queue_reset(q);
+        status = 0;
 
-            default:
-                INCREMENT_ERROR_COUNT();
-                queue_size = QUEUE_FULL;
+    } else if (timestamp == NIOS_PKT_RETUNE2_CANCEL) {
+        cancelled = retune_queue_cancel(q, id);
+        status = 0;
 
-        }
+    } else {
+        uint8_t slot = retune_queue_insert(q, timestamp, id);
 
-        if (queue_size == QUEUE_FULL) {
+        if (slot == RETUNE_QUEUE_FULL) {
             status = -1;
         } else {
+            profiles[slot] = profile;
+            profile_load_scheduled(q, profiles, module);
             status = 0;
         }
     }
@@ -444,4 +300,6 @@ void pkt_retune2(struct pkt_buf *b)
     }
 
     nios_pkt_retune2_resp_pack(b->resp, duration, flags);
+    nios_pkt_retune2_resp_set_status(b->resp, retune_queue_take_missed(q),
+                                     cancelled);
 }
@@ -0,0 +1,208 @@
+/* This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (c) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "retune_queue.h"
+#include "devices.h"
+
+static inline void swap_entries(struct retune_queue_entry *a,
+                                struct retune_queue_entry *b)
+{
+    struct retune_queue_entry tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void sift_up(struct retune_queue *q, uint8_t i)
+{
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+
+        if (q->heap[parent].timestamp <= q->heap[i].timestamp) {
+            break;
+        }
+
+        swap_entries(&q->heap[parent], &q->heap[i]);
+        i = parent;
+    }
+}
+
+static void sift_down(struct retune_queue *q, uint8_t i)
+{
+    while (true) {
+        uint8_t left     = 2 * i + 1;
+        uint8_t right    = left + 1;
+        uint8_t smallest = i;
+
+        if (left < q->count &&
+            q->heap[left].timestamp < q->heap[smallest].timestamp) {
+            smallest = left;
+        }
+
+        if (right < q->count &&
+            q->heap[right].timestamp < q->heap[smallest].timestamp) {
+            smallest = right;
+        }
+
+        if (smallest == i) {
+            break;
+        }
+
+        swap_entries(&q->heap[smallest], &q->heap[i]);
+        i = smallest;
+    }
+}
+
+static void free_slot(struct retune_queue *q, uint8_t slot)
+{
+    /* The slot may be reused by a new entry, which must not be mistaken for
+     * the one that was armed */
+    if (q->armed && q->armed_slot == slot) {
+        q->armed = false;
+    }
+
+    q->free_slots[q->num_free++] = slot;
+}
+
+void retune_queue_reset(struct retune_queue *q)
+{
+    uint8_t i;
+
+    q->count = 0;
+    q->num_free = RETUNE_QUEUE_MAX;
+    q->armed = false;
+    q->fired = false;
+    q->missed = 0;
+
+    for (i = 0; i < RETUNE_QUEUE_MAX; i++) {
+        q->free_slots[i] = i;
+    }
+}
+
+uint8_t retune_queue_insert(struct retune_queue *q, uint64_t timestamp,
+                            uint8_t id)
+{
+    struct retune_queue_entry *e;
+    uint8_t slot;
+
+    if (q->count >= RETUNE_QUEUE_MAX) {
+        return RETUNE_QUEUE_FULL;
+    }
+
+    slot = q->free_slots[--q->num_free];
+
+    e = &q->heap[q->count];
+    e->timestamp = timestamp;
+    e->slot = slot;
+    e->id = id;
+
+    q->count++;
+    sift_up(q, q->count - 1);
+
+    return slot;
+}
+
+uint8_t retune_queue_cancel(struct retune_queue *q, uint8_t id)
+{
+    uint8_t i, kept = 0, removed = 0;
+
+    /* Compact the remaining entries, then restore the heap property */
+    for (i = 0; i < q->count; i++) {
+        if (q->heap[i].id == id) {
+            free_slot(q, q->heap[i].slot);
+            removed++;
+        } else {
+            q->heap[kept++] = q->heap[i];
+        }
+    }
+
+    q->count = kept;
+
+    for (i = kept / 2; i > 0; i--) {
+        sift_down(q, i - 1);
+    }
+
+    return removed;
+}
+
+bool retune_queue_due(struct retune_queue *q, bladerf_module module)
+{
+    const struct retune_queue_entry *e = retune_queue_peek(q);
+
+    if (e == NULL) {
+        return false;
+    }
+
+    if (retune_queue_head_armed(q)) {
+        return q->fired;
+    }
+
+    /* Mask the tamer while re-arming it. Otherwise, an interrupt from the
+     * previously armed timestamp could land after `fired` is cleared, and
+     * perform this retune early. */
+    tamer_enable_isr(module, false);
+    timer_tamer_clear_interrupt(module);
+
+    q->armed = true;
+    q->armed_slot = e->slot;
+    q->fired = false;
+
+    if (time_tamer_read(module) >= e->timestamp) {
+        if (q->missed < UINT8_MAX) {
+            q->missed++;
+        }
+
+        tamer_enable_isr(module, true);
+        return true;
+    }
+
+    tamer_schedule(module, e->timestamp);
+    tamer_enable_isr(module, true);
+
+    /* The time tamer only triggers upon an exact match, so ensure the
+     * timestamp didn't pass while it was being armed */
+    return time_tamer_read(module) >= e->timestamp;
+}
+
+void retune_queue_pop(struct retune_queue *q)
+{
+    if (q->count == 0) {
+        return;
+    }
+
+    free_slot(q, q->heap[0].slot);
+    q->count--;
+
+    if (q->count > 0) {
+        q->heap[0] = q->heap[q->count];
+        sift_down(q, 0);
+    }
+}
+
+uint8_t retune_queue_take_missed(struct retune_queue *q)
+{
+    uint8_t ret = q->missed;
+    q->missed = 0;
+    return ret;
+}
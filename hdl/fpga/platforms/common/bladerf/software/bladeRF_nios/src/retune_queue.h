@@ -0,0 +1,141 @@
+/* This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (c) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Timestamp-ordered queue of scheduled retunes, shared by the retune and
+ * retune2 packet handlers.
+ *
+ * Entries are kept in a binary min-heap keyed on timestamp, so retunes may be
+ * submitted in any order. The payload of each retune (e.g., LMS6002D tuning
+ * words or a fast lock profile) is owned by the packet handler, in an array
+ * indexed by the entry's slot number.
+ *
+ * Only the entry at the head of the queue is ever armed in the time tamer.
+ * The time tamer ISR only sets the `fired` flag, so the heap itself is never
+ * touched from interrupt context.
+ */
+
+#ifndef BLADERF_NIOS_RETUNE_QUEUE_H_
+#define BLADERF_NIOS_RETUNE_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices.h"
+
+#define RETUNE_QUEUE_MAX    32
+#define RETUNE_QUEUE_FULL   0xff
+
+struct retune_queue_entry {
+    uint64_t timestamp; /* When to perform the retune */
+    uint8_t slot;       /* Index of the handler's payload for this retune */
+    uint8_t id;         /* Host-assigned ID, used for cancellation */
+};
+
+struct retune_queue {
+    uint8_t count; /* Total number of items in the queue */
+
+    struct retune_queue_entry heap[RETUNE_QUEUE_MAX];
+
+    /* Stack of payload slots not in use */
+    uint8_t free_slots[RETUNE_QUEUE_MAX];
+    uint8_t num_free;
+
+    bool armed;         /* The head of the queue is armed in the time tamer */
+    uint8_t armed_slot; /* Slot of the armed entry */
+
+    volatile bool fired; /* Set by the time tamer ISR */
+
+    /* Number of retunes whose timestamp had already passed when they reached
+     * the head of the queue. Saturates at UINT8_MAX. */
+    uint8_t missed;
+};
+
+/**
+ * Remove all entries from the queue
+ */
+void retune_queue_reset(struct retune_queue *q);
+
+/**
+ * Insert a retune into the queue
+ *
+ * @return Payload slot for the new retune, or RETUNE_QUEUE_FULL
+ */
+uint8_t retune_queue_insert(struct retune_queue *q, uint64_t timestamp,
+                            uint8_t id);
+
+/**
+ * Remove all entries with the specified ID from the queue
+ *
+ * @return Number of entries removed
+ */
+uint8_t retune_queue_cancel(struct retune_queue *q, uint8_t id);
+
+/**
+ * Get the entry at the head of the queue
+ *
+ * @return Head of the queue, or NULL if the queue is empty
+ */
+static inline const struct retune_queue_entry *
+retune_queue_peek(const struct retune_queue *q)
+{
+    return (q->count == 0) ? NULL : &q->heap[0];
+}
+
+/**
+ * @return true if the head of the queue is currently armed in the time tamer
+ */
+static inline bool retune_queue_head_armed(const struct retune_queue *q)
+{
+    return q->count != 0 && q->armed && q->armed_slot == q->heap[0].slot;
+}
+
+/**
+ * Determine whether the head of the queue is due to be performed, arming the
+ * time tamer for it if it is not already armed. A head whose timestamp has
+ * already passed is due immediately, and is counted as a missed deadline.
+ *
+ * @return true if the head of the queue should be performed and then removed
+ *         via retune_queue_pop()
+ */
+bool retune_queue_due(struct retune_queue *q, bladerf_module module);
+
+/**
+ * Remove the entry at the head of the queue
+ */
+void retune_queue_pop(struct retune_queue *q);
+
+/**
+ * Retrieve, and then clear, the number of missed deadlines
+ */
+uint8_t retune_queue_take_missed(struct retune_queue *q);
+
+/**
+ * To be called from the time tamer ISR
+ */
+static inline void retune_queue_isr(struct retune_queue *q)
+{
+    q->fired = true;
+}
+
+#endif
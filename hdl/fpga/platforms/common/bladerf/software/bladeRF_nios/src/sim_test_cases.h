@@ -26,10 +26,29 @@
 
 #ifdef BLADERF_NIOS_PC_SIMULATION
 
+/* Maximum number of retunes checked by a test case */
+#define SIM_RETUNE_LOG_MAX 8
+
 struct test_case {
     const char *desc;
     const uint8_t req[NIOS_PKT_LEN];
     const uint8_t resp[NIOS_PKT_LEN];
+
+    /* Number of times to issue the request again once it has passed. These
+     * repeats run without console output, and the average time from request
+     * to response is reported. This measures packet dispatch plus the
+     * handler's own work against the simulated devices. */
+    const unsigned int repeat;
+
+    /* Number of ticks to advance the RX and TX timestamp counters by before
+     * issuing the request. Time tamers armed for a timestamp that is reached
+     * fire at this point. */
+    const uint64_t advance;
+
+    /* NINT values of the retunes expected to have been performed, in order,
+     * since the previous test case, terminated by 0. Checked before the
+     * request is issued. */
+    const uint16_t retunes[SIM_RETUNE_LOG_MAX];
 };
 
 static const struct test_case test_cases[] = {
@@ -760,6 +779,155 @@ static const struct test_case test_cases[] = {
         .resp = { 0x4b, 0x01, 0x03, 0x00, 0xff, 0xff, 0xff, 0xff,
                   0x3d, 0x2c, 0x1b, 0x0a, 0x00, 0x00, 0x00, 0x00 },
     },
+
+#ifdef BOARD_BLADERF
+    /* Scheduled retunes, on a simulated RX timestamp counter starting at
+     * 0x123456780a1b2c3d. Each request runs one pass of the queue: a due
+     * retune is performed in the pass after its tamer fires, and the next
+     * one is armed in the pass after that. TX cancel requests for the
+     * unused ID 0xfe fill in the passes without touching the RX queue. */
+
+    {
+        .desc = "Retune: schedule RX, NINT 0x060 at +6000, ID 1",
+        .req  = { 0x54, 0xad, 0x43, 0x1b, 0x0a, 0x78, 0x56, 0x34,
+                  0x12, 0x30, 0x00, 0x00, 0x00, 0x40, 0x00, 0x01 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: schedule RX, NINT 0x020 at +2000, ID 2",
+        .req  = { 0x54, 0x0d, 0x34, 0x1b, 0x0a, 0x78, 0x56, 0x34,
+                  0x12, 0x10, 0x00, 0x00, 0x00, 0x40, 0x00, 0x02 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: schedule RX, NINT 0x080 at +8000, ID 1",
+        .req  = { 0x54, 0x7d, 0x4b, 0x1b, 0x0a, 0x78, 0x56, 0x34,
+                  0x12, 0x40, 0x00, 0x00, 0x00, 0x40, 0x00, 0x01 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: schedule RX, NINT 0x040 at +4000, ID 2",
+        .req  = { 0x54, 0xdd, 0x3b, 0x1b, 0x0a, 0x78, 0x56, 0x34,
+                  0x12, 0x20, 0x00, 0x00, 0x00, 0x40, 0x00, 0x02 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: +1000, nothing due (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 1000,
+    },
+
+    {
+        .desc = "Retune: +2000, NINT 0x020 fires (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 1000,
+    },
+
+    {
+        .desc = "Retune: +3000, NINT 0x020 was performed (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 1000,
+        .retunes = { 0x020 },
+    },
+
+    {
+        .desc = "Retune: +4000, NINT 0x040 fires (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 1000,
+    },
+
+    {
+        .desc = "Retune: +5000, NINT 0x040 was performed (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 1000,
+        .retunes = { 0x040 },
+    },
+
+    {
+        .desc = "Retune: cancel ID 1, including the armed NINT 0x060",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x01 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: +9000, cancelled retunes are not performed (TX request)",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .advance = 4000,
+    },
+
+    {
+        .desc = "Retune: schedule RX, NINT 0x0a0 at +8500, already passed",
+        .req  = { 0x54, 0x71, 0x4d, 0x1b, 0x0a, 0x78, 0x56, 0x34,
+                  0x12, 0x50, 0x00, 0x00, 0x00, 0x40, 0x00, 0x03 },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+
+    {
+        .desc = "Retune: late NINT 0x0a0 performed and reported missed",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00 },
+        .retunes = { 0x0a0 },
+    },
+
+    {
+        .desc = "Retune: missed count is cleared once reported",
+        .req  = { 0x54, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0xfe },
+        .resp = { 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    },
+#endif
+
+    /* Dispatch timing. PKT_8x8 is second and PKT_LEGACY last in the
+     * bladeRF_nios.c handler table. */
+    {
+        .desc = "Timing: 8x8 read from LMS6",
+        .req  = { 0x41, 0x00, 0x00, 0x00, 0x2f, 0x00, 0x00, 0x00,
+                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .resp = { 0x41, 0x00, 0x02, 0x00, 0x2f, 0x17, 0x00, 0x00,
+                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .repeat = 1000000,
+    },
+
+    {
+        .desc = "Timing: legacy read from LMS6[0x2f]",
+        .req  = { 0x4e, 0x91, 0x2f, 0xff, 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        .resp = { 0x4e, 0x91, 0x2f, 0x17, 0xff, 0xff, 0xff, 0xff,
+                  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+        .repeat = 1000000,
+    },
 };
 
 
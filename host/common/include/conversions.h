@@ -215,6 +215,39 @@ char const *tuningmode2str(bladerf_tuning_mode mode);
  */
 const char *backend_description(bladerf_backend b);
 
+/**
+ * Implementations of the SC16Q11 <-> float conversions
+ */
+typedef enum {
+    SAMPLE_CONV_AUTO = 0, /**< Fastest implementation supported by this CPU */
+    SAMPLE_CONV_SCALAR,   /**< Portable C */
+    SAMPLE_CONV_SSE2,     /**< x86 SSE2 */
+    SAMPLE_CONV_AVX2,     /**< x86 AVX2 */
+    SAMPLE_CONV_AVX512,   /**< x86 AVX-512F */
+    SAMPLE_CONV_NEON,     /**< AArch64 NEON */
+} sample_conv_impl;
+
+/**
+ * Determine whether a conversion implementation is available. This depends
+ * upon both the target the program was built for and the CPU it is running
+ * on.
+ *
+ * @param[in]   impl    Implementation to check
+ *
+ * @return true if `impl` may be used on this machine
+ */
+bool sample_conv_supported(sample_conv_impl impl);
+
+/**
+ * Get a string description of a conversion implementation
+ *
+ * @param[in]   impl    Implementation. SAMPLE_CONV_AUTO yields the name of
+ *                      the implementation it currently resolves to.
+ *
+ * @return NUL-terminated string
+ */
+const char *sample_conv_name(sample_conv_impl impl);
+
 /**
  * Convert bladeRF SC16Q11 DAC/ADC samples to floats
  *
@@ -241,12 +274,63 @@ void sc16q11_to_float(const int16_t *in, float *out, unsigned int n);
  * Therefore, the caller must ensure the output buffer large enough to contain
  * 2*n int16_t's (or 2*n*sizeof(int16_t) bytes).
  *
+ * Values are truncated towards zero. Values beyond the range of an int16_t
+ * are clamped to it, rather than wrapping, and NaN values are converted to 0.
+ * Note that the DAC only accepts [-2048, 2047]; see float_to_sc16q11_sat()
+ * for a conversion that honors this.
+ *
  * @param[in]   in      Input buffer containing float samples
  * @param[out]  out     Output buffer of int16_t values
  * @param[in]   n       Number of samples to convert
  */
 void float_to_sc16q11(const float *in, int16_t *out, unsigned int n);
 
+/**
+ * Convert float samples to bladeRF SC16Q11 DAC/ADC format, rounding to the
+ * nearest value (ties to even) and saturating to the DAC's range of
+ * [-2048, 2047]. NaN values are converted to 0.
+ *
+ * Buffers are laid out as described for float_to_sc16q11().
+ *
+ * @param[in]   in      Input buffer containing float samples
+ * @param[out]  out     Output buffer of int16_t values
+ * @param[in]   n       Number of samples to convert
+ */
+void float_to_sc16q11_sat(const float *in, int16_t *out, unsigned int n);
+
+/**
+ * sc16q11_to_float(), using the specified implementation. If `impl` is not
+ * supported, the fastest supported implementation is used instead.
+ *
+ * This is intended for testing and benchmarking.
+ */
+void sc16q11_to_float_impl(sample_conv_impl impl,
+                           const int16_t *in,
+                           float *out,
+                           unsigned int n);
+
+/**
+ * float_to_sc16q11(), using the specified implementation. If `impl` is not
+ * supported, the fastest supported implementation is used instead.
+ *
+ * This is intended for testing and benchmarking.
+ */
+void float_to_sc16q11_impl(sample_conv_impl impl,
+                           const float *in,
+                           int16_t *out,
+                           unsigned int n);
+
+/**
+ * float_to_sc16q11_sat(), using the specified implementation. If `impl` is
+ * not supported, the fastest supported implementation is used instead.
+ *
+ * This is intended for testing and benchmarking.
+ */
+void float_to_sc16q11_sat_impl(sample_conv_impl impl,
+                               const float *in,
+                               int16_t *out,
+                               unsigned int n);
+
 /**
  * Convert a string to a bladerf_cal_module value
  *
@@ -0,0 +1,158 @@
+/**
+ * @file modulator.h
+ *
+ * @brief Table-driven GMSK/CPFSK/PSK burst synthesis
+ *
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (c) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MODULATOR_H_
+#define MODULATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Everything that depends on the pulse shape is computed once, when the
+ * modulator is created, so synthesizing a symbol is either a single block
+ * copy (CPFSK, GMSK) or a short sum of precomputed per-symbol contributions
+ * (PSK). Samples are written as interleaved SC16 Q11 I/Q pairs, directly into
+ * the caller's buffer, which may be a libbladeRF TX buffer.
+ *
+ * Data bits are consumed LSb first. A modulator retains its phase, symbol
+ * history and any leftover bits of a partial symbol between calls, so a long
+ * transmission may be synthesized one buffer at a time.
+ */
+
+enum modulation {
+    /** Binary continuous-phase FSK with a rectangular frequency pulse */
+    MODULATION_CPFSK,
+
+    /** Binary Gaussian-filtered CPFSK (e.g. GMSK, with h = 1/2) */
+    MODULATION_GMSK,
+
+    /** M-PSK, Gray coded, with a root-raised-cosine pulse */
+    MODULATION_PSK,
+};
+
+struct modulator_config {
+    enum modulation type;
+
+    /** Samples per symbol */
+    unsigned int samples_per_symbol;
+
+    /** PSK only: 1 (BPSK), 2 (QPSK) or 3 (8-PSK). Ignored otherwise. */
+    unsigned int bits_per_symbol;
+
+    /** CPFSK/GMSK modulation index, as a fraction. Ignored for PSK. */
+    unsigned int h_num;
+    unsigned int h_den;
+
+    /** GMSK/PSK pulse length, in symbols. Ignored for CPFSK. */
+    unsigned int span;
+
+    /** GMSK bandwidth-time product */
+    double bt;
+
+    /** PSK root-raised-cosine excess bandwidth, 0.0 - 1.0 */
+    double rolloff;
+
+    /** Peak amplitude, as a fraction of full scale (0.0, 1.0] */
+    double amplitude;
+};
+
+struct modulator;
+
+/**
+ * Create a modulator, precomputing its tables
+ *
+ * @param[in]   config      Modulator configuration
+ *
+ * @return Modulator on success, NULL on invalid configuration or memory
+ *         allocation failure
+ */
+struct modulator *modulator_init(const struct modulator_config *config);
+
+/**
+ * Free a modulator
+ *
+ * @param[in]   mod         Modulator to free. May be NULL.
+ */
+void modulator_close(struct modulator *mod);
+
+/**
+ * Return to a phase of 0 (1 + 0j), with an idle symbol history and no
+ * leftover bits
+ */
+void modulator_reset(struct modulator *mod);
+
+/**
+ * @return Number of samples modulator_mod() will produce for `num_bits` bits
+ */
+size_t modulator_num_samples(const struct modulator *mod, size_t num_bits);
+
+/**
+ * Modulate bits into SC16 Q11 samples
+ *
+ * Symbols preceding the first one after a reset or flush are idle: zero
+ * amplitude for PSK and zero frequency deviation for CPFSK/GMSK, so bursts
+ * ramp up smoothly.
+ *
+ * @param       mod         Modulator
+ * @param[in]   data        Bits to modulate, LSb first
+ * @param[in]   num_bits    Number of bits from `data` to modulate
+ * @param[out]  samples     Interleaved I/Q samples. Must have room for
+ *                          modulator_num_samples(mod, num_bits) samples.
+ *
+ * @return Number of samples written
+ */
+size_t modulator_mod(struct modulator *mod, const uint8_t *data,
+                     size_t num_bits, int16_t *samples);
+
+/**
+ * @return Number of samples modulator_flush() will produce
+ */
+size_t modulator_flush_samples(const struct modulator *mod);
+
+/**
+ * Clock out the tail of the pulse following the last symbol, by modulating
+ * idle symbols. Any leftover bits of a partial symbol are discarded. The
+ * phase is retained.
+ *
+ * @param       mod         Modulator
+ * @param[out]  samples     Interleaved I/Q samples. Must have room for
+ *                          modulator_flush_samples(mod) samples.
+ *
+ * @return Number of samples written
+ */
+size_t modulator_flush(struct modulator *mod, int16_t *samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
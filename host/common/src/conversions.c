@@ -403,26 +403,450 @@ const char *backend_description(bladerf_backend b)
     }
 }
 
-void sc16q11_to_float(const int16_t *in, float *out, unsigned int n)
+/* SC16Q11 <-> float conversions
+ *
+ * Each implementation converts a number of int16/float elements (i.e., twice
+ * the number of samples), handling any remainder with the scalar code.
+ *
+ * Float to SC16Q11 conversions replace NaN with zero and clamp in the float
+ * domain before converting, which keeps every implementation bit-exact with
+ * the scalar code, including for infinities and NaN.
+ *
+ * Rounding assumes the default floating point environment (round to nearest,
+ * ties to even), which the scalar code implements explicitly.
+ *
+ * AVX2 and AVX-512 are selected at runtime, and so are only available with
+ * compilers that support per-function target attributes.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define CONV_HAVE_SSE2
+#   include <emmintrin.h>
+#   if defined(__GNUC__)
+#       define CONV_HAVE_AVX
+#       include <immintrin.h>
+#   endif
+#elif defined(__aarch64__)
+#   define CONV_HAVE_NEON
+#   include <arm_neon.h>
+#endif
+
+#define SC16Q11_SCALE   2048.0f
+#define INT16_LIMIT_LO  -32768.0f
+#define INT16_LIMIT_HI  32767.0f
+#define DAC_LIMIT_LO    -2048.0f
+#define DAC_LIMIT_HI    2047.0f
+
+struct conv_kernels {
+    void (*to_float)(const int16_t *in, float *out, size_t count);
+
+    /* Clamp to [lo, hi], then round to nearest (ties to even) or truncate */
+    void (*to_sc16)(const float *in, int16_t *out, size_t count,
+                    float lo, float hi, bool round);
+};
+
+static inline int16_t scalar_to_sc16(float in, float lo, float hi, bool round)
 {
-    unsigned int i;
+    float v = in * SC16Q11_SCALE;
+    float frac;
+    int32_t t;
+
+    /* NaN is the only value that does not equal itself. The rest is written
+     * to allow min/max instructions. */
+    v = (v == v) ? v : 0.0f;
+    v = (v > lo) ? v : lo;
+    v = (v < hi) ? v : hi;
+
+    t = (int32_t)v;
+
+    if (round) {
+        /* v is well within float's exact integer range, so this is exact.
+         * This is written without branches, as the fraction is effectively
+         * random for real signals. */
+        const int32_t odd = t & 1;
+        frac = v - (float)t;
+
+        t += (frac > 0.5f) | ((frac == 0.5f) & odd);
+        t -= (frac < -0.5f) | ((frac == -0.5f) & odd);
+    }
 
-    for (i = 0; i < (2 * n); i += 2) {
-        out[i]     = (float)in[i] * (1.0f / 2048.0f);
-        out[i + 1] = (float)in[i + 1] * (1.0f / 2048.0f);
+    return (int16_t)t;
+}
+
+static void scalar_to_float(const int16_t *in, float *out, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        out[i] = (float)in[i] * (1.0f / SC16Q11_SCALE);
     }
 }
 
-void float_to_sc16q11(const float *in, int16_t *out, unsigned int n)
+static void scalar_to_sc16_n(const float *in, int16_t *out, size_t count,
+                             float lo, float hi, bool round)
 {
-    unsigned int i;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        out[i] = scalar_to_sc16(in[i], lo, hi, round);
+    }
+}
+
+#ifdef CONV_HAVE_SSE2
+static void sse2_to_float(const int16_t *in, float *out, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / SC16Q11_SCALE);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i x  = _mm_loadu_si128((const __m128i *)&in[i]);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+        _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&out[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+
+    scalar_to_float(&in[i], &out[i], count - i);
+}
+
+static inline __m128i sse2_cvt(const float *in, __m128 scale,
+                               __m128 lo, __m128 hi, bool round)
+{
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(in), scale);
+
+    /* Zero NaN lanes, which are unordered with themselves */
+    v = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+    v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+    return round ? _mm_cvtps_epi32(v) : _mm_cvttps_epi32(v);
+}
+
+static void sse2_to_sc16(const float *in, int16_t *out, size_t count,
+                         float lo, float hi, bool round)
+{
+    const __m128 scale = _mm_set1_ps(SC16Q11_SCALE);
+    const __m128 vlo   = _mm_set1_ps(lo);
+    const __m128 vhi   = _mm_set1_ps(hi);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i a = sse2_cvt(&in[i], scale, vlo, vhi, round);
+        __m128i b = sse2_cvt(&in[i + 4], scale, vlo, vhi, round);
+
+        _mm_storeu_si128((__m128i *)&out[i], _mm_packs_epi32(a, b));
+    }
+
+    scalar_to_sc16_n(&in[i], &out[i], count - i, lo, hi, round);
+}
+#endif
+
+#ifdef CONV_HAVE_AVX
+__attribute__((target("avx2"))) static void avx2_to_float(const int16_t *in,
+                                                          float *out,
+                                                          size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / SC16Q11_SCALE);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&in[i]);
+        __m256 v  = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x));
+
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(v, scale));
+    }
+
+    scalar_to_float(&in[i], &out[i], count - i);
+}
+
+__attribute__((target("avx2"))) static void avx2_to_sc16(const float *in,
+                                                         int16_t *out,
+                                                         size_t count,
+                                                         float lo,
+                                                         float hi,
+                                                         bool round)
+{
+    const __m256 scale = _mm256_set1_ps(SC16Q11_SCALE);
+    const __m256 vlo   = _mm256_set1_ps(lo);
+    const __m256 vhi   = _mm256_set1_ps(hi);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(&in[i]), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(&in[i + 8]), scale);
+        __m256i ia, ib, packed;
+
+        /* Zero NaN lanes, which are unordered with themselves */
+        a = _mm256_and_ps(a, _mm256_cmp_ps(a, a, _CMP_ORD_Q));
+        b = _mm256_and_ps(b, _mm256_cmp_ps(b, b, _CMP_ORD_Q));
+
+        a = _mm256_min_ps(_mm256_max_ps(a, vlo), vhi);
+        b = _mm256_min_ps(_mm256_max_ps(b, vlo), vhi);
+
+        ia = round ? _mm256_cvtps_epi32(a) : _mm256_cvttps_epi32(a);
+        ib = round ? _mm256_cvtps_epi32(b) : _mm256_cvttps_epi32(b);
+
+        /* Packing operates within each 128-bit lane, so restore the order */
+        packed = _mm256_packs_epi32(ia, ib);
+        packed = _mm256_permute4x64_epi64(packed, 0xd8);
+
+        _mm256_storeu_si256((__m256i *)&out[i], packed);
+    }
+
+    scalar_to_sc16_n(&in[i], &out[i], count - i, lo, hi, round);
+}
+
+__attribute__((target("avx512f"))) static void avx512_to_float(
+    const int16_t *in, float *out, size_t count)
+{
+    const __m512 scale = _mm512_set1_ps(1.0f / SC16Q11_SCALE);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&in[i]);
+        __m512 v  = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(x));
+
+        _mm512_storeu_ps(&out[i], _mm512_mul_ps(v, scale));
+    }
+
+    scalar_to_float(&in[i], &out[i], count - i);
+}
+
+__attribute__((target("avx512f"))) static void avx512_to_sc16(
+    const float *in, int16_t *out, size_t count, float lo, float hi,
+    bool round)
+{
+    const __m512 scale = _mm512_set1_ps(SC16Q11_SCALE);
+    const __m512 vlo   = _mm512_set1_ps(lo);
+    const __m512 vhi   = _mm512_set1_ps(hi);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m512 v = _mm512_mul_ps(_mm512_loadu_ps(&in[i]), scale);
+        __m512i x;
+
+        /* Zero NaN lanes, which are unordered with themselves */
+        v = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(v, v, _CMP_ORD_Q), v);
+        v = _mm512_min_ps(_mm512_max_ps(v, vlo), vhi);
+        x = round ? _mm512_cvtps_epi32(v) : _mm512_cvttps_epi32(v);
+
+        _mm256_storeu_si256((__m256i *)&out[i], _mm512_cvtsepi32_epi16(x));
+    }
+
+    scalar_to_sc16_n(&in[i], &out[i], count - i, lo, hi, round);
+}
+#endif
+
+#ifdef CONV_HAVE_NEON
+static void neon_to_float(const int16_t *in, float *out, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(&in[i]);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+
+        vst1q_f32(&out[i], vmulq_n_f32(lo, 1.0f / SC16Q11_SCALE));
+        vst1q_f32(&out[i + 4], vmulq_n_f32(hi, 1.0f / SC16Q11_SCALE));
+    }
+
+    scalar_to_float(&in[i], &out[i], count - i);
+}
+
+static inline int32x4_t neon_cvt(const float *in, float32x4_t lo,
+                                 float32x4_t hi, bool round)
+{
+    float32x4_t v = vmulq_n_f32(vld1q_f32(in), SC16Q11_SCALE);
+
+    /* Zero NaN lanes, which do not equal themselves */
+    v = vreinterpretq_f32_u32(
+        vandq_u32(vreinterpretq_u32_f32(v), vceqq_f32(v, v)));
+    v = vminq_f32(vmaxq_f32(v, lo), hi);
+    return round ? vcvtnq_s32_f32(v) : vcvtq_s32_f32(v);
+}
+
+static void neon_to_sc16(const float *in, int16_t *out, size_t count,
+                         float lo, float hi, bool round)
+{
+    const float32x4_t vlo = vdupq_n_f32(lo);
+    const float32x4_t vhi = vdupq_n_f32(hi);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        int32x4_t a = neon_cvt(&in[i], vlo, vhi, round);
+        int32x4_t b = neon_cvt(&in[i + 4], vlo, vhi, round);
+
+        vst1q_s16(&out[i], vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+
+    scalar_to_sc16_n(&in[i], &out[i], count - i, lo, hi, round);
+}
+#endif
+
+static const struct conv_kernels *conv_kernels(sample_conv_impl impl)
+{
+    static const struct conv_kernels scalar = { scalar_to_float,
+                                                scalar_to_sc16_n };
+#ifdef CONV_HAVE_SSE2
+    static const struct conv_kernels sse2 = { sse2_to_float, sse2_to_sc16 };
+#endif
+#ifdef CONV_HAVE_AVX
+    static const struct conv_kernels avx2 = { avx2_to_float, avx2_to_sc16 };
+    static const struct conv_kernels avx512 = { avx512_to_float,
+                                                avx512_to_sc16 };
+#endif
+#ifdef CONV_HAVE_NEON
+    static const struct conv_kernels neon = { neon_to_float, neon_to_sc16 };
+#endif
+
+    if (!sample_conv_supported(impl)) {
+        impl = SAMPLE_CONV_AUTO;
+    }
+
+    switch (impl) {
+#ifdef CONV_HAVE_SSE2
+        case SAMPLE_CONV_SSE2:
+            return &sse2;
+#endif
+#ifdef CONV_HAVE_AVX
+        case SAMPLE_CONV_AVX2:
+            return &avx2;
+
+        case SAMPLE_CONV_AVX512:
+            return &avx512;
+#endif
+#ifdef CONV_HAVE_NEON
+        case SAMPLE_CONV_NEON:
+            return &neon;
+#endif
+        case SAMPLE_CONV_AUTO:
+#if defined(CONV_HAVE_AVX)
+            if (__builtin_cpu_supports("avx512f")) {
+                return &avx512;
+            } else if (__builtin_cpu_supports("avx2")) {
+                return &avx2;
+            }
+            return &sse2;
+#elif defined(CONV_HAVE_SSE2)
+            return &sse2;
+#elif defined(CONV_HAVE_NEON)
+            return &neon;
+#else
+            return &scalar;
+#endif
+
+        default:
+            return &scalar;
+    }
+}
+
+bool sample_conv_supported(sample_conv_impl impl)
+{
+    switch (impl) {
+        case SAMPLE_CONV_AUTO:
+        case SAMPLE_CONV_SCALAR:
+            return true;
+
+#ifdef CONV_HAVE_SSE2
+        case SAMPLE_CONV_SSE2:
+            return true;
+#endif
+
+#ifdef CONV_HAVE_AVX
+        case SAMPLE_CONV_AVX2:
+            return __builtin_cpu_supports("avx2");
+
+        case SAMPLE_CONV_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+
+#ifdef CONV_HAVE_NEON
+        case SAMPLE_CONV_NEON:
+            return true;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+const char *sample_conv_name(sample_conv_impl impl)
+{
+    const struct conv_kernels *k;
+
+    if (impl == SAMPLE_CONV_AUTO) {
+        k = conv_kernels(SAMPLE_CONV_AUTO);
+
+        for (impl = SAMPLE_CONV_SCALAR; impl <= SAMPLE_CONV_NEON; impl++) {
+            if (sample_conv_supported(impl) && conv_kernels(impl) == k) {
+                break;
+            }
+        }
+    }
+
+    switch (impl) {
+        case SAMPLE_CONV_SCALAR:
+            return "Scalar";
 
-    for (i = 0; i < (2 * n); i += 2) {
-        out[i]     = (int16_t)(in[i] * 2048.0f);
-        out[i + 1] = (int16_t)(in[i + 1] * 2048.0f);
+        case SAMPLE_CONV_SSE2:
+            return "SSE2";
+
+        case SAMPLE_CONV_AVX2:
+            return "AVX2";
+
+        case SAMPLE_CONV_AVX512:
+            return "AVX-512";
+
+        case SAMPLE_CONV_NEON:
+            return "NEON";
+
+        default:
+            return "Unknown";
     }
 }
 
+void sc16q11_to_float_impl(sample_conv_impl impl,
+                           const int16_t *in,
+                           float *out,
+                           unsigned int n)
+{
+    conv_kernels(impl)->to_float(in, out, 2 * (size_t)n);
+}
+
+void float_to_sc16q11_impl(sample_conv_impl impl,
+                           const float *in,
+                           int16_t *out,
+                           unsigned int n)
+{
+    conv_kernels(impl)->to_sc16(in, out, 2 * (size_t)n, INT16_LIMIT_LO,
+                                INT16_LIMIT_HI, false);
+}
+
+void float_to_sc16q11_sat_impl(sample_conv_impl impl,
+                               const float *in,
+                               int16_t *out,
+                               unsigned int n)
+{
+    conv_kernels(impl)->to_sc16(in, out, 2 * (size_t)n, DAC_LIMIT_LO,
+                                DAC_LIMIT_HI, true);
+}
+
+void sc16q11_to_float(const int16_t *in, float *out, unsigned int n)
+{
+    sc16q11_to_float_impl(SAMPLE_CONV_AUTO, in, out, n);
+}
+
+void float_to_sc16q11(const float *in, int16_t *out, unsigned int n)
+{
+    float_to_sc16q11_impl(SAMPLE_CONV_AUTO, in, out, n);
+}
+
+void float_to_sc16q11_sat(const float *in, int16_t *out, unsigned int n)
+{
+    float_to_sc16q11_sat_impl(SAMPLE_CONV_AUTO, in, out, n);
+}
+
 bladerf_cal_module str_to_bladerf_cal_module(const char *str)
 {
     bladerf_cal_module module = BLADERF_DC_CAL_INVALID;
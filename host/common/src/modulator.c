@@ -0,0 +1,849 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (c) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "modulator.h"
+#include "host_config.h"
+
+/* Keep the tables within reason */
+#define MAX_SPAN        8
+#define MAX_TABLE_LEN   (1 << 22)
+
+/* Resolution of the numerical integration of the GMSK frequency pulse */
+#define GMSK_OVERSAMPLE 64
+
+/*
+ * Symbols are referred to by digit: 0 is the idle symbol, and 1 + x is the
+ * symbol conveying bits x.
+ *
+ * CPFSK/GMSK: The signal during a symbol depends only upon the phase at its
+ * start, which is a multiple of pi / h_den, and the `span` most recent
+ * symbols. `table` holds every symbol's worth of samples for each of those
+ * combinations, indexed by [phase][pattern], where `pattern` is the most
+ * recent symbols' digits in base `num_digits`, the newest least significant.
+ *
+ * PSK: The signal during a symbol is the sum of the pulse tails of the `span`
+ * most recent symbols. `table` holds each symbol's contribution, indexed by
+ * [age][digit].
+ */
+struct modulator {
+    enum modulation type;
+    unsigned int sps;
+    unsigned int bits_per_symbol;
+    unsigned int span;
+    unsigned int num_digits;
+
+    /* Entries are one symbol's worth of interleaved I/Q samples */
+    int16_t *table;
+    size_t entry_len;
+
+    /* CPFSK/GMSK */
+    unsigned int num_phases;
+    unsigned int num_patterns;
+    unsigned int oldest_div;    /* num_digits ^ (span - 1) */
+    unsigned int h_num;
+    unsigned int phase;
+    unsigned int pattern;
+
+    /* PSK: digits of the most recent symbols, newest at `newest` */
+    uint8_t history[MAX_SPAN];
+    unsigned int newest;
+
+    /* Bits of an incomplete symbol */
+    unsigned int bits;
+    unsigned int num_bits;
+};
+
+static unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (b != 0) {
+        unsigned int tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+
+    return a;
+}
+
+static int16_t to_q11(double x)
+{
+    x = round(x * 2048.0);
+
+    if (x > 2047.0) {
+        return 2047;
+    } else if (x < -2048.0) {
+        return -2048;
+    } else {
+        return (int16_t) x;
+    }
+}
+
+/* Gaussian Q function */
+static double q_func(double x)
+{
+    return 0.5 * erfc(x / sqrt(2.0));
+}
+
+/* Fill `q` with the phase pulse, i.e. the integral of the frequency pulse,
+ * at the end of each of the span * sps sample periods. It ends at 1/2. */
+static void phase_pulse(const struct modulator_config *config,
+                        unsigned int span, double *q)
+{
+    const unsigned int sps = config->samples_per_symbol;
+    const unsigned int len = span * sps;
+    const double k = 2.0 * M_PI * config->bt / sqrt(log(2.0));
+    const double dt = 1.0 / (sps * GMSK_OVERSAMPLE);
+    double acc = 0.0;
+    unsigned int n, i;
+
+    if (config->type == MODULATION_CPFSK) {
+        for (n = 0; n < len; n++) {
+            q[n] = 0.5 * (n + 1) / sps;
+        }
+        return;
+    }
+
+    /* Gaussian-filtered rectangular pulse of one symbol, centered within the
+     * span. Integrate with the midpoint rule. */
+    for (n = 0; n < len; n++) {
+        for (i = 0; i < GMSK_OVERSAMPLE; i++) {
+            const double t = (n + (i + 0.5) / GMSK_OVERSAMPLE) / sps
+                             - span / 2.0;
+
+            acc += (q_func(k * (t - 0.5)) - q_func(k * (t + 0.5))) * dt;
+        }
+
+        q[n] = acc;
+    }
+
+    /* Account for the truncated tails */
+    for (n = 0; n < len; n++) {
+        q[n] *= 0.5 / acc;
+    }
+}
+
+static int init_cpm(struct modulator *mod,
+                    const struct modulator_config *config)
+{
+    const unsigned int sps = mod->sps;
+    unsigned int div, p, s, pattern, j, k;
+    double *q;
+    int16_t *entry;
+
+    if (config->h_num == 0 || config->h_den == 0) {
+        return -1;
+    }
+
+    div        = gcd(config->h_num, config->h_den);
+    mod->h_num = config->h_num / div;
+    p          = config->h_den / div;
+
+    /* Phases at symbol boundaries are multiples of pi / p */
+    mod->num_phases = 2 * p;
+
+    mod->bits_per_symbol = 1;
+    mod->num_digits      = 3;
+
+    mod->num_patterns = 1;
+    for (j = 0; j < mod->span; j++) {
+        mod->oldest_div    = mod->num_patterns;
+        mod->num_patterns *= mod->num_digits;
+    }
+
+    if ((size_t) mod->num_phases * mod->num_patterns > MAX_TABLE_LEN / sps) {
+        return -1;
+    }
+
+    q = malloc(mod->span * sps * sizeof(q[0]));
+    if (q == NULL) {
+        return -1;
+    }
+
+    mod->table = malloc((size_t) mod->num_phases * mod->num_patterns *
+                        mod->entry_len * sizeof(mod->table[0]));
+    if (mod->table == NULL) {
+        free(q);
+        return -1;
+    }
+
+    phase_pulse(config, mod->span, q);
+
+    entry = mod->table;
+    for (s = 0; s < mod->num_phases; s++) {
+        for (pattern = 0; pattern < mod->num_patterns; pattern++) {
+            for (k = 0; k < sps; k++) {
+                double phase = M_PI * s / p;
+                unsigned int digits = pattern;
+
+                /* Sum the contributions of the symbols, newest first */
+                for (j = 0; j < mod->span; j++) {
+                    const unsigned int d = digits % mod->num_digits;
+
+                    if (d != 0) {
+                        const double v = (d == 2) ? 1.0 : -1.0;
+                        phase += 2.0 * M_PI * mod->h_num / p * v *
+                                 q[j * sps + k];
+                    }
+
+                    digits /= mod->num_digits;
+                }
+
+                *entry++ = to_q11(config->amplitude * cos(phase));
+                *entry++ = to_q11(config->amplitude * sin(phase));
+            }
+        }
+    }
+
+    free(q);
+    return 0;
+}
+
+/* Root-raised-cosine impulse response at time t, in symbols */
+static double rrc(double t, double beta)
+{
+    const double eps = 1e-9;
+
+    if (fabs(t) < eps) {
+        return 1.0 - beta + 4.0 * beta / M_PI;
+    }
+
+    if (beta > 0.0 && fabs(fabs(t) - 1.0 / (4.0 * beta)) < eps) {
+        return beta / sqrt(2.0) *
+               ((1.0 + 2.0 / M_PI) * sin(M_PI / (4.0 * beta)) +
+                (1.0 - 2.0 / M_PI) * cos(M_PI / (4.0 * beta)));
+    }
+
+    return (sin(M_PI * t * (1.0 - beta)) +
+            4.0 * beta * t * cos(M_PI * t * (1.0 + beta))) /
+           (M_PI * t * (1.0 - 16.0 * beta * beta * t * t));
+}
+
+static int init_psk(struct modulator *mod,
+                    const struct modulator_config *config)
+{
+    const unsigned int sps = mod->sps;
+    const unsigned int len = mod->span * sps;
+    const unsigned int m   = 1u << config->bits_per_symbol;
+    const double offset    = (m == 4) ? M_PI / 4.0 : 0.0;
+    double *h, peak = 0.0, scale;
+    unsigned int n, j, k, d, i;
+    int16_t *entry;
+
+    if (config->bits_per_symbol < 1 || config->bits_per_symbol > 3 ||
+        config->rolloff < 0.0 || config->rolloff > 1.0) {
+        return -1;
+    }
+
+    mod->bits_per_symbol = config->bits_per_symbol;
+    mod->num_digits      = 1 + m;
+
+    h = malloc(len * sizeof(h[0]));
+    if (h == NULL) {
+        return -1;
+    }
+
+    mod->table = malloc((size_t) mod->span * mod->num_digits *
+                        mod->entry_len * sizeof(mod->table[0]));
+    if (mod->table == NULL) {
+        free(h);
+        return -1;
+    }
+
+    for (n = 0; n < len; n++) {
+        h[n] = rrc(((double) n - len / 2) / sps, config->rolloff);
+    }
+
+    /* Scale such that the sum of the contributions can never exceed full
+     * scale, leaving headroom for their rounding */
+    for (k = 0; k < sps; k++) {
+        double sum = 0.0;
+
+        for (j = 0; j < mod->span; j++) {
+            sum += fabs(h[j * sps + k]);
+        }
+
+        if (sum > peak) {
+            peak = sum;
+        }
+    }
+
+    scale = config->amplitude * (2047.0 - mod->span) / 2048.0 / peak;
+
+    entry = mod->table;
+    for (j = 0; j < mod->span; j++) {
+        for (d = 0; d < mod->num_digits; d++) {
+            double angle = 0.0, mag = 0.0;
+
+            if (d != 0) {
+                /* Gray code: the symbol at index i conveys i ^ (i >> 1) */
+                for (i = 0; i < m; i++) {
+                    if ((i ^ (i >> 1)) == d - 1) {
+                        break;
+                    }
+                }
+
+                angle = 2.0 * M_PI * i / m + offset;
+                mag   = scale;
+            }
+
+            for (k = 0; k < sps; k++) {
+                *entry++ = to_q11(mag * cos(angle) * h[j * sps + k]);
+                *entry++ = to_q11(mag * sin(angle) * h[j * sps + k]);
+            }
+        }
+    }
+
+    free(h);
+    return 0;
+}
+
+struct modulator *modulator_init(const struct modulator_config *config)
+{
+    struct modulator *mod;
+    int status;
+
+    if (config->samples_per_symbol == 0 || config->amplitude <= 0.0 ||
+        config->amplitude > 1.0) {
+        return NULL;
+    }
+
+    mod = calloc(1, sizeof(*mod));
+    if (mod == NULL) {
+        return NULL;
+    }
+
+    mod->type      = config->type;
+    mod->sps       = config->samples_per_symbol;
+    mod->entry_len = 2 * (size_t) mod->sps;
+    mod->span      = (config->type == MODULATION_CPFSK) ? 1 : config->span;
+
+    if (mod->span == 0 || mod->span > MAX_SPAN) {
+        free(mod);
+        return NULL;
+    }
+
+    switch (config->type) {
+        case MODULATION_CPFSK:
+        case MODULATION_GMSK:
+            status = init_cpm(mod, config);
+            break;
+
+        case MODULATION_PSK:
+            status = init_psk(mod, config);
+            break;
+
+        default:
+            status = -1;
+    }
+
+    if (status != 0) {
+        modulator_close(mod);
+        return NULL;
+    }
+
+    return mod;
+}
+
+void modulator_close(struct modulator *mod)
+{
+    if (mod != NULL) {
+        free(mod->table);
+        free(mod);
+    }
+}
+
+void modulator_reset(struct modulator *mod)
+{
+    mod->phase    = 0;
+    mod->pattern  = 0;
+    mod->newest   = 0;
+    mod->bits     = 0;
+    mod->num_bits = 0;
+    memset(mod->history, 0, sizeof(mod->history));
+}
+
+size_t modulator_num_samples(const struct modulator *mod, size_t num_bits)
+{
+    return (mod->num_bits + num_bits) / mod->bits_per_symbol * mod->sps;
+}
+
+size_t modulator_flush_samples(const struct modulator *mod)
+{
+    return (mod->span - 1) * (size_t) mod->sps;
+}
+
+static inline void mod_symbol_cpm(struct modulator *mod, unsigned int digit,
+                                  int16_t *samples)
+{
+    const unsigned int oldest = mod->pattern / mod->oldest_div;
+
+    /* The oldest symbol's contribution is now complete */
+    if (oldest == 1) {
+        mod->phase += mod->num_phases - mod->h_num % mod->num_phases;
+    } else if (oldest == 2) {
+        mod->phase += mod->h_num;
+    }
+
+    mod->phase %= mod->num_phases;
+
+    mod->pattern = (mod->pattern % mod->oldest_div) * mod->num_digits + digit;
+
+    memcpy(samples,
+           &mod->table[((size_t) mod->phase * mod->num_patterns +
+                        mod->pattern) * mod->entry_len],
+           mod->entry_len * sizeof(samples[0]));
+}
+
+static inline void mod_symbol_psk(struct modulator *mod, unsigned int digit,
+                                  int16_t *samples)
+{
+    const size_t len = mod->entry_len;
+    const int16_t *c;
+    unsigned int j, i;
+    size_t k;
+
+    mod->newest = (mod->newest + 1) % mod->span;
+    mod->history[mod->newest] = (uint8_t) digit;
+
+    c = &mod->table[digit * len];
+    memcpy(samples, c, len * sizeof(samples[0]));
+
+    /* The headroom left by init_psk() ensures these sums can't overflow */
+    for (j = 1; j < mod->span; j++) {
+        i = (mod->newest + mod->span - j) % mod->span;
+        c = &mod->table[(j * mod->num_digits + mod->history[i]) * len];
+
+        for (k = 0; k < len; k++) {
+            samples[k] += c[k];
+        }
+    }
+}
+
+static inline void mod_symbol(struct modulator *mod, unsigned int digit,
+                              int16_t *samples)
+{
+    if (mod->type == MODULATION_PSK) {
+        mod_symbol_psk(mod, digit, samples);
+    } else {
+        mod_symbol_cpm(mod, digit, samples);
+    }
+}
+
+size_t modulator_mod(struct modulator *mod, const uint8_t *data,
+                     size_t num_bits, int16_t *samples)
+{
+    int16_t *out = samples;
+    size_t i;
+
+    for (i = 0; i < num_bits; i++) {
+        mod->bits |= ((data[i / 8] >> (i % 8)) & 1u) << mod->num_bits;
+
+        if (++mod->num_bits == mod->bits_per_symbol) {
+            mod_symbol(mod, 1 + mod->bits, out);
+            out += mod->entry_len;
+
+            mod->bits     = 0;
+            mod->num_bits = 0;
+        }
+    }
+
+    return (size_t) (out - samples) / 2;
+}
+
+size_t modulator_flush(struct modulator *mod, int16_t *samples)
+{
+    unsigned int j;
+
+    mod->bits     = 0;
+    mod->num_bits = 0;
+
+    for (j = 1; j < mod->span; j++) {
+        mod_symbol(mod, 0, &samples[(j - 1) * mod->entry_len]);
+    }
+
+    return modulator_flush_samples(mod);
+}
+
+#ifdef MODULATOR_TEST
+#include <stdio.h>
+
+#define PRINT_ERROR(...) fprintf(stderr, __VA_ARGS__)
+
+#define NUM_TEST_BYTES  64
+
+/* Position on the unit circle of each symbol's constellation point, in units
+ * of 2*pi / M, for Gray-coded BPSK, QPSK and 8-PSK. QPSK is rotated by an
+ * additional pi / 4. */
+static const unsigned int psk_positions[3][8] = {
+    { 0, 1 },
+    { 0, 1, 3, 2 },
+    { 0, 1, 3, 2, 7, 6, 4, 5 },
+};
+
+static void fill_pattern(uint8_t *data, size_t len, unsigned int pattern)
+{
+    uint32_t state = 0x1234567;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        switch (pattern) {
+            case 0: data[i] = 0x00; break;
+            case 1: data[i] = 0xff; break;
+            case 2: data[i] = 0x55; break;
+            case 3: data[i] = (uint8_t) (0xf0 >> (i % 5)); break;
+            default:
+                state   = state * 1103515245 + 12345;
+                data[i] = (uint8_t) (state >> 16);
+        }
+    }
+}
+
+/* bladeRF-fsk's original modulator: each sample steps one point around a
+ * table of `points_per_rev` points on the unit circle, counter-clockwise for
+ * a 1 and clockwise for a 0, starting from 1 + 0j */
+static size_t ref_cpfsk(const uint8_t *data, size_t num_bytes,
+                        unsigned int sps, unsigned int points_per_rev,
+                        int16_t *samples)
+{
+    unsigned int pos = 0, byte, bit, k;
+    size_t i = 0;
+
+    for (byte = 0; byte < num_bytes; byte++) {
+        for (bit = 0; bit < 8; bit++) {
+            for (k = 0; k < sps; k++) {
+                if ((data[byte] >> bit) & 1) {
+                    pos = (pos + 1) % points_per_rev;
+                } else {
+                    pos = (pos + points_per_rev - 1) % points_per_rev;
+                }
+
+                samples[2 * i]     = to_q11(cos(pos * 2.0 * M_PI /
+                                                points_per_rev));
+                samples[2 * i + 1] = to_q11(sin(pos * 2.0 * M_PI /
+                                                points_per_rev));
+                i++;
+            }
+        }
+    }
+
+    return i;
+}
+
+/* CPFSK matches the table walk it replaced, including when the bits are
+ * supplied over several calls */
+static unsigned int test_cpfsk(void)
+{
+    static const unsigned int params[][2] = {
+        /* Samples per symbol, points per revolution */
+        { 8, 32 },      /* bladeRF-fsk's */
+        { 4, 32 },
+        { 8, 12 },
+        { 5, 64 },
+    };
+
+    unsigned int failures = 0;
+    struct modulator_config config;
+    struct modulator *mod;
+    uint8_t data[NUM_TEST_BYTES];
+    int16_t *expected, *actual;
+    size_t num_samples, n, i;
+    unsigned int p, pattern;
+
+    for (p = 0; p < sizeof(params) / sizeof(params[0]); p++) {
+        const unsigned int sps = params[p][0];
+
+        memset(&config, 0, sizeof(config));
+        config.type               = MODULATION_CPFSK;
+        config.samples_per_symbol = sps;
+        config.h_num              = 2 * sps;
+        config.h_den              = params[p][1];
+        config.amplitude          = 1.0;
+
+        mod         = modulator_init(&config);
+        num_samples = (size_t) NUM_TEST_BYTES * 8 * sps;
+        expected    = malloc(2 * num_samples * sizeof(expected[0]));
+        actual      = malloc(2 * num_samples * sizeof(actual[0]));
+
+        if (mod == NULL || expected == NULL || actual == NULL) {
+            PRINT_ERROR("%s: Failed to initialize\n", __FUNCTION__);
+            failures++;
+            goto next;
+        }
+
+        for (pattern = 0; pattern < 5; pattern++) {
+            fill_pattern(data, sizeof(data), pattern);
+            ref_cpfsk(data, sizeof(data), sps, params[p][1], expected);
+
+            /* In two parts, to carry the phase across calls */
+            modulator_reset(mod);
+            n = modulator_mod(mod, data, 8 * 7, actual);
+            n += modulator_mod(mod, data + 7, 8 * (NUM_TEST_BYTES - 7),
+                               &actual[2 * n]);
+
+            if (n != num_samples) {
+                PRINT_ERROR("%s: %u sps, %u points: got %zu samples, "
+                            "expected %zu\n", __FUNCTION__, sps,
+                            params[p][1], n, num_samples);
+                failures++;
+                continue;
+            }
+
+            for (i = 0; i < 2 * num_samples; i++) {
+                if (actual[i] != expected[i]) {
+                    PRINT_ERROR("%s: %u sps, %u points, pattern %u: sample "
+                                "%zu is (%d, %d), expected (%d, %d)\n",
+                                __FUNCTION__, sps, params[p][1], pattern,
+                                i / 2, actual[i & ~1], actual[i | 1],
+                                expected[i & ~1], expected[i | 1]);
+                    failures++;
+                    break;
+                }
+            }
+        }
+
+next:
+        modulator_close(mod);
+        free(expected);
+        free(actual);
+    }
+
+    return failures;
+}
+
+/* With a span of one symbol, the sample at the center of each pulse lies on
+ * the constellation point of its symbol */
+static unsigned int test_psk_constellation(void)
+{
+    const unsigned int sps = 8;
+
+    unsigned int failures = 0;
+    struct modulator_config config;
+    struct modulator *mod;
+    int16_t samples[2 * 8];
+    double radius = 0.0;
+    unsigned int bits, m, x;
+    uint8_t data;
+
+    for (bits = 1; bits <= 3; bits++) {
+        const double offset = (bits == 2) ? M_PI / 4.0 : 0.0;
+
+        m = 1u << bits;
+
+        memset(&config, 0, sizeof(config));
+        config.type               = MODULATION_PSK;
+        config.samples_per_symbol = sps;
+        config.bits_per_symbol    = bits;
+        config.span               = 1;
+        config.rolloff            = 0.35;
+        config.amplitude          = 1.0;
+
+        mod = modulator_init(&config);
+        if (mod == NULL) {
+            PRINT_ERROR("%s: Failed to initialize\n", __FUNCTION__);
+            failures++;
+            continue;
+        }
+
+        for (x = 0; x < m; x++) {
+            const double angle = 2.0 * M_PI * psk_positions[bits - 1][x] / m +
+                                 offset;
+            double i_val, q_val, r, err;
+
+            data = (uint8_t) x;
+            if (modulator_mod(mod, &data, bits, samples) != sps) {
+                PRINT_ERROR("%s: Wrong number of samples\n", __FUNCTION__);
+                failures++;
+                break;
+            }
+
+            i_val = samples[sps];
+            q_val = samples[sps + 1];
+            r     = sqrt(i_val * i_val + q_val * q_val);
+
+            /* Every point lies on the same circle */
+            if (radius == 0.0) {
+                radius = r;
+            }
+
+            err = fabs(remainder(atan2(q_val, i_val) - angle, 2.0 * M_PI));
+
+            if (r < 1024.0 || fabs(r - radius) > 2.0 || err > 0.005) {
+                PRINT_ERROR("%s: %u-PSK symbol %u is at (%.0f, %.0f), "
+                            "expected an angle of %.3f\n", __FUNCTION__, m,
+                            x, i_val, q_val, angle);
+                failures++;
+            }
+        }
+
+        modulator_close(mod);
+    }
+
+    return failures;
+}
+
+/* The sum of each sample's contributions lies within [-2048, 2047] for any
+ * sequence of symbols, and a long random stream is summed without wrapping.
+ * The stream is supplied in two parts, which for 8-PSK splits a symbol. */
+static unsigned int test_psk_range(void)
+{
+    static const double rolloffs[] = { 0.0, 0.35, 1.0 };
+
+    unsigned int failures = 0;
+    struct modulator_config config;
+    struct modulator *mod;
+    uint8_t data[NUM_TEST_BYTES];
+    uint8_t digits[NUM_TEST_BYTES * 8];
+    int16_t *samples;
+    unsigned int bits, r, span, j, d, s;
+    size_t num_symbols, n, k;
+
+    for (bits = 1; bits <= 3; bits++) {
+        for (r = 0; r < sizeof(rolloffs) / sizeof(rolloffs[0]); r++) {
+            for (span = 1; span <= MAX_SPAN; span++) {
+                memset(&config, 0, sizeof(config));
+                config.type               = MODULATION_PSK;
+                config.samples_per_symbol = 8;
+                config.bits_per_symbol    = bits;
+                config.span               = span;
+                config.rolloff            = rolloffs[r];
+                config.amplitude          = 1.0;
+
+                mod = modulator_init(&config);
+                num_symbols = NUM_TEST_BYTES * 8 / bits;
+                samples = malloc(num_symbols * 2 * config.samples_per_symbol *
+                                 sizeof(samples[0]));
+
+                if (mod == NULL || samples == NULL) {
+                    PRINT_ERROR("%s: Failed to initialize\n", __FUNCTION__);
+                    failures++;
+                    goto next;
+                }
+
+                /* Worst case: every contribution at its extreme */
+                for (k = 0; k < mod->entry_len; k++) {
+                    int32_t max = 0, min = 0;
+
+                    for (j = 0; j < span; j++) {
+                        int32_t hi = 0, lo = 0;
+
+                        for (d = 0; d < mod->num_digits; d++) {
+                            const int16_t v = mod->table[
+                                (j * mod->num_digits + d) * mod->entry_len + k];
+
+                            hi = v > hi ? v : hi;
+                            lo = v < lo ? v : lo;
+                        }
+
+                        max += hi;
+                        min += lo;
+                    }
+
+                    if (max > 2047 || min < -2048) {
+                        PRINT_ERROR("%s: %u bits, rolloff %.2f, span %u: "
+                                    "sums may reach [%d, %d]\n",
+                                    __FUNCTION__, bits, rolloffs[r], span,
+                                    (int) min, (int) max);
+                        failures++;
+                        break;
+                    }
+                }
+
+                /* A random stream, against sums taken without wrapping */
+                fill_pattern(data, sizeof(data), 4);
+                modulator_reset(mod);
+                n = modulator_mod(mod, data, 8 * 7, samples);
+                n += modulator_mod(mod, data + 7, num_symbols * bits - 8 * 7,
+                                   &samples[2 * n]);
+
+                for (s = 0; s < num_symbols; s++) {
+                    unsigned int v = 0, b;
+
+                    for (b = 0; b < bits; b++) {
+                        const size_t i = (size_t) s * bits + b;
+                        v |= ((data[i / 8] >> (i % 8)) & 1u) << b;
+                    }
+
+                    digits[s] = (uint8_t) (1 + v);
+                }
+
+                for (s = 0; s < num_symbols && n == num_symbols * 8; s++) {
+                    for (k = 0; k < mod->entry_len; k++) {
+                        int32_t sum = 0;
+
+                        for (j = 0; j < span && j <= s; j++) {
+                            sum += mod->table[(j * mod->num_digits +
+                                               digits[s - j]) *
+                                              mod->entry_len + k];
+                        }
+
+                        if (sum > 2047 || sum < -2048 ||
+                            samples[s * mod->entry_len + k] != sum) {
+                            PRINT_ERROR("%s: %u bits, rolloff %.2f, span %u: "
+                                        "symbol %u sums to %d, got %d\n",
+                                        __FUNCTION__, bits, rolloffs[r],
+                                        span, s, (int) sum,
+                                        samples[s * mod->entry_len + k]);
+                            failures++;
+                            s = (unsigned int) num_symbols;
+                            break;
+                        }
+                    }
+                }
+
+                if (n != num_symbols * 8) {
+                    PRINT_ERROR("%s: Wrong number of samples\n", __FUNCTION__);
+                    failures++;
+                }
+
+next:
+                modulator_close(mod);
+                free(samples);
+            }
+        }
+    }
+
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int failures = 0;
+
+    failures += test_cpfsk();
+    failures += test_psk_constellation();
+    failures += test_psk_range();
+
+    if (failures != 0) {
+        PRINT_ERROR("%u modulator check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All modulator checks passed\n");
+    return EXIT_SUCCESS;
+}
+#endif
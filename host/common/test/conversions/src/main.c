@@ -0,0 +1,384 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (c) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Checks each SC16Q11 <-> float conversion implementation against expected
+ * values and against the scalar code, and reports its throughput. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <libbladeRF.h>
+#include "conversions.h"
+
+#define DEFAULT_NUM_SAMPLES 16384
+#define DEFAULT_ITERATIONS  10000
+
+/* Odd, so that every implementation exercises its remainder handling */
+#define CHECK_NUM_SAMPLES   4099
+
+struct bufs {
+    int16_t *sc16;
+    int16_t *sc16_ref;
+    float *f32;
+    float *f32_ref;
+};
+
+static const sample_conv_impl impls[] = {
+    SAMPLE_CONV_SCALAR,
+    SAMPLE_CONV_SSE2,
+    SAMPLE_CONV_AVX2,
+    SAMPLE_CONV_AVX512,
+    SAMPLE_CONV_NEON,
+};
+
+#define NUM_IMPLS (sizeof(impls) / sizeof(impls[0]))
+
+/* Expected results of float_to_sc16q11() and float_to_sc16q11_sat() */
+struct expected_sc16 {
+    float in;
+    int16_t trunc;
+    int16_t sat;
+};
+
+static const struct expected_sc16 expected_sc16[] = {
+    /* Ties round to even */
+    { 0.5f / 2048.0f,       0,      0 },
+    { 1.5f / 2048.0f,       1,      2 },
+    { 2.5f / 2048.0f,       2,      2 },
+    { 3.5f / 2048.0f,       3,      4 },
+    { -0.5f / 2048.0f,      0,      0 },
+    { -1.5f / 2048.0f,      -1,     -2 },
+    { -2.5f / 2048.0f,      -2,     -2 },
+    { -3.5f / 2048.0f,      -3,     -4 },
+    { 1.25f / 2048.0f,      1,      1 },
+    { -1.75f / 2048.0f,     -1,     -2 },
+
+    /* Full scale */
+    { 1.0f,                 2048,   2047 },
+    { -1.0f,                -2048,  -2048 },
+    { 2047.0f / 2048.0f,    2047,   2047 },
+    { 2047.5f / 2048.0f,    2047,   2047 },
+    { -2048.5f / 2048.0f,   -2048,  -2048 },
+
+    /* Beyond the DAC's range, and beyond int16's */
+    { 1.5f,                 3072,   2047 },
+    { -1.5f,                -3072,  -2048 },
+    { 16.0f,                32767,  2047 },
+    { -16.0f,               -32768, -2048 },
+    { 1e9f,                 32767,  2047 },
+    { -1e9f,                -32768, -2048 },
+    { INFINITY,             32767,  2047 },
+    { -INFINITY,            -32768, -2048 },
+
+    { NAN,                  0,      0 },
+    { -NAN,                 0,      0 },
+    { 0.0f,                 0,      0 },
+    { -0.0f,                0,      0 },
+};
+
+#define NUM_EXPECTED_SC16 (sizeof(expected_sc16) / sizeof(expected_sc16[0]))
+
+/* Expected results of sc16q11_to_float() */
+struct expected_float {
+    int16_t in;
+    float out;
+};
+
+static const struct expected_float expected_float[] = {
+    { 0,        0.0f },
+    { 1,        1.0f / 2048.0f },
+    { -1,       -1.0f / 2048.0f },
+    { 1024,     0.5f },
+    { 2047,     2047.0f / 2048.0f },
+    { -2048,    -1.0f },
+    { 32767,    32767.0f / 2048.0f },
+    { -32768,   -16.0f },
+};
+
+#define NUM_EXPECTED_FLOAT (sizeof(expected_float) / sizeof(expected_float[0]))
+
+static void fill_float(float *f, size_t count)
+{
+    static const float special[] = {
+        0.5f / 2048.0f,  1.5f / 2048.0f,  2.5f / 2048.0f, -0.5f / 2048.0f,
+        -1.5f / 2048.0f, -2.5f / 2048.0f, 1.0f,           -1.0f,
+        1.5f,            -1.5f,           16.0f,          -16.0f,
+        1e9f,            -1e9f,           INFINITY,       -INFINITY,
+        NAN,             0.0f,            -0.0f,
+    };
+
+    const size_t num_special = sizeof(special) / sizeof(special[0]);
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (i < num_special) {
+            f[i] = special[i];
+        } else {
+            /* Mostly in range, with some beyond the DAC's limits */
+            f[i] = ((float)rand() / (float)RAND_MAX) * 2.5f - 1.25f;
+        }
+    }
+}
+
+static void fill_sc16(int16_t *s, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        s[i] = (int16_t)(rand() & 0xffff);
+    }
+}
+
+/* Check the conversion of known values. The values are repeated throughout
+ * the buffers, so that each one passes through every vector lane and the
+ * remainder handling. */
+static int check_expected(sample_conv_impl impl, struct bufs *b)
+{
+    const unsigned int n = CHECK_NUM_SAMPLES;
+    const size_t count   = 2 * (size_t)n;
+    int status           = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        b->f32[i] = expected_sc16[i % NUM_EXPECTED_SC16].in;
+    }
+
+    float_to_sc16q11_impl(impl, b->f32, b->sc16, n);
+    float_to_sc16q11_sat_impl(impl, b->f32, b->sc16_ref, n);
+
+    for (i = 0; i < count; i++) {
+        const struct expected_sc16 *e = &expected_sc16[i % NUM_EXPECTED_SC16];
+
+        if (b->sc16[i] != e->trunc) {
+            fprintf(stderr, "%s: float_to_sc16q11(%g) at [%zu] = %d, "
+                    "expected %d\n", sample_conv_name(impl), e->in, i,
+                    b->sc16[i], e->trunc);
+            status = -1;
+            break;
+        }
+
+        if (b->sc16_ref[i] != e->sat) {
+            fprintf(stderr, "%s: float_to_sc16q11_sat(%g) at [%zu] = %d, "
+                    "expected %d\n", sample_conv_name(impl), e->in, i,
+                    b->sc16_ref[i], e->sat);
+            status = -1;
+            break;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        b->sc16[i] = expected_float[i % NUM_EXPECTED_FLOAT].in;
+    }
+
+    sc16q11_to_float_impl(impl, b->sc16, b->f32, n);
+
+    for (i = 0; i < count; i++) {
+        const struct expected_float *e =
+            &expected_float[i % NUM_EXPECTED_FLOAT];
+
+        if (b->f32[i] != e->out) {
+            fprintf(stderr, "%s: sc16q11_to_float(%d) at [%zu] = %g, "
+                    "expected %g\n", sample_conv_name(impl), e->in, i,
+                    b->f32[i], e->out);
+            status = -1;
+            break;
+        }
+    }
+
+    return status;
+}
+
+static int check(sample_conv_impl impl, struct bufs *b)
+{
+    const unsigned int n = CHECK_NUM_SAMPLES;
+    const size_t count   = 2 * (size_t)n;
+    int status           = 0;
+
+    fill_sc16(b->sc16, count);
+    sc16q11_to_float_impl(SAMPLE_CONV_SCALAR, b->sc16, b->f32_ref, n);
+    sc16q11_to_float_impl(impl, b->sc16, b->f32, n);
+
+    if (memcmp(b->f32, b->f32_ref, count * sizeof(float)) != 0) {
+        fprintf(stderr, "%s: sc16q11_to_float mismatch\n",
+                sample_conv_name(impl));
+        status = -1;
+    }
+
+    fill_float(b->f32, count);
+
+    float_to_sc16q11_impl(SAMPLE_CONV_SCALAR, b->f32, b->sc16_ref, n);
+    float_to_sc16q11_impl(impl, b->f32, b->sc16, n);
+
+    if (memcmp(b->sc16, b->sc16_ref, count * sizeof(int16_t)) != 0) {
+        fprintf(stderr, "%s: float_to_sc16q11 mismatch\n",
+                sample_conv_name(impl));
+        status = -1;
+    }
+
+    float_to_sc16q11_sat_impl(SAMPLE_CONV_SCALAR, b->f32, b->sc16_ref, n);
+    float_to_sc16q11_sat_impl(impl, b->f32, b->sc16, n);
+
+    if (memcmp(b->sc16, b->sc16_ref, count * sizeof(int16_t)) != 0) {
+        fprintf(stderr, "%s: float_to_sc16q11_sat mismatch\n",
+                sample_conv_name(impl));
+        status = -1;
+    }
+
+    return status;
+}
+
+static double msps(clock_t start, clock_t end, unsigned int n,
+                   unsigned int iterations)
+{
+    double secs = (double)(end - start) / CLOCKS_PER_SEC;
+
+    if (secs <= 0) {
+        return 0;
+    }
+
+    return (double)n * iterations / secs / 1e6;
+}
+
+static void bench(sample_conv_impl impl, struct bufs *b, unsigned int n,
+                  unsigned int iterations)
+{
+    clock_t start;
+    double to_float, to_sc16, to_sc16_sat;
+    unsigned int i;
+
+    start = clock();
+    for (i = 0; i < iterations; i++) {
+        sc16q11_to_float_impl(impl, b->sc16, b->f32, n);
+    }
+    to_float = msps(start, clock(), n, iterations);
+
+    start = clock();
+    for (i = 0; i < iterations; i++) {
+        float_to_sc16q11_impl(impl, b->f32, b->sc16, n);
+    }
+    to_sc16 = msps(start, clock(), n, iterations);
+
+    start = clock();
+    for (i = 0; i < iterations; i++) {
+        float_to_sc16q11_sat_impl(impl, b->f32, b->sc16, n);
+    }
+    to_sc16_sat = msps(start, clock(), n, iterations);
+
+    printf("%-8s %14.1f %14.1f %14.1f\n", sample_conv_name(impl), to_float,
+           to_sc16, to_sc16_sat);
+}
+
+static void usage(const char *argv0)
+{
+    printf("Usage: %s [samples per buffer] [iterations]\n\n", argv0);
+    printf("Verifies each available SC16Q11 <-> float conversion against\n");
+    printf("the scalar implementation, and then reports its throughput in\n");
+    printf("millions of samples per second.\n\n");
+    printf("Defaults: %u samples, %u iterations\n", DEFAULT_NUM_SAMPLES,
+           DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int n          = DEFAULT_NUM_SAMPLES;
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    struct bufs b;
+    size_t count;
+    size_t i;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 1) {
+        if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+
+        n = (unsigned int)strtoul(argv[1], NULL, 0);
+    }
+
+    if (argc > 2) {
+        iterations = (unsigned int)strtoul(argv[2], NULL, 0);
+    }
+
+    if (n == 0 || iterations == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (n < CHECK_NUM_SAMPLES) {
+        n = CHECK_NUM_SAMPLES;
+    }
+
+    count      = 2 * (size_t)n;
+    b.sc16     = malloc(count * sizeof(int16_t));
+    b.sc16_ref = malloc(count * sizeof(int16_t));
+    b.f32      = malloc(count * sizeof(float));
+    b.f32_ref  = malloc(count * sizeof(float));
+
+    if (!b.sc16 || !b.sc16_ref || !b.f32 || !b.f32_ref) {
+        fprintf(stderr, "Failed to allocate buffers\n");
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    srand(0x5c16);
+
+    for (i = 0; i < NUM_IMPLS; i++) {
+        if (!sample_conv_supported(impls[i])) {
+            continue;
+        }
+
+        if (check_expected(impls[i], &b) != 0 || check(impls[i], &b) != 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (status != EXIT_SUCCESS) {
+        goto out;
+    }
+
+    printf("Default implementation: %s\n\n", sample_conv_name(SAMPLE_CONV_AUTO));
+    printf("%-8s %14s %14s %14s\n", "", "sc16->float", "float->sc16",
+           "float->sc16sat");
+
+    fill_sc16(b.sc16, count);
+    fill_float(b.f32, count);
+
+    for (i = 0; i < NUM_IMPLS; i++) {
+        if (sample_conv_supported(impls[i])) {
+            bench(impls[i], &b, n, iterations);
+        }
+    }
+
+out:
+    free(b.sc16);
+    free(b.sc16_ref);
+    free(b.f32);
+    free(b.f32_ref);
+    return status;
+}
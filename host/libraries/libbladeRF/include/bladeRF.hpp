@@ -0,0 +1,575 @@
+/**
+ * @file bladeRF.hpp
+ *
+ * @brief Header-only C++17 interface to libbladeRF
+ *
+ * This file provides RAII device and stream handles, and typed sample
+ * streams built upon the synchronous interface. The sample type of a stream
+ * is a template parameter, so any conversion to or from the SC16 Q11 stream
+ * format is selected at compile time:
+ *
+ *  - `std::complex<int16_t>` samples are SC16 Q11 values, and are transferred
+ *    directly to/from the caller's buffers.
+ *  - `std::complex<float>` samples are scaled to [-1.0, 1.0).
+ *
+ * Everything is in the bladeRF namespace. Errors are reported by throwing
+ * bladeRF::error.
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifndef BLADERF_HPP_
+#define BLADERF_HPP_
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "bladeRF.hpp requires C++17"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 201703L && __has_include(<span>)
+#include <span>
+#endif
+
+#include <libbladeRF.h>
+
+namespace bladeRF
+{
+/**
+ * Exception thrown when a libbladeRF call fails
+ */
+class error : public std::runtime_error
+{
+  public:
+    explicit error(int status)
+        : std::runtime_error(bladerf_strerror(status)), status_(status)
+    {
+    }
+
+    /** @return The BLADERF_ERR_* value */
+    int code() const noexcept
+    {
+        return status_;
+    }
+
+  private:
+    int status_;
+};
+
+namespace detail
+{
+    inline void check(int status)
+    {
+        if (status != 0) {
+            throw error(status);
+        }
+    }
+}  // namespace detail
+
+#if defined(__cpp_lib_span)
+template <typename T> using span = std::span<T>;
+#else
+/**
+ * Minimal stand-in for C++20's std::span, which is used when available
+ */
+template <typename T> class span
+{
+  public:
+    using element_type = T;
+    using size_type    = std::size_t;
+    using iterator     = T *;
+
+    constexpr span() noexcept : data_(nullptr), size_(0) {}
+    constexpr span(T *data, size_type size) noexcept : data_(data), size_(size)
+    {
+    }
+
+    template <std::size_t N>
+    constexpr span(T (&arr)[N]) noexcept : data_(arr), size_(N)
+    {
+    }
+
+    /* Containers and spans of compatible element types */
+    template <typename C,
+              typename E = std::remove_pointer_t<
+                  decltype(std::declval<C &>().data())>,
+              typename = std::enable_if_t<std::is_convertible_v<E (*)[],
+                                                                T (*)[]>>>
+    constexpr span(C &&c) : data_(c.data()), size_(c.size())
+    {
+    }
+
+    constexpr T *data() const noexcept
+    {
+        return data_;
+    }
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+    constexpr T &operator[](size_type i) const
+    {
+        return data_[i];
+    }
+    constexpr iterator begin() const noexcept
+    {
+        return data_;
+    }
+    constexpr iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+    constexpr span subspan(size_type offset, size_type count) const
+    {
+        return span(data_ + offset, count);
+    }
+
+  private:
+    T *data_;
+    size_type size_;
+};
+#endif
+
+/**
+ * Sample type traits
+ *
+ * Specializations describe how a sample type is converted to and from the
+ * SC16 Q11 format used on the wire. `native` types share that format's memory
+ * layout and are never converted.
+ */
+template <typename Sample> struct sample_traits;
+
+/*
+ * std::complex<int16_t> is SC16 Q11. The standard only specifies the layout of
+ * std::complex for floating-point types, but every supported standard library
+ * stores the real and imaginary parts as consecutive members.
+ */
+template <> struct sample_traits<std::complex<int16_t>> {
+    static constexpr bool native = true;
+};
+
+static_assert(sizeof(std::complex<int16_t>) == 2 * sizeof(int16_t),
+              "std::complex<int16_t> is not layout-compatible with SC16 Q11");
+
+template <> struct sample_traits<std::complex<float>> {
+    static constexpr bool native = false;
+
+    static constexpr float scale = 2048.0f;
+
+    /* std::complex<float> is guaranteed to be layout-compatible with float[2],
+     * which allows these to be written as flat loops that vectorize well */
+    static void from_sc16(int16_t const *src,
+                          std::complex<float> *dst,
+                          std::size_t n) noexcept
+    {
+        float *out = reinterpret_cast<float *>(dst);
+
+        for (std::size_t i = 0; i < 2 * n; i++) {
+            out[i] = static_cast<float>(src[i]) * (1.0f / scale);
+        }
+    }
+
+    static void to_sc16(std::complex<float> const *src,
+                        int16_t *dst,
+                        std::size_t n) noexcept
+    {
+        float const *in = reinterpret_cast<float const *>(src);
+
+        for (std::size_t i = 0; i < 2 * n; i++) {
+            float const v = in[i] * scale;
+
+            /* NaN converts to 0, as in float_to_sc16q11_sat(). Otherwise, it
+             * would pass through std::clamp() and the cast would be undefined
+             * behaviour. */
+            dst[i] = (v == v) ? static_cast<int16_t>(std::clamp(
+                                    std::nearbyint(v), -2048.0f, 2047.0f))
+                              : int16_t{ 0 };
+        }
+    }
+};
+
+/**
+ * RAII device handle
+ */
+class device
+{
+  public:
+    /**
+     * Open a device
+     *
+     * @param   devstr  Device identifier string, as accepted by bladerf_open().
+     *                  NULL opens the first available device.
+     */
+    explicit device(char const *devstr = nullptr)
+    {
+        detail::check(bladerf_open(&dev_, devstr));
+    }
+
+    explicit device(std::string const &devstr) : device(devstr.c_str()) {}
+
+    device(device const &) = delete;
+    device &operator=(device const &) = delete;
+
+    device(device &&other) noexcept : dev_(std::exchange(other.dev_, nullptr))
+    {
+    }
+
+    device &operator=(device &&other) noexcept
+    {
+        if (this != &other) {
+            close();
+            dev_ = std::exchange(other.dev_, nullptr);
+        }
+        return *this;
+    }
+
+    ~device()
+    {
+        close();
+    }
+
+    /** @return Underlying handle, for use with the C API */
+    struct bladerf *get() const noexcept
+    {
+        return dev_;
+    }
+
+    bladerf_sample_rate set_sample_rate(bladerf_channel ch,
+                                        bladerf_sample_rate rate)
+    {
+        bladerf_sample_rate actual;
+        detail::check(bladerf_set_sample_rate(dev_, ch, rate, &actual));
+        return actual;
+    }
+
+    void set_frequency(bladerf_channel ch, bladerf_frequency freq)
+    {
+        detail::check(bladerf_set_frequency(dev_, ch, freq));
+    }
+
+    void set_gain(bladerf_channel ch, bladerf_gain gain)
+    {
+        detail::check(bladerf_set_gain(dev_, ch, gain));
+    }
+
+    void enable(bladerf_channel ch, bool enable)
+    {
+        detail::check(bladerf_enable_module(dev_, ch, enable));
+    }
+
+  private:
+    void close() noexcept
+    {
+        if (dev_ != nullptr) {
+            bladerf_close(dev_);
+            dev_ = nullptr;
+        }
+    }
+
+    struct bladerf *dev_ = nullptr;
+};
+
+/**
+ * Synchronous stream configuration
+ *
+ * See bladerf_sync_config() for a description of these values.
+ */
+struct stream_config {
+    unsigned int num_buffers   = 16;
+    unsigned int buffer_size   = 8192;
+    unsigned int num_transfers = 8;
+    unsigned int timeout_ms    = 3500;
+};
+
+namespace detail
+{
+    /**
+     * Common implementation of rx_stream and tx_stream
+     *
+     * Configures the synchronous interface and enables the channels on
+     * construction, and disables them on destruction.
+     */
+    template <typename Sample, unsigned int Channels, bool Meta, bool IsTx>
+    class sync_stream
+    {
+        static_assert(Channels == 1 || Channels == 2,
+                      "Only 1 or 2 channels are supported");
+
+      public:
+        using sample_type = Sample;
+        using traits      = sample_traits<Sample>;
+
+        static constexpr unsigned int channels = Channels;
+
+        static constexpr bladerf_format format =
+            Meta ? BLADERF_FORMAT_SC16_Q11_META : BLADERF_FORMAT_SC16_Q11;
+
+        static constexpr bladerf_channel_layout layout =
+            IsTx ? (Channels == 1 ? BLADERF_TX_X1 : BLADERF_TX_X2)
+                 : (Channels == 1 ? BLADERF_RX_X1 : BLADERF_RX_X2);
+
+        sync_stream(device &dev, stream_config const &config)
+            : dev_(dev.get()), timeout_ms_(config.timeout_ms)
+        {
+            check(bladerf_sync_config(dev_, layout, format, config.num_buffers,
+                                      config.buffer_size, config.num_transfers,
+                                      config.timeout_ms));
+
+            unsigned int enabled = 0;
+
+            /* The destructor does not run if the constructor throws, so the
+             * channels enabled so far must be disabled here */
+            try {
+                for (; enabled < Channels; enabled++) {
+                    check(bladerf_enable_module(dev_, channel(enabled), true));
+                }
+
+                if constexpr (!traits::native) {
+                    scratch_.resize(Channels);
+                }
+            } catch (...) {
+                while (enabled-- > 0) {
+                    bladerf_enable_module(dev_, channel(enabled), false);
+                }
+
+                throw;
+            }
+        }
+
+        sync_stream(sync_stream const &) = delete;
+        sync_stream &operator=(sync_stream const &) = delete;
+
+        sync_stream(sync_stream &&other) noexcept
+            : dev_(std::exchange(other.dev_, nullptr)),
+              timeout_ms_(other.timeout_ms_),
+              scratch_(std::move(other.scratch_))
+        {
+        }
+
+        sync_stream &operator=(sync_stream &&) = delete;
+
+        ~sync_stream()
+        {
+            if (dev_ != nullptr) {
+                for (unsigned int c = 0; c < Channels; c++) {
+                    bladerf_enable_module(dev_, channel(c), false);
+                }
+            }
+        }
+
+        /** Set the timeout used by subsequent transfers */
+        void set_timeout(unsigned int timeout_ms) noexcept
+        {
+            timeout_ms_ = timeout_ms;
+        }
+
+      protected:
+        static constexpr bladerf_channel channel(unsigned int c)
+        {
+            return IsTx ? BLADERF_CHANNEL_TX(c) : BLADERF_CHANNEL_RX(c);
+        }
+
+        template <typename Span>
+        static unsigned int common_size(std::array<Span, Channels> const &s)
+        {
+            std::size_t const n = s[0].size();
+
+            for (auto const &ch : s) {
+                if (ch.size() != n) {
+                    throw std::invalid_argument(
+                        "All channels must have the same number of samples");
+                }
+            }
+
+            if (n > UINT32_MAX) {
+                throw std::invalid_argument("Too many samples");
+            }
+
+            return static_cast<unsigned int>(n);
+        }
+
+        /* Scratch buffers for non-native sample types, grown as needed */
+        int16_t *scratch(unsigned int c, std::size_t n)
+        {
+            std::vector<int16_t> &buf = scratch_[c];
+
+            if (buf.size() < 2 * n) {
+                buf.resize(2 * n);
+            }
+
+            return buf.data();
+        }
+
+        struct bladerf *dev_;
+        unsigned int timeout_ms_;
+        std::vector<std::vector<int16_t>> scratch_;
+    };
+}  // namespace detail
+
+/**
+ * Typed RX stream
+ *
+ * @tparam  Sample      Sample type; see sample_traits
+ * @tparam  Channels    Number of channels (1 or 2)
+ * @tparam  Meta        Use BLADERF_FORMAT_SC16_Q11_META, in which case
+ *                      metadata must be supplied with each call
+ */
+template <typename Sample, unsigned int Channels = 1, bool Meta = false>
+class rx_stream
+    : public detail::sync_stream<Sample, Channels, Meta, false>
+{
+    using base = detail::sync_stream<Sample, Channels, Meta, false>;
+
+  public:
+    using traits = typename base::traits;
+
+    explicit rx_stream(device &dev, stream_config const &config = {})
+        : base(dev, config)
+    {
+    }
+
+    /**
+     * Receive samples, one span per channel
+     *
+     * All spans must be the same size.
+     */
+    void receive(std::array<span<Sample>, Channels> const &samples,
+                 bladerf_metadata *meta = nullptr)
+    {
+        unsigned int const n = base::common_size(samples);
+        void *bufs[Channels];
+
+        if constexpr (Meta) {
+            if (meta == nullptr) {
+                throw std::invalid_argument("Metadata is required");
+            }
+        }
+
+        for (unsigned int c = 0; c < Channels; c++) {
+            if constexpr (traits::native) {
+                bufs[c] = samples[c].data();
+            } else {
+                bufs[c] = base::scratch(c, n);
+            }
+        }
+
+        if constexpr (Channels == 1) {
+            detail::check(
+                bladerf_sync_rx(this->dev_, bufs[0], n, meta, this->timeout_ms_));
+        } else {
+            detail::check(
+                bladerf_sync_rxv(this->dev_, bufs, n, meta, this->timeout_ms_));
+        }
+
+        if constexpr (!traits::native) {
+            for (unsigned int c = 0; c < Channels; c++) {
+                traits::from_sc16(static_cast<int16_t const *>(bufs[c]),
+                                  samples[c].data(), n);
+            }
+        }
+    }
+
+    /** Receive samples from a single-channel stream */
+    template <unsigned int C = Channels, typename = std::enable_if_t<C == 1>>
+    void receive(span<Sample> samples, bladerf_metadata *meta = nullptr)
+    {
+        receive(std::array<span<Sample>, 1>{ samples }, meta);
+    }
+};
+
+/**
+ * Typed TX stream
+ *
+ * @tparam  Sample      Sample type; see sample_traits
+ * @tparam  Channels    Number of channels (1 or 2)
+ * @tparam  Meta        Use BLADERF_FORMAT_SC16_Q11_META, in which case
+ *                      metadata must be supplied with each call
+ */
+template <typename Sample, unsigned int Channels = 1, bool Meta = false>
+class tx_stream
+    : public detail::sync_stream<Sample, Channels, Meta, true>
+{
+    using base = detail::sync_stream<Sample, Channels, Meta, true>;
+
+  public:
+    using traits = typename base::traits;
+
+    explicit tx_stream(device &dev, stream_config const &config = {})
+        : base(dev, config)
+    {
+    }
+
+    /**
+     * Transmit samples, one span per channel
+     *
+     * All spans must be the same size.
+     */
+    void transmit(std::array<span<Sample const>, Channels> const &samples,
+                  bladerf_metadata *meta = nullptr)
+    {
+        unsigned int const n = base::common_size(samples);
+        void const *bufs[Channels];
+
+        if constexpr (Meta) {
+            if (meta == nullptr) {
+                throw std::invalid_argument("Metadata is required");
+            }
+        }
+
+        for (unsigned int c = 0; c < Channels; c++) {
+            if constexpr (traits::native) {
+                bufs[c] = samples[c].data();
+            } else {
+                int16_t *buf = base::scratch(c, n);
+                traits::to_sc16(samples[c].data(), buf, n);
+                bufs[c] = buf;
+            }
+        }
+
+        if constexpr (Channels == 1) {
+            detail::check(
+                bladerf_sync_tx(this->dev_, bufs[0], n, meta, this->timeout_ms_));
+        } else {
+            detail::check(
+                bladerf_sync_txv(this->dev_, bufs, n, meta, this->timeout_ms_));
+        }
+    }
+
+    /** Transmit samples on a single-channel stream */
+    template <unsigned int C = Channels, typename = std::enable_if_t<C == 1>>
+    void transmit(span<Sample const> samples, bladerf_metadata *meta = nullptr)
+    {
+        transmit(std::array<span<Sample const>, 1>{ samples }, meta);
+    }
+};
+
+}  // namespace bladeRF
+
+#endif
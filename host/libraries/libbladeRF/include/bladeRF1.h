@@ -418,6 +418,65 @@ int CALL_CONV bladerf_get_sampling(struct bladerf *dev,
 
 /** @} (End of FN_BLADERF1_SAMPLING_MUX) */
 
+/**
+ * @defgroup FN_BLADERF1_SAMPLE_RATES Sample rate precomputation
+ *
+ * The bladeRF1's sample clocks are produced by the Si5338 clock generator.
+ * Each change of sample rate requires solving for the Si5338's multisynth
+ * parameters and writing them to the device.
+ *
+ * libbladeRF retains the most recently used solutions, and tracks the values
+ * last written to the sample clocks' registers. When switching between rates
+ * that have already been used, only the registers whose values differ are
+ * written. A multisynth's parameter registers are always written together,
+ * so that the clock never runs with a mix of old and new parameters.
+ *
+ * Applications that cycle through a known set of sample rates may prepare
+ * them in advance, both to ensure that they are retained and to determine
+ * the rates that will actually be achieved.
+ *
+ * These functions are thread-safe.
+ *
+ * @{
+ */
+
+/**
+ * Maximum number of sample rates that may be prepared for a channel
+ */
+#define BLADERF_MAX_PREPARED_SAMPLE_RATES 16
+
+/**
+ * Precompute the Si5338 configurations for a set of sample rates.
+ *
+ * This does not change the device's sample rate. Subsequent calls to
+ * bladerf_set_rational_sample_rate() or bladerf_set_sample_rate() with one of
+ * these rates will use the precomputed configuration.
+ *
+ * Rates previously prepared for the channel are released.
+ *
+ * @param       dev         Device handle
+ * @param[in]   ch          Channel
+ * @param[in]   rates       Sample rates to prepare
+ * @param[in]   num_rates   Number of entries in `rates`. Must not exceed
+ *                          ::BLADERF_MAX_PREPARED_SAMPLE_RATES.
+ * @param[out]  actual      If non-NULL, populated with the sample rates that
+ *                          will actually be achieved. Must have room for
+ *                          `num_rates` entries.
+ *
+ * @return 0 on success, ::BLADERF_ERR_INVAL if a rate is out of range or too
+ *         many rates are provided, value from \ref RETCODES list on failure.
+ *         No rates are prepared upon failure.
+ */
+API_EXPORT
+int CALL_CONV bladerf_prepare_rational_sample_rates(
+    struct bladerf *dev,
+    bladerf_channel ch,
+    const struct bladerf_rational_rate *rates,
+    unsigned int num_rates,
+    struct bladerf_rational_rate *actual);
+
+/** @} (End of FN_BLADERF1_SAMPLE_RATES) */
+
 /**
  * @defgroup FN_BLADERF1_LPF_BYPASS LPF Bypass
  *
@@ -1262,6 +1321,11 @@ typedef enum {
 /**
  * Perform DC calibration
  *
+ * The results are saved in the user's bladeRF config directory (e.g.,
+ * `~/.config/Nuand/bladeRF/<serial>.cal` on Linux), and are restored when the
+ * device is next opened, taking precedence over any DC calibration tables.
+ * Results older than 30 days are not restored.
+ *
  * @param       dev         Device handle
  * @param[in]   module      Module to calibrate
  *
@@ -1395,6 +1459,32 @@ int CALL_CONV bladerf_calibrate_dc(struct bladerf *dev,
  * */
 #define BLADERF_GPIO_TIMESTAMP_DIV2 (1 << 17)
 
+/**
+ * RX wire format field. This holds a ::bladerf_wire_format value.
+ *
+ * @note This is set using bladerf_set_wire_format(), and is only
+ *       supported by FPGA versions >= v0.11.0.
+ */
+#define BLADERF_GPIO_RX_WIRE_FORMAT_MASK (0x3 << BLADERF_GPIO_RX_WIRE_FORMAT_SHIFT)
+
+/**
+ * RX wire format field shift
+ */
+#define BLADERF_GPIO_RX_WIRE_FORMAT_SHIFT 24
+
+/**
+ * TX wire format field. This holds a ::bladerf_wire_format value.
+ *
+ * @note This is set using bladerf_set_wire_format(), and is only
+ *       supported by FPGA versions >= v0.11.0.
+ */
+#define BLADERF_GPIO_TX_WIRE_FORMAT_MASK (0x3 << BLADERF_GPIO_TX_WIRE_FORMAT_SHIFT)
+
+/**
+ * TX wire format field shift
+ */
+#define BLADERF_GPIO_TX_WIRE_FORMAT_SHIFT 26
+
 /**
  * Write value to VCTCXO trim DAC.
  *
@@ -66,6 +66,72 @@ int CALL_CONV bladerf_set_bias_tee(struct bladerf *dev,
 
 /** @} (End of FN_BLADERF2_BIAS_TEE) */
 
+/**
+ * @defgroup FN_BLADERF2_RX_DECIMATION FPGA RX Decimation
+ *
+ * The FPGA may decimate received samples by a power of two, optionally
+ * applying a frequency shift first. This permits narrowband applications to
+ * obtain low-rate streams without the full RFIC sample rate being carried over
+ * USB or processed by the host.
+ *
+ * When decimation is enabled:
+ *  - Samples are delivered at the RFIC sample rate divided by the decimation
+ *    factor. bladerf_get_sample_rate() continues to report the RFIC rate.
+ *  - RX timestamps, both in metadata and from bladerf_get_timestamp(), are
+ *    in units of decimated samples; they are the RFIC-rate timestamp counter
+ *    divided by the decimation factor. TX timestamps are unaffected.
+ *  - A sample's timestamp is that of the RFIC sample at the center of the
+ *    decimation filters' response, i.e., their group delay of
+ *    11 * (factor - 1) RFIC-rate samples is accounted for.
+ *  - The setting applies to all RX channels.
+ *
+ * These settings should only be changed while RX is disabled. The NCO offset
+ * is computed from the current sample rate, so it should be reapplied after
+ * the sample rate is changed.
+ *
+ * This functionality requires FPGA v0.11.0 or later.
+ *
+ * @{
+ */
+
+/**
+ * Configure the FPGA RX decimation chain
+ *
+ * The NCO has a frequency resolution of the sample rate / 8192, so the
+ * applied offset may differ slightly from the requested offset. Use
+ * bladerf_get_rx_decimation() to retrieve the applied value.
+ *
+ * @param       dev         Device handle
+ * @param[in]   factor      Decimation factor: 1 (no decimation), 2, 4, 8, 16,
+ *                          32, or 64
+ * @param[in]   nco_offset  Frequency, in Hz relative to the tuned frequency,
+ *                          to shift down to DC prior to decimation. Must be
+ *                          within +/- half of the sample rate. 0 disables the
+ *                          NCO.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_rx_decimation(struct bladerf *dev,
+                                        unsigned int factor,
+                                        int32_t nco_offset);
+
+/**
+ * Get the current FPGA RX decimation chain configuration
+ *
+ * @param       dev         Device handle
+ * @param[out]  factor      Decimation factor
+ * @param[out]  nco_offset  Applied NCO frequency offset, in Hz
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_rx_decimation(struct bladerf *dev,
+                                        unsigned int *factor,
+                                        int32_t *nco_offset);
+
+/** @} (End of FN_BLADERF2_RX_DECIMATION) */
+
 /**
  * @defgroup FN_BLADERF2_LOW_LEVEL Low-level accessors
  *
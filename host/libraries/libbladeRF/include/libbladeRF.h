@@ -116,6 +116,9 @@ typedef enum {
     BLADERF_BACKEND_LIBUSB,      /**< libusb */
     BLADERF_BACKEND_CYPRESS,     /**< CyAPI */
     BLADERF_BACKEND_DUMMY = 100, /**< Dummy used for development purposes */
+    BLADERF_BACKEND_REPLAY,      /**< Sample file replay, for testing without
+                                  *   hardware. Configured via the
+                                  *   `BLADERF_REPLAY` environment variable. */
 } bladerf_backend;
 
 /** Length of device description string, including NUL-terminator */
@@ -1879,6 +1882,85 @@ API_EXPORT
 int CALL_CONV bladerf_cancel_scheduled_retunes(struct bladerf *dev,
                                                bladerf_channel ch);
 
+/**
+ * Schedule a frequency retune, as with bladerf_schedule_retune(), tagged with
+ * an ID by which it may later be cancelled.
+ *
+ * Any number of scheduled retunes may share an ID. Retunes scheduled via
+ * bladerf_schedule_retune() carry an ID of 0.
+ *
+ * @param       dev             Device handle
+ * @param[in]   ch              Channel
+ * @param[in]   timestamp       See bladerf_schedule_retune()
+ * @param[in]   frequency       See bladerf_schedule_retune()
+ * @param[in]   quick_tune      See bladerf_schedule_retune()
+ * @param[in]   id              Retune ID
+ *
+ * @return 0 on success, ::BLADERF_ERR_UNSUPPORTED if the FPGA does not
+ *         support retune IDs, or another value from \ref RETCODES list on
+ *         failure.
+ */
+API_EXPORT
+int CALL_CONV bladerf_schedule_retune_with_id(struct bladerf *dev,
+                                              bladerf_channel ch,
+                                              bladerf_timestamp timestamp,
+                                              bladerf_frequency frequency,
+                                              struct bladerf_quick_tune *quick_tune,
+                                              uint8_t id);
+
+/**
+ * Cancel the pending scheduled retunes bearing the specified ID, leaving any
+ * others in place.
+ *
+ * @param       dev         Device handle
+ * @param[in]   ch          Channel
+ * @param[in]   id          Retune ID
+ * @param[out]  cancelled   If non-NULL, updated with the number of retunes
+ *                          that were cancelled
+ *
+ * @return 0 on success, ::BLADERF_ERR_UNSUPPORTED if the FPGA does not
+ *         support retune IDs, or another value from \ref RETCODES list on
+ *         failure.
+ */
+API_EXPORT
+int CALL_CONV bladerf_cancel_scheduled_retunes_with_id(struct bladerf *dev,
+                                                       bladerf_channel ch,
+                                                       uint8_t id,
+                                                       unsigned int *cancelled);
+
+/**
+ * Scheduled retune statistics
+ *
+ * These are accumulated from the FPGA's responses to retune requests, so
+ * retunes performed late are counted once a later request for the same
+ * direction has been made.
+ */
+struct bladerf_retune_stats {
+    /** Scheduled retunes performed late, because their timestamp had already
+     *  passed by the time they reached the head of the FPGA's queue */
+    uint64_t missed;
+
+    /** Scheduled retunes removed via bladerf_cancel_scheduled_retunes_with_id() */
+    uint64_t cancelled;
+};
+
+/**
+ * Get the scheduled retune statistics of a channel's direction, accumulated
+ * since the device was opened.
+ *
+ * The channels of a direction share a retune queue, and hence statistics.
+ *
+ * @param       dev     Device handle
+ * @param[in]   ch      Channel
+ * @param[out]  stats   Retune statistics
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure.
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_retune_stats(struct bladerf *dev,
+                                       bladerf_channel ch,
+                                       struct bladerf_retune_stats *stats);
+
 /**
  * Fetch parameters used to tune the transceiver to the current frequency for
  * use with bladerf_schedule_retune() to perform a "quick retune."
@@ -2006,6 +2088,155 @@ int CALL_CONV bladerf_get_correction(struct bladerf *dev,
 
 /** @} (End of FN_CORR) */
 
+/**
+ * @defgroup FN_PROFILE Configuration profiles
+ *
+ * A configuration profile captures a set of device settings, such as those
+ * that make up an operating mode, so that they may be applied together.
+ *
+ * libbladeRF tracks the settings it has most recently applied or captured.
+ * When a profile is applied via bladerf_apply_profile(), only the settings
+ * that differ from these are written to the device, in an order that accounts
+ * for dependencies between them (e.g., the RF port and gain are applied after
+ * the frequency, which may affect them). Switching between a few profiles
+ * therefore costs only the changes that are actually required.
+ *
+ * Changes made via other libbladeRF functions are accounted for. Changes made
+ * outside of libbladeRF (e.g., by another process) are not; use
+ * bladerf_capture_profile() to resynchronize.
+ *
+ * These functions are thread-safe.
+ *
+ * @{
+ */
+
+/**
+ * @defgroup BLADERF_PROFILE_FIELDS Profile fields
+ *
+ * Bitmask values denoting which settings a profile contains
+ *
+ * @{
+ */
+
+/** bladerf_channel_profile::frequency is valid */
+#define BLADERF_PROFILE_FREQUENCY (1 << 0)
+
+/** bladerf_channel_profile::sample_rate is valid */
+#define BLADERF_PROFILE_SAMPLE_RATE (1 << 1)
+
+/** bladerf_channel_profile::bandwidth is valid */
+#define BLADERF_PROFILE_BANDWIDTH (1 << 2)
+
+/** bladerf_channel_profile::gain_mode is valid. Applicable to RX only. */
+#define BLADERF_PROFILE_GAIN_MODE (1 << 3)
+
+/** bladerf_channel_profile::gain is valid */
+#define BLADERF_PROFILE_GAIN (1 << 4)
+
+/** bladerf_channel_profile::rf_port is valid */
+#define BLADERF_PROFILE_RF_PORT (1 << 5)
+
+/**
+ * bladerf_channel_profile::trigger_signal and
+ * bladerf_channel_profile::trigger_role are valid
+ */
+#define BLADERF_PROFILE_TRIGGER (1 << 6)
+
+/** bladerf_profile::loopback is valid */
+#define BLADERF_PROFILE_LOOPBACK (1 << 16)
+
+/** bladerf_profile::rx_mux is valid */
+#define BLADERF_PROFILE_RX_MUX (1 << 17)
+
+/** @} (End of BLADERF_PROFILE_FIELDS) */
+
+/** Maximum length of an RF port name stored in a profile, including the NUL */
+#define BLADERF_PROFILE_PORT_NAME_LEN 16
+
+/** Number of channels, per direction, that a profile can describe */
+#define BLADERF_PROFILE_MAX_CHANNELS 2
+
+/**
+ * Per-channel settings within a configuration profile
+ */
+struct bladerf_channel_profile {
+    /** Bitmask of BLADERF_PROFILE_* values denoting valid fields. Settings
+     *  whose fields are not valid are left unmodified. */
+    uint32_t fields;
+
+    bladerf_frequency frequency;     /**< Frequency, in Hz */
+    bladerf_sample_rate sample_rate; /**< Sample rate, in samples/second */
+    bladerf_bandwidth bandwidth;     /**< Bandwidth, in Hz */
+    bladerf_gain_mode gain_mode;     /**< Gain control mode */
+    bladerf_gain gain; /**< Overall gain, in dB. This is not applied if
+                        *   `gain_mode` is ::BLADERF_GAIN_AUTOMATIC */
+    char rf_port[BLADERF_PROFILE_PORT_NAME_LEN]; /**< RF port name */
+
+    bladerf_trigger_signal trigger_signal; /**< Trigger signal */
+    bladerf_trigger_role trigger_role;     /**< Trigger role. The trigger is
+                                            *   armed unless this is
+                                            *   ::BLADERF_TRIGGER_ROLE_DISABLED
+                                            */
+};
+
+/**
+ * Configuration profile
+ *
+ * Zero-initialize this structure (or use bladerf_capture_profile()) before
+ * populating it, so that unused settings are ignored.
+ */
+struct bladerf_profile {
+    /** Bitmask of BLADERF_PROFILE_* values denoting valid device-wide
+     *  fields */
+    uint32_t fields;
+
+    bladerf_loopback loopback; /**< Loopback mode */
+    bladerf_rx_mux rx_mux;     /**< RX mux mode */
+
+    /** RX channel settings, indexed by channel number */
+    struct bladerf_channel_profile rx[BLADERF_PROFILE_MAX_CHANNELS];
+
+    /** TX channel settings, indexed by channel number */
+    struct bladerf_channel_profile tx[BLADERF_PROFILE_MAX_CHANNELS];
+};
+
+/**
+ * Capture the device's current configuration into a profile
+ *
+ * All settings supported by the device are read back from the device, and
+ * libbladeRF's record of the applied configuration is updated accordingly.
+ * Settings that are not supported by the device are marked as invalid in the
+ * profile.
+ *
+ * @param       dev         Device handle
+ * @param[out]  profile     Captured profile
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_capture_profile(struct bladerf *dev,
+                                      struct bladerf_profile *profile);
+
+/**
+ * Apply a configuration profile
+ *
+ * Only those valid settings in the profile that differ from the device's
+ * current configuration are applied. This is performed as a single operation
+ * with respect to other threads using the device handle.
+ *
+ * If an error occurs, settings applied up to that point remain in effect.
+ *
+ * @param       dev         Device handle
+ * @param[in]   profile     Profile to apply
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_apply_profile(struct bladerf *dev,
+                                    const struct bladerf_profile *profile);
+
+/** @} (End of FN_PROFILE) */
+
 /** @} (End of FN_CHANNEL) */
 
 /**
@@ -2407,6 +2638,113 @@ int CALL_CONV bladerf_deinterleave_stream_buffer(bladerf_channel_layout layout,
                                                  unsigned int buffer_size,
                                                  void *samples);
 
+/**
+ * Representation of samples as they are transferred over USB, between the
+ * FPGA and the host.
+ *
+ * Both RFICs produce and consume 12-bit samples, so the default 16-bit
+ * representation wastes a quarter of the available USB bandwidth. The packed
+ * representations allow higher aggregate sample rates (e.g., 2x2 MIMO at high
+ * sample rates) to be sustained, at the cost of some host CPU time spent
+ * converting samples.
+ *
+ * With the \ref FN_STREAMING_SYNC interface, the wire format is transparent:
+ * samples are still provided and returned in the ::BLADERF_FORMAT_SC16_Q11
+ * format, and are converted by libbladeRF. With the \ref FN_STREAMING_ASYNC
+ * interface, stream buffers contain samples in the wire format; see
+ * bladerf_unpack_stream_buffer().
+ *
+ * Packed wire formats are currently only supported in conjunction with the
+ * ::BLADERF_FORMAT_SC16_Q11 format (i.e., without metadata), and require FPGA
+ * v0.11.0 or later.
+ */
+typedef enum {
+    /**
+     * 16-bit I and Q; 4 bytes per sample. This is the default.
+     */
+    BLADERF_WIRE_FORMAT_SC16 = 0,
+
+    /**
+     * 12-bit I and Q, packed into 3 bytes per sample:
+     *
+     * <pre>
+     *  .-------------.------------------------------------.
+     *  | Byte offset |           Contents                 |
+     *  +-------------+------------------------------------+
+     *  |    0x00     |  I[7:0]                            |
+     *  |    0x01     |  Q[3:0] (bits 7:4), I[11:8] (3:0)  |
+     *  |    0x02     |  Q[11:4]                           |
+     *  `-------------`------------------------------------`
+     * </pre>
+     *
+     * This is lossless with respect to the RFIC's sample resolution.
+     */
+    BLADERF_WIRE_FORMAT_SC12,
+
+    /**
+     * 8-bit I and Q; 2 bytes per sample. Byte 0 contains I[11:4], and byte
+     * 1 contains Q[11:4]. The 4 least significant bits of each 12-bit value
+     * are discarded (RX) or zeroed (TX).
+     */
+    BLADERF_WIRE_FORMAT_SC8,
+} bladerf_wire_format;
+
+/**
+ * Select the wire format to use for the specified direction.
+ *
+ * This takes effect the next time the sync interface is configured via
+ * bladerf_sync_config(), or a stream is started via bladerf_stream(), for the
+ * specified direction. It cannot be changed while either is configured; to
+ * change the format of a configured sync interface, first disable the
+ * direction via bladerf_enable_module().
+ *
+ * @param       dev         Device handle
+ * @param[in]   dir         Stream direction
+ * @param[in]   wire_format Wire format
+ *
+ * @return 0 on success, BLADERF_ERR_UNSUPPORTED if the FPGA does not support
+ *         packed formats, BLADERF_ERR_INVAL if a stream is configured for the
+ *         direction, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_wire_format(struct bladerf *dev,
+                                      bladerf_direction dir,
+                                      bladerf_wire_format wire_format);
+
+/**
+ * Get the wire format selected for the specified direction.
+ *
+ * @param       dev         Device handle
+ * @param[in]   dir         Stream direction
+ * @param[out]  wire_format Wire format
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_wire_format(struct bladerf *dev,
+                                      bladerf_direction dir,
+                                      bladerf_wire_format *wire_format);
+
+/**
+ * Convert samples in a packed wire format into the ::BLADERF_FORMAT_SC16_Q11
+ * format. This is intended for use with stream buffers received via the
+ * \ref FN_STREAMING_ASYNC interface.
+ *
+ * @param[in]   wire_format Wire format of the samples in `src`
+ * @param[in]   src         Samples to convert
+ * @param[out]  dest        Converted samples. This must have room for
+ *                          `num_samples` SC16 Q11 samples, and must not
+ *                          overlap `src`.
+ * @param[in]   num_samples Number of samples to convert
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_unpack_stream_buffer(bladerf_wire_format wire_format,
+                                           const void *src,
+                                           int16_t *dest,
+                                           unsigned int num_samples);
+
 /** @} (End of STREAMING_FORMAT) */
 
 /**
@@ -2480,6 +2818,158 @@ int CALL_CONV bladerf_get_timestamp(struct bladerf *dev,
                                     bladerf_direction dir,
                                     bladerf_timestamp *timestamp);
 
+/**
+ * Alignment, in bytes, of each buffer allocated by
+ * bladerf_alloc_sample_buffers()
+ *
+ * This is sufficient for aligned loads and stores of any SIMD register width
+ * in common use, and avoids buffers sharing a cache line.
+ */
+#define BLADERF_SAMPLE_BUFFER_ALIGNMENT 64
+
+/**
+ * bladerf_alloc_sample_buffers() flag requesting that buffers be backed by
+ * huge pages, where supported by the host
+ *
+ * Reserved huge pages are used when available. Otherwise, the allocation falls
+ * back to regular pages, with transparent huge pages requested where the OS
+ * supports them.
+ */
+#define BLADERF_SAMPLE_BUFFER_HUGEPAGES (1 << 0)
+
+/**
+ * Allocate a set of sample buffers suitable for use with the streaming APIs
+ *
+ * The buffers are allocated from a single zero-filled region. Each buffer
+ * begins on a ::BLADERF_SAMPLE_BUFFER_ALIGNMENT boundary, and the region
+ * itself is page-aligned.
+ *
+ * All pages are touched by the calling thread before this function returns.
+ * This avoids page faults in the data path and, on NUMA systems using the
+ * default first-touch policy, places the memory on the node of the calling
+ * thread. Therefore, call this from the thread (or a thread bound to the same
+ * node) that will process the samples.
+ *
+ * The returned buffers may be used as the `samples` argument to
+ * bladerf_sync_rx() and bladerf_sync_tx(), or otherwise as ordinary arrays.
+ *
+ * @param[out]  buffers             Upon success, updated to point to an array
+ *                                  of `num_buffers` buffer pointers
+ * @param[in]   num_buffers         Number of buffers to allocate
+ * @param[in]   format              Sample format
+ * @param[in]   samples_per_buffer  Size of each buffer, in samples
+ * @param[in]   flags               Bitmask of BLADERF_SAMPLE_BUFFER_* flags.
+ *                                  Specify 0 for default behavior.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_alloc_sample_buffers(void ***buffers,
+                                           size_t num_buffers,
+                                           bladerf_format format,
+                                           size_t samples_per_buffer,
+                                           uint32_t flags);
+
+/**
+ * Free buffers allocated by bladerf_alloc_sample_buffers()
+ *
+ * @param   buffers     Buffer array to free. This may be NULL.
+ */
+API_EXPORT
+void CALL_CONV bladerf_free_sample_buffers(void **buffers);
+
+/**
+ * Stream fault injection configuration
+ *
+ * This is intended for exercising an application's (and libbladeRF's)
+ * handling of adverse streaming conditions without requiring misbehaving
+ * hardware. Faults are applied to transfer completions, as they are passed
+ * from the backend to the stream. Decisions are made by a pseudorandom number
+ * generator seeded with bladerf_stream_faults::seed, so a given configuration
+ * is repeatable.
+ *
+ * @see bladerf_set_stream_faults()
+ */
+struct bladerf_stream_faults {
+    uint64_t seed;         /**< PRNG seed */
+    unsigned int delay_us; /**< Fixed delay added to each completion, in
+                            *   microseconds */
+    unsigned int jitter_us; /**< Maximum additional uniformly-distributed
+                             *   random delay, in microseconds */
+    double drop_prob;    /**< Probability [0, 1] that an RX transfer's
+                          *   samples are discarded and the transfer is
+                          *   silently resubmitted */
+    double timeout_prob; /**< Probability [0, 1] that a transfer is reported
+                          *   as having timed out, which terminates the
+                          *   stream with ::BLADERF_ERR_TIMEOUT */
+    double stall_prob;     /**< Probability [0, 1] that completion handling
+                            *   stalls for `stall_ms` */
+    unsigned int stall_ms; /**< Duration of a stall, in milliseconds */
+};
+
+/**
+ * Counts of stream faults injected across all of a device's streams
+ *
+ * These are reset each time a stream is initialized, including when
+ * bladerf_sync_config() is called for either direction.
+ */
+struct bladerf_stream_fault_stats {
+    uint64_t completions; /**< Transfer completions observed */
+    uint64_t delayed;     /**< Completions delayed (including stalls) */
+    uint64_t stalls;      /**< Completions stalled */
+    uint64_t dropped;     /**< RX transfers dropped */
+    uint64_t timeouts;    /**< Transfer timeouts injected */
+};
+
+/**
+ * Configure stream fault injection
+ *
+ * The configuration applies to streams initialized after this call, including
+ * those initialized internally by bladerf_sync_config().
+ *
+ * If this function is not called, a configuration is read from the
+ * `BLADERF_STREAM_FAULTS` environment variable, if set, when a stream is
+ * initialized. This contains comma-separated `key=value` pairs, where the
+ * keys are `seed`, `delay_us`, `jitter_us`, `drop`, `timeout`, `stall`, and
+ * `stall_ms`. For example:
+ *
+ * <pre>
+ *  BLADERF_STREAM_FAULTS="seed=42,delay_us=100,jitter_us=400,drop=0.01"
+ * </pre>
+ *
+ * @note This is only available when libbladeRF is built with the
+ *       `ENABLE_LIBBLADERF_FAULT_INJECTION` option.
+ *
+ * @param       dev         Device handle
+ * @param[in]   faults      Fault configuration, or NULL to disable fault
+ *                          injection (including that requested via the
+ *                          environment)
+ *
+ * @return 0 on success,
+ *         ::BLADERF_ERR_UNSUPPORTED if libbladeRF is not built with support
+ *         for this functionality,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_stream_faults(
+    struct bladerf *dev, const struct bladerf_stream_faults *faults);
+
+/**
+ * Retrieve counts of injected stream faults since the most recent stream
+ * initialization
+ *
+ * @param       dev         Device handle
+ * @param[out]  stats       Fault counts
+ *
+ * @return 0 on success,
+ *         ::BLADERF_ERR_UNSUPPORTED if libbladeRF is not built with support
+ *         for this functionality,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_stream_fault_stats(
+    struct bladerf *dev, struct bladerf_stream_fault_stats *stats);
+
 /**
  * @defgroup FN_STREAMING_SYNC  Synchronous API
  *
@@ -2638,39 +3128,322 @@ int CALL_CONV bladerf_sync_rx(struct bladerf *dev,
                               struct bladerf_metadata *metadata,
                               unsigned int timeout_ms);
 
-
-/** @} (End of FN_STREAMING_SYNC) */
-
 /**
- * @defgroup FN_STREAMING_ASYNC    Asynchronous API
+ * Transmit IQ samples from one array per channel.
  *
- * This interface gives the API user full control over the stream and buffer
- * management, at the cost of added complexity.
+ * This behaves like bladerf_sync_tx(), except that rather than requiring
+ * the caller to provide interleaved samples for a multi-channel layout (e.g.,
+ * ::BLADERF_TX_X2), samples are read from a separate array for each channel
+ * and interleaved directly into the underlying stream buffers. This avoids the
+ * intermediate copy incurred by using bladerf_interleave_stream_buffer().
  *
- * @note New users are recommended to first evaluate the \ref FN_STREAMING_SYNC
- *       interface, and to only use this interface if the former is found to not
- *       yield suitable performance.
+ * For single-channel layouts, `samples` must contain a single array and this
+ * call is equivalent to bladerf_sync_tx().
  *
- * These functions are either thread-safe or may be used in a thread-safe
- * manner (per the details noted in the function description).
+ * @pre A bladerf_sync_config() call has been to configure the device for
+ *      synchronous data transfer.
  *
- * @{
+ * @param       dev         Device handle
+ * @param[in]   samples     Array of per-channel sample arrays, one for each
+ *                          channel in the configured ::bladerf_channel_layout,
+ *                          in channel order
+ * @param[in]   num_samples Number of samples to write, per channel
+ * @param[in]   metadata    Sample metadata. This must be provided when using
+ *                          the ::BLADERF_FORMAT_SC16_Q11_META format, but may
+ *                          be NULL when the interface is configured for
+ *                          the ::BLADERF_FORMAT_SC16_Q11 format.
+ * @param[in]   timeout_ms  Timeout (milliseconds) for this call to complete.
+ *                          Zero implies "infinite."
+ *
+ * @return 0 on success,
+ *         ::BLADERF_ERR_UNSUPPORTED if libbladeRF is not built with support
+ *         for this functionality,
+ *         or a value from \ref RETCODES list on failures.
  */
+API_EXPORT
+int CALL_CONV bladerf_sync_txv(struct bladerf *dev,
+                               void const *const *samples,
+                               unsigned int num_samples,
+                               struct bladerf_metadata *metadata,
+                               unsigned int timeout_ms);
 
 /**
- * Use this as a return value in callbacks or as the buffer parameter to
- * bladerf_submit_stream_buffer() to shutdown a stream.
+ * Receive IQ samples into one array per channel.
+ *
+ * This behaves like bladerf_sync_rx(), except that samples from a
+ * multi-channel layout (e.g., ::BLADERF_RX_X2) are deinterleaved directly from
+ * the underlying stream buffers into a separate array for each channel. This
+ * avoids the intermediate copy incurred by using
+ * bladerf_deinterleave_stream_buffer().
+ *
+ * For single-channel layouts, `samples` must contain a single array and this
+ * call is equivalent to bladerf_sync_rx().
+ *
+ * @pre A bladerf_sync_config() call has been to configure the device for
+ *      synchronous data transfer.
+ *
+ * @param       dev         Device handle
+ * @param[out]  samples     Array of per-channel sample arrays, one for each
+ *                          channel in the configured ::bladerf_channel_layout,
+ *                          in channel order. Each must be large enough to hold
+ *                          `num_samples` samples.
+ * @param[in]   num_samples Number of samples to read, per channel
+ * @param[out]  metadata    Sample metadata. This must be provided when using
+ *                          the ::BLADERF_FORMAT_SC16_Q11_META format, but may
+ *                          be NULL when the interface is configured for
+ *                          the ::BLADERF_FORMAT_SC16_Q11 format. The
+ *                          bladerf_metadata::actual_count field is reported
+ *                          per channel.
+ * @param[in]   timeout_ms  Timeout (milliseconds) for this call to complete.
+ *                          Zero implies "infinite."
+ *
+ * @return 0 on success,
+ *         ::BLADERF_ERR_UNSUPPORTED if libbladeRF is not built with support
+ *         for this functionality,
+ *         or a value from \ref RETCODES list on failures.
  */
-#define BLADERF_STREAM_SHUTDOWN (NULL)
+API_EXPORT
+int CALL_CONV bladerf_sync_rxv(struct bladerf *dev,
+                               void *const *samples,
+                               unsigned int num_samples,
+                               struct bladerf_metadata *metadata,
+                               unsigned int timeout_ms);
 
 /**
- * Use this value in a stream callback to indicate that no buffer is being
- * provided. In this case, buffers are expected to be provided via
- * bladerf_submit_stream_buffer().
+ * RX overrun recovery policy
+ *
+ * A software overrun occurs when bladerf_sync_rx() is not called often enough
+ * to keep up with the incoming samples, and the synchronous interface's
+ * worker finds no empty buffer to hand to the next USB transfer.
  */
-#define BLADERF_STREAM_NO_DATA ((void *)(-1))
+typedef enum {
+    /**
+     * Discard the buffer that was just received, along with the next
+     * `num_transfers - 1` buffers, so that the in-flight transfers return to
+     * their original order. Buffers that have already been received, but not
+     * yet read, are retained.
+     *
+     * This is the default.
+     */
+    BLADERF_RX_OVERRUN_RESUBMIT,
 
-/** This opaque structure is used to keep track of stream information */
+    /**
+     * Discard only the oldest received buffer that bladerf_sync_rx() has not
+     * yet started reading, and immediately hand it back to the USB layer. At
+     * most one buffer is lost per transfer that completes while the caller is
+     * behind, and the newest samples are always retained.
+     *
+     * The discarded range is recorded and may be retrieved via
+     * bladerf_get_rx_overrun().
+     */
+    BLADERF_RX_OVERRUN_DROP_OLDEST,
+} bladerf_rx_overrun_recovery;
+
+/**
+ * Samples discarded by RX overrun recovery
+ */
+struct bladerf_rx_overrun {
+    /**
+     * Position of the first discarded sample.
+     *
+     * When using the ::BLADERF_FORMAT_SC16_Q11_META format, this is the
+     * timestamp of the first discarded sample. Otherwise, this is the number of
+     * samples that were received before it, since the stream was started.
+     */
+    bladerf_timestamp timestamp;
+
+    /**
+     * Number of discarded samples, in the same units as `timestamp`
+     */
+    uint64_t length;
+
+    /**
+     * Number of buffers discarded. This is 0 if no samples have been
+     * discarded since the previous bladerf_get_rx_overrun() call.
+     */
+    unsigned int count;
+
+    /**
+     * Number of separate discontinuities the discarded buffers span. When this
+     * is 1, the discarded samples form the single contiguous range
+     * [`timestamp`, `timestamp` + `length`).
+     */
+    unsigned int discontinuities;
+};
+
+/**
+ * Select how the synchronous RX interface recovers from software overruns.
+ *
+ * This setting persists across bladerf_sync_config() calls, and may be changed
+ * while streaming.
+ *
+ * @param       dev     Device handle
+ * @param[in]   mode    Recovery policy
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_rx_overrun_recovery(
+    struct bladerf *dev, bladerf_rx_overrun_recovery mode);
+
+/**
+ * Retrieve, and then clear, the range of samples discarded by RX overrun
+ * recovery since the previous call to this function.
+ *
+ * Only ::BLADERF_RX_OVERRUN_DROP_OLDEST records discarded samples.
+ *
+ * A typical use is to call this function when bladerf_sync_rx() reports
+ * ::BLADERF_META_STATUS_OVERRUN, in order to learn the exact extent of the
+ * gap in a single query.
+ *
+ * @pre A bladerf_sync_config() call has been made to configure the device for
+ *      synchronous reception.
+ *
+ * @param       dev     Device handle
+ * @param[out]  info    Discarded sample range
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_rx_overrun(struct bladerf *dev,
+                                     struct bladerf_rx_overrun *info);
+
+/**
+ * Retain the most recently received samples in a history, indexed by
+ * timestamp, so that they may be read again via bladerf_sync_rx_at().
+ *
+ * Every buffer walked by the synchronous RX interface is recorded, including
+ * samples skipped over when bladerf_sync_rx() seeks to a future timestamp.
+ * This allows an event detected in one part of the stream to be followed by a
+ * read of the samples that preceded it.
+ *
+ * The history is only maintained for ::BLADERF_FORMAT_SC16_Q11_META streams.
+ * Samples are stored in SC16 Q11, regardless of the wire format.
+ *
+ * The history's length is computed from the RX sample rate at the time of
+ * this call. Call this function again after changing the sample rate.
+ *
+ * This setting persists across bladerf_sync_config() calls. Changing it
+ * while streaming discards the current contents of the history.
+ *
+ * @param       dev         Device handle
+ * @param[in]   duration_ms Duration of the history, in milliseconds.
+ *                          0 disables the history, which is the default.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_rx_history(struct bladerf *dev,
+                                     unsigned int duration_ms);
+
+/**
+ * Receive the samples starting at the specified timestamp, which may have
+ * already been consumed by bladerf_sync_rx().
+ *
+ * Samples held in the history configured via bladerf_set_rx_history() are
+ * copied from there. If the interval extends beyond the newest sample
+ * received, the stream is read forward until it has been received, as
+ * bladerf_sync_rx() would do with a future timestamp. Note that a subsequent
+ * bladerf_sync_rx() call continues from that point.
+ *
+ * Timestamps within the interval that were lost to an overrun are zero-filled,
+ * and reported by setting ::BLADERF_META_STATUS_OVERRUN in the metadata
+ * status.
+ *
+ * Samples are interleaved, and counted, as with bladerf_sync_rx().
+ *
+ * @pre A bladerf_sync_config() call has been made to configure the device for
+ *      synchronous reception with ::BLADERF_FORMAT_SC16_Q11_META, and
+ *      bladerf_set_rx_history() has been called with a non-zero duration.
+ *
+ * @param       dev         Device handle
+ * @param[out]  samples     Buffer to store samples in. Must be large enough
+ *                          for `num_samples` samples.
+ * @param[in]   num_samples Number of samples to read. May not exceed the
+ *                          length of the history.
+ * @param[in]   timestamp   Timestamp of the first sample to read
+ * @param[out]  metadata    Optional. On success, `timestamp` and
+ *                          `actual_count` describe the interval read, and
+ *                          `status` reports overruns within it.
+ * @param[in]   timeout_ms  Timeout (milliseconds) for reading forward
+ *                          through the stream. 0 implies an infinite wait.
+ *
+ * @return 0 on success, ::BLADERF_ERR_TIME_PAST if part of the interval is
+ *         older than the history, or another value from \ref RETCODES on
+ *         failure.
+ */
+API_EXPORT
+int CALL_CONV bladerf_sync_rx_at(struct bladerf *dev,
+                                 void *samples,
+                                 unsigned int num_samples,
+                                 bladerf_timestamp timestamp,
+                                 struct bladerf_metadata *metadata,
+                                 unsigned int timeout_ms);
+
+/**
+ * Select the number of threads the synchronous interface uses to convert
+ * samples between SC16 Q11 and a packed wire format (see
+ * bladerf_set_wire_format()).
+ *
+ * By default (0 threads), samples are converted on the calling thread as
+ * bladerf_sync_rx() and bladerf_sync_tx() copy them. With one or more threads,
+ * each stream buffer is instead converted as a whole by a pool of worker
+ * threads, allowing several buffers to be converted in parallel. Buffers are
+ * still delivered to bladerf_sync_rx(), and transmitted, in stream order.
+ *
+ * With threads in use, bladerf_sync_tx() may return before the final buffer
+ * of a burst has been handed to the device, and reports a failure to submit a
+ * buffer upon the next buffer it fills.
+ *
+ * This has no effect with the ::BLADERF_WIRE_FORMAT_SC16 wire format, which
+ * requires no conversion.
+ *
+ * This takes effect the next time bladerf_sync_config() is called for the
+ * specified direction.
+ *
+ * @param       dev         Device handle
+ * @param[in]   dir         Stream direction
+ * @param[in]   num_threads Number of threads, up to 16. 0 disables the pool.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_sync_dsp_threads(struct bladerf *dev,
+                                           bladerf_direction dir,
+                                           unsigned int num_threads);
+
+/** @} (End of FN_STREAMING_SYNC) */
+
+/**
+ * @defgroup FN_STREAMING_ASYNC    Asynchronous API
+ *
+ * This interface gives the API user full control over the stream and buffer
+ * management, at the cost of added complexity.
+ *
+ * @note New users are recommended to first evaluate the \ref FN_STREAMING_SYNC
+ *       interface, and to only use this interface if the former is found to not
+ *       yield suitable performance.
+ *
+ * These functions are either thread-safe or may be used in a thread-safe
+ * manner (per the details noted in the function description).
+ *
+ * @{
+ */
+
+/**
+ * Use this as a return value in callbacks or as the buffer parameter to
+ * bladerf_submit_stream_buffer() to shutdown a stream.
+ */
+#define BLADERF_STREAM_SHUTDOWN (NULL)
+
+/**
+ * Use this value in a stream callback to indicate that no buffer is being
+ * provided. In this case, buffers are expected to be provided via
+ * bladerf_submit_stream_buffer().
+ */
+#define BLADERF_STREAM_NO_DATA ((void *)(-1))
+
+/** This opaque structure is used to keep track of stream information */
 struct bladerf_stream;
 
 /**
@@ -2923,8 +3696,665 @@ int CALL_CONV bladerf_get_stream_timeout(struct bladerf *dev,
 
 /** @} (End of FN_STREAMING_ASYNC) */
 
+/**
+ * @defgroup FN_STREAMING_TX_MIXER  TX mixer
+ *
+ * The TX mixer allows several independent producers to share a single
+ * transmitter. Each producer submits timestamped bursts of samples; a mixer
+ * thread sums any that overlap, saturating the result to the SC16 Q11 range,
+ * and transmits it through the synchronous interface in the
+ * ::BLADERF_FORMAT_SC16_Q11_META format.
+ *
+ * The mixer commits samples to the device `lead_time_us` ahead of their
+ * timestamps. Until then, a newly submitted burst may still be mixed with
+ * bursts already queued. A burst is reported as late, and dropped in its
+ * entirety, if the mixer has already committed samples beyond its timestamp,
+ * or if it is reached with less than half of the lead time remaining.
+ *
+ * Gaps between bursts that are shorter than `burst_gap` are filled with
+ * zeros. Longer gaps end the device burst (::BLADERF_META_FLAG_TX_BURST_END),
+ * and the next begins at its timestamp.
+ *
+ * Before creating a mixer, configure the synchronous TX interface with the
+ * ::BLADERF_TX_X1 layout and the ::BLADERF_FORMAT_SC16_Q11_META format, and
+ * enable the TX channel. While the mixer exists, it is the sole user of
+ * bladerf_sync_tx() on the device.
+ *
+ * These functions are thread-safe. Each producer may be used from a
+ * different thread.
+ *
+ * @{
+ */
+
+/** Opaque TX mixer handle */
+struct bladerf_tx_mixer;
+
+/** Opaque TX mixer producer handle */
+struct bladerf_tx_producer;
+
+/**
+ * TX mixer configuration
+ *
+ * Fields set to 0 take the default value noted.
+ */
+struct bladerf_tx_mixer_config {
+    /**
+     * Channel being transmitted on. Its sample rate is used to convert
+     * between time and timestamps. (Default: BLADERF_CHANNEL_TX(0))
+     */
+    bladerf_channel channel;
+
+    /**
+     * Number of samples mixed and passed to bladerf_sync_tx() at a time.
+     * (Default: 4096)
+     */
+    unsigned int chunk_size;
+
+    /**
+     * Minimum gap between device bursts, in samples. This must be at least
+     * the `buffer_size` passed to bladerf_sync_config(), as ending a burst
+     * flushes the remainder of a buffer. (Default: 8192)
+     */
+    unsigned int burst_gap;
+
+    /**
+     * How far ahead of their timestamps samples are committed to the device,
+     * in microseconds. (Default: 20000)
+     */
+    unsigned int lead_time_us;
+
+    /**
+     * Maximum number of bursts each producer may have queued.
+     * (Default: 64)
+     */
+    unsigned int max_pending;
+
+    /**
+     * Timeout passed to bladerf_sync_tx(), in milliseconds.
+     * (Default: 1000)
+     */
+    unsigned int timeout_ms;
+};
+
+/**
+ * TX mixer producer statistics
+ */
+struct bladerf_tx_producer_stats {
+    uint64_t bursts_submitted; /**< Bursts accepted by
+                                *   bladerf_tx_producer_submit() */
+    uint64_t bursts_sent;      /**< Bursts fully passed to the device */
+    uint64_t bursts_late;      /**< Bursts dropped for being late */
+    uint64_t samples_late;     /**< Samples in the bursts dropped for being
+                                *   late */
+
+    /** Timestamp of the most recent late burst. Only valid when
+     *  `bursts_late` is nonzero. */
+    bladerf_timestamp last_late_timestamp;
+};
+
+/**
+ * TX mixer statistics
+ */
+struct bladerf_tx_mixer_stats {
+    uint64_t samples;         /**< Samples passed to the device */
+    uint64_t samples_clipped; /**< Samples in which the sum of overlapping
+                               *   bursts was saturated */
+    uint64_t device_bursts;   /**< Device bursts started */
+
+    /** 0 while the mixer is running. Otherwise, the error, from the
+     *  \ref RETCODES list, that stopped the mixer thread. */
+    int status;
+};
+
+/**
+ * Create a TX mixer and start its thread
+ *
+ * @param       dev         Device handle
+ * @param[out]  mixer       Updated to point to the new mixer on success
+ * @param[in]   config      Mixer configuration. May be NULL to use defaults.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_tx_mixer_create(
+    struct bladerf *dev,
+    struct bladerf_tx_mixer **mixer,
+    const struct bladerf_tx_mixer_config *config);
+
+/**
+ * Stop a TX mixer and free it, along with any remaining producers
+ *
+ * A device burst in progress is ended. Queued bursts that have not yet been
+ * started are discarded.
+ *
+ * @param       mixer       Mixer to destroy. This may be NULL.
+ */
+API_EXPORT
+void CALL_CONV bladerf_tx_mixer_destroy(struct bladerf_tx_mixer *mixer);
+
+/**
+ * Get TX mixer statistics
+ *
+ * @param       mixer       Mixer handle
+ * @param[out]  stats       Updated with the mixer's statistics
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_tx_mixer_get_stats(struct bladerf_tx_mixer *mixer,
+                                         struct bladerf_tx_mixer_stats *stats);
+
+/**
+ * Add a producer to a TX mixer
+ *
+ * @param       mixer       Mixer handle
+ * @param[out]  producer    Updated to point to the new producer on success
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_tx_producer_add(struct bladerf_tx_mixer *mixer,
+                                      struct bladerf_tx_producer **producer);
+
+/**
+ * Remove a producer from its TX mixer, and free it
+ *
+ * Any of its bursts that are still queued are discarded, including the
+ * remainder of one that is partially transmitted.
+ *
+ * @param       producer    Producer to remove
+ */
+API_EXPORT
+void CALL_CONV bladerf_tx_producer_remove(struct bladerf_tx_producer *producer);
+
+/**
+ * Queue a burst for transmission
+ *
+ * The samples are copied, so the buffer may be reused once this returns.
+ * Bursts from one producer may overlap each other, and need not be submitted
+ * in timestamp order.
+ *
+ * @param       producer    Producer handle
+ * @param[in]   samples     Interleaved SC16 Q11 samples
+ * @param[in]   num_samples Number of samples
+ * @param[in]   timestamp   Timestamp of the first sample
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_QUEUE_FULL if the producer already has `max_pending`
+ *         bursts queued, BLADERF_ERR_TIME_PAST if the mixer has already
+ *         committed samples beyond `timestamp`, or another value from
+ *         \ref RETCODES list on failure. If the mixer thread has stopped, the
+ *         error that stopped it is returned.
+ */
+API_EXPORT
+int CALL_CONV bladerf_tx_producer_submit(struct bladerf_tx_producer *producer,
+                                         const int16_t *samples,
+                                         unsigned int num_samples,
+                                         bladerf_timestamp timestamp);
+
+/**
+ * Get TX mixer producer statistics
+ *
+ * @param       producer    Producer handle
+ * @param[out]  stats       Updated with the producer's statistics
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_tx_producer_get_stats(
+    struct bladerf_tx_producer *producer,
+    struct bladerf_tx_producer_stats *stats);
+
+/** @} (End of FN_STREAMING_TX_MIXER) */
+
+/**
+ * @defgroup FN_STREAMING_SLOTS  Half-duplex slot scheduling
+ *
+ * Half-duplex protocols (e.g., stop-and-wait links and TDMA) alternate
+ * between transmitting and receiving. Doing so with ::BLADERF_META_FLAG_TX_NOW
+ * bursts and ::BLADERF_META_FLAG_RX_NOW reads makes the turnaround time depend
+ * upon how quickly the host reacts.
+ *
+ * Instead, bladerf_run_slots() takes a plan of TX bursts and RX windows, each
+ * at a timestamp, and arms both directions ahead of time: all TX bursts are
+ * handed to the device, with their timestamps, from a separate thread, while
+ * the RX windows are read from the stream in the calling thread. The device
+ * holds each TX burst until its timestamp and the RX stream buffers samples
+ * until they are read, so the turnaround is determined by the hardware.
+ *
+ * Before running a plan, configure the synchronous interface of both
+ * directions with the ::BLADERF_FORMAT_SC16_Q11_META format and enable the
+ * channels. Slots' timestamps are in the counter of their direction, as
+ * returned by bladerf_get_timestamp().
+ *
+ * While a plan is running, it is the sole user of bladerf_sync_tx() and
+ * bladerf_sync_rx() on the device.
+ *
+ * @{
+ */
+
+/**
+ * A TX burst or RX window
+ */
+struct bladerf_slot {
+    /** Direction of the slot */
+    bladerf_direction dir;
+
+    /**
+     * Timestamp of the first sample transmitted (TX) or received (RX)
+     */
+    bladerf_timestamp timestamp;
+
+    /**
+     * Number of samples to transmit, or length of the receive window
+     */
+    unsigned int num_samples;
+
+    /**
+     * Samples to transmit (not modified), or buffer to receive into. The
+     * buffer must be large enough for `num_samples` in the format and layout
+     * the direction was configured with.
+     */
+    void *samples;
+
+    /**
+     * Set by bladerf_run_slots(): 0 on success, or value from \ref RETCODES
+     * list if this slot failed. Slots that were not attempted are set to
+     * ::BLADERF_ERR_UNEXPECTED.
+     */
+    int status;
+
+    /**
+     * Set by bladerf_run_slots(): BLADERF_META_STATUS_* flags reported for
+     * this slot
+     */
+    uint32_t meta_status;
+};
+
+/**
+ * Run a plan of TX bursts and RX windows
+ *
+ * Within each direction, slots must be in increasing timestamp order and
+ * must not overlap. TX and RX slots may be interleaved in any order in the
+ * `slots` array. TX bursts are transmitted with the
+ * ::BLADERF_META_FLAG_TX_BURST_START and ::BLADERF_META_FLAG_TX_BURST_END
+ * flags, so the transmitter is idle between them.
+ *
+ * This function returns once every RX window has been received and every TX
+ * burst has been handed to bladerf_sync_tx(). TX bursts may still be waiting
+ * on the device for their timestamps at that point, so a TX slot's `status`
+ * reports whether the burst was queued, not whether it was transmitted.
+ *
+ * A failed slot does not prevent the remaining slots from being attempted.
+ * RX slots after a failed TX slot are still received, and vice versa.
+ *
+ * @param       dev         Device handle
+ * @param       slots       Plan to run. The `status` and `meta_status` fields
+ *                          of each slot are updated.
+ * @param[in]   num_slots   Number of slots in the plan
+ * @param[in]   timeout_ms  Timeout for each slot's bladerf_sync_tx() or
+ *                          bladerf_sync_rx() call. For RX slots, it must allow
+ *                          for the time until the end of the window.
+ *
+ * @return 0 if every slot succeeded, BLADERF_ERR_INVAL if the plan is
+ *         invalid (in which case no slots are run), or the status of the
+ *         earliest failed slot in `slots`
+ */
+API_EXPORT
+int CALL_CONV bladerf_run_slots(struct bladerf *dev,
+                                struct bladerf_slot *slots,
+                                unsigned int num_slots,
+                                unsigned int timeout_ms);
+
+/** @} (End of FN_STREAMING_SLOTS) */
+
 /** @} (End of STREAMING) */
 
+/**
+ * @defgroup FN_TELEMETRY Telemetry
+ *
+ * Reading board health (supply voltage, current and power, RFIC temperature,
+ * RSSI, and VCTCXO trim) requires device round trips that contend with
+ * time-critical control operations, such as retunes and gain changes.
+ *
+ * When enabled, a telemetry thread samples these values in the background,
+ * at a low rate. It only accesses the device when no other control operation
+ * is in progress, and performs one read at a time, so a control operation
+ * waits at most one read for it. Readings are published as snapshots, which
+ * bladerf_get_telemetry() and bladerf_get_telemetry_history() retrieve
+ * without accessing the device or waiting on any lock.
+ *
+ * Items that a device does not support (e.g., the power monitor on the
+ * bladeRF x40/x115) are silently dropped from sampling.
+ *
+ * bladerf_enable_telemetry() and bladerf_disable_telemetry() must not be
+ * called concurrently with any other telemetry function on the same device.
+ * The remaining functions are thread-safe.
+ *
+ * @{
+ */
+
+/**
+ * @defgroup BLADERF_TELEMETRY_ITEMS Telemetry items
+ *
+ * Flags identifying the values sampled by the telemetry thread
+ *
+ * @{
+ */
+
+/** Power monitor bus voltage */
+#define BLADERF_TELEMETRY_BUS_VOLTAGE (1 << 0)
+
+/** Power monitor current */
+#define BLADERF_TELEMETRY_CURRENT (1 << 1)
+
+/** Power monitor power */
+#define BLADERF_TELEMETRY_POWER (1 << 2)
+
+/** RFIC temperature. Unavailable in FPGA tuning mode. */
+#define BLADERF_TELEMETRY_RFIC_TEMPERATURE (1 << 3)
+
+/** RSSI of each RX channel */
+#define BLADERF_TELEMETRY_RSSI (1 << 4)
+
+/** Current VCTCXO trim DAC value */
+#define BLADERF_TELEMETRY_VCTCXO_TRIM (1 << 5)
+
+/** All of the above */
+#define BLADERF_TELEMETRY_ALL (0x3f)
+
+/** @} (End of BLADERF_TELEMETRY_ITEMS) */
+
+/**
+ * Telemetry configuration
+ *
+ * Fields set to 0 take the default value noted.
+ */
+struct bladerf_telemetry_config {
+    /** Interval between snapshots, in milliseconds. (Default: 1000) */
+    unsigned int interval_ms;
+
+    /** Number of snapshots retained in the history. (Default: 60) */
+    unsigned int history_len;
+
+    /**
+     * Items to sample, as a bitmask of \ref BLADERF_TELEMETRY_ITEMS values.
+     * (Default: ::BLADERF_TELEMETRY_ALL)
+     */
+    uint32_t items;
+};
+
+/**
+ * Telemetry snapshot
+ */
+struct bladerf_telemetry {
+    /**
+     * Snapshot number, starting at 1. A value of 0 indicates that no
+     * snapshot has been taken yet.
+     */
+    uint64_t sequence;
+
+    /** Time the snapshot was taken, in nanoseconds since the UNIX epoch */
+    uint64_t time_ns;
+
+    /**
+     * Items holding a value, as a bitmask of \ref BLADERF_TELEMETRY_ITEMS
+     * values. Fields of items not included here should be ignored.
+     */
+    uint32_t valid;
+
+    /**
+     * Items sampled for this snapshot. Valid items not included here could
+     * not be sampled in time, as the device was busy, and hold the value from
+     * an earlier snapshot.
+     */
+    uint32_t updated;
+
+    float bus_voltage;      /**< Bus voltage, in volts */
+    float current;          /**< Current, in amps */
+    float power;            /**< Power, in watts */
+    float rfic_temperature; /**< RFIC temperature, in degrees Celsius */
+
+    int32_t pre_rssi[2]; /**< Preamble RSSI of each RX channel, in dB */
+    int32_t sym_rssi[2]; /**< Symbol RSSI of each RX channel, in dB */
+
+    uint16_t vctcxo_trim; /**< VCTCXO trim DAC value */
+
+    /**
+     * Total number of times the telemetry thread has deferred a read
+     * because another control operation was in progress
+     */
+    uint64_t deferred;
+};
+
+/**
+ * Start sampling telemetry in the background. If telemetry is already
+ * enabled, it is restarted with the new configuration and an empty history.
+ *
+ * @param       dev         Device handle
+ * @param[in]   config      Telemetry configuration. NULL may be used to
+ *                          select the defaults.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_enable_telemetry(
+    struct bladerf *dev, const struct bladerf_telemetry_config *config);
+
+/**
+ * Stop sampling telemetry and discard the history. This is a no-op if
+ * telemetry is not enabled. Telemetry is disabled automatically by
+ * bladerf_close().
+ *
+ * @param       dev         Device handle
+ */
+API_EXPORT
+void CALL_CONV bladerf_disable_telemetry(struct bladerf *dev);
+
+/**
+ * Retrieve the most recent telemetry snapshot. This does not access the
+ * device or block.
+ *
+ * @param       dev         Device handle
+ * @param[out]  snapshot    Updated with the most recent snapshot. Its
+ *                          `sequence` is 0 if none has been taken yet.
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if telemetry is not enabled
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_telemetry(struct bladerf *dev,
+                                    struct bladerf_telemetry *snapshot);
+
+/**
+ * Retrieve the most recent telemetry snapshots from the history. This does
+ * not access the device or block.
+ *
+ * @param       dev         Device handle
+ * @param[out]  snapshots   Updated with up to `count` snapshots, oldest
+ *                          first
+ * @param[in]   count       Capacity of `snapshots`
+ * @param[out]  actual      Number of snapshots retrieved
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if telemetry is not enabled
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_telemetry_history(struct bladerf *dev,
+                                            struct bladerf_telemetry *snapshots,
+                                            unsigned int count,
+                                            unsigned int *actual);
+
+/** @} (End of FN_TELEMETRY) */
+
+/**
+ * @defgroup FN_ASYNC_CTRL Asynchronous control
+ *
+ * Functions such as bladerf_set_frequency() block the caller for all of the
+ * device round trips they entail. This makes it difficult to overlap the
+ * configuration of several devices from a single thread, such as an event
+ * loop.
+ *
+ * Alternatively, control operations may be submitted to a per-device
+ * control thread, which is started upon the first submission and stopped by
+ * bladerf_close(). Each submission returns a future, which may be polled or
+ * waited upon, and may also invoke a completion callback. Operations on
+ * different devices proceed in parallel.
+ *
+ * Operations submitted to a device are performed in the order they were
+ * submitted. Those that accumulate while the control thread is busy are
+ * taken as a batch, in which consecutive operations that apply the same value
+ * to the same setting (i.e., the same operation on the same channel) are only
+ * performed once, and all complete with its status. Every other operation is
+ * performed, and completes with its own status.
+ *
+ * Operations are serialized with the device's other control functions, which
+ * remain usable while asynchronous operations are pending.
+ *
+ * These functions are thread-safe.
+ *
+ * @{
+ */
+
+/**
+ * Asynchronous control operations
+ */
+typedef enum {
+    /** bladerf_set_frequency(), with `value.frequency` */
+    BLADERF_CTRL_SET_FREQUENCY,
+
+    /** bladerf_set_gain(), with `value.gain` */
+    BLADERF_CTRL_SET_GAIN,
+
+    /** bladerf_set_gain_mode(), with `value.gain_mode` */
+    BLADERF_CTRL_SET_GAIN_MODE,
+
+    /**
+     * bladerf_set_sample_rate(), with `value.sample_rate`. The future's
+     * `actual` value is the sample rate actually set.
+     */
+    BLADERF_CTRL_SET_SAMPLE_RATE,
+
+    /**
+     * bladerf_set_bandwidth(), with `value.bandwidth`. The future's `actual`
+     * value is the bandwidth actually set.
+     */
+    BLADERF_CTRL_SET_BANDWIDTH,
+
+    /**
+     * bladerf_apply_profile(), with `value.profile`. The `channel` is
+     * ignored, and these operations are always performed.
+     */
+    BLADERF_CTRL_APPLY_PROFILE,
+} bladerf_ctrl_op;
+
+/**
+ * Asynchronous control request
+ */
+struct bladerf_ctrl_request {
+    bladerf_ctrl_op op;      /**< Operation to perform */
+    bladerf_channel channel; /**< Channel to operate upon */
+
+    /** Value to apply, according to `op` */
+    union {
+        bladerf_frequency frequency;     /**< Frequency, in Hz */
+        bladerf_gain gain;               /**< Gain, in dB */
+        bladerf_gain_mode gain_mode;     /**< Gain mode */
+        bladerf_sample_rate sample_rate; /**< Sample rate, in samples/s */
+        bladerf_bandwidth bandwidth;     /**< Bandwidth, in Hz */
+        struct bladerf_profile profile;  /**< Configuration profile */
+    } value;
+};
+
+/**
+ * Handle for the result of an asynchronous control operation
+ */
+struct bladerf_future;
+
+/**
+ * Completion callback for an asynchronous control operation.
+ *
+ * This is called from the device's control thread, which does not process
+ * further operations until it returns. It may submit further operations,
+ * but must not call bladerf_close() on the device.
+ *
+ * The future does not become ready until the callback has returned.
+ *
+ * @param       dev         Device handle
+ * @param       future      Future of the completed operation, or NULL if
+ *                          none was requested
+ * @param[in]   status      0 on success, value from \ref RETCODES list on
+ *                          failure
+ * @param       user_data   User data provided upon submission
+ */
+typedef void (*bladerf_ctrl_cb)(struct bladerf *dev,
+                                struct bladerf_future *future,
+                                int status,
+                                void *user_data);
+
+/**
+ * Submit a control operation to the device's control thread. This does not
+ * wait for the device.
+ *
+ * @param       dev         Device handle
+ * @param[in]   request     Operation to perform. This is copied.
+ * @param[in]   cb          Completion callback. May be NULL.
+ * @param       user_data   Passed to `cb`
+ * @param[out]  future      Updated with a future for the operation, which
+ *                          must be released via bladerf_future_free(). May be
+ *                          NULL if the caller only requires the callback.
+ *
+ * @return 0 on success, value from \ref RETCODES list on failure
+ */
+API_EXPORT
+int CALL_CONV bladerf_submit_ctrl(struct bladerf *dev,
+                                  const struct bladerf_ctrl_request *request,
+                                  bladerf_ctrl_cb cb,
+                                  void *user_data,
+                                  struct bladerf_future **future);
+
+/**
+ * Wait for an asynchronous control operation to complete
+ *
+ * @param       future      Future to wait upon
+ * @param[in]   timeout_ms  Timeout, in milliseconds. 0 waits indefinitely.
+ * @param[out]  actual      If non-NULL, updated with the value actually set
+ *                          by ::BLADERF_CTRL_SET_SAMPLE_RATE and
+ *                          ::BLADERF_CTRL_SET_BANDWIDTH operations, or 0 for
+ *                          other operations.
+ *
+ * @return The operation's status: 0 on success, value from \ref RETCODES
+ *         list on failure. ::BLADERF_ERR_TIMEOUT is returned if the operation
+ *         has not completed within `timeout_ms`.
+ */
+API_EXPORT
+int CALL_CONV bladerf_future_wait(struct bladerf_future *future,
+                                  unsigned int timeout_ms,
+                                  uint64_t *actual);
+
+/**
+ * Check whether an asynchronous control operation has completed, without
+ * blocking
+ *
+ * @param       future      Future to check
+ *
+ * @return true if bladerf_future_wait() would return without blocking
+ */
+API_EXPORT
+bool CALL_CONV bladerf_future_ready(struct bladerf_future *future);
+
+/**
+ * Release a future. If its operation is still pending, the operation is
+ * still performed, and its callback invoked.
+ *
+ * Futures remain valid after the device is closed, and must still be
+ * released.
+ *
+ * @param       future      Future to release. NULL is ignored.
+ */
+API_EXPORT
+void CALL_CONV bladerf_future_free(struct bladerf_future *future);
+
+/** @} (End of FN_ASYNC_CTRL) */
+
 /**
  * @defgroup FN_PROG  Firmware and FPGA
  *
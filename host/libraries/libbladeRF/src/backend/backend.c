@@ -145,6 +145,9 @@ const char *backend2str(bladerf_backend backend)
         case BLADERF_BACKEND_CYPRESS:
             return BACKEND_STR_CYPRESS;
 
+        case BLADERF_BACKEND_REPLAY:
+            return BACKEND_STR_REPLAY;
+
         default:
             return BACKEND_STR_ANY;
     }
@@ -160,6 +163,8 @@ int str2backend(const char *str, bladerf_backend *backend)
         *backend = BLADERF_BACKEND_LINUX;
     } else if (!strcasecmp(BACKEND_STR_CYPRESS, str)) {
         *backend = BLADERF_BACKEND_CYPRESS;
+    } else if (!strcasecmp(BACKEND_STR_REPLAY, str)) {
+        *backend = BLADERF_BACKEND_REPLAY;
     } else if (!strcasecmp(BACKEND_STR_ANY, str)) {
         *backend = BLADERF_BACKEND_ANY;
     } else {
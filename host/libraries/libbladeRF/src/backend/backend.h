@@ -37,6 +37,7 @@
 #define BACKEND_STR_LIBUSB "libusb"
 #define BACKEND_STR_LINUX "linux"
 #define BACKEND_STR_CYPRESS "cypress"
+#define BACKEND_STR_REPLAY "replay"
 
 /**
  * Specifies what to probe for
@@ -219,6 +220,10 @@ struct backend_fns {
     int (*adf400x_write)(struct bladerf *dev, uint8_t addr, uint32_t data);
     int (*adf400x_read)(struct bladerf *dev, uint8_t addr, uint32_t *data);
 
+    /* RX decimation control register accessors */
+    int (*rx_decim_write)(struct bladerf *dev, uint32_t value);
+    int (*rx_decim_read)(struct bladerf *dev, uint32_t *value);
+
     /* VCTCXO accessors */
     int (*vctcxo_dac_write)(struct bladerf *dev, uint8_t addr, uint16_t value);
     int (*vctcxo_dac_read)(struct bladerf *dev, uint8_t addr, uint16_t *value);
@@ -257,7 +262,8 @@ struct backend_fns {
                   uint8_t freqsel,
                   uint8_t vcocap,
                   bool low_band,
-                  bool quick_tune);
+                  bool quick_tune,
+                  uint8_t id);
 
     /* Schedule a frequency retune2 operation */
     int (*retune2)(struct bladerf *dev,
@@ -266,7 +272,8 @@ struct backend_fns {
                    uint16_t nios_profile,
                    uint8_t rffe_profile,
                    uint8_t port,
-                   uint8_t spdt);
+                   uint8_t spdt,
+                   uint8_t id);
 
     /* Load firmware from FX3 bootloader */
     int (*load_fw_from_bootloader)(bladerf_backend backend,
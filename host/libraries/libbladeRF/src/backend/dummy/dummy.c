@@ -322,6 +322,16 @@ static int dummy_adf400x_read(struct bladerf *dev, uint8_t addr, uint32_t *data)
     return 0;
 }
 
+static int dummy_rx_decim_write(struct bladerf *dev, uint32_t value)
+{
+    return 0;
+}
+
+static int dummy_rx_decim_read(struct bladerf *dev, uint32_t *value)
+{
+    return 0;
+}
+
 static int dummy_vctcxo_dac_write(struct bladerf *dev,
                                   uint8_t addr,
                                   uint16_t value)
@@ -405,7 +415,8 @@ static int dummy_retune(struct bladerf *dev,
                         uint8_t freqsel,
                         uint8_t vcocap,
                         bool low_band,
-                        bool quick_tune)
+                        bool quick_tune,
+                        uint8_t id)
 {
     return 0;
 }
@@ -516,6 +527,9 @@ const struct backend_fns backend_fns_dummy = {
     FIELD_INIT(.adf400x_write, dummy_adf400x_write),
     FIELD_INIT(.adf400x_read, dummy_adf400x_read),
 
+    FIELD_INIT(.rx_decim_write, dummy_rx_decim_write),
+    FIELD_INIT(.rx_decim_read, dummy_rx_decim_read),
+
     FIELD_INIT(.vctcxo_dac_write, dummy_vctcxo_dac_write),
     FIELD_INIT(.vctcxo_dac_read, dummy_vctcxo_dac_read),
 
@@ -0,0 +1,1159 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "host_config.h"
+
+#if BLADERF_OS_WINDOWS || BLADERF_OS_OSX
+#include "clock_gettime.h"
+#else
+#include <time.h>
+#endif
+
+#if !BLADERF_OS_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Pacing must not follow changes to the wall clock. The clock_gettime()
+ * shims for Windows and older OS X only provide CLOCK_REALTIME. */
+#ifdef CLOCK_MONOTONIC
+#define PACE_CLOCK CLOCK_MONOTONIC
+#else
+#define PACE_CLOCK CLOCK_REALTIME
+#endif
+
+#include "log.h"
+#include "rel_assert.h"
+
+#include "board/board.h"
+#include "backend/replay/replay.h"
+#include "helpers/timeout.h"
+#include "streaming/async.h"
+#include "streaming/metadata.h"
+#include "streaming/packing.h"
+
+#define REPLAY_MSG_SIZE_DEFAULT 2048
+
+/* How long an idle stream waits for a buffer submission before checking
+ * whether it has been shut down */
+#define REPLAY_IDLE_WAIT_MS 100
+
+typedef enum {
+    REPLAY_FORMAT_SC16Q11,
+    REPLAY_FORMAT_META,
+} replay_format;
+
+typedef enum {
+    REPLAY_RATE_MAX,
+    REPLAY_RATE_REALTIME,
+    REPLAY_RATE_FIXED,
+} replay_rate_mode;
+
+struct replay_config {
+    char *file;
+    char *tx_file;
+    replay_format format;
+    size_t msg_size;
+    replay_rate_mode rate_mode;
+    uint64_t rate;
+    bool loop;
+    bool use_mmap;
+};
+
+struct replay_data {
+    struct replay_config cfg;
+
+    /* Recording, accessed through either stdio or a memory mapping */
+    FILE *file;
+    const uint8_t *map;
+    size_t map_len;
+    size_t map_pos;
+    bool wrapped;
+
+    /* Capture of TX buffers, if requested */
+    FILE *tx_capture;
+
+    /* "meta" recordings: the first timestamp in the recording, the offset
+     * applied to its timestamps, which grows each time it loops, and the
+     * (rewritten) timestamp that follows the last message read */
+    bool have_first_ts;
+    uint64_t first_ts;
+    uint64_t ts_offset;
+    uint64_t next_ts;
+
+    /* A message from a "meta" recording that is being delivered to a
+     * stream without metadata */
+    uint8_t *msg;
+    size_t msg_pos;
+    size_t msg_len;
+
+    /* Pacing rate for each direction, in samples per second. 0 streams as
+     * fast as possible. */
+    uint64_t rate[2];
+
+    MUTEX lock;
+    uint64_t timestamp[2]; /* Timestamp following the last sample streamed.
+                            * Protected by `lock`. */
+
+    /* While TX is enabled and paced, its timestamp counter runs on its own,
+     * as on a device, from `tx_clock_ts` at `tx_clock_start`. Protected by
+     * `lock`. */
+    bool tx_clock_running;
+    struct timespec tx_clock_start;
+    uint64_t tx_clock_ts;
+
+    /* Emulated Si5338 register file. Accessed with dev->lock held. */
+    uint8_t si5338[256];
+};
+
+struct replay_stream_data {
+    /* Submitted buffers, in the order they are to be completed */
+    void **queue;
+    size_t num_transfers;
+    size_t head;
+    size_t count;
+
+    size_t num_avail;       /* Transfers available for submission */
+    bool at_end;            /* The recording has been exhausted */
+    struct timespec at_end_deadline;
+    pthread_cond_t submitted;
+
+    /* Reference point for pacing */
+    bool started;
+    struct timespec start_time;
+    uint64_t start_ts;
+};
+
+static inline struct replay_data *replay_backend(struct bladerf *dev)
+{
+    return dev->backend_data;
+}
+
+/******************************************************************************/
+/* Configuration */
+/******************************************************************************/
+
+static int parse_bool(const char *value, bool *out)
+{
+    if (!strcmp(value, "1") || !strcasecmp(value, "true") ||
+        !strcasecmp(value, "yes")) {
+        *out = true;
+    } else if (!strcmp(value, "0") || !strcasecmp(value, "false") ||
+               !strcasecmp(value, "no")) {
+        *out = false;
+    } else {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return 0;
+}
+
+static int parse_env(struct replay_config *cfg, const char *str)
+{
+    char *copy, *token, *saveptr = NULL;
+    int status = 0;
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->format   = REPLAY_FORMAT_SC16Q11;
+    cfg->msg_size = REPLAY_MSG_SIZE_DEFAULT;
+
+    copy = strdup(str);
+    if (copy == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    for (token = strtok_r(copy, ",", &saveptr); token != NULL && status == 0;
+         token = strtok_r(NULL, ",", &saveptr)) {
+
+        char *value = strchr(token, '=');
+
+        if (value == NULL) {
+            status = BLADERF_ERR_INVAL;
+            log_warning("Invalid %s entry: %s\n", REPLAY_ENV_VAR, token);
+            break;
+        }
+
+        *value++ = '\0';
+
+        if (!strcmp(token, "file")) {
+            free(cfg->file);
+            cfg->file = strdup(value);
+            if (cfg->file == NULL) {
+                status = BLADERF_ERR_MEM;
+            }
+        } else if (!strcmp(token, "tx_file")) {
+            free(cfg->tx_file);
+            cfg->tx_file = strdup(value);
+            if (cfg->tx_file == NULL) {
+                status = BLADERF_ERR_MEM;
+            }
+        } else if (!strcmp(token, "format")) {
+            if (!strcasecmp(value, "sc16q11") || !strcasecmp(value, "bin")) {
+                cfg->format = REPLAY_FORMAT_SC16Q11;
+            } else if (!strcasecmp(value, "meta")) {
+                cfg->format = REPLAY_FORMAT_META;
+            } else {
+                status = BLADERF_ERR_INVAL;
+            }
+        } else if (!strcmp(token, "msg_size")) {
+            cfg->msg_size = (size_t)strtoul(value, NULL, 0);
+            if (cfg->msg_size != 1024 && cfg->msg_size != 2048) {
+                status = BLADERF_ERR_INVAL;
+            }
+        } else if (!strcmp(token, "rate")) {
+            if (!strcasecmp(value, "max")) {
+                cfg->rate_mode = REPLAY_RATE_MAX;
+            } else if (!strcasecmp(value, "realtime")) {
+                cfg->rate_mode = REPLAY_RATE_REALTIME;
+            } else {
+                cfg->rate_mode = REPLAY_RATE_FIXED;
+                cfg->rate      = strtoull(value, NULL, 0);
+                if (cfg->rate == 0) {
+                    status = BLADERF_ERR_INVAL;
+                }
+            }
+        } else if (!strcmp(token, "loop")) {
+            status = parse_bool(value, &cfg->loop);
+        } else if (!strcmp(token, "mmap")) {
+            status = parse_bool(value, &cfg->use_mmap);
+        } else {
+            status = BLADERF_ERR_INVAL;
+        }
+
+        if (status == BLADERF_ERR_INVAL) {
+            log_warning("Invalid %s entry: %s=%s\n", REPLAY_ENV_VAR, token,
+                        value);
+        }
+    }
+
+    free(copy);
+
+    if (status == 0 && cfg->file == NULL) {
+        log_warning("%s does not specify a file.\n", REPLAY_ENV_VAR);
+        status = BLADERF_ERR_INVAL;
+    }
+
+    if (status != 0) {
+        free(cfg->file);
+        free(cfg->tx_file);
+        cfg->file    = NULL;
+        cfg->tx_file = NULL;
+    }
+
+    return status;
+}
+
+/******************************************************************************/
+/* Recording access */
+/******************************************************************************/
+
+static int open_recording(struct replay_data *d)
+{
+    if (d->cfg.use_mmap) {
+#if BLADERF_OS_WINDOWS
+        log_warning("mmap is not supported on this platform. "
+                    "Falling back to stdio.\n");
+#else
+        struct stat st;
+        void *map;
+        int fd;
+
+        fd = open(d->cfg.file, O_RDONLY);
+        if (fd < 0) {
+            log_debug("Failed to open %s: %s\n", d->cfg.file, strerror(errno));
+            return BLADERF_ERR_NO_FILE;
+        }
+
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            log_debug("Failed to stat %s, or it is empty\n", d->cfg.file);
+            close(fd);
+            return BLADERF_ERR_IO;
+        }
+
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (map == MAP_FAILED) {
+            log_debug("Failed to map %s: %s\n", d->cfg.file, strerror(errno));
+            return BLADERF_ERR_IO;
+        }
+
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+        d->map     = map;
+        d->map_len = (size_t)st.st_size;
+        return 0;
+#endif
+    }
+
+    d->file = fopen(d->cfg.file, "rb");
+    if (d->file == NULL) {
+        log_debug("Failed to open %s: %s\n", d->cfg.file, strerror(errno));
+        return BLADERF_ERR_NO_FILE;
+    }
+
+    return 0;
+}
+
+static void close_recording(struct replay_data *d)
+{
+#if !BLADERF_OS_WINDOWS
+    if (d->map != NULL) {
+        munmap((void *)d->map, d->map_len);
+        d->map = NULL;
+    }
+#endif
+
+    if (d->file != NULL) {
+        fclose(d->file);
+        d->file = NULL;
+    }
+}
+
+static size_t read_some(struct replay_data *d, uint8_t *dst, size_t n)
+{
+    if (d->map != NULL) {
+        const size_t avail = d->map_len - d->map_pos;
+
+        if (n > avail) {
+            n = avail;
+        }
+
+        memcpy(dst, &d->map[d->map_pos], n);
+        d->map_pos += n;
+        return n;
+    }
+
+    return fread(dst, 1, n, d->file);
+}
+
+/* Read `n` bytes from the recording, in multiples of `unit` bytes. A partial
+ * unit at the end of the recording is discarded.
+ *
+ * Returns 0 on success, 1 if the end of the recording was reached and it is
+ * not being looped, or a BLADERF_ERR_* value on failure. */
+static int read_recording(struct replay_data *d,
+                          uint8_t *dst,
+                          size_t n,
+                          size_t unit)
+{
+    bool rewound = false;
+
+    while (n > 0) {
+        size_t got = read_some(d, dst, n);
+
+        got -= got % unit;
+        dst += got;
+        n -= got;
+
+        if (got > 0) {
+            rewound = false;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        if (d->file != NULL && ferror(d->file)) {
+            log_debug("Failed to read %s\n", d->cfg.file);
+            return BLADERF_ERR_IO;
+        }
+
+        /* Nothing more, or the recording is shorter than one unit */
+        if (!d->cfg.loop || rewound) {
+            return 1;
+        }
+
+        if (d->map != NULL) {
+            d->map_pos = 0;
+        } else if (fseek(d->file, 0, SEEK_SET) != 0) {
+            return BLADERF_ERR_IO;
+        }
+
+        rewound    = true;
+        d->wrapped = true;
+    }
+
+    return 0;
+}
+
+/* Read the next message of a "meta" recording into `msg`, and rewrite its
+ * timestamp to continue across loops of the recording. The first message of
+ * each loop follows on directly from the last message of the previous one. */
+static int read_message(struct replay_data *d,
+                        uint8_t *msg,
+                        size_t sample_size,
+                        size_t channels)
+{
+    const size_t msg_size = d->cfg.msg_size;
+    const size_t payload  = msg_size - METADATA_HEADER_SIZE;
+    uint64_t ts;
+    int status;
+
+    status = read_recording(d, msg, msg_size, msg_size);
+    if (status != 0) {
+        return status;
+    }
+
+    ts = metadata_get_timestamp(msg);
+
+    if (!d->have_first_ts) {
+        d->first_ts      = ts;
+        d->have_first_ts = true;
+    }
+
+    if (d->wrapped) {
+        d->ts_offset = d->next_ts - d->first_ts;
+        d->wrapped   = false;
+    }
+
+    ts += d->ts_offset;
+    d->next_ts = ts + payload / sample_size / channels;
+
+    metadata_set(msg, ts, metadata_get_flags(msg));
+    return 0;
+}
+
+/******************************************************************************/
+/* Sample streams */
+/******************************************************************************/
+
+static inline size_t stream_channels(struct bladerf_stream *stream)
+{
+    return (stream->layout == BLADERF_RX_X2 ||
+            stream->layout == BLADERF_TX_X2) ? 2 : 1;
+}
+
+/* Recordings and captures hold samples in the stream's wire format */
+static inline size_t stream_sample_size(struct bladerf_stream *stream)
+{
+    return wire_format_bytes_per_sample(stream->wire_format);
+}
+
+/* Fill an RX buffer from the recording. On success, `ts_end` is updated to
+ * the timestamp that follows the buffer's last sample. */
+static int fill_rx(struct replay_data *d,
+                   struct bladerf_stream *stream,
+                   uint8_t *buf,
+                   uint64_t *ts_end)
+{
+    const size_t bytes       = async_stream_buf_bytes(stream);
+    const size_t channels    = stream_channels(stream);
+    const size_t sample_size = stream_sample_size(stream);
+    const size_t msg_size    = d->cfg.msg_size;
+    const size_t payload     = msg_size - METADATA_HEADER_SIZE;
+    uint64_t ts              = *ts_end;
+    size_t off, n;
+    int status = 0;
+
+    if (stream->format == BLADERF_FORMAT_SC16_Q11_META) {
+        for (off = 0; off < bytes && status == 0; off += msg_size) {
+            uint8_t *msg = &buf[off];
+
+            if (d->cfg.format == REPLAY_FORMAT_META) {
+                status = read_message(d, msg, sample_size, channels);
+                if (status == 0) {
+                    ts = metadata_get_timestamp(msg);
+                }
+            } else {
+                status = read_recording(d, &msg[METADATA_HEADER_SIZE],
+                                        payload, sample_size);
+                metadata_set(msg, ts, 0);
+            }
+
+            ts += payload / sample_size / channels;
+        }
+    } else if (d->cfg.format == REPLAY_FORMAT_SC16Q11) {
+        status = read_recording(d, buf, bytes, sample_size);
+        ts += bytes / sample_size / channels;
+    } else {
+        /* Strip the headers from a "meta" recording */
+        for (off = 0; off < bytes && status == 0; off += n) {
+            if (d->msg_pos == d->msg_len) {
+                status = read_message(d, d->msg, sample_size, channels);
+                if (status != 0) {
+                    break;
+                }
+
+                ts         = metadata_get_timestamp(d->msg);
+                d->msg_pos = METADATA_HEADER_SIZE;
+                d->msg_len = msg_size;
+            }
+
+            n = d->msg_len - d->msg_pos;
+            if (n > bytes - off) {
+                n = bytes - off;
+            }
+
+            memcpy(&buf[off], &d->msg[d->msg_pos], n);
+            d->msg_pos += n;
+            ts += n / sample_size / channels;
+        }
+    }
+
+    if (status == 0) {
+        *ts_end = ts;
+    }
+
+    return status;
+}
+
+/* Consume a TX buffer. The samples are written to the TX capture, if there
+ * is one, and otherwise discarded. The timestamps of buffers with metadata
+ * are honored for pacing and for get_timestamp(). */
+static int consume_tx(struct replay_data *d,
+                      struct bladerf_stream *stream,
+                      const uint8_t *buf,
+                      uint64_t *ts_end)
+{
+    const size_t bytes       = async_stream_buf_bytes(stream);
+    const size_t channels    = stream_channels(stream);
+    const size_t sample_size = stream_sample_size(stream);
+    const size_t msg_size    = d->cfg.msg_size;
+    const size_t payload     = msg_size - METADATA_HEADER_SIZE;
+    uint64_t ts              = *ts_end;
+    size_t off;
+
+    if (stream->format == BLADERF_FORMAT_SC16_Q11_META) {
+        for (off = 0; off < bytes; off += msg_size) {
+            const uint64_t msg_ts = metadata_get_timestamp(&buf[off]);
+
+            /* A burst scheduled in the future leaves a gap, as on a device.
+             * Timestamps in the past are transmitted immediately. */
+            if (msg_ts > ts) {
+                ts = msg_ts;
+            }
+
+            ts += payload / sample_size / channels;
+        }
+    } else {
+        ts += bytes / sample_size / channels;
+    }
+
+    if (d->tx_capture != NULL && fwrite(buf, bytes, 1, d->tx_capture) != 1) {
+        log_debug("Failed to write %s\n", d->cfg.tx_file);
+        return BLADERF_ERR_IO;
+    }
+
+    *ts_end = ts;
+    return 0;
+}
+
+static uint64_t tx_clock_now(struct replay_data *d)
+{
+    struct timespec now;
+    double elapsed;
+
+    clock_gettime(PACE_CLOCK, &now);
+    elapsed = (double)(now.tv_sec - d->tx_clock_start.tv_sec) +
+              (double)(now.tv_nsec - d->tx_clock_start.tv_nsec) * 1e-9;
+
+    return d->tx_clock_ts + (uint64_t)(elapsed * (double)d->rate[BLADERF_TX]);
+}
+
+/* Sleep until the time at which a device running at `rate` would have
+ * streamed up to `ts_end` */
+static void pace(struct replay_stream_data *sd,
+                 uint64_t rate,
+                 uint64_t ts_begin,
+                 uint64_t ts_end)
+{
+    struct timespec now;
+    double target, elapsed;
+
+    if (rate == 0) {
+        return;
+    }
+
+    if (!sd->started) {
+        clock_gettime(PACE_CLOCK, &sd->start_time);
+        sd->start_ts = ts_begin;
+        sd->started  = true;
+    }
+
+    target = (double)(ts_end - sd->start_ts) / (double)rate;
+
+    clock_gettime(PACE_CLOCK, &now);
+    elapsed = (double)(now.tv_sec - sd->start_time.tv_sec) +
+              (double)(now.tv_nsec - sd->start_time.tv_nsec) * 1e-9;
+
+    /* usleep() need not support intervals of a second or more */
+    while (target > elapsed) {
+        const double remaining_us = (target - elapsed) * 1e6;
+        const unsigned int us =
+            remaining_us > 500000.0 ? 500000 : (unsigned int)remaining_us;
+
+        if (us == 0) {
+            break;
+        }
+
+        usleep(us);
+        elapsed += us * 1e-6;
+    }
+}
+
+static int replay_enable_module(struct bladerf *dev,
+                                bladerf_direction dir,
+                                bool enable)
+{
+    struct replay_data *d = replay_backend(dev);
+    bladerf_sample_rate rate;
+    int status;
+
+    if (!enable) {
+        if (dir == BLADERF_TX) {
+            MUTEX_LOCK(&d->lock);
+            if (d->tx_clock_running) {
+                const uint64_t now = tx_clock_now(d);
+
+                if (now > d->timestamp[BLADERF_TX]) {
+                    d->timestamp[BLADERF_TX] = now;
+                }
+
+                d->tx_clock_running = false;
+            }
+            MUTEX_UNLOCK(&d->lock);
+        }
+
+        return 0;
+    }
+
+    switch (d->cfg.rate_mode) {
+        case REPLAY_RATE_MAX:
+            d->rate[dir] = 0;
+            break;
+
+        case REPLAY_RATE_FIXED:
+            d->rate[dir] = d->cfg.rate;
+            break;
+
+        case REPLAY_RATE_REALTIME:
+            status = dev->board->get_sample_rate(
+                dev,
+                (dir == BLADERF_RX) ? BLADERF_CHANNEL_RX(0)
+                                    : BLADERF_CHANNEL_TX(0),
+                &rate);
+            if (status != 0) {
+                return status;
+            }
+
+            d->rate[dir] = rate;
+            break;
+    }
+
+    if (dir == BLADERF_TX && d->rate[dir] != 0) {
+        MUTEX_LOCK(&d->lock);
+        if (!d->tx_clock_running) {
+            clock_gettime(PACE_CLOCK, &d->tx_clock_start);
+            d->tx_clock_ts      = d->timestamp[BLADERF_TX];
+            d->tx_clock_running = true;
+        }
+        MUTEX_UNLOCK(&d->lock);
+    }
+
+    return 0;
+}
+
+static int replay_get_timestamp(struct bladerf *dev,
+                                bladerf_direction dir,
+                                uint64_t *value)
+{
+    struct replay_data *d = replay_backend(dev);
+
+    MUTEX_LOCK(&d->lock);
+    *value = d->timestamp[dir];
+
+    if (dir == BLADERF_TX && d->tx_clock_running) {
+        const uint64_t now = tx_clock_now(d);
+
+        if (now > *value) {
+            *value = now;
+        }
+    }
+    MUTEX_UNLOCK(&d->lock);
+
+    return 0;
+}
+
+static int replay_init_stream(struct bladerf_stream *stream,
+                              size_t num_transfers)
+{
+    struct replay_stream_data *sd;
+
+    sd = calloc(1, sizeof(*sd));
+    if (sd == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    sd->queue = calloc(num_transfers, sizeof(sd->queue[0]));
+    if (sd->queue == NULL) {
+        free(sd);
+        return BLADERF_ERR_MEM;
+    }
+
+    sd->num_transfers = num_transfers;
+    sd->num_avail     = num_transfers;
+    pthread_cond_init(&sd->submitted, NULL);
+
+    stream->backend_data = sd;
+    return 0;
+}
+
+/* Queue a buffer for completion. Must be called with stream->lock held, and
+ * a transfer available. */
+static void submit_transfer(struct bladerf_stream *stream, void *buffer)
+{
+    struct replay_stream_data *sd = stream->backend_data;
+
+    assert(sd->num_avail > 0);
+
+    sd->queue[(sd->head + sd->count) % sd->num_transfers] = buffer;
+    sd->count++;
+    sd->num_avail--;
+
+    pthread_cond_signal(&sd->submitted);
+}
+
+static int replay_stream(struct bladerf_stream *stream,
+                         bladerf_channel_layout layout)
+{
+    struct bladerf *dev            = stream->dev;
+    struct replay_data *d          = replay_backend(dev);
+    struct replay_stream_data *sd  = stream->backend_data;
+    const bladerf_direction dir    = layout & BLADERF_DIRECTION_MASK;
+    struct bladerf_metadata metadata;
+    struct timespec timeout_abs;
+    void *buffer;
+    size_t i;
+    int status = 0;
+
+    memset(&metadata, 0, sizeof(metadata));
+
+    /* A running TX clock sets the pace, so that buffers are consumed when a
+     * device would transmit them */
+    MUTEX_LOCK(&d->lock);
+    if (dir == BLADERF_TX && d->tx_clock_running) {
+        sd->start_time = d->tx_clock_start;
+        sd->start_ts   = d->tx_clock_ts;
+        sd->started    = true;
+    }
+    MUTEX_UNLOCK(&d->lock);
+
+    MUTEX_LOCK(&stream->lock);
+
+    /* Set up initial set of buffers */
+    for (i = 0; i < sd->num_transfers && stream->state == STREAM_RUNNING;
+         i++) {
+        if (dir == BLADERF_TX) {
+            buffer = stream->cb(dev, stream, &metadata, NULL,
+                                stream->samples_per_buffer,
+                                stream->user_data);
+
+            if (buffer == BLADERF_STREAM_SHUTDOWN) {
+                stream->state = STREAM_SHUTTING_DOWN;
+                break;
+            }
+        } else {
+            buffer = stream->buffers[i];
+        }
+
+        if (buffer != BLADERF_STREAM_NO_DATA) {
+            submit_transfer(stream, buffer);
+        }
+    }
+
+    while (stream->state != STREAM_DONE) {
+        uint64_t ts_begin, ts_end;
+
+        /* Nothing is in flight on a device; outstanding transfers are
+         * simply cancelled */
+        if (stream->state == STREAM_SHUTTING_DOWN) {
+            sd->count     = 0;
+            sd->num_avail = sd->num_transfers;
+            stream->state = STREAM_DONE;
+            pthread_cond_broadcast(&stream->can_submit_buffer);
+            break;
+        }
+
+        if (sd->at_end && stream->transfer_timeout != 0) {
+            /* As with a device that has stopped producing samples, the
+             * held transfer times out, and takes the stream down with it */
+            if (pthread_cond_timedwait(&sd->submitted, &stream->lock,
+                                       &sd->at_end_deadline) == ETIMEDOUT) {
+                log_error("Transfer timed out at the end of %s\n",
+                          d->cfg.file);
+                stream->error_code = BLADERF_ERR_TIMEOUT;
+                stream->state      = STREAM_SHUTTING_DOWN;
+            }
+            continue;
+        }
+
+        if (sd->count == 0 || sd->at_end) {
+            status = populate_abs_timeout(&timeout_abs, REPLAY_IDLE_WAIT_MS);
+            if (status != 0) {
+                break;
+            }
+
+            pthread_cond_timedwait(&sd->submitted, &stream->lock,
+                                   &timeout_abs);
+            continue;
+        }
+
+        buffer   = sd->queue[sd->head];
+        sd->head = (sd->head + 1) % sd->num_transfers;
+        sd->count--;
+
+        MUTEX_UNLOCK(&stream->lock);
+
+        ts_begin = ts_end = d->timestamp[dir];
+
+        if (dir == BLADERF_RX) {
+            status = fill_rx(d, stream, buffer, &ts_end);
+        } else {
+            status = consume_tx(d, stream, buffer, &ts_end);
+        }
+
+        if (status == 0) {
+            pace(sd, d->rate[dir], ts_begin, ts_end);
+
+            MUTEX_LOCK(&d->lock);
+            d->timestamp[dir] = ts_end;
+            MUTEX_UNLOCK(&d->lock);
+        }
+
+        MUTEX_LOCK(&stream->lock);
+
+        sd->num_avail++;
+        pthread_cond_signal(&stream->can_submit_buffer);
+
+        if (status == 1) {
+            /* Hold on to the buffer, as a device that stopped producing
+             * samples would */
+            log_info("Reached the end of %s\n", d->cfg.file);
+            sd->num_avail--;
+            sd->at_end = true;
+            status     = populate_abs_timeout(&sd->at_end_deadline,
+                                          stream->transfer_timeout);
+            if (status != 0) {
+                stream->error_code = status;
+                stream->state      = STREAM_SHUTTING_DOWN;
+                status             = 0;
+            }
+            continue;
+        } else if (status < 0) {
+            stream->error_code = status;
+            stream->state      = STREAM_SHUTTING_DOWN;
+            continue;
+        }
+
+        if (stream->state == STREAM_RUNNING) {
+            void *next = stream->cb(dev, stream, &metadata, buffer,
+                                    stream->samples_per_buffer,
+                                    stream->user_data);
+
+            if (next == BLADERF_STREAM_SHUTDOWN) {
+                stream->state = STREAM_SHUTTING_DOWN;
+            } else if (next != BLADERF_STREAM_NO_DATA) {
+                submit_transfer(stream, next);
+            }
+        }
+    }
+
+    MUTEX_UNLOCK(&stream->lock);
+
+    return status;
+}
+
+/* The top-level code will have acquired the stream->lock for us */
+static int replay_submit_stream_buffer(struct bladerf_stream *stream,
+                                       void *buffer,
+                                       unsigned int timeout_ms,
+                                       bool nonblock)
+{
+    struct replay_stream_data *sd = stream->backend_data;
+    struct timespec timeout_abs;
+    int status = 0;
+
+    if (buffer == BLADERF_STREAM_SHUTDOWN) {
+        /* A stream that has already ended, e.g. due to an error, is left
+         * done. Nothing would otherwise complete its shutdown. */
+        if (stream->state != STREAM_DONE) {
+            stream->state = STREAM_SHUTTING_DOWN;
+            pthread_cond_signal(&sd->submitted);
+        }
+        return 0;
+    }
+
+    if (sd->num_avail == 0) {
+        if (nonblock) {
+            log_debug("Non-blocking buffer submission requested, but no "
+                      "transfers are currently available.\n");
+
+            return BLADERF_ERR_WOULD_BLOCK;
+        }
+
+        if (timeout_ms != 0) {
+            status = populate_abs_timeout(&timeout_abs, timeout_ms);
+            if (status != 0) {
+                return BLADERF_ERR_UNEXPECTED;
+            }
+
+            while (sd->num_avail == 0 && status == 0) {
+                status = pthread_cond_timedwait(&stream->can_submit_buffer,
+                                                &stream->lock, &timeout_abs);
+            }
+        } else {
+            while (sd->num_avail == 0 && status == 0) {
+                status = pthread_cond_wait(&stream->can_submit_buffer,
+                                           &stream->lock);
+            }
+        }
+    }
+
+    if (status == ETIMEDOUT) {
+        log_debug("%s: Timed out waiting for a transfer to become available.\n",
+                  __FUNCTION__);
+        return BLADERF_ERR_TIMEOUT;
+    } else if (status != 0) {
+        return BLADERF_ERR_UNEXPECTED;
+    }
+
+    submit_transfer(stream, buffer);
+    return 0;
+}
+
+static void replay_deinit_stream(struct bladerf_stream *stream)
+{
+    struct replay_stream_data *sd = stream->backend_data;
+
+    if (sd != NULL) {
+        pthread_cond_destroy(&sd->submitted);
+        free(sd->queue);
+        free(sd);
+        stream->backend_data = NULL;
+    }
+}
+
+/******************************************************************************/
+/* Open/close */
+/******************************************************************************/
+
+static bool replay_matches(bladerf_backend backend)
+{
+    return backend == BLADERF_BACKEND_REPLAY;
+}
+
+/* Replay devices are only opened explicitly, and never probed */
+static int replay_probe(backend_probe_target probe_target,
+                        struct bladerf_devinfo_list *info_list)
+{
+    return 0;
+}
+
+static void free_replay_data(struct replay_data *d)
+{
+    close_recording(d);
+    if (d->tx_capture != NULL) {
+        fclose(d->tx_capture);
+    }
+    MUTEX_DESTROY(&d->lock);
+    free(d->msg);
+    free(d->cfg.file);
+    free(d->cfg.tx_file);
+    free(d);
+}
+
+static int replay_open(struct bladerf *dev, struct bladerf_devinfo *info)
+{
+    struct replay_data *d;
+    const char *env;
+    int status;
+
+    if (info->backend != BLADERF_BACKEND_REPLAY) {
+        return BLADERF_ERR_NODEV;
+    }
+
+    env = getenv(REPLAY_ENV_VAR);
+    if (env == NULL) {
+        log_warning("The replay backend requires %s to be set.\n",
+                    REPLAY_ENV_VAR);
+        return BLADERF_ERR_NODEV;
+    }
+
+    d = calloc(1, sizeof(*d));
+    if (d == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    MUTEX_INIT(&d->lock);
+
+    status = parse_env(&d->cfg, env);
+    if (status != 0) {
+        goto error;
+    }
+
+    d->msg = malloc(d->cfg.msg_size);
+    if (d->msg == NULL) {
+        status = BLADERF_ERR_MEM;
+        goto error;
+    }
+
+    status = open_recording(d);
+    if (status != 0) {
+        goto error;
+    }
+
+    if (d->cfg.tx_file != NULL) {
+        d->tx_capture = fopen(d->cfg.tx_file, "wb");
+        if (d->tx_capture == NULL) {
+            log_debug("Failed to open %s: %s\n", d->cfg.tx_file,
+                      strerror(errno));
+            status = BLADERF_ERR_IO;
+            goto error;
+        }
+    }
+
+    log_info("Replaying %s per %s=\"%s\"\n", d->cfg.file, REPLAY_ENV_VAR,
+             env);
+
+    memset(&dev->ident, 0, sizeof(dev->ident));
+    dev->ident.backend = BLADERF_BACKEND_REPLAY;
+    strncpy(dev->ident.serial, "replay", BLADERF_SERIAL_LENGTH - 1);
+    strncpy(dev->ident.manufacturer, "Nuand", BLADERF_DESCRIPTION_LENGTH - 1);
+    strncpy(dev->ident.product, "bladeRF replay",
+            BLADERF_DESCRIPTION_LENGTH - 1);
+
+    dev->backend      = &backend_fns_replay;
+    dev->backend_data = d;
+
+    return 0;
+
+error:
+    free_replay_data(d);
+    return status;
+}
+
+static void replay_close(struct bladerf *dev)
+{
+    struct replay_data *d = replay_backend(dev);
+
+    if (d != NULL) {
+        free_replay_data(d);
+        dev->backend_data = NULL;
+    }
+}
+
+static int replay_load_fw_from_bootloader(bladerf_backend backend,
+                                          uint8_t bus,
+                                          uint8_t addr,
+                                          struct fx3_firmware *fw)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+/* There is no USB device to identify. The bladeRF1 and bladeRF2 boards use
+ * this to decide whether they match, so it must fail gracefully. */
+static int replay_get_vid_pid(struct bladerf *dev,
+                              uint16_t *vid,
+                              uint16_t *pid)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_otp(struct bladerf *dev, char *otp)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_write_otp(struct bladerf *dev, char *otp)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_lock_otp(struct bladerf *dev)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_read_fw_log(struct bladerf *dev, logger_entry *e)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_si5338_write(struct bladerf *dev, uint8_t addr, uint8_t data)
+{
+    replay_backend(dev)->si5338[addr] = data;
+    return 0;
+}
+
+static int replay_si5338_read(struct bladerf *dev, uint8_t addr, uint8_t *data)
+{
+    *data = replay_backend(dev)->si5338[addr];
+    return 0;
+}
+
+size_t replay_msg_size(struct bladerf *dev)
+{
+    return replay_backend(dev)->cfg.msg_size;
+}
+
+/* Only the accessors that the replay board, the streaming code and
+ * bladerf.c use are provided, along with the Si5338's, which raw register
+ * access reaches. The other peripheral accessors are reached only through
+ * the bladeRF1 and bladeRF2 boards, which never match this backend. */
+const struct backend_fns backend_fns_replay = {
+    FIELD_INIT(.matches, replay_matches),
+
+    FIELD_INIT(.probe, replay_probe),
+
+    FIELD_INIT(.open, replay_open),
+    FIELD_INIT(.close, replay_close),
+
+    FIELD_INIT(.get_vid_pid, replay_get_vid_pid),
+
+    FIELD_INIT(.get_otp, replay_get_otp),
+    FIELD_INIT(.write_otp, replay_write_otp),
+    FIELD_INIT(.lock_otp, replay_lock_otp),
+
+    FIELD_INIT(.get_timestamp, replay_get_timestamp),
+
+    FIELD_INIT(.si5338_write, replay_si5338_write),
+    FIELD_INIT(.si5338_read, replay_si5338_read),
+
+    FIELD_INIT(.enable_module, replay_enable_module),
+
+    FIELD_INIT(.init_stream, replay_init_stream),
+    FIELD_INIT(.stream, replay_stream),
+    FIELD_INIT(.submit_stream_buffer, replay_submit_stream_buffer),
+    FIELD_INIT(.deinit_stream, replay_deinit_stream),
+
+    FIELD_INIT(.load_fw_from_bootloader, replay_load_fw_from_bootloader),
+
+    FIELD_INIT(.read_fw_log, replay_read_fw_log),
+
+    FIELD_INIT(.name, "replay"),
+};
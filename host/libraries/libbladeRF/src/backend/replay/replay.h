@@ -0,0 +1,89 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Sample file replay backend
+ *
+ * This backend stands in for a device, for testing and benchmarking without
+ * hardware. RX streams are fed from a recording, and TX streams are consumed
+ * and discarded, or captured, in both cases through the normal async/sync
+ * streaming code.
+ * It is paired with the "replay" board (board/replay/replay.c), which simply
+ * stores the radio settings it is given.
+ *
+ * A replay device is opened with the "replay" backend in the device string,
+ * e.g., bladerf_open(&dev, "replay:"). Its configuration is read from the
+ * environment variable below, which contains comma-separated key=value pairs:
+ *
+ *  file=<path>     Recording to play back. Required.
+ *
+ *  format=<fmt>    "sc16q11" (default): interleaved SC16 Q11 samples, as
+ *                  written by bladeRF-cli's "rx config format=bin".
+ *                  "meta": SC16 Q11 messages with 16-byte metadata headers,
+ *                  as they are received from the FPGA. Their timestamps are
+ *                  passed on, so discontinuities are reproduced.
+ *
+ *                  Recordings for a stream using a packed wire format (see
+ *                  bladerf_set_wire_format()) hold samples in that format.
+ *
+ *  msg_size=<n>    Message size of a "meta" recording: 2048 (default) for
+ *                  SuperSpeed, or 1024 for Hi-Speed.
+ *
+ *  rate=<r>        "max" (default) to stream as fast as possible,
+ *                  "realtime" to pace streams at the configured sample rate,
+ *                  or a rate in samples per second.
+ *
+ *  loop=<0|1>      Restart from the beginning of the recording at its end.
+ *                  Otherwise, RX streams stop delivering samples there,
+ *                  and time out as they would with a stalled device.
+ *
+ *  mmap=<0|1>      Map the recording into memory rather than reading it
+ *                  with stdio. Not available on Windows.
+ *
+ *  tx_file=<path>  Write every TX buffer to this file as it is consumed,
+ *                  in the stream's format and wire format, including any
+ *                  metadata headers.
+ *
+ * While TX is enabled and paced (any rate other than "max"), its timestamp
+ * counter runs on its own, as on a device, and TX buffers are consumed when
+ * the counter reaches their timestamps.
+ *
+ * The backend also emulates the register file of a bladeRF1's Si5338, which
+ * bladerf_si5338_read() and bladerf_si5338_write() access. The board keeps
+ * its sample rates there, so that raw register writes disturb them as they
+ * would on a bladeRF1.
+ */
+
+#ifndef BACKEND_REPLAY_H_
+#define BACKEND_REPLAY_H_
+
+#include "backend/backend.h"
+
+#define REPLAY_ENV_VAR "BLADERF_REPLAY"
+
+extern const struct backend_fns backend_fns_replay;
+
+/**
+ * @return Size of the messages that the replay backend uses for streams in
+ *         the BLADERF_FORMAT_SC16_Q11_META format
+ */
+size_t replay_msg_size(struct bladerf *dev);
+
+#endif
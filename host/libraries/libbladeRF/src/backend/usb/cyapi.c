@@ -682,7 +682,7 @@ static int cyapi_stream(void *driver, struct bladerf_stream *stream,
         if (success) {
             next_buffer = stream->cb(stream->dev, stream, &meta,
                                      data->transfers[i].buffer,
-                                     bytes_to_samples(stream->format, len),
+                                     async_stream_bytes_to_samples(stream, len),
                                      stream->user_data);
 
         } else {
@@ -814,6 +814,30 @@ int nios_adf400x_write(struct bladerf *dev, uint8_t addr, uint32_t data)
     return status;
 }
 
+int nios_rx_decim_write(struct bladerf *dev, uint32_t value)
+{
+    int status;
+
+    status = nios_8x32_write(dev, NIOS_PKT_8x32_TARGET_RX_DECIM, 0, value);
+    if (status == 0) {
+        log_verbose("%s: Wrote 0x%08x\n", __FUNCTION__, value);
+    }
+
+    return status;
+}
+
+int nios_rx_decim_read(struct bladerf *dev, uint32_t *value)
+{
+    int status;
+
+    status = nios_8x32_read(dev, NIOS_PKT_8x32_TARGET_RX_DECIM, 0, value);
+    if (status == 0) {
+        log_verbose("%s: Read 0x%08x\n", __FUNCTION__, *value);
+    }
+
+    return status;
+}
+
 int nios_vctcxo_trim_dac_write(struct bladerf *dev, uint8_t addr, uint16_t value)
 {
     return nios_8x16_write(dev, NIOS_PKT_8x16_TARGET_VCTCXO_DAC, addr, value);
@@ -1075,19 +1099,39 @@ int nios_expansion_gpio_dir_write(struct bladerf *dev,
     return status;
 }
 
+/* Accumulate the retune queue status reported in a retune response */
+static void retune_stats_update(struct bladerf *dev, bladerf_channel ch,
+                                uint8_t missed, uint8_t cancelled)
+{
+    const bladerf_direction dir = BLADERF_CHANNEL_IS_TX(ch) ? BLADERF_TX
+                                                            : BLADERF_RX;
+
+    if (missed != 0) {
+        log_debug("%u scheduled %s retune(s) were performed late.\n",
+                  missed, channel2str(ch));
+    }
+
+    dev->retune_stats[dir].missed    += missed;
+    dev->retune_stats[dir].cancelled += cancelled;
+}
+
 int nios_retune(struct bladerf *dev, bladerf_channel ch,
                 uint64_t timestamp, uint16_t nint, uint32_t nfrac,
                 uint8_t freqsel, uint8_t vcocap, bool low_band,
-                bool quick_tune)
+                bool quick_tune, uint8_t id)
 {
     int status;
     uint8_t buf[NIOS_PKT_LEN];
 
     uint8_t resp_flags;
     uint64_t duration;
+    uint8_t missed, cancelled;
 
     if (timestamp == NIOS_PKT_RETUNE_CLEAR_QUEUE) {
         log_verbose("Clearing %s retune queue.\n", channel2str(ch));
+    } else if (timestamp == NIOS_PKT_RETUNE_CANCEL) {
+        log_verbose("Cancelling %s retunes with ID %u.\n",
+                    channel2str(ch), id);
     } else {
         log_verbose("%s: channel=%s timestamp=%"PRIu64" nint=%u nfrac=%u\n\t\t\t\t"
                     "freqsel=0x%02x vcocap=0x%02x low_band=%d quick_tune=%d\n",
@@ -1097,6 +1141,7 @@ int nios_retune(struct bladerf *dev, bladerf_channel ch,
 
     nios_pkt_retune_pack(buf, ch, timestamp,
                          nint, nfrac, freqsel, vcocap, low_band, quick_tune);
+    nios_pkt_retune_set_id(buf, id);
 
     status = nios_access(dev, buf);
     if (status != 0) {
@@ -1104,6 +1149,8 @@ int nios_retune(struct bladerf *dev, bladerf_channel ch,
     }
 
     nios_pkt_retune_resp_unpack(buf, &duration, &vcocap, &resp_flags);
+    nios_pkt_retune_resp_get_status(buf, &missed, &cancelled);
+    retune_stats_update(dev, ch, missed, cancelled);
 
     if (resp_flags & NIOS_PKT_RETUNERESP_FLAG_TSVTUNE_VALID) {
         log_verbose("%s retune operation: vcocap=%u, duration=%"PRIu64"\n",
@@ -1130,16 +1177,20 @@ int nios_retune(struct bladerf *dev, bladerf_channel ch,
 int nios_retune2(struct bladerf *dev, bladerf_channel ch,
                  uint64_t timestamp, uint16_t nios_profile,
                  uint8_t rffe_profile, uint8_t port,
-                 uint8_t spdt)
+                 uint8_t spdt, uint8_t id)
 {
     int status;
     uint8_t buf[NIOS_PKT_LEN];
 
     uint8_t resp_flags;
     uint64_t duration;
+    uint8_t missed, cancelled;
 
     if (timestamp == NIOS_PKT_RETUNE2_CLEAR_QUEUE) {
         log_verbose("Clearing %s retune queue.\n", channel2str(ch));
+    } else if (timestamp == NIOS_PKT_RETUNE2_CANCEL) {
+        log_verbose("Cancelling %s retunes with ID %u.\n",
+                    channel2str(ch), id);
     } else {
         log_verbose("%s: channel=%s timestamp=%"PRIu64" nios_profile=%u "
                     "rffe_profile=%u\n\t\t\t\tport=0x%02x spdt=0x%02x\n",
@@ -1149,6 +1200,7 @@ int nios_retune2(struct bladerf *dev, bladerf_channel ch,
 
     nios_pkt_retune2_pack(buf, ch, timestamp, nios_profile, rffe_profile,
                           port, spdt);
+    nios_pkt_retune2_set_id(buf, id);
 
     status = nios_access(dev, buf);
     if (status != 0) {
@@ -1156,6 +1208,8 @@ int nios_retune2(struct bladerf *dev, bladerf_channel ch,
     }
 
     nios_pkt_retune2_resp_unpack(buf, &duration, &resp_flags);
+    nios_pkt_retune2_resp_get_status(buf, &missed, &cancelled);
+    retune_stats_update(dev, ch, missed, cancelled);
 
     if (resp_flags & NIOS_PKT_RETUNE2_RESP_FLAG_TSVTUNE_VALID) {
         log_verbose("%s retune operation: duration=%"PRIu64"\n",
@@ -292,6 +292,26 @@ int nios_adf400x_write(struct bladerf *dev, uint8_t addr, uint32_t data);
  */
 int nios_adf400x_read(struct bladerf *dev, uint8_t addr, uint32_t *data);
 
+/**
+ * Write the RX decimation control register.
+ *
+ * @param       dev         Device handle
+ * @param[in]   value       Value
+ *
+ * @return 0 on success, BLADERF_ERR_* code on error.
+ */
+int nios_rx_decim_write(struct bladerf *dev, uint32_t value);
+
+/**
+ * Read the RX decimation control register.
+ *
+ * @param       dev         Device handle
+ * @param[out]  value       Value
+ *
+ * @return 0 on success, BLADERF_ERR_* code on error.
+ */
+int nios_rx_decim_read(struct bladerf *dev, uint32_t *value);
+
 /**
  * Write to a VCTCXO trim DAC register.
  *
@@ -482,6 +502,7 @@ int nios_expansion_gpio_dir_write(struct bladerf *dev,
  * @param[in]   low_band    High vs low band selection
  * @param[in]   quick_tune  Denotes quick tune should be used instead of
  *                          tuning algorithm
+ * @param[in]   id          Retune ID, used for cancellation
  *
  * @return BLADERF_ERR_UNSUPPORTED
  */
@@ -493,7 +514,8 @@ int nios_retune(struct bladerf *dev,
                 uint8_t freqsel,
                 uint8_t vcocap,
                 bool low_band,
-                bool quick_tune);
+                bool quick_tune,
+                uint8_t id);
 
 /**
  * Handler for a retune request on bladeRF2 devices. The RFFEs used in these
@@ -517,12 +539,14 @@ int nios_retune(struct bladerf *dev,
  *                           the Nios profile will be loaded.
  * @param[in]   port         RFFE port settings
  * @param[in]   spdt         RF SPDT switch settings
+ * @param[in]   id           Retune ID, used for cancellation
  *
  * @return 0 on success, BLADERF_ERR_* code on error.
  */
 int nios_retune2(struct bladerf *dev, bladerf_channel ch,
                  uint64_t timestamp, uint16_t nios_profile,
-                 uint8_t rffe_profile, uint8_t port, uint8_t spdt);
+                 uint8_t rffe_profile, uint8_t port, uint8_t spdt,
+                 uint8_t id);
 
 /**
  * Read trigger register value
@@ -459,6 +459,18 @@ int nios_legacy_adf400x_write(struct bladerf *dev, uint8_t addr, uint32_t data)
     return BLADERF_ERR_UNSUPPORTED;
 }
 
+int nios_legacy_rx_decim_write(struct bladerf *dev, uint32_t value)
+{
+    log_debug("This operation is not supported by the legacy NIOS packet format\n");
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+int nios_legacy_rx_decim_read(struct bladerf *dev, uint32_t *value)
+{
+    log_debug("This operation is not supported by the legacy NIOS packet format\n");
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
 int nios_legacy_vctcxo_trim_dac_write(struct bladerf *dev, uint8_t addr, uint16_t value)
 {
     int status;
@@ -333,6 +333,26 @@ int nios_legacy_adf400x_write(struct bladerf *dev, uint8_t addr, uint32_t data);
  */
 int nios_legacy_adf400x_read(struct bladerf *dev, uint8_t addr, uint32_t *data);
 
+/**
+ * Write the RX decimation control register.
+ *
+ * @param       dev         Device handle
+ * @param[in]   value       Value
+ *
+ * @return 0 on success, BLADERF_ERR_* code on error.
+ */
+int nios_legacy_rx_decim_write(struct bladerf *dev, uint32_t value);
+
+/**
+ * Read the RX decimation control register.
+ *
+ * @param       dev         Device handle
+ * @param[out]  value       Value
+ *
+ * @return 0 on success, BLADERF_ERR_* code on error.
+ */
+int nios_legacy_rx_decim_read(struct bladerf *dev, uint32_t *value);
+
 /**
  * Write to the VCTCXO trim DAC.
  *
@@ -1269,6 +1269,9 @@ const struct backend_fns backend_fns_usb_legacy = {
     FIELD_INIT(.adf400x_write, nios_legacy_adf400x_write),
     FIELD_INIT(.adf400x_read, nios_legacy_adf400x_read),
 
+    FIELD_INIT(.rx_decim_write, nios_legacy_rx_decim_write),
+    FIELD_INIT(.rx_decim_read, nios_legacy_rx_decim_read),
+
     FIELD_INIT(.vctcxo_dac_write, nios_legacy_vctcxo_trim_dac_write),
     FIELD_INIT(.vctcxo_dac_read, nios_vctcxo_trim_dac_read),
 
@@ -1380,6 +1383,9 @@ const struct backend_fns backend_fns_usb = {
     FIELD_INIT(.adf400x_write, nios_adf400x_write),
     FIELD_INIT(.adf400x_read, nios_adf400x_read),
 
+    FIELD_INIT(.rx_decim_write, nios_rx_decim_write),
+    FIELD_INIT(.rx_decim_read, nios_rx_decim_read),
+
     FIELD_INIT(.vctcxo_dac_write, nios_vctcxo_trim_dac_write),
     FIELD_INIT(.vctcxo_dac_read, nios_vctcxo_trim_dac_read),
 
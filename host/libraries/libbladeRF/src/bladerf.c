@@ -38,6 +38,12 @@
 #include "board/board.h"
 #include "driver/fx3_fw.h"
 #include "streaming/async.h"
+#include "streaming/buffers.h"
+#include "streaming/faults.h"
+#include "streaming/format.h"
+#include "streaming/slots.h"
+#include "streaming/tx_mixer.h"
+#include "streaming/packing.h"
 #include "version.h"
 
 #include "expansion/xb100.h"
@@ -48,6 +54,9 @@
 #include "helpers/configfile.h"
 #include "helpers/file.h"
 #include "helpers/interleave.h"
+#include "helpers/profile.h"
+#include "helpers/telemetry.h"
+#include "helpers/async_ctrl.h"
 
 
 /******************************************************************************/
@@ -150,6 +159,11 @@ int bladerf_get_devinfo(struct bladerf *dev, struct bladerf_devinfo *info)
 void bladerf_close(struct bladerf *dev)
 {
     if (dev) {
+        /* The telemetry and control threads take dev->lock, so they must be
+         * stopped first */
+        async_ctrl_stop(dev);
+        telemetry_disable(dev);
+
         MUTEX_LOCK(&dev->lock);
 
         dev->board->close(dev);
@@ -158,6 +172,8 @@ void bladerf_close(struct bladerf *dev)
             dev->backend->close(dev);
         }
 
+        faults_free(dev);
+
         MUTEX_UNLOCK(&dev->lock);
 
         free(dev);
@@ -495,6 +511,7 @@ int bladerf_set_gain(struct bladerf *dev, bladerf_channel ch, int gain)
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_gain(dev, ch, gain);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -519,6 +536,7 @@ int bladerf_set_gain_mode(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_gain_mode(dev, ch, mode);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_GAIN_MODE);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -560,6 +578,7 @@ int bladerf_set_gain_stage(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_gain_stage(dev, ch, stage, gain);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -608,6 +627,7 @@ int bladerf_set_sample_rate(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_sample_rate(dev, ch, rate, actual);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_SAMPLE_RATE);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -642,6 +662,7 @@ int bladerf_set_rational_sample_rate(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_rational_sample_rate(dev, ch, rate, actual);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_SAMPLE_RATE);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -673,6 +694,7 @@ int bladerf_set_bandwidth(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_bandwidth(dev, ch, bandwidth, actual);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_BANDWIDTH);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -710,6 +732,7 @@ int bladerf_set_frequency(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_frequency(dev, ch, frequency);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_FREQUENCY);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -743,6 +766,7 @@ int bladerf_select_band(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->select_band(dev, ch, frequency);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_RF_PORT);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -760,6 +784,7 @@ int bladerf_set_rf_port(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_rf_port(dev, ch, port);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_RF_PORT);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -819,8 +844,9 @@ int bladerf_schedule_retune(struct bladerf *dev,
     int status;
     MUTEX_LOCK(&dev->lock);
 
-    status =
-        dev->board->schedule_retune(dev, ch, timestamp, frequency, quick_tune);
+    status = dev->board->schedule_retune(dev, ch, timestamp, frequency,
+                                         quick_tune, 0);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_FREQUENCY);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -837,6 +863,67 @@ int bladerf_cancel_scheduled_retunes(struct bladerf *dev, bladerf_channel ch)
     return status;
 }
 
+int bladerf_schedule_retune_with_id(struct bladerf *dev,
+                                    bladerf_channel ch,
+                                    bladerf_timestamp timestamp,
+                                    bladerf_frequency frequency,
+                                    struct bladerf_quick_tune *quick_tune,
+                                    uint8_t id)
+{
+    int status;
+    MUTEX_LOCK(&dev->lock);
+
+    status = dev->board->schedule_retune(dev, ch, timestamp, frequency,
+                                         quick_tune, id);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_FREQUENCY);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_cancel_scheduled_retunes_with_id(struct bladerf *dev,
+                                             bladerf_channel ch,
+                                             uint8_t id,
+                                             unsigned int *cancelled)
+{
+    int status;
+    struct bladerf_retune_stats *stats;
+    uint64_t prev;
+
+    MUTEX_LOCK(&dev->lock);
+
+    stats = &dev->retune_stats[BLADERF_CHANNEL_IS_TX(ch) ? BLADERF_TX
+                                                         : BLADERF_RX];
+    prev  = stats->cancelled;
+
+    status = dev->board->cancel_scheduled_retunes_with_id(dev, ch, id);
+
+    /* The count arrives in the FPGA's response to this request */
+    if (status == 0 && cancelled != NULL) {
+        *cancelled = (unsigned int)(stats->cancelled - prev);
+    }
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_get_retune_stats(struct bladerf *dev,
+                             bladerf_channel ch,
+                             struct bladerf_retune_stats *stats)
+{
+    if (stats == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+
+    *stats = dev->retune_stats[BLADERF_CHANNEL_IS_TX(ch) ? BLADERF_TX
+                                                         : BLADERF_RX];
+
+    MUTEX_UNLOCK(&dev->lock);
+    return 0;
+}
+
 /******************************************************************************/
 /* DC/Phase/Gain Correction */
 /******************************************************************************/
@@ -869,6 +956,44 @@ int bladerf_set_correction(struct bladerf *dev,
     return status;
 }
 
+/******************************************************************************/
+/* Configuration profiles */
+/******************************************************************************/
+
+int bladerf_capture_profile(struct bladerf *dev,
+                            struct bladerf_profile *profile)
+{
+    int status;
+
+    if (profile == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+
+    status = profile_capture(dev, profile);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_apply_profile(struct bladerf *dev,
+                          const struct bladerf_profile *profile)
+{
+    int status;
+
+    if (profile == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+
+    status = profile_apply(dev, profile);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
 /******************************************************************************/
 /* Trigger */
 /******************************************************************************/
@@ -894,9 +1019,15 @@ int bladerf_trigger_arm(struct bladerf *dev,
                         uint64_t resv2)
 {
     int status;
+
+    if (trigger == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->trigger_arm(dev, trigger, arm, resv1, resv2);
+    profile_invalidate(dev, trigger->channel, BLADERF_PROFILE_TRIGGER);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -1045,6 +1176,149 @@ int bladerf_sync_rx(struct bladerf *dev,
     return dev->board->sync_rx(dev, samples, num_samples, metadata, timeout_ms);
 }
 
+int bladerf_sync_txv(struct bladerf *dev,
+                     void const *const *samples,
+                     unsigned int num_samples,
+                     struct bladerf_metadata *metadata,
+                     unsigned int timeout_ms)
+{
+    return dev->board->sync_txv(dev, samples, num_samples, metadata,
+                                timeout_ms);
+}
+
+int bladerf_sync_rxv(struct bladerf *dev,
+                     void *const *samples,
+                     unsigned int num_samples,
+                     struct bladerf_metadata *metadata,
+                     unsigned int timeout_ms)
+{
+    return dev->board->sync_rxv(dev, samples, num_samples, metadata,
+                                timeout_ms);
+}
+
+int bladerf_tx_mixer_create(struct bladerf *dev,
+                            struct bladerf_tx_mixer **mixer,
+                            const struct bladerf_tx_mixer_config *config)
+{
+    return tx_mixer_create(dev, mixer, config);
+}
+
+void bladerf_tx_mixer_destroy(struct bladerf_tx_mixer *mixer)
+{
+    tx_mixer_destroy(mixer);
+}
+
+int bladerf_tx_mixer_get_stats(struct bladerf_tx_mixer *mixer,
+                               struct bladerf_tx_mixer_stats *stats)
+{
+    return tx_mixer_get_stats(mixer, stats);
+}
+
+int bladerf_tx_producer_add(struct bladerf_tx_mixer *mixer,
+                            struct bladerf_tx_producer **producer)
+{
+    return tx_producer_add(mixer, producer);
+}
+
+void bladerf_tx_producer_remove(struct bladerf_tx_producer *producer)
+{
+    tx_producer_remove(producer);
+}
+
+int bladerf_tx_producer_submit(struct bladerf_tx_producer *producer,
+                               const int16_t *samples,
+                               unsigned int num_samples,
+                               bladerf_timestamp timestamp)
+{
+    return tx_producer_submit(producer, samples, num_samples, timestamp);
+}
+
+int bladerf_tx_producer_get_stats(struct bladerf_tx_producer *producer,
+                                  struct bladerf_tx_producer_stats *stats)
+{
+    return tx_producer_get_stats(producer, stats);
+}
+
+int bladerf_run_slots(struct bladerf *dev,
+                      struct bladerf_slot *slots,
+                      unsigned int num_slots,
+                      unsigned int timeout_ms)
+{
+    return slots_run(dev, slots, num_slots, timeout_ms);
+}
+
+int bladerf_set_rx_overrun_recovery(struct bladerf *dev,
+                                    bladerf_rx_overrun_recovery mode)
+{
+    int status;
+    MUTEX_LOCK(&dev->lock);
+
+    status = dev->board->set_rx_overrun_recovery(dev, mode);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_get_rx_overrun(struct bladerf *dev,
+                           struct bladerf_rx_overrun *info)
+{
+    return dev->board->get_rx_overrun(dev, info);
+}
+
+int bladerf_set_sync_dsp_threads(struct bladerf *dev,
+                                 bladerf_direction dir,
+                                 unsigned int num_threads)
+{
+    int status;
+    MUTEX_LOCK(&dev->lock);
+
+    status = dev->board->set_sync_dsp_threads(dev, dir, num_threads);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_set_rx_history(struct bladerf *dev, unsigned int duration_ms)
+{
+    int status;
+    bladerf_sample_rate rate = 0;
+    uint64_t length = 0;
+
+    MUTEX_LOCK(&dev->lock);
+
+    if (duration_ms > 0) {
+        status = dev->board->get_sample_rate(dev, BLADERF_CHANNEL_RX(0), &rate);
+        if (status < 0) {
+            goto out;
+        }
+
+        length = ((uint64_t)rate * duration_ms + 999) / 1000;
+        if (length > UINT_MAX) {
+            log_debug("%s: %u ms is too long at %u Hz\n", __FUNCTION__,
+                      duration_ms, rate);
+            status = BLADERF_ERR_INVAL;
+            goto out;
+        }
+    }
+
+    status = dev->board->set_rx_history(dev, (unsigned int)length);
+
+out:
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_sync_rx_at(struct bladerf *dev,
+                       void *samples,
+                       unsigned int num_samples,
+                       bladerf_timestamp timestamp,
+                       struct bladerf_metadata *metadata,
+                       unsigned int timeout_ms)
+{
+    return dev->board->sync_rx_at(dev, samples, num_samples, timestamp,
+                                  metadata, timeout_ms);
+}
+
 int bladerf_get_timestamp(struct bladerf *dev,
                           bladerf_direction dir,
                           bladerf_timestamp *timestamp)
@@ -1058,6 +1332,134 @@ int bladerf_get_timestamp(struct bladerf *dev,
     return status;
 }
 
+int bladerf_alloc_sample_buffers(void ***buffers,
+                                 size_t num_buffers,
+                                 bladerf_format format,
+                                 size_t samples_per_buffer,
+                                 uint32_t flags)
+{
+    switch (format) {
+        case BLADERF_FORMAT_SC16_Q11:
+        case BLADERF_FORMAT_SC16_Q11_META:
+            break;
+
+        default:
+            log_debug("%s: Invalid format: %d\n", __FUNCTION__, format);
+            return BLADERF_ERR_INVAL;
+    }
+
+    return buffers_alloc(buffers, num_buffers,
+                         samples_to_bytes(format, samples_per_buffer), flags);
+}
+
+void bladerf_free_sample_buffers(void **buffers)
+{
+    buffers_free(buffers);
+}
+
+int bladerf_set_stream_faults(struct bladerf *dev,
+                              const struct bladerf_stream_faults *faults)
+{
+    int status;
+    MUTEX_LOCK(&dev->lock);
+
+    status = faults_set(dev, faults);
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_get_stream_fault_stats(struct bladerf *dev,
+                                   struct bladerf_stream_fault_stats *stats)
+{
+    if (stats == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return faults_get_stats(dev, stats);
+}
+
+/******************************************************************************/
+/* Telemetry */
+/******************************************************************************/
+
+int bladerf_enable_telemetry(struct bladerf *dev,
+                             const struct bladerf_telemetry_config *config)
+{
+    return telemetry_enable(dev, config);
+}
+
+void bladerf_disable_telemetry(struct bladerf *dev)
+{
+    telemetry_disable(dev);
+}
+
+int bladerf_get_telemetry(struct bladerf *dev,
+                          struct bladerf_telemetry *snapshot)
+{
+    if (snapshot == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return telemetry_get(dev, snapshot);
+}
+
+int bladerf_get_telemetry_history(struct bladerf *dev,
+                                  struct bladerf_telemetry *snapshots,
+                                  unsigned int count,
+                                  unsigned int *actual)
+{
+    if (snapshots == NULL || actual == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return telemetry_get_history(dev, snapshots, count, actual);
+}
+
+/******************************************************************************/
+/* Asynchronous control */
+/******************************************************************************/
+
+int bladerf_submit_ctrl(struct bladerf *dev,
+                        const struct bladerf_ctrl_request *request,
+                        bladerf_ctrl_cb cb,
+                        void *user_data,
+                        struct bladerf_future **future)
+{
+    if (request == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return async_ctrl_submit(dev, request, cb, user_data, future);
+}
+
+int bladerf_future_wait(struct bladerf_future *future,
+                        unsigned int timeout_ms,
+                        uint64_t *actual)
+{
+    if (future == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return async_ctrl_future_wait(future, timeout_ms, actual);
+}
+
+bool bladerf_future_ready(struct bladerf_future *future)
+{
+    if (future == NULL) {
+        return false;
+    }
+
+    return async_ctrl_future_ready(future);
+}
+
+void bladerf_future_free(struct bladerf_future *future)
+{
+    if (future != NULL) {
+        async_ctrl_future_free(future);
+    }
+}
+
 int bladerf_interleave_stream_buffer(bladerf_channel_layout layout,
                                      bladerf_format format,
                                      unsigned int buffer_size,
@@ -1074,6 +1476,80 @@ int bladerf_deinterleave_stream_buffer(bladerf_channel_layout layout,
     return _interleave_deinterleave_buf(layout, format, buffer_size, samples);
 }
 
+int bladerf_set_wire_format(struct bladerf *dev,
+                            bladerf_direction dir,
+                            bladerf_wire_format wire_format)
+{
+    int status = 0;
+
+    if (dir != BLADERF_RX && dir != BLADERF_TX) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    if (wire_format_bytes_per_sample(wire_format) == 0) {
+        log_debug("%s: Invalid wire format: %d\n", __FUNCTION__, wire_format);
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+
+    if (wire_format != BLADERF_WIRE_FORMAT_SC16 &&
+        !have_cap(dev->board->get_capabilities(dev),
+                  BLADERF_CAP_PACKED_SAMPLES)) {
+        log_debug("%s: FPGA does not support packed samples\n", __FUNCTION__);
+        status = BLADERF_ERR_UNSUPPORTED;
+    } else if (dev->stream_configured[dir] &&
+               wire_format != dev->wire_format[dir]) {
+        /* The FPGA and the stream have already been set up for the current
+         * format, and would otherwise disagree */
+        log_debug("%s: A %s stream is configured\n", __FUNCTION__,
+                  dir == BLADERF_RX ? "RX" : "TX");
+        status = BLADERF_ERR_INVAL;
+    } else {
+        dev->wire_format[dir] = wire_format;
+    }
+
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int bladerf_get_wire_format(struct bladerf *dev,
+                            bladerf_direction dir,
+                            bladerf_wire_format *wire_format)
+{
+    if (dir != BLADERF_RX && dir != BLADERF_TX) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    if (wire_format == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+    *wire_format = dev->wire_format[dir];
+    MUTEX_UNLOCK(&dev->lock);
+
+    return 0;
+}
+
+int bladerf_unpack_stream_buffer(bladerf_wire_format wire_format,
+                                 const void *src,
+                                 int16_t *dest,
+                                 unsigned int num_samples)
+{
+    if (src == NULL || dest == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    if (wire_format_bytes_per_sample(wire_format) == 0) {
+        log_debug("%s: Invalid wire format: %d\n", __FUNCTION__, wire_format);
+        return BLADERF_ERR_INVAL;
+    }
+
+    packing_unpack(wire_format, src, dest, num_samples);
+    return 0;
+}
+
 /******************************************************************************/
 /* FPGA/Firmware Loading/Flashing */
 /******************************************************************************/
@@ -1090,6 +1566,7 @@ int bladerf_load_fpga(struct bladerf *dev, const char *fpga_file)
     }
 
     status = dev->board->load_fpga(dev, buf, buf_size);
+    profile_invalidate_all(dev);
 
 exit:
     free(buf);
@@ -1153,6 +1630,7 @@ int bladerf_device_reset(struct bladerf *dev)
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->device_reset(dev);
+    profile_invalidate_all(dev);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -1222,6 +1700,7 @@ int bladerf_set_loopback(struct bladerf *dev, bladerf_loopback l)
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_loopback(dev, l);
+    profile_invalidate(dev, BLADERF_CHANNEL_INVALID, BLADERF_PROFILE_LOOPBACK);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -1248,6 +1727,7 @@ int bladerf_set_rx_mux(struct bladerf *dev, bladerf_rx_mux mux)
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->set_rx_mux(dev, mux);
+    profile_invalidate(dev, BLADERF_CHANNEL_INVALID, BLADERF_PROFILE_RX_MUX);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -1650,6 +2130,7 @@ int bladerf_expansion_attach(struct bladerf *dev, bladerf_xb xb)
     MUTEX_LOCK(&dev->lock);
 
     status = dev->board->expansion_attach(dev, xb);
+    profile_invalidate_all(dev);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -1749,6 +2230,10 @@ int bladerf_xb200_set_filterbank(struct bladerf *dev,
 
     status = xb200_set_filterbank(dev, ch, filter);
 
+    /* The XB-200 path and filter are otherwise selected by set_frequency(),
+     * so it must be reapplied to restore them */
+    profile_invalidate(dev, ch, BLADERF_PROFILE_FREQUENCY);
+
     MUTEX_UNLOCK(&dev->lock);
     return status;
 }
@@ -1774,6 +2259,7 @@ int bladerf_xb200_set_path(struct bladerf *dev,
     MUTEX_LOCK(&dev->lock);
 
     status = xb200_set_path(dev, ch, path);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_FREQUENCY);
 
     MUTEX_UNLOCK(&dev->lock);
     return status;
@@ -22,6 +22,7 @@
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
+#include <time.h>
 
 #include <libbladeRF.h>
 
@@ -58,6 +59,8 @@
 #include "devinfo.h"
 #include "helpers/version.h"
 #include "helpers/file.h"
+#include "helpers/profile.h"
+#include "helpers/calstore.h"
 #include "version.h"
 
 /******************************************************************************
@@ -105,6 +108,9 @@ struct bladerf1_board_data {
 
     /* Synchronous interface handles */
     struct bladerf_sync sync[NUM_MODULES];
+
+    /* Si5338 multisynth solutions and register shadows */
+    struct si5338_cache si5338;
 };
 
 #define _CHECK_BOARD_STATE(_state, _locked) \
@@ -534,6 +540,66 @@ static int bladerf1_apply_lms_dc_cals(struct bladerf *dev)
     return 0;
 }
 
+/* Apply any LMS DC calibrations persisted by bladerf_calibrate_dc() */
+static int bladerf1_restore_calstore(struct bladerf *dev)
+{
+    struct calstore cs;
+    const char *stale;
+    int status;
+
+    status = calstore_load(dev->ident.serial, &cs);
+    if (status != 0) {
+        if (status != BLADERF_ERR_NO_FILE) {
+            log_debug("Failed to load calibration store: %s\n",
+                      bladerf_strerror(status));
+        }
+        return 0;
+    }
+
+    stale = calstore_stale(&cs, dev->ident.serial, time(NULL));
+    if (stale != NULL) {
+        log_debug("Not restoring stored calibrations (%s).\n", stale);
+        return 0;
+    }
+
+    log_verbose("Restoring LMS DC calibrations from calibration store.\n");
+    return lms_set_dc_cals(dev, &cs.lms);
+}
+
+/* Record the results of calibrating `module` in the calibration store */
+static void bladerf1_update_calstore(struct bladerf *dev,
+                                     bladerf_cal_module module)
+{
+    struct bladerf_lms_dc_cals cals;
+    struct calstore cs;
+    int status;
+
+    status = lms_get_dc_cals(dev, &cals);
+    if (status != 0) {
+        log_debug("Failed to read back LMS DC calibrations: %s\n",
+                  bladerf_strerror(status));
+        return;
+    }
+
+    /* Merge with the results for other modules, unless those are no longer
+     * usable. The entry keeps the creation time of its oldest results. */
+    if (calstore_load(dev->ident.serial, &cs) != 0 ||
+        calstore_stale(&cs, dev->ident.serial, time(NULL)) != NULL) {
+        calstore_init(&cs, dev->ident.serial);
+    }
+
+    if (calstore_merge(&cs, &cals, module) != 0) {
+        return;
+    }
+
+    /* Failing to persist the results doesn't affect the calibration itself */
+    status = calstore_save(&cs);
+    if (status != 0) {
+        log_debug("Failed to save calibration store: %s\n",
+                  bladerf_strerror(status));
+    }
+}
+
 /**
  * Initialize device registers - required after power-up, but safe
  * to call multiple times after power-up (e.g., multiple close and reopens)
@@ -716,13 +782,18 @@ static int bladerf1_initialize(struct bladerf *dev)
             return status;
         }
 
-        /* Set a default samplerate */
-        status = si5338_set_sample_rate(dev, BLADERF_CHANNEL_TX(0), 1000000, NULL);
+        /* Set a default samplerate. The Si5338 may have been configured by
+         * a previous session, so write its registers in full. */
+        si5338_cache_invalidate(&board_data->si5338);
+
+        status = si5338_set_sample_rate(dev, &board_data->si5338,
+                                        BLADERF_CHANNEL_TX(0), 1000000, NULL);
         if (status != 0) {
             return status;
         }
 
-        status = si5338_set_sample_rate(dev, BLADERF_CHANNEL_RX(0), 1000000, NULL);
+        status = si5338_set_sample_rate(dev, &board_data->si5338,
+                                        BLADERF_CHANNEL_RX(0), 1000000, NULL);
         if (status != 0) {
             return status;
         }
@@ -775,6 +846,13 @@ static int bladerf1_initialize(struct bladerf *dev)
         return status;
     }
 
+    /* Stored calibration results take precedence over the DC calibration
+     * tables, as they are at least as recent */
+    status = bladerf1_restore_calstore(dev);
+    if (status != 0) {
+        return status;
+    }
+
     return 0;
 }
 
@@ -1911,9 +1989,11 @@ static int bladerf1_get_gain_stages(struct bladerf *dev,
 
 static int bladerf1_set_sample_rate(struct bladerf *dev, bladerf_channel ch, unsigned int rate, unsigned int *actual)
 {
+    struct bladerf1_board_data *board_data = dev->board_data;
+
     CHECK_BOARD_STATE(STATE_INITIALIZED);
 
-    return si5338_set_sample_rate(dev, ch, rate, actual);
+    return si5338_set_sample_rate(dev, &board_data->si5338, ch, rate, actual);
 }
 
 static int bladerf1_get_sample_rate(struct bladerf *dev, bladerf_channel ch, unsigned int *rate)
@@ -1931,9 +2011,12 @@ static int bladerf1_get_sample_rate_range(struct bladerf *dev, bladerf_channel c
 
 static int bladerf1_set_rational_sample_rate(struct bladerf *dev, bladerf_channel ch, struct bladerf_rational_rate *rate, struct bladerf_rational_rate *actual)
 {
+    struct bladerf1_board_data *board_data = dev->board_data;
+
     CHECK_BOARD_STATE(STATE_INITIALIZED);
 
-    return si5338_set_rational_sample_rate(dev, ch, rate, actual);
+    return si5338_set_rational_sample_rate(dev, &board_data->si5338, ch, rate,
+                                           actual);
 }
 
 static int bladerf1_get_rational_sample_rate(struct bladerf *dev, bladerf_channel ch, struct bladerf_rational_rate *rate)
@@ -2066,7 +2149,7 @@ static int bladerf1_set_frequency(struct bladerf *dev,
 
         case BLADERF_TUNING_MODE_FPGA: {
             status = dev->board->schedule_retune(dev, ch, BLADERF_RETUNE_NOW,
-                                                 frequency, NULL);
+                                                 frequency, NULL, 0);
             break;
         }
 
@@ -2372,7 +2455,8 @@ static int bladerf1_schedule_retune(struct bladerf *dev,
                                     bladerf_channel ch,
                                     bladerf_timestamp timestamp,
                                     bladerf_frequency frequency,
-                                    struct bladerf_quick_tune *quick_tune)
+                                    struct bladerf_quick_tune *quick_tune,
+                                    uint8_t id)
 
 {
     struct bladerf1_board_data *board_data = dev->board_data;
@@ -2391,6 +2475,17 @@ static int bladerf1_schedule_retune(struct bladerf *dev,
         return BLADERF_ERR_UNSUPPORTED;
     }
 
+    if (id != 0 &&
+        !have_cap(board_data->capabilities, BLADERF_CAP_RETUNE_CANCEL)) {
+        log_debug("This FPGA version (%u.%u.%u) does not support "
+                  "retune IDs.\n",
+                  board_data->fpga_version.major,
+                  board_data->fpga_version.minor,
+                  board_data->fpga_version.patch);
+
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
     if (quick_tune == NULL) {
         status = lms_calculate_tuning_params((uint32_t)frequency, &f);
         if (status != 0) {
@@ -2409,7 +2504,8 @@ static int bladerf1_schedule_retune(struct bladerf *dev,
     return dev->backend->retune(dev, ch, timestamp, f.nint, f.nfrac, f.freqsel,
                                 f.vcocap,
                                 (f.flags & LMS_FREQ_FLAGS_LOW_BAND) != 0,
-                                (f.flags & LMS_FREQ_FLAGS_FORCE_VCOCAP) != 0);
+                                (f.flags & LMS_FREQ_FLAGS_FORCE_VCOCAP) != 0,
+                                id);
 }
 
 static int bladerf1_cancel_scheduled_retunes(struct bladerf *dev,
@@ -2422,7 +2518,7 @@ static int bladerf1_cancel_scheduled_retunes(struct bladerf *dev,
 
     if (have_cap(board_data->capabilities, BLADERF_CAP_SCHEDULED_RETUNE)) {
         status = dev->backend->retune(dev, ch, NIOS_PKT_RETUNE_CLEAR_QUEUE, 0,
-                                      0, 0, 0, false, false);
+                                      0, 0, 0, false, false, 0);
     } else {
         log_debug("This FPGA version (%u.%u.%u) does not support "
                   "scheduled retunes.\n",
@@ -2436,6 +2532,28 @@ static int bladerf1_cancel_scheduled_retunes(struct bladerf *dev,
     return status;
 }
 
+static int bladerf1_cancel_scheduled_retunes_with_id(struct bladerf *dev,
+                                                     bladerf_channel ch,
+                                                     uint8_t id)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    CHECK_BOARD_STATE(STATE_FPGA_LOADED);
+
+    if (!have_cap(board_data->capabilities, BLADERF_CAP_RETUNE_CANCEL)) {
+        log_debug("This FPGA version (%u.%u.%u) does not support "
+                  "retune IDs.\n",
+                  board_data->fpga_version.major,
+                  board_data->fpga_version.minor,
+                  board_data->fpga_version.patch);
+
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
+    return dev->backend->retune(dev, ch, NIOS_PKT_RETUNE_CANCEL, 0, 0, 0, 0,
+                                false, false, id);
+}
+
 /******************************************************************************/
 /* DC/Phase/Gain Correction */
 /******************************************************************************/
@@ -2649,6 +2767,12 @@ static int perform_format_config(struct bladerf *dev, bladerf_direction dir,
         return BLADERF_ERR_UPDATE_FPGA;
     }
 
+    if (use_timestamps && (dir == BLADERF_RX || dir == BLADERF_TX) &&
+        dev->wire_format[dir] != BLADERF_WIRE_FORMAT_SC16) {
+        log_debug("Packed wire formats do not support metadata.\n");
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
     switch (dir) {
         case BLADERF_RX:
             other = BLADERF_TX;
@@ -2682,9 +2806,12 @@ static int perform_format_config(struct bladerf *dev, bladerf_direction dir,
         gpio_val &= ~(BLADERF_GPIO_TIMESTAMP | BLADERF_GPIO_TIMESTAMP_DIV2);
     }
 
+    gpio_val = wire_format_gpio(gpio_val, dir, dev->wire_format[dir]);
+
     status = dev->backend->config_gpio_write(dev, gpio_val);
     if (status == 0) {
         board_data->module_format[dir] = format;
+        dev->stream_configured[dir]    = true;
     }
 
     return status;
@@ -2709,6 +2836,7 @@ static int perform_format_deconfig(struct bladerf *dev, bladerf_direction dir)
             /* We'll reconfigure the HW when we call perform_format_config, so
              * we just need to update our stored information */
             board_data->module_format[dir] = -1;
+            dev->stream_configured[dir]    = false;
             break;
 
         default:
@@ -2847,6 +2975,38 @@ static int bladerf1_sync_rx(struct bladerf *dev,
     return status;
 }
 
+static int bladerf1_sync_txv(struct bladerf *dev,
+                             void const *const *samples,
+                             unsigned int num_samples,
+                             struct bladerf_metadata *metadata,
+                             unsigned int timeout_ms)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_TX].initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_txv(&board_data->sync[BLADERF_TX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
+static int bladerf1_sync_rxv(struct bladerf *dev,
+                             void *const *samples,
+                             unsigned int num_samples,
+                             struct bladerf_metadata *metadata,
+                             unsigned int timeout_ms)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_rxv(&board_data->sync[BLADERF_RX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
 static int bladerf1_get_timestamp(struct bladerf *dev,
                                   bladerf_direction dir,
                                   bladerf_timestamp *value)
@@ -2856,6 +3016,69 @@ static int bladerf1_get_timestamp(struct bladerf *dev,
     return dev->backend->get_timestamp(dev, dir, value);
 }
 
+static int bladerf1_set_rx_overrun_recovery(struct bladerf *dev,
+                                            bladerf_rx_overrun_recovery mode)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    return sync_set_rx_overrun_recovery(&board_data->sync[BLADERF_RX], mode);
+}
+
+static int bladerf1_get_rx_overrun(struct bladerf *dev,
+                                   struct bladerf_rx_overrun *info)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_get_rx_overrun(&board_data->sync[BLADERF_RX], info);
+}
+
+static int bladerf1_set_rx_history(struct bladerf *dev, unsigned int length)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    return sync_set_rx_history(&board_data->sync[BLADERF_RX], length);
+}
+
+static int bladerf1_sync_rx_at(struct bladerf *dev,
+                               void *samples,
+                               unsigned int num_samples,
+                               bladerf_timestamp timestamp,
+                               struct bladerf_metadata *metadata,
+                               unsigned int timeout_ms)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_rx_at(&board_data->sync[BLADERF_RX], samples, num_samples,
+                      timestamp, metadata, timeout_ms);
+}
+
+static int bladerf1_set_sync_dsp_threads(struct bladerf *dev,
+                                         bladerf_direction dir,
+                                         unsigned int num_threads)
+{
+    struct bladerf1_board_data *board_data = dev->board_data;
+
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    if (dir != BLADERF_RX && dir != BLADERF_TX) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_set_dsp_threads(&board_data->sync[dir], num_threads);
+}
+
 /******************************************************************************/
 /* FPGA/Firmware Loading/Flashing */
 /******************************************************************************/
@@ -3485,6 +3708,19 @@ static int bladerf1_expansion_get_attached(struct bladerf *dev, bladerf_xb *xb)
     return status;
 }
 
+/******************************************************************************/
+/* Telemetry */
+/******************************************************************************/
+
+static int bladerf1_read_telemetry(struct bladerf *dev,
+                                   uint32_t item,
+                                   struct bladerf_telemetry *telemetry)
+{
+    /* The bladeRF x40/x115 has no power monitor, and the LMS6002D provides
+     * neither a temperature sensor nor RSSI */
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
 /******************************************************************************/
 /* Board binding */
 /******************************************************************************/
@@ -3532,6 +3768,7 @@ const struct board_fns bladerf1_board_fns = {
     FIELD_INIT(.get_quick_tune, bladerf1_get_quick_tune),
     FIELD_INIT(.schedule_retune, bladerf1_schedule_retune),
     FIELD_INIT(.cancel_scheduled_retunes, bladerf1_cancel_scheduled_retunes),
+    FIELD_INIT(.cancel_scheduled_retunes_with_id, bladerf1_cancel_scheduled_retunes_with_id),
     FIELD_INIT(.get_correction, bladerf1_get_correction),
     FIELD_INIT(.set_correction, bladerf1_set_correction),
     FIELD_INIT(.trigger_init, bladerf1_trigger_init),
@@ -3548,7 +3785,14 @@ const struct board_fns bladerf1_board_fns = {
     FIELD_INIT(.sync_config, bladerf1_sync_config),
     FIELD_INIT(.sync_tx, bladerf1_sync_tx),
     FIELD_INIT(.sync_rx, bladerf1_sync_rx),
+    FIELD_INIT(.sync_txv, bladerf1_sync_txv),
+    FIELD_INIT(.sync_rxv, bladerf1_sync_rxv),
     FIELD_INIT(.get_timestamp, bladerf1_get_timestamp),
+    FIELD_INIT(.set_rx_overrun_recovery, bladerf1_set_rx_overrun_recovery),
+    FIELD_INIT(.get_rx_overrun, bladerf1_get_rx_overrun),
+    FIELD_INIT(.set_rx_history, bladerf1_set_rx_history),
+    FIELD_INIT(.sync_rx_at, bladerf1_sync_rx_at),
+    FIELD_INIT(.set_sync_dsp_threads, bladerf1_set_sync_dsp_threads),
     FIELD_INIT(.load_fpga, bladerf1_load_fpga),
     FIELD_INIT(.flash_fpga, bladerf1_flash_fpga),
     FIELD_INIT(.erase_stored_fpga, bladerf1_erase_stored_fpga),
@@ -3575,6 +3819,7 @@ const struct board_fns bladerf1_board_fns = {
     FIELD_INIT(.write_flash, bladerf1_write_flash),
     FIELD_INIT(.expansion_attach, bladerf1_expansion_attach),
     FIELD_INIT(.expansion_get_attached, bladerf1_expansion_get_attached),
+    FIELD_INIT(.read_telemetry, bladerf1_read_telemetry),
     FIELD_INIT(.name, "bladerf1"),
 };
 
@@ -3600,6 +3845,7 @@ int bladerf_set_txvga2(struct bladerf *dev, int gain)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_txvga2_set_gain(dev, gain);
+    profile_invalidate(dev, BLADERF_CHANNEL_TX(0), BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3636,6 +3882,7 @@ int bladerf_set_txvga1(struct bladerf *dev, int gain)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_txvga1_set_gain(dev, gain);
+    profile_invalidate(dev, BLADERF_CHANNEL_TX(0), BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3676,6 +3923,7 @@ int bladerf_set_lna_gain(struct bladerf *dev, bladerf_lna_gain gain)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_lna_set_gain(dev, gain);
+    profile_invalidate(dev, BLADERF_CHANNEL_RX(0), BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3712,6 +3960,7 @@ int bladerf_set_rxvga1(struct bladerf *dev, int gain)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_rxvga1_set_gain(dev, gain);
+    profile_invalidate(dev, BLADERF_CHANNEL_RX(0), BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3748,6 +3997,7 @@ int bladerf_set_rxvga2(struct bladerf *dev, int gain)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_rxvga2_set_gain(dev, gain);
+    profile_invalidate(dev, BLADERF_CHANNEL_RX(0), BLADERF_PROFILE_GAIN);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3789,6 +4039,7 @@ int bladerf_set_lpf_mode(struct bladerf *dev, bladerf_channel ch,
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_lpf_set_mode(dev, ch, mode);
+    profile_invalidate(dev, ch, BLADERF_PROFILE_BANDWIDTH);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3854,6 +4105,43 @@ int bladerf_set_sampling(struct bladerf *dev, bladerf_sampling sampling)
     return status;
 }
 
+/******************************************************************************/
+/* Sample rate precomputation */
+/******************************************************************************/
+
+int bladerf_prepare_rational_sample_rates(
+    struct bladerf *dev,
+    bladerf_channel ch,
+    const struct bladerf_rational_rate *rates,
+    unsigned int num_rates,
+    struct bladerf_rational_rate *actual)
+{
+    struct bladerf1_board_data *board_data;
+    int status;
+
+    if (dev->board != &bladerf1_board_fns)
+        return BLADERF_ERR_UNSUPPORTED;
+
+    if (ch != BLADERF_CHANNEL_RX(0) && ch != BLADERF_CHANNEL_TX(0)) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    if (rates == NULL && num_rates != 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&dev->lock);
+
+    board_data = dev->board_data;
+
+    status = si5338_prepare_sample_rates(&board_data->si5338, ch, rates,
+                                         num_rates, actual);
+
+    MUTEX_UNLOCK(&dev->lock);
+
+    return status;
+}
+
 /******************************************************************************/
 /* SMB Clock Configuration */
 /******************************************************************************/
@@ -3982,6 +4270,9 @@ int bladerf_calibrate_dc(struct bladerf *dev, bladerf_cal_module module)
     CHECK_BOARD_STATE_LOCKED(STATE_INITIALIZED);
 
     status = lms_calibrate_dc(dev, module);
+    if (status == 0) {
+        bladerf1_update_calstore(dev, module);
+    }
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -3992,16 +4283,34 @@ int bladerf_calibrate_dc(struct bladerf *dev, bladerf_cal_module module)
 /* Low-level Si5338 access */
 /******************************************************************************/
 
+#ifdef ENABLE_BACKEND_REPLAY
+extern const struct board_fns replay_board_fns;
+
+/* Replay devices emulate the Si5338's register file, in which they keep their
+ * sample rates (see backend/replay/replay.h) */
+static bool is_replay(struct bladerf *dev)
+{
+    return dev->board == &replay_board_fns;
+}
+#else
+static bool is_replay(struct bladerf *dev)
+{
+    return false;
+}
+#endif
+
 int bladerf_si5338_read(struct bladerf *dev, uint8_t address, uint8_t *val)
 {
     int status;
 
-    if (dev->board != &bladerf1_board_fns)
+    if (dev->board != &bladerf1_board_fns && !is_replay(dev))
         return BLADERF_ERR_UNSUPPORTED;
 
     MUTEX_LOCK(&dev->lock);
 
-    CHECK_BOARD_STATE_LOCKED(STATE_FPGA_LOADED);
+    if (!is_replay(dev)) {
+        CHECK_BOARD_STATE_LOCKED(STATE_FPGA_LOADED);
+    }
 
     status = dev->backend->si5338_read(dev,address,val);
 
@@ -4014,15 +4323,26 @@ int bladerf_si5338_write(struct bladerf *dev, uint8_t address, uint8_t val)
 {
     int status;
 
-    if (dev->board != &bladerf1_board_fns)
+    if (dev->board != &bladerf1_board_fns && !is_replay(dev))
         return BLADERF_ERR_UNSUPPORTED;
 
     MUTEX_LOCK(&dev->lock);
 
-    CHECK_BOARD_STATE_LOCKED(STATE_FPGA_LOADED);
+    if (!is_replay(dev)) {
+        CHECK_BOARD_STATE_LOCKED(STATE_FPGA_LOADED);
+    }
 
     status = dev->backend->si5338_write(dev,address,val);
 
+    /* Either sample clock may have changed. Invalidating one channel's rate
+     * forgets every channel's, as they share the Si5338. */
+    profile_invalidate(dev, BLADERF_CHANNEL_RX(0), BLADERF_PROFILE_SAMPLE_RATE);
+
+    if (!is_replay(dev)) {
+        struct bladerf1_board_data *board_data = dev->board_data;
+        si5338_cache_invalidate(&board_data->si5338);
+    }
+
     MUTEX_UNLOCK(&dev->lock);
 
     return status;
@@ -4062,6 +4382,7 @@ int bladerf_lms_write(struct bladerf *dev, uint8_t address, uint8_t val)
     CHECK_BOARD_STATE_LOCKED(STATE_FPGA_LOADED);
 
     status = dev->backend->lms_write(dev,address,val);
+    profile_invalidate_all(dev);
 
     MUTEX_UNLOCK(&dev->lock);
 
@@ -102,5 +102,10 @@ uint64_t bladerf1_get_fpga_capabilities(const struct bladerf_version *fpga_versi
         capabilities |= BLADERF_CAP_AGC_DC_LUT;
     }
 
+    if (version_fields_greater_or_equal(fpga_version, 0, 11, 0)) {
+        capabilities |= BLADERF_CAP_PACKED_SAMPLES;
+        capabilities |= BLADERF_CAP_RETUNE_CANCEL;
+    }
+
     return capabilities;
 }
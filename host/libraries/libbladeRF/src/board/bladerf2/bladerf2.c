@@ -53,6 +53,7 @@
 #include "conversions.h"
 #include "devinfo.h"
 #include "helpers/file.h"
+#include "helpers/profile.h"
 #include "helpers/version.h"
 #include "helpers/wallclock.h"
 #include "iterators.h"
@@ -171,6 +172,17 @@ static int _bladerf2_initialize(struct bladerf *dev)
     CHECK_STATUS(
         dev->backend->set_fpga_protocol(dev, BACKEND_FPGA_PROTOCOL_NIOSII));
 
+    /* The FPGA may have been left decimating by a previous session */
+    board_data->rx_log2_decimation = 0;
+    if (have_cap(board_data->capabilities, BLADERF_CAP_RX_DECIMATION)) {
+        uint32_t reg;
+
+        CHECK_STATUS(dev->backend->rx_decim_read(dev, &reg));
+
+        board_data->rx_log2_decimation =
+            (reg >> RX_DECIM_LOG2_SHIFT) & RX_DECIM_LOG2_MASK;
+    }
+
     /* Initialize INA219 */
     CHECK_STATUS(ina219_init(dev, ina219_r_shunt));
 
@@ -1015,7 +1027,10 @@ static int bladerf2_set_sample_rate(struct bladerf *dev,
 
     struct bladerf2_board_data *board_data = dev->board_data;
     struct controller_fns const *rfic      = board_data->rfic;
+    struct bladerf2_rate_cache *cache      = &board_data->rate_cache;
     struct bladerf_range const *range      = NULL;
+    struct bladerf2_rate_cache_entry const *cached;
+    struct bladerf2_rate_cache_entry entry;
     bladerf_sample_rate current;
     bool old_low, new_low;
     bladerf_rfic_rxfir rxfir;
@@ -1028,20 +1043,41 @@ static int bladerf2_set_sample_rate(struct bladerf *dev,
         return BLADERF_ERR_RANGE;
     }
 
-    /* Get current sample rate, and check it against the low-rate range */
-    CHECK_STATUS(dev->board->get_sample_rate(dev, ch, &current));
+    /* RX and TX share the RFIC's clock chain, so there is nothing to do if
+     * this rate was the last one configured, on either channel. */
+    if (cache->valid && cache->requested == rate) {
+        log_verbose("%s: %u Hz is already configured\n", __FUNCTION__, rate);
 
-    old_low = is_within_range(&bladerf2_sample_rate_range_4x, current);
-    new_low = is_within_range(&bladerf2_sample_rate_range_4x, rate);
+        if (actual != NULL) {
+            *actual = cache->actual;
+        }
 
-    /* Get current filter status */
-    if (new_low || old_low) {
+        /* The set of enabled channels may have changed since */
+        check_total_sample_rate(dev);
+
+        return 0;
+    }
+
+    /* Get current sample rate and filter status, from the cache if we can */
+    if (cache->valid) {
+        current = cache->actual;
+        rxfir   = cache->rxfir;
+        txfir   = cache->txfir;
+    } else {
+        CHECK_STATUS(dev->board->get_sample_rate(dev, ch, &current));
         CHECK_STATUS(
             rfic->get_filter(dev, BLADERF_CHANNEL_RX(0), &rxfir, NULL));
         CHECK_STATUS(
             rfic->get_filter(dev, BLADERF_CHANNEL_TX(0), NULL, &txfir));
     }
 
+    /* Until the reconfiguration succeeds, the RFIC state is unknown */
+    cache->valid = false;
+
+    /* Check current and new sample rates against the low-rate range */
+    old_low = is_within_range(&bladerf2_sample_rate_range_4x, current);
+    new_low = is_within_range(&bladerf2_sample_rate_range_4x, rate);
+
     /* If the requested sample rate is below the native range, we must implement
      * a 4x decimation/interpolation filter on the RFIC. */
     if (new_low) {
@@ -1081,10 +1117,43 @@ static int bladerf2_set_sample_rate(struct bladerf *dev,
 
             return BLADERF_ERR_UNEXPECTED;
         }
+
+        rxfir = BLADERF_RFIC_RXFIR_DEC4;
+        txfir = BLADERF_RFIC_TXFIR_INT4;
+    }
+
+    /* Set the sample rate. If this rate has been configured under the same
+     * FIR settings before, program its clock chain directly instead of having
+     * the RFIC driver compute it again. */
+    cached = rate_cache_lookup(cache, rate, rxfir, txfir);
+
+    if (cached != NULL && cached->have_clks && rfic->set_path_clks != NULL) {
+        log_verbose("%s: restoring clock chain for %u Hz\n", __FUNCTION__,
+                    rate);
+
+        entry = *cached;
+        CHECK_STATUS(rfic->set_path_clks(dev, entry.rx_path_clks,
+                                         entry.tx_path_clks));
+    } else {
+        CHECK_STATUS(rfic->set_sample_rate(dev, ch, rate));
     }
 
-    /* Set the sample rate */
-    CHECK_STATUS(rfic->set_sample_rate(dev, ch, rate));
+    /* Remember the clock chain as the RFIC driver computed it, before any
+     * FIR change below, which is the point it's restored at. */
+    if (cached != NULL) {
+        entry = *cached;
+    } else {
+        memset(&entry, 0, sizeof(entry));
+        entry.requested = rate;
+        entry.rxfir     = rxfir;
+        entry.txfir     = txfir;
+
+        if (rfic->get_path_clks != NULL) {
+            CHECK_STATUS(rfic->get_path_clks(dev, entry.rx_path_clks,
+                                             entry.tx_path_clks));
+            entry.have_clks = true;
+        }
+    }
 
     /* If the previous sample rate was below the native range, but the new one
      * isn't, switch back to the default filters. */
@@ -1098,12 +1167,27 @@ static int bladerf2_set_sample_rate(struct bladerf *dev,
                                           BLADERF_RFIC_RXFIR_DEFAULT, 0));
             CHECK_STATUS(rfic->set_filter(dev, BLADERF_CHANNEL_TX(0), 0,
                                           BLADERF_RFIC_TXFIR_DEFAULT));
+
+            rxfir = BLADERF_RFIC_RXFIR_DEFAULT;
+            txfir = BLADERF_RFIC_TXFIR_DEFAULT;
         }
     }
 
-    /* If requested, fetch the new sample rate and return it. */
+    /* Fetch the new sample rate, unless we've configured this rate before */
+    if (cached == NULL) {
+        CHECK_STATUS(dev->board->get_sample_rate(dev, ch, &entry.actual));
+        rate_cache_insert(cache, &entry);
+    }
+
+    cache->valid     = true;
+    cache->requested = rate;
+    cache->actual    = entry.actual;
+    cache->rxfir     = rxfir;
+    cache->txfir     = txfir;
+
+    /* If requested, return the new sample rate */
     if (actual != NULL) {
-        CHECK_STATUS(dev->board->get_sample_rate(dev, ch, actual));
+        *actual = entry.actual;
     }
 
     /* Warn the user if this isn't achievable */
@@ -1443,7 +1527,8 @@ static int bladerf2_schedule_retune(struct bladerf *dev,
                                     bladerf_channel ch,
                                     bladerf_timestamp timestamp,
                                     bladerf_frequency frequency,
-                                    struct bladerf_quick_tune *quick_tune)
+                                    struct bladerf_quick_tune *quick_tune,
+                                    uint8_t id)
 {
     CHECK_BOARD_STATE(STATE_FPGA_LOADED);
     NULL_CHECK(quick_tune);
@@ -1460,9 +1545,20 @@ static int bladerf2_schedule_retune(struct bladerf *dev,
         return BLADERF_ERR_UNSUPPORTED;
     }
 
+    if (id != 0 &&
+        !have_cap(board_data->capabilities, BLADERF_CAP_RETUNE_CANCEL)) {
+        log_debug("This FPGA version (%u.%u.%u) does not support "
+                  "retune IDs.\n",
+                  board_data->fpga_version.major,
+                  board_data->fpga_version.minor,
+                  board_data->fpga_version.patch);
+
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
     return dev->backend->retune2(dev, ch, timestamp, quick_tune->nios_profile,
                                  quick_tune->rffe_profile, quick_tune->port,
-                                 quick_tune->spdt);
+                                 quick_tune->spdt, id);
 }
 
 static int bladerf2_cancel_scheduled_retunes(struct bladerf *dev,
@@ -1483,7 +1579,29 @@ static int bladerf2_cancel_scheduled_retunes(struct bladerf *dev,
     }
 
     return dev->backend->retune2(dev, ch, NIOS_PKT_RETUNE2_CLEAR_QUEUE, 0, 0, 0,
-                                 0);
+                                 0, 0);
+}
+
+static int bladerf2_cancel_scheduled_retunes_with_id(struct bladerf *dev,
+                                                     bladerf_channel ch,
+                                                     uint8_t id)
+{
+    CHECK_BOARD_STATE(STATE_FPGA_LOADED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!have_cap(board_data->capabilities, BLADERF_CAP_RETUNE_CANCEL)) {
+        log_debug("This FPGA version (%u.%u.%u) does not support "
+                  "retune IDs.\n",
+                  board_data->fpga_version.major,
+                  board_data->fpga_version.minor,
+                  board_data->fpga_version.patch);
+
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
+    return dev->backend->retune2(dev, ch, NIOS_PKT_RETUNE2_CANCEL, 0, 0, 0, 0,
+                                 id);
 }
 
 
@@ -2150,6 +2268,42 @@ static int bladerf2_sync_rx(struct bladerf *dev,
                    metadata, timeout_ms);
 }
 
+static int bladerf2_sync_txv(struct bladerf *dev,
+                             void const *const *samples,
+                             unsigned int num_samples,
+                             struct bladerf_metadata *metadata,
+                             unsigned int timeout_ms)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_TX].initialized) {
+        RETURN_INVAL("sync tx", "not initialized");
+    }
+
+    return sync_txv(&board_data->sync[BLADERF_TX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
+static int bladerf2_sync_rxv(struct bladerf *dev,
+                             void *const *samples,
+                             unsigned int num_samples,
+                             struct bladerf_metadata *metadata,
+                             unsigned int timeout_ms)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        RETURN_INVAL("sync rx", "not initialized");
+    }
+
+    return sync_rxv(&board_data->sync[BLADERF_RX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
 static int bladerf2_get_timestamp(struct bladerf *dev,
                                   bladerf_direction dir,
                                   bladerf_timestamp *value)
@@ -2157,7 +2311,84 @@ static int bladerf2_get_timestamp(struct bladerf *dev,
     CHECK_BOARD_STATE(STATE_INITIALIZED);
     NULL_CHECK(value);
 
-    return dev->backend->get_timestamp(dev, dir, value);
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    CHECK_STATUS(dev->backend->get_timestamp(dev, dir, value));
+
+    /* RX metadata timestamps count decimated samples (see rx.vhd) */
+    if (BLADERF_RX == dir) {
+        *value >>= board_data->rx_log2_decimation;
+    }
+
+    return 0;
+}
+
+static int bladerf2_set_rx_overrun_recovery(struct bladerf *dev,
+                                            bladerf_rx_overrun_recovery mode)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    return sync_set_rx_overrun_recovery(&board_data->sync[BLADERF_RX], mode);
+}
+
+static int bladerf2_get_rx_overrun(struct bladerf *dev,
+                                   struct bladerf_rx_overrun *info)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+    NULL_CHECK(info);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        RETURN_INVAL("sync rx", "not initialized");
+    }
+
+    return sync_get_rx_overrun(&board_data->sync[BLADERF_RX], info);
+}
+
+static int bladerf2_set_rx_history(struct bladerf *dev, unsigned int length)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    return sync_set_rx_history(&board_data->sync[BLADERF_RX], length);
+}
+
+static int bladerf2_sync_rx_at(struct bladerf *dev,
+                               void *samples,
+                               unsigned int num_samples,
+                               bladerf_timestamp timestamp,
+                               struct bladerf_metadata *metadata,
+                               unsigned int timeout_ms)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        RETURN_INVAL("sync rx", "not initialized");
+    }
+
+    return sync_rx_at(&board_data->sync[BLADERF_RX], samples, num_samples,
+                      timestamp, metadata, timeout_ms);
+}
+
+static int bladerf2_set_sync_dsp_threads(struct bladerf *dev,
+                                         bladerf_direction dir,
+                                         unsigned int num_threads)
+{
+    CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (dir != BLADERF_RX && dir != BLADERF_TX) {
+        RETURN_INVAL("direction", "is invalid");
+    }
+
+    return sync_set_dsp_threads(&board_data->sync[dir], num_threads);
 }
 
 
@@ -2318,6 +2549,9 @@ static int bladerf2_set_tuning_mode(struct bladerf *dev,
     board_data->rfic        = rfic_new;
     board_data->tuning_mode = mode;
 
+    /* The RFIC is about to be (re)initialized */
+    rate_cache_invalidate(&board_data->rate_cache);
+
     /* Bring RFIC to initialized state */
     CHECK_STATUS(rfic_new->get_init_state(dev, &init_state));
 
@@ -2783,6 +3017,60 @@ static int bladerf2_expansion_get_attached(struct bladerf *dev, bladerf_xb *xb)
 }
 
 
+/******************************************************************************/
+/* Telemetry */
+/******************************************************************************/
+
+static int bladerf2_read_telemetry(struct bladerf *dev,
+                                   uint32_t item,
+                                   struct bladerf_telemetry *telemetry)
+{
+    CHECK_BOARD_STATE(STATE_FPGA_LOADED);
+    NULL_CHECK(telemetry);
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+    size_t i;
+
+    switch (item) {
+        case BLADERF_TELEMETRY_BUS_VOLTAGE:
+            return ina219_read_bus_voltage(dev, &telemetry->bus_voltage);
+
+        case BLADERF_TELEMETRY_CURRENT:
+            return ina219_read_current(dev, &telemetry->current);
+
+        case BLADERF_TELEMETRY_POWER:
+            return ina219_read_power(dev, &telemetry->power);
+
+        case BLADERF_TELEMETRY_RFIC_TEMPERATURE:
+            if (board_data->rfic->command_mode != RFIC_COMMAND_HOST) {
+                return BLADERF_ERR_UNSUPPORTED;
+            }
+
+            telemetry->rfic_temperature =
+                ad9361_get_temp(board_data->phy) / 1000.0F;
+            return 0;
+
+        case BLADERF_TELEMETRY_RSSI:
+            CHECK_BOARD_STATE(STATE_INITIALIZED);
+
+            for (i = 0; i < ARRAY_SIZE(telemetry->pre_rssi); ++i) {
+                int pre_rssi, sym_rssi;
+
+                CHECK_STATUS(board_data->rfic->get_rssi(
+                    dev, BLADERF_CHANNEL_RX(i), &pre_rssi, &sym_rssi));
+
+                telemetry->pre_rssi[i] = pre_rssi;
+                telemetry->sym_rssi[i] = sym_rssi;
+            }
+
+            return 0;
+
+        default:
+            return BLADERF_ERR_UNSUPPORTED;
+    }
+}
+
+
 /******************************************************************************/
 /* Board binding */
 /******************************************************************************/
@@ -2830,6 +3118,7 @@ struct board_fns const bladerf2_board_fns = {
     FIELD_INIT(.get_quick_tune, bladerf2_get_quick_tune),
     FIELD_INIT(.schedule_retune, bladerf2_schedule_retune),
     FIELD_INIT(.cancel_scheduled_retunes, bladerf2_cancel_scheduled_retunes),
+    FIELD_INIT(.cancel_scheduled_retunes_with_id, bladerf2_cancel_scheduled_retunes_with_id),
     FIELD_INIT(.get_correction, bladerf2_get_correction),
     FIELD_INIT(.set_correction, bladerf2_set_correction),
     FIELD_INIT(.trigger_init, bladerf2_trigger_init),
@@ -2846,7 +3135,14 @@ struct board_fns const bladerf2_board_fns = {
     FIELD_INIT(.sync_config, bladerf2_sync_config),
     FIELD_INIT(.sync_tx, bladerf2_sync_tx),
     FIELD_INIT(.sync_rx, bladerf2_sync_rx),
+    FIELD_INIT(.sync_txv, bladerf2_sync_txv),
+    FIELD_INIT(.sync_rxv, bladerf2_sync_rxv),
     FIELD_INIT(.get_timestamp, bladerf2_get_timestamp),
+    FIELD_INIT(.set_rx_overrun_recovery, bladerf2_set_rx_overrun_recovery),
+    FIELD_INIT(.get_rx_overrun, bladerf2_get_rx_overrun),
+    FIELD_INIT(.set_rx_history, bladerf2_set_rx_history),
+    FIELD_INIT(.sync_rx_at, bladerf2_sync_rx_at),
+    FIELD_INIT(.set_sync_dsp_threads, bladerf2_set_sync_dsp_threads),
     FIELD_INIT(.load_fpga, bladerf2_load_fpga),
     FIELD_INIT(.flash_fpga, bladerf2_flash_fpga),
     FIELD_INIT(.erase_stored_fpga, bladerf2_erase_stored_fpga),
@@ -2873,6 +3169,7 @@ struct board_fns const bladerf2_board_fns = {
     FIELD_INIT(.write_flash, bladerf2_write_flash),
     FIELD_INIT(.expansion_attach, bladerf2_expansion_attach),
     FIELD_INIT(.expansion_get_attached, bladerf2_expansion_get_attached),
+    FIELD_INIT(.read_telemetry, bladerf2_read_telemetry),
     FIELD_INIT(.name, "bladerf2"),
 };
 
@@ -2942,6 +3239,115 @@ int bladerf_set_bias_tee(struct bladerf *dev, bladerf_channel ch, bool enable)
 }
 
 
+/******************************************************************************/
+/* RX Decimation */
+/******************************************************************************/
+
+static int check_rx_decimation_cap(struct bladerf *dev)
+{
+    struct bladerf2_board_data *board_data = dev->board_data;
+
+    if (!have_cap(board_data->capabilities, BLADERF_CAP_RX_DECIMATION)) {
+        log_debug("This FPGA version (%u.%u.%u) does not support "
+                  "RX decimation.\n",
+                  board_data->fpga_version.major,
+                  board_data->fpga_version.minor,
+                  board_data->fpga_version.patch);
+
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
+    return 0;
+}
+
+int bladerf_set_rx_decimation(struct bladerf *dev,
+                              unsigned int factor,
+                              int32_t nco_offset)
+{
+    CHECK_BOARD_IS_BLADERF2(dev);
+    CHECK_BOARD_STATE(STATE_FPGA_LOADED);
+    CHECK_STATUS(check_rx_decimation_cap(dev));
+
+    struct bladerf2_board_data *board_data = dev->board_data;
+    unsigned int log2_factor               = 0;
+
+    while (log2_factor < RX_DECIM_LOG2_MAX && (1u << log2_factor) < factor) {
+        ++log2_factor;
+    }
+
+    if ((1u << log2_factor) != factor) {
+        log_debug("%s: invalid decimation factor: %u\n", __FUNCTION__, factor);
+        return BLADERF_ERR_INVAL;
+    }
+
+    WITH_MUTEX(&dev->lock, {
+        uint32_t reg = (uint32_t)log2_factor << RX_DECIM_LOG2_SHIFT;
+
+        if (nco_offset != 0) {
+            bladerf_sample_rate sr;
+            int64_t dphase;
+
+            CHECK_STATUS_LOCKED(dev->board->get_sample_rate(
+                dev, BLADERF_CHANNEL_RX(0), &sr));
+
+            if ((int64_t)nco_offset * 2 > (int64_t)sr ||
+                (int64_t)nco_offset * -2 > (int64_t)sr) {
+                log_debug("%s: NCO offset %d Hz exceeds sample rate %u Hz\n",
+                          __FUNCTION__, nco_offset, sr);
+                MUTEX_UNLOCK(&dev->lock);
+                return BLADERF_ERR_RANGE;
+            }
+
+            /* A positive offset shifts signals at +offset down to DC */
+            dphase = -__round_int64((double)nco_offset *
+                                    RX_DECIM_NCO_PHASE_STEPS / sr);
+
+            reg |= (uint32_t)dphase & RX_DECIM_NCO_DPHASE_MASK;
+            reg |= (1 << RX_DECIM_NCO_EN);
+        }
+
+        CHECK_STATUS_LOCKED(dev->backend->rx_decim_write(dev, reg));
+
+        board_data->rx_log2_decimation = log2_factor;
+    });
+
+    return 0;
+}
+
+int bladerf_get_rx_decimation(struct bladerf *dev,
+                              unsigned int *factor,
+                              int32_t *nco_offset)
+{
+    CHECK_BOARD_IS_BLADERF2(dev);
+    CHECK_BOARD_STATE(STATE_FPGA_LOADED);
+    NULL_CHECK(factor);
+    NULL_CHECK(nco_offset);
+    CHECK_STATUS(check_rx_decimation_cap(dev));
+
+    WITH_MUTEX(&dev->lock, {
+        uint32_t reg;
+
+        CHECK_STATUS_LOCKED(dev->backend->rx_decim_read(dev, &reg));
+
+        *factor     = 1u << ((reg >> RX_DECIM_LOG2_SHIFT) & RX_DECIM_LOG2_MASK);
+        *nco_offset = 0;
+
+        if (reg & (1 << RX_DECIM_NCO_EN)) {
+            bladerf_sample_rate sr;
+            int16_t dphase = (int16_t)(reg & RX_DECIM_NCO_DPHASE_MASK);
+
+            CHECK_STATUS_LOCKED(dev->board->get_sample_rate(
+                dev, BLADERF_CHANNEL_RX(0), &sr));
+
+            *nco_offset = -__round_int((double)dphase * sr /
+                                       RX_DECIM_NCO_PHASE_STEPS);
+        }
+    });
+
+    return 0;
+}
+
+
 /******************************************************************************/
 /* Low level RFIC Accessors */
 /******************************************************************************/
@@ -2974,12 +3380,17 @@ int bladerf_set_rfic_register(struct bladerf *dev,
     CHECK_BOARD_IS_BLADERF2(dev);
     CHECK_BOARD_STATE(STATE_FPGA_LOADED);
 
+    struct bladerf2_board_data *board_data = dev->board_data;
+
     WITH_MUTEX(&dev->lock, {
         uint64_t data = (((uint64_t)val) << 56);
 
         address |= (AD936X_WRITE | AD936X_CNT(1));
 
         CHECK_AD936X_LOCKED(dev->backend->ad9361_spi_write(dev, address, data));
+
+        profile_invalidate_all(dev);
+        rate_cache_invalidate(&board_data->rate_cache);
     });
 
     return 0;
@@ -3085,6 +3496,8 @@ int bladerf_set_rfic_rx_fir(struct bladerf *dev, bladerf_rfic_rxfir rxfir)
         }
 
         CHECK_STATUS_LOCKED(rfic->set_filter(dev, ch, rxfir, 0));
+
+        rate_cache_invalidate(&board_data->rate_cache);
     });
 
     return 0;
@@ -3133,6 +3546,8 @@ int bladerf_set_rfic_tx_fir(struct bladerf *dev, bladerf_rfic_txfir txfir)
         }
 
         CHECK_STATUS_LOCKED(rfic->set_filter(dev, ch, 0, txfir));
+
+        rate_cache_invalidate(&board_data->rate_cache);
     });
 
     return 0;
@@ -90,5 +90,11 @@ uint64_t bladerf2_get_fpga_capabilities(
         capabilities |= BLADERF_CAP_FPGA_TUNING;
     }
 
+    if (version_fields_greater_or_equal(fpga_version, 0, 11, 0)) {
+        capabilities |= BLADERF_CAP_PACKED_SAMPLES;
+        capabilities |= BLADERF_CAP_RX_DECIMATION;
+        capabilities |= BLADERF_CAP_RETUNE_CANCEL;
+    }
+
     return capabilities;
 }
@@ -25,6 +25,8 @@
 #include "capabilities.h"
 #include "common.h"
 
+#include "streaming/packing.h"
+
 
 /******************************************************************************/
 /* Constants */
@@ -100,6 +102,11 @@ int perform_format_config(struct bladerf *dev,
         return BLADERF_ERR_INVAL;
     }
 
+    if (use_timestamps && dev->wire_format[dir] != BLADERF_WIRE_FORMAT_SC16) {
+        log_debug("Packed wire formats do not support metadata.\n");
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
     CHECK_STATUS(dev->backend->config_gpio_read(dev, &gpio_val));
 
     if (use_timestamps) {
@@ -108,9 +115,12 @@ int perform_format_config(struct bladerf *dev,
         gpio_val &= ~BLADERF_GPIO_TIMESTAMP;
     }
 
+    gpio_val = wire_format_gpio(gpio_val, dir, dev->wire_format[dir]);
+
     CHECK_STATUS(dev->backend->config_gpio_write(dev, gpio_val));
 
     board_data->module_format[dir] = format;
+    dev->stream_configured[dir]    = true;
 
     return 0;
 }
@@ -125,6 +135,7 @@ int perform_format_deconfig(struct bladerf *dev, bladerf_direction dir)
             /* We'll reconfigure the HW when we call perform_format_config,
              * so we just need to update our stored information */
             board_data->module_format[dir] = -1;
+            dev->stream_configured[dir]    = false;
             break;
 
         default:
@@ -352,6 +363,48 @@ bool check_total_sample_rate(struct bladerf *dev)
     return true;
 }
 
+void rate_cache_invalidate(struct bladerf2_rate_cache *cache)
+{
+    cache->num_entries = 0;
+    cache->next        = 0;
+    cache->valid       = false;
+}
+
+struct bladerf2_rate_cache_entry const *rate_cache_lookup(
+    struct bladerf2_rate_cache const *cache,
+    bladerf_sample_rate requested,
+    bladerf_rfic_rxfir rxfir,
+    bladerf_rfic_txfir txfir)
+{
+    size_t i;
+
+    for (i = 0; i < cache->num_entries; ++i) {
+        struct bladerf2_rate_cache_entry const *e = &cache->entries[i];
+
+        if (e->requested == requested && e->rxfir == rxfir &&
+            e->txfir == txfir) {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+void rate_cache_insert(struct bladerf2_rate_cache *cache,
+                       struct bladerf2_rate_cache_entry const *entry)
+{
+    size_t i;
+
+    if (cache->num_entries < BLADERF2_RATE_CACHE_SIZE) {
+        i = cache->num_entries++;
+    } else {
+        i           = cache->next;
+        cache->next = (cache->next + 1) % BLADERF2_RATE_CACHE_SIZE;
+    }
+
+    cache->entries[i] = *entry;
+}
+
 bool does_rffe_dir_have_enabled_ch(uint32_t reg, bladerf_direction dir)
 {
     switch (dir) {
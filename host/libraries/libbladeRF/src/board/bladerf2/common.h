@@ -66,6 +66,15 @@ struct controller_fns {
                            bladerf_channel ch,
                            bladerf_sample_rate rate);
 
+    /* Read or directly program the RX and TX clock chains (BBPLL and
+     * dividers). NULL if the controller does not support it. */
+    int (*get_path_clks)(struct bladerf *dev,
+                         uint32_t rx_path_clks[NUM_RX_CLOCKS],
+                         uint32_t tx_path_clks[NUM_TX_CLOCKS]);
+    int (*set_path_clks)(struct bladerf *dev,
+                         uint32_t rx_path_clks[NUM_RX_CLOCKS],
+                         uint32_t tx_path_clks[NUM_TX_CLOCKS]);
+
     int (*get_frequency)(struct bladerf *dev,
                          bladerf_channel ch,
                          bladerf_frequency *frequency);
@@ -127,6 +136,56 @@ struct controller_fns {
     enum bladerf2_rfic_command_mode const command_mode;
 };
 
+/* Number of previously-configured sample rates remembered per device */
+#define BLADERF2_RATE_CACHE_SIZE 16
+
+/**
+ * A previously configured sample rate.
+ *
+ * The AD9361 clock chain that a rate resolves to depends on the FIR
+ * decimation/interpolation in effect when it is set, so entries are keyed on
+ * both.
+ */
+struct bladerf2_rate_cache_entry {
+    bladerf_sample_rate requested;
+    bladerf_rfic_rxfir rxfir;
+    bladerf_rfic_txfir txfir;
+
+    /* Rate the RFIC actually achieved */
+    bladerf_sample_rate actual;
+
+    /* Clock chain set up for this rate. Only meaningful if `have_clks` is
+     * true, which requires RFIC controller support. */
+    bool have_clks;
+    uint32_t rx_path_clks[NUM_RX_CLOCKS];
+    uint32_t tx_path_clks[NUM_TX_CLOCKS];
+};
+
+/**
+ * Sample rate configuration cache.
+ *
+ * Computing the AD9361 clock chain for a new rate, and reading back the
+ * resulting rate and FIR state, costs several round trips to the device. This
+ * cache remembers the clock chain and achieved rate for each previously
+ * requested sample rate, along with the configuration the RFIC was last left
+ * in. Returning to a known rate programs the saved clock chain directly, and
+ * rate changes only perform the RFIC operations that are actually required.
+ *
+ * The baseband calibrations that follow a clock chain change still run.
+ */
+struct bladerf2_rate_cache {
+    struct bladerf2_rate_cache_entry entries[BLADERF2_RATE_CACHE_SIZE];
+    size_t num_entries;
+    size_t next; /* Entry to replace once the cache is full */
+
+    /* Current RFIC configuration. Only meaningful if `valid` is true. */
+    bool valid;
+    bladerf_sample_rate requested;
+    bladerf_sample_rate actual;
+    bladerf_rfic_rxfir rxfir;
+    bladerf_rfic_txfir txfir;
+};
+
 struct bladerf2_board_data {
     /* Board state */
     enum {
@@ -178,6 +237,13 @@ struct bladerf2_board_data {
     bladerf_rfic_rxfir rxfir;
     bladerf_rfic_txfir txfir;
 
+    /* Sample rate configuration cache */
+    struct bladerf2_rate_cache rate_cache;
+
+    /* log2 of the FPGA RX decimation factor. RX timestamps are scaled down
+     * by this amount, to match those in RX metadata. */
+    unsigned int rx_log2_decimation;
+
     /* If true, RFIC control will be fully de-initialized on close, instead of
      * just put into a standby state. */
     bool rfic_reset_on_close;
@@ -461,6 +527,41 @@ bladerf_tuning_mode default_tuning_mode(struct bladerf *dev);
 
 bool check_total_sample_rate(struct bladerf *dev);
 
+/**
+ * Forget all cached sample rate configuration. This must be called whenever
+ * the RFIC's clock chain or FIR configuration is changed by anything other
+ * than bladerf2_set_sample_rate().
+ *
+ * @param       cache   Sample rate cache
+ */
+void rate_cache_invalidate(struct bladerf2_rate_cache *cache);
+
+/**
+ * Look up a previously configured sample rate
+ *
+ * @param[in]   cache       Sample rate cache
+ * @param[in]   requested   Requested sample rate
+ * @param[in]   rxfir       RX FIR setting in effect when the rate is set
+ * @param[in]   txfir       TX FIR setting in effect when the rate is set
+ *
+ * @return matching entry, or NULL if not found
+ */
+struct bladerf2_rate_cache_entry const *rate_cache_lookup(
+    struct bladerf2_rate_cache const *cache,
+    bladerf_sample_rate requested,
+    bladerf_rfic_rxfir rxfir,
+    bladerf_rfic_txfir txfir);
+
+/**
+ * Remember a configured sample rate, replacing the oldest entry if the cache
+ * is full
+ *
+ * @param       cache   Sample rate cache
+ * @param[in]   entry   Entry to copy into the cache
+ */
+void rate_cache_insert(struct bladerf2_rate_cache *cache,
+                       struct bladerf2_rate_cache_entry const *entry);
+
 bool does_rffe_dir_have_enabled_ch(uint32_t reg, bladerf_direction dir);
 
 int get_gain_offset(struct bladerf *dev, bladerf_channel ch, float *offset);
@@ -737,6 +737,10 @@ struct controller_fns const rfic_fpga_control = {
     FIELD_INIT(.get_sample_rate, _rfic_fpga_get_sample_rate),
     FIELD_INIT(.set_sample_rate, _rfic_fpga_set_sample_rate),
 
+    /* The NIOS RFIC command interface has no clock chain access */
+    FIELD_INIT(.get_path_clks, NULL),
+    FIELD_INIT(.set_path_clks, NULL),
+
     FIELD_INIT(.get_frequency, _rfic_fpga_get_frequency),
     FIELD_INIT(.set_frequency, _rfic_fpga_set_frequency),
     FIELD_INIT(.select_band, _rfic_fpga_select_band),
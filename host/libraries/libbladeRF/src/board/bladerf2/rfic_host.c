@@ -364,6 +364,30 @@ static int _rfic_host_set_sample_rate(struct bladerf *dev,
     return 0;
 }
 
+static int _rfic_host_get_path_clks(struct bladerf *dev,
+                                    uint32_t rx_path_clks[NUM_RX_CLOCKS],
+                                    uint32_t tx_path_clks[NUM_TX_CLOCKS])
+{
+    struct bladerf2_board_data *board_data = dev->board_data;
+    struct ad9361_rf_phy *phy              = board_data->phy;
+
+    CHECK_AD936X(ad9361_get_trx_path_clks(phy, rx_path_clks, tx_path_clks));
+
+    return 0;
+}
+
+static int _rfic_host_set_path_clks(struct bladerf *dev,
+                                    uint32_t rx_path_clks[NUM_RX_CLOCKS],
+                                    uint32_t tx_path_clks[NUM_TX_CLOCKS])
+{
+    struct bladerf2_board_data *board_data = dev->board_data;
+    struct ad9361_rf_phy *phy              = board_data->phy;
+
+    CHECK_AD936X(ad9361_set_trx_path_clks(phy, rx_path_clks, tx_path_clks));
+
+    return 0;
+}
+
 
 /******************************************************************************/
 /* Frequency */
@@ -967,6 +991,9 @@ struct controller_fns const rfic_host_control = {
     FIELD_INIT(.get_sample_rate, _rfic_host_get_sample_rate),
     FIELD_INIT(.set_sample_rate, _rfic_host_set_sample_rate),
 
+    FIELD_INIT(.get_path_clks, _rfic_host_get_path_clks),
+    FIELD_INIT(.set_path_clks, _rfic_host_set_path_clks),
+
     FIELD_INIT(.get_frequency, _rfic_host_get_frequency),
     FIELD_INIT(.set_frequency, _rfic_host_set_frequency),
     FIELD_INIT(.select_band, _rfic_host_select_band),
@@ -2,12 +2,20 @@
 
 #include "board.h"
 
+#include "backend/backend_config.h"
+
 extern const struct board_fns bladerf1_board_fns;
 extern const struct board_fns bladerf2_board_fns;
+#ifdef ENABLE_BACKEND_REPLAY
+extern const struct board_fns replay_board_fns;
+#endif
 
 const struct board_fns *bladerf_boards[] = {
     &bladerf1_board_fns,
     &bladerf2_board_fns,
+#ifdef ENABLE_BACKEND_REPLAY
+    &replay_board_fns,
+#endif
 };
 
 const unsigned int bladerf_boards_len = ARRAY_SIZE(bladerf_boards);
@@ -109,6 +109,22 @@
  */
 #define BLADERF_CAP_FPGA_TUNING (1 << 11)
 
+/**
+ * FPGA v0.11.0 introduced packed SC12 and SC8 sample wire formats
+ */
+#define BLADERF_CAP_PACKED_SAMPLES (1 << 12)
+
+/**
+ * FPGA v0.11.0 introduced the RX decimation chain on the bladeRF 2
+ */
+#define BLADERF_CAP_RX_DECIMATION (1 << 13)
+
+/**
+ * FPGA v0.11.0 introduced retune IDs, cancellation of scheduled retunes by ID,
+ * and reporting of retunes performed late
+ */
+#define BLADERF_CAP_RETUNE_CANCEL (1 << 14)
+
 /**
  * Firmware 1.7.1 introduced firmware-based loopback
  */
@@ -173,6 +189,32 @@ struct bladerf {
 
     /* XB's private data */
     void *xb_data;
+
+    /* Stream fault injection configuration. See streaming/faults.h. */
+    struct faults *faults;
+
+    /* Background telemetry sampler, if enabled. See helpers/telemetry.h. */
+    struct telemetry *telemetry;
+
+    /* Control thread for asynchronous operations, once started. See
+     * helpers/async_ctrl.h. */
+    struct async_ctrl *async_ctrl;
+
+    /* Most recently applied or captured configuration. See
+     * helpers/profile.h. */
+    struct bladerf_profile profile;
+
+    /* Wire format to use for each direction, indexed by bladerf_direction */
+    bladerf_wire_format wire_format[2];
+
+    /* Set while the FPGA is configured to stream in a direction (i.e., from
+     * sync_config() or the start of stream(), until the module is disabled
+     * or the stream ends). The wire format may not change in the meantime. */
+    bool stream_configured[2];
+
+    /* Scheduled retune statistics reported by the FPGA, indexed by
+     * bladerf_direction */
+    struct bladerf_retune_stats retune_stats[2];
 };
 
 struct board_fns {
@@ -298,8 +340,12 @@ struct board_fns {
                            bladerf_channel ch,
                            bladerf_timestamp timestamp,
                            bladerf_frequency frequency,
-                           struct bladerf_quick_tune *quick_tune);
+                           struct bladerf_quick_tune *quick_tune,
+                           uint8_t id);
     int (*cancel_scheduled_retunes)(struct bladerf *dev, bladerf_channel ch);
+    int (*cancel_scheduled_retunes_with_id)(struct bladerf *dev,
+                                            bladerf_channel ch,
+                                            uint8_t id);
 
     /* DC/Phase/Gain Correction */
     int (*get_correction)(struct bladerf *dev,
@@ -371,9 +417,33 @@ struct board_fns {
                    unsigned int num_samples,
                    struct bladerf_metadata *metadata,
                    unsigned int timeout_ms);
+    int (*sync_txv)(struct bladerf *dev,
+                    void const *const *samples,
+                    unsigned int num_samples,
+                    struct bladerf_metadata *metadata,
+                    unsigned int timeout_ms);
+    int (*sync_rxv)(struct bladerf *dev,
+                    void *const *samples,
+                    unsigned int num_samples,
+                    struct bladerf_metadata *metadata,
+                    unsigned int timeout_ms);
     int (*get_timestamp)(struct bladerf *dev,
                          bladerf_direction dir,
                          bladerf_timestamp *timestamp);
+    int (*set_rx_overrun_recovery)(struct bladerf *dev,
+                                   bladerf_rx_overrun_recovery mode);
+    int (*get_rx_overrun)(struct bladerf *dev,
+                          struct bladerf_rx_overrun *info);
+    int (*set_rx_history)(struct bladerf *dev, unsigned int length);
+    int (*sync_rx_at)(struct bladerf *dev,
+                      void *samples,
+                      unsigned int num_samples,
+                      bladerf_timestamp timestamp,
+                      struct bladerf_metadata *metadata,
+                      unsigned int timeout_ms);
+    int (*set_sync_dsp_threads)(struct bladerf *dev,
+                                bladerf_direction dir,
+                                unsigned int num_threads);
 
     /* FPGA/Firmware Loading/Flashing */
     int (*load_fpga)(struct bladerf *dev, const uint8_t *buf, size_t length);
@@ -440,6 +510,12 @@ struct board_fns {
     int (*expansion_attach)(struct bladerf *dev, bladerf_xb xb);
     int (*expansion_get_attached)(struct bladerf *dev, bladerf_xb *xb);
 
+    /* Telemetry. Reads a single BLADERF_TELEMETRY_* item, other than
+     * BLADERF_TELEMETRY_VCTCXO_TRIM, into the snapshot. */
+    int (*read_telemetry)(struct bladerf *dev,
+                          uint32_t item,
+                          struct bladerf_telemetry *telemetry);
+
     /* Board name */
     const char *name;
 };
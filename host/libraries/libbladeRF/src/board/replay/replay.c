@@ -0,0 +1,1358 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Sample file replay board
+ *
+ * The board half of the replay device (see backend/replay/replay.h). It has
+ * no radio: settings are simply stored and read back, and streaming is
+ * passed through to the async and sync interfaces, with the backend
+ * supplying and consuming the samples. Operations that require hardware
+ * return BLADERF_ERR_UNSUPPORTED.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libbladeRF.h>
+
+#include "host_config.h"
+
+#include "log.h"
+
+#include "board/board.h"
+
+#include "backend/replay/replay.h"
+
+#include "streaming/async.h"
+#include "streaming/sync.h"
+
+#define REPLAY_NUM_CHANNELS 2
+
+#define CHECK_CHANNEL(_ch)                                          \
+    do {                                                            \
+        if ((_ch) < 0 || ((_ch) >> 1) >= REPLAY_NUM_CHANNELS) {     \
+            log_debug("%s: invalid channel %d\n", __FUNCTION__, _ch); \
+            return BLADERF_ERR_INVAL;                               \
+        }                                                           \
+    } while (0)
+
+#define NULL_CHECK(_var)                                        \
+    do {                                                        \
+        if (NULL == (_var)) {                                   \
+            log_debug("%s: %s is null\n", __FUNCTION__, #_var); \
+            return BLADERF_ERR_INVAL;                           \
+        }                                                       \
+    } while (0)
+
+struct replay_channel {
+    bladerf_frequency frequency;
+    bladerf_bandwidth bandwidth;
+    bladerf_gain gain;
+    bladerf_gain_mode gain_mode;
+};
+
+struct replay_board_data {
+    /* Indexed by bladerf_channel */
+    struct replay_channel channels[2 * REPLAY_NUM_CHANNELS];
+
+    bladerf_loopback loopback;
+    bladerf_rx_mux rx_mux;
+    bladerf_tuning_mode tuning_mode;
+    uint32_t config_gpio;
+    uint16_t trim_dac;
+
+    struct bladerf_sync sync[2];
+};
+
+/******************************************************************************/
+/* Constants */
+/******************************************************************************/
+
+static const struct bladerf_range replay_frequency_range = {
+    FIELD_INIT(.min, 70000000),
+    FIELD_INIT(.max, 6000000000),
+    FIELD_INIT(.step, 2),
+    FIELD_INIT(.scale, 1),
+};
+
+static const struct bladerf_range replay_sample_rate_range = {
+    FIELD_INIT(.min, 520834),
+    FIELD_INIT(.max, 61440000),
+    FIELD_INIT(.step, 2),
+    FIELD_INIT(.scale, 1),
+};
+
+static const struct bladerf_range replay_bandwidth_range = {
+    FIELD_INIT(.min, 200000),
+    FIELD_INIT(.max, 56000000),
+    FIELD_INIT(.step, 1),
+    FIELD_INIT(.scale, 1),
+};
+
+static const struct bladerf_range replay_gain_range = {
+    FIELD_INIT(.min, 0),
+    FIELD_INIT(.max, 60),
+    FIELD_INIT(.step, 1),
+    FIELD_INIT(.scale, 1),
+};
+
+static const struct bladerf_gain_modes replay_gain_modes[] = {
+    {
+        FIELD_INIT(.name, "manual"),
+        FIELD_INIT(.mode, BLADERF_GAIN_MGC),
+    },
+};
+
+static const struct bladerf_loopback_modes replay_loopback_modes[] = {
+    {
+        FIELD_INIT(.name, "none"),
+        FIELD_INIT(.mode, BLADERF_LB_NONE),
+    },
+};
+
+static const char *replay_rf_port = "replay";
+
+static inline struct replay_channel *get_channel(struct bladerf *dev,
+                                                 bladerf_channel ch)
+{
+    struct replay_board_data *board_data = dev->board_data;
+    return &board_data->channels[ch];
+}
+
+static inline int64_t clamp_to_range(const struct bladerf_range *range,
+                                     int64_t value)
+{
+    if (value < range->min) {
+        return range->min;
+    } else if (value > range->max) {
+        return range->max;
+    }
+
+    return value;
+}
+
+/* Each channel's sample rate is kept in the first four parameter registers
+ * of the emulated Si5338's multisynth of the same index, so that raw
+ * register writes disturb it (see backend/replay/replay.h) */
+#define SI5338_MS_BASE(ch_) (53 + (ch_) * 11)
+
+static int store_sample_rate(struct bladerf *dev, bladerf_channel ch,
+                             bladerf_sample_rate rate)
+{
+    int i, status = 0;
+
+    for (i = 0; i < 4 && status == 0; i++) {
+        status = dev->backend->si5338_write(dev, SI5338_MS_BASE(ch) + i,
+                                            (uint8_t)(rate >> (8 * i)));
+    }
+
+    return status;
+}
+
+static int load_sample_rate(struct bladerf *dev, bladerf_channel ch,
+                            bladerf_sample_rate *rate)
+{
+    uint8_t val;
+    int i, status = 0;
+
+    *rate = 0;
+
+    for (i = 0; i < 4 && status == 0; i++) {
+        status = dev->backend->si5338_read(dev, SI5338_MS_BASE(ch) + i, &val);
+        *rate |= (bladerf_sample_rate)val << (8 * i);
+    }
+
+    return status;
+}
+
+/******************************************************************************/
+/* Open/close */
+/******************************************************************************/
+
+static bool replay_matches(struct bladerf *dev)
+{
+    return dev->backend == &backend_fns_replay;
+}
+
+static int replay_open(struct bladerf *dev, struct bladerf_devinfo *devinfo)
+{
+    struct replay_board_data *board_data;
+    size_t i;
+
+    board_data = calloc(1, sizeof(struct replay_board_data));
+    if (board_data == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(board_data->channels); i++) {
+        board_data->channels[i].frequency = 2400000000;
+        board_data->channels[i].bandwidth = 1000000;
+        board_data->channels[i].gain      = 0;
+        board_data->channels[i].gain_mode = BLADERF_GAIN_MGC;
+    }
+
+    board_data->loopback    = BLADERF_LB_NONE;
+    board_data->rx_mux      = BLADERF_RX_MUX_BASEBAND;
+    board_data->tuning_mode = BLADERF_TUNING_MODE_HOST;
+    board_data->trim_dac    = 0x8000;
+
+    dev->board_data = board_data;
+
+    for (i = 0; i < ARRAY_SIZE(board_data->channels); i++) {
+        store_sample_rate(dev, (bladerf_channel)i, 1000000);
+    }
+
+    return 0;
+}
+
+static void replay_close(struct bladerf *dev)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (board_data != NULL) {
+        sync_deinit(&board_data->sync[BLADERF_RX]);
+        sync_deinit(&board_data->sync[BLADERF_TX]);
+
+        free(board_data);
+        dev->board_data = NULL;
+    }
+}
+
+/******************************************************************************/
+/* Properties */
+/******************************************************************************/
+
+static bladerf_dev_speed replay_device_speed(struct bladerf *dev)
+{
+    return BLADERF_DEVICE_SPEED_SUPER;
+}
+
+static int replay_get_serial(struct bladerf *dev, char *serial)
+{
+    strncpy(serial, dev->ident.serial, BLADERF_SERIAL_LENGTH);
+    serial[BLADERF_SERIAL_LENGTH - 1] = '\0';
+
+    return 0;
+}
+
+static int replay_get_fpga_size(struct bladerf *dev, bladerf_fpga_size *size)
+{
+    *size = BLADERF_FPGA_UNKNOWN;
+    return 0;
+}
+
+static int replay_is_fpga_configured(struct bladerf *dev)
+{
+    return 1;
+}
+
+static int replay_get_fpga_source(struct bladerf *dev,
+                                  bladerf_fpga_source *source)
+{
+    *source = BLADERF_FPGA_SOURCE_UNKNOWN;
+    return 0;
+}
+
+static uint64_t replay_get_capabilities(struct bladerf *dev)
+{
+    return BLADERF_CAP_TIMESTAMPS | BLADERF_CAP_PACKED_SAMPLES;
+}
+
+static size_t replay_get_channel_count(struct bladerf *dev,
+                                       bladerf_direction dir)
+{
+    return REPLAY_NUM_CHANNELS;
+}
+
+/******************************************************************************/
+/* Versions */
+/******************************************************************************/
+
+static int replay_get_version(struct bladerf *dev,
+                              struct bladerf_version *version)
+{
+    version->major    = 0;
+    version->minor    = 0;
+    version->patch    = 0;
+    version->describe = "replay";
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Gain */
+/******************************************************************************/
+
+static int replay_set_gain(struct bladerf *dev,
+                           bladerf_channel ch,
+                           bladerf_gain gain)
+{
+    CHECK_CHANNEL(ch);
+
+    get_channel(dev, ch)->gain =
+        (bladerf_gain)clamp_to_range(&replay_gain_range, gain);
+
+    return 0;
+}
+
+static int replay_get_gain(struct bladerf *dev,
+                           bladerf_channel ch,
+                           bladerf_gain *gain)
+{
+    CHECK_CHANNEL(ch);
+    NULL_CHECK(gain);
+
+    *gain = get_channel(dev, ch)->gain;
+
+    return 0;
+}
+
+static int replay_set_gain_mode(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_gain_mode mode)
+{
+    CHECK_CHANNEL(ch);
+
+    get_channel(dev, ch)->gain_mode = mode;
+
+    return 0;
+}
+
+static int replay_get_gain_mode(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_gain_mode *mode)
+{
+    CHECK_CHANNEL(ch);
+    NULL_CHECK(mode);
+
+    *mode = get_channel(dev, ch)->gain_mode;
+
+    return 0;
+}
+
+static int replay_get_gain_modes(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 const struct bladerf_gain_modes **modes)
+{
+    if (modes != NULL) {
+        *modes = replay_gain_modes;
+    }
+
+    return ARRAY_SIZE(replay_gain_modes);
+}
+
+static int replay_get_gain_range(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 const struct bladerf_range **range)
+{
+    NULL_CHECK(range);
+
+    *range = &replay_gain_range;
+
+    return 0;
+}
+
+static int replay_set_gain_stage(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 const char *stage,
+                                 bladerf_gain gain)
+{
+    return replay_set_gain(dev, ch, gain);
+}
+
+static int replay_get_gain_stage(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 const char *stage,
+                                 bladerf_gain *gain)
+{
+    return replay_get_gain(dev, ch, gain);
+}
+
+static int replay_get_gain_stage_range(struct bladerf *dev,
+                                       bladerf_channel ch,
+                                       const char *stage,
+                                       const struct bladerf_range **range)
+{
+    return replay_get_gain_range(dev, ch, range);
+}
+
+static int replay_get_gain_stages(struct bladerf *dev,
+                                  bladerf_channel ch,
+                                  const char **stages,
+                                  size_t count)
+{
+    if (stages != NULL && count > 0) {
+        stages[0] = "full";
+    }
+
+    return 1;
+}
+
+/******************************************************************************/
+/* Sample Rate */
+/******************************************************************************/
+
+static int replay_set_sample_rate(struct bladerf *dev,
+                                  bladerf_channel ch,
+                                  bladerf_sample_rate rate,
+                                  bladerf_sample_rate *actual)
+{
+    int status;
+
+    CHECK_CHANNEL(ch);
+
+    rate = (bladerf_sample_rate)clamp_to_range(&replay_sample_rate_range,
+                                               rate);
+
+    status = store_sample_rate(dev, ch, rate);
+    if (status == 0 && actual != NULL) {
+        *actual = rate;
+    }
+
+    return status;
+}
+
+static int replay_set_rational_sample_rate(struct bladerf *dev,
+                                           bladerf_channel ch,
+                                           struct bladerf_rational_rate *rate,
+                                           struct bladerf_rational_rate *actual)
+{
+    bladerf_sample_rate integer_rate;
+    int status;
+
+    NULL_CHECK(rate);
+
+    status = replay_set_sample_rate(dev, ch, (bladerf_sample_rate)rate->integer,
+                                    &integer_rate);
+    if (status == 0 && actual != NULL) {
+        actual->integer = integer_rate;
+        actual->num     = 0;
+        actual->den     = 1;
+    }
+
+    return status;
+}
+
+static int replay_get_sample_rate(struct bladerf *dev,
+                                  bladerf_channel ch,
+                                  bladerf_sample_rate *rate)
+{
+    CHECK_CHANNEL(ch);
+    NULL_CHECK(rate);
+
+    return load_sample_rate(dev, ch, rate);
+}
+
+static int replay_get_sample_rate_range(struct bladerf *dev,
+                                        bladerf_channel ch,
+                                        const struct bladerf_range **range)
+{
+    NULL_CHECK(range);
+
+    *range = &replay_sample_rate_range;
+
+    return 0;
+}
+
+static int replay_get_rational_sample_rate(struct bladerf *dev,
+                                           bladerf_channel ch,
+                                           struct bladerf_rational_rate *rate)
+{
+    bladerf_sample_rate integer_rate;
+    int status;
+
+    NULL_CHECK(rate);
+
+    status = replay_get_sample_rate(dev, ch, &integer_rate);
+    if (status == 0) {
+        rate->integer = integer_rate;
+        rate->num     = 0;
+        rate->den     = 1;
+    }
+
+    return status;
+}
+
+/******************************************************************************/
+/* Bandwidth */
+/******************************************************************************/
+
+static int replay_set_bandwidth(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_bandwidth bandwidth,
+                                bladerf_bandwidth *actual)
+{
+    struct replay_channel *c;
+
+    CHECK_CHANNEL(ch);
+
+    c            = get_channel(dev, ch);
+    c->bandwidth = (bladerf_bandwidth)clamp_to_range(&replay_bandwidth_range,
+                                                     bandwidth);
+
+    if (actual != NULL) {
+        *actual = c->bandwidth;
+    }
+
+    return 0;
+}
+
+static int replay_get_bandwidth(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_bandwidth *bandwidth)
+{
+    CHECK_CHANNEL(ch);
+    NULL_CHECK(bandwidth);
+
+    *bandwidth = get_channel(dev, ch)->bandwidth;
+
+    return 0;
+}
+
+static int replay_get_bandwidth_range(struct bladerf *dev,
+                                      bladerf_channel ch,
+                                      const struct bladerf_range **range)
+{
+    NULL_CHECK(range);
+
+    *range = &replay_bandwidth_range;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Frequency */
+/******************************************************************************/
+
+static int replay_get_frequency(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_frequency *frequency)
+{
+    CHECK_CHANNEL(ch);
+    NULL_CHECK(frequency);
+
+    *frequency = get_channel(dev, ch)->frequency;
+
+    return 0;
+}
+
+static int replay_set_frequency(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_frequency frequency)
+{
+    CHECK_CHANNEL(ch);
+
+    if ((int64_t)frequency < replay_frequency_range.min ||
+        (int64_t)frequency > replay_frequency_range.max) {
+        return BLADERF_ERR_RANGE;
+    }
+
+    get_channel(dev, ch)->frequency = frequency;
+
+    return 0;
+}
+
+static int replay_get_frequency_range(struct bladerf *dev,
+                                      bladerf_channel ch,
+                                      const struct bladerf_range **range)
+{
+    NULL_CHECK(range);
+
+    *range = &replay_frequency_range;
+
+    return 0;
+}
+
+static int replay_select_band(struct bladerf *dev,
+                              bladerf_channel ch,
+                              bladerf_frequency frequency)
+{
+    return 0;
+}
+
+/******************************************************************************/
+/* RF Ports */
+/******************************************************************************/
+
+static int replay_set_rf_port(struct bladerf *dev,
+                              bladerf_channel ch,
+                              const char *port)
+{
+    NULL_CHECK(port);
+
+    if (strcmp(port, replay_rf_port) != 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return 0;
+}
+
+static int replay_get_rf_port(struct bladerf *dev,
+                              bladerf_channel ch,
+                              const char **port)
+{
+    NULL_CHECK(port);
+
+    *port = replay_rf_port;
+
+    return 0;
+}
+
+static int replay_get_rf_ports(struct bladerf *dev,
+                               bladerf_channel ch,
+                               const char **ports,
+                               unsigned int count)
+{
+    if (ports != NULL && count > 0) {
+        ports[0] = replay_rf_port;
+    }
+
+    return 1;
+}
+
+/******************************************************************************/
+/* Streaming */
+/******************************************************************************/
+
+static int replay_enable_module(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bool enable)
+{
+    CHECK_CHANNEL(ch);
+
+    return dev->backend->enable_module(dev, BLADERF_CHANNEL_IS_TX(ch)
+                                                ? BLADERF_TX
+                                                : BLADERF_RX,
+                                       enable);
+}
+
+/* The replay backend produces and consumes plain SC16 Q11 data. */
+static int check_format(bladerf_format format)
+{
+    switch (format) {
+        case BLADERF_FORMAT_SC16_Q11:
+        case BLADERF_FORMAT_SC16_Q11_META:
+            return 0;
+
+        default:
+            log_debug("Format %d is not supported by the replay board.\n",
+                      format);
+            return BLADERF_ERR_UNSUPPORTED;
+    }
+}
+
+static int replay_init_stream(struct bladerf_stream **stream,
+                              struct bladerf *dev,
+                              bladerf_stream_cb callback,
+                              void ***buffers,
+                              size_t num_buffers,
+                              bladerf_format format,
+                              size_t samples_per_buffer,
+                              size_t num_transfers,
+                              void *user_data)
+{
+    int status;
+
+    status = check_format(format);
+    if (status != 0) {
+        return status;
+    }
+
+    return async_init_stream(stream, dev, callback, buffers, num_buffers,
+                             format, samples_per_buffer, num_transfers,
+                             user_data);
+}
+
+static int replay_stream(struct bladerf_stream *stream,
+                         bladerf_channel_layout layout)
+{
+    switch (layout) {
+        case BLADERF_RX_X1:
+        case BLADERF_RX_X2:
+        case BLADERF_TX_X1:
+        case BLADERF_TX_X2:
+            break;
+        default:
+            return BLADERF_ERR_INVAL;
+    }
+
+    return async_run_stream(stream, layout);
+}
+
+static int replay_submit_stream_buffer(struct bladerf_stream *stream,
+                                       void *buffer,
+                                       unsigned int timeout_ms,
+                                       bool nonblock)
+{
+    return async_submit_stream_buffer(stream, buffer, timeout_ms, nonblock);
+}
+
+static void replay_deinit_stream(struct bladerf_stream *stream)
+{
+    async_deinit_stream(stream);
+}
+
+static int replay_set_stream_timeout(struct bladerf *dev,
+                                     bladerf_direction dir,
+                                     unsigned int timeout)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    MUTEX_LOCK(&board_data->sync[dir].lock);
+    board_data->sync[dir].stream_config.timeout_ms = timeout;
+    MUTEX_UNLOCK(&board_data->sync[dir].lock);
+
+    return 0;
+}
+
+static int replay_get_stream_timeout(struct bladerf *dev,
+                                     bladerf_direction dir,
+                                     unsigned int *timeout)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(timeout);
+
+    MUTEX_LOCK(&board_data->sync[dir].lock);
+    *timeout = board_data->sync[dir].stream_config.timeout_ms;
+    MUTEX_UNLOCK(&board_data->sync[dir].lock);
+
+    return 0;
+}
+
+static int replay_sync_config(struct bladerf *dev,
+                              bladerf_channel_layout layout,
+                              bladerf_format format,
+                              unsigned int num_buffers,
+                              unsigned int buffer_size,
+                              unsigned int num_transfers,
+                              unsigned int stream_timeout)
+{
+    struct replay_board_data *board_data = dev->board_data;
+    bladerf_direction dir                = layout & BLADERF_DIRECTION_MASK;
+    int status;
+
+    switch (layout) {
+        case BLADERF_RX_X1:
+        case BLADERF_RX_X2:
+        case BLADERF_TX_X1:
+        case BLADERF_TX_X2:
+            break;
+        default:
+            return BLADERF_ERR_INVAL;
+    }
+
+    status = check_format(format);
+    if (status != 0) {
+        return status;
+    }
+
+    return sync_init(&board_data->sync[dir], dev, layout, format, num_buffers,
+                     buffer_size, replay_msg_size(dev), num_transfers,
+                     stream_timeout);
+}
+
+static int replay_sync_tx(struct bladerf *dev,
+                          void const *samples,
+                          unsigned int num_samples,
+                          struct bladerf_metadata *metadata,
+                          unsigned int timeout_ms)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_TX].initialized) {
+        log_debug("%s: sync tx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_tx(&board_data->sync[BLADERF_TX], samples, num_samples,
+                   metadata, timeout_ms);
+}
+
+static int replay_sync_rx(struct bladerf *dev,
+                          void *samples,
+                          unsigned int num_samples,
+                          struct bladerf_metadata *metadata,
+                          unsigned int timeout_ms)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        log_debug("%s: sync rx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_rx(&board_data->sync[BLADERF_RX], samples, num_samples,
+                   metadata, timeout_ms);
+}
+
+static int replay_sync_txv(struct bladerf *dev,
+                           void const *const *samples,
+                           unsigned int num_samples,
+                           struct bladerf_metadata *metadata,
+                           unsigned int timeout_ms)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_TX].initialized) {
+        log_debug("%s: sync tx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_txv(&board_data->sync[BLADERF_TX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
+static int replay_sync_rxv(struct bladerf *dev,
+                           void *const *samples,
+                           unsigned int num_samples,
+                           struct bladerf_metadata *metadata,
+                           unsigned int timeout_ms)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        log_debug("%s: sync rx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_rxv(&board_data->sync[BLADERF_RX], samples, num_samples,
+                    metadata, timeout_ms);
+}
+
+static int replay_get_timestamp(struct bladerf *dev,
+                                bladerf_direction dir,
+                                bladerf_timestamp *value)
+{
+    NULL_CHECK(value);
+
+    return dev->backend->get_timestamp(dev, dir, value);
+}
+
+static int replay_set_rx_overrun_recovery(struct bladerf *dev,
+                                          bladerf_rx_overrun_recovery mode)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    return sync_set_rx_overrun_recovery(&board_data->sync[BLADERF_RX], mode);
+}
+
+static int replay_get_rx_overrun(struct bladerf *dev,
+                                 struct bladerf_rx_overrun *info)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(info);
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        log_debug("%s: sync rx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_get_rx_overrun(&board_data->sync[BLADERF_RX], info);
+}
+
+static int replay_set_rx_history(struct bladerf *dev, unsigned int length)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    return sync_set_rx_history(&board_data->sync[BLADERF_RX], length);
+}
+
+static int replay_sync_rx_at(struct bladerf *dev,
+                             void *samples,
+                             unsigned int num_samples,
+                             bladerf_timestamp timestamp,
+                             struct bladerf_metadata *metadata,
+                             unsigned int timeout_ms)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (!board_data->sync[BLADERF_RX].initialized) {
+        log_debug("%s: sync rx not initialized\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_rx_at(&board_data->sync[BLADERF_RX], samples, num_samples,
+                      timestamp, metadata, timeout_ms);
+}
+
+static int replay_set_sync_dsp_threads(struct bladerf *dev,
+                                       bladerf_direction dir,
+                                       unsigned int num_threads)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (dir != BLADERF_RX && dir != BLADERF_TX) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return sync_set_dsp_threads(&board_data->sync[dir], num_threads);
+}
+
+/******************************************************************************/
+/* Tuning mode */
+/******************************************************************************/
+
+static int replay_set_tuning_mode(struct bladerf *dev, bladerf_tuning_mode mode)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    board_data->tuning_mode = mode;
+
+    return 0;
+}
+
+static int replay_get_tuning_mode(struct bladerf *dev,
+                                  bladerf_tuning_mode *mode)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(mode);
+
+    *mode = board_data->tuning_mode;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Loopback */
+/******************************************************************************/
+
+static int replay_get_loopback_modes(
+    struct bladerf *dev, const struct bladerf_loopback_modes **modes)
+{
+    if (modes != NULL) {
+        *modes = replay_loopback_modes;
+    }
+
+    return ARRAY_SIZE(replay_loopback_modes);
+}
+
+static int replay_set_loopback(struct bladerf *dev, bladerf_loopback l)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (l != BLADERF_LB_NONE) {
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
+    board_data->loopback = l;
+
+    return 0;
+}
+
+static int replay_get_loopback(struct bladerf *dev, bladerf_loopback *l)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(l);
+
+    *l = board_data->loopback;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Sample RX FPGA Mux */
+/******************************************************************************/
+
+static int replay_get_rx_mux(struct bladerf *dev, bladerf_rx_mux *mode)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(mode);
+
+    *mode = board_data->rx_mux;
+
+    return 0;
+}
+
+static int replay_set_rx_mux(struct bladerf *dev, bladerf_rx_mux mode)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    if (mode != BLADERF_RX_MUX_BASEBAND) {
+        return BLADERF_ERR_UNSUPPORTED;
+    }
+
+    board_data->rx_mux = mode;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Low-level Configuration GPIO access */
+/******************************************************************************/
+
+static int replay_config_gpio_read(struct bladerf *dev, uint32_t *val)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(val);
+
+    *val = board_data->config_gpio;
+
+    return 0;
+}
+
+static int replay_config_gpio_write(struct bladerf *dev, uint32_t val)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    board_data->config_gpio = val;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* VCTCXO trim DAC */
+/******************************************************************************/
+
+static int replay_trim_dac_read(struct bladerf *dev, uint16_t *trim)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    NULL_CHECK(trim);
+
+    *trim = board_data->trim_dac;
+
+    return 0;
+}
+
+static int replay_trim_dac_write(struct bladerf *dev, uint16_t trim)
+{
+    struct replay_board_data *board_data = dev->board_data;
+
+    board_data->trim_dac = trim;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Expansion support */
+/******************************************************************************/
+
+static int replay_expansion_get_attached(struct bladerf *dev, bladerf_xb *xb)
+{
+    NULL_CHECK(xb);
+
+    *xb = BLADERF_XB_NONE;
+
+    return 0;
+}
+
+static int replay_read_telemetry(struct bladerf *dev,
+                                 uint32_t item,
+                                 struct bladerf_telemetry *telemetry)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+/******************************************************************************/
+/* Operations that require hardware */
+/******************************************************************************/
+
+static int replay_get_fpga_bytes(struct bladerf *dev, size_t *size)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_flash_size(struct bladerf *dev,
+                                 uint32_t *size,
+                                 bool *is_guess)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_quick_tune(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 struct bladerf_quick_tune *quick_tune)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_schedule_retune(struct bladerf *dev,
+                                  bladerf_channel ch,
+                                  bladerf_timestamp timestamp,
+                                  bladerf_frequency frequency,
+                                  struct bladerf_quick_tune *quick_tune,
+                                  uint8_t id)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_cancel_scheduled_retunes(struct bladerf *dev,
+                                           bladerf_channel ch)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_cancel_scheduled_retunes_with_id(struct bladerf *dev,
+                                                   bladerf_channel ch,
+                                                   uint8_t id)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_correction(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 bladerf_correction corr,
+                                 int16_t *value)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_set_correction(struct bladerf *dev,
+                                 bladerf_channel ch,
+                                 bladerf_correction corr,
+                                 int16_t value)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_trigger_init(struct bladerf *dev,
+                               bladerf_channel ch,
+                               bladerf_trigger_signal signal,
+                               struct bladerf_trigger *trigger)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_trigger_arm(struct bladerf *dev,
+                              const struct bladerf_trigger *trigger,
+                              bool arm,
+                              uint64_t resv1,
+                              uint64_t resv2)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_trigger_fire(struct bladerf *dev,
+                               const struct bladerf_trigger *trigger)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_trigger_state(struct bladerf *dev,
+                                const struct bladerf_trigger *trigger,
+                                bool *is_armed,
+                                bool *has_fired,
+                                bool *fire_requested,
+                                uint64_t *resv1,
+                                uint64_t *resv2)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_load_fpga(struct bladerf *dev,
+                            const uint8_t *buf,
+                            size_t length)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_flash_fpga(struct bladerf *dev,
+                             const uint8_t *buf,
+                             size_t length)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_erase_stored_fpga(struct bladerf *dev)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_flash_firmware(struct bladerf *dev,
+                                 const uint8_t *buf,
+                                 size_t length)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_device_reset(struct bladerf *dev)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_set_vctcxo_tamer_mode(struct bladerf *dev,
+                                        bladerf_vctcxo_tamer_mode mode)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_vctcxo_tamer_mode(struct bladerf *dev,
+                                        bladerf_vctcxo_tamer_mode *mode)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_get_vctcxo_trim(struct bladerf *dev, uint16_t *trim)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_read_trigger(struct bladerf *dev,
+                               bladerf_channel ch,
+                               bladerf_trigger_signal trigger,
+                               uint8_t *val)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_write_trigger(struct bladerf *dev,
+                                bladerf_channel ch,
+                                bladerf_trigger_signal trigger,
+                                uint8_t val)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_erase_flash(struct bladerf *dev,
+                              uint32_t erase_block,
+                              uint32_t count)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_read_flash(struct bladerf *dev,
+                             uint8_t *buf,
+                             uint32_t page,
+                             uint32_t count)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_write_flash(struct bladerf *dev,
+                              const uint8_t *buf,
+                              uint32_t page,
+                              uint32_t count)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static int replay_expansion_attach(struct bladerf *dev, bladerf_xb xb)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+/******************************************************************************/
+/* Board binding */
+/******************************************************************************/
+
+struct board_fns const replay_board_fns = {
+    FIELD_INIT(.matches, replay_matches),
+    FIELD_INIT(.open, replay_open),
+    FIELD_INIT(.close, replay_close),
+    FIELD_INIT(.device_speed, replay_device_speed),
+    FIELD_INIT(.get_serial, replay_get_serial),
+    FIELD_INIT(.get_fpga_size, replay_get_fpga_size),
+    FIELD_INIT(.get_fpga_bytes, replay_get_fpga_bytes),
+    FIELD_INIT(.get_flash_size, replay_get_flash_size),
+    FIELD_INIT(.is_fpga_configured, replay_is_fpga_configured),
+    FIELD_INIT(.get_fpga_source, replay_get_fpga_source),
+    FIELD_INIT(.get_capabilities, replay_get_capabilities),
+    FIELD_INIT(.get_channel_count, replay_get_channel_count),
+    FIELD_INIT(.get_fpga_version, replay_get_version),
+    FIELD_INIT(.get_fw_version, replay_get_version),
+    FIELD_INIT(.set_gain, replay_set_gain),
+    FIELD_INIT(.get_gain, replay_get_gain),
+    FIELD_INIT(.set_gain_mode, replay_set_gain_mode),
+    FIELD_INIT(.get_gain_mode, replay_get_gain_mode),
+    FIELD_INIT(.get_gain_modes, replay_get_gain_modes),
+    FIELD_INIT(.get_gain_range, replay_get_gain_range),
+    FIELD_INIT(.set_gain_stage, replay_set_gain_stage),
+    FIELD_INIT(.get_gain_stage, replay_get_gain_stage),
+    FIELD_INIT(.get_gain_stage_range, replay_get_gain_stage_range),
+    FIELD_INIT(.get_gain_stages, replay_get_gain_stages),
+    FIELD_INIT(.set_sample_rate, replay_set_sample_rate),
+    FIELD_INIT(.set_rational_sample_rate, replay_set_rational_sample_rate),
+    FIELD_INIT(.get_sample_rate, replay_get_sample_rate),
+    FIELD_INIT(.get_sample_rate_range, replay_get_sample_rate_range),
+    FIELD_INIT(.get_rational_sample_rate, replay_get_rational_sample_rate),
+    FIELD_INIT(.set_bandwidth, replay_set_bandwidth),
+    FIELD_INIT(.get_bandwidth, replay_get_bandwidth),
+    FIELD_INIT(.get_bandwidth_range, replay_get_bandwidth_range),
+    FIELD_INIT(.get_frequency, replay_get_frequency),
+    FIELD_INIT(.set_frequency, replay_set_frequency),
+    FIELD_INIT(.get_frequency_range, replay_get_frequency_range),
+    FIELD_INIT(.select_band, replay_select_band),
+    FIELD_INIT(.set_rf_port, replay_set_rf_port),
+    FIELD_INIT(.get_rf_port, replay_get_rf_port),
+    FIELD_INIT(.get_rf_ports, replay_get_rf_ports),
+    FIELD_INIT(.get_quick_tune, replay_get_quick_tune),
+    FIELD_INIT(.schedule_retune, replay_schedule_retune),
+    FIELD_INIT(.cancel_scheduled_retunes, replay_cancel_scheduled_retunes),
+    FIELD_INIT(.cancel_scheduled_retunes_with_id, replay_cancel_scheduled_retunes_with_id),
+    FIELD_INIT(.get_correction, replay_get_correction),
+    FIELD_INIT(.set_correction, replay_set_correction),
+    FIELD_INIT(.trigger_init, replay_trigger_init),
+    FIELD_INIT(.trigger_arm, replay_trigger_arm),
+    FIELD_INIT(.trigger_fire, replay_trigger_fire),
+    FIELD_INIT(.trigger_state, replay_trigger_state),
+    FIELD_INIT(.enable_module, replay_enable_module),
+    FIELD_INIT(.init_stream, replay_init_stream),
+    FIELD_INIT(.stream, replay_stream),
+    FIELD_INIT(.submit_stream_buffer, replay_submit_stream_buffer),
+    FIELD_INIT(.deinit_stream, replay_deinit_stream),
+    FIELD_INIT(.set_stream_timeout, replay_set_stream_timeout),
+    FIELD_INIT(.get_stream_timeout, replay_get_stream_timeout),
+    FIELD_INIT(.sync_config, replay_sync_config),
+    FIELD_INIT(.sync_tx, replay_sync_tx),
+    FIELD_INIT(.sync_rx, replay_sync_rx),
+    FIELD_INIT(.sync_txv, replay_sync_txv),
+    FIELD_INIT(.sync_rxv, replay_sync_rxv),
+    FIELD_INIT(.get_timestamp, replay_get_timestamp),
+    FIELD_INIT(.set_rx_overrun_recovery, replay_set_rx_overrun_recovery),
+    FIELD_INIT(.get_rx_overrun, replay_get_rx_overrun),
+    FIELD_INIT(.set_rx_history, replay_set_rx_history),
+    FIELD_INIT(.sync_rx_at, replay_sync_rx_at),
+    FIELD_INIT(.set_sync_dsp_threads, replay_set_sync_dsp_threads),
+    FIELD_INIT(.load_fpga, replay_load_fpga),
+    FIELD_INIT(.flash_fpga, replay_flash_fpga),
+    FIELD_INIT(.erase_stored_fpga, replay_erase_stored_fpga),
+    FIELD_INIT(.flash_firmware, replay_flash_firmware),
+    FIELD_INIT(.device_reset, replay_device_reset),
+    FIELD_INIT(.set_tuning_mode, replay_set_tuning_mode),
+    FIELD_INIT(.get_tuning_mode, replay_get_tuning_mode),
+    FIELD_INIT(.get_loopback_modes, replay_get_loopback_modes),
+    FIELD_INIT(.set_loopback, replay_set_loopback),
+    FIELD_INIT(.get_loopback, replay_get_loopback),
+    FIELD_INIT(.get_rx_mux, replay_get_rx_mux),
+    FIELD_INIT(.set_rx_mux, replay_set_rx_mux),
+    FIELD_INIT(.set_vctcxo_tamer_mode, replay_set_vctcxo_tamer_mode),
+    FIELD_INIT(.get_vctcxo_tamer_mode, replay_get_vctcxo_tamer_mode),
+    FIELD_INIT(.get_vctcxo_trim, replay_get_vctcxo_trim),
+    FIELD_INIT(.trim_dac_read, replay_trim_dac_read),
+    FIELD_INIT(.trim_dac_write, replay_trim_dac_write),
+    FIELD_INIT(.read_trigger, replay_read_trigger),
+    FIELD_INIT(.write_trigger, replay_write_trigger),
+    FIELD_INIT(.config_gpio_read, replay_config_gpio_read),
+    FIELD_INIT(.config_gpio_write, replay_config_gpio_write),
+    FIELD_INIT(.erase_flash, replay_erase_flash),
+    FIELD_INIT(.read_flash, replay_read_flash),
+    FIELD_INIT(.write_flash, replay_write_flash),
+    FIELD_INIT(.expansion_attach, replay_expansion_attach),
+    FIELD_INIT(.expansion_get_attached, replay_expansion_get_attached),
+    FIELD_INIT(.read_telemetry, replay_read_telemetry),
+    FIELD_INIT(.name, "replay"),
+};
@@ -219,36 +219,72 @@ static void si5338_pack_regs(struct si5338_multisynth *ms)
     return ;
 }
 
+/**
+ * Write a multisynth's configuration to the device. When a shadow of the
+ * previously written values is provided, the enable and R divider registers,
+ * as well as the parameter block, are skipped if they already hold the
+ * desired values.
+ *
+ * The parameter registers are only ever written as a whole block, in order.
+ * The part applies new parameters upon the write of the block's last
+ * register, and would otherwise run with a mix of old and new values.
+ */
 static int si5338_write_multisynth(struct bladerf *dev,
+                                   struct si5338_shadow *shadow,
                                    struct si5338_multisynth *ms)
 {
+    struct si5338_shadow prev;
     int i, status;
     uint8_t r_power, r_count, val;
 
     log_verbose("Writing MS%d\n", ms->index);
 
-    /* Write out the enables */
-    status = dev->backend->si5338_read(dev, 36 + ms->index, &val);
-    if (status < 0) {
-        si5338_log_read_error(status, bladerf_strerror(status));
-        return status;
-    }
-    val |= ms->enable;
-    log_verbose("Wrote enable register: 0x%2.2x\n", val);
-    status = dev->backend->si5338_write(dev, 36 + ms->index, val);
-    if (status < 0) {
-        si5338_log_write_error(status, bladerf_strerror(status));
-        return status;
+    if (shadow != NULL) {
+        prev = *shadow;
+
+        /* Until all writes succeed, the device's state is unknown */
+        shadow->valid = false;
+    } else {
+        prev.valid = false;
     }
 
-    /* Write out the registers */
-    for (i = 0 ; i < 10 ; i++) {
-        status = dev->backend->si5338_write(dev, ms->base + i, *(ms->regs+i));
+    /* Write out the enables */
+    if (!prev.valid || (prev.enable & ms->enable) != ms->enable) {
+        status = dev->backend->si5338_read(dev, 36 + ms->index, &val);
+        if (status < 0) {
+            si5338_log_read_error(status, bladerf_strerror(status));
+            return status;
+        }
+        val |= ms->enable;
+        log_verbose("Wrote enable register: 0x%2.2x\n", val);
+        status = dev->backend->si5338_write(dev, 36 + ms->index, val);
         if (status < 0) {
             si5338_log_write_error(status, bladerf_strerror(status));
             return status;
         }
-        log_verbose("Wrote regs[%d]: 0x%2.2x\n", i, *(ms->regs+i));
+    } else {
+        val = prev.enable;
+    }
+
+    if (shadow != NULL) {
+        shadow->enable = val;
+    }
+
+    /* Write out the registers */
+    if (!prev.valid || memcmp(prev.regs, ms->regs, sizeof(ms->regs)) != 0) {
+        for (i = 0 ; i < SI5338_MS_NUM_REGS ; i++) {
+            status = dev->backend->si5338_write(dev, ms->base + i,
+                                                *(ms->regs+i));
+            if (status < 0) {
+                si5338_log_write_error(status, bladerf_strerror(status));
+                return status;
+            }
+            log_verbose("Wrote regs[%d]: 0x%2.2x\n", i, *(ms->regs+i));
+        }
+    }
+
+    if (shadow != NULL) {
+        memcpy(shadow->regs, ms->regs, sizeof(shadow->regs));
     }
 
     /* Calculate r_power from c_count */
@@ -263,11 +299,21 @@ static int si5338_write_multisynth(struct bladerf *dev,
     val = 0xc0;
     val |= (r_power<<2);
 
-    log_verbose("Wrote r register: 0x%2.2x\n", val);
+    if (prev.valid && prev.r_reg == val) {
+        status = 0;
+    } else {
+        log_verbose("Wrote r register: 0x%2.2x\n", val);
 
-    status = dev->backend->si5338_write(dev, 31 + ms->index, val);
-    if (status < 0) {
-        si5338_log_write_error(status, bladerf_strerror(status));
+        status = dev->backend->si5338_write(dev, 31 + ms->index, val);
+        if (status < 0) {
+            si5338_log_write_error(status, bladerf_strerror(status));
+            return status;
+        }
+    }
+
+    if (shadow != NULL) {
+        shadow->r_reg = val;
+        shadow->valid = true;
     }
 
     return status ;
@@ -430,58 +476,172 @@ static int si5338_calculate_multisynth(struct si5338_multisynth *ms,
     return 0;
 }
 
+static bool si5338_rational_equal(const struct bladerf_rational_rate *a,
+                                  const struct bladerf_rational_rate *b)
+{
+    return a->integer == b->integer && a->num == b->num && a->den == b->den;
+}
+
+/**
+ * Compute the multisynth configuration for a reduced rate
+ */
+static int si5338_solve(uint8_t index,
+                        const struct bladerf_rational_rate *rate,
+                        struct si5338_solution *sol)
+{
+    struct si5338_multisynth ms;
+    struct bladerf_rational_rate req = *rate;
+    int status;
+
+    ms.index = index;
+
+    status = si5338_calculate_multisynth(&ms, &req);
+    if (status != 0) {
+        return status;
+    }
+
+    memset(sol, 0, sizeof(*sol));
+    sol->index = index;
+    sol->requested = *rate;
+    sol->r = ms.r;
+    memcpy(sol->regs, ms.regs, sizeof(sol->regs));
+
+    si5338_calculate_ms_freq(&ms, &sol->actual);
+
+    return 0;
+}
+
+static struct si5338_solution *
+si5338_cache_find(struct si5338_cache *cache, uint8_t index,
+                  const struct bladerf_rational_rate *rate)
+{
+    size_t i;
+
+    for (i = 0; i < SI5338_CACHE_ENTRIES; i++) {
+        struct si5338_solution *sol = &cache->solutions[i];
+
+        if (sol->valid && sol->index == index &&
+            si5338_rational_equal(&sol->requested, rate)) {
+            return sol;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Get an unused entry, or else the least recently used entry that has not
+ * been prepared. Returns NULL if all entries have been prepared.
+ */
+static struct si5338_solution *si5338_cache_alloc(struct si5338_cache *cache)
+{
+    struct si5338_solution *lru = NULL;
+    size_t i;
+
+    for (i = 0; i < SI5338_CACHE_ENTRIES; i++) {
+        struct si5338_solution *sol = &cache->solutions[i];
+
+        if (!sol->valid) {
+            return sol;
+        } else if (!sol->prepared &&
+                   (lru == NULL || sol->last_used < lru->last_used)) {
+            lru = sol;
+        }
+    }
+
+    return lru;
+}
+
+void si5338_cache_invalidate(struct si5338_cache *cache)
+{
+    memset(cache->shadow, 0, sizeof(cache->shadow));
+}
+
 /**
  * Configure a multisynth for either the RX/TX sample clocks (index=1 or 2)
  * or for the SMB output (index=3).
  */
 static int si5338_set_rational_multisynth(struct bladerf *dev,
+                                          struct si5338_cache *cache,
                                           uint8_t index, uint8_t channel,
                                           struct bladerf_rational_rate *rate,
                                           struct bladerf_rational_rate *actual_ret)
 {
     struct si5338_multisynth ms;
-    struct bladerf_rational_rate req;
-    struct bladerf_rational_rate actual;
+    struct si5338_solution computed;
+    struct si5338_solution *sol = NULL;
+    struct si5338_shadow *shadow = NULL;
     int status;
 
     si5338_rational_reduce(rate);
 
-    /* Save off the value */
-    req = *rate;
+    if (cache != NULL) {
+        sol = si5338_cache_find(cache, index, rate);
+    }
+
+    if (sol == NULL) {
+        /* Calculate multisynth values */
+        status = si5338_solve(index, rate, &computed);
+        if (status != 0) {
+            return status;
+        }
+
+        sol = &computed;
+
+        if (cache != NULL) {
+            struct si5338_solution *entry = si5338_cache_alloc(cache);
+            if (entry != NULL) {
+                *entry = computed;
+                entry->valid = true;
+                sol = entry;
+            }
+        }
+    } else {
+        log_verbose("Using cached MS%d solution\n", index);
+    }
+
+    if (cache != NULL) {
+        sol->last_used = ++cache->use_count;
+
+        if (index == 1 || index == 2) {
+            shadow = &cache->shadow[index - 1];
+        }
+    }
 
     /* Setup the multisynth enables and index */
     ms.index = index;
     ms.enable = channel;
+    ms.r = sol->r;
+    memcpy(ms.regs, sol->regs, sizeof(ms.regs));
 
     /* Update the base address register */
     si5338_update_base(&ms);
 
-    /* Calculate multisynth values */
-    status = si5338_calculate_multisynth(&ms, &req);
-    if(status != 0) {
-        return status;
-    }
-
     /* Get the actual rate */
-    si5338_calculate_ms_freq(&ms, &actual);
     if (actual_ret) {
-        memcpy(actual_ret, &actual, sizeof(*actual_ret));
+        memcpy(actual_ret, &sol->actual, sizeof(*actual_ret));
     }
 
     /* Program it to the part */
-    status = si5338_write_multisynth(dev, &ms);
+    status = si5338_write_multisynth(dev, shadow, &ms);
 
     /* Done */
     return status ;
 }
 
+static uint8_t si5338_sample_clock_index(bladerf_channel ch)
+{
+    return (ch == BLADERF_CHANNEL_RX(0)) ? 1 : 2;
+}
 
-int si5338_set_rational_sample_rate(struct bladerf *dev, bladerf_channel ch,
+int si5338_set_rational_sample_rate(struct bladerf *dev,
+                                    struct si5338_cache *cache,
+                                    bladerf_channel ch,
                                     const struct bladerf_rational_rate *rate,
                                     struct bladerf_rational_rate *actual)
 {
     struct bladerf_rational_rate rate_reduced = *rate;
-    uint8_t index = (ch == BLADERF_CHANNEL_RX(0)) ? 1 : 2;
+    uint8_t index = si5338_sample_clock_index(ch);
     uint8_t channel = SI5338_EN_A;
 
     /* Enforce minimum sample rate */
@@ -495,7 +655,76 @@ int si5338_set_rational_sample_rate(struct bladerf *dev, bladerf_channel ch,
         channel |= SI5338_EN_B;
     }
 
-    return si5338_set_rational_multisynth(dev, index, channel, &rate_reduced, actual);
+    return si5338_set_rational_multisynth(dev, cache, index, channel,
+                                          &rate_reduced, actual);
+}
+
+int si5338_prepare_sample_rates(struct si5338_cache *cache,
+                                bladerf_channel ch,
+                                const struct bladerf_rational_rate *rates,
+                                unsigned int num_rates,
+                                struct bladerf_rational_rate *actual)
+{
+    struct si5338_solution sols[SI5338_MAX_PREPARED_RATES];
+    const uint8_t index = si5338_sample_clock_index(ch);
+    unsigned int i;
+    size_t j;
+    int status;
+
+    if (num_rates > SI5338_MAX_PREPARED_RATES) {
+        log_debug("%s: Cannot prepare more than %d rates\n", __FUNCTION__,
+                  SI5338_MAX_PREPARED_RATES);
+        return BLADERF_ERR_INVAL;
+    }
+
+    /* Solve for every rate before modifying the cache, so that it is left
+     * untouched upon failure */
+    for (i = 0; i < num_rates; i++) {
+        struct bladerf_rational_rate rate_reduced = rates[i];
+
+        si5338_rational_reduce(&rate_reduced);
+        if (rate_reduced.integer < BLADERF_SAMPLERATE_MIN) {
+            log_debug("%s: provided sample rate violates minimum\n",
+                      __FUNCTION__);
+            return BLADERF_ERR_INVAL;
+        }
+
+        status = si5338_solve(index, &rate_reduced, &sols[i]);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    /* Release the rates previously prepared for this multisynth */
+    for (j = 0; j < SI5338_CACHE_ENTRIES; j++) {
+        if (cache->solutions[j].index == index) {
+            cache->solutions[j].prepared = false;
+        }
+    }
+
+    for (i = 0; i < num_rates; i++) {
+        struct si5338_solution *entry;
+
+        entry = si5338_cache_find(cache, index, &sols[i].requested);
+        if (entry == NULL) {
+            /* At most SI5338_MAX_PREPARED_RATES entries are prepared for
+             * each of the two sample clocks, so this cannot fail */
+            entry = si5338_cache_alloc(cache);
+            assert(entry != NULL);
+
+            *entry = sols[i];
+            entry->valid = true;
+        }
+
+        entry->prepared = true;
+        entry->last_used = ++cache->use_count;
+
+        if (actual != NULL) {
+            actual[i] = entry->actual;
+        }
+    }
+
+    return 0;
 }
 
 int si5338_set_rational_smb_freq(struct bladerf *dev,
@@ -515,11 +744,12 @@ int si5338_set_rational_smb_freq(struct bladerf *dev,
         return BLADERF_ERR_INVAL;
     }
 
-    return si5338_set_rational_multisynth(dev, 3, SI5338_EN_A, &rate_reduced, actual);
+    return si5338_set_rational_multisynth(dev, NULL, 3, SI5338_EN_A,
+                                          &rate_reduced, actual);
 }
 
-int si5338_set_sample_rate(struct bladerf *dev, bladerf_channel ch,
-                           uint32_t rate, uint32_t *actual)
+int si5338_set_sample_rate(struct bladerf *dev, struct si5338_cache *cache,
+                           bladerf_channel ch, uint32_t rate, uint32_t *actual)
 {
     struct bladerf_rational_rate req, act;
     int status;
@@ -530,7 +760,7 @@ int si5338_set_sample_rate(struct bladerf *dev, bladerf_channel ch,
     req.num = 0;
     req.den = 1;
 
-    status = si5338_set_rational_sample_rate(dev, ch, &req, &act);
+    status = si5338_set_rational_sample_rate(dev, cache, ch, &req, &act);
 
     if (status == 0 && act.num != 0) {
         log_info("Non-integer sample rate set from integer sample rate, "
@@ -583,7 +813,7 @@ int si5338_get_rational_sample_rate(struct bladerf *dev, bladerf_channel ch,
     int status;
 
     /* Select the multisynth we want to read */
-    ms.index = (ch == BLADERF_CHANNEL_RX(0)) ? 1 : 2;
+    ms.index = si5338_sample_clock_index(ch);
 
     /* Update the base address */
     si5338_update_base(&ms);
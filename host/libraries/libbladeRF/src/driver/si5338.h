@@ -30,10 +30,87 @@
 
 #include "board/board.h"
 
+/* Maximum number of rates that may be prepared for a channel at once */
+#define SI5338_MAX_PREPARED_RATES BLADERF_MAX_PREPARED_SAMPLE_RATES
+
+/* Number of multisynth solutions retained by a struct si5338_cache. This
+ * leaves room for recently used rates when both sample clocks have the
+ * maximum number of rates prepared. */
+#define SI5338_CACHE_ENTRIES (2 * SI5338_MAX_PREPARED_RATES + 8)
+
+/* Number of multisynth parameter registers */
+#define SI5338_MS_NUM_REGS 10
+
+/**
+ * Multisynth configuration that produces a particular rate
+ */
+struct si5338_solution {
+    bool valid;
+
+    /* Retained until the next si5338_prepare_sample_rates() call for the
+     * same multisynth, rather than being subject to eviction */
+    bool prepared;
+
+    /* Multisynth index, 1-3 */
+    uint8_t index;
+
+    /* Requested rate, in reduced form, and the rate actually achieved */
+    struct bladerf_rational_rate requested;
+    struct bladerf_rational_rate actual;
+
+    /* Output divider and multisynth register image */
+    uint32_t r;
+    uint8_t regs[SI5338_MS_NUM_REGS];
+
+    /* For least-recently-used eviction */
+    uint32_t last_used;
+};
+
+/**
+ * Last values written to a sample clock multisynth's registers
+ */
+struct si5338_shadow {
+    bool valid;
+    uint8_t enable;
+    uint8_t r_reg;
+    uint8_t regs[SI5338_MS_NUM_REGS];
+};
+
+/**
+ * Solver cache and register shadows for a device's Si5338.
+ *
+ * Solutions avoid recomputing the multisynth parameters for previously used
+ * rates. The shadows allow rate changes to skip the enable, R divider and
+ * multisynth parameter registers that already hold the desired values. The
+ * parameters are written as a whole block whenever any of them differ.
+ *
+ * The shadows only cover the RX and TX sample clocks (MS1 and MS2). The SMB
+ * clock's registers are shared with the SMB port and XB-200 configuration
+ * code, so its multisynth is always written in full.
+ *
+ * A zeroed structure is a valid, empty cache.
+ */
+struct si5338_cache {
+    struct si5338_solution solutions[SI5338_CACHE_ENTRIES];
+    uint32_t use_count;
+
+    struct si5338_shadow shadow[2];
+};
+
+/**
+ * Forget the register shadows, e.g., after a raw register write. Cached
+ * solutions remain valid.
+ *
+ * @param       cache   Cache to invalidate
+ */
+void si5338_cache_invalidate(struct si5338_cache *cache);
+
 /**
  * Set the rational sample rate of the specified channel.
  *
  * @param       dev     Device handle
+ * @param       cache   Solver cache and register shadows. May be NULL, in
+ *                      which case every register is written.
  * @param[in]   ch      Channel
  * @param[in]   rate    Rational rate requested
  * @param[out]  actual  Rational rate actually set
@@ -41,10 +118,33 @@
  * @return 0 on success, BLADERF_ERR_* value on failure
  */
 int si5338_set_rational_sample_rate(struct bladerf *dev,
+                                    struct si5338_cache *cache,
                                     bladerf_channel ch,
                                     const struct bladerf_rational_rate *rate,
                                     struct bladerf_rational_rate *actual);
 
+/**
+ * Compute the multisynth configurations for a set of sample rates, and
+ * retain them in the cache. This does not access the device.
+ *
+ * Rates previously prepared for the channel are released.
+ *
+ * @param       cache       Solver cache
+ * @param[in]   ch          Channel
+ * @param[in]   rates       Rational rates to prepare
+ * @param[in]   num_rates   Number of entries in `rates`. Must not exceed
+ *                          SI5338_MAX_PREPARED_RATES.
+ * @param[out]  actual      Rational rates that will actually be achieved.
+ *                          May be NULL.
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if any rate cannot be produced
+ */
+int si5338_prepare_sample_rates(struct si5338_cache *cache,
+                                bladerf_channel ch,
+                                const struct bladerf_rational_rate *rates,
+                                unsigned int num_rates,
+                                struct bladerf_rational_rate *actual);
+
 /**
  * Get the rational sample rate of the specified channel.
  *
@@ -62,6 +162,7 @@ int si5338_get_rational_sample_rate(struct bladerf *dev,
  * Set the integral sample rate of the specified channel.
  *
  * @param       dev     Device handle
+ * @param       cache   Solver cache and register shadows. May be NULL.
  * @param[in]   ch      Channel
  * @param[in]   rate    Integral rate requested
  * @param[out]  actual  Integral rate actually set
@@ -69,6 +170,7 @@ int si5338_get_rational_sample_rate(struct bladerf *dev,
  * @return 0 on success, BLADERF_ERR_* value on failure
  */
 int si5338_set_sample_rate(struct bladerf *dev,
+                           struct si5338_cache *cache,
                            bladerf_channel ch,
                            uint32_t rate,
                            uint32_t *actual);
@@ -0,0 +1,449 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <libbladeRF.h>
+
+#include "board/board.h"
+#include "host_config.h"
+#include "log.h"
+#include "rel_assert.h"
+#include "thread.h"
+
+#include "helpers/async_ctrl.h"
+#include "helpers/timeout.h"
+
+/* Maximum number of operations performed as a single batch */
+#define MAX_BATCH 32
+
+/* The control thread is started upon the first submission. Submitters check
+ * for it without taking dev->lock, which may be held for some time by a
+ * control operation. */
+#if defined(_MSC_VER)
+#   include <windows.h>
+#   define PTR_LOAD(p)     InterlockedCompareExchangePointer( \
+                                (PVOID volatile *)(p), NULL, NULL)
+#   define PTR_STORE(p, v) InterlockedExchangePointer((PVOID volatile *)(p), \
+                                                      (v))
+#else
+#   define PTR_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#   define PTR_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+struct bladerf_future {
+    struct bladerf_ctrl_request request;
+    bladerf_ctrl_cb cb;
+    void *user_data;
+
+    /* Next operation in the queue. Only accessed with the queue lock held,
+     * or by the control thread once dequeued. */
+    struct bladerf_future *next;
+
+    /* Protects the remaining fields */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    int status;
+    uint64_t actual;
+    bool done;
+
+    /* Released by the user. Freed by the control thread upon completion. */
+    bool detached;
+
+    /* The submitter requested a handle for this operation */
+    bool has_handle;
+};
+
+struct async_ctrl {
+    struct bladerf *dev;
+
+    pthread_t thread;
+
+    /* Protects the queue and `stop` */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    struct bladerf_future *head;
+    struct bladerf_future *tail;
+    bool stop;
+};
+
+static void future_destroy(struct bladerf_future *f)
+{
+    pthread_cond_destroy(&f->cond);
+    pthread_mutex_destroy(&f->lock);
+    free(f);
+}
+
+static int perform(struct bladerf *dev,
+                   const struct bladerf_ctrl_request *req,
+                   uint64_t *actual)
+{
+    const bladerf_channel ch = req->channel;
+    bladerf_sample_rate rate;
+    bladerf_bandwidth bw;
+    int status;
+
+    *actual = 0;
+
+    switch (req->op) {
+        case BLADERF_CTRL_SET_FREQUENCY:
+            return bladerf_set_frequency(dev, ch, req->value.frequency);
+
+        case BLADERF_CTRL_SET_GAIN:
+            return bladerf_set_gain(dev, ch, req->value.gain);
+
+        case BLADERF_CTRL_SET_GAIN_MODE:
+            return bladerf_set_gain_mode(dev, ch, req->value.gain_mode);
+
+        case BLADERF_CTRL_SET_SAMPLE_RATE:
+            status = bladerf_set_sample_rate(dev, ch, req->value.sample_rate,
+                                             &rate);
+            if (status == 0) {
+                *actual = rate;
+            }
+            return status;
+
+        case BLADERF_CTRL_SET_BANDWIDTH:
+            status = bladerf_set_bandwidth(dev, ch, req->value.bandwidth, &bw);
+            if (status == 0) {
+                *actual = bw;
+            }
+            return status;
+
+        case BLADERF_CTRL_APPLY_PROFILE:
+            return bladerf_apply_profile(dev, &req->value.profile);
+
+        default:
+            return BLADERF_ERR_INVAL;
+    }
+}
+
+static void complete(struct bladerf *dev, struct bladerf_future *f,
+                     int status, uint64_t actual)
+{
+    bool detached;
+
+    MUTEX_LOCK(&f->lock);
+    f->status = status;
+    f->actual = actual;
+    MUTEX_UNLOCK(&f->lock);
+
+    /* The user may release the future from within the callback, so it must
+     * not be freed until afterwards */
+    if (f->cb != NULL) {
+        f->cb(dev, f->has_handle ? f : NULL, status, f->user_data);
+    }
+
+    MUTEX_LOCK(&f->lock);
+    f->done  = true;
+    detached = f->detached;
+    pthread_cond_broadcast(&f->cond);
+    MUTEX_UNLOCK(&f->lock);
+
+    if (detached) {
+        future_destroy(f);
+    }
+}
+
+/* Performing `later` right after `earlier` would repeat it exactly: the same
+ * setting, with the same value. Profiles are always applied. */
+static bool repeats(const struct bladerf_future *later,
+                    const struct bladerf_future *earlier)
+{
+    const struct bladerf_ctrl_request *a = &later->request;
+    const struct bladerf_ctrl_request *b = &earlier->request;
+
+    if (a->op != b->op || a->channel != b->channel) {
+        return false;
+    }
+
+    switch (a->op) {
+        case BLADERF_CTRL_SET_FREQUENCY:
+            return a->value.frequency == b->value.frequency;
+
+        case BLADERF_CTRL_SET_GAIN:
+            return a->value.gain == b->value.gain;
+
+        case BLADERF_CTRL_SET_GAIN_MODE:
+            return a->value.gain_mode == b->value.gain_mode;
+
+        case BLADERF_CTRL_SET_SAMPLE_RATE:
+            return a->value.sample_rate == b->value.sample_rate;
+
+        case BLADERF_CTRL_SET_BANDWIDTH:
+            return a->value.bandwidth == b->value.bandwidth;
+
+        default:
+            return false;
+    }
+}
+
+/* Consecutive repeats of an operation are only performed once, and all of
+ * them complete with its result. Sequential execution would have applied the
+ * same value again, and so could not have produced a different one. Anything
+ * else is performed individually, and completes with its own result. */
+static void run_batch(struct bladerf *dev, struct bladerf_future **ops,
+                      size_t n)
+{
+    size_t i, j, end;
+    uint64_t actual;
+    int status;
+
+    for (i = 0; i < n; i = end) {
+        end = i + 1;
+        while (end < n && repeats(ops[end], ops[i])) {
+            end++;
+        }
+
+        status = perform(dev, &ops[i]->request, &actual);
+
+        for (j = i; j < end; j++) {
+            complete(dev, ops[j], status, actual);
+        }
+    }
+}
+
+static void *async_ctrl_thread(void *arg)
+{
+    struct async_ctrl *c = arg;
+    struct bladerf_future *ops[MAX_BATCH];
+    size_t n;
+
+    MUTEX_LOCK(&c->lock);
+
+    while (true) {
+        while (c->head == NULL && !c->stop) {
+            pthread_cond_wait(&c->cond, &c->lock);
+        }
+
+        /* Pending operations are performed before stopping */
+        if (c->head == NULL) {
+            break;
+        }
+
+        for (n = 0; n < MAX_BATCH && c->head != NULL; n++) {
+            ops[n]  = c->head;
+            c->head = c->head->next;
+        }
+
+        if (c->head == NULL) {
+            c->tail = NULL;
+        }
+
+        MUTEX_UNLOCK(&c->lock);
+        run_batch(c->dev, ops, n);
+        MUTEX_LOCK(&c->lock);
+    }
+
+    MUTEX_UNLOCK(&c->lock);
+
+    return NULL;
+}
+
+static int start(struct bladerf *dev)
+{
+    struct async_ctrl *c;
+    int status = 0;
+
+    MUTEX_LOCK(&dev->lock);
+
+    if (dev->async_ctrl != NULL) {
+        goto out;
+    }
+
+    c = calloc(1, sizeof(*c));
+    if (c == NULL) {
+        status = BLADERF_ERR_MEM;
+        goto out;
+    }
+
+    c->dev = dev;
+
+    MUTEX_INIT(&c->lock);
+    pthread_cond_init(&c->cond, NULL);
+
+    status = pthread_create(&c->thread, NULL, async_ctrl_thread, c);
+    if (status != 0) {
+        log_debug("%s: pthread_create failed: %d\n", __FUNCTION__, status);
+        pthread_cond_destroy(&c->cond);
+        pthread_mutex_destroy(&c->lock);
+        free(c);
+        status = BLADERF_ERR_UNEXPECTED;
+        goto out;
+    }
+
+    PTR_STORE(&dev->async_ctrl, c);
+
+out:
+    MUTEX_UNLOCK(&dev->lock);
+    return status;
+}
+
+int async_ctrl_submit(struct bladerf *dev,
+                      const struct bladerf_ctrl_request *request,
+                      bladerf_ctrl_cb cb,
+                      void *user_data,
+                      struct bladerf_future **future)
+{
+    struct async_ctrl *c;
+    struct bladerf_future *f;
+    int status;
+
+    if ((int)request->op < (int)BLADERF_CTRL_SET_FREQUENCY ||
+        (int)request->op > (int)BLADERF_CTRL_APPLY_PROFILE) {
+        log_debug("%s: invalid operation: %d\n", __FUNCTION__, request->op);
+        return BLADERF_ERR_INVAL;
+    }
+
+    c = PTR_LOAD(&dev->async_ctrl);
+    if (c == NULL) {
+        status = start(dev);
+        if (status != 0) {
+            return status;
+        }
+
+        c = PTR_LOAD(&dev->async_ctrl);
+    }
+
+    f = calloc(1, sizeof(*f));
+    if (f == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    f->request    = *request;
+    f->cb         = cb;
+    f->user_data  = user_data;
+    f->detached   = (future == NULL);
+    f->has_handle = (future != NULL);
+
+    MUTEX_INIT(&f->lock);
+    pthread_cond_init(&f->cond, NULL);
+
+    if (future != NULL) {
+        *future = f;
+    }
+
+    MUTEX_LOCK(&c->lock);
+
+    if (c->tail != NULL) {
+        c->tail->next = f;
+    } else {
+        c->head = f;
+    }
+
+    c->tail = f;
+
+    pthread_cond_signal(&c->cond);
+    MUTEX_UNLOCK(&c->lock);
+
+    return 0;
+}
+
+void async_ctrl_stop(struct bladerf *dev)
+{
+    struct async_ctrl *c = dev->async_ctrl;
+
+    if (c == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(&c->lock);
+    c->stop = true;
+    pthread_cond_signal(&c->cond);
+    MUTEX_UNLOCK(&c->lock);
+
+    pthread_join(c->thread, NULL);
+
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->lock);
+
+    dev->async_ctrl = NULL;
+
+    free(c);
+}
+
+int async_ctrl_future_wait(struct bladerf_future *f,
+                           unsigned int timeout_ms,
+                           uint64_t *actual)
+{
+    struct timespec timeout_abs;
+    int status = 0;
+
+    if (timeout_ms != 0) {
+        status = populate_abs_timeout(&timeout_abs, timeout_ms);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    MUTEX_LOCK(&f->lock);
+
+    while (!f->done && status == 0) {
+        if (timeout_ms == 0) {
+            pthread_cond_wait(&f->cond, &f->lock);
+        } else if (pthread_cond_timedwait(&f->cond, &f->lock, &timeout_abs) ==
+                   ETIMEDOUT) {
+            status = f->done ? 0 : BLADERF_ERR_TIMEOUT;
+        }
+    }
+
+    if (status == 0) {
+        status = f->status;
+
+        if (actual != NULL) {
+            *actual = f->actual;
+        }
+    }
+
+    MUTEX_UNLOCK(&f->lock);
+
+    return status;
+}
+
+bool async_ctrl_future_ready(struct bladerf_future *f)
+{
+    bool done;
+
+    MUTEX_LOCK(&f->lock);
+    done = f->done;
+    MUTEX_UNLOCK(&f->lock);
+
+    return done;
+}
+
+void async_ctrl_future_free(struct bladerf_future *f)
+{
+    bool done;
+
+    MUTEX_LOCK(&f->lock);
+    done        = f->done;
+    f->detached = !done;
+    MUTEX_UNLOCK(&f->lock);
+
+    if (done) {
+        future_destroy(f);
+    }
+}
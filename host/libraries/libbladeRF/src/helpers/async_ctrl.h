@@ -0,0 +1,71 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Asynchronous control operations
+ *
+ * See the FN_ASYNC_CTRL group in libbladeRF.h.
+ */
+
+#ifndef HELPERS_ASYNC_CTRL_H_
+#define HELPERS_ASYNC_CTRL_H_
+
+#include <libbladeRF.h>
+
+/**
+ * Queue an operation for the device's control thread, starting the thread if
+ * it is not already running
+ *
+ * @pre dev->lock is not held by the caller
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int async_ctrl_submit(struct bladerf *dev,
+                      const struct bladerf_ctrl_request *request,
+                      bladerf_ctrl_cb cb,
+                      void *user_data,
+                      struct bladerf_future **future);
+
+/**
+ * Perform any pending operations, then stop the device's control thread and
+ * free its resources. This is a no-op if the thread was never started.
+ *
+ * @pre dev->lock is not held by the caller
+ */
+void async_ctrl_stop(struct bladerf *dev);
+
+/**
+ * See bladerf_future_wait()
+ */
+int async_ctrl_future_wait(struct bladerf_future *future,
+                           unsigned int timeout_ms,
+                           uint64_t *actual);
+
+/**
+ * See bladerf_future_ready()
+ */
+bool async_ctrl_future_ready(struct bladerf_future *future);
+
+/**
+ * See bladerf_future_free()
+ */
+void async_ctrl_future_free(struct bladerf_future *future);
+
+#endif
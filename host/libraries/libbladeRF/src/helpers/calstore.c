@@ -0,0 +1,348 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <libbladeRF.h>
+
+#include "host_config.h"
+#include "log.h"
+
+#if BLADERF_OS_WINDOWS
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "helpers/file.h"
+#include "helpers/calstore.h"
+
+/* Name of an entry's file, e.g. "<serial>.cal" */
+#define CALSTORE_FILENAME_LEN (BLADERF_SERIAL_LENGTH + 4)
+
+static void get_filename(const char *serial, char *filename)
+{
+    snprintf(filename, CALSTORE_FILENAME_LEN, "%s.cal", serial);
+}
+
+/* Table of the LMS fields, for the purposes of reading and writing them by
+ * name */
+static const struct {
+    const char *key;
+    size_t offset;
+} lms_fields[] = {
+#define LMS_FIELD(name) { "lms_" #name, offsetof(struct bladerf_lms_dc_cals, name) }
+    LMS_FIELD(lpf_tuning),
+    LMS_FIELD(tx_lpf_i),
+    LMS_FIELD(tx_lpf_q),
+    LMS_FIELD(rx_lpf_i),
+    LMS_FIELD(rx_lpf_q),
+    LMS_FIELD(dc_ref),
+    LMS_FIELD(rxvga2a_i),
+    LMS_FIELD(rxvga2a_q),
+    LMS_FIELD(rxvga2b_i),
+    LMS_FIELD(rxvga2b_q),
+#undef LMS_FIELD
+};
+
+static inline int16_t *lms_field(struct bladerf_lms_dc_cals *cals, size_t i)
+{
+    return (int16_t *)((uint8_t *)cals + lms_fields[i].offset);
+}
+
+void calstore_init(struct calstore *cs, const char *serial)
+{
+    size_t i;
+
+    memset(cs, 0, sizeof(*cs));
+
+    cs->version = CALSTORE_VERSION;
+    cs->created = (int64_t)time(NULL);
+    strncpy(cs->serial, serial, BLADERF_SERIAL_LENGTH - 1);
+
+    for (i = 0; i < ARRAY_SIZE(lms_fields); i++) {
+        *lms_field(&cs->lms, i) = -1;
+    }
+}
+
+static int parse_int(const char *value, long long *result)
+{
+    char *end;
+
+    errno   = 0;
+    *result = strtoll(value, &end, 10);
+
+    if (errno != 0 || end == value || *end != '\0') {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return 0;
+}
+
+static int parse_line(struct calstore *cs, char *line)
+{
+    char *key, *value;
+    long long ll;
+    size_t i;
+
+    line[strcspn(line, "\r\n")] = '\0';
+
+    if (line[0] == '\0' || line[0] == '#') {
+        return 0;
+    }
+
+    value = strchr(line, '=');
+    if (value == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    key    = line;
+    *value = '\0';
+    value++;
+
+    if (!strcmp(key, "serial")) {
+        strncpy(cs->serial, value, BLADERF_SERIAL_LENGTH - 1);
+        return 0;
+    }
+
+    if (!strcmp(key, "version")) {
+        if (parse_int(value, &ll) != 0) {
+            return BLADERF_ERR_INVAL;
+        }
+        cs->version = (unsigned int)ll;
+        return 0;
+    }
+
+    if (!strcmp(key, "created")) {
+        if (parse_int(value, &ll) != 0) {
+            return BLADERF_ERR_INVAL;
+        }
+        cs->created = (int64_t)ll;
+        return 0;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(lms_fields); i++) {
+        if (!strcmp(key, lms_fields[i].key)) {
+            if (parse_int(value, &ll) != 0) {
+                return BLADERF_ERR_INVAL;
+            }
+            *lms_field(&cs->lms, i) = (int16_t)((ll < 0) ? -1 : (ll & 0xff));
+            return 0;
+        }
+    }
+
+    /* Ignore keys written by other versions, whatever their values */
+    log_verbose("%s: Ignoring unknown key \"%s\"\n", __FUNCTION__, key);
+    return 0;
+}
+
+int calstore_load(const char *serial, struct calstore *cs)
+{
+    char filename[CALSTORE_FILENAME_LEN];
+    char line[128];
+    char *path;
+    FILE *f;
+    int status = 0;
+    unsigned int line_num = 0;
+
+    get_filename(serial, filename);
+
+    path = file_user_path(filename, false);
+    if (path == NULL) {
+        return BLADERF_ERR_NO_FILE;
+    }
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        free(path);
+        return BLADERF_ERR_NO_FILE;
+    }
+
+    /* Fields absent from the file are unknown */
+    calstore_init(cs, "");
+    cs->version = 0;
+    cs->created = 0;
+
+    while (status == 0 && fgets(line, sizeof(line), f) != NULL) {
+        line_num++;
+        status = parse_line(cs, line);
+    }
+
+    if (status != 0) {
+        log_debug("Malformed line %u in %s\n", line_num, path);
+    } else if (ferror(f)) {
+        status = BLADERF_ERR_IO;
+    }
+
+    fclose(f);
+    free(path);
+    return status;
+}
+
+/* Replace `path` with `tmp_path`, such that `path` always holds either the
+ * old or the new contents */
+static int replace_file(const char *tmp_path, const char *path)
+{
+#if BLADERF_OS_WINDOWS
+    return MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(tmp_path, path);
+#endif
+}
+
+int calstore_save(const struct calstore *cs)
+{
+    char filename[CALSTORE_FILENAME_LEN];
+    char *path, *tmp_path;
+    size_t tmp_len;
+    FILE *f;
+    size_t i;
+    int status = 0;
+
+    get_filename(cs->serial, filename);
+
+    path = file_user_path(filename, true);
+    if (path == NULL) {
+        return BLADERF_ERR_IO;
+    }
+
+    /* The temporary file is unique to this process, in case another is
+     * saving the same entry */
+    tmp_len  = strlen(path) + 32;
+    tmp_path = malloc(tmp_len);
+    if (tmp_path == NULL) {
+        free(path);
+        return BLADERF_ERR_MEM;
+    }
+
+    snprintf(tmp_path, tmp_len, "%s.%ld.tmp", path, (long)getpid());
+
+    f = fopen(tmp_path, "w");
+    if (f == NULL) {
+        log_debug("Failed to open %s: %s\n", tmp_path, strerror(errno));
+        status = BLADERF_ERR_IO;
+        goto out;
+    }
+
+    fprintf(f, "# bladeRF calibration store. Generated by libbladeRF.\n");
+    fprintf(f, "version=%u\n", cs->version);
+    fprintf(f, "serial=%s\n", cs->serial);
+    fprintf(f, "created=%" PRId64 "\n", cs->created);
+
+    for (i = 0; i < ARRAY_SIZE(lms_fields); i++) {
+        fprintf(f, "%s=%d\n", lms_fields[i].key,
+                *lms_field((struct bladerf_lms_dc_cals *)&cs->lms, i));
+    }
+
+    if (fflush(f) != 0 || ferror(f)) {
+        status = BLADERF_ERR_IO;
+    }
+
+#if !BLADERF_OS_WINDOWS
+    /* Ensure the contents reach the disk before the rename does */
+    if (status == 0 && fsync(fileno(f)) != 0) {
+        status = BLADERF_ERR_IO;
+    }
+#endif
+
+    if (fclose(f) != 0) {
+        status = BLADERF_ERR_IO;
+    }
+
+    if (status == 0 && replace_file(tmp_path, path) != 0) {
+        log_debug("Failed to replace %s: %s\n", path, strerror(errno));
+        status = BLADERF_ERR_IO;
+    }
+
+    if (status == 0) {
+        log_verbose("Saved calibration store %s\n", path);
+    } else {
+        remove(tmp_path);
+    }
+
+out:
+    free(tmp_path);
+    free(path);
+    return status;
+}
+
+const char *calstore_stale(const struct calstore *cs, const char *serial,
+                           time_t now)
+{
+    if (cs->version != CALSTORE_VERSION) {
+        return "format version mismatch";
+    }
+
+    if (strcmp(cs->serial, serial) != 0) {
+        return "serial number mismatch";
+    }
+
+    if (cs->created > (int64_t)now) {
+        return "created in the future";
+    }
+
+    if ((int64_t)now - cs->created > CALSTORE_MAX_AGE_SEC) {
+        return "too old";
+    }
+
+    return NULL;
+}
+
+int calstore_merge(struct calstore *cs,
+                   const struct bladerf_lms_dc_cals *cals,
+                   bladerf_cal_module module)
+{
+    switch (module) {
+        case BLADERF_DC_CAL_LPF_TUNING:
+            cs->lms.lpf_tuning = cals->lpf_tuning;
+            break;
+
+        case BLADERF_DC_CAL_TX_LPF:
+            cs->lms.tx_lpf_i = cals->tx_lpf_i;
+            cs->lms.tx_lpf_q = cals->tx_lpf_q;
+            break;
+
+        case BLADERF_DC_CAL_RX_LPF:
+            cs->lms.rx_lpf_i = cals->rx_lpf_i;
+            cs->lms.rx_lpf_q = cals->rx_lpf_q;
+            break;
+
+        case BLADERF_DC_CAL_RXVGA2:
+            cs->lms.dc_ref    = cals->dc_ref;
+            cs->lms.rxvga2a_i = cals->rxvga2a_i;
+            cs->lms.rxvga2a_q = cals->rxvga2a_q;
+            cs->lms.rxvga2b_i = cals->rxvga2b_i;
+            cs->lms.rxvga2b_q = cals->rxvga2b_q;
+            break;
+
+        default:
+            return BLADERF_ERR_INVAL;
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Calibration store
+ *
+ * Persists the results of a device's automatic calibrations, so they need not
+ * be repeated each time the device is opened. Each device has its own entry,
+ * <serial>.cal, in the user's writable bladeRF config directory.
+ *
+ * Entries are plain "key=value" text. Each is tagged with a format version
+ * and the time it was created, so that results which may no longer reflect
+ * the device's operating conditions are not restored.
+ *
+ * Entries are replaced by writing a temporary file alongside them and
+ * renaming it over the entry, so an interrupted save leaves the previous
+ * entry intact.
+ */
+
+#ifndef HELPERS_CALSTORE_H_
+#define HELPERS_CALSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <libbladeRF.h>
+
+/* Format version written by calstore_save(). Entries with any other version
+ * are considered stale. */
+#define CALSTORE_VERSION 1
+
+/* Entries older than this are considered stale */
+#define CALSTORE_MAX_AGE_SEC (30 * 24 * 60 * 60)
+
+struct calstore {
+    unsigned int version;
+    char serial[BLADERF_SERIAL_LENGTH];
+    int64_t created; /* Seconds since the epoch */
+
+    /* bladeRF1 LMS6002D DC calibration register values. Values < 0 have not
+     * been calibrated. */
+    struct bladerf_lms_dc_cals lms;
+};
+
+/**
+ * Initialize an empty entry, created now
+ *
+ * @param[out]  cs          Entry to initialize
+ * @param[in]   serial      Device serial number
+ */
+void calstore_init(struct calstore *cs, const char *serial);
+
+/**
+ * Load the entry for the specified device
+ *
+ * @param[in]   serial      Device serial number
+ * @param[out]  cs          Loaded entry
+ *
+ * @return 0 on success, BLADERF_ERR_NO_FILE if the device has no entry, or
+ *         another BLADERF_ERR_* value if the entry could not be read
+ */
+int calstore_load(const char *serial, struct calstore *cs);
+
+/**
+ * Write an entry, replacing any existing entry for the same device
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int calstore_save(const struct calstore *cs);
+
+/**
+ * Determine whether an entry should no longer be used
+ *
+ * @param[in]   cs          Entry
+ * @param[in]   serial      Serial number of the device it is to be used with
+ * @param[in]   now         Current time
+ *
+ * @return NULL if the entry may be used, otherwise a description of why it is
+ *         stale
+ */
+const char *calstore_stale(const struct calstore *cs, const char *serial,
+                           time_t now);
+
+/**
+ * Merge the results of calibrating one module into an entry. The results for
+ * other modules are left as they are.
+ *
+ * @param       cs          Entry to update
+ * @param[in]   cals        LMS DC calibration register values read back after
+ *                          the calibration
+ * @param[in]   module      Module that was calibrated
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if `module` is not recognized
+ */
+int calstore_merge(struct calstore *cs,
+                   const struct bladerf_lms_dc_cals *cals,
+                   bladerf_cal_module module);
+
+#endif
@@ -181,6 +181,8 @@ static size_t strip_last_path_entry(char *buf, char dir_delim)
 #if BLADERF_OS_LINUX || BLADERF_OS_OSX || BLADERF_OS_FREEBSD
 #define ACCESS_FILE_EXISTS F_OK
 #define DIR_DELIMETER '/'
+#define USER_CONFIG_DIR "/.config/Nuand/bladeRF/"
+#define make_dir(path) mkdir(path, 0755)
 
 static const struct search_path_entries search_paths[] = {
     { false, "" },
@@ -275,7 +277,10 @@ static inline size_t get_binary_dir(char *buf, size_t max_len)
 #elif BLADERF_OS_WINDOWS
 #define ACCESS_FILE_EXISTS 0
 #define DIR_DELIMETER '\\'
+#define USER_CONFIG_DIR "/Nuand/bladeRF/"
+#define make_dir(path) _mkdir(path)
 #include <shlobj.h>
+#include <direct.h>
 
 static const struct search_path_entries search_paths[] = {
     { false, "" },
@@ -509,3 +514,46 @@ char *file_find(const char *filename)
     free(full_path);
     return NULL;
 }
+
+char *file_user_path(const char *filename, bool create_dirs)
+{
+    size_t len, i;
+    char *full_path;
+
+    full_path = calloc(PATH_MAX_LEN+1, 1);
+    if (full_path == NULL) {
+        return NULL;
+    }
+
+    len = get_home_dir(full_path, PATH_MAX_LEN);
+    if (len == 0 ||
+        len + strlen(USER_CONFIG_DIR) + strlen(filename) > PATH_MAX_LEN) {
+        log_debug("Unable to form user config path for %s.\n", filename);
+        free(full_path);
+        return NULL;
+    }
+
+    strcat(full_path, USER_CONFIG_DIR);
+
+    /* Create each missing component of the config directory, truncating the
+     * path at each delimiter in turn */
+    if (create_dirs) {
+        for (i = len + 1; full_path[i] != '\0'; i++) {
+            if (full_path[i] == '/') {
+                full_path[i] = '\0';
+
+                if (make_dir(full_path) != 0 && errno != EEXIST) {
+                    log_debug("Failed to create %s: %s\n",
+                              full_path, strerror(errno));
+                    free(full_path);
+                    return NULL;
+                }
+
+                full_path[i] = '/';
+            }
+        }
+    }
+
+    strcat(full_path, filename);
+    return full_path;
+}
@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdbool.h>
 
 /**
  * Read file contents into a buffer allocated internally and returned to the
@@ -94,4 +95,17 @@ ssize_t file_size(FILE *f);
  */
 char *file_find(const char *filename);
 
+/**
+ * Form the path to the specified filename within the user's writable bladeRF
+ * config directory (e.g., ~/.config/Nuand/bladeRF/ on Linux). The file itself
+ * need not exist.
+ *
+ * @param[in]   filename    Name of the file
+ * @param[in]   create_dirs Create the config directory if it does not exist
+ *
+ * @return Heap-allocated full path on success, NULL otherwise. The caller is
+ *         responsible for freeing the returned path.
+ */
+char *file_user_path(const char *filename, bool create_dirs);
+
 #endif
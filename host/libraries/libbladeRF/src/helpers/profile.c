@@ -0,0 +1,548 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <libbladeRF.h>
+
+#include "log.h"
+
+#include "board/board.h"
+
+#include "helpers/profile.h"
+
+/* Per-channel settings, in the order in which they are applied. Settings
+ * later in this list may be affected by those earlier in it. */
+static const uint32_t channel_fields[] = {
+    BLADERF_PROFILE_SAMPLE_RATE, BLADERF_PROFILE_BANDWIDTH,
+    BLADERF_PROFILE_FREQUENCY,   BLADERF_PROFILE_RF_PORT,
+    BLADERF_PROFILE_GAIN_MODE,   BLADERF_PROFILE_GAIN,
+    BLADERF_PROFILE_TRIGGER,
+};
+
+static const bladerf_direction directions[] = { BLADERF_RX, BLADERF_TX };
+
+static bladerf_channel channel(bladerf_direction dir, size_t i)
+{
+    return dir == BLADERF_RX ? BLADERF_CHANNEL_RX(i) : BLADERF_CHANNEL_TX(i);
+}
+
+static struct bladerf_channel_profile *
+channel_profile(struct bladerf_profile *p, bladerf_channel ch)
+{
+    size_t i = ch >> 1;
+
+    if (i >= BLADERF_PROFILE_MAX_CHANNELS) {
+        return NULL;
+    }
+
+    return BLADERF_CHANNEL_IS_TX(ch) ? &p->tx[i] : &p->rx[i];
+}
+
+static const struct bladerf_channel_profile *
+channel_profile_const(const struct bladerf_profile *p, bladerf_channel ch)
+{
+    return channel_profile((struct bladerf_profile *)p, ch);
+}
+
+static size_t num_channels(struct bladerf *dev, bladerf_direction dir)
+{
+    size_t n = dev->board->get_channel_count(dev, dir);
+    return n < BLADERF_PROFILE_MAX_CHANNELS ? n : BLADERF_PROFILE_MAX_CHANNELS;
+}
+
+/* Clear `fields` in the known configuration for every channel in `dir`, or
+ * every channel if `dir` is BLADERF_DIRECTION_MASK */
+static void forget(struct bladerf *dev, int dir, uint32_t fields)
+{
+    size_t i;
+
+    for (i = 0; i < BLADERF_PROFILE_MAX_CHANNELS; i++) {
+        if (dir != BLADERF_TX) {
+            dev->profile.rx[i].fields &= ~fields;
+        }
+
+        if (dir != BLADERF_RX) {
+            dev->profile.tx[i].fields &= ~fields;
+        }
+    }
+}
+
+void profile_invalidate(struct bladerf *dev, bladerf_channel ch,
+                        uint32_t fields)
+{
+    struct bladerf_channel_profile *known;
+    bladerf_direction dir;
+
+    if (ch == BLADERF_CHANNEL_INVALID) {
+        dev->profile.fields &= ~fields;
+        return;
+    }
+
+    known = channel_profile(&dev->profile, ch);
+    if (known == NULL) {
+        return;
+    }
+
+    dir = BLADERF_CHANNEL_IS_TX(ch) ? BLADERF_TX : BLADERF_RX;
+
+    known->fields &= ~fields;
+
+    /* Channels in the same direction may share an LO and filters
+     * (e.g., the AD9361), and the RF port and gain may be adjusted according
+     * to the frequency. */
+    if (fields & BLADERF_PROFILE_FREQUENCY) {
+        forget(dev, dir, BLADERF_PROFILE_FREQUENCY | BLADERF_PROFILE_RF_PORT |
+                             BLADERF_PROFILE_GAIN);
+    }
+
+    if (fields & BLADERF_PROFILE_BANDWIDTH) {
+        forget(dev, dir, BLADERF_PROFILE_BANDWIDTH);
+    }
+
+    /* RX and TX sample rates may be derived from a common clock */
+    if (fields & BLADERF_PROFILE_SAMPLE_RATE) {
+        forget(dev, BLADERF_DIRECTION_MASK, BLADERF_PROFILE_SAMPLE_RATE);
+    }
+
+    if (fields & BLADERF_PROFILE_GAIN_MODE) {
+        known->fields &= ~BLADERF_PROFILE_GAIN;
+    }
+}
+
+void profile_invalidate_all(struct bladerf *dev)
+{
+    memset(&dev->profile, 0, sizeof(dev->profile));
+}
+
+/* Unsupported settings are simply omitted from a captured profile */
+#define CAPTURE(field_, call_)                                                 \
+    do {                                                                       \
+        int status_ = (call_);                                                 \
+        if (status_ == 0) {                                                    \
+            cp->fields |= (field_);                                            \
+        } else if (status_ != BLADERF_ERR_UNSUPPORTED) {                       \
+            return status_;                                                    \
+        }                                                                      \
+    } while (0)
+
+static int capture_channel(struct bladerf *dev,
+                           bladerf_channel ch,
+                           struct bladerf_channel_profile *cp)
+{
+    const char *port = NULL;
+    int status;
+
+    memset(cp, 0, sizeof(*cp));
+
+    CAPTURE(BLADERF_PROFILE_FREQUENCY,
+            dev->board->get_frequency(dev, ch, &cp->frequency));
+
+    CAPTURE(BLADERF_PROFILE_SAMPLE_RATE,
+            dev->board->get_sample_rate(dev, ch, &cp->sample_rate));
+
+    CAPTURE(BLADERF_PROFILE_BANDWIDTH,
+            dev->board->get_bandwidth(dev, ch, &cp->bandwidth));
+
+    if (!BLADERF_CHANNEL_IS_TX(ch)) {
+        CAPTURE(BLADERF_PROFILE_GAIN_MODE,
+                dev->board->get_gain_mode(dev, ch, &cp->gain_mode));
+    }
+
+    CAPTURE(BLADERF_PROFILE_GAIN, dev->board->get_gain(dev, ch, &cp->gain));
+
+    status = dev->board->get_rf_port(dev, ch, &port);
+    if (status == 0 && port != NULL &&
+        strlen(port) < sizeof(cp->rf_port)) {
+        strcpy(cp->rf_port, port);
+        cp->fields |= BLADERF_PROFILE_RF_PORT;
+    } else if (status != 0 && status != BLADERF_ERR_UNSUPPORTED) {
+        return status;
+    }
+
+    /* The trigger signal in use isn't something we can read back, so the
+     * trigger configuration is left out */
+
+    return 0;
+}
+
+int profile_capture(struct bladerf *dev, struct bladerf_profile *profile)
+{
+    struct bladerf_profile *cp = profile;
+    size_t d, i;
+    int status;
+
+    memset(profile, 0, sizeof(*profile));
+
+    CAPTURE(BLADERF_PROFILE_LOOPBACK,
+            dev->board->get_loopback(dev, &profile->loopback));
+
+    CAPTURE(BLADERF_PROFILE_RX_MUX,
+            dev->board->get_rx_mux(dev, &profile->rx_mux));
+
+    for (d = 0; d < ARRAY_SIZE(directions); d++) {
+        for (i = 0; i < num_channels(dev, directions[d]); i++) {
+            bladerf_channel ch = channel(directions[d], i);
+
+            status = capture_channel(dev, ch, channel_profile(profile, ch));
+            if (status != 0) {
+                return status;
+            }
+        }
+    }
+
+    dev->profile = *profile;
+    return 0;
+}
+
+static bool channel_field_equal(const struct bladerf_channel_profile *a,
+                                const struct bladerf_channel_profile *b,
+                                uint32_t field)
+{
+    switch (field) {
+        case BLADERF_PROFILE_FREQUENCY:
+            return a->frequency == b->frequency;
+
+        case BLADERF_PROFILE_SAMPLE_RATE:
+            return a->sample_rate == b->sample_rate;
+
+        case BLADERF_PROFILE_BANDWIDTH:
+            return a->bandwidth == b->bandwidth;
+
+        case BLADERF_PROFILE_GAIN_MODE:
+            return a->gain_mode == b->gain_mode;
+
+        case BLADERF_PROFILE_GAIN:
+            return a->gain == b->gain;
+
+        case BLADERF_PROFILE_RF_PORT:
+            return !strcmp(a->rf_port, b->rf_port);
+
+        case BLADERF_PROFILE_TRIGGER:
+            return a->trigger_signal == b->trigger_signal &&
+                   a->trigger_role == b->trigger_role;
+
+        default:
+            return false;
+    }
+}
+
+static int set_channel_field(struct bladerf *dev,
+                             bladerf_channel ch,
+                             const struct bladerf_channel_profile *want,
+                             uint32_t field)
+{
+    struct bladerf_trigger trigger;
+    bool arm;
+    int status;
+
+    switch (field) {
+        case BLADERF_PROFILE_FREQUENCY:
+            return dev->board->set_frequency(dev, ch, want->frequency);
+
+        case BLADERF_PROFILE_SAMPLE_RATE:
+            return dev->board->set_sample_rate(dev, ch, want->sample_rate,
+                                               NULL);
+
+        case BLADERF_PROFILE_BANDWIDTH:
+            return dev->board->set_bandwidth(dev, ch, want->bandwidth, NULL);
+
+        case BLADERF_PROFILE_GAIN_MODE:
+            return dev->board->set_gain_mode(dev, ch, want->gain_mode);
+
+        case BLADERF_PROFILE_GAIN:
+            return dev->board->set_gain(dev, ch, want->gain);
+
+        case BLADERF_PROFILE_RF_PORT:
+            return dev->board->set_rf_port(dev, ch, want->rf_port);
+
+        case BLADERF_PROFILE_TRIGGER:
+            status = dev->board->trigger_init(dev, ch, want->trigger_signal,
+                                              &trigger);
+            if (status != 0) {
+                return status;
+            }
+
+            trigger.role = want->trigger_role;
+            arm          = want->trigger_role != BLADERF_TRIGGER_ROLE_DISABLED;
+
+            return dev->board->trigger_arm(dev, &trigger, arm, 0, 0);
+
+        default:
+            assert(!"Invalid profile field");
+            return BLADERF_ERR_UNEXPECTED;
+    }
+}
+
+static void store_channel_field(struct bladerf_channel_profile *known,
+                                const struct bladerf_channel_profile *want,
+                                uint32_t field)
+{
+    switch (field) {
+        case BLADERF_PROFILE_FREQUENCY:
+            known->frequency = want->frequency;
+            break;
+
+        case BLADERF_PROFILE_SAMPLE_RATE:
+            known->sample_rate = want->sample_rate;
+            break;
+
+        case BLADERF_PROFILE_BANDWIDTH:
+            known->bandwidth = want->bandwidth;
+            break;
+
+        case BLADERF_PROFILE_GAIN_MODE:
+            known->gain_mode = want->gain_mode;
+            break;
+
+        case BLADERF_PROFILE_GAIN:
+            known->gain = want->gain;
+            break;
+
+        case BLADERF_PROFILE_RF_PORT:
+            memcpy(known->rf_port, want->rf_port, sizeof(known->rf_port));
+            break;
+
+        case BLADERF_PROFILE_TRIGGER:
+            known->trigger_signal = want->trigger_signal;
+            known->trigger_role   = want->trigger_role;
+            break;
+    }
+
+    known->fields |= field;
+}
+
+static int read_channel_field(struct bladerf *dev, bladerf_channel ch,
+                              uint32_t field, uint64_t *value)
+{
+    bladerf_frequency freq;
+    bladerf_bandwidth bw;
+    bladerf_sample_rate rate;
+    int status;
+
+    switch (field) {
+        case BLADERF_PROFILE_FREQUENCY:
+            status = dev->board->get_frequency(dev, ch, &freq);
+            *value = freq;
+            return status;
+
+        case BLADERF_PROFILE_BANDWIDTH:
+            status = dev->board->get_bandwidth(dev, ch, &bw);
+            *value = bw;
+            return status;
+
+        case BLADERF_PROFILE_SAMPLE_RATE:
+            status = dev->board->get_sample_rate(dev, ch, &rate);
+            *value = rate;
+            return status;
+
+        default:
+            return BLADERF_ERR_UNSUPPORTED;
+    }
+}
+
+/* A setting applied to `ch` may also have changed it on other channels,
+ * depending on the hardware (e.g., the AD9361's RX channels share an LO).
+ * Rather than encode each board's coupling here, read back the setting from
+ * the other channels in `dir` (or all channels, for BLADERF_DIRECTION_MASK).
+ *
+ * Channels now reporting the same value as `ch` are taken to have been set
+ * along with it, and are recorded with the value requested in `want`. This
+ * keeps them consistent with `ch` when the hardware's actual value differs
+ * slightly from the requested one. */
+static void refresh(struct bladerf *dev, bladerf_channel ch, int dir,
+                    const struct bladerf_channel_profile *want, uint32_t field)
+{
+    uint64_t actual, other_actual;
+    size_t d, i;
+
+    if (read_channel_field(dev, ch, field, &actual) != 0) {
+        forget(dev, dir, field);
+        channel_profile(&dev->profile, ch)->fields |= field;
+        return;
+    }
+
+    for (d = 0; d < ARRAY_SIZE(directions); d++) {
+        if (dir != BLADERF_DIRECTION_MASK && dir != (int)directions[d]) {
+            continue;
+        }
+
+        for (i = 0; i < num_channels(dev, directions[d]); i++) {
+            bladerf_channel other = channel(directions[d], i);
+            struct bladerf_channel_profile *known;
+
+            if (other == ch) {
+                continue;
+            }
+
+            known = channel_profile(&dev->profile, other);
+
+            if (read_channel_field(dev, other, field, &other_actual) != 0) {
+                known->fields &= ~field;
+            } else if (other_actual == actual) {
+                store_channel_field(known, want, field);
+            } else {
+                struct bladerf_channel_profile tmp;
+
+                tmp.frequency   = other_actual;
+                tmp.bandwidth   = (bladerf_bandwidth)other_actual;
+                tmp.sample_rate = (bladerf_sample_rate)other_actual;
+
+                store_channel_field(known, &tmp, field);
+            }
+        }
+    }
+}
+
+static int apply_channel_field(struct bladerf *dev,
+                               bladerf_channel ch,
+                               const struct bladerf_channel_profile *want,
+                               uint32_t field,
+                               unsigned int *num_changes)
+{
+    struct bladerf_channel_profile *known = channel_profile(&dev->profile, ch);
+    bladerf_direction dir = BLADERF_CHANNEL_IS_TX(ch) ? BLADERF_TX : BLADERF_RX;
+    int status;
+
+    if (!(want->fields & field)) {
+        return 0;
+    }
+
+    /* Manual gain is meaningless while the AGC is in control */
+    if (field == BLADERF_PROFILE_GAIN &&
+        (want->fields & BLADERF_PROFILE_GAIN_MODE) &&
+        want->gain_mode == BLADERF_GAIN_AUTOMATIC) {
+        return 0;
+    }
+
+    if ((known->fields & field) && channel_field_equal(known, want, field)) {
+        return 0;
+    }
+
+    status = set_channel_field(dev, ch, want, field);
+    if (status != 0) {
+        log_debug("%s: Failed to apply setting 0x%x to channel %d: %s\n",
+                  __FUNCTION__, field, ch, bladerf_strerror(status));
+        profile_invalidate(dev, ch, field);
+        return status;
+    }
+
+    store_channel_field(known, want, field);
+    (*num_changes)++;
+
+    switch (field) {
+        case BLADERF_PROFILE_FREQUENCY:
+            forget(dev, dir, BLADERF_PROFILE_RF_PORT | BLADERF_PROFILE_GAIN);
+            refresh(dev, ch, dir, want, field);
+            break;
+
+        case BLADERF_PROFILE_BANDWIDTH:
+            refresh(dev, ch, dir, want, field);
+            break;
+
+        case BLADERF_PROFILE_SAMPLE_RATE:
+            refresh(dev, ch, BLADERF_DIRECTION_MASK, want, field);
+            break;
+
+        case BLADERF_PROFILE_GAIN_MODE:
+            known->fields &= ~BLADERF_PROFILE_GAIN;
+            break;
+    }
+
+    return 0;
+}
+
+int profile_apply(struct bladerf *dev, const struct bladerf_profile *profile)
+{
+    unsigned int num_changes = 0;
+    size_t d, f, i;
+    int status;
+
+    /* Reject the profile before changing anything if it describes channels
+     * that this device does not have */
+    for (d = 0; d < ARRAY_SIZE(directions); d++) {
+        for (i = num_channels(dev, directions[d]);
+             i < BLADERF_PROFILE_MAX_CHANNELS; i++) {
+            bladerf_channel ch = channel(directions[d], i);
+
+            if (channel_profile_const(profile, ch)->fields != 0) {
+                log_debug("%s: Device does not have channel %d\n",
+                          __FUNCTION__, ch);
+                return BLADERF_ERR_INVAL;
+            }
+        }
+    }
+
+    /* Device-wide settings determine the signal path, so they go first */
+    if ((profile->fields & BLADERF_PROFILE_LOOPBACK) &&
+        !((dev->profile.fields & BLADERF_PROFILE_LOOPBACK) &&
+          dev->profile.loopback == profile->loopback)) {
+
+        status = dev->board->set_loopback(dev, profile->loopback);
+        profile_invalidate(dev, BLADERF_CHANNEL_INVALID,
+                           BLADERF_PROFILE_LOOPBACK);
+        if (status != 0) {
+            return status;
+        }
+
+        dev->profile.loopback = profile->loopback;
+        dev->profile.fields |= BLADERF_PROFILE_LOOPBACK;
+        num_changes++;
+    }
+
+    if ((profile->fields & BLADERF_PROFILE_RX_MUX) &&
+        !((dev->profile.fields & BLADERF_PROFILE_RX_MUX) &&
+          dev->profile.rx_mux == profile->rx_mux)) {
+
+        status = dev->board->set_rx_mux(dev, profile->rx_mux);
+        profile_invalidate(dev, BLADERF_CHANNEL_INVALID,
+                           BLADERF_PROFILE_RX_MUX);
+        if (status != 0) {
+            return status;
+        }
+
+        dev->profile.rx_mux = profile->rx_mux;
+        dev->profile.fields |= BLADERF_PROFILE_RX_MUX;
+        num_changes++;
+    }
+
+    /* Apply each setting across all channels before moving on to the next,
+     * so that a setting is never applied before one it depends upon */
+    for (f = 0; f < ARRAY_SIZE(channel_fields); f++) {
+        for (d = 0; d < ARRAY_SIZE(directions); d++) {
+            for (i = 0; i < num_channels(dev, directions[d]); i++) {
+                bladerf_channel ch = channel(directions[d], i);
+
+                status = apply_channel_field(
+                    dev, ch, channel_profile_const(profile, ch),
+                    channel_fields[f], &num_changes);
+
+                if (status != 0) {
+                    return status;
+                }
+            }
+        }
+    }
+
+    log_debug("%s: Applied %u setting(s)\n", __FUNCTION__, num_changes);
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file profile.h
+ *
+ * @brief Configuration profile capture and diff-based application
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <libbladeRF.h>
+
+/**
+ * Read the device's current configuration into `profile`, and record it as
+ * the device's known configuration.
+ *
+ * @pre dev->lock is held
+ */
+int profile_capture(struct bladerf *dev, struct bladerf_profile *profile);
+
+/**
+ * Apply the settings in `profile` that differ from the device's known
+ * configuration.
+ *
+ * @pre dev->lock is held
+ */
+int profile_apply(struct bladerf *dev, const struct bladerf_profile *profile);
+
+/**
+ * Note that the specified setting(s) may have been changed outside of
+ * profile_apply(), such that they are no longer known. This accounts for
+ * settings coupled to those specified.
+ *
+ * @param   dev     Device handle
+ * @param   ch      Channel, or BLADERF_CHANNEL_INVALID for device-wide fields
+ * @param   fields  Bitmask of BLADERF_PROFILE_* values
+ */
+void profile_invalidate(struct bladerf *dev, bladerf_channel ch,
+                        uint32_t fields);
+
+/**
+ * Forget the device's known configuration entirely, e.g., after a raw
+ * register write or FPGA load.
+ */
+void profile_invalidate_all(struct bladerf *dev);
+
+#endif  // PROFILE_H_
@@ -0,0 +1,373 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libbladeRF.h>
+
+#include "board/board.h"
+#include "host_config.h"
+#include "log.h"
+#include "rel_assert.h"
+#include "thread.h"
+
+#include "helpers/telemetry.h"
+#include "helpers/timeout.h"
+#include "helpers/wallclock.h"
+
+#define DEFAULT_INTERVAL_MS     1000
+#define DEFAULT_HISTORY_LEN     60
+
+/* How long to back off when the device is busy with a control operation */
+#define RETRY_MS                1
+
+#define NSEC_PER_MSEC           1000000ULL
+
+/* Snapshots are published through a sequence lock: the telemetry thread makes
+ * `seq` odd while updating them, and readers retry until they have copied
+ * them out while `seq` was even and unchanged.
+ *
+ * The data itself is copied a word at a time with relaxed atomic accesses, so
+ * that a reader racing with an update merely sees a torn copy, which it then
+ * discards. */
+#if defined(_MSC_VER)
+#   include <windows.h>
+#   define SEQ_LOAD(p)     ((uint64_t)InterlockedCompareExchange64( \
+                                (volatile LONG64 *)(p), 0, 0))
+#   define SEQ_STORE(p, v) InterlockedExchange64((volatile LONG64 *)(p), \
+                                                 (LONG64)(v))
+#   define SEQ_FENCE()     MemoryBarrier()
+#   define WORD_LOAD(p)    (*(volatile const uint64_t *)(p))
+#   define WORD_STORE(p, v) (*(volatile uint64_t *)(p) = (v))
+#else
+#   define SEQ_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#   define SEQ_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#   define SEQ_FENCE()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#   define WORD_LOAD(p)    __atomic_load_n((p), __ATOMIC_RELAXED)
+#   define WORD_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#endif
+
+#define SNAPSHOT_WORDS \
+    ((sizeof(struct bladerf_telemetry) + sizeof(uint64_t) - 1) / \
+     sizeof(uint64_t))
+
+/* A published snapshot, as the words it is copied in and out by */
+union snapshot {
+    struct bladerf_telemetry data;
+    uint64_t words[SNAPSHOT_WORDS];
+};
+
+struct telemetry {
+    struct bladerf *dev;
+    struct bladerf_telemetry_config config;
+
+    pthread_t thread;
+
+    /* Protects `stop` */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool stop;
+
+    /* Snapshot being assembled. Only accessed by the telemetry thread. */
+    struct bladerf_telemetry current;
+
+    /* Published snapshots, protected by `seq` */
+    uint64_t seq;
+    uint64_t count;                     /* Total published */
+    union snapshot *history;            /* Ring of config.history_len */
+};
+
+/* Sleep for up to `ms`, returning false if the thread has been asked to stop */
+static bool wait_ms(struct telemetry *t, unsigned int ms)
+{
+    struct timespec timeout_abs;
+    bool stop;
+
+    MUTEX_LOCK(&t->lock);
+
+    if (!t->stop && populate_abs_timeout(&timeout_abs, ms) == 0) {
+        pthread_cond_timedwait(&t->cond, &t->lock, &timeout_abs);
+    }
+
+    stop = t->stop;
+
+    MUTEX_UNLOCK(&t->lock);
+
+    return !stop;
+}
+
+/* Read a single item, waiting for the device to be idle. Gives up with
+ * BLADERF_ERR_TIMEOUT if it does not become idle before `deadline_ns`. */
+static int sample_item(struct telemetry *t, uint32_t item,
+                       uint64_t deadline_ns)
+{
+    struct bladerf *dev = t->dev;
+    int status;
+
+    while (pthread_mutex_trylock(&dev->lock) != 0) {
+        t->current.deferred++;
+
+        if (wallclock_get_current_nsec() + RETRY_MS * NSEC_PER_MSEC >=
+                deadline_ns ||
+            !wait_ms(t, RETRY_MS)) {
+            return BLADERF_ERR_TIMEOUT;
+        }
+    }
+
+    if (item == BLADERF_TELEMETRY_VCTCXO_TRIM) {
+        status = dev->board->trim_dac_read(dev, &t->current.vctcxo_trim);
+    } else {
+        status = dev->board->read_telemetry(dev, item, &t->current);
+    }
+
+    MUTEX_UNLOCK(&dev->lock);
+
+    return status;
+}
+
+static void publish(struct telemetry *t, uint32_t updated)
+{
+    const uint64_t seq = t->seq;
+    union snapshot *dst;
+    union snapshot src;
+    size_t i;
+
+    t->current.sequence++;
+    t->current.time_ns = wallclock_get_current_nsec();
+    t->current.updated = updated;
+    t->current.valid  |= updated;
+
+    SEQ_STORE(&t->seq, seq + 1);
+    SEQ_FENCE();
+
+    memset(&src, 0, sizeof(src));
+    src.data = t->current;
+    dst      = &t->history[t->count % t->config.history_len];
+
+    for (i = 0; i < SNAPSHOT_WORDS; i++) {
+        WORD_STORE(&dst->words[i], src.words[i]);
+    }
+
+    WORD_STORE(&t->count, t->count + 1);
+
+    SEQ_FENCE();
+    SEQ_STORE(&t->seq, seq + 2);
+}
+
+static void *telemetry_thread(void *arg)
+{
+    struct telemetry *t         = arg;
+    const uint64_t interval_ns  = t->config.interval_ms * NSEC_PER_MSEC;
+    uint32_t items              = t->config.items;
+    uint64_t deadline           = wallclock_get_current_nsec();
+    uint64_t now;
+    uint32_t item, updated;
+    int status;
+
+    do {
+        /* Each item should be sampled before the next snapshot is due */
+        deadline += interval_ns;
+        updated   = 0;
+
+        for (item = 1; item & BLADERF_TELEMETRY_ALL; item <<= 1) {
+            if (!(items & item)) {
+                continue;
+            }
+
+            status = sample_item(t, item, deadline);
+            if (status == 0) {
+                updated |= item;
+            } else if (status == BLADERF_ERR_UNSUPPORTED) {
+                log_debug("%s: item 0x%02x is not supported, dropping it\n",
+                          __FUNCTION__, item);
+                items &= ~item;
+            } else if (status != BLADERF_ERR_TIMEOUT) {
+                log_verbose("%s: failed to read item 0x%02x: %s\n",
+                            __FUNCTION__, item, bladerf_strerror(status));
+            }
+        }
+
+        publish(t, updated);
+
+        /* If we've fallen behind, don't try to catch up */
+        now = wallclock_get_current_nsec();
+        if (now >= deadline) {
+            deadline = now;
+        }
+    } while (wait_ms(t, (unsigned int)((deadline - now) / NSEC_PER_MSEC)));
+
+    return NULL;
+}
+
+int telemetry_enable(struct bladerf *dev,
+                     const struct bladerf_telemetry_config *config)
+{
+    struct telemetry *t;
+    int status;
+
+    telemetry_disable(dev);
+
+    t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    t->dev = dev;
+
+    if (config != NULL) {
+        t->config = *config;
+    }
+
+    if (t->config.interval_ms == 0) {
+        t->config.interval_ms = DEFAULT_INTERVAL_MS;
+    }
+
+    if (t->config.history_len == 0) {
+        t->config.history_len = DEFAULT_HISTORY_LEN;
+    }
+
+    if (t->config.items == 0) {
+        t->config.items = BLADERF_TELEMETRY_ALL;
+    } else if (t->config.items & ~BLADERF_TELEMETRY_ALL) {
+        log_debug("%s: invalid items: 0x%08x\n", __FUNCTION__,
+                  t->config.items);
+        status = BLADERF_ERR_INVAL;
+        goto error;
+    }
+
+    t->history = calloc(t->config.history_len, sizeof(t->history[0]));
+    if (t->history == NULL) {
+        status = BLADERF_ERR_MEM;
+        goto error;
+    }
+
+    MUTEX_INIT(&t->lock);
+    pthread_cond_init(&t->cond, NULL);
+
+    status = pthread_create(&t->thread, NULL, telemetry_thread, t);
+    if (status != 0) {
+        log_debug("%s: pthread_create failed: %d\n", __FUNCTION__, status);
+        pthread_cond_destroy(&t->cond);
+        pthread_mutex_destroy(&t->lock);
+        status = BLADERF_ERR_UNEXPECTED;
+        goto error;
+    }
+
+    dev->telemetry = t;
+    return 0;
+
+error:
+    free(t->history);
+    free(t);
+    return status;
+}
+
+void telemetry_disable(struct bladerf *dev)
+{
+    struct telemetry *t = dev->telemetry;
+
+    if (t == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(&t->lock);
+    t->stop = true;
+    pthread_cond_signal(&t->cond);
+    MUTEX_UNLOCK(&t->lock);
+
+    pthread_join(t->thread, NULL);
+
+    pthread_cond_destroy(&t->cond);
+    pthread_mutex_destroy(&t->lock);
+
+    dev->telemetry = NULL;
+
+    free(t->history);
+    free(t);
+}
+
+int telemetry_get(struct bladerf *dev, struct bladerf_telemetry *snapshot)
+{
+    unsigned int actual;
+    int status;
+
+    status = telemetry_get_history(dev, snapshot, 1, &actual);
+    if (status == 0 && actual == 0) {
+        memset(snapshot, 0, sizeof(*snapshot));
+    }
+
+    return status;
+}
+
+int telemetry_get_history(struct bladerf *dev,
+                          struct bladerf_telemetry *snapshots,
+                          unsigned int count,
+                          unsigned int *actual)
+{
+    const struct telemetry *t = dev->telemetry;
+    const uint64_t len        = t ? t->config.history_len : 0;
+    union snapshot copy;
+    uint64_t seq, total, first, i;
+    uint64_t n = 0;
+    size_t w;
+
+    if (t == NULL) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    do {
+        seq = SEQ_LOAD(&t->seq);
+        if (seq & 1) {
+            continue;
+        }
+
+        total = WORD_LOAD(&t->count);
+
+        n = total;
+        if (n > len) {
+            n = len;
+        }
+
+        if (n > count) {
+            n = count;
+        }
+
+        first = total - n;
+
+        for (i = 0; i < n; i++) {
+            const union snapshot *src = &t->history[(first + i) % len];
+
+            for (w = 0; w < SNAPSHOT_WORDS; w++) {
+                copy.words[w] = WORD_LOAD(&src->words[w]);
+            }
+
+            snapshots[i] = copy.data;
+        }
+
+        SEQ_FENCE();
+    } while ((seq & 1) || SEQ_LOAD(&t->seq) != seq);
+
+    *actual = (unsigned int)n;
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Background telemetry sampling
+ *
+ * See the FN_TELEMETRY group in libbladeRF.h.
+ */
+
+#ifndef HELPERS_TELEMETRY_H_
+#define HELPERS_TELEMETRY_H_
+
+#include <libbladeRF.h>
+
+/**
+ * Start the device's telemetry thread, stopping any that is already running
+ *
+ * @pre dev->lock is not held by the caller
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int telemetry_enable(struct bladerf *dev,
+                     const struct bladerf_telemetry_config *config);
+
+/**
+ * Stop the device's telemetry thread and free its resources, if enabled
+ *
+ * @pre dev->lock is not held by the caller
+ */
+void telemetry_disable(struct bladerf *dev);
+
+/**
+ * Copy out the most recent snapshot, without blocking
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if telemetry is not enabled
+ */
+int telemetry_get(struct bladerf *dev, struct bladerf_telemetry *snapshot);
+
+/**
+ * Copy out up to `count` of the most recent snapshots, oldest first, without
+ * blocking
+ *
+ * @return 0 on success, BLADERF_ERR_INVAL if telemetry is not enabled
+ */
+int telemetry_get_history(struct bladerf *dev,
+                          struct bladerf_telemetry *snapshots,
+                          unsigned int count,
+                          unsigned int *actual);
+
+#endif
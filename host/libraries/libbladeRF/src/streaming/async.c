@@ -28,9 +28,17 @@
 #include "backend/usb/usb.h"
 
 #include "async.h"
+#include "buffers.h"
+#include "faults.h"
 #include "board/board.h"
 #include "helpers/timeout.h"
 
+/* Total stream buffer size, in bytes, at or above which huge pages are
+ * requested for the stream's buffers */
+#ifndef STREAM_HUGEPAGE_THRESHOLD
+#   define STREAM_HUGEPAGE_THRESHOLD (2 * 1024 * 1024)
+#endif
+
 int async_init_stream(struct bladerf_stream **stream,
                       struct bladerf *dev,
                       bladerf_stream_cb callback,
@@ -43,7 +51,7 @@ int async_init_stream(struct bladerf_stream **stream,
 {
     struct bladerf_stream *lstream;
     size_t buffer_size_bytes;
-    size_t i;
+    uint32_t buffer_flags = 0;
     int status = 0;
 
     if (num_transfers > num_buffers) {
@@ -85,6 +93,8 @@ int async_init_stream(struct bladerf_stream **stream,
     lstream->cb = callback;
     lstream->user_data = user_data;
     lstream->buffers = NULL;
+    lstream->faults = NULL;
+    lstream->wire_format = BLADERF_WIRE_FORMAT_SC16;
 
     switch(format) {
         case BLADERF_FORMAT_SC16_Q11:
@@ -98,30 +108,25 @@ int async_init_stream(struct bladerf_stream **stream,
     }
 
     if (!status) {
-        lstream->buffers = calloc(num_buffers, sizeof(lstream->buffers[0]));
-        if (lstream->buffers) {
-            for (i = 0; i < num_buffers && !status; i++) {
-                lstream->buffers[i] = calloc(1, buffer_size_bytes);
-                if (!lstream->buffers[i]) {
-                    status = BLADERF_ERR_MEM;
-                }
-            }
-        } else {
-            status = BLADERF_ERR_MEM;
+        /* Large buffer sets are where TLB pressure starts to show up at high
+         * sample rates, so back them with huge pages where available */
+        if (num_buffers * buffer_size_bytes >= STREAM_HUGEPAGE_THRESHOLD) {
+            buffer_flags |= BLADERF_SAMPLE_BUFFER_HUGEPAGES;
         }
-    }
 
-    /* Clean up everything we've allocated if we hit any errors */
-    if (status) {
-
-        if (lstream->buffers) {
-            for (i = 0; i < num_buffers; i++) {
-                free(lstream->buffers[i]);
-            }
+        status = buffers_alloc(&lstream->buffers, num_buffers,
+                               buffer_size_bytes, buffer_flags);
+    }
 
-            free(lstream->buffers);
+    if (!status) {
+        status = faults_attach(lstream);
+        if (status) {
+            buffers_free(lstream->buffers);
         }
+    }
 
+    /* Clean up everything we've allocated if we hit any errors */
+    if (status) {
         free(lstream);
     } else {
         /* Perform any backend-specific stream initialization */
@@ -170,6 +175,7 @@ int async_run_stream(struct bladerf_stream *stream, bladerf_channel_layout layou
 
     MUTEX_LOCK(&stream->lock);
     stream->layout = layout;
+    stream->wire_format = dev->wire_format[layout & BLADERF_DIRECTION_MASK];
     stream->state = STREAM_RUNNING;
     pthread_cond_signal(&stream->stream_started);
     MUTEX_UNLOCK(&stream->lock);
@@ -232,8 +238,6 @@ error:
 
 void async_deinit_stream(struct bladerf_stream *stream)
 {
-    size_t i;
-
     if (!stream) {
         log_debug("%s called with NULL stream\n", __FUNCTION__);
         return;
@@ -248,12 +252,9 @@ void async_deinit_stream(struct bladerf_stream *stream)
     stream->dev->backend->deinit_stream(stream);
 
     /* Free up the buffers */
-    for (i = 0; i < stream->num_buffers; i++) {
-        free(stream->buffers[i]);
-    }
+    buffers_free(stream->buffers);
 
-    /* Free up the pointer to the buffers */
-    free(stream->buffers);
+    faults_detach(stream);
 
     /* Free up the stream itself */
     free(stream);
@@ -29,6 +29,7 @@
 #include "thread.h"
 
 #include "format.h"
+#include "packing.h"
 
 typedef enum {
     STREAM_IDLE,          /* Idle and initialized */
@@ -61,14 +62,37 @@ struct bladerf_stream {
     pthread_cond_t can_submit_buffer;
     pthread_cond_t stream_started;
     void *backend_data;
+
+    /* Fault injection state, if enabled. See faults.h. */
+    struct stream_faults *faults;
+
+    /* Representation of samples over USB. This is latched from the device's
+     * setting for the stream's direction in async_run_stream(). */
+    bladerf_wire_format wire_format;
 };
 
 /* Get the number of bytes per stream buffer */
 static inline size_t async_stream_buf_bytes(struct bladerf_stream *s)
 {
+    if (s->wire_format != BLADERF_WIRE_FORMAT_SC16) {
+        return wire_format_bytes_per_sample(s->wire_format) *
+               s->samples_per_buffer;
+    }
+
     return samples_to_bytes(s->format, s->samples_per_buffer);
 }
 
+/* Convert a transfer length to a number of samples */
+static inline size_t async_stream_bytes_to_samples(struct bladerf_stream *s,
+                                                   size_t n_bytes)
+{
+    if (s->wire_format != BLADERF_WIRE_FORMAT_SC16) {
+        return n_bytes / wire_format_bytes_per_sample(s->wire_format);
+    }
+
+    return bytes_to_samples(s->format, n_bytes);
+}
+
 int async_init_stream(struct bladerf_stream **stream,
                       struct bladerf *dev,
                       bladerf_stream_cb callback,
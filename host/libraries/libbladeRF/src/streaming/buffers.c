@@ -0,0 +1,196 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_config.h"
+
+#if !BLADERF_OS_WINDOWS
+#include <sys/mman.h>
+#endif
+
+#include "log.h"
+
+#include "streaming/buffers.h"
+
+#define PAGE_BYTES      4096
+#define HUGEPAGE_BYTES  (2 * 1024 * 1024)
+
+/* Backing memory for a set of buffers. A pointer to this is stashed in the
+ * slot preceding the first entry of the buffer array handed to the caller. */
+struct buffer_region {
+    void *base;
+    size_t bytes;
+    bool mapped; /* Allocated via mmap(), rather than from the heap */
+};
+
+static inline size_t round_up(size_t n, size_t multiple)
+{
+    return ((n + multiple - 1) / multiple) * multiple;
+}
+
+static void *heap_alloc(size_t bytes, size_t alignment)
+{
+#if BLADERF_OS_WINDOWS
+    return _aligned_malloc(bytes, alignment);
+#else
+    void *ptr;
+    return posix_memalign(&ptr, alignment, bytes) == 0 ? ptr : NULL;
+#endif
+}
+
+static void heap_free(void *ptr)
+{
+#if BLADERF_OS_WINDOWS
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static int region_alloc(struct buffer_region *r, size_t bytes, uint32_t flags)
+{
+    size_t alignment = PAGE_BYTES;
+
+    r->mapped = false;
+
+    if (flags & BLADERF_SAMPLE_BUFFER_HUGEPAGES) {
+        alignment = HUGEPAGE_BYTES;
+        bytes     = round_up(bytes, HUGEPAGE_BYTES);
+
+#ifdef MAP_HUGETLB
+        r->base = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (r->base != MAP_FAILED) {
+            r->bytes  = bytes;
+            r->mapped = true;
+            return 0;
+        }
+
+        log_debug("No reserved huge pages available for %llu bytes. "
+                  "Falling back to transparent huge pages.\n",
+                  (unsigned long long)bytes);
+#endif
+    } else {
+        bytes = round_up(bytes, PAGE_BYTES);
+    }
+
+    r->base = heap_alloc(bytes, alignment);
+    if (r->base == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    r->bytes = bytes;
+
+#ifdef MADV_HUGEPAGE
+    if (flags & BLADERF_SAMPLE_BUFFER_HUGEPAGES) {
+        /* This is only advice; failure just leaves us with regular pages */
+        madvise(r->base, r->bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    return 0;
+}
+
+static void region_free(struct buffer_region *r)
+{
+#if !BLADERF_OS_WINDOWS
+    if (r->mapped) {
+        munmap(r->base, r->bytes);
+        return;
+    }
+#endif
+
+    heap_free(r->base);
+}
+
+int buffers_alloc(void ***buffers,
+                  size_t num_buffers,
+                  size_t buffer_bytes,
+                  uint32_t flags)
+{
+    struct buffer_region *region;
+    void **ptrs;
+    size_t stride, i;
+    int status;
+
+    if (buffers == NULL || num_buffers == 0 || buffer_bytes == 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    stride = round_up(buffer_bytes, BLADERF_SAMPLE_BUFFER_ALIGNMENT);
+    if (stride > (SIZE_MAX - HUGEPAGE_BYTES) / num_buffers) {
+        log_debug("%s: Requested allocation is too large.\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    region = calloc(1, sizeof(*region));
+    ptrs   = calloc(num_buffers + 1, sizeof(ptrs[0]));
+
+    if (region == NULL || ptrs == NULL) {
+        status = BLADERF_ERR_MEM;
+        goto error;
+    }
+
+    status = region_alloc(region, stride * num_buffers, flags);
+    if (status != 0) {
+        goto error;
+    }
+
+    /* Zero the region from the calling thread. In addition to providing
+     * calloc()-like semantics, this faults in every page now rather than in
+     * the data path, and under the default first-touch policy places them on
+     * the caller's NUMA node. */
+    memset(region->base, 0, region->bytes);
+
+    ptrs[0] = region;
+    for (i = 0; i < num_buffers; i++) {
+        ptrs[i + 1] = (uint8_t *)region->base + i * stride;
+    }
+
+    *buffers = &ptrs[1];
+    return 0;
+
+error:
+    free(ptrs);
+    free(region);
+    return status;
+}
+
+void buffers_free(void **buffers)
+{
+    void **ptrs;
+    struct buffer_region *region;
+
+    if (buffers == NULL) {
+        return;
+    }
+
+    ptrs   = buffers - 1;
+    region = (struct buffer_region *)ptrs[0];
+
+    region_free(region);
+    free(region);
+    free(ptrs);
+}
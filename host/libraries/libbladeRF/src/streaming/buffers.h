@@ -0,0 +1,57 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef STREAMING_BUFFERS_H_
+#define STREAMING_BUFFERS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <libbladeRF.h>
+
+/**
+ * Allocate a set of sample buffers from a single zero-filled region
+ *
+ * Each buffer begins on a ::BLADERF_SAMPLE_BUFFER_ALIGNMENT boundary. The
+ * region is page-aligned, and is backed by huge pages where possible when
+ * ::BLADERF_SAMPLE_BUFFER_HUGEPAGES is specified.
+ *
+ * @param[out]  buffers         Upon success, updated to point to an array of
+ *                              `num_buffers` buffer pointers
+ * @param[in]   num_buffers     Number of buffers
+ * @param[in]   buffer_bytes    Size of each buffer, in bytes
+ * @param[in]   flags           Bitmask of BLADERF_SAMPLE_BUFFER_* flags
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int buffers_alloc(void ***buffers,
+                  size_t num_buffers,
+                  size_t buffer_bytes,
+                  uint32_t flags);
+
+/**
+ * Free buffers allocated by buffers_alloc()
+ *
+ * @param   buffers     Buffer array to free. May be NULL.
+ */
+void buffers_free(void **buffers);
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include <libbladeRF.h>
+
+#include "log.h"
+#include "rel_assert.h"
+#include "thread.h"
+
+#include "dsp_pool.h"
+
+struct dsp_pool_slot {
+    void *job;
+    bool finished;
+};
+
+struct dsp_pool {
+    dsp_pool_fn work;
+    dsp_pool_fn done;
+    void *arg;
+
+    pthread_t *threads;
+    unsigned int num_threads;
+
+    /* Outstanding jobs, in order of submission. The following should be
+     * accessed while holding `lock`. */
+    struct dsp_pool_slot *slots;
+    unsigned int num_slots;
+    unsigned int head;      /* Oldest outstanding job */
+    unsigned int count;     /* Number of outstanding jobs */
+    unsigned int next;      /* Next job to be started */
+    unsigned int unstarted; /* Number of jobs not yet started */
+    bool retiring;          /* A thread is calling done functions */
+    bool shutdown;
+
+    MUTEX lock;
+    pthread_cond_t job_ready;   /* A job has been submitted */
+    pthread_cond_t job_retired; /* Jobs have been reported done */
+};
+
+/* Report every finished job at the head of the queue as done. Only one
+ * thread does so at a time, which keeps the reports in order.
+ *
+ * Assumes the pool lock is held */
+static void retire_jobs(struct dsp_pool *p)
+{
+    if (p->retiring) {
+        /* The retiring thread will pick up this job too */
+        return;
+    }
+
+    p->retiring = true;
+
+    while (p->count > 0 && p->slots[p->head].finished) {
+        void *job = p->slots[p->head].job;
+
+        p->slots[p->head].finished = false;
+        p->head = (p->head + 1) % p->num_slots;
+        p->count--;
+
+        MUTEX_UNLOCK(&p->lock);
+        p->done(p->arg, job);
+        MUTEX_LOCK(&p->lock);
+    }
+
+    p->retiring = false;
+    pthread_cond_broadcast(&p->job_retired);
+}
+
+static void *dsp_pool_thread(void *arg)
+{
+    struct dsp_pool *p = (struct dsp_pool *)arg;
+    unsigned int slot;
+
+    MUTEX_LOCK(&p->lock);
+
+    while (true) {
+        while (p->unstarted == 0 && !p->shutdown) {
+            pthread_cond_wait(&p->job_ready, &p->lock);
+        }
+
+        if (p->unstarted == 0) {
+            break;
+        }
+
+        slot    = p->next;
+        p->next = (p->next + 1) % p->num_slots;
+        p->unstarted--;
+
+        MUTEX_UNLOCK(&p->lock);
+        p->work(p->arg, p->slots[slot].job);
+        MUTEX_LOCK(&p->lock);
+
+        p->slots[slot].finished = true;
+        retire_jobs(p);
+    }
+
+    MUTEX_UNLOCK(&p->lock);
+    return NULL;
+}
+
+int dsp_pool_create(struct dsp_pool **pool,
+                    unsigned int num_threads,
+                    unsigned int max_jobs,
+                    dsp_pool_fn work,
+                    dsp_pool_fn done,
+                    void *arg)
+{
+    struct dsp_pool *p;
+    unsigned int i;
+    int status;
+
+    *pool = NULL;
+
+    if (num_threads == 0 || num_threads > DSP_POOL_MAX_THREADS ||
+        max_jobs == 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    p = (struct dsp_pool *)calloc(1, sizeof(*p));
+    if (p == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    p->work      = work;
+    p->done      = done;
+    p->arg       = arg;
+    p->num_slots = max_jobs;
+
+    p->slots   = (struct dsp_pool_slot *)calloc(max_jobs, sizeof(p->slots[0]));
+    p->threads = (pthread_t *)calloc(num_threads, sizeof(p->threads[0]));
+    if (p->slots == NULL || p->threads == NULL) {
+        free(p->slots);
+        free(p->threads);
+        free(p);
+        return BLADERF_ERR_MEM;
+    }
+
+    MUTEX_INIT(&p->lock);
+    pthread_cond_init(&p->job_ready, NULL);
+    pthread_cond_init(&p->job_retired, NULL);
+
+    for (i = 0; i < num_threads; i++) {
+        status = pthread_create(&p->threads[i], NULL, dsp_pool_thread, p);
+        if (status != 0) {
+            log_debug("%s: pthread_create failed: %d\n", __FUNCTION__, status);
+            dsp_pool_destroy(p);
+            return BLADERF_ERR_UNEXPECTED;
+        }
+
+        p->num_threads++;
+    }
+
+    *pool = p;
+    return 0;
+}
+
+int dsp_pool_submit(struct dsp_pool *p, void *job)
+{
+    unsigned int slot;
+
+    MUTEX_LOCK(&p->lock);
+
+    if (p->count == p->num_slots) {
+        MUTEX_UNLOCK(&p->lock);
+        return BLADERF_ERR_QUEUE_FULL;
+    }
+
+    slot = (p->head + p->count) % p->num_slots;
+    p->slots[slot].job      = job;
+    p->slots[slot].finished = false;
+
+    p->count++;
+    p->unstarted++;
+
+    pthread_cond_signal(&p->job_ready);
+    MUTEX_UNLOCK(&p->lock);
+
+    return 0;
+}
+
+void dsp_pool_drain(struct dsp_pool *p)
+{
+    MUTEX_LOCK(&p->lock);
+
+    while (p->count > 0 || p->retiring) {
+        pthread_cond_wait(&p->job_retired, &p->lock);
+    }
+
+    MUTEX_UNLOCK(&p->lock);
+}
+
+void dsp_pool_destroy(struct dsp_pool *p)
+{
+    unsigned int i;
+
+    if (p == NULL) {
+        return;
+    }
+
+    if (p->num_threads > 0) {
+        dsp_pool_drain(p);
+    }
+
+    MUTEX_LOCK(&p->lock);
+    p->shutdown = true;
+    pthread_cond_broadcast(&p->job_ready);
+    MUTEX_UNLOCK(&p->lock);
+
+    for (i = 0; i < p->num_threads; i++) {
+        pthread_join(p->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&p->job_ready);
+    pthread_cond_destroy(&p->job_retired);
+    MUTEX_DESTROY(&p->lock);
+
+    free(p->threads);
+    free(p->slots);
+    free(p);
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* DSP worker pool
+ *
+ * A fixed set of threads that process jobs concurrently, but report their
+ * completion strictly in the order the jobs were submitted. This allows
+ * per-buffer processing of a stream to be spread across cores without the
+ * consumer of the results having to reorder them.
+ *
+ * Each job's work function may run on any pool thread, concurrently with
+ * others. Its done function runs on a pool thread once the job and all jobs
+ * submitted before it have finished, and never concurrently with another done
+ * function. Neither is called with any of the pool's locks held.
+ */
+
+#ifndef STREAMING_DSP_POOL_H_
+#define STREAMING_DSP_POOL_H_
+
+/* Upper bound on the number of threads in a pool */
+#define DSP_POOL_MAX_THREADS 16
+
+struct dsp_pool;
+
+/**
+ * Process a job
+ *
+ * @param   arg     User data provided to dsp_pool_create()
+ * @param   job     Job provided to dsp_pool_submit()
+ */
+typedef void (*dsp_pool_fn)(void *arg, void *job);
+
+/**
+ * Create a pool and start its threads
+ *
+ * @param[out]  pool        Created pool
+ * @param[in]   num_threads Number of threads, 1 to DSP_POOL_MAX_THREADS
+ * @param[in]   max_jobs    Maximum number of jobs that may be outstanding,
+ *                          i.e., submitted but not yet done
+ * @param[in]   work        Function to process a job
+ * @param[in]   done        Function to report a job's completion, in order
+ * @param[in]   arg         User data passed to `work` and `done`
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int dsp_pool_create(struct dsp_pool **pool,
+                    unsigned int num_threads,
+                    unsigned int max_jobs,
+                    dsp_pool_fn work,
+                    dsp_pool_fn done,
+                    void *arg);
+
+/**
+ * Submit a job. This does not block.
+ *
+ * @return 0 on success, BLADERF_ERR_QUEUE_FULL if `max_jobs` are outstanding
+ */
+int dsp_pool_submit(struct dsp_pool *pool, void *job);
+
+/**
+ * Wait until all submitted jobs are done
+ *
+ * This must not be called with any lock that a done function acquires held.
+ */
+void dsp_pool_drain(struct dsp_pool *pool);
+
+/**
+ * Drain the pool, stop its threads, and free it. This is a no-op if `pool`
+ * is NULL.
+ */
+void dsp_pool_destroy(struct dsp_pool *pool);
+
+#endif
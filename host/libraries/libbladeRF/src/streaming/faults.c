@@ -0,0 +1,319 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+
+#include "board/board.h"
+
+#include "faults.h"
+
+/* Per-device configuration and statistics */
+struct faults {
+    bool enabled;
+    struct bladerf_stream_faults cfg;
+
+    MUTEX lock; /* Protects stats, which are shared by RX and TX streams */
+    struct bladerf_stream_fault_stats stats;
+};
+
+/* Per-stream state, passed to the interposed callback as its user data */
+struct stream_faults {
+    struct faults *dev_faults;
+    struct bladerf_stream_faults cfg;
+    uint64_t rng;
+    bool seeded;
+
+    /* The callback and user data we've interposed on */
+    bladerf_stream_cb cb;
+    void *user_data;
+};
+
+/* xorshift64* */
+static uint64_t rng_next(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * UINT64_C(2685821657736338717);
+}
+
+/* Uniformly distributed value in [0, 1) */
+static double rng_uniform(uint64_t *state)
+{
+    return (rng_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static bool rng_event(uint64_t *state, double prob)
+{
+    return prob > 0.0 && rng_uniform(state) < prob;
+}
+
+static void count(struct faults *f, uint64_t *counter)
+{
+    MUTEX_LOCK(&f->lock);
+    (*counter)++;
+    MUTEX_UNLOCK(&f->lock);
+}
+
+static void *faults_stream_cb(struct bladerf *dev,
+                              struct bladerf_stream *stream,
+                              struct bladerf_metadata *meta,
+                              void *samples,
+                              size_t num_samples,
+                              void *user_data)
+{
+    struct stream_faults *sf = user_data;
+    struct faults *f         = sf->dev_faults;
+    unsigned int delay_us    = sf->cfg.delay_us;
+    bool rx = (stream->layout & BLADERF_DIRECTION_MASK) == BLADERF_RX;
+
+    /* The initial TX callbacks request buffers, rather than complete them */
+    if (samples == NULL) {
+        return sf->cb(dev, stream, meta, samples, num_samples, sf->user_data);
+    }
+
+    /* The direction isn't known until the stream is running. Give RX and TX
+     * distinct, but repeatable, sequences. The zero state is a fixed point
+     * of the generator, so avoid it. */
+    if (!sf->seeded) {
+        sf->rng = (sf->cfg.seed + (rx ? 1 : 2)) * UINT64_C(0x9E3779B97F4A7C15);
+        sf->rng = sf->rng ? sf->rng : 1;
+        sf->seeded = true;
+    }
+
+    count(f, &f->stats.completions);
+
+    /* Report this transfer as having timed out, as a backend would */
+    if (rng_event(&sf->rng, sf->cfg.timeout_prob)) {
+        log_debug("%s: Injecting transfer timeout\n", __FUNCTION__);
+        count(f, &f->stats.timeouts);
+        stream->error_code = BLADERF_ERR_TIMEOUT;
+        return BLADERF_STREAM_SHUTDOWN;
+    }
+
+    if (rng_event(&sf->rng, sf->cfg.stall_prob)) {
+        log_debug("%s: Injecting %u ms stall\n", __FUNCTION__,
+                  sf->cfg.stall_ms);
+        count(f, &f->stats.stalls);
+        delay_us += sf->cfg.stall_ms * 1000;
+    }
+
+    if (sf->cfg.jitter_us != 0) {
+        delay_us += (unsigned int)(rng_next(&sf->rng) %
+                                   ((uint64_t)sf->cfg.jitter_us + 1));
+    }
+
+    /* This blocks the backend's completion handling, just as a slow or
+     * descheduled event thread would */
+    if (delay_us != 0) {
+        count(f, &f->stats.delayed);
+        usleep(delay_us);
+    }
+
+    /* Drop the completion: the samples are lost, and the buffer is simply
+     * resubmitted without its owner ever seeing it. TX buffers must always
+     * be returned to their owner, so this is only applicable to RX. */
+    if (rx && rng_event(&sf->rng, sf->cfg.drop_prob)) {
+        count(f, &f->stats.dropped);
+        return samples;
+    }
+
+    return sf->cb(dev, stream, meta, samples, num_samples, sf->user_data);
+}
+
+static int parse_env(struct bladerf_stream_faults *cfg, const char *str)
+{
+    char *copy, *token, *saveptr = NULL;
+    int status = 0;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    copy = strdup(str);
+    if (copy == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    for (token = strtok_r(copy, ",", &saveptr); token != NULL && status == 0;
+         token = strtok_r(NULL, ",", &saveptr)) {
+
+        char *value = strchr(token, '=');
+
+        if (value == NULL) {
+            status = BLADERF_ERR_INVAL;
+            break;
+        }
+
+        *value++ = '\0';
+
+        if (!strcmp(token, "seed")) {
+            cfg->seed = strtoull(value, NULL, 0);
+        } else if (!strcmp(token, "delay_us")) {
+            cfg->delay_us = (unsigned int)strtoul(value, NULL, 0);
+        } else if (!strcmp(token, "jitter_us")) {
+            cfg->jitter_us = (unsigned int)strtoul(value, NULL, 0);
+        } else if (!strcmp(token, "drop")) {
+            cfg->drop_prob = strtod(value, NULL);
+        } else if (!strcmp(token, "timeout")) {
+            cfg->timeout_prob = strtod(value, NULL);
+        } else if (!strcmp(token, "stall")) {
+            cfg->stall_prob = strtod(value, NULL);
+        } else if (!strcmp(token, "stall_ms")) {
+            cfg->stall_ms = (unsigned int)strtoul(value, NULL, 0);
+        } else {
+            status = BLADERF_ERR_INVAL;
+        }
+
+        if (status != 0) {
+            log_warning("Invalid %s entry: %s\n", FAULTS_ENV_VAR, token);
+        }
+    }
+
+    free(copy);
+    return status;
+}
+
+static bool valid_prob(double p)
+{
+    return p >= 0.0 && p <= 1.0;
+}
+
+int faults_set(struct bladerf *dev, const struct bladerf_stream_faults *faults)
+{
+    if (faults != NULL &&
+        (!valid_prob(faults->drop_prob) || !valid_prob(faults->timeout_prob) ||
+         !valid_prob(faults->stall_prob))) {
+        log_debug("%s: Probabilities must be within [0, 1]\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    if (dev->faults == NULL) {
+        dev->faults = calloc(1, sizeof(*dev->faults));
+        if (dev->faults == NULL) {
+            return BLADERF_ERR_MEM;
+        }
+
+        MUTEX_INIT(&dev->faults->lock);
+    }
+
+    if (faults != NULL) {
+        dev->faults->enabled = true;
+        dev->faults->cfg     = *faults;
+    } else {
+        dev->faults->enabled = false;
+    }
+
+    return 0;
+}
+
+int faults_get_stats(struct bladerf *dev,
+                     struct bladerf_stream_fault_stats *stats)
+{
+    if (dev->faults == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return 0;
+    }
+
+    MUTEX_LOCK(&dev->faults->lock);
+    *stats = dev->faults->stats;
+    MUTEX_UNLOCK(&dev->faults->lock);
+
+    return 0;
+}
+
+int faults_attach(struct bladerf_stream *stream)
+{
+    struct bladerf *dev = stream->dev;
+    struct stream_faults *sf;
+    const char *env;
+    int status;
+
+    /* A configuration provided via the API takes precedence */
+    if (dev->faults == NULL) {
+        struct bladerf_stream_faults cfg;
+
+        env = getenv(FAULTS_ENV_VAR);
+        if (env == NULL) {
+            return 0;
+        }
+
+        status = parse_env(&cfg, env);
+        if (status == 0) {
+            status = faults_set(dev, &cfg);
+        }
+
+        if (status != 0) {
+            return status;
+        }
+
+        log_info("Injecting stream faults per %s=\"%s\"\n",
+                 FAULTS_ENV_VAR, env);
+    }
+
+    /* Counts start over with each stream configuration */
+    MUTEX_LOCK(&dev->faults->lock);
+    memset(&dev->faults->stats, 0, sizeof(dev->faults->stats));
+    MUTEX_UNLOCK(&dev->faults->lock);
+
+    if (!dev->faults->enabled) {
+        return 0;
+    }
+
+    sf = calloc(1, sizeof(*sf));
+    if (sf == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    sf->dev_faults = dev->faults;
+    sf->cfg        = dev->faults->cfg;
+    sf->cb         = stream->cb;
+    sf->user_data  = stream->user_data;
+
+    stream->faults    = sf;
+    stream->cb        = faults_stream_cb;
+    stream->user_data = sf;
+
+    return 0;
+}
+
+void faults_detach(struct bladerf_stream *stream)
+{
+    if (stream->faults != NULL) {
+        stream->cb        = stream->faults->cb;
+        stream->user_data = stream->faults->user_data;
+        free(stream->faults);
+        stream->faults = NULL;
+    }
+}
+
+void faults_free(struct bladerf *dev)
+{
+    if (dev->faults != NULL) {
+        MUTEX_DESTROY(&dev->faults->lock);
+    }
+
+    free(dev->faults);
+    dev->faults = NULL;
+}
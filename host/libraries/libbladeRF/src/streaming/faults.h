@@ -0,0 +1,122 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Stream fault injection
+ *
+ * When enabled, this interposes on the transfer completion callback that the
+ * backend invokes for each stream, between the backend and the stream's
+ * owner (e.g., the sync worker). Completions may then be delayed, stalled,
+ * dropped, or turned into transfer timeouts, per a seeded PRNG so that runs
+ * are repeatable.
+ *
+ * This is only built when ENABLE_LIBBLADERF_FAULT_INJECTION is defined.
+ */
+
+#ifndef STREAMING_FAULTS_H_
+#define STREAMING_FAULTS_H_
+
+#include <libbladeRF.h>
+
+#include "async.h"
+
+/**
+ * Environment variable consulted for a fault configuration when none has been
+ * provided via bladerf_set_stream_faults(). It contains comma-separated
+ * key=value pairs, e.g.:
+ *
+ *  "seed=42,delay_us=100,jitter_us=50,drop=0.01,timeout=0.001,stall=0.0001"
+ *
+ * Recognized keys are those of struct bladerf_stream_faults, with `drop`,
+ * `timeout`, and `stall` corresponding to the *_prob fields.
+ */
+#define FAULTS_ENV_VAR "BLADERF_STREAM_FAULTS"
+
+#ifdef ENABLE_LIBBLADERF_FAULT_INJECTION
+
+/**
+ * Set or clear (when `faults` is NULL) the device's fault configuration. This
+ * applies to streams initialized after this call.
+ *
+ * @pre dev->lock is held
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int faults_set(struct bladerf *dev, const struct bladerf_stream_faults *faults);
+
+/**
+ * Retrieve the number of faults injected across all of the device's streams
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int faults_get_stats(struct bladerf *dev,
+                     struct bladerf_stream_fault_stats *stats);
+
+/**
+ * Interpose on the stream's callback, if fault injection is configured, and
+ * reset the device's fault counts
+ *
+ * @pre stream->cb and stream->user_data have been initialized
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int faults_attach(struct bladerf_stream *stream);
+
+/**
+ * Release resources allocated by faults_attach(). No-op if nothing was
+ * attached.
+ */
+void faults_detach(struct bladerf_stream *stream);
+
+/**
+ * Release the device's fault configuration
+ */
+void faults_free(struct bladerf *dev);
+
+#else
+
+static inline int faults_set(struct bladerf *dev,
+                             const struct bladerf_stream_faults *faults)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static inline int faults_get_stats(struct bladerf *dev,
+                                   struct bladerf_stream_fault_stats *stats)
+{
+    return BLADERF_ERR_UNSUPPORTED;
+}
+
+static inline int faults_attach(struct bladerf_stream *stream)
+{
+    return 0;
+}
+
+static inline void faults_detach(struct bladerf_stream *stream)
+{
+}
+
+static inline void faults_free(struct bladerf *dev)
+{
+}
+
+#endif
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "rel_assert.h"
+
+#include "streaming/packing.h"
+
+/* RX unpacking is in the data path of every received sample, so it has
+ * SSE2/SSSE3 implementations on x86. These are selected at runtime, so that
+ * the library need not be built for a particular CPU. Other platforms, and
+ * the tails of buffers, use the portable implementations. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define PACKING_X86 1
+#   include <immintrin.h>
+#endif
+
+/* Saturate an SC16 Q11 value to the 12-bit range of the packed formats */
+static inline unsigned int clamp12(int16_t v)
+{
+    return (unsigned int)(v < -2048 ? -2048 : (v > 2047 ? 2047 : v));
+}
+
+/* Sign-extend a 12-bit value */
+static inline int16_t sext12(unsigned int v)
+{
+    return (int16_t)((int16_t)(v << 4) >> 4);
+}
+
+static void unpack_sc12(const uint8_t *src, int16_t *dest, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        const uint8_t *b = &src[3 * i];
+
+        dest[2 * i]     = sext12(b[0] | ((b[1] & 0x0f) << 8));
+        dest[2 * i + 1] = sext12((b[1] >> 4) | (b[2] << 4));
+    }
+}
+
+static void unpack_sc8(const uint8_t *src, int16_t *dest, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < 2 * n; i++) {
+        dest[i] = (int16_t)((int8_t)src[i] * 16);
+    }
+}
+
+#ifdef PACKING_X86
+/* Returns the number of samples converted, which is a multiple of 4 */
+__attribute__((target("ssse3")))
+static size_t unpack_sc12_ssse3(const uint8_t *src, int16_t *dest, size_t n)
+{
+    /* Gather the two bytes containing each 12-bit value into a 16-bit lane:
+     * bytes (0, 1) for I, and bytes (1, 2) for Q */
+    const __m128i shuf = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5,
+                                       6, 7, 7, 8, 9, 10, 10, 11);
+    const __m128i i_lanes = _mm_set1_epi32(0x0000ffff);
+    size_t i;
+
+    /* 4 samples (12 bytes) are converted per iteration, but 16 bytes are
+     * loaded, so stop short of the end of the buffer */
+    for (i = 0; i + 6 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[3 * i]);
+        __m128i iv, qv;
+
+        v  = _mm_shuffle_epi8(v, shuf);
+
+        /* I occupies the low 12 bits of its lane, and Q the high 12 bits of
+         * its lane. Arithmetic shifts leave both sign-extended. */
+        iv = _mm_srai_epi16(_mm_slli_epi16(v, 4), 4);
+        qv = _mm_srai_epi16(v, 4);
+
+        v = _mm_or_si128(_mm_and_si128(i_lanes, iv),
+                         _mm_andnot_si128(i_lanes, qv));
+
+        _mm_storeu_si128((__m128i *)&dest[2 * i], v);
+    }
+
+    return i;
+}
+
+/* Returns the number of samples converted, which is a multiple of 8 */
+__attribute__((target("sse2")))
+static size_t unpack_sc8_sse2(const uint8_t *src, int16_t *dest, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[2 * i]);
+
+        /* Placing each byte in the high half of a 16-bit lane and shifting
+         * it back down by 4 yields the sign-extended value, times 16 */
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(zero, v), 4);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(zero, v), 4);
+
+        _mm_storeu_si128((__m128i *)&dest[2 * i], lo);
+        _mm_storeu_si128((__m128i *)&dest[2 * i + 8], hi);
+    }
+
+    return i;
+}
+
+static bool have_ssse3(void)
+{
+    static int supported = -1;
+
+    if (supported < 0) {
+        supported = __builtin_cpu_supports("ssse3") ? 1 : 0;
+    }
+
+    return supported == 1;
+}
+
+static bool have_sse2(void)
+{
+    static int supported = -1;
+
+    if (supported < 0) {
+        supported = __builtin_cpu_supports("sse2") ? 1 : 0;
+    }
+
+    return supported == 1;
+}
+#endif
+
+void packing_unpack(bladerf_wire_format fmt,
+                    const uint8_t *src,
+                    int16_t *dest,
+                    size_t n)
+{
+    size_t done = 0;
+
+    switch (fmt) {
+        case BLADERF_WIRE_FORMAT_SC16:
+            memcpy(dest, src, n * 2 * sizeof(int16_t));
+            break;
+
+        case BLADERF_WIRE_FORMAT_SC12:
+#ifdef PACKING_X86
+            if (have_ssse3()) {
+                done = unpack_sc12_ssse3(src, dest, n);
+            }
+#endif
+            unpack_sc12(&src[3 * done], &dest[2 * done], n - done);
+            break;
+
+        case BLADERF_WIRE_FORMAT_SC8:
+#ifdef PACKING_X86
+            if (have_sse2()) {
+                done = unpack_sc8_sse2(src, dest, n);
+            }
+#endif
+            unpack_sc8(&src[2 * done], &dest[2 * done], n - done);
+            break;
+
+        default:
+            assert(!"Invalid wire format");
+            break;
+    }
+}
+
+void packing_pack(bladerf_wire_format fmt,
+                  const int16_t *src,
+                  uint8_t *dest,
+                  size_t n)
+{
+    size_t i;
+
+    switch (fmt) {
+        case BLADERF_WIRE_FORMAT_SC16:
+            memcpy(dest, src, n * 2 * sizeof(int16_t));
+            break;
+
+        case BLADERF_WIRE_FORMAT_SC12:
+            for (i = 0; i < n; i++) {
+                unsigned int s_i = clamp12(src[2 * i]) & 0xfff;
+                unsigned int s_q = clamp12(src[2 * i + 1]) & 0xfff;
+
+                dest[3 * i]     = (uint8_t)s_i;
+                dest[3 * i + 1] = (uint8_t)((s_i >> 8) | (s_q << 4));
+                dest[3 * i + 2] = (uint8_t)(s_q >> 4);
+            }
+            break;
+
+        case BLADERF_WIRE_FORMAT_SC8:
+            for (i = 0; i < 2 * n; i++) {
+                dest[i] = (uint8_t)((clamp12(src[i]) & 0xfff) >> 4);
+            }
+            break;
+
+        default:
+            assert(!"Invalid wire format");
+            break;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Conversions between SC16 Q11 samples and the packed wire formats that may be
+ * used to carry them over USB. See bladerf_wire_format for the layouts. */
+
+#ifndef STREAMING_PACKING_H_
+#define STREAMING_PACKING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <libbladeRF.h>
+
+/**
+ * @return Number of bytes occupied by one sample in the specified wire format,
+ *         or 0 if the wire format is invalid
+ */
+static inline size_t wire_format_bytes_per_sample(bladerf_wire_format fmt)
+{
+    switch (fmt) {
+        case BLADERF_WIRE_FORMAT_SC16:
+            return 4;
+
+        case BLADERF_WIRE_FORMAT_SC12:
+            return 3;
+
+        case BLADERF_WIRE_FORMAT_SC8:
+            return 2;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Update a config GPIO register value to select the specified wire format for
+ * the specified direction
+ */
+static inline uint32_t wire_format_gpio(uint32_t gpio_val,
+                                        bladerf_direction dir,
+                                        bladerf_wire_format fmt)
+{
+    if (dir == BLADERF_RX) {
+        gpio_val &= ~BLADERF_GPIO_RX_WIRE_FORMAT_MASK;
+        gpio_val |= ((uint32_t)fmt << BLADERF_GPIO_RX_WIRE_FORMAT_SHIFT);
+    } else {
+        gpio_val &= ~BLADERF_GPIO_TX_WIRE_FORMAT_MASK;
+        gpio_val |= ((uint32_t)fmt << BLADERF_GPIO_TX_WIRE_FORMAT_SHIFT);
+    }
+
+    return gpio_val;
+}
+
+/**
+ * Convert `n` samples from the specified wire format into SC16 Q11
+ *
+ * @param[in]   fmt     Wire format of `src`
+ * @param[in]   src     Packed samples
+ * @param[out]  dest    SC16 Q11 samples (2*n int16_t values)
+ * @param[in]   n       Number of samples
+ */
+void packing_unpack(bladerf_wire_format fmt,
+                    const uint8_t *src,
+                    int16_t *dest,
+                    size_t n);
+
+/**
+ * Convert `n` SC16 Q11 samples into the specified wire format. Values outside
+ * of [-2048, 2047] are saturated.
+ *
+ * @param[in]   fmt     Wire format of `dest`
+ * @param[in]   src     SC16 Q11 samples (2*n int16_t values)
+ * @param[out]  dest    Packed samples
+ * @param[in]   n       Number of samples
+ */
+void packing_pack(bladerf_wire_format fmt,
+                  const int16_t *src,
+                  uint8_t *dest,
+                  size_t n);
+
+#endif
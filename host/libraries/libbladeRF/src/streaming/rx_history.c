@@ -0,0 +1,200 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+
+#include <libbladeRF.h>
+
+#include "log.h"
+#include "minmax.h"
+#include "rel_assert.h"
+
+#include "rx_history.h"
+
+static inline struct rx_history_run *run(struct rx_history *h, unsigned int i)
+{
+    return &h->runs[(h->first_run + i) % RX_HISTORY_MAX_RUNS];
+}
+
+static inline const struct rx_history_run *crun(const struct rx_history *h,
+                                                unsigned int i)
+{
+    return &h->runs[(h->first_run + i) % RX_HISTORY_MAX_RUNS];
+}
+
+static void drop_first_run(struct rx_history *h)
+{
+    h->first_run = (h->first_run + 1) % RX_HISTORY_MAX_RUNS;
+    h->num_runs--;
+}
+
+int rx_history_init(struct rx_history *h, uint64_t capacity)
+{
+    if (capacity == 0 || capacity > SIZE_MAX / sizeof(h->samples[0])) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    h->samples = malloc((size_t)capacity * sizeof(h->samples[0]));
+    if (h->samples == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    h->capacity = capacity;
+    rx_history_clear(h);
+
+    return 0;
+}
+
+void rx_history_deinit(struct rx_history *h)
+{
+    free(h->samples);
+    h->samples  = NULL;
+    h->capacity = 0;
+    rx_history_clear(h);
+}
+
+void rx_history_clear(struct rx_history *h)
+{
+    h->first_run = 0;
+    h->num_runs  = 0;
+}
+
+uint64_t rx_history_end(const struct rx_history *h)
+{
+    assert(h->num_runs > 0);
+    return crun(h, h->num_runs - 1)->end;
+}
+
+void rx_history_record(struct rx_history *h, uint64_t timestamp,
+                       const void *samples, unsigned int n)
+{
+    const uint32_t *src = (const uint32_t *)samples;
+    struct rx_history_run *last;
+    uint64_t end, oldest;
+    size_t off, count;
+
+    if (h->samples == NULL || n == 0) {
+        return;
+    }
+
+    if (!rx_history_empty(h) && timestamp < rx_history_end(h)) {
+        log_debug("%s: Timestamp moved backwards (t=%" PRIu64 ", end=%"
+                  PRIu64 "). Discarding history.\n", __FUNCTION__,
+                  timestamp, rx_history_end(h));
+        rx_history_clear(h);
+    }
+
+    /* Only the newest `capacity` samples can be retained */
+    if (n > h->capacity) {
+        const unsigned int skip = n - (unsigned int)h->capacity;
+        src       += skip;
+        timestamp += skip;
+        n         -= skip;
+    }
+
+    off   = (size_t)(timestamp % h->capacity);
+    count = (size_t)u64_min(n, h->capacity - off);
+
+    memcpy(&h->samples[off], src, count * sizeof(h->samples[0]));
+    memcpy(h->samples, src + count, (n - count) * sizeof(h->samples[0]));
+
+    if (!rx_history_empty(h) && rx_history_end(h) == timestamp) {
+        run(h, h->num_runs - 1)->end += n;
+    } else {
+        if (h->num_runs == RX_HISTORY_MAX_RUNS) {
+            drop_first_run(h);
+        }
+
+        last        = run(h, h->num_runs++);
+        last->start = timestamp;
+        last->end   = timestamp + n;
+    }
+
+    /* Forget about samples that have just been overwritten */
+    end    = rx_history_end(h);
+    oldest = (end > h->capacity) ? end - h->capacity : 0;
+
+    while (run(h, 0)->end <= oldest) {
+        drop_first_run(h);
+    }
+
+    if (run(h, 0)->start < oldest) {
+        run(h, 0)->start = oldest;
+    }
+}
+
+static void copy_out(const struct rx_history *h, uint64_t timestamp,
+                     uint32_t *dest, size_t n)
+{
+    const size_t off   = (size_t)(timestamp % h->capacity);
+    const size_t count = (size_t)u64_min(n, h->capacity - off);
+
+    memcpy(dest, &h->samples[off], count * sizeof(h->samples[0]));
+    memcpy(dest + count, h->samples, (n - count) * sizeof(h->samples[0]));
+}
+
+int rx_history_read(const struct rx_history *h, uint64_t timestamp,
+                    void *samples, unsigned int n, bool *gap)
+{
+    uint32_t *dest     = (uint32_t *)samples;
+    const uint64_t end = timestamp + n;
+    uint64_t pos       = timestamp;
+    unsigned int i;
+
+    *gap = false;
+
+    if (rx_history_empty(h) || timestamp < crun(h, 0)->start) {
+        return BLADERF_ERR_TIME_PAST;
+    }
+
+    assert(end <= rx_history_end(h));
+
+    for (i = 0; i < h->num_runs && pos < end; i++) {
+        const struct rx_history_run *r = crun(h, i);
+        size_t count;
+
+        if (r->end <= pos) {
+            continue;
+        }
+
+        if (r->start > pos) {
+            count = (size_t)(u64_min(r->start, end) - pos);
+            memset(dest, 0, count * sizeof(dest[0]));
+
+            dest += count;
+            pos  += count;
+            *gap  = true;
+        }
+
+        if (pos < end) {
+            count = (size_t)(u64_min(r->end, end) - pos);
+            copy_out(h, pos, dest, count);
+
+            dest += count;
+            pos  += count;
+        }
+    }
+
+    return 0;
+}
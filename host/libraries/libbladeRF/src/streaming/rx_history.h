@@ -0,0 +1,121 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* RX history
+ *
+ * Ring of the most recently received SC16 Q11 samples, indexed by timestamp.
+ * The sample at timestamp t lives at slot (t % capacity), so a lookup is a
+ * modulo and a copy. Discontinuities in the stream are tracked as a short
+ * list of contiguous runs of valid timestamps.
+ *
+ * Callers provide their own locking.
+ */
+
+#ifndef STREAMING_RX_HISTORY_H_
+#define STREAMING_RX_HISTORY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Maximum number of discontinuities tracked within the history. When more
+ * occur, the oldest run is forgotten. */
+#define RX_HISTORY_MAX_RUNS 64
+
+struct rx_history_run {
+    uint64_t start; /* Timestamp of the first sample in the run */
+    uint64_t end;   /* Timestamp following the last sample in the run */
+};
+
+struct rx_history {
+    uint32_t *samples;  /* SC16 Q11 samples, NULL if history is disabled */
+    uint64_t capacity;  /* Number of samples in the ring */
+
+    struct rx_history_run runs[RX_HISTORY_MAX_RUNS];
+    unsigned int first_run;
+    unsigned int num_runs;
+};
+
+/**
+ * Allocate a history of the specified number of samples
+ *
+ * @param[out]  h           History to initialize
+ * @param[in]   capacity    Number of samples to retain. Must be non-zero.
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int rx_history_init(struct rx_history *h, uint64_t capacity);
+
+/**
+ * Free a history's resources. This is a no-op if `h` was never initialized
+ * or has already been deinitialized, provided it was zeroed beforehand.
+ */
+void rx_history_deinit(struct rx_history *h);
+
+/**
+ * Discard all recorded samples
+ */
+void rx_history_clear(struct rx_history *h);
+
+/**
+ * Record samples received at the specified timestamp. Samples that precede
+ * the end of the history indicate that the stream has been restarted, in
+ * which case the previous contents are discarded.
+ *
+ * @param       h           History
+ * @param[in]   timestamp   Timestamp of the first sample
+ * @param[in]   samples     SC16 Q11 samples
+ * @param[in]   n           Number of samples
+ */
+void rx_history_record(struct rx_history *h, uint64_t timestamp,
+                       const void *samples, unsigned int n);
+
+/**
+ * @return true if nothing has been recorded
+ */
+static inline bool rx_history_empty(const struct rx_history *h)
+{
+    return h->num_runs == 0;
+}
+
+/**
+ * @return Timestamp following the newest recorded sample. Only valid when
+ *         the history is not empty.
+ */
+uint64_t rx_history_end(const struct rx_history *h);
+
+/**
+ * Copy samples out of the history. Timestamps within the interval that
+ * were never received (i.e. overruns) are zero-filled.
+ *
+ * @param       h           History
+ * @param[in]   timestamp   Timestamp of the first sample to read
+ * @param[out]  samples     SC16 Q11 sample buffer
+ * @param[in]   n           Number of samples to read. The interval must not
+ *                          extend past rx_history_end().
+ * @param[out]  gap         Set to true if any samples were zero-filled
+ *
+ * @return 0 on success, BLADERF_ERR_TIME_PAST if part of the interval has
+ *         already been overwritten
+ */
+int rx_history_read(const struct rx_history *h, uint64_t timestamp,
+                    void *samples, unsigned int n, bool *gap);
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include <libbladeRF.h>
+
+#include "log.h"
+
+#include "streaming/slots.h"
+
+struct tx_worker {
+    struct bladerf *dev;
+    struct bladerf_slot *slots;
+    unsigned int num_slots;
+    unsigned int timeout_ms;
+};
+
+/* Within each direction, slots must be in order and must not overlap */
+static bool plan_valid(const struct bladerf_slot *slots, unsigned int num_slots)
+{
+    bladerf_timestamp end[2] = { 0, 0 };
+    unsigned int i;
+
+    for (i = 0; i < num_slots; i++) {
+        const struct bladerf_slot *s = &slots[i];
+
+        if ((s->dir != BLADERF_RX && s->dir != BLADERF_TX) ||
+            s->samples == NULL || s->num_samples == 0) {
+            log_debug("%s: Slot %u is invalid\n", __FUNCTION__, i);
+            return false;
+        }
+
+        if (s->timestamp < end[s->dir]) {
+            log_debug("%s: Slot %u is out of order or overlaps the previous "
+                      "%s slot\n", __FUNCTION__, i,
+                      s->dir == BLADERF_TX ? "TX" : "RX");
+            return false;
+        }
+
+        end[s->dir] = s->timestamp + s->num_samples;
+    }
+
+    return true;
+}
+
+static void run_slot(struct bladerf *dev, struct bladerf_slot *slot,
+                     unsigned int timeout_ms)
+{
+    struct bladerf_metadata meta;
+
+    memset(&meta, 0, sizeof(meta));
+    meta.timestamp = slot->timestamp;
+
+    if (slot->dir == BLADERF_TX) {
+        meta.flags = BLADERF_META_FLAG_TX_BURST_START |
+                     BLADERF_META_FLAG_TX_BURST_END;
+
+        slot->status = bladerf_sync_tx(dev, slot->samples, slot->num_samples,
+                                       &meta, timeout_ms);
+    } else {
+        slot->status = bladerf_sync_rx(dev, slot->samples, slot->num_samples,
+                                       &meta, timeout_ms);
+
+        if (slot->status == 0 && meta.actual_count != slot->num_samples) {
+            slot->status = BLADERF_ERR_UNEXPECTED;
+        }
+    }
+
+    slot->meta_status = meta.status;
+
+    if (slot->status != 0) {
+        log_debug("%s: %s slot at %" PRIu64 " failed: %s\n", __FUNCTION__,
+                  slot->dir == BLADERF_TX ? "TX" : "RX", slot->timestamp,
+                  bladerf_strerror(slot->status));
+    }
+}
+
+static void run_direction(struct bladerf *dev, struct bladerf_slot *slots,
+                          unsigned int num_slots, bladerf_direction dir,
+                          unsigned int timeout_ms)
+{
+    unsigned int i;
+
+    for (i = 0; i < num_slots; i++) {
+        if (slots[i].dir == dir) {
+            run_slot(dev, &slots[i], timeout_ms);
+        }
+    }
+}
+
+static void *tx_thread(void *arg)
+{
+    struct tx_worker *w = arg;
+    run_direction(w->dev, w->slots, w->num_slots, BLADERF_TX, w->timeout_ms);
+    return NULL;
+}
+
+int slots_run(struct bladerf *dev,
+              struct bladerf_slot *slots,
+              unsigned int num_slots,
+              unsigned int timeout_ms)
+{
+    struct tx_worker worker;
+    pthread_t thread;
+    bool have_tx = false;
+    unsigned int i;
+    int status;
+
+    if (slots == NULL || !plan_valid(slots, num_slots)) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    for (i = 0; i < num_slots; i++) {
+        slots[i].status      = BLADERF_ERR_UNEXPECTED;
+        slots[i].meta_status = 0;
+        have_tx |= (slots[i].dir == BLADERF_TX);
+    }
+
+    if (have_tx) {
+        worker.dev        = dev;
+        worker.slots      = slots;
+        worker.num_slots  = num_slots;
+        worker.timeout_ms = timeout_ms;
+
+        /* Queue up the TX bursts while RX windows are read here, so neither
+         * direction waits on the other */
+        status = pthread_create(&thread, NULL, tx_thread, &worker);
+        if (status != 0) {
+            log_debug("%s: pthread_create failed: %d\n", __FUNCTION__, status);
+            return BLADERF_ERR_UNEXPECTED;
+        }
+    }
+
+    run_direction(dev, slots, num_slots, BLADERF_RX, timeout_ms);
+
+    if (have_tx) {
+        pthread_join(thread, NULL);
+    }
+
+    for (i = 0; i < num_slots; i++) {
+        if (slots[i].status != 0) {
+            return slots[i].status;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/* Half-duplex slot scheduling
+ *
+ * See the FN_STREAMING_SLOTS group in libbladeRF.h.
+ */
+
+#ifndef STREAMING_SLOTS_H_
+#define STREAMING_SLOTS_H_
+
+#include <libbladeRF.h>
+
+int slots_run(struct bladerf *dev,
+              struct bladerf_slot *slots,
+              unsigned int num_slots,
+              unsigned int timeout_ms);
+
+#endif
@@ -35,6 +35,7 @@
 #include "sync.h"
 #include "sync_worker.h"
 #include "metadata.h"
+#include "packing.h"
 
 #include "board/board.h"
 #include "helpers/timeout.h"
@@ -124,6 +125,28 @@ static inline unsigned int samples_per_msg(size_t msg_size,
     return (unsigned int) n;
 }
 
+/* Number of per-channel arrays expected by sync_rxv()/sync_txv() */
+static unsigned int num_channels(struct bladerf_sync *s)
+{
+    switch (s->stream_config.layout) {
+        case BLADERF_RX_X2:
+        case BLADERF_TX_X2:
+            return 2;
+
+        default:
+            return 1;
+    }
+}
+
+/* Size of the RX history ring. Whole buffers are recorded as soon as the
+ * consumer reaches them, so an extra buffer's worth of samples ensures the
+ * requested length is retained behind the sample being consumed. */
+static uint64_t history_capacity(struct bladerf_sync *s)
+{
+    return (uint64_t)s->history_len * num_channels(s) +
+           s->stream_config.samples_per_buffer;
+}
+
 int sync_init(struct bladerf_sync *sync,
               struct bladerf *dev,
               bladerf_channel_layout layout,
@@ -137,6 +160,7 @@ int sync_init(struct bladerf_sync *sync,
 {
     int status = 0;
     size_t i, bytes_per_sample;
+    bladerf_wire_format wire_format;
 
     if (num_transfers >= num_buffers) {
         return BLADERF_ERR_INVAL;
@@ -153,6 +177,13 @@ int sync_init(struct bladerf_sync *sync,
             return BLADERF_ERR_INVAL;
     }
 
+    /* Packed wire formats have been validated against the format by the
+     * board's perform_format_config() */
+    wire_format = dev->wire_format[layout & BLADERF_DIRECTION_MASK];
+    if (wire_format != BLADERF_WIRE_FORMAT_SC16) {
+        bytes_per_sample = wire_format_bytes_per_sample(wire_format);
+    }
+
     /* bladeRF GPIF DMA requirement */
     if ((bytes_per_sample * buffer_size) % 4096 != 0) {
         return BLADERF_ERR_INVAL;
@@ -183,6 +214,7 @@ int sync_init(struct bladerf_sync *sync,
     sync->stream_config.samples_per_buffer = (unsigned int)buffer_size;
     sync->stream_config.num_xfers = num_transfers;
     sync->stream_config.timeout_ms = stream_timeout;
+    sync->stream_config.wire_format = wire_format;
     sync->stream_config.bytes_per_sample = bytes_per_sample;
 
     sync->meta.state = SYNC_META_STATE_HEADER;
@@ -227,6 +259,18 @@ int sync_init(struct bladerf_sync *sync,
             sync->meta.msg_timestamp = 0;
             sync->meta.msg_flags = 0;
 
+            sync->buf_mgmt.num_completed = 0;
+            memset(&sync->buf_mgmt.overrun, 0, sizeof(sync->buf_mgmt.overrun));
+
+            if (format == BLADERF_FORMAT_SC16_Q11_META &&
+                sync->history_len > 0) {
+                status = rx_history_init(&sync->history,
+                                         history_capacity(sync));
+                if (status < 0) {
+                    goto error;
+                }
+            }
+
             break;
 
         case BLADERF_TX:
@@ -261,6 +305,9 @@ void sync_deinit(struct bladerf_sync *sync)
 {
     if (sync->initialized) {
         if ((sync->stream_config.layout & BLADERF_DIRECTION_MASK) == BLADERF_TX) {
+            /* Let the DSP pool submit any buffers it still holds */
+            sync_worker_dsp_drain(sync->worker);
+
             async_submit_stream_buffer(sync->worker->stream,
                                        BLADERF_STREAM_SHUTDOWN, 0, false);
         }
@@ -278,6 +325,8 @@ void sync_deinit(struct bladerf_sync *sync)
 
         sync->initialized = false;
     }
+
+    rx_history_deinit(&sync->history);
 }
 
 static int wait_for_buffer(struct buffer_mgmt *b,
@@ -340,8 +389,244 @@ static inline unsigned int timestamp_to_msg(struct bladerf_sync *s, uint64_t t)
     return (unsigned int) m;
 }
 
-int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
-            struct bladerf_metadata *user_meta, unsigned int timeout_ms)
+/* Copy n SC16 Q11 samples to interleaved sample position `off` within the
+ * caller's per-channel sample arrays */
+static void scatter_sc16(void *const *dest, unsigned int num_dest,
+                         unsigned int off, uint8_t const *src, unsigned int n)
+{
+    unsigned int i, ch;
+    size_t idx;
+
+    ch  = off % num_dest;
+    idx = off / num_dest;
+
+    for (i = 0; i < n; i++) {
+        memcpy((uint32_t *)dest[ch] + idx, src + i * sizeof(uint32_t),
+               sizeof(uint32_t));
+
+        if (++ch == num_dest) {
+            ch = 0;
+            idx++;
+        }
+    }
+}
+
+/* Inverse of scatter_sc16() */
+static void gather_sc16(void const *const *src, unsigned int num_src,
+                        unsigned int off, uint8_t *dest, unsigned int n)
+{
+    unsigned int i, ch;
+    size_t idx;
+
+    ch  = off % num_src;
+    idx = off / num_src;
+
+    for (i = 0; i < n; i++) {
+        memcpy(dest + i * sizeof(uint32_t), (uint32_t const *)src[ch] + idx,
+               sizeof(uint32_t));
+
+        if (++ch == num_src) {
+            ch = 0;
+            idx++;
+        }
+    }
+}
+
+/* Number of samples converted at a time when scattering/gathering samples in
+ * a packed wire format */
+#define SYNC_PACKING_CHUNK 256
+
+/* Locate the SC16 Q11 sample that the worker's DSP pool converts to or from
+ * position `p` within stream buffer `buf` */
+static uint8_t *dsp_sample(struct bladerf_sync *s, void *buf, uint8_t const *p)
+{
+    const struct sync_dsp_job *job = sync_worker_dsp_job(s->worker, buf);
+    size_t off = (size_t)(p - (uint8_t const *)buf);
+    size_t sample;
+
+    if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        const size_t msg = off / s->meta.msg_size;
+
+        off %= s->meta.msg_size;
+        assert(off >= METADATA_HEADER_SIZE);
+
+        sample = msg * s->meta.samples_per_msg +
+                 (off - METADATA_HEADER_SIZE) / s->stream_config.bytes_per_sample;
+    } else {
+        sample = off / s->stream_config.bytes_per_sample;
+    }
+
+    return job->samples + sc16q11_to_bytes(sample);
+}
+
+/* Copy n samples out of a stream buffer, to interleaved sample position `off`
+ * within the caller's sample array(s). With more than one array, the stream's
+ * interleaved samples are scattered across the per-channel arrays. Samples
+ * in a packed wire format are converted to SC16 Q11 along the way. */
+static void copy_to_user(struct bladerf_sync *s,
+                         void *const *dest, unsigned int num_dest,
+                         unsigned int off, uint8_t const *src, unsigned int n)
+{
+    bladerf_wire_format wire_format = s->stream_config.wire_format;
+    uint32_t tmp[SYNC_PACKING_CHUNK];
+
+    /* The DSP pool has already unpacked the buffer being consumed */
+    if (s->worker->dsp != NULL) {
+        src = dsp_sample(s, s->buf_mgmt.buffers[s->buf_mgmt.cons_i], src);
+        wire_format = BLADERF_WIRE_FORMAT_SC16;
+    }
+
+    if (num_dest == 1) {
+        packing_unpack(wire_format, src,
+                       (int16_t *)((uint8_t *)dest[0] + sc16q11_to_bytes(off)),
+                       n);
+    } else if (wire_format == BLADERF_WIRE_FORMAT_SC16) {
+        scatter_sc16(dest, num_dest, off, src, n);
+    } else {
+        while (n > 0) {
+            unsigned int count = uint_min(n, SYNC_PACKING_CHUNK);
+
+            packing_unpack(wire_format, src, (int16_t *)tmp, count);
+            scatter_sc16(dest, num_dest, off, (uint8_t *)tmp, count);
+
+            src += samples2bytes(s, count);
+            off += count;
+            n   -= count;
+        }
+    }
+}
+
+/* Inverse of copy_to_user(): gather n samples from the caller's sample
+ * array(s), starting at interleaved sample position `off`, into a stream
+ * buffer. */
+static void copy_from_user(struct bladerf_sync *s,
+                           void const *const *src, unsigned int num_src,
+                           unsigned int off, uint8_t *dest, unsigned int n)
+{
+    bladerf_wire_format wire_format = s->stream_config.wire_format;
+    uint32_t tmp[SYNC_PACKING_CHUNK];
+
+    /* The DSP pool packs the buffer being produced once it's full */
+    if (s->worker->dsp != NULL) {
+        dest = dsp_sample(s, s->buf_mgmt.buffers[s->buf_mgmt.prod_i], dest);
+        wire_format = BLADERF_WIRE_FORMAT_SC16;
+    }
+
+    if (num_src == 1) {
+        packing_pack(wire_format,
+                     (int16_t const *)((uint8_t const *)src[0] +
+                                       sc16q11_to_bytes(off)),
+                     dest, n);
+    } else if (wire_format == BLADERF_WIRE_FORMAT_SC16) {
+        gather_sc16(src, num_src, off, dest, n);
+    } else {
+        while (n > 0) {
+            unsigned int count = uint_min(n, SYNC_PACKING_CHUNK);
+
+            gather_sc16(src, num_src, off, (uint8_t *)tmp, count);
+            packing_pack(wire_format, (int16_t *)tmp, dest, count);
+
+            dest += samples2bytes(s, count);
+            off  += count;
+            n    -= count;
+        }
+    }
+}
+
+/* Zero n samples at position `dest` within the stream buffer being
+ * produced */
+static void zero_samples(struct bladerf_sync *s, uint8_t *dest, unsigned int n)
+{
+    if (s->worker->dsp != NULL) {
+        dest = dsp_sample(s, s->buf_mgmt.buffers[s->buf_mgmt.prod_i], dest);
+        memset(dest, 0, sc16q11_to_bytes(n));
+    } else {
+        memset(dest, 0, samples2bytes(s, n));
+    }
+}
+
+/* Record every message in an RX buffer in the history, converting samples in a
+ * packed wire format to SC16 Q11 along the way */
+static void record_history(struct bladerf_sync *s, uint8_t *buf)
+{
+    bladerf_wire_format wire_format = s->stream_config.wire_format;
+    uint32_t tmp[SYNC_PACKING_CHUNK];
+    unsigned int i;
+
+    /* The DSP pool has already unpacked the buffer */
+    if (s->worker->dsp != NULL) {
+        wire_format = BLADERF_WIRE_FORMAT_SC16;
+    }
+
+    for (i = 0; i < s->meta.msg_per_buf; i++) {
+        uint8_t const *msg = buf + s->meta.msg_size * i;
+        uint8_t const *src = msg + METADATA_HEADER_SIZE;
+        uint64_t timestamp = metadata_get_timestamp(msg);
+        unsigned int n     = s->meta.samples_per_msg;
+
+        if (s->worker->dsp != NULL) {
+            src = dsp_sample(s, buf, src);
+        }
+
+        if (wire_format == BLADERF_WIRE_FORMAT_SC16) {
+            rx_history_record(&s->history, timestamp, src, n);
+            continue;
+        }
+
+        while (n > 0) {
+            unsigned int count = uint_min(n, SYNC_PACKING_CHUNK);
+
+            packing_unpack(wire_format, src, (int16_t *)tmp, count);
+            rx_history_record(&s->history, timestamp, tmp, count);
+
+            src       += samples2bytes(s, count);
+            timestamp += count;
+            n         -= count;
+        }
+    }
+}
+
+/* Validates the per-channel arrays passed to sync_rxv()/sync_txv(), and
+ * computes the corresponding total number of interleaved samples */
+static int check_vectored_args(struct bladerf_sync *s,
+                               void const *const *samples,
+                               unsigned int num_samples,
+                               unsigned int *total)
+{
+    unsigned int i, n;
+
+    if (s == NULL || samples == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (!s->initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    n = num_channels(s);
+
+    for (i = 0; i < n; i++) {
+        if (samples[i] == NULL) {
+            log_debug("NULL sample array for channel %u\n", i);
+            return BLADERF_ERR_INVAL;
+        }
+    }
+
+    if (num_samples > UINT_MAX / n) {
+        log_debug("Sample count %u is too large for %u channels\n",
+                  num_samples, n);
+        return BLADERF_ERR_INVAL;
+    }
+
+    *total = num_samples * n;
+    return 0;
+}
+
+static int rx_samples(struct bladerf_sync *s,
+                      void *const *samples,
+                      unsigned int num_dest,
+                      unsigned int num_samples,
+                      struct bladerf_metadata *user_meta,
+                      unsigned int timeout_ms)
 {
     struct buffer_mgmt *b;
 
@@ -349,19 +634,12 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
     bool exit_early = false;
     bool copied_data = false;
     unsigned int samples_returned = 0;
-    uint8_t *samples_dest = (uint8_t*)samples;
     uint8_t *buf_src = NULL;
+    uint8_t *history_buf = NULL;
     unsigned int samples_to_copy = 0;
     unsigned int samples_per_buffer = 0;
     uint64_t target_timestamp = UINT64_MAX;
 
-    if (s == NULL || samples == NULL) {
-        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
-        return BLADERF_ERR_INVAL;
-    } else if (!s->initialized) {
-        return BLADERF_ERR_INVAL;
-    }
-
     MUTEX_LOCK(&s->lock);
 
     if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
@@ -469,6 +747,15 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
 
             case SYNC_STATE_BUFFER_READY:
                 MUTEX_LOCK(&b->lock);
+
+                /* Overrun recovery may have reclaimed this buffer since we
+                 * found it full. If so, go back to waiting on the next one. */
+                if (b->status[b->cons_i] != SYNC_BUFFER_FULL) {
+                    s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+                    MUTEX_UNLOCK(&b->lock);
+                    break;
+                }
+
                 b->status[b->cons_i] = SYNC_BUFFER_PARTIAL;
                 b->partial_off = 0;
 
@@ -481,6 +768,10 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
                         s->state = SYNC_STATE_USING_BUFFER_META;
                         s->meta.curr_msg_off = 0;
                         s->meta.msg_num = 0;
+
+                        if (s->history.samples != NULL) {
+                            history_buf = (uint8_t*)b->buffers[b->cons_i];
+                        }
                         break;
 
                     default:
@@ -489,6 +780,14 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
                 }
 
                 MUTEX_UNLOCK(&b->lock);
+
+                /* Record the whole buffer before any of it can be skipped
+                 * over. It's ours while marked partial, so the worker's lock
+                 * needn't be held while copying. */
+                if (history_buf != NULL) {
+                    record_history(s, history_buf);
+                    history_buf = NULL;
+                }
                 break;
 
             case SYNC_STATE_USING_BUFFER: /* SC16Q11 buffers w/o metadata */
@@ -499,9 +798,9 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
                 samples_to_copy = uint_min(num_samples - samples_returned,
                                            samples_per_buffer - b->partial_off);
 
-                memcpy(samples_dest + samples2bytes(s, samples_returned),
-                       buf_src + samples2bytes(s, b->partial_off),
-                       samples2bytes(s, samples_to_copy));
+                copy_to_user(s, samples, num_dest, samples_returned,
+                             buf_src + samples2bytes(s, b->partial_off),
+                             samples_to_copy);
 
                 b->partial_off += samples_to_copy;
                 samples_returned += samples_to_copy;
@@ -597,11 +896,12 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
                                 uint_min(num_samples - samples_returned,
                                          left_in_msg(s));
 
-                            memcpy(samples_dest + samples2bytes(s, samples_returned),
-                                   s->meta.curr_msg +
-                                        METADATA_HEADER_SIZE +
-                                        samples2bytes(s, s->meta.curr_msg_off),
-                                   samples2bytes(s, samples_to_copy));
+                            copy_to_user(s, samples, num_dest,
+                                         samples_returned,
+                                         s->meta.curr_msg +
+                                            METADATA_HEADER_SIZE +
+                                            samples2bytes(s, s->meta.curr_msg_off),
+                                         samples_to_copy);
 
                             samples_returned += samples_to_copy;
                             s->meta.curr_msg_off += samples_to_copy;
@@ -693,7 +993,9 @@ int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
     }
 
     if (user_meta) {
-        user_meta->actual_count = samples_returned;
+        /* Report the count in the caller's terms: per-channel samples when
+         * per-channel arrays were provided */
+        user_meta->actual_count = samples_returned / num_dest;
     }
 
 out:
@@ -702,13 +1004,124 @@ out:
     return status;
 }
 
+int sync_rx(struct bladerf_sync *s, void *samples, unsigned num_samples,
+            struct bladerf_metadata *user_meta, unsigned int timeout_ms)
+{
+    if (s == NULL || samples == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (!s->initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return rx_samples(s, &samples, 1, num_samples, user_meta, timeout_ms);
+}
+
+int sync_rx_at(struct bladerf_sync *s, void *samples, unsigned int num_samples,
+               uint64_t timestamp, struct bladerf_metadata *user_meta,
+               unsigned int timeout_ms)
+{
+    struct bladerf_metadata pull;
+    uint32_t scratch;
+    void *dest = &scratch;
+    bool pulled_past = false;
+    bool done = false;
+    bool gap = false;
+    int status = 0;
+
+    if (s == NULL || samples == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (!s->initialized ||
+               s->stream_config.format != BLADERF_FORMAT_SC16_Q11_META) {
+        return BLADERF_ERR_INVAL;
+    } else if (num_samples == 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    while (!done && status == 0) {
+        MUTEX_LOCK(&s->lock);
+
+        if (s->history.samples == NULL) {
+            log_debug("%s: RX history is not enabled\n", __FUNCTION__);
+            status = BLADERF_ERR_INVAL;
+        } else if (num_samples >
+                   (uint64_t)s->history_len * num_channels(s)) {
+            log_debug("%s: %u samples exceeds the RX history length\n",
+                      __FUNCTION__, num_samples);
+            status = BLADERF_ERR_INVAL;
+        } else if (!rx_history_empty(&s->history) &&
+                   timestamp + num_samples <= rx_history_end(&s->history)) {
+            status = rx_history_read(&s->history, timestamp, samples,
+                                     num_samples, &gap);
+            done   = true;
+        } else if (pulled_past) {
+            /* The stream is past the interval, but it wasn't recorded */
+            status = BLADERF_ERR_TIME_PAST;
+        }
+
+        MUTEX_UNLOCK(&s->lock);
+
+        if (done || status != 0) {
+            break;
+        }
+
+        /* Read forward to the last sample of the interval. Every buffer
+         * walked along the way is recorded in the history. */
+        memset(&pull, 0, sizeof(pull));
+        pull.timestamp = timestamp + num_samples - 1;
+
+        status = rx_samples(s, &dest, 1, 1, &pull, timeout_ms);
+
+        /* The last sample may have fallen within an overrun, in which case
+         * the stream is now beyond it. Either way, the history covers it. */
+        if (status == BLADERF_ERR_TIME_PAST) {
+            pulled_past = true;
+            status      = 0;
+        }
+    }
+
+    if (user_meta != NULL) {
+        user_meta->timestamp    = timestamp;
+        user_meta->status       = gap ? BLADERF_META_STATUS_OVERRUN : 0;
+        user_meta->actual_count = (status == 0) ? num_samples : 0;
+    }
+
+    return status;
+}
+
+int sync_rxv(struct bladerf_sync *s, void *const *samples,
+             unsigned int num_samples, struct bladerf_metadata *user_meta,
+             unsigned int timeout_ms)
+{
+    unsigned int total;
+    int status;
+
+    status = check_vectored_args(s, (void const *const *)samples, num_samples,
+                                 &total);
+    if (status != 0) {
+        return status;
+    }
+
+    return rx_samples(s, samples, num_channels(s), total, user_meta,
+                      timeout_ms);
+}
+
 /* Assumes buffer lock is held */
 static int advance_tx_buffer(struct bladerf_sync *s, struct buffer_mgmt *b)
 {
     int status = 0;
     const unsigned int idx = b->prod_i;
 
-    if (b->submitter == SYNC_TX_SUBMITTER_FN) {
+    if (s->worker->dsp != NULL) {
+        /* The worker's DSP pool packs the buffer and then submits it, in
+         * order. Report any earlier failure to submit. */
+        b->status[idx] = SYNC_BUFFER_PROCESSING;
+        sync_worker_dsp_submit(s, b->buffers[idx]);
+
+        status = s->worker->dsp_status;
+        s->worker->dsp_status = 0;
+    } else if (b->submitter == SYNC_TX_SUBMITTER_FN) {
         /* Mark buffer in flight because we're going to send it out.
          * This ensures that if the callback fires before this function
          * completes, its state will be correct. */
@@ -858,11 +1271,12 @@ static inline int handle_tx_parameters(struct bladerf_metadata *user_meta,
     return 0;
 }
 
-int sync_tx(struct bladerf_sync *s,
-            void const *samples,
-            unsigned int num_samples,
-            struct bladerf_metadata *user_meta,
-            unsigned int timeout_ms)
+static int tx_samples(struct bladerf_sync *s,
+                      void const *const *samples,
+                      unsigned int num_src,
+                      unsigned int num_samples,
+                      struct bladerf_metadata *user_meta,
+                      unsigned int timeout_ms)
 {
     struct buffer_mgmt *b = NULL;
 
@@ -870,7 +1284,6 @@ int sync_tx(struct bladerf_sync *s,
     unsigned int samples_written    = 0;
     unsigned int samples_to_copy    = 0;
     unsigned int samples_per_buffer = 0;
-    uint8_t const *samples_src      = (uint8_t const *)samples;
     uint8_t *buf_dest               = NULL;
     struct tx_options op            = {
         FIELD_INIT(.flush, false), FIELD_INIT(.zero_pad, false),
@@ -878,10 +1291,6 @@ int sync_tx(struct bladerf_sync *s,
 
     log_verbose("%s: called for %u samples.\n", __FUNCTION__, num_samples);
 
-    if (s == NULL || samples == NULL || !s->initialized) {
-        return BLADERF_ERR_INVAL;
-    }
-
     MUTEX_LOCK(&s->lock);
 
     status = handle_tx_parameters(user_meta, s, &op);
@@ -981,9 +1390,9 @@ int sync_tx(struct bladerf_sync *s,
                 samples_to_copy = uint_min(num_samples - samples_written,
                                            samples_per_buffer - b->partial_off);
 
-                memcpy(buf_dest + samples2bytes(s, b->partial_off),
-                       samples_src + samples2bytes(s, samples_written),
-                       samples2bytes(s, samples_to_copy));
+                copy_from_user(s, samples, num_src, samples_written,
+                               buf_dest + samples2bytes(s, b->partial_off),
+                               samples_to_copy);
 
                 b->partial_off += samples_to_copy;
                 samples_written += samples_to_copy;
@@ -1058,9 +1467,11 @@ int sync_tx(struct bladerf_sync *s,
                                             __FUNCTION__, (uint64_t)to_zero);
                             }
 
-                            memset(s->meta.curr_msg + METADATA_HEADER_SIZE +
-                                       samples2bytes(s, s->meta.curr_msg_off),
-                                   0, samples2bytes(s, to_zero));
+                            zero_samples(s,
+                                         s->meta.curr_msg +
+                                             METADATA_HEADER_SIZE +
+                                             samples2bytes(s, s->meta.curr_msg_off),
+                                         (unsigned int)to_zero);
 
                             s->meta.curr_msg_off += to_zero;
 
@@ -1097,11 +1508,12 @@ int sync_tx(struct bladerf_sync *s,
                         if (samples_to_copy != 0) {
                             /* We have user data to copy into the current
                              * message within the buffer */
-                            memcpy(s->meta.curr_msg + METADATA_HEADER_SIZE +
-                                       samples2bytes(s, s->meta.curr_msg_off),
-                                   samples_src +
-                                       samples2bytes(s, samples_written),
-                                   samples2bytes(s, samples_to_copy));
+                            copy_from_user(s, samples, num_src,
+                                           samples_written,
+                                           s->meta.curr_msg +
+                                               METADATA_HEADER_SIZE +
+                                               samples2bytes(s, s->meta.curr_msg_off),
+                                           samples_to_copy);
 
                             s->meta.curr_msg_off += samples_to_copy;
                             s->meta.curr_timestamp += samples_to_copy;
@@ -1127,8 +1539,7 @@ int sync_tx(struct bladerf_sync *s,
                              * all requested data to the buffer */
                             assert(num_samples == samples_written);
 
-                            memset(s->meta.curr_msg + off, 0,
-                                   samples2bytes(s, to_zero));
+                            zero_samples(s, s->meta.curr_msg + off, to_zero);
 
                             log_verbose(
                                 "%s: Flushed %u samples @ %u (0x%08x)\n",
@@ -1188,6 +1599,110 @@ out:
     return status;
 }
 
+int sync_tx(struct bladerf_sync *s,
+            void const *samples,
+            unsigned int num_samples,
+            struct bladerf_metadata *user_meta,
+            unsigned int timeout_ms)
+{
+    if (s == NULL || samples == NULL || !s->initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    return tx_samples(s, &samples, 1, num_samples, user_meta, timeout_ms);
+}
+
+int sync_txv(struct bladerf_sync *s,
+             void const *const *samples,
+             unsigned int num_samples,
+             struct bladerf_metadata *user_meta,
+             unsigned int timeout_ms)
+{
+    unsigned int total;
+    int status;
+
+    status = check_vectored_args(s, samples, num_samples, &total);
+    if (status != 0) {
+        return status;
+    }
+
+    return tx_samples(s, samples, num_channels(s), total, user_meta,
+                      timeout_ms);
+}
+
+int sync_set_rx_history(struct bladerf_sync *s, unsigned int length)
+{
+    int status = 0;
+
+    if (!s->initialized) {
+        s->history_len = length;
+        return 0;
+    }
+
+    MUTEX_LOCK(&s->lock);
+
+    s->history_len = length;
+    rx_history_deinit(&s->history);
+
+    if (length > 0 &&
+        s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        status = rx_history_init(&s->history, history_capacity(s));
+    }
+
+    MUTEX_UNLOCK(&s->lock);
+
+    return status;
+}
+
+int sync_set_rx_overrun_recovery(struct bladerf_sync *s,
+                                 bladerf_rx_overrun_recovery mode)
+{
+    switch (mode) {
+        case BLADERF_RX_OVERRUN_RESUBMIT:
+        case BLADERF_RX_OVERRUN_DROP_OLDEST:
+            break;
+
+        default:
+            log_debug("Invalid overrun recovery mode: %d\n", mode);
+            return BLADERF_ERR_INVAL;
+    }
+
+    if (s->initialized) {
+        MUTEX_LOCK(&s->buf_mgmt.lock);
+        s->buf_mgmt.overrun_recovery = mode;
+        MUTEX_UNLOCK(&s->buf_mgmt.lock);
+    } else {
+        s->buf_mgmt.overrun_recovery = mode;
+    }
+
+    return 0;
+}
+
+int sync_get_rx_overrun(struct bladerf_sync *s, struct bladerf_rx_overrun *info)
+{
+    if (s == NULL || info == NULL || !s->initialized) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    MUTEX_LOCK(&s->buf_mgmt.lock);
+    *info = s->buf_mgmt.overrun;
+    memset(&s->buf_mgmt.overrun, 0, sizeof(s->buf_mgmt.overrun));
+    MUTEX_UNLOCK(&s->buf_mgmt.lock);
+
+    return 0;
+}
+
+int sync_set_dsp_threads(struct bladerf_sync *s, unsigned int num_threads)
+{
+    if (num_threads > DSP_POOL_MAX_THREADS) {
+        log_debug("Invalid number of DSP threads: %u\n", num_threads);
+        return BLADERF_ERR_INVAL;
+    }
+
+    s->dsp_threads = num_threads;
+    return 0;
+}
+
 unsigned int sync_buf2idx(struct buffer_mgmt *b, void *addr)
 {
     unsigned int i;
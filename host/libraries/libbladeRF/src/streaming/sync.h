@@ -29,6 +29,8 @@
 
 #include "thread.h"
 
+#include "rx_history.h"
+
 /* These parameters are only written during sync_init */
 struct stream_config {
     bladerf_format format;
@@ -38,6 +40,11 @@ struct stream_config {
     unsigned int num_xfers;
     unsigned int timeout_ms;
 
+    /* Representation of samples in the stream buffers. Samples are converted
+     * to/from SC16 Q11 as they are copied to/from the caller. */
+    bladerf_wire_format wire_format;
+
+    /* Size of a sample within a stream buffer */
     size_t bytes_per_sample;
 };
 
@@ -46,6 +53,7 @@ typedef enum {
     SYNC_BUFFER_PARTIAL,   /**< sync_rx/tx is currently emptying/filling */
     SYNC_BUFFER_FULL,      /**< Buffer is full of data */
     SYNC_BUFFER_IN_FLIGHT, /**< Currently being transferred */
+    SYNC_BUFFER_PROCESSING, /**< Being converted by the worker's DSP pool */
 } sync_buffer_status;
 
 typedef enum {
@@ -81,6 +89,17 @@ struct buffer_mgmt {
      * resubmission */
     unsigned int resubmit_count;
 
+    /* Applicable to RX only. Policy used by the worker callback when it
+     * finds no empty buffer to submit, and the gap(s) recorded by overruns
+     * that have not yet been retrieved via sync_get_rx_overrun() */
+    bladerf_rx_overrun_recovery overrun_recovery;
+    struct bladerf_rx_overrun overrun;
+    uint64_t overrun_end; /**< Position following the last dropped sample */
+
+    /* Applicable to RX only. Number of transfers completed since the stream
+     * was started. Used to locate dropped buffers in non-metadata streams. */
+    uint64_t num_completed;
+
     /* Applicable to TX only. Denotes which context is responsible for
      * submitting full buffers to the underlying async system */
     sync_tx_submitter submitter;
@@ -142,6 +161,16 @@ struct bladerf_sync {
     struct stream_config stream_config;
     struct sync_worker *worker;
     struct sync_meta meta;
+
+    /* Applicable to RX with metadata only. Samples recently received, for
+     * sync_rx_at(). `history_len` is the per-channel length requested via
+     * sync_set_rx_history(), and persists across sync_init() calls. */
+    unsigned int history_len;
+    struct rx_history history;
+
+    /* Number of DSP pool threads requested via sync_set_dsp_threads().
+     * Persists across sync_init() calls. */
+    unsigned int dsp_threads;
 };
 
 /**
@@ -183,6 +212,116 @@ int sync_tx(struct bladerf_sync *sync,
             struct bladerf_metadata *metadata,
             unsigned int timeout_ms);
 
+/**
+ * Vectored variant of sync_rx(), which deinterleaves samples directly into one
+ * array per channel of the stream's layout
+ *
+ * @param[inout]    sync        RX sync handle
+ * @param[out]      samples     Array of per-channel sample arrays
+ * @param[in]       num_samples Number of samples per channel
+ * @param[inout]    metadata    Metadata. `actual_count` is reported per
+ *                              channel.
+ * @param[in]       timeout_ms  Timeout, in milliseconds
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_rxv(struct bladerf_sync *sync,
+             void *const *samples,
+             unsigned int num_samples,
+             struct bladerf_metadata *metadata,
+             unsigned int timeout_ms);
+
+/**
+ * Vectored variant of sync_tx(), which interleaves samples directly from one
+ * array per channel of the stream's layout
+ *
+ * @param[inout]    sync        TX sync handle
+ * @param[in]       samples     Array of per-channel sample arrays
+ * @param[in]       num_samples Number of samples per channel
+ * @param[in]       metadata    Metadata
+ * @param[in]       timeout_ms  Timeout, in milliseconds
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_txv(struct bladerf_sync *sync,
+             void const *const *samples,
+             unsigned int num_samples,
+             struct bladerf_metadata *metadata,
+             unsigned int timeout_ms);
+
+/**
+ * Read an interval of samples by timestamp, from the RX history when it has
+ * already been received, or else by reading forward through the stream.
+ *
+ * @param[inout]    sync        RX sync handle, configured for
+ *                              BLADERF_FORMAT_SC16_Q11_META
+ * @param[out]      samples     Sample buffer
+ * @param[in]       num_samples Number of samples to read
+ * @param[in]       timestamp   Timestamp of the first sample to read
+ * @param[out]      metadata    Optional. Reports gaps within the interval.
+ * @param[in]       timeout_ms  Timeout, in milliseconds
+ *
+ * @return 0 or BLADERF_ERR_* value on failure. BLADERF_ERR_TIME_PAST is
+ *         returned if the interval is older than the history.
+ */
+int sync_rx_at(struct bladerf_sync *sync,
+               void *samples,
+               unsigned int num_samples,
+               uint64_t timestamp,
+               struct bladerf_metadata *metadata,
+               unsigned int timeout_ms);
+
+/**
+ * Select the length of the RX history used by sync_rx_at()
+ *
+ * @param[inout]    sync    RX sync handle. Need not be initialized; the
+ *                          selection persists across sync_init() calls.
+ * @param[in]       length  Number of samples, per channel, to retain.
+ *                          0 disables the history.
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_set_rx_history(struct bladerf_sync *sync, unsigned int length);
+
+/**
+ * Select how the RX worker recovers from a software overrun
+ *
+ * @param[inout]    sync    RX sync handle. Need not be initialized; the
+ *                          selection persists across sync_init() calls.
+ * @param[in]       mode    Recovery policy
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_set_rx_overrun_recovery(struct bladerf_sync *sync,
+                                 bladerf_rx_overrun_recovery mode);
+
+/**
+ * Retrieve and clear the gap recorded by RX overruns
+ *
+ * @param[inout]    sync    Initialized RX sync handle
+ * @param[out]      info    Recorded gap. `info->count` is 0 if no samples
+ *                          have been dropped since the last call.
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_get_rx_overrun(struct bladerf_sync *sync,
+                        struct bladerf_rx_overrun *info);
+
+/**
+ * Select the number of threads the worker uses to convert whole buffers
+ * between SC16 Q11 and a packed wire format, in parallel
+ *
+ * @param[inout]    sync        Sync handle. Need not be initialized; the
+ *                              selection takes effect at the next sync_init()
+ *                              call.
+ * @param[in]       num_threads Number of threads. 0 performs conversions on
+ *                              the API caller's thread, as samples are
+ *                              copied.
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_set_dsp_threads(struct bladerf_sync *sync, unsigned int num_threads);
+
 unsigned int sync_buf2idx(struct buffer_mgmt *b, void *addr);
 
 void *sync_idx2buf(struct buffer_mgmt *b, unsigned int idx);
@@ -17,6 +17,7 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -35,6 +36,7 @@
 #include "async.h"
 #include "sync.h"
 #include "sync_worker.h"
+#include "metadata.h"
 
 #include "board/board.h"
 #include "backend/usb/usb.h"
@@ -43,6 +45,320 @@
 
 void *sync_worker_task(void *arg);
 
+/* Convert a buffer between its wire format and SC16 Q11. Runs on any DSP
+ * pool thread. The buffer belongs to the pool while it's marked
+ * SYNC_BUFFER_PROCESSING, so no lock is needed. */
+static void dsp_work(void *arg, void *job_ptr)
+{
+    struct bladerf_sync *s   = (struct bladerf_sync *)arg;
+    struct sync_dsp_job *job = (struct sync_dsp_job *)job_ptr;
+
+    const bladerf_wire_format fmt = s->stream_config.wire_format;
+    const bool rx =
+        (s->stream_config.layout & BLADERF_DIRECTION_MASK) == BLADERF_RX;
+
+    unsigned int i, num_msg, samples_per_msg;
+    size_t msg_size, header_size;
+
+    if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        num_msg         = s->meta.msg_per_buf;
+        samples_per_msg = s->meta.samples_per_msg;
+        msg_size        = s->meta.msg_size;
+        header_size     = METADATA_HEADER_SIZE;
+    } else {
+        num_msg         = 1;
+        samples_per_msg = s->stream_config.samples_per_buffer;
+        msg_size        = 0;
+        header_size     = 0;
+    }
+
+    for (i = 0; i < num_msg; i++) {
+        uint8_t *wire = (uint8_t *)job->buf + msg_size * i + header_size;
+        int16_t *sc16 = (int16_t *)(job->samples +
+                                    sc16q11_to_bytes(samples_per_msg * i));
+
+        if (rx) {
+            packing_unpack(fmt, wire, sc16, samples_per_msg);
+        } else {
+            packing_pack(fmt, sc16, wire, samples_per_msg);
+        }
+    }
+}
+
+/* The DSP pool reports buffers done in the order they were handed to it. An
+ * RX buffer is then ready for the consumer. */
+static void rx_dsp_done(struct bladerf_sync *s, struct sync_dsp_job *job)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+    unsigned int idx;
+
+    MUTEX_LOCK(&b->lock);
+
+    idx = sync_buf2idx(b, job->buf);
+    assert(b->status[idx] == SYNC_BUFFER_PROCESSING);
+
+    b->status[idx] = SYNC_BUFFER_FULL;
+    pthread_cond_signal(&b->buf_ready);
+
+    MUTEX_UNLOCK(&b->lock);
+}
+
+/* A TX buffer is submitted once packed, in the same manner sync_tx() would
+ * have submitted it. Being called in order keeps the submissions in order. */
+static void tx_dsp_done(struct bladerf_sync *s, struct sync_dsp_job *job)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+    unsigned int idx;
+    int status;
+
+    MUTEX_LOCK(&b->lock);
+
+    idx = sync_buf2idx(b, job->buf);
+    assert(b->status[idx] == SYNC_BUFFER_PROCESSING);
+
+    if (b->submitter == SYNC_TX_SUBMITTER_FN) {
+        b->status[idx] = SYNC_BUFFER_IN_FLIGHT;
+
+        MUTEX_UNLOCK(&b->lock);
+        status = async_submit_stream_buffer(s->worker->stream, job->buf,
+                                            s->stream_config.timeout_ms, true);
+        MUTEX_LOCK(&b->lock);
+
+        if (status == BLADERF_ERR_WOULD_BLOCK) {
+            log_verbose("%s: Deferring buf[%u] submission to worker "
+                        "callback.\n", __FUNCTION__, idx);
+
+            b->status[idx] = SYNC_BUFFER_FULL;
+            b->submitter   = SYNC_TX_SUBMITTER_CALLBACK;
+            b->cons_i      = idx;
+        } else if (status != 0) {
+            log_debug("%s: Failed to submit buf[%u]: %s\n", __FUNCTION__, idx,
+                      bladerf_strerror(status));
+
+            /* Discard the buffer, rather than leave sync_tx() waiting on it */
+            b->status[idx] = SYNC_BUFFER_EMPTY;
+            pthread_cond_signal(&b->buf_ready);
+
+            if (s->worker->dsp_status == 0) {
+                s->worker->dsp_status = status;
+            }
+        }
+    } else {
+        /* The worker callback will submit this buffer in turn */
+        b->status[idx] = SYNC_BUFFER_FULL;
+    }
+
+    MUTEX_UNLOCK(&b->lock);
+}
+
+static void dsp_done(void *arg, void *job)
+{
+    struct bladerf_sync *s = (struct bladerf_sync *)arg;
+
+    if ((s->stream_config.layout & BLADERF_DIRECTION_MASK) == BLADERF_RX) {
+        rx_dsp_done(s, (struct sync_dsp_job *)job);
+    } else {
+        tx_dsp_done(s, (struct sync_dsp_job *)job);
+    }
+}
+
+static int dsp_init(struct bladerf_sync *s)
+{
+    struct sync_worker *w          = s->worker;
+    const unsigned int num_buffers = s->buf_mgmt.num_buffers;
+    const size_t buf_bytes =
+        sc16q11_to_bytes(s->stream_config.samples_per_buffer);
+    unsigned int i;
+
+    w->dsp_jobs    = (struct sync_dsp_job *)calloc(num_buffers,
+                                                   sizeof(w->dsp_jobs[0]));
+    w->dsp_samples = (uint8_t *)malloc(num_buffers * buf_bytes);
+
+    if (w->dsp_jobs == NULL || w->dsp_samples == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    for (i = 0; i < num_buffers; i++) {
+        w->dsp_jobs[i].buf     = s->buf_mgmt.buffers[i];
+        w->dsp_jobs[i].samples = w->dsp_samples + buf_bytes * i;
+    }
+
+    w->num_dsp_jobs = num_buffers;
+
+    /* Each buffer is handed to the pool at most once at a time, so the pool
+     * can never be full */
+    return dsp_pool_create(&w->dsp, s->dsp_threads, num_buffers, dsp_work,
+                           dsp_done, s);
+}
+
+static void dsp_deinit(struct sync_worker *w)
+{
+    dsp_pool_destroy(w->dsp);
+    free(w->dsp_jobs);
+    free(w->dsp_samples);
+
+    w->dsp          = NULL;
+    w->dsp_jobs     = NULL;
+    w->dsp_samples  = NULL;
+    w->num_dsp_jobs = 0;
+}
+
+struct sync_dsp_job *sync_worker_dsp_job(struct sync_worker *w,
+                                         const void *buf)
+{
+    unsigned int i;
+
+    /* Jobs never move, unlike the buffers within the ring */
+    for (i = 0; i < w->num_dsp_jobs; i++) {
+        if (w->dsp_jobs[i].buf == buf) {
+            return &w->dsp_jobs[i];
+        }
+    }
+
+    assert(!"Bug: DSP job not found.");
+    return &w->dsp_jobs[0];
+}
+
+void sync_worker_dsp_submit(struct bladerf_sync *s, void *buf)
+{
+    int status;
+
+    status = dsp_pool_submit(s->worker->dsp, sync_worker_dsp_job(s->worker, buf));
+    if (status != 0) {
+        assert(!"Bug: DSP pool full.");
+        log_critical("Bug: DSP pool full.\n");
+    }
+}
+
+void sync_worker_dsp_drain(struct sync_worker *w)
+{
+    if (w->dsp != NULL) {
+        dsp_pool_drain(w->dsp);
+    }
+}
+
+/* Make a received buffer available to the consumer, by way of the DSP pool
+ * if there is one.
+ *
+ * Assumes the buffer lock is held */
+static void complete_rx_buffer(struct bladerf_sync *s, unsigned int idx)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+
+    if (s->worker->dsp != NULL) {
+        b->status[idx] = SYNC_BUFFER_PROCESSING;
+        sync_worker_dsp_submit(s, b->buffers[idx]);
+    } else {
+        b->status[idx] = SYNC_BUFFER_FULL;
+        pthread_cond_signal(&b->buf_ready);
+    }
+}
+
+/* Number of buffers from index `from` up to index `to` in the ring */
+static inline unsigned int buf_distance(struct buffer_mgmt *b,
+                                        unsigned int from,
+                                        unsigned int to)
+{
+    return (to + b->num_buffers - from) % b->num_buffers;
+}
+
+/* Record the contents of buffer `idx` as dropped. `newest` is the index of the
+ * buffer whose transfer just completed.
+ *
+ * Assumes the buffer lock is held */
+static void record_rx_drop(struct bladerf_sync *s,
+                           unsigned int idx,
+                           unsigned int newest)
+{
+    struct buffer_mgmt *b        = &s->buf_mgmt;
+    struct bladerf_rx_overrun *o = &b->overrun;
+    uint64_t timestamp, length;
+
+    if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        timestamp = metadata_get_timestamp((uint8_t *)b->buffers[idx]);
+        length    = (uint64_t)s->meta.samples_per_msg * s->meta.msg_per_buf;
+    } else {
+        /* Only the oldest unread buffer is ever dropped, so the buffers from
+         * this one through the newest are contiguous in the stream */
+        length    = s->stream_config.samples_per_buffer;
+        timestamp = (b->num_completed - 1 - buf_distance(b, idx, newest)) *
+                    length;
+    }
+
+    if (o->count == 0) {
+        o->timestamp       = timestamp;
+        o->length          = 0;
+        o->discontinuities = 1;
+    } else if (timestamp != b->overrun_end) {
+        o->discontinuities++;
+    }
+
+    o->length += length;
+    o->count++;
+    b->overrun_end = timestamp + length;
+
+    log_debug("RX overrun: dropped %" PRIu64 " samples @ %" PRIu64 "\n",
+              length, timestamp);
+}
+
+/* Drop the oldest buffer that sync_rx() has not started reading and return it
+ * for resubmission. `newest` is the index of the buffer whose transfer just
+ * completed, and must already be marked full.
+ *
+ * Assumes the buffer lock is held */
+static void *drop_oldest_rx_buffer(struct bladerf_sync *s, unsigned int newest)
+{
+    struct buffer_mgmt *b   = &s->buf_mgmt;
+    const unsigned int head = b->prod_i;
+    unsigned int drop_i, tail, i;
+    void *drop_buf;
+
+    if (b->status[head] == SYNC_BUFFER_FULL && head == b->cons_i) {
+        /* The consumer hasn't touched the head of the queue. Hand it straight
+         * back to the USB layer and move the consumer on to the next one. */
+        record_rx_drop(s, head, newest);
+
+        b->status[head] = SYNC_BUFFER_IN_FLIGHT;
+        b->prod_i       = (head + 1) % b->num_buffers;
+        b->cons_i       = b->prod_i;
+
+        return b->buffers[head];
+    }
+
+    /* sync_rx() is partway through the head of the queue, so drop the buffer
+     * after it instead. Everything behind that buffer is shifted forward by
+     * one slot, and it is requeued at the tail, just ahead of the head.
+     *
+     * Buffer pointers move along with their state, keeping the ring in stream
+     * order with a single gap. In-flight buffers are located by address via
+     * sync_buf2idx() upon completion, so they're found in their new slots.
+     * The same goes for buffers with the DSP pool. */
+    drop_i = (head + 1) % b->num_buffers;
+
+    /* Buffers still with the DSP pool can't be reclaimed. In that case it's
+     * the pool that's behind, so drop what was just received instead. */
+    if (b->status[head] == SYNC_BUFFER_PROCESSING ||
+        b->status[drop_i] == SYNC_BUFFER_PROCESSING) {
+        drop_i = newest;
+    }
+
+    tail     = (head + b->num_buffers - 1) % b->num_buffers;
+    drop_buf = b->buffers[drop_i];
+
+    record_rx_drop(s, drop_i, newest);
+
+    for (i = drop_i; i != tail; i = (i + 1) % b->num_buffers) {
+        const unsigned int next = (i + 1) % b->num_buffers;
+        b->buffers[i] = b->buffers[next];
+        b->status[i]  = b->status[next];
+    }
+
+    b->buffers[tail] = drop_buf;
+    b->status[tail]  = SYNC_BUFFER_IN_FLIGHT;
+
+    return drop_buf;
+}
+
 static void *rx_callback(struct bladerf *dev,
                          struct bladerf_stream *stream,
                          struct bladerf_metadata *meta,
@@ -76,13 +392,13 @@ static void *rx_callback(struct bladerf *dev,
 
     /* Get the index of the buffer that was just filled */
     samples_idx = sync_buf2idx(b, samples);
+    b->num_completed++;
 
     if (b->resubmit_count == 0) {
         if (b->status[b->prod_i] == SYNC_BUFFER_EMPTY) {
 
             /* This buffer is now ready for the consumer */
-            b->status[samples_idx] = SYNC_BUFFER_FULL;
-            pthread_cond_signal(&b->buf_ready);
+            complete_rx_buffer(s, samples_idx);
 
             /* Update the state of the buffer being submitted next */
             next_idx = b->prod_i;
@@ -95,6 +411,18 @@ static void *rx_callback(struct bladerf *dev,
             log_verbose("%s worker: buf[%u] = full, buf[%u] = in_flight\n",
                         worker2str(s), samples_idx, next_idx);
 
+        } else if (b->overrun_recovery == BLADERF_RX_OVERRUN_DROP_OLDEST) {
+            /* Keep what we just received, at the expense of the oldest data
+             * the consumer hasn't gotten to yet */
+            b->status[samples_idx] = SYNC_BUFFER_FULL;
+            next_buf = drop_oldest_rx_buffer(s, samples_idx);
+
+            /* Unless it was discarded, the buffer may have been moved
+             * within the ring */
+            if (next_buf != samples) {
+                complete_rx_buffer(s, sync_buf2idx(b, samples));
+            }
+
         } else {
             /* TODO propagate back the RX Overrun to the sync_rx() caller */
             log_debug("RX overrun @ buffer %u\r\n", samples_idx);
@@ -224,6 +552,16 @@ int sync_worker_init(struct bladerf_sync *s)
         goto worker_init_out;
     }
 
+    if (s->dsp_threads > 0 &&
+        s->stream_config.wire_format != BLADERF_WIRE_FORMAT_SC16) {
+        status = dsp_init(s);
+        if (status != 0) {
+            log_debug("%s worker: Failed to init DSP pool: %s\n",
+                      worker2str(s), bladerf_strerror(status));
+            goto worker_init_out;
+        }
+    }
+
     MUTEX_INIT(&s->worker->state_lock);
     MUTEX_INIT(&s->worker->request_lock);
 
@@ -262,7 +600,8 @@ int sync_worker_init(struct bladerf_sync *s)
     }
 
 worker_init_out:
-    if (status != 0) {
+    if (status != 0 && s->worker != NULL) {
+        dsp_deinit(s->worker);
         free(s->worker);
         s->worker = NULL;
     }
@@ -300,6 +639,9 @@ void sync_worker_deinit(struct sync_worker *w,
     pthread_join(w->thread, NULL);
     log_verbose("%s: Worker joined.\n", __FUNCTION__);
 
+    /* Any buffers still with the DSP pool are finished off first */
+    dsp_deinit(w);
+
     async_deinit_stream(w->stream);
 
     free(w);
@@ -420,6 +762,13 @@ static sync_worker_state exec_idle_state(struct bladerf_sync *s)
 
     } else if (requests & SYNC_WORKER_START) {
         log_verbose("%s worker: Got request to start\n", worker2str(s));
+
+        /* RX buffers still being converted from the previous run must not
+         * become full after the buffer states are reset below */
+        if ((s->stream_config.layout & BLADERF_DIRECTION_MASK) == BLADERF_RX) {
+            sync_worker_dsp_drain(s->worker);
+        }
+
         MUTEX_LOCK(&s->buf_mgmt.lock);
 
         if ((s->stream_config.layout & BLADERF_DIRECTION_MASK) == BLADERF_TX) {
@@ -434,6 +783,7 @@ static sync_worker_state exec_idle_state(struct bladerf_sync *s)
             pthread_cond_signal(&s->buf_mgmt.buf_ready);
         } else {
             s->buf_mgmt.prod_i = s->stream_config.num_xfers;
+            s->buf_mgmt.num_completed = 0;
 
             for (i = 0; i < s->buf_mgmt.num_buffers; i++) {
                 if (i < s->stream_config.num_xfers) {
@@ -21,6 +21,7 @@
 
 #include "host_config.h"
 #include "sync.h"
+#include "dsp_pool.h"
 #include <libbladeRF.h>
 #include <pthread.h>
 
@@ -48,6 +49,13 @@ typedef enum {
     SYNC_WORKER_STATE_STOPPED
 } sync_worker_state;
 
+/* A stream buffer, and the SC16 Q11 samples it carries in a packed wire
+ * format. The DSP pool converts between the two. */
+struct sync_dsp_job {
+    void *buf;        /* Stream buffer, in the wire format */
+    uint8_t *samples; /* SC16 Q11 samples, excluding any metadata headers */
+};
+
 struct sync_worker {
     pthread_t thread;
 
@@ -68,6 +76,20 @@ struct sync_worker {
     unsigned int requests;
     pthread_cond_t requests_pending;
     MUTEX request_lock;
+
+    /* Applicable to packed wire formats, when DSP threads have been
+     * requested; NULL otherwise. RX buffers are unpacked between their
+     * transfer completing and being made available to sync_rx(). TX buffers
+     * are packed, and then submitted in order, after sync_tx() fills them. */
+    struct dsp_pool *dsp;
+    struct sync_dsp_job *dsp_jobs; /* One per stream buffer */
+    unsigned int num_dsp_jobs;
+    uint8_t *dsp_samples;          /* Backing store for dsp_jobs' samples */
+
+    /* TX only. First failure to submit a buffer converted by the DSP pool,
+     * to be reported by sync_tx(). Accessed while holding the
+     * sync->buf_mgmt.lock. */
+    int dsp_status;
 };
 
 /**
@@ -127,4 +149,37 @@ sync_worker_state sync_worker_get_state(struct sync_worker *w, int *err_code);
  */
 void sync_worker_submit_request(struct sync_worker *w, unsigned int request);
 
+/**
+ * Look up the DSP job for a stream buffer
+ *
+ * @pre The worker has a DSP pool
+ *
+ * @param       w           Worker
+ * @param[in]   buf         Stream buffer
+ *
+ * @return DSP job
+ */
+struct sync_dsp_job *sync_worker_dsp_job(struct sync_worker *w,
+                                         const void *buf);
+
+/**
+ * Hand a TX buffer to the DSP pool, to be packed and then submitted. The
+ * caller must have marked the buffer SYNC_BUFFER_PROCESSING.
+ *
+ * @pre The worker has a DSP pool, and the sync->buf_mgmt.lock is held
+ *
+ * @param       s           TX sync handle
+ * @param[in]   buf         Stream buffer, filled with SC16 Q11 samples via
+ *                          its DSP job
+ */
+void sync_worker_dsp_submit(struct bladerf_sync *s, void *buf);
+
+/**
+ * Wait for the DSP pool to finish with all buffers handed to it. This is a
+ * no-op if the worker has no DSP pool.
+ *
+ * @pre The sync->buf_mgmt.lock is not held
+ */
+void sync_worker_dsp_drain(struct sync_worker *w);
+
 #endif
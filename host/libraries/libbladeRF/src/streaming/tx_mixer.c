@@ -0,0 +1,611 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include <libbladeRF.h>
+
+#include "host_config.h"
+#include "log.h"
+#include "rel_assert.h"
+#include "thread.h"
+
+#include "helpers/timeout.h"
+#include "streaming/tx_mixer.h"
+
+#define DEFAULT_CHUNK_SIZE      4096
+#define DEFAULT_BURST_GAP       8192
+#define DEFAULT_LEAD_TIME_US    20000
+#define DEFAULT_MAX_PENDING     64
+#define DEFAULT_TIMEOUT_MS      1000
+
+/* Upper bound on how long the mixer thread sleeps before re-reading the
+ * device's timestamp */
+#define MAX_WAIT_MS             100
+
+#define SC16Q11_MAX     2047
+#define SC16Q11_MIN     (-2048)
+
+struct tx_burst {
+    struct tx_burst *next;
+    struct bladerf_tx_producer *producer;
+    bladerf_timestamp timestamp;
+    unsigned int num_samples;
+    bool started; /* Some of its samples have been committed */
+    int16_t samples[];
+};
+
+struct bladerf_tx_producer {
+    struct bladerf_tx_mixer *mixer;
+    struct bladerf_tx_producer *next;
+    unsigned int pending;
+    struct bladerf_tx_producer_stats stats;
+};
+
+struct bladerf_tx_mixer {
+    struct bladerf *dev;
+    struct bladerf_tx_mixer_config config;
+    bladerf_sample_rate sample_rate;
+    uint64_t lead_samples;
+
+    pthread_t thread;
+
+    /* Everything below is protected by `lock` */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool stop;
+
+    struct tx_burst *bursts; /* Queued bursts, sorted by timestamp */
+    struct bladerf_tx_producer *producers;
+
+    /* The timestamp following the last sample committed to the device. While
+     * idle, a new device burst may not start before `min_start`. */
+    bool in_burst;
+    bladerf_timestamp committed;
+    bladerf_timestamp min_start;
+
+    int32_t *acc;
+    int16_t *out;
+
+    struct bladerf_tx_mixer_stats stats;
+};
+
+/******************************************************************************/
+/* Burst bookkeeping. All of these must be called with the mixer lock held. */
+/******************************************************************************/
+
+static void burst_retire(struct tx_burst *b, bool late)
+{
+    struct bladerf_tx_producer *p = b->producer;
+
+    assert(p->pending > 0);
+    p->pending--;
+
+    if (late) {
+        log_debug("TX mixer: dropping late burst @ %" PRIu64 "\n",
+                  b->timestamp);
+        p->stats.bursts_late++;
+        p->stats.samples_late += b->num_samples;
+        p->stats.last_late_timestamp = b->timestamp;
+    } else {
+        p->stats.bursts_sent++;
+    }
+
+    free(b);
+}
+
+static void bursts_insert(struct bladerf_tx_mixer *m, struct tx_burst *b)
+{
+    struct tx_burst **pp = &m->bursts;
+
+    /* Bursts with equal timestamps are kept in submission order */
+    while (*pp != NULL && (*pp)->timestamp <= b->timestamp) {
+        pp = &(*pp)->next;
+    }
+
+    b->next = *pp;
+    *pp     = b;
+}
+
+/* Earliest timestamp at which a newly submitted burst can still be placed */
+static inline bladerf_timestamp earliest_start(struct bladerf_tx_mixer *m)
+{
+    return m->in_burst ? m->committed : m->min_start;
+}
+
+/******************************************************************************/
+/* Mixing */
+/******************************************************************************/
+
+static inline int16_t saturate(int32_t x, uint64_t *clipped)
+{
+    if (x > SC16Q11_MAX) {
+        *clipped = 1;
+        return SC16Q11_MAX;
+    } else if (x < SC16Q11_MIN) {
+        *clipped = 1;
+        return SC16Q11_MIN;
+    }
+
+    return (int16_t)x;
+}
+
+/* Mix the chunk starting at timestamp `t` into m->out, retiring the bursts
+ * that it completes, and fill in the metadata for transmitting it. If
+ * `end` is set, or nothing follows closely enough, the device burst is
+ * ended with this chunk.
+ *
+ * Returns the number of samples in the chunk. Called with the lock held. */
+static unsigned int mix_chunk(struct bladerf_tx_mixer *m,
+                              bladerf_timestamp t,
+                              bool end,
+                              struct bladerf_metadata *meta)
+{
+    const unsigned int chunk          = m->config.chunk_size;
+    const bladerf_timestamp chunk_end = t + chunk;
+    bladerf_timestamp content_end     = t;
+    struct tx_burst **pp              = &m->bursts;
+    struct tx_burst *b;
+    unsigned int len, i;
+
+    memset(m->acc, 0, 2 * chunk * sizeof(m->acc[0]));
+
+    while ((b = *pp) != NULL && b->timestamp < chunk_end) {
+        const bladerf_timestamp b_end = b->timestamp + b->num_samples;
+        bladerf_timestamp start, stop;
+        const int16_t *src;
+        int32_t *dst;
+        size_t n;
+
+        if (!b->started && b->timestamp < t) {
+            *pp = b->next;
+            burst_retire(b, true);
+            continue;
+        }
+
+        start = (b->timestamp > t) ? b->timestamp : t;
+        stop  = (b_end < chunk_end) ? b_end : chunk_end;
+
+        src = &b->samples[2 * (start - b->timestamp)];
+        dst = &m->acc[2 * (start - t)];
+        n   = 2 * (size_t)(stop - start);
+
+        for (i = 0; i < n; i++) {
+            dst[i] += src[i];
+        }
+
+        b->started = true;
+
+        if (stop > content_end) {
+            content_end = stop;
+        }
+
+        if (b_end <= chunk_end) {
+            *pp = b->next;
+            burst_retire(b, false);
+        } else {
+            pp = &b->next;
+        }
+    }
+
+    /* The list is sorted, so its head tells whether there is more to send
+     * before the gap becomes long enough to end the device burst */
+    if (!end && m->bursts != NULL &&
+        m->bursts->timestamp < content_end + m->config.burst_gap) {
+        len = chunk;
+    } else {
+        end = true;
+        len = (unsigned int)(content_end - t);
+
+        /* A zero sample carries the BURST_END flag when nothing is left */
+        if (len == 0) {
+            len = 1;
+        }
+    }
+
+    for (i = 0; i < len; i++) {
+        uint64_t clipped = 0;
+
+        m->out[2 * i]     = saturate(m->acc[2 * i], &clipped);
+        m->out[2 * i + 1] = saturate(m->acc[2 * i + 1], &clipped);
+        m->stats.samples_clipped += clipped;
+    }
+
+    memset(meta, 0, sizeof(*meta));
+
+    if (!m->in_burst) {
+        meta->flags     = BLADERF_META_FLAG_TX_BURST_START;
+        meta->timestamp = t;
+        m->in_burst     = true;
+        m->stats.device_bursts++;
+    }
+
+    m->committed = t + len;
+    m->stats.samples += len;
+
+    if (end) {
+        meta->flags |= BLADERF_META_FLAG_TX_BURST_END;
+        m->in_burst  = false;
+        m->min_start = m->committed + m->config.burst_gap;
+    }
+
+    return len;
+}
+
+/* Transmit a chunk, with the lock released for the duration */
+static int transmit(struct bladerf_tx_mixer *m,
+                    unsigned int len,
+                    struct bladerf_metadata *meta)
+{
+    int status;
+
+    MUTEX_UNLOCK(&m->lock);
+    status = bladerf_sync_tx(m->dev, m->out, len, meta, m->config.timeout_ms);
+    MUTEX_LOCK(&m->lock);
+
+    if (status != 0) {
+        log_error("TX mixer: bladerf_sync_tx failed: %s\n",
+                  bladerf_strerror(status));
+    }
+
+    return status;
+}
+
+static void *mixer_thread(void *arg)
+{
+    struct bladerf_tx_mixer *m = arg;
+    struct bladerf_metadata meta;
+    struct timespec timeout_abs;
+    bladerf_timestamp now, t;
+    unsigned int len;
+    int status = 0;
+
+    MUTEX_LOCK(&m->lock);
+
+    while (!m->stop) {
+        if (m->bursts == NULL && !m->in_burst) {
+            pthread_cond_wait(&m->cond, &m->lock);
+            continue;
+        }
+
+        MUTEX_UNLOCK(&m->lock);
+        status = bladerf_get_timestamp(m->dev, BLADERF_TX, &now);
+        MUTEX_LOCK(&m->lock);
+
+        if (status != 0) {
+            log_error("TX mixer: failed to read timestamp: %s\n",
+                      bladerf_strerror(status));
+            break;
+        } else if (m->stop) {
+            break;
+        }
+
+        if (m->in_burst) {
+            t = m->committed;
+        } else {
+            /* Starting a device burst requires enough time for its first
+             * samples to reach the device */
+            while (m->bursts != NULL &&
+                   (m->bursts->timestamp < now + m->lead_samples / 2 ||
+                    m->bursts->timestamp < m->min_start)) {
+                struct tx_burst *b = m->bursts;
+                m->bursts          = b->next;
+                burst_retire(b, true);
+            }
+
+            if (m->bursts == NULL) {
+                continue;
+            }
+
+            t = m->bursts->timestamp;
+        }
+
+        /* Hold off until the chunk is due, so that bursts submitted in the
+         * meantime can still be mixed into it */
+        if (t > now + m->lead_samples) {
+            uint64_t wait_ms = (t - now - m->lead_samples) * 1000 /
+                               m->sample_rate;
+
+            if (wait_ms > MAX_WAIT_MS) {
+                wait_ms = MAX_WAIT_MS;
+            } else if (wait_ms == 0) {
+                wait_ms = 1;
+            }
+
+            status = populate_abs_timeout(&timeout_abs, (unsigned int)wait_ms);
+            if (status != 0) {
+                break;
+            }
+
+            pthread_cond_timedwait(&m->cond, &m->lock, &timeout_abs);
+            continue;
+        }
+
+        len    = mix_chunk(m, t, false, &meta);
+        status = transmit(m, len, &meta);
+        if (status != 0) {
+            break;
+        }
+    }
+
+    /* Leave the device idle */
+    if (status == 0 && m->in_burst) {
+        len    = mix_chunk(m, m->committed, true, &meta);
+        status = transmit(m, len, &meta);
+    }
+
+    m->stats.status = status;
+
+    MUTEX_UNLOCK(&m->lock);
+
+    return NULL;
+}
+
+/******************************************************************************/
+/* Mixer */
+/******************************************************************************/
+
+int tx_mixer_create(struct bladerf *dev,
+                    struct bladerf_tx_mixer **mixer,
+                    const struct bladerf_tx_mixer_config *config)
+{
+    struct bladerf_tx_mixer *m;
+    int status;
+
+    m = calloc(1, sizeof(*m));
+    if (m == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    m->dev = dev;
+
+    if (config != NULL) {
+        m->config = *config;
+    } else {
+        m->config.channel = BLADERF_CHANNEL_TX(0);
+    }
+
+#define DEFAULT(_field, _value)      \
+    if (m->config._field == 0) {     \
+        m->config._field = (_value); \
+    }
+
+    DEFAULT(chunk_size, DEFAULT_CHUNK_SIZE);
+    DEFAULT(burst_gap, DEFAULT_BURST_GAP);
+    DEFAULT(lead_time_us, DEFAULT_LEAD_TIME_US);
+    DEFAULT(max_pending, DEFAULT_MAX_PENDING);
+    DEFAULT(timeout_ms, DEFAULT_TIMEOUT_MS);
+
+#undef DEFAULT
+
+    if (!BLADERF_CHANNEL_IS_TX(m->config.channel)) {
+        log_debug("%s: channel %d is not a TX channel\n", __FUNCTION__,
+                  m->config.channel);
+        status = BLADERF_ERR_INVAL;
+        goto error;
+    }
+
+    status = bladerf_get_sample_rate(dev, m->config.channel, &m->sample_rate);
+    if (status != 0) {
+        goto error;
+    } else if (m->sample_rate == 0) {
+        status = BLADERF_ERR_UNEXPECTED;
+        goto error;
+    }
+
+    m->lead_samples =
+        (uint64_t)m->config.lead_time_us * m->sample_rate / 1000000;
+
+    m->acc = malloc(2 * m->config.chunk_size * sizeof(m->acc[0]));
+    m->out = malloc(2 * m->config.chunk_size * sizeof(m->out[0]));
+    if (m->acc == NULL || m->out == NULL) {
+        status = BLADERF_ERR_MEM;
+        goto error;
+    }
+
+    MUTEX_INIT(&m->lock);
+    pthread_cond_init(&m->cond, NULL);
+
+    status = pthread_create(&m->thread, NULL, mixer_thread, m);
+    if (status != 0) {
+        log_debug("%s: pthread_create failed: %d\n", __FUNCTION__, status);
+        pthread_cond_destroy(&m->cond);
+        pthread_mutex_destroy(&m->lock);
+        status = BLADERF_ERR_UNEXPECTED;
+        goto error;
+    }
+
+    *mixer = m;
+    return 0;
+
+error:
+    free(m->acc);
+    free(m->out);
+    free(m);
+    return status;
+}
+
+void tx_mixer_destroy(struct bladerf_tx_mixer *m)
+{
+    struct tx_burst *b;
+    struct bladerf_tx_producer *p;
+
+    if (m == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(&m->lock);
+    m->stop = true;
+    pthread_cond_signal(&m->cond);
+    MUTEX_UNLOCK(&m->lock);
+
+    pthread_join(m->thread, NULL);
+
+    while ((b = m->bursts) != NULL) {
+        m->bursts = b->next;
+        free(b);
+    }
+
+    while ((p = m->producers) != NULL) {
+        m->producers = p->next;
+        free(p);
+    }
+
+    pthread_cond_destroy(&m->cond);
+    pthread_mutex_destroy(&m->lock);
+
+    free(m->acc);
+    free(m->out);
+    free(m);
+}
+
+int tx_mixer_get_stats(struct bladerf_tx_mixer *m,
+                       struct bladerf_tx_mixer_stats *stats)
+{
+    MUTEX_LOCK(&m->lock);
+    *stats = m->stats;
+    MUTEX_UNLOCK(&m->lock);
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Producers */
+/******************************************************************************/
+
+int tx_producer_add(struct bladerf_tx_mixer *m,
+                    struct bladerf_tx_producer **producer)
+{
+    struct bladerf_tx_producer *p;
+
+    p = calloc(1, sizeof(*p));
+    if (p == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    p->mixer = m;
+
+    MUTEX_LOCK(&m->lock);
+    p->next      = m->producers;
+    m->producers = p;
+    MUTEX_UNLOCK(&m->lock);
+
+    *producer = p;
+    return 0;
+}
+
+void tx_producer_remove(struct bladerf_tx_producer *p)
+{
+    struct bladerf_tx_mixer *m = p->mixer;
+    struct bladerf_tx_producer **pp;
+    struct tx_burst **bp, *b;
+
+    MUTEX_LOCK(&m->lock);
+
+    for (bp = &m->bursts; (b = *bp) != NULL;) {
+        if (b->producer == p) {
+            *bp = b->next;
+            free(b);
+        } else {
+            bp = &b->next;
+        }
+    }
+
+    for (pp = &m->producers; *pp != NULL; pp = &(*pp)->next) {
+        if (*pp == p) {
+            *pp = p->next;
+            break;
+        }
+    }
+
+    MUTEX_UNLOCK(&m->lock);
+
+    free(p);
+}
+
+int tx_producer_submit(struct bladerf_tx_producer *p,
+                       const int16_t *samples,
+                       unsigned int num_samples,
+                       bladerf_timestamp timestamp)
+{
+    struct bladerf_tx_mixer *m = p->mixer;
+    struct tx_burst *b;
+    int status = 0;
+
+    if (num_samples == 0) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    /* Copy the samples before taking the lock, to keep the mixer thread from
+     * waiting on it */
+    b = malloc(sizeof(*b) + 2 * (size_t)num_samples * sizeof(b->samples[0]));
+    if (b == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    b->producer    = p;
+    b->timestamp   = timestamp;
+    b->num_samples = num_samples;
+    b->started     = false;
+    memcpy(b->samples, samples, 2 * (size_t)num_samples * sizeof(samples[0]));
+
+    MUTEX_LOCK(&m->lock);
+
+    if (m->stats.status != 0) {
+        status = m->stats.status;
+    } else if (p->pending >= m->config.max_pending) {
+        status = BLADERF_ERR_QUEUE_FULL;
+    } else {
+        p->pending++;
+        p->stats.bursts_submitted++;
+
+        if (timestamp < earliest_start(m)) {
+            burst_retire(b, true);
+            status = BLADERF_ERR_TIME_PAST;
+        } else {
+            bursts_insert(m, b);
+            pthread_cond_signal(&m->cond);
+        }
+
+        b = NULL;
+    }
+
+    MUTEX_UNLOCK(&m->lock);
+
+    free(b);
+    return status;
+}
+
+int tx_producer_get_stats(struct bladerf_tx_producer *p,
+                          struct bladerf_tx_producer_stats *stats)
+{
+    struct bladerf_tx_mixer *m = p->mixer;
+
+    MUTEX_LOCK(&m->lock);
+    *stats = p->stats;
+    MUTEX_UNLOCK(&m->lock);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* TX mixer
+ *
+ * Shares the synchronous TX interface among several producers of
+ * timestamped bursts. See the FN_STREAMING_TX_MIXER group in libbladeRF.h.
+ */
+
+#ifndef STREAMING_TX_MIXER_H_
+#define STREAMING_TX_MIXER_H_
+
+#include <libbladeRF.h>
+
+int tx_mixer_create(struct bladerf *dev,
+                    struct bladerf_tx_mixer **mixer,
+                    const struct bladerf_tx_mixer_config *config);
+
+void tx_mixer_destroy(struct bladerf_tx_mixer *mixer);
+
+int tx_mixer_get_stats(struct bladerf_tx_mixer *mixer,
+                       struct bladerf_tx_mixer_stats *stats);
+
+int tx_producer_add(struct bladerf_tx_mixer *mixer,
+                    struct bladerf_tx_producer **producer);
+
+void tx_producer_remove(struct bladerf_tx_producer *producer);
+
+int tx_producer_submit(struct bladerf_tx_producer *producer,
+                       const int16_t *samples,
+                       unsigned int num_samples,
+                       bladerf_timestamp timestamp);
+
+int tx_producer_get_stats(struct bladerf_tx_producer *producer,
+                          struct bladerf_tx_producer_stats *stats);
+
+#endif
@@ -0,0 +1,305 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Calibration store tests: saving and loading entries, parsing of
+ * hand-written entries, staleness checks, and merging of per-module results.
+ *
+ * The store lives in the user's config directory, so HOME is pointed at a
+ * temporary directory for the duration of the test. */
+
+#include <libbladeRF.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "helpers/calstore.h"
+#include "helpers/file.h"
+
+#define PRINT_ERROR(...) printf(__VA_ARGS__)
+
+#define SERIAL "0123456789abcdef0123456789abcdef"
+
+#define CHECK(cond_)                                                         \
+    do {                                                                     \
+        if (!(cond_)) {                                                      \
+            PRINT_ERROR("%s:%d: check failed: %s\n", __FUNCTION__, __LINE__, \
+                        #cond_);                                             \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+static const struct bladerf_lms_dc_cals sample_cals = {
+    0x1a, 0x22, 0x23, 0x05, 0x06, 0x31, 0x01, 0x02, 0x03, 0x04
+};
+
+static char config_dir[512];
+
+static int write_entry(const char *contents)
+{
+    char *path = file_user_path(SERIAL ".cal", true);
+    FILE *f;
+    int status = -1;
+
+    if (path == NULL) {
+        return -1;
+    }
+
+    f = fopen(path, "w");
+    if (f != NULL) {
+        if (fputs(contents, f) >= 0) {
+            status = 0;
+        }
+        fclose(f);
+    }
+
+    free(path);
+    return status;
+}
+
+static bool cals_equal(const struct bladerf_lms_dc_cals *a,
+                       const struct bladerf_lms_dc_cals *b)
+{
+    return a->lpf_tuning == b->lpf_tuning && a->tx_lpf_i == b->tx_lpf_i &&
+           a->tx_lpf_q == b->tx_lpf_q && a->rx_lpf_i == b->rx_lpf_i &&
+           a->rx_lpf_q == b->rx_lpf_q && a->dc_ref == b->dc_ref &&
+           a->rxvga2a_i == b->rxvga2a_i && a->rxvga2a_q == b->rxvga2a_q &&
+           a->rxvga2b_i == b->rxvga2b_i && a->rxvga2b_q == b->rxvga2b_q;
+}
+
+/* Count the files in the config directory */
+static unsigned int count_files(void)
+{
+    struct dirent *e;
+    unsigned int n = 0;
+    DIR *d;
+
+    d = opendir(config_dir);
+    if (d == NULL) {
+        return 0;
+    }
+
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] != '.') {
+            n++;
+        }
+    }
+
+    closedir(d);
+    return n;
+}
+
+static size_t test_save_load(void)
+{
+    struct calstore cs, loaded;
+    size_t failures = 0;
+
+    CHECK(calstore_load(SERIAL, &loaded) == BLADERF_ERR_NO_FILE);
+
+    calstore_init(&cs, SERIAL);
+    CHECK(cs.version == CALSTORE_VERSION);
+    CHECK(cs.lms.lpf_tuning == -1 && cs.lms.rxvga2b_q == -1);
+
+    cs.lms     = sample_cals;
+    cs.created = 1234567890;
+    CHECK(calstore_save(&cs) == 0);
+
+    /* Only the entry itself remains; the temporary file was renamed */
+    CHECK(count_files() == 1);
+
+    CHECK(calstore_load(SERIAL, &loaded) == 0);
+    CHECK(loaded.version == CALSTORE_VERSION);
+    CHECK(strcmp(loaded.serial, SERIAL) == 0);
+    CHECK(loaded.created == 1234567890);
+    CHECK(cals_equal(&loaded.lms, &sample_cals));
+
+    /* Saving again replaces the entry outright */
+    calstore_init(&cs, SERIAL);
+    CHECK(calstore_save(&cs) == 0);
+    CHECK(count_files() == 1);
+    CHECK(calstore_load(SERIAL, &loaded) == 0);
+    CHECK(loaded.lms.lpf_tuning == -1 && loaded.lms.dc_ref == -1);
+
+    return failures;
+}
+
+static size_t test_parse(void)
+{
+    struct calstore cs;
+    size_t failures = 0;
+
+    /* Comments, blank lines, CRLF line endings and unknown keys are
+     * accepted. Register values are masked to 8 bits and negative values
+     * mean "not calibrated". Absent fields are unknown. */
+    CHECK(write_entry("# comment\r\n"
+                      "\n"
+                      "version=1\r\n"
+                      "serial=" SERIAL "\n"
+                      "created=42\n"
+                      "temperature=31.50\n"
+                      "some_future_key=abc\n"
+                      "lms_lpf_tuning=26\n"
+                      "lms_tx_lpf_i=511\n"
+                      "lms_rx_lpf_q=-5\n") == 0);
+
+    CHECK(calstore_load(SERIAL, &cs) == 0);
+    CHECK(cs.version == 1);
+    CHECK(strcmp(cs.serial, SERIAL) == 0);
+    CHECK(cs.created == 42);
+    CHECK(cs.lms.lpf_tuning == 26);
+    CHECK(cs.lms.tx_lpf_i == 0xff);
+    CHECK(cs.lms.rx_lpf_q == -1);
+    CHECK(cs.lms.tx_lpf_q == -1 && cs.lms.dc_ref == -1);
+
+    /* A file without a version or creation time is never usable */
+    CHECK(write_entry("serial=" SERIAL "\n") == 0);
+    CHECK(calstore_load(SERIAL, &cs) == 0);
+    CHECK(cs.version == 0 && cs.created == 0);
+    CHECK(calstore_stale(&cs, SERIAL, 100) != NULL);
+
+    /* Malformed lines */
+    CHECK(write_entry("version=1\nno separator\n") == 0);
+    CHECK(calstore_load(SERIAL, &cs) == BLADERF_ERR_INVAL);
+
+    CHECK(write_entry("version=1\nlms_dc_ref=12x\n") == 0);
+    CHECK(calstore_load(SERIAL, &cs) == BLADERF_ERR_INVAL);
+
+    CHECK(write_entry("created=\n") == 0);
+    CHECK(calstore_load(SERIAL, &cs) == BLADERF_ERR_INVAL);
+
+    return failures;
+}
+
+static size_t test_stale(void)
+{
+    struct calstore cs;
+    size_t failures = 0;
+    const time_t now = 2000000000;
+
+    calstore_init(&cs, SERIAL);
+    cs.created = now - 100;
+
+    CHECK(calstore_stale(&cs, SERIAL, now) == NULL);
+    CHECK(calstore_stale(&cs, "fedcba9876543210fedcba9876543210", now) !=
+          NULL);
+
+    cs.version = CALSTORE_VERSION + 1;
+    CHECK(calstore_stale(&cs, SERIAL, now) != NULL);
+    cs.version = CALSTORE_VERSION;
+
+    cs.created = now + 1;
+    CHECK(calstore_stale(&cs, SERIAL, now) != NULL);
+
+    cs.created = now - CALSTORE_MAX_AGE_SEC;
+    CHECK(calstore_stale(&cs, SERIAL, now) == NULL);
+
+    cs.created = now - CALSTORE_MAX_AGE_SEC - 1;
+    CHECK(calstore_stale(&cs, SERIAL, now) != NULL);
+
+    return failures;
+}
+
+static size_t test_merge(void)
+{
+    struct bladerf_lms_dc_cals other;
+    struct calstore cs;
+    size_t failures = 0;
+
+    calstore_init(&cs, SERIAL);
+
+    CHECK(calstore_merge(&cs, &sample_cals, BLADERF_DC_CAL_TX_LPF) == 0);
+    CHECK(cs.lms.tx_lpf_i == sample_cals.tx_lpf_i);
+    CHECK(cs.lms.tx_lpf_q == sample_cals.tx_lpf_q);
+    CHECK(cs.lms.lpf_tuning == -1 && cs.lms.rx_lpf_i == -1);
+    CHECK(cs.lms.dc_ref == -1 && cs.lms.rxvga2a_i == -1);
+
+    CHECK(calstore_merge(&cs, &sample_cals, BLADERF_DC_CAL_RXVGA2) == 0);
+    CHECK(cs.lms.dc_ref == sample_cals.dc_ref);
+    CHECK(cs.lms.rxvga2a_i == sample_cals.rxvga2a_i);
+    CHECK(cs.lms.rxvga2a_q == sample_cals.rxvga2a_q);
+    CHECK(cs.lms.rxvga2b_i == sample_cals.rxvga2b_i);
+    CHECK(cs.lms.rxvga2b_q == sample_cals.rxvga2b_q);
+    CHECK(cs.lms.rx_lpf_q == -1);
+
+    CHECK(calstore_merge(&cs, &sample_cals, BLADERF_DC_CAL_LPF_TUNING) == 0);
+    CHECK(calstore_merge(&cs, &sample_cals, BLADERF_DC_CAL_RX_LPF) == 0);
+    CHECK(cals_equal(&cs.lms, &sample_cals));
+
+    /* A later calibration of one module only replaces its own results */
+    other          = sample_cals;
+    other.rx_lpf_i = 0x11;
+    other.rx_lpf_q = 0x12;
+    other.tx_lpf_i = 0x77;
+    CHECK(calstore_merge(&cs, &other, BLADERF_DC_CAL_RX_LPF) == 0);
+    CHECK(cs.lms.rx_lpf_i == 0x11 && cs.lms.rx_lpf_q == 0x12);
+    CHECK(cs.lms.tx_lpf_i == sample_cals.tx_lpf_i);
+
+    /* Unknown modules are rejected, leaving the entry unchanged */
+    other = cs.lms;
+    CHECK(calstore_merge(&cs, &sample_cals, (bladerf_cal_module)99) ==
+          BLADERF_ERR_INVAL);
+    CHECK(cals_equal(&cs.lms, &other));
+
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    char home[] = "/tmp/bladerf_calstore_XXXXXX";
+    char *path;
+    size_t failures = 0;
+
+    if (mkdtemp(home) == NULL) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    setenv("HOME", home, 1);
+    snprintf(config_dir, sizeof(config_dir), "%s/.config/Nuand/bladeRF",
+             home);
+
+    failures += test_save_load();
+    failures += test_parse();
+    failures += test_stale();
+    failures += test_merge();
+
+    /* Clean up */
+    path = file_user_path(SERIAL ".cal", false);
+    if (path != NULL) {
+        remove(path);
+        free(path);
+    }
+    rmdir(config_dir);
+    snprintf(config_dir, sizeof(config_dir), "%s/.config/Nuand", home);
+    rmdir(config_dir);
+    snprintf(config_dir, sizeof(config_dir), "%s/.config", home);
+    rmdir(config_dir);
+    rmdir(home);
+
+    if (failures != 0) {
+        PRINT_ERROR("%zu calibration store check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All calibration store checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This program verifies that bladeRF.hpp builds as C++17, and that its sample
+ * conversions behave. If a device string is given, a few buffers are also
+ * received from that device as complex<float>.
+ */
+#include <iostream>
+#include <limits>
+#include <bladeRF.hpp>
+
+using sc16   = std::complex<int16_t>;
+using cfloat = std::complex<float>;
+
+/* Instantiate everything, to catch errors in templates not otherwise used */
+template class bladeRF::rx_stream<sc16>;
+template class bladeRF::rx_stream<cfloat, 2, true>;
+template class bladeRF::tx_stream<sc16, 2>;
+template class bladeRF::tx_stream<cfloat, 1, true>;
+
+static bool check_conversions()
+{
+    using traits = bladeRF::sample_traits<cfloat>;
+
+    int16_t const in[] = { 0, 2047, -2048, 1024, -1, 1 };
+    cfloat f[3];
+    int16_t out[6];
+
+    traits::from_sc16(in, f, 3);
+    traits::to_sc16(f, out, 3);
+
+    for (size_t i = 0; i < 6; i++) {
+        if (in[i] != out[i]) {
+            std::cerr << "Round trip failed at " << i << ": " << in[i]
+                      << " != " << out[i] << std::endl;
+            return false;
+        }
+    }
+
+    /* Out of range values saturate */
+    cfloat const big[] = { { 2.0f, -2.0f } };
+    traits::to_sc16(big, out, 1);
+
+    if (out[0] != 2047 || out[1] != -2048) {
+        std::cerr << "Saturation failed" << std::endl;
+        return false;
+    }
+
+    /* NaN converts to 0 */
+    float const nan = std::numeric_limits<float>::quiet_NaN();
+    cfloat const nans[] = { { nan, 0.5f }, { -0.5f, -nan } };
+    traits::to_sc16(nans, out, 2);
+
+    if (out[0] != 0 || out[1] != 1024 || out[2] != -1024 || out[3] != 0) {
+        std::cerr << "NaN conversion failed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!check_conversions()) {
+        return 1;
+    }
+
+    if (argc < 2) {
+        return 0;
+    }
+
+    try {
+        bladeRF::device dev(argv[1]);
+        bladeRF::rx_stream<cfloat> rx(dev);
+        std::vector<cfloat> samples(8192);
+
+        for (int i = 0; i < 16; i++) {
+            rx.receive(samples);
+        }
+
+        std::cout << "First sample: " << samples[0] << std::endl;
+    } catch (bladeRF::error const &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
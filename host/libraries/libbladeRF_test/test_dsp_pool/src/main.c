@@ -0,0 +1,325 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* DSP pool tests: jobs that finish out of order are still reported done in
+ * submission order and one at a time, a full pool rejects further jobs, and
+ * draining or destroying a pool completes every outstanding job.
+ *
+ * The synchronous interface's use of the pool is covered by the "dsp" test of
+ * libbladeRF_test_replay. */
+
+#include "host_config.h"
+#include <libbladeRF.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "streaming/dsp_pool.h"
+
+#define PRINT_ERROR(...) printf(__VA_ARGS__)
+
+#define CHECK(cond_)                                                         \
+    do {                                                                     \
+        if (!(cond_)) {                                                      \
+            PRINT_ERROR("%s:%d: check failed: %s\n", __FUNCTION__, __LINE__, \
+                        #cond_);                                             \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+#define MAX_JOBS 256
+
+struct job {
+    unsigned int index;
+    unsigned int delay_us;
+    unsigned int finish_seq; /* Order in which the work finished */
+    bool worked;
+};
+
+struct results {
+    pthread_mutex_t lock;
+    pthread_cond_t gate_opened;
+    bool gated; /* Work waits until the gate is opened */
+
+    unsigned int num_finished;
+    unsigned int num_done;
+    unsigned int done_order[MAX_JOBS];
+
+    bool in_done;
+    unsigned int concurrent_done;
+    unsigned int done_before_work;
+};
+
+static struct job jobs[MAX_JOBS];
+static struct results r;
+
+static void reset(unsigned int num_jobs)
+{
+    unsigned int i;
+
+    memset(jobs, 0, sizeof(jobs));
+    for (i = 0; i < num_jobs; i++) {
+        jobs[i].index = i;
+    }
+
+    r.gated            = false;
+    r.num_finished     = 0;
+    r.num_done         = 0;
+    r.in_done          = false;
+    r.concurrent_done  = 0;
+    r.done_before_work = 0;
+}
+
+static void work(void *arg, void *job_ptr)
+{
+    struct results *res = (struct results *)arg;
+    struct job *job     = (struct job *)job_ptr;
+
+    pthread_mutex_lock(&res->lock);
+    while (res->gated) {
+        pthread_cond_wait(&res->gate_opened, &res->lock);
+    }
+    pthread_mutex_unlock(&res->lock);
+
+    if (job->delay_us != 0) {
+        usleep(job->delay_us);
+    }
+
+    pthread_mutex_lock(&res->lock);
+    job->worked     = true;
+    job->finish_seq = res->num_finished++;
+    pthread_mutex_unlock(&res->lock);
+}
+
+static void done(void *arg, void *job_ptr)
+{
+    struct results *res = (struct results *)arg;
+    struct job *job     = (struct job *)job_ptr;
+
+    pthread_mutex_lock(&res->lock);
+    if (res->in_done) {
+        res->concurrent_done++;
+    }
+    res->in_done = true;
+
+    if (!job->worked) {
+        res->done_before_work++;
+    }
+    pthread_mutex_unlock(&res->lock);
+
+    /* Give another thread the chance to report a job concurrently */
+    usleep(50);
+
+    pthread_mutex_lock(&res->lock);
+    if (res->num_done < MAX_JOBS) {
+        res->done_order[res->num_done] = job->index;
+    }
+    res->num_done++;
+    res->in_done = false;
+    pthread_mutex_unlock(&res->lock);
+}
+
+/* Submit a job, waiting for room in the pool */
+static int submit(struct dsp_pool *pool, struct job *job)
+{
+    int status;
+
+    while ((status = dsp_pool_submit(pool, job)) == BLADERF_ERR_QUEUE_FULL) {
+        usleep(100);
+    }
+
+    return status;
+}
+
+static size_t check_done_in_order(unsigned int num_jobs)
+{
+    size_t failures = 0;
+    unsigned int i;
+
+    CHECK(r.num_done == num_jobs);
+    CHECK(r.concurrent_done == 0);
+    CHECK(r.done_before_work == 0);
+
+    for (i = 0; i < num_jobs && i < r.num_done; i++) {
+        if (r.done_order[i] != i) {
+            PRINT_ERROR("%s: job %u reported done in place of job %u\n",
+                        __FUNCTION__, r.done_order[i], i);
+            failures++;
+            break;
+        }
+    }
+
+    return failures;
+}
+
+static size_t test_invalid(void)
+{
+    /* Any non-NULL value, to check that it is cleared */
+    struct dsp_pool *pool = (struct dsp_pool *)&r;
+    size_t failures       = 0;
+
+    CHECK(dsp_pool_create(&pool, 0, 4, work, done, &r) == BLADERF_ERR_INVAL);
+    CHECK(pool == NULL);
+
+    CHECK(dsp_pool_create(&pool, DSP_POOL_MAX_THREADS + 1, 4, work, done,
+                          &r) == BLADERF_ERR_INVAL);
+    CHECK(pool == NULL);
+
+    CHECK(dsp_pool_create(&pool, 2, 0, work, done, &r) == BLADERF_ERR_INVAL);
+    CHECK(pool == NULL);
+
+    dsp_pool_destroy(NULL);
+
+    return failures;
+}
+
+/* Every fourth job takes much longer than the rest, so the jobs submitted
+ * after it finish first */
+static size_t test_out_of_order(void)
+{
+    const unsigned int num_jobs = 200;
+    struct dsp_pool *pool;
+    size_t failures = 0;
+    unsigned int i, overtaken = 0;
+
+    reset(num_jobs);
+
+    CHECK(dsp_pool_create(&pool, 4, 16, work, done, &r) == 0);
+    if (failures != 0) {
+        return failures;
+    }
+
+    for (i = 0; i < num_jobs; i++) {
+        jobs[i].delay_us = (i % 4 == 0) ? 3000 : 0;
+        CHECK(submit(pool, &jobs[i]) == 0);
+    }
+
+    dsp_pool_drain(pool);
+
+    /* Everything is done once the pool has drained */
+    failures += check_done_in_order(num_jobs);
+
+    for (i = 1; i < num_jobs; i++) {
+        if (jobs[i].finish_seq < jobs[i - 1].finish_seq) {
+            overtaken++;
+        }
+    }
+
+    /* Otherwise, this test has not shown anything */
+    CHECK(overtaken > 0);
+
+    dsp_pool_destroy(pool);
+    return failures;
+}
+
+static size_t test_full(void)
+{
+    const unsigned int max_jobs = 4;
+    struct dsp_pool *pool;
+    struct job extra;
+    size_t failures = 0;
+    unsigned int i;
+
+    reset(max_jobs);
+    r.gated = true;
+
+    CHECK(dsp_pool_create(&pool, 2, max_jobs, work, done, &r) == 0);
+    if (failures != 0) {
+        return failures;
+    }
+
+    for (i = 0; i < max_jobs; i++) {
+        CHECK(dsp_pool_submit(pool, &jobs[i]) == 0);
+    }
+
+    memset(&extra, 0, sizeof(extra));
+    CHECK(dsp_pool_submit(pool, &extra) == BLADERF_ERR_QUEUE_FULL);
+
+    pthread_mutex_lock(&r.lock);
+    CHECK(r.num_done == 0);
+    r.gated = false;
+    pthread_cond_broadcast(&r.gate_opened);
+    pthread_mutex_unlock(&r.lock);
+
+    dsp_pool_drain(pool);
+    failures += check_done_in_order(max_jobs);
+
+    /* Room is made as jobs are reported done */
+    extra.index = max_jobs;
+    CHECK(dsp_pool_submit(pool, &extra) == 0);
+    dsp_pool_drain(pool);
+    CHECK(r.num_done == max_jobs + 1);
+
+    dsp_pool_destroy(pool);
+    return failures;
+}
+
+/* Destroying a pool completes the jobs it still holds */
+static size_t test_destroy(void)
+{
+    const unsigned int num_jobs = 8;
+    struct dsp_pool *pool;
+    size_t failures = 0;
+    unsigned int i;
+
+    reset(num_jobs);
+
+    CHECK(dsp_pool_create(&pool, 3, num_jobs, work, done, &r) == 0);
+    if (failures != 0) {
+        return failures;
+    }
+
+    for (i = 0; i < num_jobs; i++) {
+        jobs[i].delay_us = 2000 - 200 * i;
+        CHECK(dsp_pool_submit(pool, &jobs[i]) == 0);
+    }
+
+    dsp_pool_destroy(pool);
+    failures += check_done_in_order(num_jobs);
+
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t failures = 0;
+
+    pthread_mutex_init(&r.lock, NULL);
+    pthread_cond_init(&r.gate_opened, NULL);
+
+    failures += test_invalid();
+    failures += test_out_of_order();
+    failures += test_full();
+    failures += test_destroy();
+
+    pthread_cond_destroy(&r.gate_opened);
+    pthread_mutex_destroy(&r.lock);
+
+    if (failures != 0) {
+        PRINT_ERROR("%zu DSP pool check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All DSP pool checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_replay.h"
+
+#ifdef _WIN32
+#define setenv(name, value, overwrite) _putenv_s(name, value)
+#endif
+
+void test_file(const struct app_params *p, const char *name,
+               char *path, size_t len)
+{
+    snprintf(path, len, "%s/libbladeRF_test_replay_%s", p->dir, name);
+}
+
+static void put_le32(uint8_t *buf, uint32_t value)
+{
+    size_t i;
+
+    for (i = 0; i < 4; i++) {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_le64(uint8_t *buf, uint64_t value)
+{
+    size_t i;
+
+    for (i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint64_t get_le64(const uint8_t *buf)
+{
+    uint64_t value = 0;
+    size_t i;
+
+    for (i = 0; i < 8; i++) {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+
+    return value;
+}
+
+int write_counter_recording(const char *path, unsigned int channels,
+                            uint64_t ts, size_t num_msgs,
+                            size_t gap_msg, uint64_t gap)
+{
+    uint8_t msg[MSG_SIZE];
+    FILE *f;
+    size_t m, i;
+    int status = 0;
+
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    for (m = 0; m < num_msgs && status == 0; m++) {
+        if (m == gap_msg) {
+            ts += gap;
+        }
+
+        memset(msg, 0, MSG_HEADER_SIZE);
+        put_le64(&msg[4], ts);
+
+        for (i = 0; i < SAMPLES_PER_MSG; i++) {
+            const uint32_t t = (uint32_t)(ts + i / channels) & COUNTER_MASK;
+            const uint32_t c = (uint32_t)(i % channels);
+
+            put_le32(&msg[MSG_HEADER_SIZE + 4 * i], t | (c << 16));
+        }
+
+        if (fwrite(msg, sizeof(msg), 1, f) != 1) {
+            perror(path);
+            status = -1;
+        }
+
+        ts += SAMPLES_PER_MSG / channels;
+    }
+
+    if (fclose(f) != 0 && status == 0) {
+        perror(path);
+        status = -1;
+    }
+
+    return status;
+}
+
+int open_replay(struct bladerf **dev, const char *path, const char *options)
+{
+    char config[1024];
+    int n;
+
+    n = snprintf(config, sizeof(config), "file=%s,format=meta,msg_size=%u%s%s",
+                 path, MSG_SIZE, options != NULL ? "," : "",
+                 options != NULL ? options : "");
+
+    if (n < 0 || (size_t)n >= sizeof(config)) {
+        return BLADERF_ERR_INVAL;
+    }
+
+    setenv("BLADERF_REPLAY", config, 1);
+
+    return bladerf_open(dev, "replay:");
+}
@@ -0,0 +1,228 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Tests of streaming and control features that run against the replay
+ * backend, using recordings written by the tests themselves. No hardware is
+ * required. */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conversions.h"
+#include "test_replay.h"
+
+static const struct test_case *tests[] = {
+    // clang-format off
+    &test_case_loop,
+    &test_case_tx_mixer,
+    &test_case_history,
+    &test_case_slots,
+    &test_case_dsp,
+    &test_case_async_ctrl,
+    &test_case_profile,
+    &test_case_telemetry,
+#ifdef ENABLE_LIBBLADERF_FAULT_INJECTION
+    &test_case_faults,
+#endif
+    // clang-format on
+};
+
+#define OPTARG "t:o:v:hL"
+static const struct option long_options[] = {
+    // clang-format off
+    { "test",       required_argument,  0,      't'},
+    { "dir",        required_argument,  0,      'o'},
+    { "help",       no_argument,        0,      'h'},
+    { "list-tests", no_argument,        0,      'L'},
+    { "verbosity",  required_argument,  0,      'v'},
+    { 0,            0,                  0,       0 },
+    // clang-format on
+};
+
+struct stats {
+    bool ran;
+    size_t failures;
+};
+
+static void usage(const char *argv0)
+{
+    printf("Usage: %s [options]\n", argv0);
+    printf("Exercise libbladeRF streaming and control features with the\n");
+    printf("replay backend.\n");
+    printf("\nOptions:\n");
+    printf("  -t, --test <name>             Run specified test.\n");
+    printf("  -o, --dir <path>              Directory for temporary recordings.\n");
+    printf("                                Default: $TMPDIR, or the current\n");
+    printf("                                directory.\n");
+    printf("  -h, --help                    Show this text.\n");
+    printf("  -L, --list-tests              List available tests.\n");
+    printf("  -v, --verbosity <level>       Set libbladeRF verbosity level.\n");
+}
+
+static void list_tests()
+{
+    size_t i;
+
+    printf("Available tests:\n");
+    printf("-------------------------\n");
+    for (i = 0; i < ARRAY_SIZE(tests); i++) {
+        printf("    %s\n", tests[i]->name);
+    }
+    printf("\n");
+}
+
+static int get_params(int argc, char *argv[], struct app_params *p)
+{
+    int c, idx;
+    bool ok;
+    bladerf_log_level level;
+
+    memset(p, 0, sizeof(p[0]));
+
+    /* Streams time out at the end of a recording, which is expected */
+    bladerf_log_set_verbosity(BLADERF_LOG_LEVEL_SILENT);
+
+    while ((c = getopt_long(argc, argv, OPTARG, long_options, &idx)) != -1) {
+        switch (c) {
+            case 't':
+                free(p->test_name);
+                p->test_name = strdup(optarg);
+                if (NULL == p->test_name) {
+                    perror("strdup");
+                    return -1;
+                }
+                break;
+
+            case 'o':
+                free(p->dir);
+                p->dir = strdup(optarg);
+                if (NULL == p->dir) {
+                    perror("strdup");
+                    return -1;
+                }
+                break;
+
+            case 'h':
+                usage(argv[0]);
+                return 1;
+
+            case 'L':
+                list_tests();
+                return 1;
+
+            case 'v':
+                level = str2loglevel(optarg, &ok);
+                if (ok) {
+                    bladerf_log_set_verbosity(level);
+                } else {
+                    fprintf(stderr, "Invalid log level: %s\n", optarg);
+                    return -1;
+                }
+                break;
+
+            default:
+                return -1;
+        }
+    }
+
+    if (NULL == p->dir) {
+        const char *tmpdir = getenv("TMPDIR");
+
+        p->dir = strdup(tmpdir != NULL ? tmpdir : ".");
+        if (NULL == p->dir) {
+            perror("strdup");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct app_params p;
+    struct stats *stats = NULL;
+    bool pass           = true;
+    size_t i;
+    int status;
+
+    status = get_params(argc, argv, &p);
+    if (status != 0) {
+        if (1 == status) {
+            status = 0;
+        }
+        goto out;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++) {
+        if (NULL == p.test_name || !strcasecmp(p.test_name, tests[i]->name)) {
+            break;
+        }
+    }
+
+    if (i >= ARRAY_SIZE(tests)) {
+        fprintf(stderr, "Invalid test: %s\n", p.test_name);
+        status = -1;
+        goto out;
+    }
+
+    stats = calloc(ARRAY_SIZE(tests), sizeof(stats[0]));
+    if (NULL == stats) {
+        perror("calloc");
+        status = -1;
+        goto out;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++) {
+        if (NULL == p.test_name || !strcasecmp(p.test_name, tests[i]->name)) {
+            stats[i].ran      = true;
+            stats[i].failures = tests[i]->fn(&p, false);
+        }
+    }
+
+    puts("\nFailure counts");
+    puts("--------------------------------------------");
+    for (i = 0; i < ARRAY_SIZE(tests); i++) {
+        if (stats[i].ran) {
+            printf("%16s %zu\n", tests[i]->name, stats[i].failures);
+        }
+
+        if (stats[i].failures != 0) {
+            pass = false;
+        }
+    }
+    puts("");
+
+    status = pass ? 0 : -1;
+
+out:
+    free(p.test_name);
+    free(p.dir);
+    free(stats);
+    return status;
+}
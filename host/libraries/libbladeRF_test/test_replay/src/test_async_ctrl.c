@@ -0,0 +1,689 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Asynchronous control operations, performed on the replay device's settings:
+ *
+ *  - Operations that pile up into batches, including repeated and failing
+ *    ones, complete with the same status and value, and leave the device in
+ *    the same state, as the same operations performed synchronously.
+ *  - Waiting upon a pending operation times out, and it completes once the
+ *    control thread gets to it.
+ *  - Several threads submitting at once see their operations completed in
+ *    order, whether their futures are waited upon, released right away or
+ *    released from the callback. Closing the device completes every pending
+ *    operation, and futures remain usable afterwards.
+ *
+ * This is also meant to be run under ThreadSanitizer and AddressSanitizer. */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "test_replay.h"
+
+#define NUM_OPS         400
+#define NUM_THREADS     4
+#define OPS_PER_THREAD  500
+#define NUM_CLOSE_OPS   100
+#define TIMEOUT_MS      1000
+
+/* RX gain set by the operation that holds up the control thread */
+#define GATE_GAIN       30
+
+/* Channels whose settings are checked. Operations are also submitted on an
+ * invalid channel, which fail. */
+static const bladerf_channel channels[] = {
+    BLADERF_CHANNEL_RX(0),
+    BLADERF_CHANNEL_TX(0),
+};
+
+#define NUM_CHANNELS (sizeof(channels) / sizeof(channels[0]))
+#define INVALID_CHANNEL BLADERF_CHANNEL_RX(2)
+
+struct dev_state {
+    bladerf_frequency frequency[NUM_CHANNELS];
+    bladerf_gain gain[NUM_CHANNELS];
+    bladerf_sample_rate sample_rate[NUM_CHANNELS];
+    bladerf_bandwidth bandwidth[NUM_CHANNELS];
+};
+
+/* Outcome of an operation, and the device's state right after it */
+struct result {
+    bool called;
+    int status;
+    uint64_t actual;
+    struct dev_state state;
+};
+
+/* Holds up the control thread, so that operations pile up behind it */
+struct gate {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool closed;
+};
+
+static struct gate gate = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false
+};
+
+static void gate_set(bool closed)
+{
+    pthread_mutex_lock(&gate.lock);
+    gate.closed = closed;
+    pthread_cond_broadcast(&gate.cond);
+    pthread_mutex_unlock(&gate.lock);
+}
+
+static void gate_cb(struct bladerf *dev, struct bladerf_future *future,
+                    int status, void *user_data)
+{
+    pthread_mutex_lock(&gate.lock);
+    while (gate.closed) {
+        pthread_cond_wait(&gate.cond, &gate.lock);
+    }
+    pthread_mutex_unlock(&gate.lock);
+}
+
+/* Submit an operation whose callback waits for the gate to open */
+static int submit_gate(struct bladerf *dev, struct bladerf_future **future)
+{
+    struct bladerf_ctrl_request req;
+
+    memset(&req, 0, sizeof(req));
+    req.op         = BLADERF_CTRL_SET_GAIN;
+    req.channel    = BLADERF_CHANNEL_RX(0);
+    req.value.gain = GATE_GAIN;
+
+    gate_set(true);
+    return bladerf_submit_ctrl(dev, &req, gate_cb, NULL, future);
+}
+
+static int get_state(struct bladerf *dev, struct dev_state *s)
+{
+    size_t i;
+    int status = 0;
+
+    for (i = 0; i < NUM_CHANNELS && status == 0; i++) {
+        status = bladerf_get_frequency(dev, channels[i], &s->frequency[i]);
+        if (status == 0) {
+            status = bladerf_get_gain(dev, channels[i], &s->gain[i]);
+        }
+        if (status == 0) {
+            status =
+                bladerf_get_sample_rate(dev, channels[i], &s->sample_rate[i]);
+        }
+        if (status == 0) {
+            status = bladerf_get_bandwidth(dev, channels[i], &s->bandwidth[i]);
+        }
+    }
+
+    return status;
+}
+
+static int set_state(struct bladerf *dev, const struct dev_state *s)
+{
+    size_t i;
+    int status = 0;
+
+    for (i = 0; i < NUM_CHANNELS && status == 0; i++) {
+        status = bladerf_set_frequency(dev, channels[i], s->frequency[i]);
+        if (status == 0) {
+            status = bladerf_set_gain(dev, channels[i], s->gain[i]);
+        }
+        if (status == 0) {
+            status = bladerf_set_sample_rate(dev, channels[i],
+                                             s->sample_rate[i], NULL);
+        }
+        if (status == 0) {
+            status = bladerf_set_bandwidth(dev, channels[i], s->bandwidth[i],
+                                           NULL);
+        }
+    }
+
+    return status;
+}
+
+static bool states_equal(const struct dev_state *a, const struct dev_state *b)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_CHANNELS; i++) {
+        if (a->frequency[i] != b->frequency[i] || a->gain[i] != b->gain[i] ||
+            a->sample_rate[i] != b->sample_rate[i] ||
+            a->bandwidth[i] != b->bandwidth[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return (*state >> 16) & 0x7fff;
+}
+
+/* Generate operations from a few values per setting, so that many of them
+ * repeat the previous one. Some fail: frequencies out of range, and any
+ * operation on the invalid channel. */
+static void generate_ops(struct bladerf_ctrl_request *ops, size_t n)
+{
+    static const bladerf_frequency frequencies[] = {
+        915000000, 2400000000, 10000000 /* Out of range */
+    };
+    static const bladerf_gain gains[] = { 0, 20, 40 };
+    static const bladerf_sample_rate rates[] = { 1000000, 10000000 };
+    static const bladerf_bandwidth bandwidths[] = { 1500000, 28000000 };
+
+    uint32_t rand_state = 1;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        struct bladerf_ctrl_request *req = &ops[i];
+        const uint32_t r                 = next_random(&rand_state);
+
+        if (i > 0 && r % 3 == 0) {
+            *req = ops[i - 1];
+            continue;
+        }
+
+        memset(req, 0, sizeof(*req));
+        req->channel = (r % 17 == 1) ? INVALID_CHANNEL
+                                     : channels[(r >> 4) % NUM_CHANNELS];
+
+        switch ((r >> 6) % 4) {
+            case 0:
+                req->op              = BLADERF_CTRL_SET_FREQUENCY;
+                req->value.frequency = frequencies[(r >> 8) % 3];
+                break;
+
+            case 1:
+                req->op         = BLADERF_CTRL_SET_GAIN;
+                req->value.gain = gains[(r >> 8) % 3];
+                break;
+
+            case 2:
+                req->op                = BLADERF_CTRL_SET_SAMPLE_RATE;
+                req->value.sample_rate = rates[(r >> 8) % 2];
+                break;
+
+            default:
+                req->op              = BLADERF_CTRL_SET_BANDWIDTH;
+                req->value.bandwidth = bandwidths[(r >> 8) % 2];
+                break;
+        }
+    }
+}
+
+static int perform_sync(struct bladerf *dev,
+                        const struct bladerf_ctrl_request *req,
+                        uint64_t *actual)
+{
+    bladerf_sample_rate rate;
+    bladerf_bandwidth bw;
+    int status;
+
+    *actual = 0;
+
+    switch (req->op) {
+        case BLADERF_CTRL_SET_FREQUENCY:
+            return bladerf_set_frequency(dev, req->channel,
+                                         req->value.frequency);
+
+        case BLADERF_CTRL_SET_GAIN:
+            return bladerf_set_gain(dev, req->channel, req->value.gain);
+
+        case BLADERF_CTRL_SET_SAMPLE_RATE:
+            status = bladerf_set_sample_rate(dev, req->channel,
+                                             req->value.sample_rate, &rate);
+            if (status == 0) {
+                *actual = rate;
+            }
+            return status;
+
+        case BLADERF_CTRL_SET_BANDWIDTH:
+            status = bladerf_set_bandwidth(dev, req->channel,
+                                           req->value.bandwidth, &bw);
+            if (status == 0) {
+                *actual = bw;
+            }
+            return status;
+
+        default:
+            return BLADERF_ERR_INVAL;
+    }
+}
+
+static void record_cb(struct bladerf *dev, struct bladerf_future *future,
+                      int status, void *user_data)
+{
+    struct result *res = user_data;
+
+    res->called = true;
+    res->status = status;
+
+    if (get_state(dev, &res->state) != 0) {
+        res->status = BLADERF_ERR_UNEXPECTED;
+    }
+}
+
+static failure_count check_sequential(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_ctrl_request *ops;
+    struct bladerf_future **futures;
+    struct result *expected, *results;
+    struct dev_state initial;
+    size_t i, num_failed = 0, num_repeats = 0;
+    int status;
+
+    PRINT("%s: Comparing %u batched operations with synchronous calls...\n",
+          __FUNCTION__, NUM_OPS);
+
+    ops      = calloc(NUM_OPS, sizeof(ops[0]));
+    futures  = calloc(NUM_OPS, sizeof(futures[0]));
+    expected = calloc(NUM_OPS, sizeof(expected[0]));
+    results  = calloc(NUM_OPS, sizeof(results[0]));
+    if (ops == NULL || futures == NULL || expected == NULL ||
+        results == NULL) {
+        PR_ERROR("Failed to allocate operations\n");
+        failures++;
+        goto out;
+    }
+
+    generate_ops(ops, NUM_OPS);
+
+    /* Start from the state that the gate's operation leaves behind */
+    status = bladerf_set_gain(dev, BLADERF_CHANNEL_RX(0), GATE_GAIN);
+    if (status == 0) {
+        status = get_state(dev, &initial);
+    }
+
+    if (status != 0) {
+        PR_ERROR("Failed to get settings: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    for (i = 0; i < NUM_OPS; i++) {
+        expected[i].status = perform_sync(dev, &ops[i], &expected[i].actual);
+        get_state(dev, &expected[i].state);
+
+        if (expected[i].status != 0) {
+            num_failed++;
+        }
+
+        if (i > 0 && memcmp(&ops[i], &ops[i - 1], sizeof(ops[i])) == 0) {
+            num_repeats++;
+        }
+    }
+
+    /* Otherwise, this test has not shown anything */
+    if (num_failed == 0 || num_repeats == 0) {
+        PR_ERROR("Generated %u failing and %u repeated operations\n",
+                 (unsigned int)num_failed, (unsigned int)num_repeats);
+        failures++;
+    }
+
+    status = set_state(dev, &initial);
+    if (status != 0) {
+        PR_ERROR("Failed to restore settings: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    /* Hold up the control thread until everything has been submitted */
+    status = submit_gate(dev, NULL);
+
+    for (i = 0; i < NUM_OPS && status == 0; i++) {
+        status = bladerf_submit_ctrl(dev, &ops[i], record_cb, &results[i],
+                                     &futures[i]);
+    }
+
+    gate_set(false);
+
+    if (status != 0) {
+        PR_ERROR("Failed to submit operation %u: %s\n", (unsigned int)i,
+                 bladerf_strerror(status));
+        failures++;
+    }
+
+    for (i = 0; i < NUM_OPS && futures[i] != NULL; i++) {
+        uint64_t actual;
+
+        status = bladerf_future_wait(futures[i], 0, &actual);
+
+        if (!results[i].called) {
+            PR_ERROR("Operation %u completed without its callback\n",
+                     (unsigned int)i);
+            failures++;
+        } else if (status != expected[i].status ||
+                   results[i].status != expected[i].status ||
+                   actual != expected[i].actual) {
+            PR_ERROR("Operation %u (op %d, channel %d): expected status %d "
+                     "and value %llu, got %d and %llu\n",
+                     (unsigned int)i, ops[i].op, ops[i].channel,
+                     expected[i].status,
+                     (unsigned long long)expected[i].actual, status,
+                     (unsigned long long)actual);
+            failures++;
+        } else if (!states_equal(&results[i].state, &expected[i].state)) {
+            PR_ERROR("Operation %u (op %d, channel %d) left the device in a "
+                     "different state\n",
+                     (unsigned int)i, ops[i].op, ops[i].channel);
+            failures++;
+        }
+
+        bladerf_future_free(futures[i]);
+    }
+
+out:
+    free(results);
+    free(expected);
+    free(futures);
+    free(ops);
+    return failures;
+}
+
+static failure_count check_timeout(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_ctrl_request req;
+    struct bladerf_future *future = NULL;
+    uint64_t actual               = 0;
+    int status;
+
+    PRINT("%s: Waiting upon a pending operation...\n", __FUNCTION__);
+
+    memset(&req, 0, sizeof(req));
+    req.op                = BLADERF_CTRL_SET_SAMPLE_RATE;
+    req.channel           = BLADERF_CHANNEL_RX(0);
+    req.value.sample_rate = 2000000;
+
+    status = submit_gate(dev, NULL);
+    if (status == 0) {
+        status = bladerf_submit_ctrl(dev, &req, NULL, NULL, &future);
+    }
+
+    if (status != 0) {
+        gate_set(false);
+        PR_ERROR("Failed to submit: %s\n", bladerf_strerror(status));
+        return 1;
+    }
+
+    status = bladerf_future_wait(future, 10, &actual);
+    if (status != BLADERF_ERR_TIMEOUT || bladerf_future_ready(future)) {
+        PR_ERROR("Pending operation: got %s\n", bladerf_strerror(status));
+        failures++;
+    }
+
+    gate_set(false);
+
+    status = bladerf_future_wait(future, TIMEOUT_MS, &actual);
+    if (status != 0 || actual != 2000000 || !bladerf_future_ready(future)) {
+        PR_ERROR("Completed operation: got %s, with %llu\n",
+                 bladerf_strerror(status), (unsigned long long)actual);
+        failures++;
+    }
+
+    bladerf_future_free(future);
+    return failures;
+}
+
+/* Operations submitted by one of several threads */
+struct submitter {
+    pthread_t thread;
+    struct bladerf *dev;
+    unsigned int id;
+
+    /* Updated by the callbacks, which all run on the control thread */
+    unsigned int num_completed;
+    unsigned int num_out_of_order;
+    unsigned int num_failed;
+
+    /* Errors of the submitting thread itself */
+    unsigned int num_errors;
+};
+
+struct submission {
+    struct submitter *s;
+    unsigned int seq;
+    bool free_in_cb;
+};
+
+static struct submission submissions[NUM_THREADS][OPS_PER_THREAD];
+
+static void submission_cb(struct bladerf *dev, struct bladerf_future *future,
+                          int status, void *user_data)
+{
+    struct submission *sub = user_data;
+    struct submitter *s    = sub->s;
+
+    if (sub->seq != s->num_completed) {
+        s->num_out_of_order++;
+    }
+
+    if (status != 0) {
+        s->num_failed++;
+    }
+
+    s->num_completed++;
+
+    if (sub->free_in_cb) {
+        bladerf_future_free(future);
+    }
+}
+
+static void *submitter_thread(void *arg)
+{
+    struct submitter *s = arg;
+    struct bladerf_ctrl_request req;
+    unsigned int i;
+    int status;
+
+    memset(&req, 0, sizeof(req));
+    req.channel = channels[s->id % NUM_CHANNELS];
+
+    for (i = 0; i < OPS_PER_THREAD; i++) {
+        struct submission *sub = &submissions[s->id][i];
+        struct bladerf_future *future;
+
+        sub->s          = s;
+        sub->seq        = i;
+        sub->free_in_cb = (i % 4 == 3);
+
+        /* Runs of the same operation, interleaved with the other threads'
+         * operations */
+        if ((i / 3) % 2 == 0) {
+            req.op              = BLADERF_CTRL_SET_FREQUENCY;
+            req.value.frequency = 100000000 + 1000000 * ((i / 6) % 5);
+        } else {
+            req.op         = BLADERF_CTRL_SET_GAIN;
+            req.value.gain = (bladerf_gain)((i / 6) % 60);
+        }
+
+        switch (i % 4) {
+            case 0:
+                status = bladerf_submit_ctrl(s->dev, &req, submission_cb, sub,
+                                             NULL);
+                break;
+
+            case 1:
+                status = bladerf_submit_ctrl(s->dev, &req, submission_cb, sub,
+                                             &future);
+                if (status == 0) {
+                    bladerf_future_free(future);
+                }
+                break;
+
+            case 2:
+                status = bladerf_submit_ctrl(s->dev, &req, submission_cb, sub,
+                                             &future);
+                if (status == 0) {
+                    if (bladerf_future_wait(future, TIMEOUT_MS, NULL) != 0) {
+                        s->num_errors++;
+                    }
+                    bladerf_future_free(future);
+                }
+                break;
+
+            default:
+                /* Released by the callback */
+                status = bladerf_submit_ctrl(s->dev, &req, submission_cb, sub,
+                                             &future);
+                break;
+        }
+
+        if (status != 0) {
+            s->num_errors++;
+        }
+    }
+
+    return NULL;
+}
+
+static failure_count check_threads(const char *path, bool quiet)
+{
+    failure_count failures = 0;
+    struct submitter s[NUM_THREADS];
+    struct bladerf_future *futures[NUM_CLOSE_OPS];
+    struct bladerf_ctrl_request req;
+    struct bladerf *dev = NULL;
+    unsigned int i, num_started = 0, num_closed = 0;
+    int status;
+
+    PRINT("%s: Submitting from %u threads, then closing the device...\n",
+          __FUNCTION__, NUM_THREADS);
+
+    status = open_replay(&dev, path, NULL);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    memset(s, 0, sizeof(s));
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        s[i].dev = dev;
+        s[i].id  = i;
+
+        if (pthread_create(&s[i].thread, NULL, submitter_thread, &s[i]) != 0) {
+            PR_ERROR("Failed to start submitter thread\n");
+            failures++;
+            break;
+        }
+
+        num_started++;
+    }
+
+    for (i = 0; i < num_started; i++) {
+        pthread_join(s[i].thread, NULL);
+    }
+
+    /* Leave operations pending for bladerf_close() to complete */
+    memset(&req, 0, sizeof(req));
+    req.op      = BLADERF_CTRL_SET_BANDWIDTH;
+    req.channel = BLADERF_CHANNEL_TX(0);
+
+    for (i = 0; i < NUM_CLOSE_OPS; i++) {
+        req.value.bandwidth = 1000000 + 100000 * (i % 7);
+
+        futures[i] = NULL;
+        status = bladerf_submit_ctrl(dev, &req, NULL, NULL, &futures[i]);
+        if (status != 0) {
+            PR_ERROR("Failed to submit: %s\n", bladerf_strerror(status));
+            failures++;
+            break;
+        }
+    }
+
+    bladerf_close(dev);
+
+    for (i = 0; i < NUM_CLOSE_OPS && futures[i] != NULL; i++) {
+        uint64_t actual = 0;
+
+        if (bladerf_future_ready(futures[i]) &&
+            bladerf_future_wait(futures[i], 0, &actual) == 0 &&
+            actual == 1000000 + 100000 * (i % 7)) {
+            num_closed++;
+        }
+
+        bladerf_future_free(futures[i]);
+    }
+
+    if (num_closed != NUM_CLOSE_OPS) {
+        PR_ERROR("%u of %u operations completed by bladerf_close()\n",
+                 num_closed, NUM_CLOSE_OPS);
+        failures++;
+    }
+
+    for (i = 0; i < num_started; i++) {
+        if (s[i].num_completed != OPS_PER_THREAD ||
+            s[i].num_out_of_order != 0 || s[i].num_failed != 0 ||
+            s[i].num_errors != 0) {
+            PR_ERROR("Thread %u: %u of %u completed, %u out of order, "
+                     "%u failed, %u errors\n",
+                     i, s[i].num_completed, OPS_PER_THREAD,
+                     s[i].num_out_of_order, s[i].num_failed,
+                     s[i].num_errors);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+failure_count test_async_ctrl(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf *dev    = NULL;
+    char path[1024];
+    int status;
+
+    /* The device is only opened to operate upon its settings */
+    test_file(p, "async_ctrl.bin", path, sizeof(path));
+    if (write_counter_recording(path, 1, 0, 4, 0, 0) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, NULL);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+    } else {
+        failures += check_sequential(dev, quiet);
+        failures += check_timeout(dev, quiet);
+        bladerf_close(dev);
+
+        failures += check_threads(path, quiet);
+    }
+
+    remove(path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(async_ctrl);
@@ -0,0 +1,598 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Stream the SC8 wire format through the synchronous interface's DSP threads:
+ *
+ *  - RX samples are delivered in order, with each sample unpacked from the
+ *    recording at its timestamp.
+ *  - With BLADERF_RX_OVERRUN_DROP_OLDEST and a stalled reader, the samples
+ *    that are delivered still match their timestamps, gaps are reported, and
+ *    everything is either delivered or recorded as dropped.
+ *  - TX samples reach the capture packed, in order, at their timestamps.
+ *  - Closing the device right after the last bladerf_sync_tx() call, while
+ *    the DSP threads may still hold buffers, leaves an intact prefix of the
+ *    burst in the capture.
+ *  - A failure to submit a packed TX buffer is reported by a later
+ *    bladerf_sync_tx() call, rather than lost or left waiting.
+ *
+ * In SC8 recordings and captures, sample (I, Q) at timestamp t is the pair of
+ * bytes (t, t >> 8). */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define SAMPLE_RATE     4000000
+#define FIRST_TS        1000
+#define BUFFER_SIZE     2048
+#define NUM_BUFFERS     32
+#define NUM_XFERS       8
+#define DSP_THREADS     4
+#define CHUNK           3000
+#define TIMEOUT_MS      1000
+
+/* Timeout of the stream whose capture fails, so that the DSP threads give up
+ * on it quickly */
+#define FAIL_TIMEOUT_MS 100
+
+#define SC8_SAMPLES_PER_MSG ((MSG_SIZE - MSG_HEADER_SIZE) / 2)
+
+#define RX_MSGS         200
+#define OVERRUN_MSGS    600
+
+#define TX_TS           10000
+#define TX_LEN          50000
+#define TX_CHUNK        1000
+
+static inline uint8_t sc8_i(uint64_t t)
+{
+    return (uint8_t)t;
+}
+
+static inline uint8_t sc8_q(uint64_t t)
+{
+    return (uint8_t)(t >> 8);
+}
+
+/* SC16 Q11 value of a sample unpacked from SC8 */
+static inline int16_t sc8_to_sc16(uint8_t v)
+{
+    return (int16_t)((int8_t)v * 16);
+}
+
+static void put_le64(uint8_t *buf, uint64_t value)
+{
+    size_t i;
+
+    for (i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static int write_sc8_recording(const char *path, uint64_t ts, size_t num_msgs)
+{
+    uint8_t msg[MSG_SIZE];
+    FILE *f;
+    size_t m, i;
+    int status = 0;
+
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    for (m = 0; m < num_msgs && status == 0; m++) {
+        memset(msg, 0, MSG_HEADER_SIZE);
+        put_le64(&msg[4], ts);
+
+        for (i = 0; i < SC8_SAMPLES_PER_MSG; i++) {
+            msg[MSG_HEADER_SIZE + 2 * i]     = sc8_i(ts + i);
+            msg[MSG_HEADER_SIZE + 2 * i + 1] = sc8_q(ts + i);
+        }
+
+        if (fwrite(msg, sizeof(msg), 1, f) != 1) {
+            perror(path);
+            status = -1;
+        }
+
+        ts += SC8_SAMPLES_PER_MSG;
+    }
+
+    if (fclose(f) != 0 && status == 0) {
+        perror(path);
+        status = -1;
+    }
+
+    return status;
+}
+
+/* Open a replay device, and configure a stream of SC8 samples processed by
+ * DSP_THREADS threads */
+static int open_sc8(struct bladerf **dev,
+                    const char *path,
+                    const char *options,
+                    bladerf_channel_layout layout,
+                    bladerf_format format,
+                    unsigned int timeout_ms)
+{
+    const bladerf_direction dir = layout & BLADERF_DIRECTION_MASK;
+    const bladerf_channel ch =
+        dir == BLADERF_RX ? BLADERF_CHANNEL_RX(0) : BLADERF_CHANNEL_TX(0);
+    int status;
+
+    status = open_replay(dev, path, options);
+    if (status != 0) {
+        return status;
+    }
+
+    status = bladerf_set_sample_rate(*dev, ch, SAMPLE_RATE, NULL);
+    if (status == 0) {
+        status = bladerf_set_wire_format(*dev, dir, BLADERF_WIRE_FORMAT_SC8);
+    }
+    if (status == 0) {
+        status = bladerf_set_sync_dsp_threads(*dev, dir, DSP_THREADS);
+    }
+    if (status == 0) {
+        status = bladerf_sync_config(*dev, layout, format, NUM_BUFFERS,
+                                     BUFFER_SIZE, NUM_XFERS, timeout_ms);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(*dev, ch, true);
+    }
+
+    if (status != 0) {
+        bladerf_close(*dev);
+        *dev = NULL;
+    }
+
+    return status;
+}
+
+/* Check `n` received samples, the first of which is at timestamp `ts` */
+static failure_count check_rx(const int16_t *samples, uint64_t ts,
+                              unsigned int n)
+{
+    unsigned int k;
+
+    for (k = 0; k < n; k++) {
+        const int16_t ei = sc8_to_sc16(sc8_i(ts + k));
+        const int16_t eq = sc8_to_sc16(sc8_q(ts + k));
+
+        if (samples[2 * k] != ei || samples[2 * k + 1] != eq) {
+            PR_ERROR("RX sample at t=%llu: expected (%d, %d), got (%d, %d)\n",
+                     (unsigned long long)(ts + k), ei, eq, samples[2 * k],
+                     samples[2 * k + 1]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static failure_count check_rx_order(const struct app_params *p,
+                                    int16_t *samples, bool quiet)
+{
+    const uint64_t total = (uint64_t)RX_MSGS * SC8_SAMPLES_PER_MSG;
+    struct bladerf *dev  = NULL;
+    struct bladerf_metadata meta;
+    failure_count failures = 0;
+    char path[1024];
+    uint64_t ts = FIRST_TS;
+    int status;
+
+    PRINT("  Checking RX sample order and content...\n");
+
+    test_file(p, "dsp_rx.bin", path, sizeof(path));
+    if (write_sc8_recording(path, FIRST_TS, RX_MSGS) != 0) {
+        return 1;
+    }
+
+    status = open_sc8(&dev, path, "rate=realtime", BLADERF_RX_X1,
+                      BLADERF_FORMAT_SC16_Q11_META, TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    while (ts < FIRST_TS + total && failures == 0) {
+        const uint64_t left = FIRST_TS + total - ts;
+        const unsigned int n = left < CHUNK ? (unsigned int)left : CHUNK;
+
+        memset(&meta, 0, sizeof(meta));
+        meta.flags = BLADERF_META_FLAG_RX_NOW;
+
+        status = bladerf_sync_rx(dev, samples, n, &meta, TIMEOUT_MS);
+        if (status != 0) {
+            PR_ERROR("RX failed at t=%llu: %s\n", (unsigned long long)ts,
+                     bladerf_strerror(status));
+            failures++;
+        } else if (meta.timestamp != ts || meta.actual_count != n ||
+                   (meta.status & BLADERF_META_STATUS_OVERRUN)) {
+            PR_ERROR("Expected %u samples @ t=%llu, got %u @ t=%llu, "
+                     "status 0x%08x\n", n, (unsigned long long)ts,
+                     meta.actual_count, (unsigned long long)meta.timestamp,
+                     meta.status);
+            failures++;
+        } else {
+            failures += check_rx(samples, ts, n);
+            ts += n;
+        }
+    }
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return failures;
+}
+
+static failure_count check_rx_overrun(const struct app_params *p,
+                                      int16_t *samples, bool quiet)
+{
+    const uint64_t total = (uint64_t)OVERRUN_MSGS * SC8_SAMPLES_PER_MSG;
+    struct bladerf *dev  = NULL;
+    struct bladerf_metadata meta;
+    struct bladerf_rx_overrun overrun;
+    failure_count failures = 0;
+    unsigned int gaps      = 0;
+    uint64_t delivered     = 0;
+    uint64_t ts            = FIRST_TS;
+    char path[1024];
+    int status;
+
+    PRINT("  Checking RX overrun recovery...\n");
+
+    test_file(p, "dsp_overrun.bin", path, sizeof(path));
+    if (write_sc8_recording(path, FIRST_TS, OVERRUN_MSGS) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, "rate=max");
+    if (status == 0) {
+        status = bladerf_set_wire_format(dev, BLADERF_RX,
+                                         BLADERF_WIRE_FORMAT_SC8);
+    }
+    if (status == 0) {
+        status = bladerf_set_sync_dsp_threads(dev, BLADERF_RX, DSP_THREADS);
+    }
+    if (status == 0) {
+        status = bladerf_set_rx_overrun_recovery(
+            dev, BLADERF_RX_OVERRUN_DROP_OLDEST);
+    }
+    if (status == 0) {
+        status = bladerf_sync_config(dev, BLADERF_RX_X1,
+                                     BLADERF_FORMAT_SC16_Q11_META, 16,
+                                     BUFFER_SIZE, NUM_XFERS, TIMEOUT_MS / 2);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), true);
+    }
+    if (status != 0) {
+        PR_ERROR("Failed to configure RX stream: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    while (failures == 0) {
+        memset(&meta, 0, sizeof(meta));
+        meta.flags = BLADERF_META_FLAG_RX_NOW;
+
+        /* Samples read by a call that fails are lost, so read a message
+         * at a time. The call at the end of the recording then has nothing
+         * to return. */
+        status = bladerf_sync_rx(dev, samples, SC8_SAMPLES_PER_MSG, &meta,
+                                 TIMEOUT_MS);
+        if (status != 0) {
+            break;
+        }
+
+        if (meta.timestamp < ts) {
+            PR_ERROR("Samples @ t=%llu were delivered after t=%llu\n",
+                     (unsigned long long)meta.timestamp,
+                     (unsigned long long)ts);
+            failures++;
+            break;
+        }
+
+        if (meta.timestamp != ts) {
+            gaps++;
+        }
+
+        failures += check_rx(samples, meta.timestamp, meta.actual_count);
+
+        ts = meta.timestamp + meta.actual_count;
+        delivered += meta.actual_count;
+
+        /* Fall well behind after the first read */
+        if (delivered == meta.actual_count) {
+            usleep(50000);
+        }
+    }
+
+    status = bladerf_get_rx_overrun(dev, &overrun);
+    if (status != 0) {
+        PR_ERROR("Failed to get overrun info: %s\n", bladerf_strerror(status));
+        failures++;
+    } else if (failures == 0) {
+        if (gaps == 0 || overrun.count == 0) {
+            PR_ERROR("Expected an overrun, but got %u gaps and %u dropped "
+                     "buffers\n", gaps, overrun.count);
+            failures++;
+        }
+
+        if (delivered + overrun.length != total) {
+            PR_ERROR("%llu samples delivered and %llu dropped, of %llu\n",
+                     (unsigned long long)delivered,
+                     (unsigned long long)overrun.length,
+                     (unsigned long long)total);
+            failures++;
+        }
+    }
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return failures;
+}
+
+/* Check the SC8 capture of the TX burst. If `complete`, the whole burst must
+ * be present, and otherwise some prefix of it. */
+static failure_count check_capture(const char *path, bool complete,
+                                   bool quiet)
+{
+    uint8_t msg[MSG_SIZE];
+    failure_count failures = 0;
+    uint64_t seen          = 0;
+    FILE *f;
+    size_t i;
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        PR_ERROR("Failed to open %s\n", path);
+        return 1;
+    }
+
+    while (failures == 0 && fread(msg, sizeof(msg), 1, f) == 1) {
+        const uint64_t ts = get_le64(&msg[4]);
+
+        for (i = 0; i < SC8_SAMPLES_PER_MSG; i++) {
+            const uint64_t t = ts + i;
+            const uint8_t si = msg[MSG_HEADER_SIZE + 2 * i];
+            const uint8_t sq = msg[MSG_HEADER_SIZE + 2 * i + 1];
+            uint8_t ei = 0, eq = 0;
+
+            if (t >= TX_TS && t < TX_TS + TX_LEN) {
+                if (t != TX_TS + seen) {
+                    PR_ERROR("Transmitted t=%llu, after %llu burst "
+                             "samples\n", (unsigned long long)t,
+                             (unsigned long long)seen);
+                    failures++;
+                    break;
+                }
+
+                ei = sc8_i(t);
+                eq = sc8_q(t);
+                seen++;
+            }
+
+            if (si != ei || sq != eq) {
+                PR_ERROR("Transmitted sample at t=%llu: expected (%u, %u), "
+                         "got (%u, %u)\n", (unsigned long long)t, ei, eq, si,
+                         sq);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    fclose(f);
+
+    if (failures == 0 && complete && seen != TX_LEN) {
+        PR_ERROR("%llu of %u burst samples transmitted\n",
+                 (unsigned long long)seen, TX_LEN);
+        failures++;
+    }
+
+    PRINT("    %llu of %u burst samples in the capture\n",
+          (unsigned long long)seen, TX_LEN);
+
+    return failures;
+}
+
+/* Transmit the burst. If `wait`, wait for it to be consumed before closing
+ * the device, and otherwise close it immediately. */
+static failure_count check_tx(const struct app_params *p,
+                              const char *rx_path,
+                              int16_t *samples,
+                              bool wait,
+                              bool quiet)
+{
+    struct bladerf *dev = NULL;
+    struct bladerf_metadata meta;
+    failure_count failures = 0;
+    char tx_path[1024], options[1100];
+    bladerf_timestamp now = 0;
+    unsigned int off, k, ms;
+    int status;
+
+    PRINT("  Checking TX sample content%s...\n",
+          wait ? "" : ", closing the device immediately");
+
+    test_file(p, "dsp_tx.bin", tx_path, sizeof(tx_path));
+    snprintf(options, sizeof(options), "rate=max,tx_file=%s", tx_path);
+
+    status = open_sc8(&dev, rx_path, options, BLADERF_TX_X1,
+                      BLADERF_FORMAT_SC16_Q11_META, TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    for (off = 0; off < TX_LEN && failures == 0; off += TX_CHUNK) {
+        for (k = 0; k < TX_CHUNK; k++) {
+            samples[2 * k]     = sc8_to_sc16(sc8_i(TX_TS + off + k));
+            samples[2 * k + 1] = sc8_to_sc16(sc8_q(TX_TS + off + k));
+        }
+
+        memset(&meta, 0, sizeof(meta));
+        if (off == 0) {
+            meta.flags     = BLADERF_META_FLAG_TX_BURST_START;
+            meta.timestamp = TX_TS;
+        } else if (off + TX_CHUNK == TX_LEN) {
+            meta.flags = BLADERF_META_FLAG_TX_BURST_END;
+        }
+
+        status = bladerf_sync_tx(dev, samples, TX_CHUNK, &meta, TIMEOUT_MS);
+        if (status != 0) {
+            PR_ERROR("TX failed at offset %u: %s\n", off,
+                     bladerf_strerror(status));
+            failures++;
+        }
+    }
+
+    for (ms = 0; wait && now < TX_TS + TX_LEN && ms < TIMEOUT_MS; ms += 10) {
+        usleep(10000);
+        bladerf_get_timestamp(dev, BLADERF_TX, &now);
+    }
+
+    bladerf_close(dev);
+    dev = NULL;
+
+    if (failures == 0) {
+        failures += check_capture(tx_path, wait, quiet);
+    }
+
+out:
+    remove(tx_path);
+    return failures;
+}
+
+static failure_count check_tx_error(const char *rx_path, int16_t *samples,
+                                    bool quiet)
+{
+#ifdef _WIN32
+    PRINT("  Skipping the TX error check on this platform.\n");
+    return 0;
+#else
+    struct bladerf *dev = NULL;
+    failure_count failures = 0;
+    int status;
+
+    PRINT("  Checking the report of TX submission errors...\n");
+
+    /* Every write to the capture fails */
+    status = open_sc8(&dev, rx_path, "rate=max,tx_file=/dev/full",
+                      BLADERF_TX_X1, BLADERF_FORMAT_SC16_Q11,
+                      FAIL_TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    memset(samples, 0, 2 * BUFFER_SIZE * sizeof(samples[0]));
+
+    /* The stream fails upon the first buffer */
+    status = bladerf_sync_tx(dev, samples, BUFFER_SIZE, NULL, TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("First buffer: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    usleep(2 * FAIL_TIMEOUT_MS * 1000);
+
+    /* The second buffer is handed to the DSP threads, which fail to submit it
+     * once packed. That only becomes known after this call returns. */
+    status = bladerf_sync_tx(dev, samples, BUFFER_SIZE, NULL, TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("Second buffer: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    usleep(2 * FAIL_TIMEOUT_MS * 1000);
+
+    /* ...so it is reported by the next call */
+    status = bladerf_sync_tx(dev, samples, BUFFER_SIZE, NULL, TIMEOUT_MS);
+    if (status != BLADERF_ERR_TIMEOUT) {
+        PR_ERROR("Third buffer: expected \"%s\", got \"%s\"\n",
+                 bladerf_strerror(BLADERF_ERR_TIMEOUT),
+                 bladerf_strerror(status));
+        failures++;
+    }
+
+out:
+    bladerf_close(dev);
+    return failures;
+#endif
+}
+
+failure_count test_dsp(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+    char rx_path[1024];
+    int16_t *samples;
+
+    PRINT("%s: Checking SC8 streaming with %u DSP threads...\n", __FUNCTION__,
+          DSP_THREADS);
+
+    samples = calloc(2 * (CHUNK > BUFFER_SIZE ? CHUNK : BUFFER_SIZE),
+                     sizeof(int16_t));
+    if (samples == NULL) {
+        PR_ERROR("Failed to allocate samples\n");
+        return 1;
+    }
+
+    failures += check_rx_order(p, samples, quiet);
+    failures += check_rx_overrun(p, samples, quiet);
+
+    /* The TX checks only need a recording to open the device with */
+    test_file(p, "dsp_tx_rx.bin", rx_path, sizeof(rx_path));
+    if (write_sc8_recording(rx_path, FIRST_TS, 1) != 0) {
+        failures++;
+    } else {
+        failures += check_tx(p, rx_path, samples, true, quiet);
+        failures += check_tx(p, rx_path, samples, false, quiet);
+        failures += check_tx_error(rx_path, samples, quiet);
+    }
+
+    remove(rx_path);
+    free(samples);
+    return failures;
+}
+
+DECLARE_TEST_CASE(dsp);
@@ -0,0 +1,372 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Stream fault injection: with a fixed seed, the counts of injected delays,
+ * dropped buffers and timeouts agree with the configuration and with what the
+ * stream's owner actually saw, the same seed reproduces the same faults, and
+ * the device streams normally again once the faults are cleared.
+ *
+ * This requires a library built with ENABLE_LIBBLADERF_FAULT_INJECTION. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define NUM_MSGS            7
+#define FIRST_TS            1000
+
+#define NUM_BUFFERS         16
+#define NUM_TRANSFERS       8
+#define MSGS_PER_BUFFER     4
+#define BUFFER_SAMPLES      (MSGS_PER_BUFFER * MSG_SIZE / 4)
+#define TS_PER_BUFFER       (MSGS_PER_BUFFER * SAMPLES_PER_MSG)
+
+/* Buffers to receive in each run */
+#define NUM_RECEIVED        200
+
+#define SEED                0x5eed
+#define DELAY_US            50
+#define DROP_PROB           0.25
+
+struct faults_state {
+    void **buffers;
+    size_t idx;
+
+    size_t received;
+    size_t skipped;
+    uint64_t next_ts;
+    failure_count failures;
+};
+
+/* Check that a message holds the samples of the recording's message at its
+ * timestamp. The recording is looped, with timestamps carrying on. */
+static void check_message(struct faults_state *s, const uint8_t *msg)
+{
+    const uint64_t ts           = get_le64(&msg[4]);
+    const uint64_t msg_index    = (ts - FIRST_TS) / SAMPLES_PER_MSG;
+    const uint64_t recording_ts = FIRST_TS +
+                                  (msg_index % NUM_MSGS) * SAMPLES_PER_MSG;
+    size_t i;
+
+    for (i = 0; i < SAMPLES_PER_MSG; i++) {
+        const uint8_t *w = &msg[MSG_HEADER_SIZE + 4 * i];
+        const unsigned int t = (unsigned int)(recording_ts + i) & COUNTER_MASK;
+
+        if ((unsigned int)(w[0] | (w[1] << 8)) != t || w[2] != 0 || w[3] != 0) {
+            PR_ERROR("Buffer %zu: sample %zu of the message at %llu does not "
+                     "match the recording\n", s->received, i,
+                     (unsigned long long)ts);
+            s->failures++;
+            break;
+        }
+    }
+}
+
+static void *stream_cb(struct bladerf *dev,
+                       struct bladerf_stream *stream,
+                       struct bladerf_metadata *meta,
+                       void *samples,
+                       size_t num_samples,
+                       void *user_data)
+{
+    struct faults_state *s = user_data;
+    const uint8_t *buf     = samples;
+    uint64_t ts;
+    size_t off;
+
+    if (samples != NULL) {
+        ts = get_le64(&buf[4]);
+
+        /* Dropped buffers are lost whole; nothing else may go missing */
+        if (s->received > 0) {
+            if (ts < s->next_ts || (ts - s->next_ts) % TS_PER_BUFFER != 0) {
+                PR_ERROR("Buffer %zu: expected timestamp %llu plus a whole "
+                         "number of buffers, got %llu\n", s->received,
+                         (unsigned long long)s->next_ts,
+                         (unsigned long long)ts);
+                s->failures++;
+            } else {
+                s->skipped += (size_t)((ts - s->next_ts) / TS_PER_BUFFER);
+            }
+        }
+
+        for (off = 0; off < num_samples * 4; off += MSG_SIZE) {
+            check_message(s, &buf[off]);
+        }
+
+        s->next_ts = ts + TS_PER_BUFFER;
+        s->received++;
+    }
+
+    if (s->received >= NUM_RECEIVED) {
+        return BLADERF_STREAM_SHUTDOWN;
+    }
+
+    s->idx = (s->idx + 1) % NUM_BUFFERS;
+    return s->buffers[s->idx];
+}
+
+/* Receive up to NUM_RECEIVED buffers, returning the stream's status */
+static int run(struct bladerf *dev, struct faults_state *s,
+               struct bladerf_stream_fault_stats *stats)
+{
+    struct bladerf_stream *stream = NULL;
+    int status;
+
+    memset(s, 0, sizeof(*s));
+    s->idx = NUM_TRANSFERS - 1;
+
+    status = bladerf_init_stream(&stream, dev, stream_cb, &s->buffers,
+                                 NUM_BUFFERS, BLADERF_FORMAT_SC16_Q11_META,
+                                 BUFFER_SAMPLES, NUM_TRANSFERS, s);
+    if (status != 0) {
+        return status;
+    }
+
+    status = bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), true);
+    if (status == 0) {
+        status = bladerf_stream(stream, BLADERF_RX_X1);
+        bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), false);
+    }
+
+    /* The counts are those of the last stream */
+    if (bladerf_get_stream_fault_stats(dev, stats) != 0) {
+        memset(stats, 0xff, sizeof(*stats));
+    }
+
+    bladerf_deinit_stream(stream);
+    return status;
+}
+
+static failure_count check_drops(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_stream_faults faults;
+    struct bladerf_stream_fault_stats stats, repeat_stats;
+    struct faults_state s;
+    size_t repeat_skipped;
+    int status;
+
+    PRINT("%s: Delaying every buffer and dropping %.0f%%...\n", __FUNCTION__,
+          DROP_PROB * 100);
+
+    memset(&faults, 0, sizeof(faults));
+    faults.seed      = SEED;
+    faults.delay_us  = DELAY_US;
+    faults.drop_prob = DROP_PROB;
+
+    status = bladerf_set_stream_faults(dev, &faults);
+    if (status != 0) {
+        PR_ERROR("Failed to set stream faults: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    status = run(dev, &s, &stats);
+    failures += s.failures;
+    if (status != 0) {
+        PR_ERROR("Stream failed: %s\n", bladerf_strerror(status));
+        return failures + 1;
+    }
+
+    PRINT("  %llu completions, %llu delayed, %llu dropped\n",
+          (unsigned long long)stats.completions,
+          (unsigned long long)stats.delayed,
+          (unsigned long long)stats.dropped);
+
+    if (s.received != NUM_RECEIVED ||
+        stats.completions != s.received + stats.dropped) {
+        PR_ERROR("%zu buffers received and %llu dropped, of %llu "
+                 "completions\n", s.received,
+                 (unsigned long long)stats.dropped,
+                 (unsigned long long)stats.completions);
+        failures++;
+    }
+
+    if (s.skipped != stats.dropped) {
+        PR_ERROR("%zu buffers went missing, but %llu were dropped\n",
+                 s.skipped, (unsigned long long)stats.dropped);
+        failures++;
+    }
+
+    if (stats.delayed != stats.completions) {
+        PR_ERROR("Only %llu of %llu completions were delayed\n",
+                 (unsigned long long)stats.delayed,
+                 (unsigned long long)stats.completions);
+        failures++;
+    }
+
+    /* Well outside of what chance would allow for, at this many buffers */
+    if (stats.dropped < stats.completions * DROP_PROB / 2 ||
+        stats.dropped > stats.completions * DROP_PROB * 2) {
+        PR_ERROR("%llu of %llu completions dropped, for a probability of "
+                 "%.2f\n", (unsigned long long)stats.dropped,
+                 (unsigned long long)stats.completions, DROP_PROB);
+        failures++;
+    }
+
+    if (stats.timeouts != 0 || stats.stalls != 0) {
+        PR_ERROR("%llu timeouts and %llu stalls were injected, but none were "
+                 "configured\n", (unsigned long long)stats.timeouts,
+                 (unsigned long long)stats.stalls);
+        failures++;
+    }
+
+    /* The counts start over with the next stream, which sees the same faults
+     * for the same seed */
+    status         = run(dev, &s, &repeat_stats);
+    repeat_skipped = s.skipped;
+    failures += s.failures;
+
+    if (status != 0) {
+        PR_ERROR("Repeated stream failed: %s\n", bladerf_strerror(status));
+        failures++;
+    } else if (memcmp(&stats, &repeat_stats, sizeof(stats)) != 0 ||
+               repeat_skipped != stats.dropped) {
+        PR_ERROR("The same seed gave %llu drops of %llu completions, rather "
+                 "than %llu of %llu\n",
+                 (unsigned long long)repeat_stats.dropped,
+                 (unsigned long long)repeat_stats.completions,
+                 (unsigned long long)stats.dropped,
+                 (unsigned long long)stats.completions);
+        failures++;
+    }
+
+    return failures;
+}
+
+static failure_count check_timeout(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_stream_faults faults;
+    struct bladerf_stream_fault_stats stats;
+    struct faults_state s;
+    int status;
+
+    PRINT("%s: Timing out the first transfer...\n", __FUNCTION__);
+
+    memset(&faults, 0, sizeof(faults));
+    faults.seed         = SEED;
+    faults.timeout_prob = 1.0;
+
+    status = bladerf_set_stream_faults(dev, &faults);
+    if (status != 0) {
+        PR_ERROR("Failed to set stream faults: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    status = run(dev, &s, &stats);
+    failures += s.failures;
+
+    if (status != BLADERF_ERR_TIMEOUT) {
+        PR_ERROR("Expected the stream to time out, got: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+    }
+
+    if (s.received != 0 || stats.completions != 1 || stats.timeouts != 1) {
+        PR_ERROR("%zu buffers received, with %llu timeouts of %llu "
+                 "completions\n", s.received,
+                 (unsigned long long)stats.timeouts,
+                 (unsigned long long)stats.completions);
+        failures++;
+    }
+
+    return failures;
+}
+
+/* With the faults cleared, nothing is injected and nothing goes missing */
+static failure_count check_recovery(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_stream_fault_stats stats, zero;
+    struct faults_state s;
+    int status;
+
+    PRINT("%s: Streaming with the faults cleared...\n", __FUNCTION__);
+
+    status = bladerf_set_stream_faults(dev, NULL);
+    if (status != 0) {
+        PR_ERROR("Failed to clear stream faults: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    status = run(dev, &s, &stats);
+    failures += s.failures;
+    memset(&zero, 0, sizeof(zero));
+
+    if (status != 0) {
+        PR_ERROR("Stream failed: %s\n", bladerf_strerror(status));
+        failures++;
+    } else if (s.received != NUM_RECEIVED || s.skipped != 0) {
+        PR_ERROR("%zu buffers received, %zu missing\n", s.received,
+                 s.skipped);
+        failures++;
+    }
+
+    if (memcmp(&stats, &zero, sizeof(stats)) != 0) {
+        PR_ERROR("Faults were counted after they were cleared\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+failure_count test_faults(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf *dev = NULL;
+    char path[1024];
+    int status;
+
+    test_file(p, "faults.bin", path, sizeof(path));
+    if (write_counter_recording(path, 1, FIRST_TS, NUM_MSGS, 0, 0) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, "loop=1,rate=max");
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    failures += check_drops(dev, quiet);
+    failures += check_timeout(dev, quiet);
+    failures += check_recovery(dev, quiet);
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(faults);
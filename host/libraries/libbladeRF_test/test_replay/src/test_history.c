@@ -0,0 +1,274 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Exercise bladerf_sync_rx_at() and the RX history behind it, using a
+ * recording with a known discontinuity:
+ *
+ *  - Samples already consumed by bladerf_sync_rx() are read back.
+ *  - A future interval is read forward, after which bladerf_sync_rx()
+ *    continues from its end.
+ *  - An interval spanning the discontinuity is zero-filled there, and
+ *    reported as an overrun.
+ *  - The full history length preceding the stream's position can be read,
+ *    while samples older than the history's capacity cannot.
+ *  - Intervals longer than the history, and beyond the end of the stream,
+ *    are rejected.
+ *
+ * The stream has more buffers than the recording fills, so that the replay
+ * backend never overruns the host. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define SAMPLE_RATE         1000000
+#define HISTORY_MS          10
+#define HISTORY_LEN         (HISTORY_MS * (SAMPLE_RATE / 1000))
+
+#define FIRST_TS            1000
+#define NUM_MSGS            60
+#define GAP_MSG             30
+#define GAP                 777
+
+#define NUM_BUFFERS         64
+#define NUM_TRANSFERS       8
+#define MSGS_PER_BUFFER     4
+#define BUFFER_SIZE         (MSGS_PER_BUFFER * MSG_SIZE / 4)
+
+/* The history holds one buffer beyond its nominal length */
+#define CAPACITY            (HISTORY_LEN + BUFFER_SIZE)
+
+/* Interval read across the discontinuity */
+#define GAP_READ_TS         (msg_ts(GAP_MSG) - GAP - 240)
+#define GAP_READ_LEN        2000
+
+#define TIMEOUT_MS          500
+
+static uint64_t msg_ts(size_t m)
+{
+    return FIRST_TS + m * SAMPLES_PER_MSG + (m >= GAP_MSG ? GAP : 0);
+}
+
+static bool in_gap(uint64_t t)
+{
+    return t >= msg_ts(GAP_MSG) - GAP && t < msg_ts(GAP_MSG);
+}
+
+static failure_count check_samples(const int16_t *samples, uint64_t ts,
+                                   unsigned int n, bool quiet)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        const uint64_t t  = ts + i;
+        const int16_t exp = in_gap(t) ? 0 : (int16_t)(t & COUNTER_MASK);
+
+        if (samples[2 * i] != exp || samples[2 * i + 1] != 0) {
+            PR_ERROR("Sample at t=%llu: expected (%d, 0), got (%d, %d)\n",
+                     (unsigned long long)t, exp, samples[2 * i],
+                     samples[2 * i + 1]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Read an interval that should be available, and check it */
+static failure_count read_at(struct bladerf *dev, int16_t *samples,
+                             uint64_t ts, unsigned int n, bool expect_gap,
+                             bool quiet)
+{
+    struct bladerf_metadata meta;
+    int status;
+
+    memset(&meta, 0, sizeof(meta));
+
+    status = bladerf_sync_rx_at(dev, samples, n, ts, &meta, TIMEOUT_MS);
+    if (status != 0) {
+        PR_ERROR("Reading %u samples at t=%llu failed: %s\n", n,
+                 (unsigned long long)ts, bladerf_strerror(status));
+        return 1;
+    }
+
+    if (meta.timestamp != ts || meta.actual_count != n ||
+        ((meta.status & BLADERF_META_STATUS_OVERRUN) != 0) != expect_gap) {
+        PR_ERROR("Reading %u samples at t=%llu: got t=%llu, count=%u, "
+                 "status=0x%08x\n", n, (unsigned long long)ts,
+                 (unsigned long long)meta.timestamp, meta.actual_count,
+                 meta.status);
+        return 1;
+    }
+
+    return check_samples(samples, ts, n, quiet);
+}
+
+static failure_count expect_error(struct bladerf *dev, int16_t *samples,
+                                  uint64_t ts, unsigned int n, int expected,
+                                  bool quiet)
+{
+    int status = bladerf_sync_rx_at(dev, samples, n, ts, NULL, TIMEOUT_MS);
+
+    if (status != expected) {
+        PR_ERROR("Reading %u samples at t=%llu: expected \"%s\", got "
+                 "\"%s\"\n", n, (unsigned long long)ts,
+                 bladerf_strerror(expected), bladerf_strerror(status));
+        return 1;
+    }
+
+    return 0;
+}
+
+failure_count test_history(struct app_params *p, bool quiet)
+{
+    struct bladerf *dev    = NULL;
+    int16_t *samples       = NULL;
+    failure_count failures = 0;
+    struct bladerf_metadata meta;
+    char path[1024];
+    uint64_t pos;
+    int status;
+
+    PRINT("%s: Checking bladerf_sync_rx_at() and the RX history...\n",
+          __FUNCTION__);
+
+    samples = malloc(2 * (HISTORY_LEN + 1) * sizeof(samples[0]));
+    if (samples == NULL) {
+        PR_ERROR("Failed to allocate samples\n");
+        return 1;
+    }
+
+    test_file(p, "history.bin", path, sizeof(path));
+    if (write_counter_recording(path, 1, FIRST_TS, NUM_MSGS, GAP_MSG, GAP) !=
+        0) {
+        failures++;
+        goto out;
+    }
+
+    status = open_replay(&dev, path, "rate=max");
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    status = bladerf_set_sample_rate(dev, BLADERF_CHANNEL_RX(0), SAMPLE_RATE,
+                                     NULL);
+    if (status == 0) {
+        status = bladerf_sync_config(dev, BLADERF_RX_X1,
+                                     BLADERF_FORMAT_SC16_Q11_META, NUM_BUFFERS,
+                                     BUFFER_SIZE, NUM_TRANSFERS, TIMEOUT_MS);
+    }
+    if (status == 0) {
+        status = bladerf_set_rx_history(dev, HISTORY_MS);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), true);
+    }
+    if (status != 0) {
+        PR_ERROR("Failed to configure RX: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    /* Consume the start of the stream */
+    memset(&meta, 0, sizeof(meta));
+    meta.flags = BLADERF_META_FLAG_RX_NOW;
+    status     = bladerf_sync_rx(dev, samples, 2000, &meta, TIMEOUT_MS);
+    if (status != 0 || meta.timestamp != FIRST_TS) {
+        PR_ERROR("Initial read failed: %s, t=%llu\n", bladerf_strerror(status),
+                 (unsigned long long)meta.timestamp);
+        failures++;
+        goto out;
+    }
+
+    PRINT("  Reading back consumed samples...\n");
+    failures += read_at(dev, samples, FIRST_TS + 500, 400, false, quiet);
+    failures += read_at(dev, samples, FIRST_TS, 2000, false, quiet);
+
+    PRINT("  Reading forward to a future interval...\n");
+    failures += read_at(dev, samples, 10000, 500, false, quiet);
+
+    memset(&meta, 0, sizeof(meta));
+    meta.flags = BLADERF_META_FLAG_RX_NOW;
+    status     = bladerf_sync_rx(dev, samples, 100, &meta, TIMEOUT_MS);
+    if (status != 0 || meta.timestamp != 10500 ||
+        check_samples(samples, meta.timestamp, 100, quiet) != 0) {
+        PR_ERROR("bladerf_sync_rx() did not continue after the interval: "
+                 "%s, t=%llu\n", bladerf_strerror(status),
+                 (unsigned long long)meta.timestamp);
+        failures++;
+    }
+
+    PRINT("  Reading across a discontinuity...\n");
+    failures += read_at(dev, samples, GAP_READ_TS, GAP_READ_LEN, true, quiet);
+    failures += read_at(dev, samples, GAP_READ_TS, 200, false, quiet);
+
+    /* The stream is now at or beyond the end of that interval. (Seeking to a
+     * timestamp assumes the stream is contiguous, so a discontinuity can
+     * carry it into the following buffer.) Buffers are recorded whole, so
+     * the history may extend somewhat beyond the stream's position, but it
+     * must reach back a full history length before it, and no further than
+     * its capacity. */
+    PRINT("  Checking the extent of the history...\n");
+    memset(&meta, 0, sizeof(meta));
+    meta.flags = BLADERF_META_FLAG_RX_NOW;
+    status     = bladerf_sync_rx(dev, samples, 1, &meta, TIMEOUT_MS);
+    if (status != 0 || meta.timestamp < GAP_READ_TS + GAP_READ_LEN ||
+        check_samples(samples, meta.timestamp, 1, quiet) != 0) {
+        PR_ERROR("Failed to read past the interval: %s, t=%llu\n",
+                 bladerf_strerror(status), (unsigned long long)meta.timestamp);
+        failures++;
+        goto out;
+    }
+
+    pos = meta.timestamp + 1;
+
+    failures += read_at(dev, samples, pos - HISTORY_LEN, HISTORY_LEN, true,
+                        quiet);
+    failures += expect_error(dev, samples, pos - CAPACITY - 1, 1,
+                             BLADERF_ERR_TIME_PAST, quiet);
+    failures += expect_error(dev, samples, FIRST_TS, 100,
+                             BLADERF_ERR_TIME_PAST, quiet);
+    failures += expect_error(dev, samples, pos - HISTORY_LEN - 1,
+                             HISTORY_LEN + 1, BLADERF_ERR_INVAL, quiet);
+
+    PRINT("  Reading beyond the end of the stream...\n");
+    failures += expect_error(dev, samples, msg_ts(NUM_MSGS) + 100, 10,
+                             BLADERF_ERR_TIMEOUT, quiet);
+
+out:
+    if (dev != NULL) {
+        bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), false);
+        bladerf_close(dev);
+    }
+
+    free(samples);
+    remove(path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(history);
@@ -0,0 +1,192 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Loop a "meta" recording, and check that each pass through it follows on
+ * from the previous one: every message's timestamp must be that of the
+ * message before it plus the samples it carried, per channel, while its
+ * samples are those of the corresponding message in the recording.
+ *
+ * The recording is not a whole number of stream buffers long, so that it
+ * wraps in the middle of a buffer. The stream is read with the asynchronous
+ * interface so that each message header is seen as the backend wrote it. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define NUM_MSGS            5
+#define NUM_LOOPS           4
+#define FIRST_TS            1000
+
+#define NUM_BUFFERS         16
+#define NUM_TRANSFERS       8
+#define MSGS_PER_BUFFER     4
+#define BUFFER_SAMPLES      (MSGS_PER_BUFFER * MSG_SIZE / 4)
+
+struct loop_state {
+    unsigned int channels;
+    void **buffers;
+    size_t idx;
+    size_t msgs;
+    uint64_t next_ts;
+    failure_count failures;
+};
+
+static void check_message(struct loop_state *s, const uint8_t *msg)
+{
+    const uint64_t ts_per_msg   = SAMPLES_PER_MSG / s->channels;
+    const uint64_t expected_ts  = FIRST_TS + s->msgs * ts_per_msg;
+    const uint64_t recording_ts = FIRST_TS + (s->msgs % NUM_MSGS) * ts_per_msg;
+    const uint64_t ts           = get_le64(&msg[4]);
+    size_t i;
+
+    if (ts != expected_ts) {
+        PR_ERROR("Message %zu (pass %zu): expected timestamp %llu, got "
+                 "%llu\n", s->msgs, s->msgs / NUM_MSGS + 1,
+                 (unsigned long long)expected_ts, (unsigned long long)ts);
+        s->failures++;
+    }
+
+    for (i = 0; i < SAMPLES_PER_MSG; i++) {
+        const uint8_t *w = &msg[MSG_HEADER_SIZE + 4 * i];
+        const unsigned int t = (unsigned int)(recording_ts + i / s->channels) &
+                               COUNTER_MASK;
+        const unsigned int c = (unsigned int)(i % s->channels);
+
+        if ((unsigned int)(w[0] | (w[1] << 8)) != t ||
+            (unsigned int)(w[2] | (w[3] << 8)) != c) {
+            PR_ERROR("Message %zu: sample %zu does not match the "
+                     "recording\n", s->msgs, i);
+            s->failures++;
+            break;
+        }
+    }
+
+    s->msgs++;
+}
+
+static void *stream_cb(struct bladerf *dev,
+                       struct bladerf_stream *stream,
+                       struct bladerf_metadata *meta,
+                       void *samples,
+                       size_t num_samples,
+                       void *user_data)
+{
+    struct loop_state *s = user_data;
+    const uint8_t *buf   = samples;
+    size_t off;
+
+    if (samples != NULL) {
+        for (off = 0; off < num_samples * 4 && s->msgs < NUM_LOOPS * NUM_MSGS;
+             off += MSG_SIZE) {
+            check_message(s, &buf[off]);
+        }
+    }
+
+    if (s->msgs >= NUM_LOOPS * NUM_MSGS) {
+        return BLADERF_STREAM_SHUTDOWN;
+    }
+
+    s->idx = (s->idx + 1) % NUM_BUFFERS;
+    return s->buffers[s->idx];
+}
+
+static failure_count run(struct app_params *p, unsigned int channels,
+                         bool quiet)
+{
+    struct bladerf *dev           = NULL;
+    struct bladerf_stream *stream = NULL;
+    struct loop_state s;
+    char path[1024];
+    int status;
+
+    memset(&s, 0, sizeof(s));
+    s.channels = channels;
+    s.idx      = NUM_TRANSFERS - 1;
+
+    PRINT("  %u channel(s)...\n", channels);
+
+    test_file(p, "loop.bin", path, sizeof(path));
+    if (write_counter_recording(path, channels, FIRST_TS, NUM_MSGS, 0, 0) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, "loop=1,rate=max");
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        s.failures++;
+        goto out;
+    }
+
+    status = bladerf_init_stream(&stream, dev, stream_cb, &s.buffers,
+                                 NUM_BUFFERS, BLADERF_FORMAT_SC16_Q11_META,
+                                 BUFFER_SAMPLES, NUM_TRANSFERS, &s);
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), true);
+    }
+
+    if (status == 0) {
+        status = bladerf_stream(stream, channels == 2 ? BLADERF_RX_X2
+                                                      : BLADERF_RX_X1);
+        bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), false);
+    }
+
+    if (status != 0) {
+        PR_ERROR("Stream failed: %s\n", bladerf_strerror(status));
+        s.failures++;
+    } else if (s.msgs != NUM_LOOPS * NUM_MSGS) {
+        PR_ERROR("Received %zu messages, expected %u\n", s.msgs,
+                 NUM_LOOPS * NUM_MSGS);
+        s.failures++;
+    }
+
+out:
+    if (stream != NULL) {
+        bladerf_deinit_stream(stream);
+    }
+
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return s.failures;
+}
+
+failure_count test_loop(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+
+    PRINT("%s: Checking timestamp continuity across recording loops...\n",
+          __FUNCTION__);
+
+    failures += run(p, 1, quiet);
+    failures += run(p, 2, quiet);
+
+    return failures;
+}
+
+DECLARE_TEST_CASE(loop);
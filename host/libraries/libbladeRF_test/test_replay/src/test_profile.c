@@ -0,0 +1,160 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Configuration profiles and raw register access: after a raw Si5338 write,
+ * which may change either sample clock, applying a profile writes its sample
+ * rates again, rather than taking them to be in effect already.
+ *
+ * The replay device keeps each channel's sample rate in the parameter
+ * registers of the emulated Si5338's multisynth of the same index. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+/* First parameter register of the multisynth holding a channel's rate */
+#define SI5338_MS_BASE(ch_) (53 + (ch_) * 11)
+
+#define RX_RATE 2000000
+#define TX_RATE 3000000
+
+static failure_count check_rates(struct bladerf *dev, const char *when)
+{
+    failure_count failures = 0;
+    bladerf_sample_rate rx_rate = 0, tx_rate = 0;
+    int status;
+
+    status = bladerf_get_sample_rate(dev, BLADERF_CHANNEL_RX(0), &rx_rate);
+    if (status == 0) {
+        status = bladerf_get_sample_rate(dev, BLADERF_CHANNEL_TX(0), &tx_rate);
+    }
+
+    if (status != 0) {
+        PR_ERROR("Failed to get sample rates %s: %s\n", when,
+                 bladerf_strerror(status));
+        failures++;
+    } else if (rx_rate != RX_RATE || tx_rate != TX_RATE) {
+        PR_ERROR("Sample rates %s: RX %u, TX %u\n", when,
+                 (unsigned int)rx_rate, (unsigned int)tx_rate);
+        failures++;
+    }
+
+    return failures;
+}
+
+/* Disturb a channel's sample clock with a raw register write, and check
+ * that applying the profile restores it */
+static failure_count check_raw_write(struct bladerf *dev,
+                                     const struct bladerf_profile *profile,
+                                     bladerf_channel ch, bool quiet)
+{
+    failure_count failures = 0;
+    bladerf_sample_rate rate = 0;
+    uint8_t val;
+    int status;
+
+    PRINT("%s: Writing channel %d's multisynth, then applying...\n",
+          __FUNCTION__, ch);
+
+    status = bladerf_si5338_read(dev, SI5338_MS_BASE(ch) + 2, &val);
+    if (status == 0) {
+        status = bladerf_si5338_write(dev, SI5338_MS_BASE(ch) + 2, val ^ 0x01);
+    }
+
+    if (status != 0) {
+        PR_ERROR("Raw Si5338 access failed: %s\n", bladerf_strerror(status));
+        return 1;
+    }
+
+    /* Otherwise, this test has not shown anything */
+    status = bladerf_get_sample_rate(dev, ch, &rate);
+    if (status != 0 || rate == (ch == BLADERF_CHANNEL_RX(0) ? RX_RATE
+                                                            : TX_RATE)) {
+        PR_ERROR("The raw write did not change the sample rate\n");
+        failures++;
+    }
+
+    status = bladerf_apply_profile(dev, profile);
+    if (status != 0) {
+        PR_ERROR("Failed to apply profile: %s\n", bladerf_strerror(status));
+        failures++;
+    }
+
+    failures += check_rates(dev, "after applying the profile");
+
+    return failures;
+}
+
+failure_count test_profile(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_profile profile;
+    struct bladerf *dev = NULL;
+    char path[1024];
+    int status;
+
+    /* The device is only opened to operate upon its settings */
+    test_file(p, "profile.bin", path, sizeof(path));
+    if (write_counter_recording(path, 1, 0, 4, 0, 0) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, NULL);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    memset(&profile, 0, sizeof(profile));
+    profile.rx[0].fields      = BLADERF_PROFILE_SAMPLE_RATE;
+    profile.rx[0].sample_rate = RX_RATE;
+    profile.tx[0].fields      = BLADERF_PROFILE_SAMPLE_RATE;
+    profile.tx[0].sample_rate = TX_RATE;
+
+    status = bladerf_apply_profile(dev, &profile);
+    if (status != 0) {
+        PR_ERROR("Failed to apply profile: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    failures += check_rates(dev, "after applying the profile");
+
+    /* Either sample clock may be the one that a raw write changed */
+    failures += check_raw_write(dev, &profile, BLADERF_CHANNEL_RX(0), quiet);
+    failures += check_raw_write(dev, &profile, BLADERF_CHANNEL_TX(0), quiet);
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(profile);
@@ -0,0 +1,125 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef TEST_REPLAY_H_
+#define TEST_REPLAY_H_
+
+#include "host_config.h"
+#include <libbladeRF.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef size_t failure_count;
+
+#define DECLARE_TEST(name_)                                          \
+    extern failure_count test_##name_(struct app_params *p,          \
+                                      bool quiet);                   \
+    extern const struct test_case test_case_##name_;
+
+#define DECLARE_TEST_CASE(name_) \
+    const struct test_case test_case_##name_ = { #name_, &test_##name_ }
+
+#define PRINT(...)               \
+    do {                         \
+        if (!quiet) {            \
+            printf(__VA_ARGS__); \
+            fflush(stdout);      \
+        }                        \
+    } while (0)
+
+#define PR_ERROR(...) fprintf(stderr, "\n(!) " __VA_ARGS__)
+
+struct app_params {
+    char *test_name;
+    char *dir;
+};
+
+struct test_case {
+    const char *name;
+    failure_count (*fn)(struct app_params *p, bool quiet);
+};
+
+/* Recordings are written in the "meta" format, with the message size that
+ * the replay backend uses for USB 3.0 devices */
+#define MSG_SIZE            2048
+#define MSG_HEADER_SIZE     16
+#define SAMPLES_PER_MSG     ((MSG_SIZE - MSG_HEADER_SIZE) / 4)
+
+/* Sample (I, Q) of channel c at timestamp t is (t & COUNTER_MASK, c) */
+#define COUNTER_MASK        0x7ff
+
+/**
+ * Build the path of a temporary file used by a test
+ *
+ * @param       p       Application parameters
+ * @param       name    File name
+ * @param[out]  path    Resulting path
+ * @param       len     Size of `path`
+ */
+void test_file(const struct app_params *p, const char *name,
+               char *path, size_t len);
+
+/**
+ * Write a "meta" recording of the counter pattern
+ *
+ * @param   path        Recording to create
+ * @param   channels    Number of interleaved channels (1 or 2)
+ * @param   ts          Timestamp of the first message
+ * @param   num_msgs    Number of messages
+ * @param   gap_msg     Index of the message preceded by a discontinuity
+ * @param   gap         Number of timestamps skipped there. 0 for none.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int write_counter_recording(const char *path, unsigned int channels,
+                            uint64_t ts, size_t num_msgs,
+                            size_t gap_msg, uint64_t gap);
+
+/**
+ * Open a replay device
+ *
+ * @param[out]  dev     Device handle
+ * @param       path    Recording to replay
+ * @param       options Additional comma-separated replay options, or NULL
+ *
+ * @return 0 on success, BLADERF_ERR_* value on failure
+ */
+int open_replay(struct bladerf **dev, const char *path, const char *options);
+
+/** Read a little-endian 64-bit value */
+uint64_t get_le64(const uint8_t *buf);
+
+DECLARE_TEST(loop);
+DECLARE_TEST(tx_mixer);
+DECLARE_TEST(history);
+DECLARE_TEST(slots);
+DECLARE_TEST(dsp);
+DECLARE_TEST(async_ctrl);
+DECLARE_TEST(profile);
+DECLARE_TEST(telemetry);
+DECLARE_TEST(faults);
+
+#endif
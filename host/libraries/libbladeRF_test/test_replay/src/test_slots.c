@@ -0,0 +1,410 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Run bladerf_run_slots() against a paced replay device:
+ *
+ *  - Invalid plans are rejected without running, or touching, any slot.
+ *  - In a plan interleaving TX bursts and RX windows, each RX window receives
+ *    the recording's samples at its timestamp, and each TX burst appears in
+ *    the capture at its timestamp, with nothing transmitted in between.
+ *  - An RX window beyond the end of the recording fails on its own. The
+ *    other slots still succeed, and its status is returned. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define SAMPLE_RATE     1000000
+#define FIRST_TS        1000
+#define NUM_MSGS        40
+#define BUFFER_SIZE     2048
+#define TIMEOUT_MS      1000
+#define WAIT_MS         2000
+
+/* TX slots are relative to the TX time when the plan starts */
+#define TX_OFFSET       5000
+
+struct slot_desc {
+    bladerf_direction dir;
+    bladerf_timestamp timestamp;
+    unsigned int len;
+    int expected_status;
+};
+
+static const struct slot_desc plan[] = {
+    { BLADERF_TX, 0,                             1000, 0 },
+    { BLADERF_RX, FIRST_TS + 2000,               1000, 0 },
+    { BLADERF_RX, FIRST_TS + 9000,               2000, 0 },
+    { BLADERF_TX, 7000,                          500,  0 },
+    { BLADERF_RX, FIRST_TS + NUM_MSGS * SAMPLES_PER_MSG + 100, 10,
+      BLADERF_ERR_TIMEOUT },
+};
+
+#define NUM_SLOTS       ARRAY_SIZE(plan)
+#define TIMELINE_LEN    (7000 + 500 + BUFFER_SIZE * 4)
+
+static int16_t tx_i(size_t slot, unsigned int k)
+{
+    return (int16_t)(((slot + 1) * 100 + k) & COUNTER_MASK);
+}
+
+static int16_t tx_q(size_t slot)
+{
+    return (int16_t)(-(int)slot - 1);
+}
+
+/* Wait for the device to have transmitted everything up to `t` */
+static bool wait_until(struct bladerf *dev, bladerf_timestamp t)
+{
+    bladerf_timestamp now;
+    unsigned int ms;
+
+    for (ms = 0; ms < WAIT_MS; ms += 10) {
+        if (bladerf_get_timestamp(dev, BLADERF_TX, &now) == 0 && now >= t) {
+            return true;
+        }
+        usleep(10000);
+    }
+
+    return false;
+}
+
+static failure_count expect_invalid(struct bladerf *dev,
+                                    struct bladerf_slot *slots,
+                                    unsigned int num_slots,
+                                    const char *what, bool quiet)
+{
+    unsigned int i;
+    int status;
+
+    for (i = 0; i < num_slots; i++) {
+        slots[i].status = 1;
+    }
+
+    status = bladerf_run_slots(dev, slots, num_slots, TIMEOUT_MS);
+    if (status != BLADERF_ERR_INVAL) {
+        PR_ERROR("%s: expected \"%s\", got \"%s\"\n", what,
+                 bladerf_strerror(BLADERF_ERR_INVAL),
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    for (i = 0; i < num_slots; i++) {
+        if (slots[i].status != 1) {
+            PR_ERROR("%s: slot %u was modified\n", what, i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static failure_count check_validation(struct bladerf *dev, int16_t *buf,
+                                      bool quiet)
+{
+    struct bladerf_slot slots[2];
+    failure_count failures = 0;
+    int status;
+
+    memset(slots, 0, sizeof(slots));
+    slots[0].dir         = BLADERF_RX;
+    slots[0].timestamp   = 2000;
+    slots[0].num_samples = 100;
+    slots[0].samples     = buf;
+    slots[1]             = slots[0];
+
+    status = bladerf_run_slots(dev, NULL, 1, TIMEOUT_MS);
+    if (status != BLADERF_ERR_INVAL) {
+        PR_ERROR("NULL plan: got \"%s\"\n", bladerf_strerror(status));
+        failures++;
+    }
+
+    slots[1].timestamp = 2099;
+    failures += expect_invalid(dev, slots, 2, "Overlapping RX slots", quiet);
+
+    slots[1].timestamp = 1000;
+    failures += expect_invalid(dev, slots, 2, "Out of order RX slots", quiet);
+
+    slots[0].dir       = BLADERF_TX;
+    slots[1].dir       = BLADERF_TX;
+    slots[1].timestamp = 2050;
+    failures += expect_invalid(dev, slots, 2, "Overlapping TX slots", quiet);
+
+    slots[1].timestamp = 2100;
+    slots[1].samples   = NULL;
+    failures += expect_invalid(dev, slots, 2, "Slot without samples", quiet);
+
+    slots[1].samples     = buf;
+    slots[1].num_samples = 0;
+    failures += expect_invalid(dev, slots, 2, "Empty slot", quiet);
+
+    slots[1].num_samples = 100;
+    slots[1].dir         = (bladerf_direction)7;
+    failures += expect_invalid(dev, slots, 2, "Invalid direction", quiet);
+
+    return failures;
+}
+
+/* Check the capture against the TX slots, relative to t0 */
+static failure_count check_capture(const char *path, bladerf_timestamp t0,
+                                   bool quiet)
+{
+    uint8_t msg[MSG_SIZE];
+    failure_count failures = 0;
+    size_t bursts_seen[NUM_SLOTS];
+    size_t msgs = 0;
+    FILE *f;
+    size_t i, s;
+
+    memset(bursts_seen, 0, sizeof(bursts_seen));
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        PR_ERROR("Failed to open %s\n", path);
+        return 1;
+    }
+
+    while (failures == 0 && fread(msg, sizeof(msg), 1, f) == 1) {
+        const bladerf_timestamp ts = get_le64(&msg[4]);
+
+        for (i = 0; i < SAMPLES_PER_MSG; i++) {
+            const uint8_t *w = &msg[MSG_HEADER_SIZE + 4 * i];
+            const int16_t si = (int16_t)(w[0] | (w[1] << 8));
+            const int16_t sq = (int16_t)(w[2] | (w[3] << 8));
+            const bladerf_timestamp t = ts + i;
+            int16_t ei = 0, eq = 0;
+
+            for (s = 0; s < NUM_SLOTS; s++) {
+                const bladerf_timestamp start = t0 + plan[s].timestamp;
+
+                if (plan[s].dir == BLADERF_TX && t >= start &&
+                    t < start + plan[s].len) {
+                    ei = tx_i(s, (unsigned int)(t - start));
+                    eq = tx_q(s);
+                    bursts_seen[s]++;
+                }
+            }
+
+            if (si != ei || sq != eq) {
+                PR_ERROR("Transmitted sample at t0+%lld: expected (%d, %d), "
+                         "got (%d, %d)\n", (long long)(t - t0), ei, eq, si,
+                         sq);
+                failures++;
+                break;
+            }
+        }
+
+        msgs++;
+    }
+
+    fclose(f);
+
+    for (s = 0; s < NUM_SLOTS && failures == 0; s++) {
+        if (plan[s].dir == BLADERF_TX && bursts_seen[s] != plan[s].len) {
+            PR_ERROR("TX slot %zu: %zu of %u samples transmitted\n", s,
+                     bursts_seen[s], plan[s].len);
+            failures++;
+        }
+    }
+
+    if (msgs == 0) {
+        PR_ERROR("Nothing was transmitted\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+failure_count test_slots(struct app_params *p, bool quiet)
+{
+    struct bladerf *dev    = NULL;
+    int16_t *bufs[NUM_SLOTS];
+    struct bladerf_slot slots[NUM_SLOTS];
+    failure_count failures = 0;
+    bladerf_timestamp t0;
+    char rx_path[1024], tx_path[1024], options[1200];
+    int expected_return = 0;
+    size_t s;
+    unsigned int k;
+    int status;
+
+    PRINT("%s: Checking half-duplex slot scheduling...\n", __FUNCTION__);
+
+    memset(bufs, 0, sizeof(bufs));
+    for (s = 0; s < NUM_SLOTS; s++) {
+        bufs[s] = calloc(2 * plan[s].len, sizeof(int16_t));
+        if (bufs[s] == NULL) {
+            PR_ERROR("Failed to allocate samples\n");
+            failures++;
+            goto out;
+        }
+    }
+
+    test_file(p, "slots_rx.bin", rx_path, sizeof(rx_path));
+    test_file(p, "slots_tx.bin", tx_path, sizeof(tx_path));
+    snprintf(options, sizeof(options), "rate=realtime,tx_file=%s", tx_path);
+
+    if (write_counter_recording(rx_path, 1, FIRST_TS, NUM_MSGS, 0, 0) != 0) {
+        failures++;
+        goto out;
+    }
+
+    status = open_replay(&dev, rx_path, options);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    PRINT("  Checking plan validation...\n");
+    failures += check_validation(dev, bufs[0], quiet);
+
+    status = bladerf_set_sample_rate(dev, BLADERF_CHANNEL_RX(0), SAMPLE_RATE,
+                                     NULL);
+    if (status == 0) {
+        status = bladerf_set_sample_rate(dev, BLADERF_CHANNEL_TX(0),
+                                         SAMPLE_RATE, NULL);
+    }
+    if (status == 0) {
+        status = bladerf_sync_config(dev, BLADERF_RX_X1,
+                                     BLADERF_FORMAT_SC16_Q11_META, 32,
+                                     BUFFER_SIZE, 8, TIMEOUT_MS);
+    }
+    if (status == 0) {
+        status = bladerf_sync_config(dev, BLADERF_TX_X1,
+                                     BLADERF_FORMAT_SC16_Q11_META, 16,
+                                     BUFFER_SIZE, 8, TIMEOUT_MS);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_TX(0), true);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), true);
+    }
+    if (status == 0) {
+        status = bladerf_get_timestamp(dev, BLADERF_TX, &t0);
+    }
+    if (status != 0) {
+        PR_ERROR("Failed to configure streams: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    t0 += TX_OFFSET;
+
+    memset(slots, 0, sizeof(slots));
+    for (s = 0; s < NUM_SLOTS; s++) {
+        slots[s].dir         = plan[s].dir;
+        slots[s].timestamp   = plan[s].timestamp;
+        slots[s].num_samples = plan[s].len;
+        slots[s].samples     = bufs[s];
+
+        if (plan[s].dir == BLADERF_TX) {
+            slots[s].timestamp += t0;
+
+            for (k = 0; k < plan[s].len; k++) {
+                bufs[s][2 * k]     = tx_i(s, k);
+                bufs[s][2 * k + 1] = tx_q(s);
+            }
+        }
+
+        if (expected_return == 0) {
+            expected_return = plan[s].expected_status;
+        }
+    }
+
+    PRINT("  Running a plan...\n");
+    status = bladerf_run_slots(dev, slots, NUM_SLOTS, TIMEOUT_MS);
+    if (status != expected_return) {
+        PR_ERROR("Plan returned \"%s\", expected \"%s\"\n",
+                 bladerf_strerror(status), bladerf_strerror(expected_return));
+        failures++;
+    }
+
+    for (s = 0; s < NUM_SLOTS; s++) {
+        if (slots[s].status != plan[s].expected_status) {
+            PR_ERROR("Slot %zu: status \"%s\", expected \"%s\"\n", s,
+                     bladerf_strerror(slots[s].status),
+                     bladerf_strerror(plan[s].expected_status));
+            failures++;
+            continue;
+        }
+
+        if (plan[s].expected_status != 0) {
+            continue;
+        }
+
+        if (slots[s].meta_status != 0) {
+            PR_ERROR("Slot %zu: meta status 0x%08x\n", s,
+                     slots[s].meta_status);
+            failures++;
+        }
+
+        if (plan[s].dir == BLADERF_RX) {
+            for (k = 0; k < plan[s].len; k++) {
+                const uint64_t t  = plan[s].timestamp + k;
+                const int16_t exp = (int16_t)(t & COUNTER_MASK);
+
+                if (bufs[s][2 * k] != exp || bufs[s][2 * k + 1] != 0) {
+                    PR_ERROR("RX slot %zu, t=%llu: expected (%d, 0), got "
+                             "(%d, %d)\n", s, (unsigned long long)t, exp,
+                             bufs[s][2 * k], bufs[s][2 * k + 1]);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!wait_until(dev, t0 + TIMELINE_LEN)) {
+        PR_ERROR("Timed out waiting for the device to transmit\n");
+        failures++;
+    }
+
+    bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), false);
+    bladerf_enable_module(dev, BLADERF_CHANNEL_TX(0), false);
+    bladerf_close(dev);
+    dev = NULL;
+
+    PRINT("  Checking transmitted bursts...\n");
+    failures += check_capture(tx_path, t0, quiet);
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    for (s = 0; s < NUM_SLOTS; s++) {
+        free(bufs[s]);
+    }
+
+    remove(rx_path);
+    remove(tx_path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(slots);
@@ -0,0 +1,332 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Background telemetry:
+ *  - Once enabled, snapshots are taken periodically, with an increasing
+ *    `sequence`, and hold the items the device supports (only the VCTCXO
+ *    trim DAC, for the replay device).
+ *  - The history is returned oldest first, and only holds the most recent
+ *    `history_len` snapshots once it has wrapped.
+ *  - While another thread keeps the device busy with control calls, the
+ *    telemetry thread backs off, counting the reads it deferred, and samples
+ *    again once the device is idle.
+ *  - Telemetry is stopped cleanly by bladerf_close(). */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "test_replay.h"
+
+#define INTERVAL_MS     5
+#define HISTORY_LEN     4
+
+/* How long to wait for the telemetry thread to make progress */
+#define WAIT_MS         2000
+
+#define TRIM_VALUE      0x1234
+
+/* Wait for a snapshot with a sequence number of at least `sequence` */
+static int wait_for_snapshot(struct bladerf *dev, uint64_t sequence,
+                             struct bladerf_telemetry *snapshot)
+{
+    unsigned int i;
+    int status;
+
+    for (i = 0; i < WAIT_MS; i++) {
+        status = bladerf_get_telemetry(dev, snapshot);
+        if (status != 0 || snapshot->sequence >= sequence) {
+            return status;
+        }
+
+        usleep(1000);
+    }
+
+    return BLADERF_ERR_TIMEOUT;
+}
+
+static failure_count check_snapshots(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_telemetry prev, snapshot;
+    int status;
+
+    PRINT("%s: Waiting for snapshots...\n", __FUNCTION__);
+
+    status = bladerf_trim_dac_write(dev, TRIM_VALUE);
+    if (status != 0) {
+        PR_ERROR("Failed to write trim DAC: %s\n", bladerf_strerror(status));
+        return 1;
+    }
+
+    status = wait_for_snapshot(dev, 2, &prev);
+    if (status != 0) {
+        PR_ERROR("Failed to get two snapshots: %s\n",
+                 bladerf_strerror(status));
+        return 1;
+    }
+
+    /* Only the trim DAC can be read from a replay device */
+    if (prev.valid != BLADERF_TELEMETRY_VCTCXO_TRIM ||
+        prev.vctcxo_trim != TRIM_VALUE) {
+        PR_ERROR("Snapshot %llu: valid items 0x%02x, trim 0x%04x\n",
+                 (unsigned long long)prev.sequence, prev.valid,
+                 prev.vctcxo_trim);
+        failures++;
+    }
+
+    /* Watch a few more snapshots go by */
+    while (failures == 0 && prev.sequence < 10) {
+        status = bladerf_get_telemetry(dev, &snapshot);
+        if (status != 0) {
+            PR_ERROR("Failed to get snapshot: %s\n", bladerf_strerror(status));
+            failures++;
+        } else if (snapshot.sequence < prev.sequence ||
+                   snapshot.time_ns < prev.time_ns) {
+            PR_ERROR("Snapshot %llu at %llu ns followed %llu at %llu ns\n",
+                     (unsigned long long)snapshot.sequence,
+                     (unsigned long long)snapshot.time_ns,
+                     (unsigned long long)prev.sequence,
+                     (unsigned long long)prev.time_ns);
+            failures++;
+        } else {
+            prev = snapshot;
+        }
+    }
+
+    return failures;
+}
+
+static failure_count check_history(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_telemetry history[2 * HISTORY_LEN], latest;
+    unsigned int actual = 0, i;
+    int status;
+
+    PRINT("%s: Checking the history after it has wrapped...\n",
+          __FUNCTION__);
+
+    status = wait_for_snapshot(dev, 2 * HISTORY_LEN + 1, &latest);
+    if (status == 0) {
+        status = bladerf_get_telemetry_history(dev, history,
+                                               2 * HISTORY_LEN, &actual);
+    }
+
+    if (status != 0) {
+        PR_ERROR("Failed to get history: %s\n", bladerf_strerror(status));
+        return 1;
+    }
+
+    if (actual != HISTORY_LEN) {
+        PR_ERROR("Got %u snapshots from a history of %u\n", actual,
+                 HISTORY_LEN);
+        return 1;
+    }
+
+    if (history[actual - 1].sequence < latest.sequence) {
+        PR_ERROR("History ends at snapshot %llu, before snapshot %llu\n",
+                 (unsigned long long)history[actual - 1].sequence,
+                 (unsigned long long)latest.sequence);
+        failures++;
+    }
+
+    for (i = 1; i < actual; i++) {
+        if (history[i].sequence != history[i - 1].sequence + 1) {
+            PR_ERROR("History entry %u is snapshot %llu, following %llu\n",
+                     i, (unsigned long long)history[i].sequence,
+                     (unsigned long long)history[i - 1].sequence);
+            failures++;
+        }
+    }
+
+    /* Fewer than are available */
+    status = bladerf_get_telemetry_history(dev, history, 1, &actual);
+    if (status != 0 || actual != 1 ||
+        history[0].sequence < latest.sequence) {
+        PR_ERROR("Failed to get the most recent snapshot from the "
+                 "history\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+struct busy {
+    struct bladerf *dev;
+    pthread_mutex_t lock;
+    bool stop;
+    int status;
+};
+
+/* Keep the device busy with control calls until asked to stop */
+static void *busy_thread(void *arg)
+{
+    struct busy *b = arg;
+    bool stop      = false;
+    int gain;
+
+    while (!stop && b->status == 0) {
+        b->status = bladerf_get_gain(b->dev, BLADERF_CHANNEL_RX(0), &gain);
+
+        pthread_mutex_lock(&b->lock);
+        stop = b->stop;
+        pthread_mutex_unlock(&b->lock);
+    }
+
+    return NULL;
+}
+
+static failure_count check_deferred(struct bladerf *dev, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_telemetry before, snapshot;
+    struct busy b;
+    pthread_t thread;
+    unsigned int i;
+    int status;
+
+    PRINT("%s: Keeping the device busy...\n", __FUNCTION__);
+
+    status = bladerf_get_telemetry(dev, &before);
+    if (status != 0) {
+        PR_ERROR("Failed to get snapshot: %s\n", bladerf_strerror(status));
+        return 1;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.dev = dev;
+    pthread_mutex_init(&b.lock, NULL);
+
+    if (pthread_create(&thread, NULL, busy_thread, &b) != 0) {
+        PR_ERROR("Failed to create thread\n");
+        pthread_mutex_destroy(&b.lock);
+        return 1;
+    }
+
+    /* The telemetry thread must find the device busy at some point */
+    snapshot = before;
+    for (i = 0; i < WAIT_MS && snapshot.deferred == before.deferred; i++) {
+        usleep(1000);
+
+        status = bladerf_get_telemetry(dev, &snapshot);
+        if (status != 0) {
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&b.lock);
+    b.stop = true;
+    pthread_mutex_unlock(&b.lock);
+
+    pthread_join(thread, NULL);
+    pthread_mutex_destroy(&b.lock);
+
+    if (b.status != 0) {
+        PR_ERROR("Control call failed: %s\n", bladerf_strerror(b.status));
+        failures++;
+    }
+
+    if (status != 0 || snapshot.deferred == before.deferred) {
+        PR_ERROR("No reads were deferred in %u ms of control calls\n",
+                 WAIT_MS);
+        failures++;
+    }
+
+    PRINT("  %llu reads deferred\n",
+          (unsigned long long)(snapshot.deferred - before.deferred));
+
+    /* Once idle, the device is sampled again */
+    for (i = 0; i < WAIT_MS; i++) {
+        status = wait_for_snapshot(dev, snapshot.sequence + 1, &snapshot);
+        if (status != 0 ||
+            (snapshot.updated & BLADERF_TELEMETRY_VCTCXO_TRIM)) {
+            break;
+        }
+    }
+
+    if (status != 0 || !(snapshot.updated & BLADERF_TELEMETRY_VCTCXO_TRIM)) {
+        PR_ERROR("The trim DAC was not sampled once the device was idle\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+failure_count test_telemetry(struct app_params *p, bool quiet)
+{
+    failure_count failures = 0;
+    struct bladerf_telemetry_config config;
+    struct bladerf_telemetry snapshot;
+    struct bladerf *dev = NULL;
+    char path[1024];
+    int status;
+
+    /* The device is only opened to sample its telemetry */
+    test_file(p, "telemetry.bin", path, sizeof(path));
+    if (write_counter_recording(path, 1, 0, 4, 0, 0) != 0) {
+        return 1;
+    }
+
+    status = open_replay(&dev, path, NULL);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    if (bladerf_get_telemetry(dev, &snapshot) != BLADERF_ERR_INVAL) {
+        PR_ERROR("Got a snapshot before telemetry was enabled\n");
+        failures++;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.interval_ms = INTERVAL_MS;
+    config.history_len = HISTORY_LEN;
+
+    status = bladerf_enable_telemetry(dev, &config);
+    if (status != 0) {
+        PR_ERROR("Failed to enable telemetry: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    failures += check_snapshots(dev, quiet);
+    failures += check_history(dev, quiet);
+    failures += check_deferred(dev, quiet);
+
+    /* Telemetry is left enabled for bladerf_close() to stop */
+
+out:
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    remove(path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(telemetry);
@@ -0,0 +1,424 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Run the TX mixer against a paced replay device, capturing what it
+ * transmits, and check the capture against a model of the mixer:
+ *
+ *  - Three overlapping bursts from two producers form one device burst. Their
+ *    sum is saturated where it exceeds the SC16 Q11 range.
+ *  - A fourth burst, further out, forms a second device burst.
+ *  - A burst submitted inside the lead time is dropped as late by the mixer,
+ *    and one submitted behind samples already committed is rejected with
+ *    BLADERF_ERR_TIME_PAST.
+ *
+ * Producer and mixer statistics must account for all of the above. */
+
+#include <string.h>
+
+#include "test_replay.h"
+
+#define SAMPLE_RATE     1000000
+#define LEAD_TIME_US    20000
+#define LEAD_SAMPLES    (LEAD_TIME_US * (SAMPLE_RATE / 1000000))
+#define CHUNK_SIZE      1024
+#define BURST_GAP       4096
+#define BUFFER_SIZE     2048
+
+/* Offset of the first burst from the current time. This is beyond the lead
+ * time, so that all of the overlapping bursts are queued before the mixer
+ * starts on them. */
+#define START_OFFSET    (2 * LEAD_SAMPLES)
+
+#define WAIT_MS         2000
+
+struct burst {
+    unsigned int producer;
+    bladerf_timestamp offset;   /* From the first burst */
+    unsigned int len;
+    int16_t i;                  /* I increases from here by 1 per sample */
+    int16_t q;                  /* Constant */
+};
+
+static const struct burst bursts[] = {
+    { 0, 0,     3000,  1,    100  },
+    { 1, 1000,  3000,  1000, -200 },
+    { 0, 2000,  500,   1500, -2000 },
+    { 1, 14000, 1000,  -700, 50   },
+};
+
+#define SECOND_BURST    3
+#define FIRST_END       4000    /* Content end of the first device burst */
+#define TIMELINE_LEN    (bursts[SECOND_BURST].offset + BUFFER_SIZE * 4)
+#define LATE_LEN        100
+
+static int16_t sat(int32_t x, bool *clipped)
+{
+    if (x > 2047) {
+        *clipped = true;
+        return 2047;
+    } else if (x < -2048) {
+        *clipped = true;
+        return -2048;
+    }
+
+    return (int16_t)x;
+}
+
+static int submit(struct bladerf_tx_producer *p, const struct burst *b,
+                  bladerf_timestamp t0)
+{
+    int16_t *samples;
+    unsigned int k;
+    int status;
+
+    samples = malloc(2 * b->len * sizeof(samples[0]));
+    if (samples == NULL) {
+        return BLADERF_ERR_MEM;
+    }
+
+    for (k = 0; k < b->len; k++) {
+        samples[2 * k]     = (int16_t)(b->i + k);
+        samples[2 * k + 1] = b->q;
+    }
+
+    status = bladerf_tx_producer_submit(p, samples, b->len, t0 + b->offset);
+    free(samples);
+    return status;
+}
+
+/* Wait for the mixer to finish with a producer's bursts */
+static bool wait_for(struct bladerf_tx_producer *p, uint64_t retired)
+{
+    struct bladerf_tx_producer_stats stats;
+    unsigned int ms;
+
+    for (ms = 0; ms < WAIT_MS; ms += 10) {
+        bladerf_tx_producer_get_stats(p, &stats);
+        if (stats.bursts_sent + stats.bursts_late >= retired) {
+            return true;
+        }
+        usleep(10000);
+    }
+
+    return false;
+}
+
+/* Wait for the device to have transmitted everything up to `t` */
+static bool wait_until(struct bladerf *dev, bladerf_timestamp t)
+{
+    bladerf_timestamp now;
+    unsigned int ms;
+
+    for (ms = 0; ms < WAIT_MS; ms += 10) {
+        if (bladerf_get_timestamp(dev, BLADERF_TX, &now) == 0 && now >= t) {
+            return true;
+        }
+        usleep(10000);
+    }
+
+    return false;
+}
+
+/* Rebuild the transmitted timeline, starting at t0, from the capture */
+static failure_count read_capture(const char *path, bladerf_timestamp t0,
+                                  int16_t *timeline, size_t len, bool quiet)
+{
+    uint8_t msg[MSG_SIZE];
+    failure_count failures = 0;
+    size_t msgs            = 0;
+    FILE *f;
+    size_t i;
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        PR_ERROR("Failed to open %s\n", path);
+        return 1;
+    }
+
+    while (fread(msg, sizeof(msg), 1, f) == 1) {
+        const bladerf_timestamp ts = get_le64(&msg[4]);
+
+        for (i = 0; i < SAMPLES_PER_MSG; i++) {
+            const uint8_t *w = &msg[MSG_HEADER_SIZE + 4 * i];
+
+            if (ts + i >= t0 && ts + i < t0 + len) {
+                timeline[2 * (ts + i - t0)]     = (int16_t)(w[0] | (w[1] << 8));
+                timeline[2 * (ts + i - t0) + 1] = (int16_t)(w[2] | (w[3] << 8));
+            } else if (w[0] | w[1] | w[2] | w[3]) {
+                PR_ERROR("Nonzero sample transmitted at %llu\n",
+                         (unsigned long long)(ts + i));
+                failures++;
+                break;
+            }
+        }
+
+        msgs++;
+    }
+
+    fclose(f);
+
+    if (msgs == 0) {
+        PR_ERROR("Nothing was transmitted\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+failure_count test_tx_mixer(struct app_params *p, bool quiet)
+{
+    struct bladerf *dev               = NULL;
+    struct bladerf_tx_mixer *mixer    = NULL;
+    struct bladerf_tx_producer *prod[2];
+    struct bladerf_tx_mixer_config config;
+    struct bladerf_tx_mixer_stats mstats;
+    struct bladerf_tx_producer_stats pstats[2];
+    uint64_t expected_sent[2] = { 0, 0 };
+    uint64_t expected_clipped = 0;
+    int16_t *model            = NULL;
+    int16_t *timeline         = NULL;
+    failure_count failures    = 0;
+    bladerf_timestamp now, t0;
+    char rx_path[1024], tx_path[1024], options[1200];
+    size_t i, k;
+    int status;
+
+    PRINT("%s: Checking the TX mixer against a replay device...\n",
+          __FUNCTION__);
+
+    test_file(p, "mixer_rx.bin", rx_path, sizeof(rx_path));
+    test_file(p, "mixer_tx.bin", tx_path, sizeof(tx_path));
+    snprintf(options, sizeof(options), "rate=realtime,tx_file=%s", tx_path);
+
+    model    = calloc(2 * TIMELINE_LEN, sizeof(model[0]));
+    timeline = calloc(2 * TIMELINE_LEN, sizeof(timeline[0]));
+    if (model == NULL || timeline == NULL) {
+        PR_ERROR("Failed to allocate timelines\n");
+        failures++;
+        goto out;
+    }
+
+    /* The replay device requires an RX recording, though it isn't used */
+    if (write_counter_recording(rx_path, 1, 0, 1, 0, 0) != 0) {
+        failures++;
+        goto out;
+    }
+
+    status = open_replay(&dev, rx_path, options);
+    if (status != 0) {
+        PR_ERROR("Failed to open replay device: %s\n",
+                 bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    status = bladerf_set_sample_rate(dev, BLADERF_CHANNEL_TX(0), SAMPLE_RATE,
+                                     NULL);
+    if (status == 0) {
+        status = bladerf_sync_config(dev, BLADERF_TX_X1,
+                                     BLADERF_FORMAT_SC16_Q11_META, 16,
+                                     BUFFER_SIZE, 8, 1000);
+    }
+    if (status == 0) {
+        status = bladerf_enable_module(dev, BLADERF_CHANNEL_TX(0), true);
+    }
+    if (status != 0) {
+        PR_ERROR("Failed to configure TX: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.channel      = BLADERF_CHANNEL_TX(0);
+    config.chunk_size   = CHUNK_SIZE;
+    config.burst_gap    = BURST_GAP;
+    config.lead_time_us = LEAD_TIME_US;
+
+    status = bladerf_tx_mixer_create(dev, &mixer, &config);
+    if (status == 0) {
+        status = bladerf_tx_producer_add(mixer, &prod[0]);
+    }
+    if (status == 0) {
+        status = bladerf_tx_producer_add(mixer, &prod[1]);
+    }
+    if (status == 0) {
+        status = bladerf_get_timestamp(dev, BLADERF_TX, &now);
+    }
+    if (status != 0) {
+        PR_ERROR("Failed to set up the mixer: %s\n", bladerf_strerror(status));
+        failures++;
+        goto out;
+    }
+
+    t0 = now + START_OFFSET;
+
+    /* Late: the mixer cannot start this with enough lead time */
+    {
+        const struct burst late = { 1, 0, LATE_LEN, 0, 0 };
+
+        status = submit(prod[1], &late, now);
+        if (status != 0) {
+            PR_ERROR("Late burst was rejected on submission: %s\n",
+                     bladerf_strerror(status));
+            failures++;
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(bursts); i++) {
+        const struct burst *b = &bursts[i];
+
+        status = submit(prod[b->producer], b, t0);
+        if (status != 0) {
+            PR_ERROR("Burst %zu was rejected: %s\n", i,
+                     bladerf_strerror(status));
+            failures++;
+        }
+
+        expected_sent[b->producer]++;
+    }
+
+    if (!wait_for(prod[0], 2) || !wait_for(prod[1], 3)) {
+        PR_ERROR("Timed out waiting for the mixer\n");
+        failures++;
+    }
+
+    /* The first device burst has been committed, so this is in the past */
+    status = submit(prod[0], &bursts[0], t0);
+    if (status != BLADERF_ERR_TIME_PAST) {
+        PR_ERROR("Expected BLADERF_ERR_TIME_PAST for a committed timestamp, "
+                 "got: %s\n", bladerf_strerror(status));
+        failures++;
+    }
+
+    if (!wait_until(dev, t0 + TIMELINE_LEN)) {
+        PR_ERROR("Timed out waiting for the device to transmit\n");
+        failures++;
+    }
+
+    bladerf_tx_mixer_get_stats(mixer, &mstats);
+    bladerf_tx_producer_get_stats(prod[0], &pstats[0]);
+    bladerf_tx_producer_get_stats(prod[1], &pstats[1]);
+
+    bladerf_tx_mixer_destroy(mixer);
+    mixer = NULL;
+
+    bladerf_enable_module(dev, BLADERF_CHANNEL_TX(0), false);
+    bladerf_close(dev);
+    dev = NULL;
+
+    /* Statistics */
+    for (i = 0; i < 2; i++) {
+        /* Producer 0's late burst is the one rejected on submission */
+        const uint64_t late_samples = (i == 0) ? bursts[0].len : LATE_LEN;
+        const bladerf_timestamp late_ts = (i == 0) ? t0 : now;
+
+        if (pstats[i].bursts_submitted != expected_sent[i] + 1 ||
+            pstats[i].bursts_sent != expected_sent[i] ||
+            pstats[i].bursts_late != 1 ||
+            pstats[i].samples_late != late_samples ||
+            pstats[i].last_late_timestamp != late_ts) {
+            PR_ERROR("Producer %zu stats: submitted=%llu sent=%llu "
+                     "late=%llu samples_late=%llu last_late=%llu\n", i,
+                     (unsigned long long)pstats[i].bursts_submitted,
+                     (unsigned long long)pstats[i].bursts_sent,
+                     (unsigned long long)pstats[i].bursts_late,
+                     (unsigned long long)pstats[i].samples_late,
+                     (unsigned long long)pstats[i].last_late_timestamp);
+            failures++;
+        }
+    }
+
+    /* Model of the mixer's output */
+    {
+        int32_t *acc = calloc(2 * TIMELINE_LEN, sizeof(acc[0]));
+
+        if (acc == NULL) {
+            PR_ERROR("Failed to allocate the model\n");
+            failures++;
+            goto out;
+        }
+
+        for (i = 0; i < ARRAY_SIZE(bursts); i++) {
+            for (k = 0; k < bursts[i].len; k++) {
+                acc[2 * (bursts[i].offset + k)]     += bursts[i].i + (int)k;
+                acc[2 * (bursts[i].offset + k) + 1] += bursts[i].q;
+            }
+        }
+
+        for (k = 0; k < TIMELINE_LEN; k++) {
+            bool clipped = false;
+
+            model[2 * k]     = sat(acc[2 * k], &clipped);
+            model[2 * k + 1] = sat(acc[2 * k + 1], &clipped);
+
+            if (clipped) {
+                expected_clipped++;
+            }
+        }
+
+        free(acc);
+    }
+
+    if (mstats.device_bursts != 2 ||
+        mstats.samples != FIRST_END + bursts[SECOND_BURST].len ||
+        mstats.samples_clipped != expected_clipped || mstats.status != 0) {
+        PR_ERROR("Mixer stats: device_bursts=%llu samples=%llu "
+                 "clipped=%llu (expected %llu) status=%d\n",
+                 (unsigned long long)mstats.device_bursts,
+                 (unsigned long long)mstats.samples,
+                 (unsigned long long)mstats.samples_clipped,
+                 (unsigned long long)expected_clipped, mstats.status);
+        failures++;
+    }
+
+    /* Transmitted samples */
+    failures += read_capture(tx_path, t0, timeline, TIMELINE_LEN, quiet);
+
+    for (k = 0; k < TIMELINE_LEN; k++) {
+        if (timeline[2 * k] != model[2 * k] ||
+            timeline[2 * k + 1] != model[2 * k + 1]) {
+            PR_ERROR("Sample at t0+%zu: expected (%d, %d), got (%d, %d)\n", k,
+                     model[2 * k], model[2 * k + 1], timeline[2 * k],
+                     timeline[2 * k + 1]);
+            failures++;
+            break;
+        }
+    }
+
+out:
+    bladerf_tx_mixer_destroy(mixer);
+
+    if (dev != NULL) {
+        bladerf_close(dev);
+    }
+
+    free(model);
+    free(timeline);
+    remove(rx_path);
+    remove(tx_path);
+    return failures;
+}
+
+DECLARE_TEST_CASE(tx_mixer);
@@ -0,0 +1,455 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Checks the RX stream captured by the HDL co-simulation testbench
+ * (hdl/fpga/ip/nuand/simulation/rx_cosim_tb.vhd).
+ *
+ * The capture is played back through the replay backend and received with
+ * bladerf_sync_rx(), so that the library's own metadata handling decides
+ * where the discontinuities are. Since the testbench's sample at timestamp t
+ * is (t mod 2048, -(t mod 2048)), every sample is checked against the
+ * timestamp that libbladeRF reports for it, and each discontinuity that the
+ * library reports (BLADERF_META_STATUS_OVERRUN) must coincide with a jump in
+ * timestamps, and vice versa.
+ *
+ * libbladeRF counts the timestamps of interleaved two-channel streams in
+ * interleaved samples, whereas the FPGA counts sample periods. With two
+ * channels, samples are therefore checked against each other, rather than
+ * against the timestamps, and discontinuities are found from the samples
+ * alone, as they are without metadata. Lost sample counts are then only
+ * known modulo 2048. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <libbladeRF.h>
+#include <getopt.h>
+
+#include "conversions.h"
+
+#ifdef _WIN32
+#define setenv(name, value, overwrite) _putenv_s(name, value)
+#endif
+
+#define MSG_SIZE_SS     2048
+#define MSG_SIZE_HS     1024
+
+#define COUNTER_MASK    0x7ff
+
+/* Samples requested per bladerf_sync_rx() call, per channel */
+#define CHUNK_SIZE      3000
+
+/* Stream configuration. A transfer times out once the capture is exhausted,
+ * which is how the end of it is detected. */
+#define NUM_BUFFERS     16
+#define BUFFER_SIZE     8192
+#define NUM_TRANSFERS   8
+#define TIMEOUT_MS      500
+
+/* Default replay rate, in samples per second. This keeps the replay backend
+ * from outpacing the checker, which would otherwise add host-side overruns
+ * to those in the capture. */
+#define RATE_DEFAULT    4000000
+
+/* Maximum number of individual errors to print without -v */
+#define MAX_REPORTED    10
+
+#define OPTSTR "uc:nor:vh"
+static const struct option long_options[] = {
+    { "usb2",           no_argument,        0,          'u' },
+    { "channels",       required_argument,  0,          'c' },
+    { "no-meta",        no_argument,        0,          'n' },
+    { "overruns",       no_argument,        0,          'o' },
+    { "rate",           required_argument,  0,          'r' },
+    { "verbose",        no_argument,        0,          'v' },
+    { "help",           no_argument,        0,          'h' },
+    { 0,                0,                  0,          0   },
+};
+
+struct app_params {
+    const char *filename;
+    size_t msg_size;
+    unsigned int channels;
+    unsigned int rate;
+    bool meta;
+    bool fail_on_overrun;
+    bool verbose;
+};
+
+struct results {
+    uint64_t samples;
+    uint64_t overruns;
+    uint64_t samples_lost;
+    uint64_t timestamp_errors;
+    uint64_t sample_errors;
+};
+
+/* Position within the testbench's counter, as determined from the samples */
+struct counter {
+    bool valid;
+    uint64_t next;          /* Counter value expected for the next sample */
+    unsigned int phase;     /* Channel expected for the next sample */
+};
+
+static void print_usage(const char *argv0)
+{
+    printf("Usage: %s [options] <capture file>\n", argv0);
+    printf("Check an RX capture produced by the HDL co-simulation testbench.\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("    -u, --usb2              Capture used USB 2.0 message sizes.\n");
+    printf("    -c, --channels <n>      Number of channels enabled (1 or 2).\n");
+    printf("    -n, --no-meta           Capture does not contain metadata.\n");
+    printf("    -o, --overruns          Treat overruns as failures.\n");
+    printf("    -r, --rate <n>          Replay rate, in samples per second,\n");
+    printf("                            or 0 for as fast as possible.\n");
+    printf("                            Default: %u\n", RATE_DEFAULT);
+    printf("    -v, --verbose           Report every error.\n");
+    printf("    -h, --help              Print this help text.\n");
+    printf("\n");
+    printf("The options must match the testbench's USB2, ENABLE_CHANNEL_1 and\n");
+    printf("META_ENABLE generics.\n");
+    printf("\n");
+}
+
+static int handle_cmdline(int argc, char *argv[], struct app_params *p)
+{
+    int c;
+    bool ok;
+
+    memset(p, 0, sizeof(p[0]));
+
+    p->msg_size = MSG_SIZE_SS;
+    p->channels = 1;
+    p->rate     = RATE_DEFAULT;
+    p->meta     = true;
+
+    while ((c = getopt_long(argc, argv, OPTSTR, long_options, NULL)) >= 0) {
+        switch (c) {
+            case 'u':
+                p->msg_size = MSG_SIZE_HS;
+                break;
+
+            case 'c':
+                p->channels = str2uint(optarg, 1, 2, &ok);
+                if (!ok) {
+                    fprintf(stderr, "Invalid channel count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+
+            case 'n':
+                p->meta = false;
+                break;
+
+            case 'o':
+                p->fail_on_overrun = true;
+                break;
+
+            case 'r':
+                p->rate = str2uint(optarg, 0, UINT32_MAX, &ok);
+                if (!ok) {
+                    fprintf(stderr, "Invalid rate: %s\n", optarg);
+                    return -1;
+                }
+                break;
+
+            case 'v':
+                p->verbose = true;
+                break;
+
+            case 'h':
+                print_usage(argv[0]);
+                return 1;
+
+            default:
+                print_usage(argv[0]);
+                return -1;
+        }
+    }
+
+    if (optind != argc - 1) {
+        fprintf(stderr, "A capture file is required.\n");
+        return -1;
+    }
+
+    p->filename = argv[optind];
+    return 0;
+}
+
+static int open_replay(const struct app_params *p, struct bladerf **dev)
+{
+    char config[4096];
+    char rate[32];
+    int status;
+
+    if (p->rate == 0) {
+        snprintf(rate, sizeof(rate), "max");
+    } else {
+        snprintf(rate, sizeof(rate), "%u", p->rate);
+    }
+
+    status = snprintf(config, sizeof(config),
+                      "file=%s,format=%s,msg_size=%u,rate=%s",
+                      p->filename, p->meta ? "meta" : "sc16q11",
+                      (unsigned int)p->msg_size, rate);
+
+    if (status < 0 || (size_t)status >= sizeof(config)) {
+        fprintf(stderr, "Capture file name is too long.\n");
+        return -1;
+    }
+
+    setenv("BLADERF_REPLAY", config, 1);
+
+    status = bladerf_open(dev, "replay:");
+    if (status != 0) {
+        fprintf(stderr, "Failed to open replay device: %s\n",
+                bladerf_strerror(status));
+        return -1;
+    }
+
+    status = bladerf_sync_config(*dev,
+                                 p->channels == 2 ? BLADERF_RX_X2
+                                                  : BLADERF_RX_X1,
+                                 p->meta ? BLADERF_FORMAT_SC16_Q11_META
+                                         : BLADERF_FORMAT_SC16_Q11,
+                                 NUM_BUFFERS, BUFFER_SIZE, NUM_TRANSFERS,
+                                 TIMEOUT_MS);
+    if (status == 0) {
+        status = bladerf_enable_module(*dev, BLADERF_CHANNEL_RX(0), true);
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Failed to configure RX: %s\n",
+                bladerf_strerror(status));
+        bladerf_close(*dev);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Check samples against the counter, which is advanced past them. If `ts`
+ * is non-NULL, it is the timestamp of the first sample, and the counter is
+ * set from it. Otherwise, a discontinuity in the counter is reported as an
+ * overrun, and the counter resynchronized to the samples. */
+static void check_samples(const struct app_params *p,
+                          const int16_t *samples, size_t n,
+                          const uint64_t *ts,
+                          struct counter *c, struct results *r)
+{
+    size_t i;
+
+    if (ts != NULL) {
+        c->next  = *ts;
+        c->phase = 0;
+        c->valid = true;
+    }
+
+    for (i = 0; i < n; i++) {
+        const int16_t i_val = samples[2 * i];
+        const int16_t q_val = samples[2 * i + 1];
+        int16_t exp;
+
+        if (!c->valid) {
+            c->next  = (uint64_t)i_val & COUNTER_MASK;
+            c->valid = true;
+        } else if (ts == NULL && c->phase == 0 &&
+                   (i_val & COUNTER_MASK) != (int16_t)(c->next & COUNTER_MASK)) {
+            const uint64_t lost =
+                ((uint64_t)i_val - c->next) & COUNTER_MASK;
+
+            if (p->verbose) {
+                printf("Discontinuity @ sample %" PRIu64 ": expected %d, "
+                       "got %d\n", r->samples + i,
+                       (int)(c->next & COUNTER_MASK), i_val);
+            }
+
+            r->overruns++;
+            r->samples_lost += lost;
+            c->next = (uint64_t)i_val & COUNTER_MASK;
+        }
+
+        exp = (int16_t)(c->next & COUNTER_MASK);
+
+        if (i_val != exp || q_val != -exp) {
+            if (p->verbose || r->sample_errors < MAX_REPORTED) {
+                fprintf(stderr, "Sample %" PRIu64 " (t=%" PRIu64 "): "
+                        "expected (%d, %d), got (%d, %d)\n",
+                        r->samples + i, c->next, exp, -exp, i_val, q_val);
+            }
+            r->sample_errors++;
+        }
+
+        if (++c->phase == p->channels) {
+            c->phase = 0;
+            c->next++;
+        }
+    }
+
+    r->samples += n;
+}
+
+static int check_stream(const struct app_params *p,
+                        struct bladerf *dev,
+                        struct results *r)
+{
+    const bool use_ts = p->meta && p->channels == 1;
+    const unsigned int n = CHUNK_SIZE * p->channels;
+    struct bladerf_metadata meta;
+    struct counter counter;
+    uint64_t next_ts  = 0;
+    bool have_ts      = false;
+    bool flagged      = false;
+    int16_t *samples;
+    int status;
+
+    samples = malloc(2 * sizeof(int16_t) * n);
+    if (samples == NULL) {
+        perror("malloc");
+        return -1;
+    }
+
+    memset(&counter, 0, sizeof(counter));
+
+    while (true) {
+        unsigned int count = n;
+
+        memset(&meta, 0, sizeof(meta));
+        meta.flags = BLADERF_META_FLAG_RX_NOW;
+
+        status = bladerf_sync_rx(dev, samples, n, p->meta ? &meta : NULL,
+                                 TIMEOUT_MS * 2);
+
+        if (status == BLADERF_ERR_TIMEOUT) {
+            /* The capture has been exhausted */
+            status = 0;
+            break;
+        } else if (status != 0) {
+            fprintf(stderr, "Failed to receive samples: %s\n",
+                    bladerf_strerror(status));
+            break;
+        }
+
+        if (p->meta) {
+            count = meta.actual_count;
+        }
+
+        if (use_ts) {
+            const bool jumped = have_ts && meta.timestamp != next_ts;
+
+            if (jumped && meta.timestamp > next_ts) {
+                if (p->verbose) {
+                    printf("Overrun @ sample %" PRIu64 ": expected t=%"
+                           PRIu64 ", got t=%" PRIu64 " (%" PRIu64
+                           " samples lost)\n", r->samples, next_ts,
+                           meta.timestamp, meta.timestamp - next_ts);
+                }
+                r->overruns++;
+                r->samples_lost += meta.timestamp - next_ts;
+            } else if (jumped) {
+                if (p->verbose || r->timestamp_errors < MAX_REPORTED) {
+                    fprintf(stderr, "Sample %" PRIu64 ": timestamp went "
+                            "backwards from %" PRIu64 " to %" PRIu64 "\n",
+                            r->samples, next_ts, meta.timestamp);
+                }
+                r->timestamp_errors++;
+            }
+
+            /* The library ends a read early at a discontinuity, so the
+             * following read must start with one */
+            if (jumped != flagged) {
+                if (p->verbose || r->timestamp_errors < MAX_REPORTED) {
+                    fprintf(stderr, "Sample %" PRIu64 ": discontinuity %s "
+                            "reported\n", r->samples,
+                            jumped ? "was not" : "was wrongly");
+                }
+                r->timestamp_errors++;
+            }
+
+            check_samples(p, samples, count, &meta.timestamp, &counter, r);
+
+            next_ts = meta.timestamp + count;
+            have_ts = true;
+            flagged = (meta.status & BLADERF_META_STATUS_OVERRUN) != 0;
+        } else {
+            check_samples(p, samples, count, NULL, &counter, r);
+        }
+    }
+
+    free(samples);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    int status;
+    struct app_params params;
+    struct results results;
+    struct bladerf *dev;
+
+    status = handle_cmdline(argc, argv, &params);
+    if (status != 0) {
+        return status != 1 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    if (open_replay(&params, &dev) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    memset(&results, 0, sizeof(results));
+
+    status = check_stream(&params, dev, &results);
+
+    bladerf_enable_module(dev, BLADERF_CHANNEL_RX(0), false);
+    bladerf_close(dev);
+
+    if (status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Samples:            %" PRIu64 "\n", results.samples);
+    printf("Overruns:           %" PRIu64 "\n", results.overruns);
+    printf("Samples lost:       %" PRIu64 "\n", results.samples_lost);
+    if (params.meta && params.channels == 1) {
+        printf("Timestamp errors:   %" PRIu64 "\n", results.timestamp_errors);
+    }
+    printf("Sample errors:      %" PRIu64 "\n", results.sample_errors);
+
+    if (results.timestamp_errors != 0 || results.sample_errors != 0 ||
+        results.samples == 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (params.fail_on_overrun && results.overruns != 0) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
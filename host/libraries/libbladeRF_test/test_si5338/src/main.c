@@ -0,0 +1,323 @@
+/*
+ * This file is part of the bladeRF project:
+ *   http://www.github.com/nuand/bladeRF
+ *
+ * Copyright (C) 2026 Nuand LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Si5338 driver tests, run against a fake register file in place of the
+ * device: writes that go through the register shadows leave the part in the
+ * same state as full writes, unchanged registers are skipped, and a
+ * multisynth's parameter registers are only ever written as a whole block, in
+ * order. */
+
+#include <libbladeRF.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board/board.h"
+#include "driver/si5338.h"
+
+#define PRINT_ERROR(...) printf(__VA_ARGS__)
+
+#define CHECK(cond_)                                                         \
+    do {                                                                     \
+        if (!(cond_)) {                                                      \
+            PRINT_ERROR("%s:%d: check failed: %s\n", __FUNCTION__, __LINE__, \
+                        #cond_);                                             \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+#define NUM_REGS 256
+#define MAX_WRITES 256
+
+/* Multisynth parameter registers */
+#define MS_BASE(index_) (53 + (index_) * 11)
+#define MS_NUM_REGS 10
+
+struct write {
+    uint8_t addr;
+    uint8_t data;
+};
+
+struct fake_si5338 {
+    uint8_t regs[NUM_REGS];
+
+    struct write writes[MAX_WRITES];
+    unsigned int num_writes;
+
+    /* Fail the write with this index into `writes`, if >= 0 */
+    int fail_write;
+};
+
+static struct fake_si5338 fake;
+
+static int fake_si5338_write(struct bladerf *dev, uint8_t addr, uint8_t data)
+{
+    if (fake.fail_write >= 0 &&
+        fake.num_writes == (unsigned int)fake.fail_write) {
+        fake.fail_write = -1;
+        return BLADERF_ERR_IO;
+    }
+
+    if (fake.num_writes < MAX_WRITES) {
+        fake.writes[fake.num_writes].addr = addr;
+        fake.writes[fake.num_writes].data = data;
+    }
+
+    fake.num_writes++;
+    fake.regs[addr] = data;
+    return 0;
+}
+
+static int fake_si5338_read(struct bladerf *dev, uint8_t addr, uint8_t *data)
+{
+    *data = fake.regs[addr];
+    return 0;
+}
+
+static struct backend_fns fake_backend;
+static struct bladerf fake_dev;
+
+static void fake_reset(void)
+{
+    memset(&fake, 0, sizeof(fake));
+    fake.fail_write = -1;
+}
+
+static void fake_clear_writes(void)
+{
+    fake.num_writes = 0;
+}
+
+static void rate_from_hz(struct bladerf_rational_rate *rate, uint64_t integer,
+                         uint64_t num, uint64_t den)
+{
+    rate->integer = integer;
+    rate->num     = num;
+    rate->den     = den;
+}
+
+/* Check that each multisynth's parameter block was either left alone, or
+ * written in full, in ascending order and without other writes in between */
+static size_t check_block_writes(void)
+{
+    size_t failures = 0;
+    unsigned int i, j;
+    uint8_t index;
+
+    for (index = 1; index <= 2; index++) {
+        const unsigned int base = MS_BASE(index);
+        unsigned int num_blocks = 0;
+
+        for (i = 0; i < fake.num_writes && i < MAX_WRITES; i++) {
+            const unsigned int addr = fake.writes[i].addr;
+
+            if (addr < base || addr >= base + MS_NUM_REGS) {
+                continue;
+            }
+
+            if (addr != base) {
+                PRINT_ERROR("%s: MS%u block write starts at 0x%02x\n",
+                            __FUNCTION__, index, addr);
+                failures++;
+                break;
+            }
+
+            for (j = 0; j < MS_NUM_REGS; j++) {
+                if (i + j >= fake.num_writes ||
+                    fake.writes[i + j].addr != base + j) {
+                    PRINT_ERROR("%s: MS%u block write is missing register "
+                                "0x%02x\n", __FUNCTION__, index, base + j);
+                    failures++;
+                    break;
+                }
+            }
+
+            num_blocks++;
+            i += MS_NUM_REGS - 1;
+        }
+
+        /* One set-rate call programs a block at most once */
+        CHECK(num_blocks <= 1);
+    }
+
+    return failures;
+}
+
+/* Switching between rates through the shadows leaves the part in the same
+ * state as writing every register each time */
+static size_t test_matches_full_writes(void)
+{
+    static const struct {
+        bladerf_channel ch;
+        uint64_t integer, num, den;
+    } steps[] = {
+        { BLADERF_CHANNEL_RX(0), 1000000, 0, 1 },
+        { BLADERF_CHANNEL_TX(0), 1000000, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 2000000, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 2000001, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 2000000, 1, 3 },
+        { BLADERF_CHANNEL_TX(0), 30720000, 0, 1 },
+        { BLADERF_CHANNEL_TX(0), 30720001, 0, 1 },
+        { BLADERF_CHANNEL_TX(0), 40000000, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 10000000, 0, 1 },
+        { BLADERF_CHANNEL_TX(0), 30720000, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 2000000, 0, 1 },
+        { BLADERF_CHANNEL_RX(0), 160000, 0, 1 },
+    };
+
+    struct si5338_cache cache;
+    uint8_t expected[NUM_REGS], prev[NUM_REGS];
+    struct bladerf_rational_rate rate, actual, expected_actual;
+    size_t failures = 0;
+    unsigned int i, j, partial_changes = 0;
+
+    memset(&cache, 0, sizeof(cache));
+    memset(expected, 0, sizeof(expected));
+    fake_reset();
+
+    for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        const uint8_t index = (steps[i].ch == BLADERF_CHANNEL_RX(0)) ? 1 : 2;
+        const unsigned int base = MS_BASE(index);
+        unsigned int changed = 0;
+
+        rate_from_hz(&rate, steps[i].integer, steps[i].num, steps[i].den);
+        memcpy(prev, fake.regs, sizeof(prev));
+
+        /* Reference: every register written */
+        memcpy(fake.regs, expected, sizeof(expected));
+        CHECK(si5338_set_rational_sample_rate(&fake_dev, NULL, steps[i].ch,
+                                              &rate, &expected_actual) == 0);
+        memcpy(expected, fake.regs, sizeof(expected));
+
+        /* Through the shadows, starting from the previous state */
+        memcpy(fake.regs, prev, sizeof(prev));
+        fake_clear_writes();
+        CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache, steps[i].ch,
+                                              &rate, &actual) == 0);
+
+        CHECK(memcmp(fake.regs, expected, sizeof(expected)) == 0);
+        CHECK(actual.integer == expected_actual.integer &&
+              actual.num == expected_actual.num &&
+              actual.den == expected_actual.den);
+        failures += check_block_writes();
+
+        for (j = 0; j < MS_NUM_REGS; j++) {
+            if (prev[base + j] != fake.regs[base + j]) {
+                changed++;
+            }
+        }
+
+        if (changed > 0 && changed < MS_NUM_REGS) {
+            partial_changes++;
+        }
+
+        /* Setting the same rate again leaves the part alone */
+        fake_clear_writes();
+        CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache, steps[i].ch,
+                                              &rate, &actual) == 0);
+        CHECK(fake.num_writes == 0);
+    }
+
+    /* Otherwise, the block writes have not been exercised */
+    CHECK(partial_changes > 0);
+
+    return failures;
+}
+
+/* After the shadows are invalidated, or a write fails, everything is written
+ * again */
+static size_t test_full_rewrite(void)
+{
+    /* Enable register, parameter block and R register */
+    const unsigned int num_full_writes = 1 + MS_NUM_REGS + 1;
+
+    struct si5338_cache cache;
+    struct bladerf_rational_rate rate_a, rate_b;
+    uint8_t expected[NUM_REGS];
+    size_t failures = 0;
+
+    memset(&cache, 0, sizeof(cache));
+    fake_reset();
+
+    rate_from_hz(&rate_a, 4000000, 0, 1);
+    rate_from_hz(&rate_b, 4000000, 1, 7);
+
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache,
+                                          BLADERF_CHANNEL_RX(0), &rate_a,
+                                          NULL) == 0);
+    CHECK(fake.num_writes == num_full_writes);
+
+    si5338_cache_invalidate(&cache);
+    fake_clear_writes();
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache,
+                                          BLADERF_CHANNEL_RX(0), &rate_a,
+                                          NULL) == 0);
+    CHECK(fake.num_writes == num_full_writes);
+    failures += check_block_writes();
+
+    /* Reference state for rate B */
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, NULL,
+                                          BLADERF_CHANNEL_RX(0), &rate_b,
+                                          NULL) == 0);
+    memcpy(expected, fake.regs, sizeof(expected));
+
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, NULL,
+                                          BLADERF_CHANNEL_RX(0), &rate_a,
+                                          NULL) == 0);
+
+    /* Fail in the middle of the parameter block */
+    fake_clear_writes();
+    fake.fail_write = 4;
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache,
+                                          BLADERF_CHANNEL_RX(0), &rate_b,
+                                          NULL) == BLADERF_ERR_IO);
+
+    fake_clear_writes();
+    CHECK(si5338_set_rational_sample_rate(&fake_dev, &cache,
+                                          BLADERF_CHANNEL_RX(0), &rate_b,
+                                          NULL) == 0);
+    CHECK(fake.num_writes == num_full_writes);
+    failures += check_block_writes();
+    CHECK(memcmp(fake.regs, expected, sizeof(expected)) == 0);
+
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t failures = 0;
+
+    fake_backend.si5338_write = fake_si5338_write;
+    fake_backend.si5338_read  = fake_si5338_read;
+    fake_dev.backend          = &fake_backend;
+
+    failures += test_matches_full_writes();
+    failures += test_full_rewrite();
+
+    if (failures != 0) {
+        PRINT_ERROR("%zu Si5338 check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All Si5338 checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,668 @@
+/**
+ * @brief   Mode S / ADS-B demodulation and decoding
+ *
+ * This file is part of the bladeRF project
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "adsb.h"
+
+#ifndef M_PI
+#   define M_PI 3.14159265358979323846
+#endif
+
+#define CRC24_POLY          0xfff409
+
+/* Candidate preambles are flagged in chunks of this many positions, so the
+ * flag buffer stays on the stack and in cache */
+#define PREAMBLE_CHUNK      4096
+
+/* Must be a power of two */
+#define ICAO_CACHE_SIZE     4096
+#define ICAO_CACHE_PROBES   16
+#define ICAO_VALID          0x1000000
+
+struct syndrome {
+    uint32_t syndrome;
+    unsigned int bit;
+};
+
+struct adsb_icao_cache {
+    pthread_mutex_t lock;
+    uint32_t entries[ICAO_CACHE_SIZE];
+};
+
+static uint32_t crc24_lut[256];
+
+/* Single-bit error syndromes for long messages, sorted by syndrome. The five
+ * DF bits are excluded, since "correcting" those changes the message's type
+ * and length. */
+static struct syndrome syndromes[ADSB_LONG_BITS - 5];
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static const char ais_charset[] =
+    "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######";
+
+static uint32_t crc_residual(const uint8_t *data, unsigned int bits);
+
+static int syndrome_cmp(const void *a, const void *b)
+{
+    const struct syndrome *sa = a;
+    const struct syndrome *sb = b;
+
+    if (sa->syndrome < sb->syndrome) {
+        return -1;
+    } else if (sa->syndrome > sb->syndrome) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+static void init_tables(void)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < 256; i++) {
+        uint32_t c = i << 16;
+        for (j = 0; j < 8; j++) {
+            c = (c & 0x800000) ? (c << 1) ^ CRC24_POLY : (c << 1);
+        }
+        crc24_lut[i] = c & 0xffffff;
+    }
+
+    /* The CRC is linear with a zero initial value, so the residual of a
+     * message with a single bit flipped is simply the residual of a message
+     * containing only that bit. */
+    for (i = 5; i < ADSB_LONG_BITS; i++) {
+        uint8_t msg[ADSB_LONG_BYTES];
+
+        memset(msg, 0, sizeof(msg));
+        msg[i / 8] = 0x80 >> (i % 8);
+
+        syndromes[i - 5].syndrome = crc_residual(msg, ADSB_LONG_BITS);
+        syndromes[i - 5].bit      = i;
+    }
+
+    qsort(syndromes, ADSB_LONG_BITS - 5, sizeof(syndromes[0]), syndrome_cmp);
+}
+
+static uint32_t crc_residual(const uint8_t *data, unsigned int bits)
+{
+    const unsigned int n = bits / 8;
+    unsigned int i;
+    uint32_t crc = 0;
+
+    for (i = 0; i < n - 3; i++) {
+        crc = ((crc << 8) ^ crc24_lut[((crc >> 16) ^ data[i]) & 0xff]) &
+              0xffffff;
+    }
+
+    return crc ^ (((uint32_t)data[n - 3] << 16) |
+                  ((uint32_t)data[n - 2] << 8) |
+                  (uint32_t)data[n - 1]);
+}
+
+uint32_t adsb_crc_residual(const uint8_t *data, unsigned int bits)
+{
+    pthread_once(&tables_once, init_tables);
+    return crc_residual(data, bits);
+}
+
+struct adsb_icao_cache *adsb_icao_cache_alloc(void)
+{
+    struct adsb_icao_cache *cache;
+
+    cache = calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&cache->lock, NULL) != 0) {
+        free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void adsb_icao_cache_free(struct adsb_icao_cache *cache)
+{
+    if (cache != NULL) {
+        pthread_mutex_destroy(&cache->lock);
+        free(cache);
+    }
+}
+
+static inline unsigned int icao_hash(uint32_t addr)
+{
+    addr ^= addr >> 12;
+    addr *= 0x9e3779b1;
+    return (addr >> 16) & (ICAO_CACHE_SIZE - 1);
+}
+
+static void icao_cache_add(struct adsb_icao_cache *cache, uint32_t addr)
+{
+    const unsigned int h = icao_hash(addr);
+    const uint32_t entry = addr | ICAO_VALID;
+    unsigned int i;
+
+    pthread_mutex_lock(&cache->lock);
+
+    for (i = 0; i < ICAO_CACHE_PROBES; i++) {
+        uint32_t *slot = &cache->entries[(h + i) & (ICAO_CACHE_SIZE - 1)];
+        if (*slot == entry) {
+            break;
+        } else if (*slot == 0) {
+            *slot = entry;
+            break;
+        }
+    }
+
+    /* Table neighborhood is full; evict the entry at the home slot */
+    if (i == ICAO_CACHE_PROBES) {
+        cache->entries[h] = entry;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+static bool icao_cache_has(struct adsb_icao_cache *cache, uint32_t addr)
+{
+    const unsigned int h = icao_hash(addr);
+    const uint32_t entry = addr | ICAO_VALID;
+    unsigned int i;
+    bool found = false;
+
+    pthread_mutex_lock(&cache->lock);
+
+    for (i = 0; i < ICAO_CACHE_PROBES; i++) {
+        const uint32_t slot = cache->entries[(h + i) & (ICAO_CACHE_SIZE - 1)];
+        if (slot == entry) {
+            found = true;
+            break;
+        } else if (slot == 0) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return found;
+}
+
+void adsb_magnitude(const int16_t *samples, uint16_t *mag, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        const int32_t re = samples[2 * i];
+        const int32_t im = samples[2 * i + 1];
+        mag[i] = (uint16_t)((re < 0 ? -re : re) + (im < 0 ? -im : im));
+    }
+}
+
+/* Flag positions whose magnitudes look like a Mode S preamble: pulses at
+ * 0, 1.0, 3.5 and 4.5 us (samples 0, 2, 7 and 9), with the gaps between them
+ * and the quiet period before the data (samples 11-14) well below the pulse
+ * level.
+ *
+ * Every condition is evaluated for every position, without branches, so the
+ * compiler can vectorize this loop. Only the (rare) flagged positions are
+ * then demodulated. */
+static void find_preambles(const uint16_t *mag, uint8_t *flags, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        const uint16_t *m = &mag[i];
+        const uint32_t high = (uint32_t)m[0] + m[2] + m[7] + m[9];
+
+        flags[i] = (m[0] > m[1]) & (m[1] < m[2]) & (m[2] > m[3]) &
+                   (m[3] < m[0]) & (m[4] < m[0]) & (m[5] < m[0]) &
+                   (m[6] < m[0]) & (m[7] > m[8]) & (m[8] < m[9]) &
+                   (m[9] > m[6]) &
+                   (6u * m[4] < high)  & (6u * m[5] < high) &
+                   (6u * m[11] < high) & (6u * m[12] < high) &
+                   (6u * m[13] < high) & (6u * m[14] < high);
+    }
+}
+
+/* Pulse position demodulation: a 1 is a pulse in the first half of the bit
+ * period, and a 0 is a pulse in the second half */
+static void demod_bits(const uint16_t *m, uint8_t *data, unsigned int bits)
+{
+    unsigned int i;
+
+    for (i = 0; i < bits / 8; i++) {
+        const uint16_t *b = &m[16 * i];
+        data[i] = ((b[0]  > b[1])  << 7) | ((b[2]  > b[3])  << 6) |
+                  ((b[4]  > b[5])  << 5) | ((b[6]  > b[7])  << 4) |
+                  ((b[8]  > b[9])  << 3) | ((b[10] > b[11]) << 2) |
+                  ((b[12] > b[13]) << 1) | ((b[14] > b[15]) << 0);
+    }
+}
+
+static inline unsigned int msg_bits(unsigned int df)
+{
+    return (df & 0x10) ? ADSB_LONG_BITS : ADSB_SHORT_BITS;
+}
+
+static inline uint32_t msg_aa(const uint8_t *data)
+{
+    return ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+/* Verify (and optionally correct) the CRC of a demodulated message.
+ * Returns true if it should be accepted. */
+static bool check_msg(struct adsb_msg *msg, struct adsb_icao_cache *cache,
+                      bool fix_errors)
+{
+    uint32_t residual = crc_residual(msg->data, msg->len);
+    struct syndrome key, *s;
+
+    switch (msg->df) {
+        case 17:
+        case 18:
+            if (residual != 0 && fix_errors) {
+                key.syndrome = residual;
+                s = bsearch(&key, syndromes, ADSB_LONG_BITS - 5,
+                            sizeof(syndromes[0]), syndrome_cmp);
+                if (s != NULL) {
+                    msg->data[s->bit / 8] ^= 0x80 >> (s->bit % 8);
+                    msg->corrected_bit = s->bit;
+                    msg->corrected = true;
+                    residual = 0;
+                }
+            }
+
+            if (residual != 0) {
+                return false;
+            }
+
+            msg->icao = msg_aa(msg->data);
+            if (cache != NULL) {
+                icao_cache_add(cache, msg->icao);
+            }
+            return true;
+
+        case 11:
+            /* The low 7 bits may carry the interrogator identifier */
+            if ((residual & ~0x7fu) != 0) {
+                return false;
+            }
+
+            msg->icao = msg_aa(msg->data);
+            if (cache != NULL && residual == 0) {
+                icao_cache_add(cache, msg->icao);
+            }
+            return true;
+
+        case 0:
+        case 4:
+        case 5:
+        case 16:
+        case 20:
+        case 21:
+            /* Address/parity: the residual is the aircraft address */
+            if (cache == NULL || !icao_cache_has(cache, residual)) {
+                return false;
+            }
+
+            msg->icao = residual;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+size_t adsb_demod(const uint16_t *mag, size_t n, uint64_t base,
+                  struct adsb_icao_cache *cache, bool fix_errors,
+                  struct adsb_msg *msgs, size_t max_msgs,
+                  struct adsb_stats *stats)
+{
+    uint8_t flags[PREAMBLE_CHUNK];
+    size_t count = 0;
+    size_t skip = 0;
+    size_t chunk, i;
+
+    pthread_once(&tables_once, init_tables);
+
+    stats->samples += n;
+
+    for (chunk = 0; chunk < n && count < max_msgs; chunk += PREAMBLE_CHUNK) {
+        size_t len = n - chunk;
+
+        if (len > PREAMBLE_CHUNK) {
+            len = PREAMBLE_CHUNK;
+        }
+
+        find_preambles(&mag[chunk], flags, len);
+
+        for (i = 0; i < len && count < max_msgs; i++) {
+            const size_t pos = chunk + i;
+            struct adsb_msg *msg = &msgs[count];
+
+            if (!flags[i] || pos < skip) {
+                continue;
+            }
+
+            stats->preambles++;
+
+            memset(msg, 0, sizeof(*msg));
+            demod_bits(&mag[pos + ADSB_PREAMBLE_SAMPLES], msg->data,
+                       ADSB_LONG_BITS);
+
+            msg->df     = msg->data[0] >> 3;
+            msg->len    = msg_bits(msg->df);
+            msg->sample = base + pos;
+
+            if (!check_msg(msg, cache, fix_errors)) {
+                stats->bad_crc++;
+                continue;
+            }
+
+            if (msg->corrected) {
+                stats->corrected++;
+            } else {
+                stats->valid++;
+            }
+
+            adsb_decode(msg);
+            count++;
+
+            /* Don't look for preambles within this message's data */
+            skip = pos + ADSB_PREAMBLE_SAMPLES + 2 * msg->len;
+        }
+    }
+
+    return count;
+}
+
+/* Decode the 13-bit altitude code of DF0/4/16/20. Only 25 ft (Q=1) encoding
+ * is handled; Gillham-coded and metric altitudes are reported as invalid. */
+static int32_t decode_ac13(uint32_t ac)
+{
+    uint32_t n;
+
+    if ((ac & 0x40) || !(ac & 0x10)) {
+        return ADSB_ALTITUDE_INVALID;
+    }
+
+    n = ((ac & 0x1f80) >> 2) | ((ac & 0x20) >> 1) | (ac & 0x0f);
+    return (int32_t)n * 25 - 1000;
+}
+
+/* Decode the 12-bit altitude code of an airborne position message */
+static int32_t decode_ac12(uint32_t ac)
+{
+    uint32_t n;
+
+    if (!(ac & 0x10)) {
+        return ADSB_ALTITUDE_INVALID;
+    }
+
+    n = ((ac & 0xfe0) >> 1) | (ac & 0x0f);
+    return (int32_t)n * 25 - 1000;
+}
+
+static void decode_es(struct adsb_msg *msg)
+{
+    const uint8_t *me = &msg->data[4];
+    unsigned int i;
+
+    msg->type_code = me[0] >> 3;
+
+    if (msg->type_code >= 1 && msg->type_code <= 4) {
+        /* Eight 6-bit characters in ME bits 9-56 */
+        uint64_t chars = 0;
+
+        for (i = 1; i < 7; i++) {
+            chars = (chars << 8) | me[i];
+        }
+
+        for (i = 0; i < 8; i++) {
+            msg->callsign[i] = ais_charset[(chars >> (42 - 6 * i)) & 0x3f];
+        }
+        msg->callsign[8] = '\0';
+
+    } else if (msg->type_code >= 9 && msg->type_code <= 18) {
+        msg->altitude = decode_ac12(((uint32_t)me[1] << 4) | (me[2] >> 4));
+
+    } else if (msg->type_code == 19 && (me[0] & 0x7) == 1) {
+        /* Airborne velocity, subsonic ground speed */
+        const int ew_raw = ((me[1] & 0x03) << 8) | me[2];
+        const int ns_raw = ((me[3] & 0x7f) << 3) | (me[4] >> 5);
+        const int vr_raw = ((me[4] & 0x07) << 6) | (me[5] >> 2);
+
+        if (ew_raw != 0 && ns_raw != 0) {
+            const int ew = (me[1] & 0x04) ? -(ew_raw - 1) : (ew_raw - 1);
+            const int ns = (me[3] & 0x80) ? -(ns_raw - 1) : (ns_raw - 1);
+            double hdg = atan2(ew, ns) * 180.0 / M_PI;
+
+            if (hdg < 0) {
+                hdg += 360.0;
+            }
+
+            msg->ground_speed = (int)(sqrt((double)ew * ew + ns * ns) + 0.5);
+            msg->heading = (int)(hdg + 0.5) % 360;
+        }
+
+        if (vr_raw != 0) {
+            msg->vertical_rate = (me[4] & 0x08) ? -(vr_raw - 1) * 64
+                                                : (vr_raw - 1) * 64;
+        }
+    }
+}
+
+void adsb_decode(struct adsb_msg *msg)
+{
+    msg->altitude      = ADSB_ALTITUDE_INVALID;
+    msg->ground_speed  = -1;
+    msg->heading       = -1;
+    msg->vertical_rate = 0;
+    msg->callsign[0]   = '\0';
+
+    switch (msg->df) {
+        case 0:
+        case 4:
+        case 16:
+        case 20:
+            msg->altitude = decode_ac13(((uint32_t)(msg->data[2] & 0x1f) << 8) |
+                                        msg->data[3]);
+            break;
+
+        case 17:
+        case 18:
+            decode_es(msg);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void adsb_print(const struct adsb_msg *msg, bool verbose)
+{
+    unsigned int i;
+
+    putchar('*');
+    for (i = 0; i < msg->len / 8; i++) {
+        printf("%02x", msg->data[i]);
+    }
+    printf(";\n");
+
+    if (!verbose) {
+        return;
+    }
+
+    printf("  t=%.6f DF%-2u ICAO %06x", (double)msg->sample / ADSB_SAMPLE_RATE,
+           msg->df, msg->icao);
+
+    if (msg->df == 17 || msg->df == 18) {
+        printf(" TC%-2u", msg->type_code);
+    }
+
+    if (msg->callsign[0] != '\0') {
+        printf(" callsign %s", msg->callsign);
+    }
+
+    if (msg->altitude != ADSB_ALTITUDE_INVALID) {
+        printf(" alt %d ft", msg->altitude);
+    }
+
+    if (msg->ground_speed >= 0) {
+        printf(" gs %d kt hdg %d vr %d ft/min", msg->ground_speed,
+               msg->heading, msg->vertical_rate);
+    }
+
+    if (msg->corrected) {
+        printf(" (fixed bit %u)", msg->corrected_bit);
+    }
+
+    putchar('\n');
+}
+
+#if defined(ADSB_TEST)
+/* Modulate a few known messages into a sample buffer, with and without bit
+ * errors, and check that they are recovered */
+
+#define TEST_AMPLITUDE  1000
+#define TEST_SPACING    400
+
+static const char *test_msgs[] = {
+    "8d4840d6202cc371c32ce0576098",     /* Identification: KLM1023 */
+    "8d40621d58c382d690c8ac2863a7",     /* Airborne position: 38000 ft */
+    "8d485020994409940838175b284f",     /* Airborne velocity */
+};
+
+static void hex2bytes(const char *hex, uint8_t *out)
+{
+    unsigned int i;
+
+    for (i = 0; hex[2 * i] != '\0'; i++) {
+        sscanf(&hex[2 * i], "%2hhx", &out[i]);
+    }
+}
+
+static void modulate(int16_t *samples, const uint8_t *data, unsigned int bits)
+{
+    static const unsigned int preamble[] = { 0, 2, 7, 9 };
+    unsigned int i;
+
+    for (i = 0; i < 4; i++) {
+        samples[2 * preamble[i]] = TEST_AMPLITUDE;
+    }
+
+    for (i = 0; i < bits; i++) {
+        const unsigned int bit = (data[i / 8] >> (7 - i % 8)) & 1;
+        const unsigned int s = ADSB_PREAMBLE_SAMPLES + 2 * i + (bit ? 0 : 1);
+        samples[2 * s] = TEST_AMPLITUDE;
+    }
+}
+
+int main(void)
+{
+    const size_t n_tests = sizeof(test_msgs) / sizeof(test_msgs[0]);
+    const size_t n = (2 * n_tests + 1) * TEST_SPACING;
+    struct adsb_msg msgs[16];
+    struct adsb_stats stats;
+    struct adsb_icao_cache *cache;
+    int16_t *samples;
+    uint16_t *mag;
+    size_t i, count;
+    int failures = 0;
+
+    samples = calloc(2 * (n + ADSB_FRAME_SAMPLES), sizeof(samples[0]));
+    mag     = calloc(n + ADSB_FRAME_SAMPLES, sizeof(mag[0]));
+    cache   = adsb_icao_cache_alloc();
+    if (samples == NULL || mag == NULL || cache == NULL) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < n_tests; i++) {
+        uint8_t data[ADSB_LONG_BYTES];
+
+        hex2bytes(test_msgs[i], data);
+        if (adsb_crc_residual(data, ADSB_LONG_BITS) != 0) {
+            fprintf(stderr, "Bad CRC for test message %s\n", test_msgs[i]);
+            failures++;
+        }
+
+        modulate(&samples[2 * (2 * i) * TEST_SPACING], data, ADSB_LONG_BITS);
+
+        /* Repeat the message with a single bit error */
+        data[5 + i] ^= 0x10;
+        modulate(&samples[2 * (2 * i + 1) * TEST_SPACING], data,
+                 ADSB_LONG_BITS);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    adsb_magnitude(samples, mag, n + ADSB_FRAME_SAMPLES);
+    count = adsb_demod(mag, n, 0, cache, true, msgs, 16, &stats);
+
+    if (count != 2 * n_tests) {
+        fprintf(stderr, "Expected %u messages, got %u\n",
+                (unsigned int)(2 * n_tests), (unsigned int)count);
+        failures++;
+    }
+
+    for (i = 0; i < count; i++) {
+        uint8_t data[ADSB_LONG_BYTES];
+
+        adsb_print(&msgs[i], true);
+
+        hex2bytes(test_msgs[i / 2], data);
+        if (memcmp(data, msgs[i].data, sizeof(data)) != 0) {
+            fprintf(stderr, "Message %u mismatch\n", (unsigned int)i);
+            failures++;
+        }
+
+        if (msgs[i].corrected != (i % 2 == 1)) {
+            fprintf(stderr, "Message %u correction mismatch\n",
+                    (unsigned int)i);
+            failures++;
+        }
+    }
+
+    if (count >= 6) {
+        if (strcmp(msgs[0].callsign, "KLM1023 ") != 0 ||
+            msgs[2].altitude != 38000 ||
+            msgs[4].ground_speed != 159 || msgs[4].heading != 183 ||
+            msgs[4].vertical_rate != -832) {
+            fprintf(stderr, "Decoded fields mismatch\n");
+            failures++;
+        }
+    }
+
+    adsb_icao_cache_free(cache);
+    free(mag);
+    free(samples);
+
+    printf("%s\n", failures == 0 ? "PASSED" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief   Mode S / ADS-B demodulation and decoding
+ *
+ * This file is part of the bladeRF project
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ADSB_H_
+#define ADSB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** The demodulator operates on 2 Msps input: two samples per 1 us bit */
+#define ADSB_SAMPLE_RATE        2000000
+
+#define ADSB_PREAMBLE_SAMPLES   16
+#define ADSB_LONG_BITS          112
+#define ADSB_SHORT_BITS         56
+#define ADSB_LONG_BYTES         (ADSB_LONG_BITS / 8)
+#define ADSB_SHORT_BYTES        (ADSB_SHORT_BITS / 8)
+
+/** Number of samples spanned by a long message, including its preamble */
+#define ADSB_FRAME_SAMPLES      (ADSB_PREAMBLE_SAMPLES + 2 * ADSB_LONG_BITS)
+
+/** Sentinel for the `altitude` field when it was not present or invalid */
+#define ADSB_ALTITUDE_INVALID   INT32_MIN
+
+struct adsb_msg {
+    uint8_t data[ADSB_LONG_BYTES];
+    unsigned int len;           /**< Length in bits (56 or 112) */
+    uint64_t sample;            /**< Sample index of the preamble's start */
+    unsigned int corrected_bit; /**< Bit that was fixed, or 0 if none */
+    bool corrected;
+
+    /* Decoded fields */
+    unsigned int df;            /**< Downlink format */
+    uint32_t icao;              /**< ICAO 24-bit address */
+    unsigned int type_code;     /**< Extended squitter type code (DF17/18) */
+    char callsign[9];           /**< Identification (TC 1-4), NUL-terminated */
+    int32_t altitude;           /**< Altitude (ft), or ADSB_ALTITUDE_INVALID */
+    int ground_speed;           /**< Ground speed (kt), or -1 if not present */
+    int heading;                /**< Track angle (degrees), or -1 */
+    int vertical_rate;          /**< Vertical rate (ft/min) */
+};
+
+struct adsb_stats {
+    uint64_t samples;
+    uint64_t preambles;         /**< Candidate preambles */
+    uint64_t valid;             /**< Messages passing CRC unmodified */
+    uint64_t corrected;         /**< Messages passing CRC after correction */
+    uint64_t bad_crc;           /**< Candidates rejected by CRC */
+};
+
+/**
+ * Demodulator state that is shared between threads.
+ *
+ * Replies whose parity is overlaid with the aircraft address (e.g., DF4,
+ * DF5, DF20, DF21) can only be verified against addresses that have
+ * already been seen in DF11/DF17/DF18 messages. This table tracks them.
+ */
+struct adsb_icao_cache;
+
+struct adsb_icao_cache *adsb_icao_cache_alloc(void);
+void adsb_icao_cache_free(struct adsb_icao_cache *cache);
+
+/**
+ * Compute the magnitude of `n` SC16 Q11 samples.
+ *
+ * This uses |I| + |Q|, which is monotonic enough for preamble detection and
+ * bit decisions, and keeps the loop trivially vectorizable.
+ *
+ * @param[in]   samples     Interleaved I/Q samples (2*n values)
+ * @param[out]  mag         Magnitudes (n values)
+ * @param[in]   n           Number of samples
+ */
+void adsb_magnitude(const int16_t *samples, uint16_t *mag, size_t n);
+
+/**
+ * Search `mag` for Mode S messages
+ *
+ * Messages are only searched for at positions [0, n); `mag` must hold
+ * n + ADSB_FRAME_SAMPLES values so that messages starting near the end of
+ * the block can be demodulated in full.
+ *
+ * @param[in]   mag         Magnitudes, as produced by adsb_magnitude()
+ * @param[in]   n           Number of positions to search
+ * @param[in]   base        Sample index of mag[0], used for timestamps
+ * @param       cache       ICAO cache. May be NULL to only accept
+ *                          DF11/DF17/DF18 messages.
+ * @param[in]   fix_errors  Attempt single-bit error correction
+ * @param[out]  msgs        Decoded messages
+ * @param[in]   max_msgs    Capacity of `msgs`
+ * @param[out]  stats       Statistics are accumulated here
+ *
+ * @return Number of messages written to `msgs`
+ */
+size_t adsb_demod(const uint16_t *mag, size_t n, uint64_t base,
+                  struct adsb_icao_cache *cache, bool fix_errors,
+                  struct adsb_msg *msgs, size_t max_msgs,
+                  struct adsb_stats *stats);
+
+/**
+ * Compute the CRC-24 (polynomial 0xfff409) residual of a message.
+ *
+ * @return 0 for a valid DF11/DF17/DF18 message, or the overlaid address or
+ *         interrogator ID for other formats
+ */
+uint32_t adsb_crc_residual(const uint8_t *data, unsigned int bits);
+
+/**
+ * Populate the decoded fields of `msg` from its raw data
+ */
+void adsb_decode(struct adsb_msg *msg);
+
+/**
+ * Print a message in the common "*<hex>;" raw format, followed by a summary
+ * of its decoded fields when `verbose` is set.
+ */
+void adsb_print(const struct adsb_msg *msg, bool verbose);
+
+#endif
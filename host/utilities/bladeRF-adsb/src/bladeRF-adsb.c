@@ -0,0 +1,720 @@
+/**
+ * @brief   Mode S / ADS-B receiver
+ *
+ * Samples are read from a bladeRF running the standard FPGA image, or from an
+ * SC16 Q11 capture, in blocks. Each block is demodulated by one of a pool of
+ * worker threads, and the results are printed in the order the blocks were
+ * read.
+ *
+ * This file is part of the bladeRF project
+ *
+ * Copyright (C) 2019 Nuand LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <libbladeRF.h>
+#include "host_config.h"
+
+#if BLADERF_OS_WINDOWS || BLADERF_OS_OSX
+    #include "clock_gettime.h"
+#else
+    #include <time.h>
+#endif
+
+#include "conversions.h"
+#include "adsb.h"
+
+/* ~65 ms of samples per block */
+#define BLOCK_SAMPLES       (128 * 1024)
+
+/* Upper bound on the number of messages that fit in a block */
+#define BLOCK_MAX_MSGS      (BLOCK_SAMPLES / \
+                             (ADSB_PREAMBLE_SAMPLES + 2 * ADSB_SHORT_BITS) + 1)
+
+#define MAX_THREADS         32
+
+#define FREQUENCY_DEFAULT   1090000000
+#define BANDWIDTH_DEFAULT   3000000
+
+#define OPTSTR "d:i:f:g:j:bnvqh"
+static const struct option long_options[] = {
+    { "device",     required_argument,  NULL,   'd' },
+    { "input",      required_argument,  NULL,   'i' },
+    { "frequency",  required_argument,  NULL,   'f' },
+    { "gain",       required_argument,  NULL,   'g' },
+    { "threads",    required_argument,  NULL,   'j' },
+    { "benchmark",  no_argument,        NULL,   'b' },
+    { "no-fix",     no_argument,        NULL,   'n' },
+    { "verbose",    no_argument,        NULL,   'v' },
+    { "quiet",      no_argument,        NULL,   'q' },
+    { "help",       no_argument,        NULL,   'h' },
+    { NULL,         0,                  NULL,   0   },
+};
+
+static const struct numeric_suffix freq_suffixes[] = {
+    { "k",      1000 },
+    { "KHz",    1000 },
+    { "M",      1000 * 1000 },
+    { "MHz",    1000 * 1000 },
+    { "G",      1000 * 1000 * 1000 },
+    { "GHz",    1000 * 1000 * 1000 },
+};
+
+static const size_t num_freq_suffixes =
+    sizeof(freq_suffixes) / sizeof(freq_suffixes[0]);
+
+struct app_params {
+    const char *device_str;
+    const char *input;
+    uint64_t frequency;
+    int gain;
+    bool set_gain;
+    unsigned int threads;
+    bool benchmark;
+    bool fix_errors;
+    bool verbose;
+    bool quiet;
+};
+
+/* Sample source: a device, a capture file, or (for benchmarks) a capture
+ * that has been loaded into memory, so that disk throughput isn't measured */
+struct source {
+    struct bladerf *dev;
+    FILE *file;
+    int16_t *mem;
+    size_t mem_samples;
+    size_t mem_pos;
+};
+
+enum block_state {
+    BLOCK_EMPTY,
+    BLOCK_FILLED,
+    BLOCK_BUSY,
+    BLOCK_DONE,
+};
+
+struct block {
+    enum block_state state;
+    uint64_t base;                  /* Sample index of samples[0] */
+    size_t n;                       /* Number of positions to search */
+
+    /* BLOCK_SAMPLES + ADSB_FRAME_SAMPLES samples. The last
+     * ADSB_FRAME_SAMPLES are repeated at the start of the next block. */
+    int16_t *samples;
+    uint16_t *mag;
+
+    struct adsb_msg *msgs;
+    size_t num_msgs;
+    struct adsb_stats stats;
+};
+
+struct pipeline {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;      /* A block was filled, or shutdown */
+    pthread_cond_t work_done;       /* A block was demodulated */
+
+    struct block *blocks;
+    size_t num_blocks;
+    size_t next_work;               /* Next block for a worker to take */
+    bool shutdown;
+
+    struct adsb_icao_cache *cache;
+    bool fix_errors;
+
+    pthread_t threads[MAX_THREADS];
+    unsigned int num_threads;
+};
+
+static volatile bool stop_requested = false;
+
+static void handle_signal(int signum)
+{
+    (void)signum;
+    stop_requested = true;
+}
+
+static void print_usage(const char *argv0)
+{
+    printf("Usage: %s [options]\n", argv0);
+    printf("Mode S / ADS-B receiver and decoder.\n\n");
+    printf("Options:\n");
+    printf("  -d, --device <str>      Device specifier string.\n");
+    printf("  -i, --input <file>      Decode an SC16 Q11 capture recorded at 2 Msps,\n");
+    printf("                          instead of receiving from a device.\n");
+    printf("  -f, --frequency <freq>  RX frequency. Default: 1090M\n");
+    printf("  -g, --gain <dB>         RX gain. Default: device default (AGC).\n");
+    printf("  -j, --threads <n>       Number of demodulator threads. Default: 2\n");
+    printf("  -b, --benchmark         Load the input file into memory, decode it\n");
+    printf("                          without printing messages, and report\n");
+    printf("                          throughput.\n");
+    printf("  -n, --no-fix            Disable single-bit error correction.\n");
+    printf("  -v, --verbose           Print decoded fields of each message.\n");
+    printf("  -q, --quiet             Don't print statistics.\n");
+    printf("  -h, --help              Print this help text.\n");
+    printf("\n");
+    printf("Messages are printed in the \"*<hex>;\" raw format.\n");
+    printf("\n");
+}
+
+static int handle_cmdline(int argc, char *argv[], struct app_params *p)
+{
+    int c;
+    bool ok;
+
+    memset(p, 0, sizeof(p[0]));
+    p->frequency  = FREQUENCY_DEFAULT;
+    p->threads    = 2;
+    p->fix_errors = true;
+
+    while ((c = getopt_long(argc, argv, OPTSTR, long_options, NULL)) >= 0) {
+        switch (c) {
+            case 'd':
+                p->device_str = optarg;
+                break;
+
+            case 'i':
+                p->input = optarg;
+                break;
+
+            case 'f':
+                p->frequency = str2uint64_suffix(optarg, 0, UINT64_MAX,
+                                                 freq_suffixes,
+                                                 num_freq_suffixes, &ok);
+                if (!ok) {
+                    fprintf(stderr, "Invalid frequency: %s\n", optarg);
+                    return -1;
+                }
+                break;
+
+            case 'g':
+                p->gain = str2int(optarg, -100, 100, &ok);
+                if (!ok) {
+                    fprintf(stderr, "Invalid gain: %s\n", optarg);
+                    return -1;
+                }
+                p->set_gain = true;
+                break;
+
+            case 'j':
+                p->threads = str2uint(optarg, 1, MAX_THREADS, &ok);
+                if (!ok) {
+                    fprintf(stderr, "Invalid thread count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+
+            case 'b':
+                p->benchmark = true;
+                break;
+
+            case 'n':
+                p->fix_errors = false;
+                break;
+
+            case 'v':
+                p->verbose = true;
+                break;
+
+            case 'q':
+                p->quiet = true;
+                break;
+
+            case 'h':
+                print_usage(argv[0]);
+                return 1;
+
+            default:
+                print_usage(argv[0]);
+                return -1;
+        }
+    }
+
+    if (p->benchmark && p->input == NULL) {
+        fprintf(stderr, "Benchmark mode requires an input file.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int open_device(const struct app_params *p, struct bladerf **dev_out)
+{
+    const bladerf_channel ch = BLADERF_CHANNEL_RX(0);
+    struct bladerf *dev;
+    int status;
+
+    status = bladerf_open(&dev, p->device_str);
+    if (status != 0) {
+        fprintf(stderr, "Failed to open device: %s\n",
+                bladerf_strerror(status));
+        return status;
+    }
+
+    status = bladerf_set_frequency(dev, ch, p->frequency);
+    if (status != 0) {
+        fprintf(stderr, "Failed to set frequency: %s\n",
+                bladerf_strerror(status));
+        goto error;
+    }
+
+    status = bladerf_set_sample_rate(dev, ch, ADSB_SAMPLE_RATE, NULL);
+    if (status != 0) {
+        fprintf(stderr, "Failed to set sample rate: %s\n",
+                bladerf_strerror(status));
+        goto error;
+    }
+
+    status = bladerf_set_bandwidth(dev, ch, BANDWIDTH_DEFAULT, NULL);
+    if (status != 0) {
+        fprintf(stderr, "Failed to set bandwidth: %s\n",
+                bladerf_strerror(status));
+        goto error;
+    }
+
+    if (p->set_gain) {
+        status = bladerf_set_gain_mode(dev, ch, BLADERF_GAIN_MGC);
+        if (status != 0 && status != BLADERF_ERR_UNSUPPORTED) {
+            fprintf(stderr, "Failed to set gain mode: %s\n",
+                    bladerf_strerror(status));
+            goto error;
+        }
+
+        status = bladerf_set_gain(dev, ch, p->gain);
+        if (status != 0) {
+            fprintf(stderr, "Failed to set gain: %s\n",
+                    bladerf_strerror(status));
+            goto error;
+        }
+    }
+
+    status = bladerf_sync_config(dev, BLADERF_RX_X1, BLADERF_FORMAT_SC16_Q11,
+                                 16, 8192, 8, 3500);
+    if (status != 0) {
+        fprintf(stderr, "Failed to configure RX stream: %s\n",
+                bladerf_strerror(status));
+        goto error;
+    }
+
+    status = bladerf_enable_module(dev, ch, true);
+    if (status != 0) {
+        fprintf(stderr, "Failed to enable RX: %s\n",
+                bladerf_strerror(status));
+        goto error;
+    }
+
+    *dev_out = dev;
+    return 0;
+
+error:
+    bladerf_close(dev);
+    return status;
+}
+
+static int source_open(const struct app_params *p, struct source *src)
+{
+    memset(src, 0, sizeof(*src));
+
+    if (p->input == NULL) {
+        return open_device(p, &src->dev);
+    }
+
+    src->file = fopen(p->input, "rb");
+    if (src->file == NULL) {
+        perror(p->input);
+        return -1;
+    }
+
+    if (p->benchmark) {
+        long len;
+
+        if (fseek(src->file, 0, SEEK_END) != 0 ||
+            (len = ftell(src->file)) < 0 ||
+            fseek(src->file, 0, SEEK_SET) != 0) {
+            perror(p->input);
+            goto error;
+        }
+
+        src->mem_samples = (size_t)len / (2 * sizeof(int16_t));
+        src->mem = malloc(src->mem_samples * 2 * sizeof(int16_t) + 1);
+        if (src->mem == NULL) {
+            perror("malloc");
+            goto error;
+        }
+
+        if (fread(src->mem, 2 * sizeof(int16_t), src->mem_samples,
+                  src->file) != src->mem_samples) {
+            perror(p->input);
+            free(src->mem);
+            goto error;
+        }
+
+        fclose(src->file);
+        src->file = NULL;
+    }
+
+    return 0;
+
+error:
+    fclose(src->file);
+    return -1;
+}
+
+static void source_close(struct source *src)
+{
+    if (src->dev != NULL) {
+        bladerf_enable_module(src->dev, BLADERF_CHANNEL_RX(0), false);
+        bladerf_close(src->dev);
+    }
+
+    if (src->file != NULL) {
+        fclose(src->file);
+    }
+
+    free(src->mem);
+}
+
+/* Read up to `n` samples. Returns the number read, which is only less than
+ * `n` at the end of the input, or a negative value on error. */
+static int64_t source_read(struct source *src, int16_t *buf, size_t n)
+{
+    if (src->dev != NULL) {
+        int status = bladerf_sync_rx(src->dev, buf, (unsigned int)n, NULL,
+                                     5000);
+        if (status != 0) {
+            fprintf(stderr, "RX failed: %s\n", bladerf_strerror(status));
+            return status;
+        }
+        return (int64_t)n;
+    } else if (src->file != NULL) {
+        return (int64_t)fread(buf, 2 * sizeof(int16_t), n, src->file);
+    } else {
+        const size_t avail = src->mem_samples - src->mem_pos;
+        if (n > avail) {
+            n = avail;
+        }
+        memcpy(buf, &src->mem[2 * src->mem_pos], n * 2 * sizeof(int16_t));
+        src->mem_pos += n;
+        return (int64_t)n;
+    }
+}
+
+static void *worker(void *arg)
+{
+    struct pipeline *pl = arg;
+    struct block *b;
+
+    pthread_mutex_lock(&pl->lock);
+
+    while (true) {
+        while (!pl->shutdown &&
+               pl->blocks[pl->next_work].state != BLOCK_FILLED) {
+            pthread_cond_wait(&pl->work_ready, &pl->lock);
+        }
+
+        if (pl->shutdown) {
+            break;
+        }
+
+        b = &pl->blocks[pl->next_work];
+        b->state = BLOCK_BUSY;
+        pl->next_work = (pl->next_work + 1) % pl->num_blocks;
+
+        pthread_mutex_unlock(&pl->lock);
+
+        adsb_magnitude(b->samples, b->mag, b->n + ADSB_FRAME_SAMPLES);
+
+        memset(&b->stats, 0, sizeof(b->stats));
+        b->num_msgs = adsb_demod(b->mag, b->n, b->base, pl->cache,
+                                 pl->fix_errors, b->msgs, BLOCK_MAX_MSGS,
+                                 &b->stats);
+
+        pthread_mutex_lock(&pl->lock);
+        b->state = BLOCK_DONE;
+        pthread_cond_broadcast(&pl->work_done);
+    }
+
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+static void pipeline_deinit(struct pipeline *pl)
+{
+    size_t i;
+
+    if (pl->num_threads > 0) {
+        pthread_mutex_lock(&pl->lock);
+        pl->shutdown = true;
+        pthread_cond_broadcast(&pl->work_ready);
+        pthread_mutex_unlock(&pl->lock);
+
+        for (i = 0; i < pl->num_threads; i++) {
+            pthread_join(pl->threads[i], NULL);
+        }
+    }
+
+    if (pl->blocks != NULL) {
+        for (i = 0; i < pl->num_blocks; i++) {
+            free(pl->blocks[i].samples);
+            free(pl->blocks[i].mag);
+            free(pl->blocks[i].msgs);
+        }
+        free(pl->blocks);
+    }
+
+    adsb_icao_cache_free(pl->cache);
+    pthread_cond_destroy(&pl->work_done);
+    pthread_cond_destroy(&pl->work_ready);
+    pthread_mutex_destroy(&pl->lock);
+}
+
+static int pipeline_init(struct pipeline *pl, const struct app_params *p)
+{
+    const size_t len = BLOCK_SAMPLES + ADSB_FRAME_SAMPLES;
+    size_t i;
+    int status;
+
+    memset(pl, 0, sizeof(*pl));
+    pthread_mutex_init(&pl->lock, NULL);
+    pthread_cond_init(&pl->work_ready, NULL);
+    pthread_cond_init(&pl->work_done, NULL);
+
+    pl->fix_errors = p->fix_errors;
+    pl->cache = adsb_icao_cache_alloc();
+    if (pl->cache == NULL) {
+        goto error;
+    }
+
+    /* Enough blocks to keep every worker busy while the next ones are read
+     * and the previous ones are printed */
+    pl->num_blocks = 2 * p->threads + 2;
+    pl->blocks = calloc(pl->num_blocks, sizeof(pl->blocks[0]));
+    if (pl->blocks == NULL) {
+        goto error;
+    }
+
+    for (i = 0; i < pl->num_blocks; i++) {
+        struct block *b = &pl->blocks[i];
+
+        b->samples = calloc(2 * len, sizeof(b->samples[0]));
+        b->mag     = malloc(len * sizeof(b->mag[0]));
+        b->msgs    = malloc(BLOCK_MAX_MSGS * sizeof(b->msgs[0]));
+
+        if (b->samples == NULL || b->mag == NULL || b->msgs == NULL) {
+            goto error;
+        }
+    }
+
+    for (i = 0; i < p->threads; i++) {
+        status = pthread_create(&pl->threads[i], NULL, worker, pl);
+        if (status != 0) {
+            fprintf(stderr, "Failed to create worker thread: %s\n",
+                    strerror(status));
+            pipeline_deinit(pl);
+            return -1;
+        }
+        pl->num_threads++;
+    }
+
+    return 0;
+
+error:
+    fprintf(stderr, "Failed to allocate buffers.\n");
+    pipeline_deinit(pl);
+    return -1;
+}
+
+static void accumulate(struct adsb_stats *total, const struct adsb_stats *s)
+{
+    total->samples   += s->samples;
+    total->preambles += s->preambles;
+    total->valid     += s->valid;
+    total->corrected += s->corrected;
+    total->bad_crc   += s->bad_crc;
+}
+
+/* Print and recycle the oldest block, once it has been demodulated. Must be
+ * called with the pipeline lock held. */
+static void retire_block(struct pipeline *pl, size_t *tail,
+                         const struct app_params *p, struct adsb_stats *total)
+{
+    struct block *b = &pl->blocks[*tail];
+    size_t i;
+
+    while (b->state != BLOCK_DONE) {
+        pthread_cond_wait(&pl->work_done, &pl->lock);
+    }
+
+    if (!p->benchmark) {
+        for (i = 0; i < b->num_msgs; i++) {
+            adsb_print(&b->msgs[i], p->verbose);
+        }
+        fflush(stdout);
+    }
+
+    accumulate(total, &b->stats);
+
+    b->state = BLOCK_EMPTY;
+    *tail = (*tail + 1) % pl->num_blocks;
+}
+
+static int run(struct pipeline *pl, struct source *src,
+               const struct app_params *p, struct adsb_stats *total)
+{
+    size_t head = 0, tail = 0, in_flight = 0;
+    struct block *prev = NULL;
+    uint64_t base = 0;
+    int64_t n_read;
+    int status = 0;
+
+    while (!stop_requested) {
+        struct block *b = &pl->blocks[head];
+        size_t have = 0;
+
+        pthread_mutex_lock(&pl->lock);
+        if (in_flight == pl->num_blocks) {
+            retire_block(pl, &tail, p, total);
+            in_flight--;
+        }
+        pthread_mutex_unlock(&pl->lock);
+
+        /* Carry over the tail of the previous block, which it only searched
+         * for the start of messages */
+        if (prev != NULL) {
+            memcpy(b->samples, &prev->samples[2 * BLOCK_SAMPLES],
+                   2 * ADSB_FRAME_SAMPLES * sizeof(int16_t));
+            have = ADSB_FRAME_SAMPLES;
+        }
+
+        n_read = source_read(src, &b->samples[2 * have],
+                             BLOCK_SAMPLES + ADSB_FRAME_SAMPLES - have);
+        if (n_read < 0) {
+            status = (int)n_read;
+            break;
+        }
+
+        have += (size_t)n_read;
+        if (have <= ADSB_FRAME_SAMPLES && prev != NULL) {
+            break;
+        }
+
+        /* Zero-pad a short final block */
+        memset(&b->samples[2 * have], 0,
+               (BLOCK_SAMPLES + ADSB_FRAME_SAMPLES - have) * 2 *
+               sizeof(int16_t));
+
+        b->base = base;
+        b->n    = have < BLOCK_SAMPLES ? have : BLOCK_SAMPLES;
+        base   += b->n;
+
+        pthread_mutex_lock(&pl->lock);
+        b->state = BLOCK_FILLED;
+        pthread_cond_signal(&pl->work_ready);
+        pthread_mutex_unlock(&pl->lock);
+
+        prev = b;
+        head = (head + 1) % pl->num_blocks;
+        in_flight++;
+
+        if (have < BLOCK_SAMPLES + ADSB_FRAME_SAMPLES) {
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&pl->lock);
+    while (in_flight > 0) {
+        retire_block(pl, &tail, p, total);
+        in_flight--;
+    }
+    pthread_mutex_unlock(&pl->lock);
+
+    return status;
+}
+
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) +
+           (double)(now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    struct app_params params;
+    struct source src;
+    struct pipeline pl;
+    struct adsb_stats total;
+    struct timespec start;
+    double secs;
+    int status;
+
+    status = handle_cmdline(argc, argv, &params);
+    if (status != 0) {
+        return status == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    status = source_open(&params, &src);
+    if (status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    status = pipeline_init(&pl, &params);
+    if (status != 0) {
+        source_close(&src);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    memset(&total, 0, sizeof(total));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    status = run(&pl, &src, &params, &total);
+
+    secs = elapsed(&start);
+
+    pipeline_deinit(&pl);
+    source_close(&src);
+
+    if (!params.quiet || params.benchmark) {
+        fprintf(stderr, "Samples:            %" PRIu64 "\n", total.samples);
+        fprintf(stderr, "Preambles:          %" PRIu64 "\n", total.preambles);
+        fprintf(stderr, "Valid messages:     %" PRIu64 "\n", total.valid);
+        fprintf(stderr, "Corrected messages: %" PRIu64 "\n", total.corrected);
+        fprintf(stderr, "Bad CRC:            %" PRIu64 "\n", total.bad_crc);
+    }
+
+    if (params.benchmark) {
+        const double msps = (double)total.samples / secs / 1e6;
+        fprintf(stderr, "Elapsed:            %.3f s (%u threads)\n", secs,
+                params.threads);
+        fprintf(stderr, "Throughput:         %.2f Msps (%.1fx real time)\n",
+                msps, msps * 1e6 / ADSB_SAMPLE_RATE);
+    }
+
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -24,8 +24,10 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
+#include <string.h>
 #include "host_config.h"
 #include "fsk.h"
+#include "modulator.h"
 
 #ifdef DEBUG_MODE
     #define DEBUG_MSG(...) fprintf(stderr, __VA_ARGS__)
@@ -35,8 +37,7 @@
 
 //internal structs
 struct fsk_handle {
-    struct complex_sample *sample_table;
-    int points_per_rev;
+    struct modulator *mod;
     int samp_per_symb;
     //These variables keep track of the demodulator's state when a call to fsk_demod()
     //did not fully demodulate the last byte, meaning it needs to be called again with
@@ -51,107 +52,16 @@ struct fsk_handle {
 };
 
 //internal functions
-static struct complex_sample *fsk_gen_samples_table(int points_per_rev);
 static double angle(int i, int q);
 static void angle_unwrap(double angle_prev, double *angle);
 
-/**
- * Generate 16bit two's complement IQ samples (SC16 Q11 format) corresponding to angles
- * from 0 to 2*pi on the unit circle. Range = [-2048, 2047]. Store in 'sample_table'.
- * 0th index is at 1+j0 (2047 + j0). Next indices will rotate counter-clockwise around 
- * the circle.
- * Example: points_per_rev = 12 -> would produce:
- *
- *           |Q
- *         . ' .
- *       .   |   .
- *    --.----+----.--I
- *       .   |   .
- *         . | .
- *           '
- *           |
- *
- * @param[in]   points_per_rev      number of points desired in one revolution (0-2*pi)
- *                                  of the complex unit circle
- *
- * @return      pointer to array of complex samples
- */
-static struct complex_sample *fsk_gen_samples_table(int points_per_rev)
-{
-    int i;
-    struct complex_sample *sample_table;
-
-    sample_table = malloc(points_per_rev*sizeof(struct complex_sample));
-    if (sample_table == NULL){
-        perror("malloc");
-        return NULL;
-    }
-
-    for (i = 0; i < points_per_rev; i++){
-        //Calculate cosine/sine samples. Round to nearest integer.
-        sample_table[i].i = (int16_t) round(2048.0*cos(i * 2.0 * M_PI / points_per_rev));
-        sample_table[i].q = (int16_t) round(2048.0*sin(i * 2.0 * M_PI / points_per_rev));
-        //Clamp values to [-2048, 2047]
-        if (sample_table[i].i > 2047){
-            sample_table[i].i = 2047;
-        }
-        if (sample_table[i].i < -2048){
-            sample_table[i].i = -2048;
-        }
-        if (sample_table[i].q > 2047){
-            sample_table[i].q = 2047;
-        }
-        if (sample_table[i].q < -2048){
-            sample_table[i].q = -2048;
-        }
-    }
-    return sample_table;
-}
-
 unsigned int fsk_mod(struct fsk_handle *fsk, uint8_t *data_buf, int num_bytes,
                         struct complex_sample *samples)
 {
-
-    int samp_table_pos;        //current position in samples table
-    int byte;                //current byte (0-(num_bytes-1))
-    int bit;                //current bit (0-7) in byte
-    int samp;                //current sample in symbol period (0-(samps_per_symb-1))
-    int i;                    //index in samples buffer
-
-    //Set initial position to 0 (1 + 0j)
-    samp_table_pos = 0;
-    i = 0;
-    for (byte = 0; byte < num_bytes; byte++){
-        for (bit = 0; bit < 8; bit++){
-            //Check for 1
-            if ( ((data_buf[byte] >> bit) & 0x01) == 0x01 ){
-                //This bit is a 1. Rotate phase CCW
-                for (samp = 0; samp < fsk->samp_per_symb; samp++){
-                    if (samp_table_pos == fsk->points_per_rev - 1){
-                        samp_table_pos = 0;
-                    }else{
-                        samp_table_pos += 1;    //Increment phase
-                    }
-                    samples[i].i = fsk->sample_table[samp_table_pos].i;
-                    samples[i].q = fsk->sample_table[samp_table_pos].q;
-                    i++;
-                }
-            }else{
-                //This bit is a 0. Rotate phase CW
-                for (samp = 0; samp < fsk->samp_per_symb; samp++){
-                    if (samp_table_pos == 0){
-                        samp_table_pos = fsk->points_per_rev - 1;
-                    }else{
-                        samp_table_pos -= 1;    //Decrement phase
-                    }
-                    samples[i].i = fsk->sample_table[samp_table_pos].i;
-                    samples[i].q = fsk->sample_table[samp_table_pos].q;
-                    i++;
-                }
-            }
-        }
-    }
-    return i;
+    //Start each transmission at phase 0 (1 + 0j)
+    modulator_reset(fsk->mod);
+    return (unsigned int) modulator_mod(fsk->mod, data_buf, (size_t)num_bytes * 8,
+                                        (int16_t *)samples);
 }
 
 /**
@@ -269,6 +179,7 @@ unsigned int fsk_demod(struct fsk_handle *fsk, struct complex_sample *samples,
 struct fsk_handle *fsk_init(void)
 {
     struct fsk_handle *fsk;
+    struct modulator_config mod_config;
 
     //Allocate memory for handle
     fsk = malloc(sizeof(struct fsk_handle));
@@ -278,11 +189,18 @@ struct fsk_handle *fsk_init(void)
     }
     //Set modulation/demodulation parameters
     fsk->samp_per_symb = SAMP_PER_SYMB;
-    fsk->points_per_rev = POINTS_PER_REV;
-    //Generate the samples table
-    fsk->sample_table = fsk_gen_samples_table(POINTS_PER_REV);
-    if (fsk->sample_table == NULL){
-        fprintf(stderr, "Couldn't generate samples table\n");
+    //Each sample advances the phase by one point, so each symbol rotates the
+    //phase by SAMP_PER_SYMB/POINTS_PER_REV of a revolution
+    memset(&mod_config, 0, sizeof(mod_config));
+    mod_config.type = MODULATION_CPFSK;
+    mod_config.samples_per_symbol = SAMP_PER_SYMB;
+    mod_config.h_num = 2 * SAMP_PER_SYMB;
+    mod_config.h_den = POINTS_PER_REV;
+    mod_config.amplitude = 1.0;
+    //Generate the modulator's tables
+    fsk->mod = modulator_init(&mod_config);
+    if (fsk->mod == NULL){
+        fprintf(stderr, "Couldn't initialize modulator\n");
         free(fsk);
         return NULL;
     }
@@ -299,7 +217,7 @@ struct fsk_handle *fsk_init(void)
 void fsk_close(struct fsk_handle *fsk)
 {
     if (fsk != NULL){
-        free(fsk->sample_table);
+        modulator_close(fsk->mod);
     }
     free(fsk);
 }
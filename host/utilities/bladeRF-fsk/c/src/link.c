@@ -49,25 +49,37 @@
  *                                          *
  ********************************************/
 
-struct data_frame {
-    //Total frame length = 1009 bytes (8072 bits)
-    uint8_t type;               //0x00 = data frame, 0xFF = ack frame
-    uint16_t seq_num;           //Sequence number
-    uint16_t payload_length;    //Length of used payload data in bytes
-    uint8_t payload[PAYLOAD_LENGTH];    //payload data
-    uint32_t crc32;             //32-bit CRC
-};
+/* Frames are kept in their over-the-air format, so they can be handed to and
+ * taken from the phy layer without conversion. Multi-byte fields are in host
+ * byte order.
+ *
+ * Data frame: 1009 bytes (8072 bits)
+ *  type (1) | seq_num (2) | payload_length (2) | payload (PAYLOAD_LENGTH) | crc32 (4)
+ *
+ * Ack frame: 7 bytes (56 bits)
+ *  type (1) | ack_num (2) | crc32 (4)
+ *
+ * type is 0x00 for a data frame, 0xFF for an ack frame
+ */
+#define FRAME_TYPE_OFFSET               0
+#define DATA_FRAME_SEQ_NUM_OFFSET       1
+#define DATA_FRAME_PAYLOAD_LEN_OFFSET   3
+#define DATA_FRAME_PAYLOAD_OFFSET       5
+#define DATA_FRAME_CRC_OFFSET           (DATA_FRAME_PAYLOAD_OFFSET + PAYLOAD_LENGTH)
+#define ACK_FRAME_ACK_NUM_OFFSET        1
+#define ACK_FRAME_CRC_OFFSET            3
+
+#if DATA_FRAME_CRC_OFFSET + 4 != DATA_FRAME_LENGTH
+#   error "DATA_FRAME_LENGTH in phy.h does not match the link layer's data frame"
+#endif
 
-struct ack_frame {
-    //Total frame length = 7 bytes (56 bits)
-    uint8_t type;               //0x00 = data frame, 0xFF = ack frame
-    uint16_t ack_num;           //Acknowledgement number
-    uint32_t crc32;             //32-bit CRC
-};
+#if ACK_FRAME_CRC_OFFSET + 4 != ACK_FRAME_LENGTH
+#   error "ACK_FRAME_LENGTH in phy.h does not match the link layer's ack frame"
+#endif
 
 struct tx {
-    struct data_frame data_frame_buf;   //Input data frame buffer
-    struct ack_frame ack_frame_buf;     //Input ack frame buffer
+    uint8_t data_frame_buf[DATA_FRAME_LENGTH];  //Input data frame buffer
+    uint8_t ack_frame_buf[ACK_FRAME_LENGTH];    //Input ack frame buffer
     bool stop;                          //Signal to stop tx thread
     bool data_buf_filled;               //Is the data frame buffer filled
     pthread_t thread;                   //Transmitter thread
@@ -80,8 +92,8 @@ struct tx {
 };
 
 struct rx {
-    struct data_frame data_frame_buf;   //Output data frame buffer
-    struct ack_frame ack_frame_buf;     //Output ack frame buffer
+    uint8_t data_frame_buf[DATA_FRAME_LENGTH];  //Output data frame buffer
+    uint8_t ack_frame_buf[ACK_FRAME_LENGTH];    //Output ack frame buffer
     //Leftover bytes received but not returned to the user after a call to
     //link_receive_data()
     uint8_t extra_bytes[PAYLOAD_LENGTH];
@@ -121,10 +133,9 @@ static int receive_ack(struct link_handle *link, uint16_t ack_num,
 static int receive_payload(struct link_handle *link, uint8_t *payload,
                             unsigned int timeout_ms);
 //utility:
-static void convert_data_frame_struct_to_buf(struct data_frame *frame, uint8_t *buf);
-static void convert_ack_frame_struct_to_buf(struct ack_frame *frame, uint8_t *buf);
-static void convert_buf_to_data_frame_struct(uint8_t *buf, struct data_frame *frame);
-static void convert_buf_to_ack_frame_struct(uint8_t *buf, struct ack_frame *frame);
+static inline uint16_t frame_get_u16(const uint8_t *frame, unsigned int offset);
+static inline void frame_set_u16(uint8_t *frame, unsigned int offset, uint16_t value);
+static void frame_set_crc(uint8_t *frame, unsigned int length);
 
 /****************************************
  *                                      *
@@ -336,125 +347,31 @@ void link_close(struct link_handle *link)
 }
 
 /**
- * Convert data frame struct to a buffer of uint8_t
- * @param[in]   frame   pointer to data_frame structure to convert
- * @param[out]  buf     pointer to buffer to place the frame in
+ * Read a 16-bit field from a frame buffer
  */
-static void convert_data_frame_struct_to_buf(struct data_frame *frame, uint8_t *buf)
+static inline uint16_t frame_get_u16(const uint8_t *frame, unsigned int offset)
 {
-    int i = 0;
-
-    //Frame type
-    memcpy(&buf[i], &(frame->type), sizeof(frame->type));
-    i += sizeof(frame->type);
-    //Seq num
-    memcpy(&buf[i], &(frame->seq_num), sizeof(frame->seq_num));
-    i += sizeof(frame->seq_num);
-    //payload length
-    memcpy(&buf[i], &(frame->payload_length), sizeof(frame->payload_length));
-    i += sizeof(frame->payload_length);
-    //payload
-    memcpy(&buf[i], frame->payload, PAYLOAD_LENGTH);
-    i += PAYLOAD_LENGTH;
-    //crc
-    memcpy(&buf[i], &(frame->crc32), sizeof(frame->crc32));
-    i += sizeof(frame->crc32);
-
-    if (i != DATA_FRAME_LENGTH){
-        fprintf(stderr, "[LINK] %s: ERROR: Link layer is using a different data frame "
-                        "length (%d) than the phy layer (%d). Update the DATA_FRAME_LENGTH"
-                        " macro in phy.h and recompile or there will be unexpected results\n",
-                        __FUNCTION__, i, DATA_FRAME_LENGTH);
-    }
+    uint16_t value;
+    memcpy(&value, &frame[offset], sizeof(value));
+    return value;
 }
 
 /**
- * Convert ack frame struct to a buffer of uint8_t
- * @param[in]   frame   pointer to ack_frame structure to convert
- * @param[out]  buf     pointer to buffer to place the frame in
+ * Write a 16-bit field into a frame buffer
  */
-static void convert_ack_frame_struct_to_buf(struct ack_frame *frame, uint8_t *buf)
+static inline void frame_set_u16(uint8_t *frame, unsigned int offset, uint16_t value)
 {
-    int i = 0;
-
-    //Frame type
-    memcpy(&buf[i], &(frame->type), sizeof(frame->type));
-    i += sizeof(frame->type);
-    //ack num
-    memcpy(&buf[i], &(frame->ack_num), sizeof(frame->ack_num));
-    i += sizeof(frame->ack_num);
-    //crc
-    memcpy(&buf[i], &(frame->crc32), sizeof(frame->crc32));
-    i += sizeof(frame->crc32);
-
-    if (i != ACK_FRAME_LENGTH){
-        fprintf(stderr, "[LINK] %s: ERROR: Link layer is using a different ack frame "
-                        "length (%d) than the phy layer (%d). Update the ACK_FRAME_LENGTH"
-                        " macro in phy.h and recompile or there will be unexpected results\n",
-                        __FUNCTION__, i, ACK_FRAME_LENGTH);
-    }
+    memcpy(&frame[offset], &value, sizeof(value));
 }
 
 /**
- * Convert uint8_t buffer to data frame struct
- *
- * @param[in]   buf     pointer to buffer holding a data frame
- * @param[out]  frame   pointer to data_frame struct to place frame in
+ * Calculate the CRC over all but the last 4 bytes of a frame, and place it in
+ * those last 4 bytes
  */
-static void convert_buf_to_data_frame_struct(uint8_t *buf, struct data_frame *frame)
+static void frame_set_crc(uint8_t *frame, unsigned int length)
 {
-    int i = 0;
-
-    //Frame type
-    memcpy(&(frame->type), &buf[i], sizeof(frame->type));
-    i += sizeof(frame->type);
-    //Seq num
-    memcpy(&(frame->seq_num), &buf[i], sizeof(frame->seq_num));
-    i += sizeof(frame->seq_num);
-    //payload length
-    memcpy(&(frame->payload_length), &buf[i], sizeof(frame->payload_length));
-    i += sizeof(frame->payload_length);
-    //payload
-    memcpy(frame->payload, &buf[i], PAYLOAD_LENGTH);
-    i += PAYLOAD_LENGTH;
-    //crc
-    memcpy(&(frame->crc32), &buf[i], sizeof(frame->crc32));
-    i += sizeof(frame->crc32);
-
-    if (i != DATA_FRAME_LENGTH){
-        fprintf(stderr, "[LINK] %s: ERROR: Link layer is using a different data frame "
-                        "length (%d) than the phy layer (%d). Update the DATA_FRAME_LENGTH"
-                        " macro in phy.h and recompile or there will be unexpected results\n",
-                        __FUNCTION__, i, DATA_FRAME_LENGTH);
-    }
-}
-
-/**
- * Convert uint8_t buffer to ack frame struct
- *
- * @param[in]   buf     pointer to buffer holding a ack frame
- * @param[out]  frame   pointer to ack_frame struct to place frame in
- */
-static void convert_buf_to_ack_frame_struct(uint8_t *buf, struct ack_frame *frame)
-{
-    int i = 0;
-
-    //Frame type
-    memcpy(&(frame->type), &buf[i], sizeof(frame->type));
-    i += sizeof(frame->type);
-    //ack num
-    memcpy(&(frame->ack_num), &buf[i], sizeof(frame->ack_num));
-    i += sizeof(frame->ack_num);
-    //crc
-    memcpy(&(frame->crc32), &buf[i], sizeof(frame->crc32));
-    i += sizeof(frame->crc32);
-
-    if (i != ACK_FRAME_LENGTH){
-        fprintf(stderr, "[LINK] %s: ERROR: Link layer is using a different ack frame "
-                        "length (%d) than the phy layer (%d). Update the ACK_FRAME_LENGTH"
-                        " macro in phy.h and recompile or there will be unexpected results\n",
-                        __FUNCTION__, i, ACK_FRAME_LENGTH);
-    }
+    uint32_t crc_32 = crc32(frame, length - sizeof(crc_32));
+    memcpy(&frame[length - sizeof(crc_32)], &crc_32, sizeof(crc_32));
 }
 
 /****************************************
@@ -596,13 +513,15 @@ static int send_payload(struct link_handle *link, uint8_t *payload,
     while(link->tx->data_buf_filled){
         usleep(50);
     }
-    //Copy payload data into frame buffer
-    memcpy(link->tx->data_frame_buf.payload, payload, used_payload_length);
+    //Copy payload data directly into the frame buffer
+    memcpy(&(link->tx->data_frame_buf[DATA_FRAME_PAYLOAD_OFFSET]), payload,
+            used_payload_length);
     //Pad zeros to unused portion of the payload
-    memset(&(link->tx->data_frame_buf.payload[used_payload_length]), 0,
-            PAYLOAD_LENGTH - used_payload_length);
+    memset(&(link->tx->data_frame_buf[DATA_FRAME_PAYLOAD_OFFSET + used_payload_length]),
+            0, PAYLOAD_LENGTH - used_payload_length);
     //Set payload length
-    link->tx->data_frame_buf.payload_length = used_payload_length;
+    frame_set_u16(link->tx->data_frame_buf, DATA_FRAME_PAYLOAD_LEN_OFFSET,
+                    used_payload_length);
     //Mark tx not done
     link->tx->done = false;
     //Mark buffer filled
@@ -650,9 +569,7 @@ void *transmit_data_frames(void *arg)
 {
     int status;
     uint16_t seq_num;
-    uint32_t crc_32;
     unsigned int tries;
-    uint8_t data_send_buf[DATA_FRAME_LENGTH];
     bool failed;
 
     //cast arg
@@ -707,21 +624,18 @@ void *transmit_data_frames(void *arg)
             }
             DEBUG_MSG("[LINK] TX: Frame buffer filled. Sending...\n");
             //Set frame type
-            link->tx->data_frame_buf.type = DATA_FRAME_CODE;
+            link->tx->data_frame_buf[FRAME_TYPE_OFFSET] = DATA_FRAME_CODE;
             //Set sequence number
-            link->tx->data_frame_buf.seq_num = seq_num;
-            //Copy frame into send buf
-            convert_data_frame_struct_to_buf(&(link->tx->data_frame_buf), data_send_buf);
+            frame_set_u16(link->tx->data_frame_buf, DATA_FRAME_SEQ_NUM_OFFSET, seq_num);
             //Calculate the CRC
-            crc_32 = crc32(data_send_buf, DATA_FRAME_LENGTH - sizeof(crc_32));
-            //Copy this CRC to the send buf
-            memcpy(&data_send_buf[DATA_FRAME_LENGTH - sizeof(crc_32)],
-                    &crc_32, sizeof(crc_32));
-            //Mark tx data buffer empty
+            frame_set_crc(link->tx->data_frame_buf, DATA_FRAME_LENGTH);
+            //Mark tx data buffer empty. send_payload() won't touch the frame
+            //again until this transmission is done, so retransmissions may
+            //send it straight from the frame buffer.
             link->tx->data_buf_filled = false;
         }
         //Transmit the frame
-        status = phy_fill_tx_buf(link->phy, data_send_buf, DATA_FRAME_LENGTH);
+        status = phy_fill_tx_buf(link->phy, link->tx->data_frame_buf, DATA_FRAME_LENGTH);
         if (status != 0){
             fprintf(stderr, "[LINK] Couldn't fill phy tx buffer\n");
             goto out;
@@ -941,9 +855,11 @@ static int receive_payload(struct link_handle *link, uint8_t *payload, unsigned
     }
 
     //Get the length of the used portion of the payload
-    payload_length = link->rx->data_frame_buf.payload_length;
+    payload_length = frame_get_u16(link->rx->data_frame_buf,
+                                    DATA_FRAME_PAYLOAD_LEN_OFFSET);
     //Copy the used portion of the payload
-    memcpy(payload, link->rx->data_frame_buf.payload, payload_length);
+    memcpy(payload, &(link->rx->data_frame_buf[DATA_FRAME_PAYLOAD_OFFSET]),
+            payload_length);
     //Mark the rx data buffer empty
     link->rx->data_buf_filled = false;
 
@@ -965,6 +881,7 @@ static int receive_ack(struct link_handle *link, uint16_t ack_num, unsigned int
 {
     struct timespec timeout_abs;
     int status, ret = 0;
+    uint16_t rx_ack_num;
 
     //Create absolute time format timeout
     status = create_timeout_abs(timeout_ms, &timeout_abs);
@@ -1003,9 +920,10 @@ static int receive_ack(struct link_handle *link, uint16_t ack_num, unsigned int
         ret = -1;
     }
     //Check the sequence number if nothing failed
-    if (ret == 0 && link->rx->ack_frame_buf.ack_num != ack_num){
+    rx_ack_num = frame_get_u16(link->rx->ack_frame_buf, ACK_FRAME_ACK_NUM_OFFSET);
+    if (ret == 0 && rx_ack_num != ack_num){
         fprintf(stderr, "[LINK] RX: receive_ack(): Incorrect ack number %hu "
-                    "(expected %hu)\n", link->rx->ack_frame_buf.ack_num, ack_num);
+                    "(expected %hu)\n", rx_ack_num, ack_num);
         ret = -3;
     }
     //mark the rx ack buffer empty
@@ -1032,8 +950,8 @@ void *receive_frames(void *arg)
     uint32_t crc_32, crc_32_rx;
     bool is_data_frame = false;
     int status;
-    uint8_t ack_send_buf[ACK_FRAME_LENGTH];
     uint16_t seq_num = 0;
+    uint16_t rx_seq_num;
     bool first_frame = true;
     bool duplicate;
 
@@ -1099,19 +1017,20 @@ void *receive_frames(void *arg)
                         phy_release_rx_buf(link->phy);
                         break;
                     }
-                    //Copy/convert to data frame struct
-                    convert_buf_to_data_frame_struct(rx_buf,
-                                                &(link->rx->data_frame_buf));
+                    //Copy the frame out of the phy's buffer
+                    memcpy(link->rx->data_frame_buf, rx_buf, DATA_FRAME_LENGTH);
                     //Release buffer from the phy
                     phy_release_rx_buf(link->phy);
                     //Is this frame a duplicate of the last frame?
-                    if (link->rx->data_frame_buf.seq_num == seq_num && !first_frame){
+                    rx_seq_num = frame_get_u16(link->rx->data_frame_buf,
+                                                DATA_FRAME_SEQ_NUM_OFFSET);
+                    if (rx_seq_num == seq_num && !first_frame){
                         DEBUG_MSG("[LINK] RX: Received a duplicate frame.\n");
                         duplicate = true;
                     }else{
                         duplicate = false;
                     }
-                    seq_num = link->rx->data_frame_buf.seq_num;
+                    seq_num = rx_seq_num;
                     first_frame = false;
                     //Mark buffer filled if not a duplicate data frame
                     if (!duplicate){
@@ -1146,8 +1065,8 @@ void *receive_frames(void *arg)
                         phy_release_rx_buf(link->phy);
                         break;
                     }
-                    //Copy/convert to ack frame struct and mark ack buffer filled
-                    convert_buf_to_ack_frame_struct(rx_buf, &(link->rx->ack_frame_buf));
+                    //Copy the frame out of the phy's buffer and mark ack buffer filled
+                    memcpy(link->rx->ack_frame_buf, rx_buf, ACK_FRAME_LENGTH);
                     //Release buffer from the phy
                     phy_release_rx_buf(link->phy);
                     //Signal that the link ack buffer is filled
@@ -1178,19 +1097,13 @@ void *receive_frames(void *arg)
                 //--We received a data frame, now it's time to send the ack
                 DEBUG_MSG("[LINK] RX: State = SEND_ACK (ack# = %hu)\n", seq_num);
 
-                link->tx->ack_frame_buf.type = 0xFF;
-                link->tx->ack_frame_buf.ack_num = seq_num;
-
-                //Copy frame into send buf
-                convert_ack_frame_struct_to_buf(&(link->tx->ack_frame_buf),
-                                                ack_send_buf);
+                link->tx->ack_frame_buf[FRAME_TYPE_OFFSET] = ACK_FRAME_CODE;
+                frame_set_u16(link->tx->ack_frame_buf, ACK_FRAME_ACK_NUM_OFFSET, seq_num);
                 //Calculate the CRC
-                crc_32 = crc32(ack_send_buf, ACK_FRAME_LENGTH - sizeof(crc_32));
-                //Copy this CRC to the send buf
-                memcpy(&ack_send_buf[ACK_FRAME_LENGTH - sizeof(crc_32)], &crc_32,
-                        sizeof(crc_32));
+                frame_set_crc(link->tx->ack_frame_buf, ACK_FRAME_LENGTH);
                 //Transmit with phy
-                status = phy_fill_tx_buf(link->phy, ack_send_buf, ACK_FRAME_LENGTH);
+                status = phy_fill_tx_buf(link->phy, link->tx->ack_frame_buf,
+                                            ACK_FRAME_LENGTH);
                 if (status != 0){
                     fprintf(stderr, "[LINK] Couldn't fill phy tx buffer\n");
                     goto out;
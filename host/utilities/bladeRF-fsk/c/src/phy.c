@@ -94,8 +94,8 @@ struct phy_handle {
 //Internal functions
 void *phy_receive_frames(void *arg);
 void *phy_transmit_frames(void *arg);
-static void scramble_frame(uint8_t *frame, int frame_length, uint8_t *scrambling_sequence);
-static void unscramble_frame(uint8_t *frame, int frame_length, uint8_t *scrambling_sequence);
+static void scramble_copy(uint8_t *dest, const uint8_t *src, unsigned int length,
+                            const uint8_t *scrambling_sequence);
 static void create_ramps(unsigned int ramp_length, struct complex_sample ramp_down_init,
                     struct complex_sample *ramp_up, struct complex_sample *ramp_down);
 
@@ -411,8 +411,10 @@ int phy_fill_tx_buf(struct phy_handle *phy, uint8_t *data_buf, unsigned int leng
         usleep(50);
     }
 
-    //Copy the tx data into the phy's tx data buf, just after where the preamble goes
-    memcpy(&(phy->tx->data_buf[TRAINING_SEQ_LENGTH+PREAMBLE_LENGTH]), data_buf, length);
+    //Scramble the tx data straight into the phy's tx data buf, just after where the
+    //preamble goes
+    scramble_copy(&(phy->tx->data_buf[TRAINING_SEQ_LENGTH+PREAMBLE_LENGTH]), data_buf,
+                    length, phy->scrambling_sequence);
     //Set the data length
     phy->tx->data_length = length;
     //Mark the buffer filled
@@ -507,11 +509,6 @@ void *phy_transmit_frames(void *arg)
         memcpy(phy->tx->data_buf, &training_seq, TRAINING_SEQ_LENGTH);
         //Add preamble to tx data buffer
         memcpy(&(phy->tx->data_buf[TRAINING_SEQ_LENGTH]), &preamble, PREAMBLE_LENGTH);
-        #ifndef BYPASS_PHY_SCRAMBLING
-            //Scramble the frame data (not including the training sequence or preamble)
-            scramble_frame(&(phy->tx->data_buf[TRAINING_SEQ_LENGTH + PREAMBLE_LENGTH]),
-                            phy->tx->data_length, phy->scrambling_sequence);
-        #endif
         //zero the tx samples buffer
         memset(phy->tx->samples, 0, sizeof(int16_t) * 2 * num_samples);
         //modulate samples - leave space for ramp up/ramp down in the samples buffer
@@ -593,17 +590,32 @@ static void create_ramps(unsigned int ramp_length, struct complex_sample ramp_do
 }
 
 /**
- * Scrambles the given data with the given scrambling sequence. The size of the
- * scrambling sequence array must be at least as large as the frame.
+ * Copies data while scrambling (or unscrambling) it with the given scrambling
+ * sequence. The size of the scrambling sequence array must be at least as large
+ * as the data. If BYPASS_PHY_SCRAMBLING is defined, this is a plain copy.
  */
-static void scramble_frame(uint8_t *frame, int frame_length,
-                            uint8_t *scrambling_sequence)
+static void scramble_copy(uint8_t *dest, const uint8_t *src, unsigned int length,
+                            const uint8_t *scrambling_sequence)
 {
-    int i;
-    for (i = 0; i < frame_length; i++){
-        //XOR byte with byte from scrambling sequence
-        frame[i] ^= scrambling_sequence[i];
+#ifdef BYPASS_PHY_SCRAMBLING
+    memcpy(dest, src, length);
+#else
+    unsigned int i;
+    uint64_t word, key;
+
+    //XOR 8 bytes at a time. memcpy() keeps this safe for unaligned buffers, and
+    //compiles down to plain loads and stores.
+    for (i = 0; i + sizeof(word) <= length; i += sizeof(word)){
+        memcpy(&word, &src[i], sizeof(word));
+        memcpy(&key, &scrambling_sequence[i], sizeof(key));
+        word ^= key;
+        memcpy(&dest[i], &word, sizeof(word));
     }
+    //XOR the remaining bytes
+    for (; i < length; i++){
+        dest[i] = src[i] ^ scrambling_sequence[i];
+    }
+#endif
 }
 
 /****************************************
@@ -707,9 +719,8 @@ void phy_release_rx_buf(struct phy_handle *phy)
  * 3) Power normalize the samples
  * 4) Correlate the samples with the preamble waveform
  * 5) If a match is found, demodulate the samples into data bytes
- * 6) Unscramble the data
- * 7) Copy the frame to a buffer which can be acquired with phy_request_rx_buf(), or
- *    drop the frame if the buffer is still in use
+ * 6) Unscramble the frame into a buffer which can be acquired with
+ *    phy_request_rx_buf(), or drop the frame if the buffer is still in use
  *
  * @param    arg        pointer to phy_handle struct
  */
@@ -732,7 +743,7 @@ void *phy_receive_frames(void *arg)
     uint64_t timestamp = UINT64_MAX;
 
     enum states {RECEIVE, PREAMBLE_CORRELATE, DEMOD,
-                    CHECK_FRAME_TYPE, DECODE, COPY};
+                    CHECK_FRAME_TYPE, COPY};
     enum states state;                //current state variable
 
     /* corr_process() takes a size_t count.
@@ -839,7 +850,7 @@ void *phy_receive_frames(void *arg)
                         samples_index++;
                     }else{
                         //We demoded all samples in the frame
-                        state = DECODE;
+                        state = COPY;
                     }
                 }
                 data_index += num_bytes_rx;
@@ -873,15 +884,6 @@ void *phy_receive_frames(void *arg)
                 num_bytes_to_demod = frame_length-1;
                 state = DEMOD;
                 break;
-            case DECODE:
-                //--Remove any phy encoding on the received frame
-                DEBUG_MSG("[PHY] RX: State = DECODE\n");
-                #ifndef BYPASS_PHY_SCRAMBLING
-                    //Unscramble the frame
-                    unscramble_frame(rx_buffer, frame_length, phy->scrambling_sequence);
-                #endif
-                state = COPY;
-                break;
             case COPY:
                 //--Copy frame into buffer which can be accessed by the link layer
                 DEBUG_MSG("[PHY] RX: State = COPY\n");
@@ -890,9 +892,9 @@ void *phy_receive_frames(void *arg)
                     //Instead of disrupting the link layer, drop this frame
                     NOTE("[PHY] RX: Frame dropped!\n");
                 }else{
-                    //Copy frame into rx_data_buf
-                    memcpy(phy->rx->data_buf, rx_buffer,
-                            frame_length);
+                    //Unscramble the frame into rx_data_buf
+                    scramble_copy(phy->rx->data_buf, rx_buffer, frame_length,
+                                    phy->scrambling_sequence);
                     phy->rx->buf_filled = true;
                     //Signal that the buffer is filled
                     status = pthread_mutex_lock(&(phy->rx->buf_status_lock));
@@ -932,17 +934,3 @@ void *phy_receive_frames(void *arg)
         free(rx_buffer);
         return NULL;
 }
-
-/**
- * Unscrambles the given data with the given scrambling sequence. The size of the
- * scrambling sequence array must be at least as large as the frame.
- */
-static void unscramble_frame(uint8_t *frame, int frame_length,
-                                uint8_t *scrambling_sequence)
-{
-    int i;
-    for (i = 0; i < frame_length; i++){
-        //XOR byte with byte from scrambling sequence
-        frame[i] ^= scrambling_sequence[i];
-    }
-}